@@ -0,0 +1,99 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#ifndef GMSAREAINDEX_H
+#define GMSAREAINDEX_H
+
+#include "config.h"
+#include "BoundingBoxTree.h"
+#include "NotCopyable.h"
+#include "MC2Coordinate.h"
+
+#include <vector>
+
+class OldGenericMap;
+class PreparedGfxData;
+
+/**
+  *   Index of the geometry of a set of area items in a map, e.g. the
+  *   municipals or built up areas, used when setting the location of
+  *   the other items.
+  *
+  *   The bounding boxes of the areas are kept in an R-tree, so only the
+  *   areas whose bounding box contains a coordinate need to be tested,
+  *   and the polygons are prepared for fast point in polygon tests.
+  *
+  *   The areas are identified by their position in the vector of ids
+  *   the index was created with. The index must be recreated if the
+  *   geometry of the areas changes.
+  */
+class GMSAreaIndex: private NotCopyable {
+ public:
+   /**
+    * Creates the index.
+    *
+    * @param theMap  The map of the areas.
+    * @param areaIDs The ids of the areas. Areas without gfx data are
+    *                never found.
+    */
+   GMSAreaIndex( const OldGenericMap& theMap, 
+                 const vector<uint32>& areaIDs );
+
+   ~GMSAreaIndex();
+
+   /// @return The number of areas.
+   uint32 getNbrAreas() const { return m_areaIDs.size(); }
+
+   /// @return The id of the area at pos.
+   uint32 getAreaID( uint32 pos ) const { return m_areaIDs[ pos ]; }
+
+   /**
+    * Finds the areas that may contain any of the coordinates.
+    *
+    * @param coords    The coordinates.
+    * @param positions Set to the positions of the areas whose
+    *                  bounding box contains any of the coordinates,
+    *                  in increasing order.
+    */
+   void getCandidates( const vector<MC2Coordinate>& coords,
+                       vector<uint32>& positions ) const;
+
+   /**
+    * Same as GfxData::insidePolygon for the area at pos.
+    *
+    * @return 0 if outside, 1 on the boundry and 2 inside.
+    */
+   int insidePolygon( uint32 pos, int32 lat, int32 lon ) const;
+
+   /**
+    * @return The position of the first area that contains the
+    *         coordinate, on the boundry counts, or MAX_UINT32 if none.
+    */
+   uint32 getFirstContaining( int32 lat, int32 lon ) const;
+
+ private:
+   /// The ids of the areas.
+   vector<uint32> m_areaIDs;
+
+   /// The prepared polygons of the areas, NULL if no gfx data.
+   vector<PreparedGfxData*> m_polygons;
+
+   /// The bounding boxes of the areas.
+   BoundingBoxTree m_tree;
+
+   /// Areas that cross the date line, always tested.
+   vector<uint32> m_alwaysTested;
+};
+
+#endif // GMSAREAINDEX_H
@@ -0,0 +1,131 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#ifndef GMSMAPJOBRUNNER_H
+#define GMSMAPJOBRUNNER_H
+
+#include "config.h"
+#include "MC2String.h"
+
+#include <vector>
+
+class OldGenericMap;
+
+/**
+  *   One stage of the map generation that only changes the map it is
+  *   given, e.g. generating turn descriptions or streets. A stage may
+  *   read data collected from other maps by an earlier stage, like
+  *   the boundry segments used for the external connections, but must
+  *   not load or change any other map.
+  *
+  *   processMap may be called from several threads at the same time,
+  *   with different maps.
+  */
+class GMSMapJob {
+ public:
+   /// What to do with the map after processMap.
+   enum result_t {
+      /// The map was changed and is saved.
+      saveMap,
+      /// The map was not changed.
+      noSave,
+      /// The processing failed, the map is saved anyway.
+      failedSaveMap,
+      /// The processing failed, the map is not saved.
+      failed
+   };
+
+   virtual ~GMSMapJob() {}
+
+   /// The name of the stage, used in the timing output.
+   virtual const char* getName() const = 0;
+
+   /**
+    * Loads a map. The default loads it with GMSMap::createMap.
+    *
+    * @param mapID   The id of the map.
+    * @param mapPath The directory of the maps.
+    * @return The map or NULL if it could not be loaded.
+    */
+   virtual OldGenericMap* createMap( uint32 mapID, 
+                                     const char* mapPath ) const;
+
+   /**
+    * Processes one map.
+    *
+    * @param theMap The map to process.
+    * @return What to do with the map.
+    */
+   virtual result_t processMap( OldGenericMap* theMap ) = 0;
+};
+
+/**
+  *   Runs a GMSMapJob on all maps in a directory. The maps are loaded,
+  *   processed and saved by a number of threads, each working on one
+  *   map at a time. With one thread the maps are processed in order
+  *   by the calling thread, just as the old loops did.
+  *
+  *   The time spent loading, processing and saving is summed for all
+  *   maps and printed when the stage is done.
+  */
+class GMSMapJobRunner {
+ public:
+   /**
+    * @param mapPath    The directory of the maps.
+    * @param nbrThreads The number of maps to process at the same time.
+    */
+   GMSMapJobRunner( const char* mapPath, uint32 nbrThreads );
+
+   /**
+    * Runs job on the maps from startMapID up to endMapID. The maps
+    * must be numbered with MapBits::nextMapID and the first missing
+    * map ends the stage.
+    *
+    * @param job        The stage to run.
+    * @param startMapID The first map.
+    * @param endMapID   The last map.
+    * @return The number of maps that failed.
+    */
+   uint32 run( GMSMapJob& job, uint32 startMapID, 
+               uint32 endMapID = MAX_UINT32 );
+
+   /**
+    * Runs job on the given maps.
+    *
+    * @param job    The stage to run.
+    * @param mapIDs The maps to process, each map only once.
+    * @return The number of maps that failed.
+    */
+   uint32 run( GMSMapJob& job, const vector<uint32>& mapIDs );
+
+   /**
+    * @param mapPath    The directory of the maps.
+    * @param startMapID The first map.
+    * @param endMapID   The last map.
+    * @return The ids of the maps in mapPath from startMapID up to
+    *         the first missing map or endMapID.
+    */
+   static vector<uint32> getMapIDs( const char* mapPath, 
+                                    uint32 startMapID, 
+                                    uint32 endMapID );
+
+ private:
+   /// The directory of the maps.
+   MC2String m_mapPath;
+
+   /// The number of threads to use.
+   uint32 m_nbrThreads;
+};
+
+#endif // GMSMAPJOBRUNNER_H
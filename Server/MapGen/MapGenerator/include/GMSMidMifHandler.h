@@ -24,7 +24,12 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 class GMSMidMifHandler {
    public:
 
-      GMSMidMifHandler(GMSMap* theMap);
+      /**
+       *    @param theMap          The map to add items to or print.
+       *    @param nbrParseThreads The number of threads parsing the
+       *                           mif features in createItemsFromMidMif.
+       */
+      GMSMidMifHandler(GMSMap* theMap, uint32 nbrParseThreads = 1);
 
       virtual ~GMSMidMifHandler();
       
@@ -153,6 +158,11 @@ class GMSMidMifHandler {
        */
       GMSMap* m_map;
 
+      /**
+       *    The number of threads parsing mif features.
+       */
+      uint32 m_nbrParseThreads;
+
       /**
        *    The map gfx data.
        */
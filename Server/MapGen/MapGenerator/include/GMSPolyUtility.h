@@ -67,15 +67,22 @@ class GMSPolyUtility
          ItemTypes::itemType elimItemType = ItemTypes::numberOfItemTypes );
          
    /**
-    *    The id of the item that is processed, used for debug printing
-    *    and needed since many of the methods operate on gfx data.
+    *    The ids of the item and map that are processed, used for debug
+    *    printing and needed since many of the methods operate on gfx data.
     */
-   static uint32 myItemID;
+   struct ProcessedItem {
+      ProcessedItem() : itemID( MAX_UINT32 ), mapID( MAX_UINT32 ) {}
+      /// The id of the item that is processed.
+      uint32 itemID;
+      /// The id of the map that is processed.
+      uint32 mapID;
+   };
+
    /**
-    *    The id of the map that is processed, used for debug printing
-    *    and needed since many of the methods operate on gfx data.
+    *    @return The item and map processed by the calling thread, as
+    *            several maps may be processed at the same time.
     */
-   static uint32 myMapID;
+   static ProcessedItem& processed();
 
    /**
     *    Merge water items in a country overview map. Large waters are
@@ -0,0 +1,83 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "GMSAreaIndex.h"
+
+#include "OldGenericMap.h"
+#include "OldItem.h"
+#include "GfxData.h"
+#include "PreparedGfxData.h"
+#include "DeleteHelpers.h"
+
+#include <algorithm>
+
+GMSAreaIndex::GMSAreaIndex( const OldGenericMap& theMap,
+                            const vector<uint32>& areaIDs )
+      : m_areaIDs( areaIDs ),
+        m_polygons( areaIDs.size(), NULL ) {
+   for ( uint32 pos = 0; pos < m_areaIDs.size(); ++pos ) {
+      const OldItem* area = theMap.itemLookup( m_areaIDs[ pos ] );
+      if ( area == NULL || area->getGfxData() == NULL ||
+           area->getGfxData()->getNbrPolygons() == 0 ||
+           area->getGfxData()->getNbrCoordinates( 0 ) == 0 ) {
+         continue;
+      }
+      const GfxData* gfx = area->getGfxData();
+      m_polygons[ pos ] = new PreparedGfxData( *gfx );
+      if ( gfx->getMinLon() > gfx->getMaxLon() ) {
+         m_alwaysTested.push_back( pos );
+      } else {
+         m_tree.add( gfx->getMinLat(), gfx->getMaxLat(), 
+                     gfx->getMinLon(), gfx->getMaxLon(), pos );
+      }
+   }
+   m_tree.build();
+}
+
+GMSAreaIndex::~GMSAreaIndex() {
+   STLUtility::deleteValues( m_polygons );
+}
+
+void
+GMSAreaIndex::getCandidates( const vector<MC2Coordinate>& coords,
+                             vector<uint32>& positions ) const {
+   positions = m_alwaysTested;
+   for ( uint32 i = 0; i < coords.size(); ++i ) {
+      m_tree.getContaining( coords[ i ].lat, coords[ i ].lon, positions );
+   }
+   std::sort( positions.begin(), positions.end() );
+   positions.erase( std::unique( positions.begin(), positions.end() ),
+                    positions.end() );
+}
+
+int
+GMSAreaIndex::insidePolygon( uint32 pos, int32 lat, int32 lon ) const {
+   if ( m_polygons[ pos ] == NULL ) {
+      return 0;
+   }
+   return m_polygons[ pos ]->insidePolygon( lat, lon );
+}
+
+uint32
+GMSAreaIndex::getFirstContaining( int32 lat, int32 lon ) const {
+   vector<uint32> positions;
+   getCandidates( vector<MC2Coordinate>( 1, MC2Coordinate( lat, lon ) ),
+                  positions );
+   for ( uint32 i = 0; i < positions.size(); ++i ) {
+      if ( insidePolygon( positions[ i ], lat, lon ) > 0 ) {
+         return positions[ i ];
+      }
+   }
+   return MAX_UINT32;
+}
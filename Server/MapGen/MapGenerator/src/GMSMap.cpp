@@ -55,6 +55,9 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include "GMSUtility.h"
 #include "GfxConstants.h"
 #include "GfxUtility.h"
+#include "PreparedGfxData.h"
+#include "GMSAreaIndex.h"
+#include "DeleteHelpers.h"
 
 #include "OldExternalConnections.h"
 
@@ -1751,35 +1754,47 @@ GMSMap::addSSIToZipCodesUsingGfx()
    // Everything is OK. Zipcodes not complete yet, so create them by
    // using the gfxdata.
    
+   vector<uint32> zipIDs;
    for (uint32 z=0; z<NUMBER_GFX_ZOOMLEVELS; ++z) {
       for (uint32 i=0; i<getNbrItemsWithZoom(z); ++i) {
          GMSZipCodeItem* zip = dynamic_cast<GMSZipCodeItem*>
                         (getItem(z, i));
          if ( ( zip != NULL ) && ( zip->getGfxData() != NULL ) &&
               ( zip->getNbrItemsInGroup() == 0 ) ) {
-            GfxData* zipGfx = zip->getGfxData();
-            //MC2BoundingBox zipBBox;
-            //zip->getMC2BoundingBox( zipBBox );
-            
-            // Loop through all ssi:s and check if they are inside
-            // the zipcode.
-            for (uint32 sz=0; sz<NUMBER_GFX_ZOOMLEVELS; ++sz) {
-               for (uint32 j=0; j<getNbrItemsWithZoom(sz); ++j) {
-                  GMSStreetSegmentItem* ssi = 
-                     dynamic_cast<GMSStreetSegmentItem*> (getItem(sz, j));
-                  if ( ( ssi != NULL ) && 
-                       ( ssi->getGfxData() != NULL ) &&
-                       ( ssi->getGfxData()->getNbrCoordinates(0) > 0 ) ) {
-                     GfxData* ssiGfx = ssi->getGfxData();
-                     if ( ( zipGfx->insidePolygon( 
-                              ssiGfx->getLat( 0, 0 ),
-                              ssiGfx->getLon( 0, 0 ) ) > 0 ) ||
-                          ( zipGfx->insidePolygon( 
-                              ssiGfx->getLastLat( 0 ),
-                              ssiGfx->getLastLon( 0 ) ) > 0 ) ) {
-                        bindItemToGroup( ssi, zip );
-                     }
-                  }
+            zipIDs.push_back( zip->getID() );
+         }
+      }
+   }
+   if ( zipIDs.empty() ) {
+      return true;
+   }
+   GMSAreaIndex zipIndex( *this, zipIDs );
+
+   // Loop through all ssi:s and add them to the zipcodes they are
+   // inside. The zipcodes are checked in the same order as above.
+   vector<MC2Coordinate> coords( 2 );
+   vector<uint32> candidates;
+   for (uint32 sz=0; sz<NUMBER_GFX_ZOOMLEVELS; ++sz) {
+      for (uint32 j=0; j<getNbrItemsWithZoom(sz); ++j) {
+         GMSStreetSegmentItem* ssi = 
+            dynamic_cast<GMSStreetSegmentItem*> (getItem(sz, j));
+         if ( ( ssi != NULL ) && 
+              ( ssi->getGfxData() != NULL ) &&
+              ( ssi->getGfxData()->getNbrCoordinates(0) > 0 ) ) {
+            GfxData* ssiGfx = ssi->getGfxData();
+            coords[ 0 ] = MC2Coordinate( ssiGfx->getLat( 0, 0 ),
+                                         ssiGfx->getLon( 0, 0 ) );
+            coords[ 1 ] = MC2Coordinate( ssiGfx->getLastLat( 0 ),
+                                         ssiGfx->getLastLon( 0 ) );
+            zipIndex.getCandidates( coords, candidates );
+            for ( uint32 c = 0; c < candidates.size(); ++c ) {
+               uint32 pos = candidates[ c ];
+               if ( ( zipIndex.insidePolygon( 
+                        pos, coords[ 0 ].lat, coords[ 0 ].lon ) > 0 ) ||
+                    ( zipIndex.insidePolygon( 
+                        pos, coords[ 1 ].lat, coords[ 1 ].lon ) > 0 ) ) {
+                  bindItemToGroup( ssi, static_cast<GMSZipCodeItem*>(
+                                      itemLookup( zipIndex.getAreaID( pos ) ) ) );
                }
             }
          }
@@ -2274,6 +2289,9 @@ GMSMap::setCityPartLocation()
 {
    int nbrLocationsSet = 0;
 
+   // The city parts of each bua, created when first needed.
+   typedef map<uint32, GMSAreaIndex*> cityPartIndexes_t;
+   STLUtility::AutoContainerMap<cityPartIndexes_t> cityPartIndexes;
 
    // Set logical location for the all the "other" items in the city
    // parts (Items with type != Municipal, BuiltUpArea and CityPart
@@ -2294,25 +2312,35 @@ GMSMap::setCityPartLocation()
             // (it is located in a bua)
             OldBuiltUpAreaItem* bua = static_cast<OldBuiltUpAreaItem*>
                (getRegion( curItem, ItemTypes::builtUpAreaItem ) );
-            uint32 j=0;
-            
-            OldCityPartItem* curCityPart = NULL;
-            while ( (bua != NULL) &&
-                    (j < bua->getNbrItemsInGroup() )) {
-               uint32 curItemID = bua->getItemNumber(j);
-               curCityPart = 
-                  dynamic_cast<OldCityPartItem*>(itemLookup(curItemID));
-               if (curCityPart != NULL) {
-                  int32 lat = curItem->getGfxData()->getLat(0,0);
-                  int32 lon = curItem->getGfxData()->getLon(0,0);
-                  if (curCityPart->getGfxData()
-                        ->insidePolygon(lat, lon) > 0) {
-                     addRegionToItem( curItem, curCityPart );
-                     nbrLocationsSet++;
-                     j = MAX_UINT32-1; //To be sure to break the while-loop
+            if ( bua == NULL ) {
+               continue;
+            }
+
+            cityPartIndexes_t::iterator it = 
+               cityPartIndexes.find( bua->getID() );
+            if ( it == cityPartIndexes.end() ) {
+               // The city parts of the bua, in group order
+               vector<uint32> cityPartIDs;
+               for ( uint32 j = 0; j < bua->getNbrItemsInGroup(); ++j ) {
+                  uint32 curItemID = bua->getItemNumber(j);
+                  OldCityPartItem* curCityPart = 
+                     dynamic_cast<OldCityPartItem*>(itemLookup(curItemID));
+                  if ( curCityPart != NULL ) {
+                     cityPartIDs.push_back( curItemID );
                   }
                }
-               j++;
+               it = cityPartIndexes.insert( 
+                  make_pair( bua->getID(),
+                             new GMSAreaIndex( *this, cityPartIDs ) ) ).first;
+            }
+            
+            int32 lat = curItem->getGfxData()->getLat(0,0);
+            int32 lon = curItem->getGfxData()->getLon(0,0);
+            uint32 pos = it->second->getFirstContaining( lat, lon );
+            if ( pos != MAX_UINT32 ) {
+               addRegionToItem( curItem, 
+                                itemLookup( it->second->getAreaID( pos ) ) );
+               nbrLocationsSet++;
             }
          }
       }
@@ -2391,14 +2419,15 @@ GMSMap::updateLocation(OldBuiltUpAreaItem* bua)
    
    // Go through all streetsegmentitems and set update their location
    // if they are inside this item.
+   PreparedGfxData buaGfx( *gfx );
    for (uint32 z = 0; z < NUMBER_GFX_ZOOMLEVELS; z++) {
       for (uint32 i = 0; i < getNbrItemsWithZoom(z); i++) {
          OldStreetSegmentItem* curSSI = 
             dynamic_cast<OldStreetSegmentItem*> (getItem(z,i));
          if ((curSSI != NULL) && (curSSI->getGfxData() != NULL)) {
             // Check if the ssi is inside 
-            if (gfx->insidePolygon(curSSI->getGfxData()->getLastLat(0),
-                                   curSSI->getGfxData()->getLastLon(0))) {
+            if (buaGfx.insidePolygon(curSSI->getGfxData()->getLastLat(0),
+                                     curSSI->getGfxData()->getLastLon(0))) {
                // Update location for the ssi.
                addRegionToItem( curSSI, bua );
             }
@@ -2463,6 +2492,13 @@ GMSMap::setItemLocation(ItemTypes::itemType type,
          (type == ItemTypes::builtUpAreaItem &&
           NationalProperties::useIndexAreas(getCountryCode(),
                                             getMapOrigin()) );
+
+   // The geometry of the items with type "type", created when first
+   // needed.
+   auto_ptr<GMSAreaIndex> typeIndex;
+   vector<MC2Coordinate> coords;
+   vector<uint32> candidates;
+
    // Set the type in all the items
    uint32 nbrLocationsSet = 0;
    for ( int z=0; z<NUMBER_GFX_ZOOMLEVELS; z++) {
@@ -2601,98 +2637,118 @@ GMSMap::setItemLocation(ItemTypes::itemType type,
                      if ( findByGfxData ) {
                         // There exists gfx datas for the item type to set
                         // location to.
+                        if ( typeIndex.get() == NULL ) {
+                           vector<uint32> ids;
+                           for ( uint32 j = 0; j < typeIDs.getSize(); ++j ) {
+                              ids.push_back( typeIDs.getElementAt( j ) );
+                           }
+                           typeIndex.reset( new GMSAreaIndex( *this, ids ) );
+                        }
+
+                        // In case we are setting the location of a 
+                        // builtup area or citypart, 
+                        // we need to check that the item
+                        // is actually inside a cityareaitem. This
+                        // check is done by picking a random coordinate
+                        // inside the item.
+                        bool groupItem = 
+                           ( curItem->getItemType() == 
+                             ItemTypes::builtUpAreaItem ) ||
+                           ( curItem->getItemType() == 
+                             ItemTypes::cityPartItem );
+                        coords.clear();
+                        if ( groupItem ) {
+                           int32 randLat;
+                           int32 randLon;
+                           if (! curGfx->getRandomCoordinateInside(
+                                             randLat,
+                                             randLon)) {
+                              mc2log << error 
+                                     << "Could not find a random "
+                                     << "coordinate inside group item "
+                                     << getName(curItem->
+                                           getStringIndex(0))
+                                     << endl;
+                           } else {
+                              coords.push_back( 
+                                 MC2Coordinate( randLat, randLon ) );
+                           }
+                        } else {
+                           coords.push_back( 
+                              MC2Coordinate( curGfx->getLat(0,0), 
+                                             curGfx->getLon(0,0) ) );
+                           coords.push_back( 
+                              MC2Coordinate( 
+                                 curGfx->getLat(0,lastCoordIdx),
+                                 curGfx->getLon(0,lastCoordIdx) ) );
+                        }
+                        // Only the items whose bounding box contains
+                        // the coordinates, in typeIDs order.
+                        typeIndex->getCandidates( coords, candidates );
+                        if ( coords.empty() ) {
+                           candidates.clear();
+                        }
 
                         bool found = false;
                         uint32 j = 0;
-                        while ((j < typeIDs.getSize()) && (!found))  {
-                           // Check OldItem with correct type number j
-                           GfxData* typeGfx = 
-                              itemLookup(typeIDs.getElementAt(j))
-                              ->getGfxData();
-                           mc2dbg8 << "   typeGfx->getNbrcoords()=" 
-                                   << typeGfx->getNbrCoordinates(0) << endl;
-                           // In case we are setting the location of a 
-                           // builtup area or citypart, 
-                           // we need to check that the item
-                           // is actually inside a cityareaitem. This
-                           // check is done by picking a random coordinate
-                           // inside the item.
-                           
-                           if ( ( curItem->getItemType() == 
-                                  ItemTypes::builtUpAreaItem ) ||
+                        for ( uint32 c = 0; 
+                              c < candidates.size() && ! found; ++c ) {
+                           j = candidates[ c ];
+                           if ( groupItem ) {
+                              found = typeIndex->insidePolygon( 
+                                 j, coords[ 0 ].lat, coords[ 0 ].lon ) == 2;
+                           } else { // No bua or citypart
+                              found = 
+                                 ( typeIndex->insidePolygon( 
+                                    j, coords[ 0 ].lat, 
+                                    coords[ 0 ].lon ) > 0 ) ||
+                                 ( typeIndex->insidePolygon( 
+                                    j, coords[ 1 ].lat, 
+                                    coords[ 1 ].lon ) > 0 );
+                           }
+                        }
+
+                        if (found) {
+                           if ( ! onlyUpdateNonValid ) {
+                              clearRegionsForItem( curItem, type );
+                           }
+                           addRegionToItem( curItem, 
+                                            typeIDs.getElementAt(j) );
+                           nbrLocationsSet++;
+
+                           // add the city parts to the bua
+                           // (compare EDR:handleAddCitypartRecord)
+                           if ( ( type == ItemTypes::builtUpAreaItem ) &&
                                 ( curItem->getItemType() == 
                                   ItemTypes::cityPartItem ) ) {
-                              int32 randLat;
-                              int32 randLon;
-                              if (! curGfx->getRandomCoordinateInside(
-                                                randLat,
-                                                randLon)) {
-                                 mc2log << error 
-                                        << "Could not find a random "
-                                        << "coordinate inside group item "
-                                        << getName(curItem->
-                                              getStringIndex(0))
-                                        << endl;
-                              } 
-                              else if ( typeGfx->
-                                        insidePolygon(randLat, 
-                                                      randLon) == 2) {
-                                 found = true;
-                              }
-                           } else // No bua or citypart
-                              if ((typeGfx->insidePolygon(
-                                   curGfx->getLat(0,0), 
-                                   curGfx->getLon(0,0)) > 0) ||
-                                   (typeGfx->insidePolygon(
-                                      curGfx->getLat(0,lastCoordIdx),
-                                      curGfx->getLon(0,lastCoordIdx)) > 0) ) {
-                                 found = true;
+                              OldBuiltUpAreaItem* bua = 
+                                 static_cast<OldBuiltUpAreaItem*>
+                                 (itemLookup(typeIDs.getElementAt(j)));
+                              if (bua != NULL) {
+                                 bua->addItem(curItem->getID());
+                                 mc2dbg8 << "Adding citypart '" 
+                                    << getFirstItemName(curItem) 
+                                    << "' -> bua '" << getFirstItemName(bua)
+                                    << "'" << endl;
                               }
+                           }
                            
-                           if (found) {
-                              if ( ! onlyUpdateNonValid ) {
-                                 clearRegionsForItem( curItem, type );
-                              }
-                              addRegionToItem( curItem, 
-                                               typeIDs.getElementAt(j) );
-                              nbrLocationsSet++;
-
-                              // add the city parts to the bua
-                              // (compare EDR:handleAddCitypartRecord)
-                              if ( ( type == ItemTypes::builtUpAreaItem ) &&
-                                   ( curItem->getItemType() == 
-                                     ItemTypes::cityPartItem ) ) {
-                                 OldBuiltUpAreaItem* bua = 
-                                    static_cast<OldBuiltUpAreaItem*>
-                                    (itemLookup(typeIDs.getElementAt(j)));
-                                 if (bua != NULL) {
-                                    bua->addItem(curItem->getID());
-                                    mc2dbg8 << "Adding citypart '" 
-                                       << getFirstItemName(curItem) 
-                                       << "' -> bua '" << getFirstItemName(bua)
-                                       << "'" << endl;
-                                 }
-                              }
-                              
-                              DEBUG4(
-                                 uint32 curStringIndex = 
-                                 curItem->getStringIndex(0);
-                                 if (curStringIndex != 0) 
-                                 mc2dbg4 << getName(curStringIndex)
-                                         << " is located in "
-                                         << getItemName(
-                                            typeIDs.getElementAt(j))
-                                         << " (ID = " 
-                                         << typeIDs.getElementAt(j)
-                                         << ", type = " 
-                                         << (uint32) type << ")"
-                                         << endl;
-                              );
+                           DEBUG4(
+                              uint32 curStringIndex = 
+                              curItem->getStringIndex(0);
+                              if (curStringIndex != 0) 
+                              mc2dbg4 << getName(curStringIndex)
+                                      << " is located in "
+                                      << getItemName(
+                                         typeIDs.getElementAt(j))
+                                      << " (ID = " 
+                                      << typeIDs.getElementAt(j)
+                                      << ", type = " 
+                                      << (uint32) type << ")"
+                                      << endl;
+                           );
 
-                           } else {
-                              j++;
-                           }
-                        }//while
+                        }
                      }
                   } else if ( (curItem->getItemType() == type) &&
                               (typeIDs.linearSearch(curItem->getID())
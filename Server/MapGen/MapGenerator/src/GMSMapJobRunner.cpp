@@ -0,0 +1,217 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "GMSMapJobRunner.h"
+
+#include "GMSMap.h"
+#include "OldGenericMapHeader.h"
+#include "MapBits.h"
+#include "File.h"
+#include "ISABThread.h"
+#include "DebugClock.h"
+
+namespace {
+
+/**
+ *   The maps of a stage and the times summed over them. Shared by
+ *   the threads running the stage.
+ */
+class JobState {
+public:
+   JobState( GMSMapJob& job, const MC2String& mapPath,
+             const vector<uint32>& mapIDs )
+         : m_job( job ),
+           m_mapPath( mapPath ),
+           m_mapIDs( mapIDs ),
+           m_nextIndex( 0 ),
+           m_nbrFailed( 0 ),
+           m_loadTime( 0 ),
+           m_processTime( 0 ),
+           m_saveTime( 0 ) {
+   }
+
+   /**
+    * Processes maps until there are no more maps to process.
+    */
+   void processMaps() {
+      uint32 mapID = MAX_UINT32;
+      while ( getNextMap( mapID ) ) {
+         processMap( mapID );
+      }
+   }
+
+   uint32 getNbrFailed() const { return m_nbrFailed; }
+
+   /// Prints the summed times.
+   void printTimes( uint32 wallTime ) const {
+      mc2log << info << "[GMSMapJobRunner]: " << m_job.getName() 
+             << " done for " << m_mapIDs.size() << " maps in " 
+             << wallTime << " ms, load " << m_loadTime
+             << " ms, process " << m_processTime << " ms, save "
+             << m_saveTime << " ms, " << m_nbrFailed << " failed" << endl;
+   }
+
+private:
+   /// Gets the id of the next map to process.
+   bool getNextMap( uint32& mapID ) {
+      ISABSync sync( m_mutex );
+      if ( m_nextIndex >= m_mapIDs.size() ) {
+         return false;
+      }
+      mapID = m_mapIDs[ m_nextIndex++ ];
+      return true;
+   }
+
+   /// Loads, processes and saves one map.
+   void processMap( uint32 mapID ) {
+      DebugClock loadClock;
+      OldGenericMap* curMap = m_job.createMap( mapID, m_mapPath.c_str() );
+      uint32 loadTime = loadClock.getTime();
+      if ( curMap == NULL ) {
+         mc2log << error << "[GMSMapJobRunner]: Could not load map 0x"
+                << hex << mapID << dec << endl;
+         addResult( true, loadTime, 0, 0 );
+         return;
+      }
+
+      DebugClock processClock;
+      GMSMapJob::result_t res = m_job.processMap( curMap );
+      uint32 processTime = processClock.getTime();
+
+      DebugClock saveClock;
+      if ( res == GMSMapJob::saveMap || res == GMSMapJob::failedSaveMap ) {
+         curMap->save();
+      }
+      uint32 saveTime = saveClock.getTime();
+      delete curMap;
+
+      mc2dbg1 << "[GMSMapJobRunner]: " << m_job.getName() << " map 0x"
+              << hex << mapID << dec << " load " << loadTime 
+              << " ms, process " << processTime << " ms, save "
+              << saveTime << " ms" << endl;
+
+      addResult( res == GMSMapJob::failed || 
+                 res == GMSMapJob::failedSaveMap,
+                 loadTime, processTime, saveTime );
+   }
+
+   /// Adds the outcome of one map.
+   void addResult( bool failed, uint32 loadTime, uint32 processTime,
+                   uint32 saveTime ) {
+      ISABSync sync( m_mutex );
+      if ( failed ) {
+         ++m_nbrFailed;
+      }
+      m_loadTime += loadTime;
+      m_processTime += processTime;
+      m_saveTime += saveTime;
+   }
+
+   GMSMapJob& m_job;
+   const MC2String& m_mapPath;
+   const vector<uint32>& m_mapIDs;
+
+   /// Protects the members below.
+   ISABMutex m_mutex;
+   /// Index in m_mapIDs of the next map to process.
+   uint32 m_nextIndex;
+   uint32 m_nbrFailed;
+   /// Summed times in ms.
+   uint64 m_loadTime;
+   uint64 m_processTime;
+   uint64 m_saveTime;
+};
+
+/**
+ *   Thread processing maps from a JobState.
+ */
+class MapJobThread : public ISABThread {
+public:
+   explicit MapJobThread( JobState& state )
+         : ISABThread( NULL, "GMSMapJobThread" ),
+           m_state( state ) {
+   }
+
+   void run() {
+      m_state.processMaps();
+   }
+
+private:
+   JobState& m_state;
+};
+
+}
+
+OldGenericMap*
+GMSMapJob::createMap( uint32 mapID, const char* mapPath ) const
+{
+   return GMSMap::createMap( mapID, mapPath );
+}
+
+GMSMapJobRunner::GMSMapJobRunner( const char* mapPath, uint32 nbrThreads )
+      : m_mapPath( mapPath ),
+        m_nbrThreads( MAX( nbrThreads, 1 ) ) {
+}
+
+vector<uint32>
+GMSMapJobRunner::getMapIDs( const char* mapPath, 
+                            uint32 startMapID, uint32 endMapID ) {
+   vector<uint32> mapIDs;
+   for ( uint32 mapID = startMapID; mapID <= endMapID; 
+         mapID = MapBits::nextMapID( mapID ) ) {
+      // The header only builds the file name, nothing is loaded.
+      OldGenericMapHeader header( mapID, mapPath );
+      MC2String fileName = header.getFilename();
+      if ( ! File::fileExist( fileName ) &&
+           ! File::fileExist( fileName + ".bz2" ) &&
+           ! File::fileExist( fileName + ".gz" ) ) {
+         break;
+      }
+      mapIDs.push_back( mapID );
+   }
+   return mapIDs;
+}
+
+uint32
+GMSMapJobRunner::run( GMSMapJob& job, uint32 startMapID, uint32 endMapID )
+{
+   return run( job, getMapIDs( m_mapPath.c_str(), startMapID, endMapID ) );
+}
+
+uint32
+GMSMapJobRunner::run( GMSMapJob& job, const vector<uint32>& mapIDs )
+{
+   DebugClock wallClock;
+   uint32 nbrThreads = MIN( m_nbrThreads, MAX( mapIDs.size(), 1 ) );
+   mc2log << info << "[GMSMapJobRunner]: " << job.getName() << " for "
+          << mapIDs.size() << " maps using " << nbrThreads 
+          << " thread(s)" << endl;
+
+   JobState state( job, m_mapPath, mapIDs );
+   if ( nbrThreads <= 1 ) {
+      state.processMaps();
+   } else {
+      vector<ISABThreadHandle> threads;
+      for ( uint32 i = 0; i < nbrThreads; ++i ) {
+         threads.push_back( new MapJobThread( state ) );
+         threads.back()->start();
+      }
+      for ( uint32 i = 0; i < threads.size(); ++i ) {
+         threads[ i ]->join();
+      }
+   }
+
+   state.printTimes( wallClock.getTime() );
+   return state.getNbrFailed();
+}
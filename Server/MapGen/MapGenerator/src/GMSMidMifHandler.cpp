@@ -41,14 +41,16 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include "GMSCartographicItem.h"
 
 #include "GMSItem.h"
+#include "MifGfxReader.h"
 
 #include "Utility.h"
 #include "Stack.h"
 
 
-GMSMidMifHandler::GMSMidMifHandler(GMSMap* theMap)
+GMSMidMifHandler::GMSMidMifHandler(GMSMap* theMap, uint32 nbrParseThreads)
 {
    m_map = theMap;
+   m_nbrParseThreads = nbrParseThreads;
    m_mapGfxData = NULL;
    m_midIdRefLoaded = false;
 };
@@ -107,7 +109,9 @@ GMSMidMifHandler::createItemsFromMidMif(
    strcat(mifFileName, ".mif");
 
    ifstream midFile(midFileName);
-   ifstream mifFile(mifFileName);
+   // The mif features are parsed in parallel, ahead of the mid rows.
+   MifGfxReader mifReader(m_nbrParseThreads);
+   bool mifOpen = mifReader.open(mifFileName);
 
    delete [] midFileName;
    delete [] mifFileName;
@@ -219,15 +223,8 @@ GMSMidMifHandler::createItemsFromMidMif(
       }
    }
    
-   // Read the mif header.
-   CoordinateTransformer::format_t coordsys;
-   bool normalCoordinateOrder;
-   uint32 utmzone;
-   int32 falseNorthing, falseEasting;
-   mc2dbg1 << "Reading mif-header of the item-file." << endl;
-   if (!GMSGfxData::readMifHeader(mifFile, 
-                                  coordsys, normalCoordinateOrder,
-                                  utmzone, falseNorthing, falseEasting)) {
+   // The mif header was read when opening the mif file.
+   if (!mifOpen) {
       mc2log << fatal << "Could not read mif header" << endl;
       MC2_ASSERT(false);
       return -1;
@@ -252,7 +249,8 @@ GMSMidMifHandler::createItemsFromMidMif(
    char coordbuffer[maxLineLength];
    coordbuffer[0] = '\0';
    m_midLineNbr = 1;
-   while ( !midFile.eof() && !mifFile.eof() ) {
+   bool mifLeft = true;
+   while ( !midFile.eof() && mifLeft ) {
       
       // read the id-column from the mid-file, check that something
       // is read to go on.
@@ -301,13 +299,17 @@ GMSMidMifHandler::createItemsFromMidMif(
          // all names
          midFile.getline(inbuffer, maxLineLength, '"');
          
-         // create the midmif item gfxData
-         GMSGfxData* curGfx = GMSGfxData::createNewGfxData(m_map, false);
+         // create the midmif item gfxData from the parsed mif feature
          mc2dbg8 << "Creating gfxData for item "<< m_midLineNbr << "." << endl;
-         bool gfxOK = curGfx->createGfxFromMif(mifFile,
-                                  coordsys, normalCoordinateOrder,
-                                  utmzone, falseNorthing, falseEasting);
-         if ( ! gfxOK ) {
+         GMSGfxData* mifGfx = NULL;
+         mifLeft = mifReader.readNext(mifGfx);
+         bool gfxOK = (mifGfx != NULL);
+         GMSGfxData* curGfx = NULL;
+         if ( gfxOK ) {
+            curGfx = GMSGfxData::createNewGfxData(m_map, mifGfx);
+            delete mifGfx;
+         } else {
+            curGfx = GMSGfxData::createNewGfxData(m_map, false);
             mc2log << warn << "Could not create gfx from mif of mid line " 
                    << m_midLineNbr << endl;
          }
@@ -755,28 +757,30 @@ GMSMidMifHandler::createItemsFromMidMif(
              << " m_midLineNbr=" << m_midLineNbr << endl;
       MC2_ASSERT(false);
    }
-   if ( !mifFile.eof() ) {
-      // we have not yet read the eof-character, test to read it
-      // to see if there really are more thing to read, or not
-      char tmp[maxLineLength];
-      tmp[0] = '\0';
-      mifFile >> tmp;
-      if ( !mifFile.eof() ) {
-         mc2log << error << "Mif file not end-of-file!" << endl
-                << " Can be different number of midrows/number of miffeatures"
-                << endl;
-         mc2dbg << "Remaining data(within \" signs): \"" << tmp << "\"" 
-                << endl;
-         mc2dbg << "OK mid rows read:     " << nbrOkMidRows << endl;
-         mc2dbg << "Not OK mid rows read: " << nbrNotOkMidRows << endl;
-         mc2dbg << "OK mif rows features: " << nbrOkMifFeatures << endl;
-         mc2dbg << "nbrItemsInFile=" << nbrItemsInFile
-                << " m_midLineNbr=" << m_midLineNbr << endl;
-         mc2dbg << " Search for \"Strange ....\"" << endl;
-         MC2_ASSERT(false);
+   
+   GMSGfxData* remainingGfx = NULL;
+   if ( mifLeft && mifReader.readNext(remainingGfx) ) {
+      mc2log << error << "Mif file not end-of-file!" << endl
+             << " Can be different number of midrows/number of miffeatures"
+             << endl;
+      if ( remainingGfx != NULL && remainingGfx->getNbrPolygons() > 0 ) {
+         mc2dbg << "Remaining feature starts at " 
+                << remainingGfx->getLat(0,0) << " " 
+                << remainingGfx->getLon(0,0) << endl;
       }
+      delete remainingGfx;
+      mc2dbg << "OK mid rows read:     " << nbrOkMidRows << endl;
+      mc2dbg << "Not OK mid rows read: " << nbrNotOkMidRows << endl;
+      mc2dbg << "OK mif rows features: " << nbrOkMifFeatures << endl;
+      mc2dbg << "nbrItemsInFile=" << nbrItemsInFile
+             << " m_midLineNbr=" << m_midLineNbr << endl;
+      mc2dbg << " Search for \"Strange ....\"" << endl;
+      MC2_ASSERT(false);
    }
    
+   mc2dbg1 << "Parsed the mif features in " << mifReader.getParseTime()
+           << " ms using " << m_nbrParseThreads << " thread(s)" << endl;
+   
    if (m_countryGfx != NULL) {
       //delete m_countryGfx;
       m_countryGfx = NULL;
@@ -24,6 +24,7 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include "TimeUtility.h"
 #include "MapBits.h"
 #include "Math.h"
+#include "ISABThread.h"
 
 uint32
 GMSPolyUtility::rmPolygonDefectsAndUnnecessaryCoords( OldGenericMap* theMap )
@@ -56,8 +57,8 @@ GMSPolyUtility::rmPolygonDefectsAndUnnecessaryCoords( OldGenericMap* theMap )
          }
 
          // store item id in member variable for debug and error print
-         GMSPolyUtility::myItemID = item->getID();
-         GMSPolyUtility::myMapID = theMap->getMapID();
+         processed().itemID = item->getID();
+         processed().mapID = theMap->getMapID();
 
          // closed polygons, remove polygon defects
          nbrClosedGfx++;
@@ -103,8 +104,8 @@ GMSPolyUtility::rmPolygonDefectsAndUnnecessaryCoordsFromClosed(
                                          polygon.end() );
       // If number of coords = 0, dont add polygon!
       if ( output.size() == 0 ) {
-         mc2dbg1 << "Item " << GMSPolyUtility::myItemID
-                 << " map " << GMSPolyUtility::myMapID
+         mc2dbg1 << "Item " << processed().itemID
+                 << " map " << processed().mapID
                  << " No coords in poly " << p << " after rmPolyDefects"
                  << endl;
       }
@@ -126,7 +127,7 @@ GMSPolyUtility::rmPolygonDefectsAndUnnecessaryCoordsFromClosed(
    if ( gfx->equals(newGfx) ) {
       return NULL;
    } else {
-      mc2dbg8 << "changed item " << GMSPolyUtility::myItemID << " "
+      mc2dbg8 << "changed item " << processed().itemID << " "
               << " nbrcoords " << gfx->getNbrCoordinates(0) 
               << " -> " << newGfx->getNbrCoordinates(0) << endl;
    }
@@ -170,8 +171,8 @@ GMSPolyUtility::eliminateSelfTouch( OldGenericMap* theMap,
          }
          
          // store item id in member variable for debug and error print
-         GMSPolyUtility::myItemID = item->getID();
-         GMSPolyUtility::myMapID = theMap->getMapID();
+         processed().itemID = item->getID();
+         processed().mapID = theMap->getMapID();
 
          GMSGfxData* gfx = item->getGfxData();
          if ( gfx == NULL ) {
@@ -204,8 +205,8 @@ GMSPolyUtility::eliminateSelfTouch( OldGenericMap* theMap,
             // Do not change this print, used for error detection
             // in the makemaps logs
             mc2log << error << here << " FCR_ELIMST: "
-                   << " map " << GMSPolyUtility::myMapID << " item "
-                   << GMSPolyUtility::myItemID
+                   << " map " << processed().mapID << " item "
+                   << processed().itemID
                    << " item type: " << int(elimItemType)
                    << endl;
          } 
@@ -274,8 +275,8 @@ GMSPolyUtility::eliminateHoles( OldGenericMap* theMap,
          }
          
          // store item id in member variable for debug and error print
-         GMSPolyUtility::myItemID = item->getID();
-         GMSPolyUtility::myMapID = theMap->getMapID();
+         processed().itemID = item->getID();
+         processed().mapID = theMap->getMapID();
 
          GMSGfxData* gfx = item->getGfxData();
          if ( gfx == NULL ) {
@@ -316,8 +317,8 @@ GMSPolyUtility::eliminateHoles( OldGenericMap* theMap,
             // Do not change this print, used for error detection
             // in the makemaps logs
             mc2log << error << here << " FCR_FALU: "
-                   << " map " << GMSPolyUtility::myMapID << " item "
-                   << GMSPolyUtility::myItemID
+                   << " map " << processed().mapID << " item "
+                   << processed().itemID
                    << " item type: " << int(elimItemType)
                    << endl;
          }
@@ -392,8 +393,8 @@ GMSPolyUtility::eliminateHoles( GMSGfxData* gfx,
    // if they do return NULL
    bool holesAtTouching = holesAreTouching(gfx, holeHierarchy);
    if ( holesAtTouching ) {
-      mc2log << error << here << " FCR  map " << GMSPolyUtility::myMapID 
-             << " item " << GMSPolyUtility::myItemID 
+      mc2log << error << here << " FCR  map " << processed().mapID 
+             << " item " << processed().itemID 
              << " has holes touching" << endl;
       hasProblems = true;
       return NULL;
@@ -434,8 +435,8 @@ GMSPolyUtility::eliminateHoles( GMSGfxData* gfx,
                  << endl;
          if ( convHull == NULL ) {
             mc2log << error << here << " FCR "
-                   << " map " << GMSPolyUtility::myMapID << " item "
-                   << GMSPolyUtility::myItemID
+                   << " map " << processed().mapID << " item "
+                   << processed().itemID
                    << " poly " << poly << " holeElimRound=" << holeElimRound
                    << " CONV HULL NULL" << endl;
             hasProblems = true;
@@ -527,8 +528,8 @@ GMSPolyUtility::eliminateHoles( GMSGfxData* gfx,
 
                } else if (idxSet.size() > 2 ) {
                   mc2log << error << here << " FCR "
-                         << " map " << GMSPolyUtility::myMapID << " item "
-                         << GMSPolyUtility::myItemID
+                         << " map " << processed().mapID << " item "
+                         << processed().itemID
                          << " More than 2 coordIdx has this coord "
                          << it->first 
                          << " in hole and convex hull of holes" << endl;
@@ -572,14 +573,14 @@ GMSPolyUtility::eliminateHoles( GMSGfxData* gfx,
                   endLat, endLon );
             if ( ! lineOK ) {
                mc2log << error << here << " FCR "
-                      << " map " << GMSPolyUtility::myMapID << " item "
-                      << GMSPolyUtility::myItemID
+                      << " map " << processed().mapID << " item "
+                      << processed().itemID
                       << " Failed to create line towards poly border"
                       << endl;
                // possible to print the convhull to mif
                //char tmpstr[128];
                //sprintf(tmpstr, "__convHull_%d_%d.txt", 
-               //         GMSPolyUtility::myMapID, GMSPolyUtility::myItemID);
+               //         processed().mapID, processed().itemID);
                //ofstream fileX( tmpstr );
                //convHull->printMif( fileX );
 
@@ -731,23 +732,23 @@ GMSPolyUtility::eliminateHoles( GMSGfxData* gfx,
                                       newCoordOnHull.lon );
 
                   mc2log << info << here << " FCR "
-                         << " map " << GMSPolyUtility::myMapID << " item "
-                         << GMSPolyUtility::myItemID 
+                         << " map " << processed().mapID << " item "
+                         << processed().itemID 
                          << " Had to change geometry for " << poly 
                          << " hole " << hole 
                          << " holeCoordIdx " << holeCoordIdx 
                          << " in order to find line intersection" << endl;
                } else { // we have a serious problem
                   mc2log << error << here << " FCR "
-                         << " map " << GMSPolyUtility::myMapID << " item "
-                         << GMSPolyUtility::myItemID 
+                         << " map " << processed().mapID << " item "
+                         << processed().itemID 
                          << " No intersection found for poly " << poly 
                          << " hole " << hole 
                          << " coordOnHull " << coordOnHull
                          << " end " << endLat << ";" << endLon << endl;
                   //char tmpstr[128];
                   //sprintf(tmpstr, "__convHull_%d_%d.txt", 
-                  //         GMSPolyUtility::myMapID, GMSPolyUtility::myItemID);
+                  //         processed().mapID, processed().itemID);
                   //ofstream fileX( tmpstr );
                   //convHull->printMif( fileX );
                   
@@ -923,8 +924,8 @@ GMSPolyUtility::eliminateHoles( GMSGfxData* gfx,
          mc2dbg8 << "keep poly " << polyNbr << endl;
          if ( ! newGfx->addPolygon( gfx, false, polyNbr) ) {
             mc2log << error << here << " FCR "
-                   << " map " << GMSPolyUtility::myMapID << " item "
-                   << GMSPolyUtility::myItemID 
+                   << " map " << processed().mapID << " item "
+                   << processed().itemID 
                    << " Problem adding gfx poly " << polyNbr 
                    << " to new gfx" << endl;
             hasProblems = true;
@@ -987,8 +988,8 @@ GMSPolyUtility::eliminateSelfTouch( GMSGfxData* origGfx,
             // Might be a polygon that failed on eliminateHoles
             // so there are holes remaining
             mc2log << error << here << " FCR "
-                   << " map " << GMSPolyUtility::myMapID << " item "
-                   << GMSPolyUtility::myItemID 
+                   << " map " << processed().mapID << " item "
+                   << processed().itemID 
                    << " Problem with clockwise in loop " 
                    << nbrLoops << " poly=" << p << " firstCoord=" 
                    << gfx->getLat(p,0) << ";" << gfx->getLon(p,0)
@@ -1047,8 +1048,8 @@ GMSPolyUtility::eliminateSelfTouch( GMSGfxData* origGfx,
                      // reversed line.
                   } else {
                      mc2log << error << here << " FCR "
-                            << " map " << GMSPolyUtility::myMapID << " item "
-                            << GMSPolyUtility::myItemID
+                            << " map " << processed().mapID << " item "
+                            << processed().itemID
                             << " Coord " << cit->first
                             << " is used " << idxSet.size()
                             << " times in poly " << p << endl;
@@ -1069,8 +1070,8 @@ GMSPolyUtility::eliminateSelfTouch( GMSGfxData* origGfx,
          mc2dbg8 << " nbrCoordsInPoly=" << nbrCoordsInPoly << endl;
          if ( selfTouchingCoordIdxs.size() == 0 ) {
             mc2log << error << here << " FCR "
-                   << " map " << GMSPolyUtility::myMapID << " item "
-                   << GMSPolyUtility::myItemID
+                   << " map " << processed().mapID << " item "
+                   << processed().itemID
                    << " poly " << p << "Problem " << endl;
             hasProblems = true;
             return NULL;
@@ -1115,8 +1116,8 @@ GMSPolyUtility::eliminateSelfTouch( GMSGfxData* origGfx,
             // this cannot happen?
             cout << " poly " << p << " is not ST" << endl;
             mc2log << error << here << " FCR "
-                   << " map " << GMSPolyUtility::myMapID << " item "
-                   << GMSPolyUtility::myItemID
+                   << " map " << processed().mapID << " item "
+                   << processed().itemID
                    << "No shared coord in poly " << p << endl;
             hasProblems = true;
             return NULL;
@@ -1184,8 +1185,8 @@ GMSPolyUtility::eliminateSelfTouch( GMSGfxData* origGfx,
             // we could not identify any self-touch-part
             // something is strange
             mc2log << error << here << " FCR "
-                   << " map " << GMSPolyUtility::myMapID << " item "
-                   << GMSPolyUtility::myItemID 
+                   << " map " << processed().mapID << " item "
+                   << processed().itemID 
                    << " Could not identify self-touch-part"
                    << " for poly " << p << " nbrLoops="
                    << nbrLoops << endl;
@@ -1222,8 +1223,8 @@ GMSPolyUtility::eliminateSelfTouch( GMSGfxData* origGfx,
                  << " clockwise=" << stClockWise << endl;
          if ( stGfx->getNbrCoordinates(0) < 3 ) {
             mc2log << error << here << " FCR "
-                   << " map " << GMSPolyUtility::myMapID << " item "
-                   << GMSPolyUtility::myItemID 
+                   << " map " << processed().mapID << " item "
+                   << processed().itemID 
                    << " The self-touch-part only has "
                    << stGfx->getNbrCoordinates(0) << " coords"
                    << " self-touch begin " << stBeginCoord << endl;
@@ -1312,13 +1313,13 @@ GMSPolyUtility::eliminateSelfTouch( GMSGfxData* origGfx,
             GfxData* stTempHullGfx = stGfx->createNewConvexHull();
             if ( stTempHullGfx == NULL ) {
                mc2log << error << here << " FCR "
-                      << " map " << GMSPolyUtility::myMapID << " item "
-                      << GMSPolyUtility::myItemID
+                      << " map " << processed().mapID << " item "
+                      << processed().itemID
                       << " poly " << p << " self-touch begin " 
                       << stBeginCoord << " CONV HULL NULL" << endl;
                char tmpstr[128];
                sprintf(tmpstr, "__stGfx_%d_%d.txt", 
-                        GMSPolyUtility::myMapID, GMSPolyUtility::myItemID);
+                        processed().mapID, processed().itemID);
                ofstream fileX( tmpstr );
                stGfx->printMif( fileX );
                hasProblems = true;
@@ -1365,8 +1366,8 @@ GMSPolyUtility::eliminateSelfTouch( GMSGfxData* origGfx,
             if ( cit == stGfxCoords.end() ) {
                // really strange
                mc2log << error << here << " FCR "
-                      << " map " << GMSPolyUtility::myMapID << " item "
-                      << GMSPolyUtility::myItemID
+                      << " map " << processed().mapID << " item "
+                      << processed().itemID
                       << " The self-touch-part does not"
                       << " share coord " << coordOnHull 
                       << " with the conv hull of the self-touch-part"
@@ -1395,8 +1396,8 @@ GMSPolyUtility::eliminateSelfTouch( GMSGfxData* origGfx,
                   endLat, endLon);
             if ( ! lineOK ) {
                mc2log << error << here << " FCR "
-                      << " map " << GMSPolyUtility::myMapID << " item "
-                      << GMSPolyUtility::myItemID
+                      << " map " << processed().mapID << " item "
+                      << processed().itemID
                       << " Failed to create line towards poly border"
                       << endl;
                hasProblems = true;
@@ -1426,8 +1427,8 @@ GMSPolyUtility::eliminateSelfTouch( GMSGfxData* origGfx,
             if ( ! interSectionFound ) {
                // we have a serious problem
                mc2log << error << here << " FCR "
-                      << " map " << GMSPolyUtility::myMapID << " item "
-                      << GMSPolyUtility::myItemID 
+                      << " map " << processed().mapID << " item "
+                      << processed().itemID 
                       << " No intersection found for poly " << p << endl;
                mc2dbg << "poly=" << p << " coordOnHull " << coordOnHull
                       << " end " << endLat << ";" << endLon << endl;
@@ -1580,8 +1581,8 @@ GMSPolyUtility::eliminateSelfTouch( GMSGfxData* origGfx,
          else {
             // problem with clockwise for the self-touch-part
             mc2log << error << here << " FCR "
-                   << " map " << GMSPolyUtility::myMapID << " item "
-                   << GMSPolyUtility::myItemID 
+                   << " map " << processed().mapID << " item "
+                   << processed().itemID 
                    << " Problem with clockwise for the self-touch-part"
                    << endl;
             GMSGfxData* tmpGfx = GMSGfxData::createNewGfxData(NULL);
@@ -1671,8 +1672,8 @@ GMSPolyUtility::getPolyHoleHierarchy(
       else if (clockWise == 0) { holes.insert(p); }
       else { 
          mc2log << error << here << " FCR "
-                << " map " << GMSPolyUtility::myMapID
-                << " item " << GMSPolyUtility::myItemID 
+                << " map " << processed().mapID
+                << " item " << processed().itemID 
                 << " Could not get clockWise for poly " << p << endl;
          hasProblems = true;
          return false; 
@@ -1766,8 +1767,8 @@ GMSPolyUtility::getPolyHoleHierarchy(
                                    newCoord.lon );
 
                mc2dbg1 << here << " FCR "
-                      << " map " << GMSPolyUtility::myMapID << " item "
-                      << GMSPolyUtility::myItemID 
+                      << " map " << processed().mapID << " item "
+                      << processed().itemID 
                       << " Had to change geometry for poly " << *poly 
                       << " hole " << *hole 
                       << " holeCoordIdx: 0" 
@@ -1782,8 +1783,8 @@ GMSPolyUtility::getPolyHoleHierarchy(
                        << *poly << endl;
                polyMaybeCandidates.insert(*poly);
                mc2log << warn << here << " FCR "
-                      << " map " << GMSPolyUtility::myMapID
-                      << " item " << GMSPolyUtility::myItemID 
+                      << " map " << processed().mapID
+                      << " item " << processed().itemID 
                       << " Hole " << *hole 
                       << " is on the border of poly " << *poly 
                       << " coord " << holeLat << ";" << holeLon 
@@ -1804,8 +1805,8 @@ GMSPolyUtility::getPolyHoleHierarchy(
       }
       if ( polyCandidates.size() == 0 ) {
          mc2log << error << here << " FCR "
-                << " map " << GMSPolyUtility::myMapID
-                << " item " << GMSPolyUtility::myItemID
+                << " map " << processed().mapID
+                << " item " << processed().itemID
                 << " Hole " << *hole << " " << holeLat << ";" 
                 << holeLon << " is not inside any poly!" << endl;
          uint32 hullIndex = getPointOnConvexHull( gfx, *hole );
@@ -1860,8 +1861,8 @@ GMSPolyUtility::getPolyHoleHierarchy(
       it = holeHierarchy.find(*poly);
       if ( it == holeHierarchy.end() ){
          mc2log << error << here << " FCR "
-                << " map " << GMSPolyUtility::myMapID
-                << " item " << GMSPolyUtility::myItemID
+                << " map " << processed().mapID
+                << " item " << processed().itemID
                 << " polysThatMustHaveHoles poly " << *poly
                 << " has no hole!" << endl;
          hasProblems = true;
@@ -1937,8 +1938,8 @@ GMSPolyUtility::createConvexHullOfHolesOfOnePoly(
    } else {
       // Something went wrong.
       mc2log << error << here << " FCR "
-             << " map " << GMSPolyUtility::myMapID
-             << " item " << GMSPolyUtility::myItemID
+             << " map " << processed().mapID
+             << " item " << processed().itemID
              << " Could not create convex hull, allHoleCoords nbrC=" 
              << allHoleCoords->getNbrCoordinates(0) 
              << " coord0=" 
@@ -2002,7 +2003,7 @@ GMSPolyUtility::findPolyBorderIntersectionPoint(
       next += polyStartIdx;
       tmpNextCoordIdx += polyStartIdx;
       if ( polyEndIdx == MAX_UINT32 ) {
-         mc2log << error << here << "Item " << GMSPolyUtility::myItemID
+         mc2log << error << here << "Item " << processed().itemID
                 << " poly " << poly << " polyStartIdx=" << polyStartIdx
                 << ", but no given polyEndIdx" << endl;
          return false;
@@ -2013,7 +2014,7 @@ GMSPolyUtility::findPolyBorderIntersectionPoint(
    if ( polyEndIdx != MAX_UINT32 ) {
       loopAllBorder = false;
       if ( polyStartIdx == MAX_UINT32 ) {
-         mc2log << error << here << "Item " << GMSPolyUtility::myItemID
+         mc2log << error << here << "Item " << processed().itemID
                 << " poly " << poly << " polyEndIdx=" << polyEndIdx
                 << ", but no given polyStartIdx" << endl;
          return false;
@@ -2058,7 +2059,7 @@ GMSPolyUtility::findPolyBorderIntersectionPoint(
          }
          // only if not isLeft -> add to candidates.
          if ( isLeft == 0 ) {
-            mc2log << error << "Item " << GMSPolyUtility::myItemID
+            mc2log << error << "Item " << processed().itemID
                    << " What to do?? - the start point is isLeft=0 "
                    << "- it is on the line from cur-next " << endl;
             return false;
@@ -2148,7 +2149,7 @@ GMSPolyUtility::findPolyBorderIntersectionPoint(
 
       }
       if ( ! foundOne ) {
-         mc2log << error << "Item " << GMSPolyUtility::myItemID
+         mc2log << error << "Item " << processed().itemID
                 << " of " << borderIntersections.size()
                 << " intersection candidates I found none good!" << endl;
          return false;
@@ -2182,8 +2183,16 @@ GMSPolyUtility::getPointOnConvexHull(GMSGfxData* gfx, int polyIndex)
    return result;
 }
 
-uint32 GMSPolyUtility::myItemID = MAX_UINT32;
-uint32 GMSPolyUtility::myMapID = MAX_UINT32;
+namespace {
+/// The ProcessedItem of each thread.
+ISABThreadSpecific<GMSPolyUtility::ProcessedItem> processedItems;
+}
+
+GMSPolyUtility::ProcessedItem&
+GMSPolyUtility::processed()
+{
+   return processedItems.get();
+}
 
 
 bool
@@ -2235,13 +2244,13 @@ GMSPolyUtility::isSelfTouching( GMSGfxData* gfx,
                         gfx->getLon(p,gfx->getNbrCoordinates(p)-1) ) {
                // my first coord is equal to my last coord
                // ok
-               mc2dbg8 << "IST " << GMSPolyUtility::myItemID
+               mc2dbg8 << "IST " << processed().itemID
                        << " intra fake shared p="
                        << p << " " << it->first << endl;
             } else {
                selfTouchingCoords.insert( make_pair(it->first, idxSet) );
                nbrSharedCoords++;
-               mc2dbg8 << "IST " << GMSPolyUtility::myItemID
+               mc2dbg8 << "IST " << processed().itemID
                        << " intra shared p=" 
                        << p << " size=" << idxSet.size()
                        << " "
@@ -2358,8 +2367,8 @@ GMSPolyUtility::drawLineTowardsPolyBorder(
    }
    if ( ! startCoordOK ) {
       mc2log << error << here << " FCR "
-             << " map " << GMSPolyUtility::myMapID << " item "
-             << GMSPolyUtility::myItemID
+             << " map " << processed().mapID << " item "
+             << processed().itemID
              << " Did not find a good startCoord for the line direction"
              << ", coordOnHull " << coordOnHull << endl;
       return false;
@@ -2402,8 +2411,8 @@ GMSPolyUtility::drawLineTowardsPolyBorder(
    int32 tmpEndLat = abs(endLat);
    if ( tmpEndLat > (MAX_INT32/2 -1) ) {
       mc2log << error << here << " FCR "
-             << " map " << GMSPolyUtility::myMapID << " item "
-             << GMSPolyUtility::myItemID
+             << " map " << processed().mapID << " item "
+             << processed().itemID
              << " Invalid latitude (" << endLat << ") for end of line" 
              << ", coordOnHull " << coordOnHull
              << " start=" << startLat << ";" << startLon
@@ -2426,8 +2435,8 @@ GMSPolyUtility::drawLineTowardsPolyBorder(
    int64 tmpEndLon = abs (coordOnHull.lon + int(deltaLonNorm*lineLength) );
    if ( tmpEndLon > MAX_INT32-1) {
       mc2log << error << here << " FCR "
-             << " map " << GMSPolyUtility::myMapID << " item "
-             << GMSPolyUtility::myItemID
+             << " map " << processed().mapID << " item "
+             << processed().itemID
              << " Invalid longitude for end of line" << endl;
       return false;
    }
@@ -2437,8 +2446,8 @@ GMSPolyUtility::drawLineTowardsPolyBorder(
            << " end " << endLat << ";" << endLon << endl;
    if ( polyBbox.contains(endLat,endLon) ) {
       mc2log << error << here << " FCR "
-             << " map " << GMSPolyUtility::myMapID << " item "
-             << GMSPolyUtility::myItemID
+             << " map " << processed().mapID << " item "
+             << processed().itemID
              << " Need to increase the length so the "
              << "end coord is outside the polyBbox" << endl;
       return false;
@@ -2522,8 +2531,8 @@ GMSPolyUtility::holesAreTouching(
          }
          if ( polysSharingTheCoord.size() > 1 ) {
             nbrHolesTouchesCoords++;
-            mc2dbg << "FCR  map " << GMSPolyUtility::myMapID 
-                   << " item " << GMSPolyUtility::myItemID 
+            mc2dbg << "FCR  map " << processed().mapID 
+                   << " item " << processed().itemID 
                    << " has holes touching in " 
                    << it->first.lat << ";" << it->first.lon << endl;
             //return true;
@@ -55,9 +55,9 @@ GMSZipCodeItem::readFromFile(ifstream& infile, char* streetName,
                               char* zipCode, char* zipArea)
 {
 	static const int LINESIZE = 128;
-	static char fstreetname[LINESIZE];
-	static char fzip[LINESIZE];
-	static char fzipcodestr[LINESIZE];
+	char fstreetname[LINESIZE];
+	char fzip[LINESIZE];
+	char fzipcodestr[LINESIZE];
 
 	bool result = infile.getline(fstreetname, LINESIZE);
 	if (result) {
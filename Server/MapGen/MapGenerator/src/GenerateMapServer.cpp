@@ -56,6 +56,8 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include "GMSPolyUtility.h"
 #include "GenericMap.h"
 #include "MapBits.h"
+#include "GMSMapJobRunner.h"
+#include "ISABThread.h"
 
 #include "SysUtility.h"
 #include "Utility.h"
@@ -134,6 +136,7 @@ bool     CL_finishIndexAreas           = false;
 bool     CL_loopAllMaps                = false;
 bool     CL_tryToBuildMapGfxFromMunicipals = false;
 char*    CL_removeDupItemsFromMidMif   = NULL;
+uint32   CL_nbrThreads                 = 1;
 typedef map<uint32, map<uint32, GMSMap::extdata_t>* > danglingEndsByMap_t;
 
 // Forward function declarations
@@ -143,9 +146,10 @@ bool commandLineSemantics(CommandlineOptionHandler &,
                           StringTable::countryCode &);
 bool fileOk(MC2String &, readFile_t &);
 void updateExternalConnections();
+map<uint32, GMSMap::extdata_t>* getDanglingEnds(OldGenericMap* curMap);
 void updExtConnsOfMap(OldGenericMap* curMap, 
-                      danglingEndsByMap_t& danglingEndsByMap,
-                      multimap<uint32, uint32>& surroundingMapsByMap );
+                      const danglingEndsByMap_t& danglingEndsByMap,
+                      const multimap<uint32, uint32>& surroundingMapsByMap );
 void createCountryMaps( CommandlineOptionHandler* coh,
                         map<MC2String, MC2String>& overviewByUnderview );
 void createCountryMapBorder( CommandlineOptionHandler* coh, 
@@ -182,6 +186,123 @@ void removeDupItemsFromMidMif();
 //
 // Main
 //========================================================================
+/**
+  *   Regenerates the turn descriptions of one map.
+  */
+class TurnDescriptionsJob : public GMSMapJob {
+ public:
+   const char* getName() const {
+      return "Regenerate turn descriptions";
+   }
+
+   result_t processMap( OldGenericMap* theMap ) {
+      if ( CL_verboseLevel > 2 ) {
+         mc2log << info << "\t" << setw(6) << theMap->getMapID() << endl;
+      }
+      // Only run on the underview maps, which are GMSMaps.
+      if ( ! static_cast<GMSMap*>( theMap )->initTurnDescriptions() ) {
+         mc2log << error << "Failed to generate turn descriptions for map "
+                << theMap->getMapID() << endl;
+         return failedSaveMap;
+      }
+      return saveMap;
+   }
+};
+
+/**
+  *   Generates the streets of one map and sets the item locations.
+  */
+class GenerateStreetsJob : public GMSMapJob {
+ public:
+   const char* getName() const {
+      return "Generate streets from street segments";
+   }
+
+   result_t processMap( OldGenericMap* theMap ) {
+      if ( CL_verboseLevel > 2 ) {
+         mc2log << info << "\t" << setw(6) << theMap->getMapID() << endl;
+      }
+      // Only run on the underview maps, which are GMSMaps.
+      GMSMap* gmsMap = static_cast<GMSMap*>( theMap );
+      gmsMap->generateStreetsFromStreetSegments();
+      gmsMap->updateMunicipalArray();
+      gmsMap->setAllItemLocation(true);
+      return saveMap;
+   }
+};
+
+/**
+  *   Reads the dangling ends of the boundry segments of one map. All
+  *   maps must be read before any external connections are added.
+  */
+class DanglingEndsJob : public GMSMapJob {
+ public:
+   explicit DanglingEndsJob( danglingEndsByMap_t& danglingEndsByMap )
+         : m_danglingEndsByMap( danglingEndsByMap ) {
+   }
+
+   const char* getName() const {
+      return "Read boundry segments";
+   }
+
+   OldGenericMap* createMap( uint32 mapID, const char* mapPath ) const {
+      return OldGenericMap::createMap( mapID, mapPath );
+   }
+
+   result_t processMap( OldGenericMap* theMap ) {
+      mc2dbg1 << "Reading boundry segments for map with ID " 
+              << theMap->getMapID() << endl;
+      map<uint32, GMSMap::extdata_t>* danglingEnds = 
+         getDanglingEnds( theMap );
+      if ( danglingEnds != NULL ) {
+         ISABSync sync( m_mutex );
+         m_danglingEndsByMap.insert( make_pair( theMap->getMapID(),
+                                                danglingEnds ) );
+      }
+      return noSave;
+   }
+
+ private:
+   /// The dangling ends of all maps read so far.
+   danglingEndsByMap_t& m_danglingEndsByMap;
+
+   /// Protects m_danglingEndsByMap.
+   ISABMutex m_mutex;
+};
+
+/**
+  *   Adds the external connections of one map from the dangling ends
+  *   read by DanglingEndsJob. Only the processed map is changed.
+  */
+class ExtConnsJob : public GMSMapJob {
+ public:
+   ExtConnsJob( const danglingEndsByMap_t& danglingEndsByMap,
+                const multimap<uint32, uint32>& surroundingMapsByMap )
+         : m_danglingEndsByMap( danglingEndsByMap ),
+           m_surroundingMapsByMap( surroundingMapsByMap ) {
+   }
+
+   const char* getName() const {
+      return "Update external connections";
+   }
+
+   OldGenericMap* createMap( uint32 mapID, const char* mapPath ) const {
+      return OldGenericMap::createMap( mapID, mapPath );
+   }
+
+   result_t processMap( OldGenericMap* theMap ) {
+      mc2dbg1 << "Adding connections to map with ID " 
+              << theMap->getMapID() << endl;
+      updExtConnsOfMap( theMap, m_danglingEndsByMap, 
+                        m_surroundingMapsByMap );
+      return saveMap;
+   }
+
+ private:
+   const danglingEndsByMap_t& m_danglingEndsByMap;
+   const multimap<uint32, uint32>& m_surroundingMapsByMap;
+};
+
 int main(int argc, char **argv) {
   
    CL_relabel[0]=MAX_UINT32;
@@ -202,6 +323,8 @@ int main(int argc, char **argv) {
 
 
 
+   ISABThreadInitialize initThreads;
+
    CommandlineOptionHandler coh(argc, argv);
    initCommandline(coh);
 
@@ -810,25 +933,9 @@ int main(int argc, char **argv) {
          }
 
          const char* mapPath = "./";
-         for(uint32 mapID = 0; ; mapID++) {
-            GMSMap* curMap = static_cast<GMSMap*>
-                                 (GMSMap::createMap(mapID, mapPath));
-            if(curMap == NULL) {
-               break;
-            } else {
-               
-               if(CL_verboseLevel > 2) {
-                  cout << "\t" << setw(6) << mapID << endl;
-               }
-               
-               if(!curMap->initTurnDescriptions()) {
-                  cerr << "fail" << endl;
-                  returnCode++;
-               }
-               curMap->save(); 
-            }
-            delete curMap;
-         }
+         TurnDescriptionsJob job;
+         GMSMapJobRunner runner( mapPath, CL_nbrThreads );
+         returnCode += runner.run( job, 0 );
          CL_regenerateTurnDescriptions = false;
       }
       
@@ -893,7 +1000,7 @@ int main(int argc, char **argv) {
                   // combine with CL_setLocations,
                   // CL_regenerateTurnDescriptions and
                   // CL_updateNodeLevelsInMap
-                  GMSMidMifHandler mmh(curMap);
+                  GMSMidMifHandler mmh(curMap, CL_nbrThreads);
                   int nbrCreated =
                      mmh.createItemsFromMidMif(
                            CL_createItemsFromMidMif, 
@@ -991,7 +1098,7 @@ int main(int argc, char **argv) {
             
             
             // Create the municipal items
-            GMSMidMifHandler mmh(newMap);
+            GMSMidMifHandler mmh(newMap, CL_nbrThreads);
             uint32 nbrItemsInFile = 0;
             int nbrCreated =
                mmh.createItemsFromMidMif(CL_initMapFromMidMif,
@@ -1037,22 +1144,9 @@ int main(int argc, char **argv) {
                   coh.getTailLength() == 0 ){
          cout << " Generate streets from street segments" << endl;
          const char* mapPath = "./";
-         for (uint32 mapID = 0; ; mapID++) {
-            GMSMap* curMap = static_cast<GMSMap*>
-                                (GMSMap::createMap(mapID, mapPath));
-            if (curMap == NULL) {
-               break;
-            } else {
-               if (CL_verboseLevel > 2) {
-                  cout << "\t" << setw(6) << mapID << endl;
-               }
-               curMap->generateStreetsFromStreetSegments();
-               curMap->updateMunicipalArray();
-               curMap->setAllItemLocation(true);
-               curMap->save();
-            }
-            delete curMap;
-         }
+         GenerateStreetsJob job;
+         GMSMapJobRunner runner( mapPath, CL_nbrThreads );
+         returnCode += runner.run( job, 0 );
          CL_generateStreetsFromStreetSegments = false;
 
       } else if ( CL_createBorderBoundrySegments ) {
@@ -1787,6 +1881,22 @@ void initCommandline(CommandlineOptionHandler& coh)
                  "This parameter is used e.g. when -e or -x or -r "
                  "parameter is set.");
 
+   //
+   // Number of threads
+   //---------------------------------------------------------------------
+   coh.addOption("", "--threads",
+                 CommandlineOptionHandler::uint32Val,
+                 1, &CL_nbrThreads, "1",
+                 "The number of maps to process at the same time in the "
+                 "stages that only change one map at a time, i.e. "
+                 "-t/--regturn and -J/--generateStreetsFromStreetSegments "
+                 "without maps in the tail and each step of "
+                 "-e/--extconnections, which first reads the boundry "
+                 "segments of all maps. The maps in the tail are always "
+                 "processed one at a time. Also the number of threads "
+                 "parsing the mif file with -r/--createItemsFromMidMif "
+                 "and -g/--initMapFromMidMid.");
+
    //
    // End at map
    //---------------------------------------------------------------------
@@ -2076,155 +2186,21 @@ void updateExternalConnections()
    }
    mc2dbg1 << "updateExternalConnections curMapID=" << curMapID << endl;
 
-   uint32 nbrMaps = 0;
-   bool cont = true;
-
    // The danglingEndsByMap_t is typedef of
    //       map<uint32, map<uint32, GMSMap::extdata_t>* >
    // mapID - nodeID - GMSMap::extdata_t
    danglingEndsByMap_t danglingEndsByMap;
    
    const char* mapPath = "./";
+   GMSMapJobRunner runner( mapPath, CL_nbrThreads );
 
    // Read all the maps and get the boundry segments
    mc2log << info << "Read all the maps and get the boundry segments" << endl;
-   while (cont) {
-      OldGenericMap* curMap = OldGenericMap::createMap(curMapID, mapPath);
-      if (curMap != NULL) {
-         // Print status
-         mc2dbg1 << "Reading boundry segments for map with ID " 
-                 << curMapID << endl;
-
-         OldBoundrySegmentsVector* boundrySegments = 
-            curMap->getBoundrySegments();
-         if (boundrySegments == NULL) {
-            mc2log << warn << here << " No boundry segments" << endl;
-         } else {
-            mc2dbg1 << " nbrItemsToAdd = " << boundrySegments->getSize() 
-                    << endl;
-            for (uint32 i=0; i<boundrySegments->getSize(); i++) {
-               uint32 curItemID = ((OldBoundrySegment*) boundrySegments->
-                     getElementAt(i))->getConnectRouteableItemID();
-               OldRouteableItem* ri = static_cast<OldRouteableItem*>
-                  (curMap->itemLookup(curItemID));
-               ItemTypes::itemType type = ri->getItemType();
-               mc2dbg2 << "    itemID = " << curItemID 
-                       << " type " << StringTable::getString(
-                         ItemTypes::getItemTypeSC(type), StringTable::ENGLISH)
-                       << endl;
-               OldBoundrySegment::closeNode_t closeNodeVal =
-                  ((OldBoundrySegment*)boundrySegments->getElementAt(i))
-                   ->getCloseNodeValue();
-
-               //The extdata where we will store the result
-               GMSMap::extdata_t data;
-               data.mapID = curMapID;
-               data.roadClass = ri->getRoadClass();
-               data.type = type;
-               if (type == ItemTypes::streetSegmentItem) {
-                  OldStreetSegmentItem* ssi = 
-                     static_cast<OldStreetSegmentItem*> (ri);
-                  data.ramp = ssi->isRamp();
-                  data.roundabout = ssi->isRoundabout();
-                  data.multiDig = ssi->isMultiDigitised();
-               } else if (type == ItemTypes::ferryItem) {
-                  data.ramp = false;
-                  data.roundabout = false;
-                  data.multiDig = false;
-               } else {
-                  mc2log << fatal << here << "Boundry segment is"
-                         << " not a routeable item, is type "
-                         << int (type) << endl;
-                  exit (1);
-               }
-
-               GfxData* curGfx = ri->getGfxData();
-               // curNode is the node close to the boundry
-               OldNode* curNode = NULL;
-               OldNode* otherNode = NULL;
-               uint32 n = 0;
-               switch (closeNodeVal) {
-                  case OldBoundrySegment::node0close :
-                     mc2dbg4 << "Adding OldNode 0" << endl;
-                     curNode = ri->getNode(0);
-                     otherNode = ri->getNode(1);
-                     break;
-                  case OldBoundrySegment::node1close :
-                     mc2dbg4 << "Adding OldNode 1" << endl;
-                     curNode = ri->getNode(1);
-                     otherNode = ri->getNode(0);
-                     n = curGfx->getNbrCoordinates(0)-1;
-                     break;
-                  default:
-                     mc2log << fatal << here << " Unknown closeNodeVal " 
-                            << int(closeNodeVal) << ", exiting!" << endl;
-                     exit(1);
-               }
-
-               data.nodeID = curNode->getNodeID();
-               data.lat = curGfx->getLat(0,n);
-               data.lon = curGfx->getLon(0,n);
-               data.entryRestrictions = curNode->getEntryRestrictions();
-               data.level = curNode->getLevel();
-               
-               // To calculate the angle of the bs, use coordinates of 
-               // the neighbouring routeable item.
-               if ( otherNode->getNbrConnections() != 1 ){
-                  mc2log << error << "Other node's number of connections "
-                         << "!= 1. Nbr conns: "
-                         << otherNode->getNbrConnections()
-                         << " NodeID: " << otherNode->getNodeID()
-                         << endl;
-                  exit(1);
-               }
-               uint32 prevNodeID = 
-                  (otherNode->getEntryConnection(0)->
-                   getConnectFromNode()) ^ 0x80000000;
-               OldNode* prevNode = curMap->nodeLookup(prevNodeID);
-               GfxData* prevGfx = curMap->itemLookup(prevNodeID)->getGfxData();
-               uint32 prevCoordIndex = 1;
-               if (!prevNode->isNode0()) {
-                  prevCoordIndex = prevGfx->getNbrCoordinates(0) - 2;
-               }
-               MC2_ASSERT(prevCoordIndex < prevGfx->getNbrCoordinates(0));
-               data.angle = GfxUtility::getAngleFromNorth(
-                              prevGfx->getLat(0,prevCoordIndex),
-                              prevGfx->getLon(0,prevCoordIndex),
-                              curGfx->getLat(0,n),
-                              curGfx->getLon(0,n));
-               data.endNodeAngle = 0;
-              
-               // Add the data to the danglingEnds
-               if ( danglingEndsByMap.find(data.mapID) == 
-                    danglingEndsByMap.end() )
-               {
-                  map<uint32, GMSMap::extdata_t>* nodeDataByNodeId =
-                     new map<uint32, GMSMap::extdata_t>();
-                  danglingEndsByMap.insert(pair<uint32, 
-                                           map<uint32, GMSMap::extdata_t>*>
-                                           (data.mapID,
-                                            nodeDataByNodeId) );
-               }
-               map<uint32, GMSMap::extdata_t>* currMapNodeDataByNodeId =
-                  danglingEndsByMap.find(data.mapID)->second;
-               currMapNodeDataByNodeId->
-                  insert(pair<uint32, GMSMap::extdata_t >
-                         (data.nodeID, data));
-                                               
-                                               
-            }
-            mc2dbg1 << "All items added." << endl;
-         }
-
-         // Increase the mapID-variable
-         nbrMaps++;
-         curMapID = MapBits::nextMapID(curMapID);
-      } else {
-         cont = false;
-      }
-
-      // Delete the map to avoid memory leaks
-      delete curMap;
+   DanglingEndsJob danglingEndsJob( danglingEndsByMap );
+   if ( runner.run( danglingEndsJob, curMapID ) > 0 ) {
+      mc2log << error << "Could not read the boundry segments of all maps,"
+             << " exits!" << endl;
+      exit(1);
    }
 
    // Create bounding boxes for each map from the boundry segments.
@@ -2289,92 +2265,57 @@ void updateExternalConnections()
       bbIt++;
    }
 
-   // Loop over all the maps once again and update the external connections
+   // Loop over all the maps once again and update the external 
+   // connections. Each map only reads the dangling ends read above, so
+   // the maps can be processed at the same time.
    mc2log << info << "Loop all maps and now update the external connections" << endl;
-   cont = true;
-   curMapID = CL_startAtMap;
-   set<uint32>firstProcessedMapIDs;
-   while (cont) {
-      OldGenericMap* curMap = OldGenericMap::createMap(curMapID, mapPath);
-      if ( (curMap != NULL ) &&
-           (curMap->getMapID() <= CL_endAtMap) ) {
-         // Print status
-         mc2dbg1 << "Adding connections to map with ID " << curMapID 
-                 << endl;
-         
-         updExtConnsOfMap(curMap, danglingEndsByMap, surroundingMapsByMap);
-       
-         // Save the map and mark it as processed
-         curMap->save();
-         firstProcessedMapIDs.insert(curMap->getMapID());
-
-         // Increase the mapID-variable
-         curMapID = MapBits::nextMapID(curMapID);
-      } else {
-         cont = false;
-      }
-
-      // Delete the map to avoid memory leaks
-      delete curMap;
+   ExtConnsJob extConnsJob( danglingEndsByMap, surroundingMapsByMap );
+   vector<uint32> firstProcessedMapIDs = 
+      GMSMapJobRunner::getMapIDs( mapPath, CL_startAtMap, CL_endAtMap );
+   if ( runner.run( extConnsJob, firstProcessedMapIDs ) > 0 ) {
+      mc2log << error << "Could not update the external connections of"
+             << " all maps, exits!" << endl;
+      exit(1);
    }
 
 
    if (CL_processNeighbours){
 
-      // Will keep track so we don't process same map multiple times.
-      // First copy the ones already processed, later fill it with the
-      // processed neighbours.
-      set<uint32>processedMapIDs;
-      set<uint32>::const_iterator mapIdIt = firstProcessedMapIDs.begin();
-      while ( mapIdIt != firstProcessedMapIDs.end()){      
-         processedMapIDs.insert(*mapIdIt);
-         ++mapIdIt;
-      }
-
-
-      mc2log << info << "Handling neighbouring maps." << endl;
-      mapIdIt = firstProcessedMapIDs.begin();
-      while ( mapIdIt != firstProcessedMapIDs.end()){
-         
+      // Collect the neighbouring maps not processed above, each map
+      // only once.
+      set<uint32> processedMapIDs( firstProcessedMapIDs.begin(), 
+                                   firstProcessedMapIDs.end() );
+      vector<uint32> neighbourMapIDs;
+      for ( vector<uint32>::const_iterator mapIdIt = 
+               firstProcessedMapIDs.begin(); 
+            mapIdIt != firstProcessedMapIDs.end(); ++mapIdIt ) {
          multimap<uint32, uint32>::const_iterator surrMapsIt = 
             surroundingMapsByMap.lower_bound(*mapIdIt);
          while (surrMapsIt != 
                 surroundingMapsByMap.upper_bound(*mapIdIt))    {
-            set<uint32>::const_iterator searchIt = 
-               processedMapIDs.find(surrMapsIt->second);
-            if ( searchIt == processedMapIDs.end() ){
+            if ( processedMapIDs.insert( surrMapsIt->second ).second ) {
                // This map is a neighbouring/surronding map and it has not
                // been processed before. Create external connections for 
                // it.
-
-               OldGenericMap* curMap = 
-                  OldGenericMap::createMap(surrMapsIt->second, mapPath);
-               if (curMap == NULL){
-                  mc2log << error << "Could not open " 
-                         << surrMapsIt->second
-                         << " exits!" << endl;
-                  exit(1);
-               }
                mc2log << info 
                       << "Adding connections to neighbour map with ID 0x" 
                       << hex << surrMapsIt->second << dec << "("
                       << surrMapsIt->second << ")" << endl;
-               updExtConnsOfMap(curMap, danglingEndsByMap, 
-                                surroundingMapsByMap);
-               
-               // Save the map
-               curMap->save();
-               processedMapIDs.insert(curMap->getMapID());
-               delete curMap;
+               neighbourMapIDs.push_back( surrMapsIt->second );
             }
             else {
                mc2dbg << "Map 0x" << hex << surrMapsIt->second << dec 
                       << " already processed." << endl;
             }
-            
             ++surrMapsIt;
          }
-         ++mapIdIt;
+      }
+
+      mc2log << info << "Handling neighbouring maps." << endl;
+      if ( runner.run( extConnsJob, neighbourMapIDs ) > 0 ) {
+         mc2log << error << "Could not update the external connections of"
+                << " all neighbouring maps, exits!" << endl;
+         exit(1);
       }
       mc2log << info << "Handling neighbouring maps done!" << endl;
    }
@@ -2391,9 +2332,126 @@ void updateExternalConnections()
    }
 } // updateExternalConnections (all maps in current directory)
 
+map<uint32, GMSMap::extdata_t>*
+getDanglingEnds(OldGenericMap* curMap)
+{
+   // nodeID - GMSMap::extdata_t, created with the first dangling end
+   map<uint32, GMSMap::extdata_t>* danglingEnds = NULL;
+
+   OldBoundrySegmentsVector* boundrySegments = 
+      curMap->getBoundrySegments();
+   if (boundrySegments == NULL) {
+      mc2log << warn << here << " No boundry segments" << endl;
+   } else {
+      mc2dbg1 << " nbrItemsToAdd = " << boundrySegments->getSize() 
+              << endl;
+      for (uint32 i=0; i<boundrySegments->getSize(); i++) {
+         uint32 curItemID = ((OldBoundrySegment*) boundrySegments->
+               getElementAt(i))->getConnectRouteableItemID();
+         OldRouteableItem* ri = static_cast<OldRouteableItem*>
+            (curMap->itemLookup(curItemID));
+         ItemTypes::itemType type = ri->getItemType();
+         mc2dbg2 << "    itemID = " << curItemID 
+                 << " type " << StringTable::getString(
+                   ItemTypes::getItemTypeSC(type), StringTable::ENGLISH)
+                 << endl;
+         OldBoundrySegment::closeNode_t closeNodeVal =
+            ((OldBoundrySegment*)boundrySegments->getElementAt(i))
+             ->getCloseNodeValue();
+
+         //The extdata where we will store the result
+         GMSMap::extdata_t data;
+         data.mapID = curMap->getMapID();
+         data.roadClass = ri->getRoadClass();
+         data.type = type;
+         if (type == ItemTypes::streetSegmentItem) {
+            OldStreetSegmentItem* ssi = 
+               static_cast<OldStreetSegmentItem*> (ri);
+            data.ramp = ssi->isRamp();
+            data.roundabout = ssi->isRoundabout();
+            data.multiDig = ssi->isMultiDigitised();
+         } else if (type == ItemTypes::ferryItem) {
+            data.ramp = false;
+            data.roundabout = false;
+            data.multiDig = false;
+         } else {
+            mc2log << fatal << here << "Boundry segment is"
+                   << " not a routeable item, is type "
+                   << int (type) << endl;
+            exit (1);
+         }
+
+         GfxData* curGfx = ri->getGfxData();
+         // curNode is the node close to the boundry
+         OldNode* curNode = NULL;
+         OldNode* otherNode = NULL;
+         uint32 n = 0;
+         switch (closeNodeVal) {
+            case OldBoundrySegment::node0close :
+               mc2dbg4 << "Adding OldNode 0" << endl;
+               curNode = ri->getNode(0);
+               otherNode = ri->getNode(1);
+               break;
+            case OldBoundrySegment::node1close :
+               mc2dbg4 << "Adding OldNode 1" << endl;
+               curNode = ri->getNode(1);
+               otherNode = ri->getNode(0);
+               n = curGfx->getNbrCoordinates(0)-1;
+               break;
+            default:
+               mc2log << fatal << here << " Unknown closeNodeVal " 
+                      << int(closeNodeVal) << ", exiting!" << endl;
+               exit(1);
+         }
+
+         data.nodeID = curNode->getNodeID();
+         data.lat = curGfx->getLat(0,n);
+         data.lon = curGfx->getLon(0,n);
+         data.entryRestrictions = curNode->getEntryRestrictions();
+         data.level = curNode->getLevel();
+         
+         // To calculate the angle of the bs, use coordinates of 
+         // the neighbouring routeable item.
+         if ( otherNode->getNbrConnections() != 1 ){
+            mc2log << error << "Other node's number of connections "
+                   << "!= 1. Nbr conns: "
+                   << otherNode->getNbrConnections()
+                   << " NodeID: " << otherNode->getNodeID()
+                   << endl;
+            exit(1);
+         }
+         uint32 prevNodeID = 
+            (otherNode->getEntryConnection(0)->
+             getConnectFromNode()) ^ 0x80000000;
+         OldNode* prevNode = curMap->nodeLookup(prevNodeID);
+         GfxData* prevGfx = curMap->itemLookup(prevNodeID)->getGfxData();
+         uint32 prevCoordIndex = 1;
+         if (!prevNode->isNode0()) {
+            prevCoordIndex = prevGfx->getNbrCoordinates(0) - 2;
+         }
+         MC2_ASSERT(prevCoordIndex < prevGfx->getNbrCoordinates(0));
+         data.angle = GfxUtility::getAngleFromNorth(
+                        prevGfx->getLat(0,prevCoordIndex),
+                        prevGfx->getLon(0,prevCoordIndex),
+                        curGfx->getLat(0,n),
+                        curGfx->getLon(0,n));
+         data.endNodeAngle = 0;
+        
+         // Add the data to the danglingEnds
+         if ( danglingEnds == NULL ) {
+            danglingEnds = new map<uint32, GMSMap::extdata_t>();
+         }
+         danglingEnds->insert(pair<uint32, GMSMap::extdata_t >
+                              (data.nodeID, data));
+      }
+      mc2dbg1 << "All items added." << endl;
+   }
+   return danglingEnds;
+} // getDanglingEnds
+
 void updExtConnsOfMap(OldGenericMap* curMap, 
-                      danglingEndsByMap_t& danglingEndsByMap,
-                      multimap<uint32, uint32>& surroundingMapsByMap)
+                      const danglingEndsByMap_t& danglingEndsByMap,
+                      const multimap<uint32, uint32>& surroundingMapsByMap)
 {
 
    uint32 curMapID = curMap->getMapID(); 
@@ -18,6 +18,9 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include "StringUtility.h"
 #include "OldItem.h"
 #include "TimeUtility.h"
+#include "MifGfxReader.h"
+#include "ISABThread.h"
+#include "DebugClock.h"
 
 
 
@@ -981,6 +984,120 @@ loadMifFile ( const char* fileName )
           << " mif features from mif file" << endl;
 }
 
+/**
+ *   The number of features and coordinates read from a mif file,
+ *   to compare different ways of reading it.
+ */
+struct MifLoadResult {
+   MifLoadResult() : nbrOk( 0 ), nbrBad( 0 ), nbrCoords( 0 ), 
+                     coordSum( 0 ), time( 0 ) {}
+
+   void addGfx( const GMSGfxData* gfx ) {
+      if ( gfx == NULL ) {
+         ++nbrBad;
+         return;
+      }
+      ++nbrOk;
+      for ( uint32 p = 0; p < gfx->getNbrPolygons(); ++p ) {
+         for ( uint32 i = 0; i < gfx->getNbrCoordinates( p ); ++i ) {
+            ++nbrCoords;
+            coordSum += gfx->getLat( p, i ) ^ gfx->getLon( p, i );
+         }
+      }
+   }
+
+   bool operator == ( const MifLoadResult& other ) const {
+      return nbrOk == other.nbrOk && nbrBad == other.nbrBad &&
+         nbrCoords == other.nbrCoords && coordSum == other.coordSum;
+   }
+
+   uint32 nbrOk;
+   uint32 nbrBad;
+   uint64 nbrCoords;
+   uint64 coordSum;
+   uint32 time;
+};
+
+ostream& operator << ( ostream& stream, const MifLoadResult& res ) {
+   return stream << res.nbrOk << " features, " << res.nbrBad << " bad, " 
+                 << res.nbrCoords << " coords in " << res.time << " ms";
+}
+
+/// Reads the mif file with ifstream, like createItemsFromMidMif used to.
+MifLoadResult
+benchmarkStreamLoad( const char* fileName )
+{
+   MifLoadResult res;
+   DebugClock clock;
+   ifstream miffile( fileName );
+   CoordinateTransformer::format_t coordsys;
+   bool normalCoordinateOrder;
+   uint32 utmzone;
+   int32 falseNorthing, falseEasting;
+   if (!GMSGfxData::readMifHeader(miffile, 
+                                  coordsys, normalCoordinateOrder,
+                                  utmzone, falseNorthing, falseEasting)) {
+      mc2log << fatal << "Could not read mif header" << endl;
+      MC2_ASSERT(false);
+   }
+   while ( !miffile.eof() ) {
+      GMSGfxData* gfx = GMSGfxData::createNewGfxData(NULL, false);
+      if ( gfx->createGfxFromMif( miffile, 
+                                  coordsys, normalCoordinateOrder,
+                                  utmzone, falseNorthing, falseEasting) ) {
+         res.addGfx( gfx );
+      } else if ( !miffile.eof() ) {
+         res.addGfx( NULL );
+      }
+      delete gfx;
+   }
+   res.time = clock.getTime();
+   return res;
+}
+
+/// Reads the mif file with MifGfxReader.
+MifLoadResult
+benchmarkReaderLoad( const char* fileName, uint32 nbrThreads )
+{
+   MifLoadResult res;
+   DebugClock clock;
+   MifGfxReader reader( nbrThreads );
+   if ( ! reader.open( fileName ) ) {
+      mc2log << fatal << "Could not open " << fileName << endl;
+      MC2_ASSERT(false);
+   }
+   GMSGfxData* gfx = NULL;
+   while ( reader.readNext( gfx ) ) {
+      res.addGfx( gfx );
+      delete gfx;
+   }
+   res.time = clock.getTime();
+   return res;
+}
+
+/**
+ *   Reads a mif file with ifstream and with MifGfxReader using 1 
+ *   and nbrThreads threads, prints the times and checks that the
+ *   results are the same.
+ */
+void
+benchmarkMifLoad( const char* fileName, uint32 nbrThreads )
+{
+   mc2log << info << "Benchmark loading mif file '" << fileName << "'" 
+          << endl;
+   MifLoadResult streamRes = benchmarkStreamLoad( fileName );
+   mc2log << info << "ifstream:             " << streamRes << endl;
+   MifLoadResult oneRes = benchmarkReaderLoad( fileName, 1 );
+   mc2log << info << "MifGfxReader 1 thread: " << oneRes << endl;
+   MifLoadResult manyRes = benchmarkReaderLoad( fileName, nbrThreads );
+   mc2log << info << "MifGfxReader " << nbrThreads << " threads: " 
+          << manyRes << endl;
+   if ( !( streamRes == oneRes ) || !( streamRes == manyRes ) ) {
+      mc2log << error << "The results differ!" << endl;
+      exit(1);
+   }
+}
+
 void
 removeInsideMifHeaders( const char* fileName, const char* outFileName )
 {
@@ -1131,6 +1248,7 @@ convertCountryBordersToMidmif( const char* fileName )
 int
 main( int argc, char* argv[] )
 {
+   ISABThreadInitialize initThreads;
    CommandlineOptionHandler coh( argc, argv, 0 );
    
    // ---------------------------- Main function: createMidMifAreaFiles
@@ -1157,6 +1275,16 @@ main( int argc, char* argv[] )
                  0, &o_load, "F",
                  "Load one mif file, to check that mif features are valid");
 
+   // -------------------------------------- Main function: benchmarkLoad
+   bool o_benchmarkLoad = false;
+   coh.addOption("", "--benchmarkLoad",
+                 CommandlineOptionHandler::presentVal,
+                 0, &o_benchmarkLoad, "F",
+                 "Load the mif file in tail with ifstream and with the "
+                 "parallel mif reader used by GenerateMapServer, print "
+                 "the times and check that the results are the same. "
+                 "The number of threads is given with --threads.");
+
    // ----------------------------------------------- Main function
    bool o_breakPoints = false;
    coh.addOption("-b", "--breakPoints",
@@ -1209,6 +1337,12 @@ main( int argc, char* argv[] )
                  1, &o_outFileName, "outFile.mif",
                  "Filename of output file, default 'outFile.mif'.");
 
+   uint32 o_nbrThreads = 4;
+   coh.addOption("", "--threads",
+                 CommandlineOptionHandler::uint32Val,
+                 1, &o_nbrThreads, "4",
+                 "Combined with --benchmarkLoad: the number of threads.");
+
    bool o_sortPolygons = false;
    coh.addOption("", "--modifySort",
                  CommandlineOptionHandler::presentVal,
@@ -1305,6 +1439,10 @@ main( int argc, char* argv[] )
       }
    }
 
+   if ( o_benchmarkLoad ) {
+      benchmarkMifLoad( coh.getTail(0), o_nbrThreads );
+   }
+
    if ( o_breakPoints ) {
       mc2log << info << "Find break points between mif files" << endl;
       if ( coh.getTailLength() > 1 ) {
@@ -144,7 +144,7 @@ class GMSGfxData : public GfxDataFull {
     *           outparameters have been set according to that coordinate 
     *           system, else default values are returned.
     */
-   static bool readMifHeader( ifstream& infile,
+   static bool readMifHeader( istream& infile,
                        CoordinateTransformer::format_t& coordsys,
                        bool& normalOrderOfCoordinates,
                        uint32& utmzone,
@@ -162,7 +162,7 @@ class GMSGfxData : public GfxDataFull {
     *    @param  falseEasting  Any addition to the longitude coordinate.
     *    @return True if ok.
     */
-   bool createGfxFromMif( ifstream& infile,
+   bool createGfxFromMif( istream& infile,
                           CoordinateTransformer::format_t coordsys,
                           bool normalOrderOfCoordinates,
                           uint32 utmzone,
@@ -204,7 +204,7 @@ private:
     *    Read from mif file until next valid mif feature is found.
     *    Valid features are: Region, Pline, Line, Point.
     */
-   bool findNextMifFeature( ifstream& infile,
+   bool findNextMifFeature( istream& infile,
                             bool& region,
                             bool& line,
                             bool& point,
@@ -297,7 +297,7 @@ class MapGenUtil {
       static uint32 getNextMapID( uint32 startID, const char* mapPath );
 
       /** Inits m_mapSupByMapSupName and m_mapSupNameByMapSup. Does nothing if
-       *  already inited.
+       *  already inited. Thread safe.
        */
       static void initMapSupMapping();
 
@@ -0,0 +1,140 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#ifndef MIFGFXREADER_H
+#define MIFGFXREADER_H
+
+#include "config.h"
+#include "CoordinateTransformer.h"
+#include "NotCopyable.h"
+
+#include <vector>
+
+class GMSGfxData;
+
+/**
+ *   Reads the features of a mif file into GMSGfxDatas, using several
+ *   threads.
+ *
+ *   The file is mapped into memory and split into one range of text
+ *   per feature. The ranges are parsed with 
+ *   GMSGfxData::createGfxFromMif in batches, each batch shared
+ *   between the threads, and the gfx datas are handed out in the order
+ *   of the features in the file. Only one batch is kept in memory so
+ *   files of any size can be read.
+ *
+ *   The gfx datas are created without a map, use 
+ *   GMSGfxData::createNewGfxData( map, gfx ) to get one owned by a
+ *   map.
+ */
+class MifGfxReader : private NotCopyable {
+public:
+   /// The default number of features per thread in a batch.
+   static const uint32 DEFAULT_BATCH_SIZE = 2048;
+
+   /**
+    * @param nbrThreads The number of threads parsing the features,
+    *                   with 1 the features are parsed by the calling
+    *                   thread.
+    * @param batchSize  The number of features per thread in each batch.
+    */
+   explicit MifGfxReader( uint32 nbrThreads = 1,
+                          uint32 batchSize = DEFAULT_BATCH_SIZE );
+
+   /// Unmaps the file and deletes any gfx datas not handed out.
+   ~MifGfxReader();
+
+   /**
+    * Maps the file and reads the mif header.
+    *
+    * @param fileName The mif file.
+    * @return True if the file could be mapped and had a mif header.
+    */
+   bool open( const char* fileName );
+
+   /**
+    * Gets the gfx data of the next feature in the file.
+    *
+    * @param gfx Set to the gfx data of the feature or NULL if the
+    *            feature could not be read, e.g. a feature type that
+    *            is not handled. The caller must delete gfx.
+    * @return False if there are no more features in the file.
+    */
+   bool readNext( GMSGfxData*& gfx );
+
+   /// @name The values of the mif header.
+   //@{
+   CoordinateTransformer::format_t getCoordSys() const { 
+      return m_coordsys; 
+   }
+   bool getNormalCoordinateOrder() const { return m_normalOrder; }
+   uint32 getUTMZone() const { return m_utmzone; }
+   int32 getFalseNorthing() const { return m_falseNorthing; }
+   int32 getFalseEasting() const { return m_falseEasting; }
+   //@}
+
+   /// @return The number of ms spent parsing, summed over the threads.
+   uint64 getParseTime() const { return m_parseTime; }
+
+private:
+   /// A range of the mapped file.
+   typedef std::pair<size_t, size_t> range_t;
+
+   /**
+    * Splits the next features of the file into ranges.
+    *
+    * @param maxNbr The maximum number of features to split.
+    * @param ranges Filled with the range of each feature.
+    */
+   void splitFeatures( uint32 maxNbr, std::vector<range_t>& ranges );
+
+   /// Parses the next batch of features into m_batch.
+   bool readBatch();
+
+   /// Unmaps the file.
+   void close();
+
+   /// The number of threads.
+   uint32 m_nbrThreads;
+
+   /// The number of features per thread in a batch.
+   uint32 m_batchSize;
+
+   /// The mapped file.
+   const char* m_data;
+
+   /// The size of the mapped file.
+   size_t m_size;
+
+   /// The offset of the next feature to split.
+   size_t m_pos;
+
+   /// The gfx datas of the current batch, NULL for bad features.
+   std::vector<GMSGfxData*> m_batch;
+
+   /// The index in m_batch of the next gfx data to hand out.
+   uint32 m_batchPos;
+
+   /// The header values.
+   CoordinateTransformer::format_t m_coordsys;
+   bool m_normalOrder;
+   uint32 m_utmzone;
+   int32 m_falseNorthing;
+   int32 m_falseEasting;
+
+   /// The summed parse time in ms.
+   uint64 m_parseTime;
+};
+
+#endif // MIFGFXREADER_H
@@ -645,7 +645,7 @@ class OldExtraDataUtility {
       /**
        *    Initiate the dictionaries used in this class. Uses the static
        *    member m_initiated to make sure the class only is initiated
-       *    once.
+       *    once, also when called by several threads.
        */
       static void init();
 
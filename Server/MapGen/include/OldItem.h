@@ -644,10 +644,12 @@ class OldItem {
                                         OldGenericMap* theMap);
 
       /**
-        *   Static buffer to hold stringdata about an object. Since
-        *   this is allocated static, it is <B>not</B> threadsafe.
+        *   Buffer to hold stringdata about an object, one per thread
+        *   so that several maps can be processed at the same time.
+        *   @return The buffer of the calling thread, 
+        *           ITEM_AS_STRING_LENGTH bytes.
         */
-      static char itemAsString[ITEM_AS_STRING_LENGTH];
+      static char* getItemAsString();
       
       /**
        *    Initialize/reset members.
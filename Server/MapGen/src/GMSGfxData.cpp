@@ -1433,7 +1433,7 @@ GMSGfxData::printMif(ofstream& outfile) const
 }
 
 bool
-GMSGfxData::readMifHeader(ifstream& infile,
+GMSGfxData::readMifHeader(istream& infile,
                        CoordinateTransformer::format_t& coordsys,
                        bool& normalOrderOfCoordinates,
                        uint32& utmzone,
@@ -1516,7 +1516,7 @@ GMSGfxData::readMifHeader(ifstream& infile,
 }
 
 bool
-GMSGfxData::findNextMifFeature(ifstream& infile,
+GMSGfxData::findNextMifFeature(istream& infile,
                                bool& region,
                                bool& line,
                                bool& point,
@@ -1640,7 +1640,7 @@ GMSGfxData::findNextMifFeature(ifstream& infile,
 }
 
 bool
-GMSGfxData::createGfxFromMif(ifstream& infile,
+GMSGfxData::createGfxFromMif(istream& infile,
                              CoordinateTransformer::format_t coordsys,
                              bool normalOrderOfCoordinates,
                              uint32 utmzone,
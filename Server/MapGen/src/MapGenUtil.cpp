@@ -22,6 +22,7 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include "ArrayTools.h"
 
 #include "Utility.h"
+#include "ISABThread.h"
 
 // Static definitions
 const MC2String MapGenUtil::poiWaspPrefix = "YYY-";
@@ -34,6 +35,11 @@ const MC2String MapGenUtil::dirBySectionFileName = "sectionToDirName.txt";
 map<MC2String, MapGenEnums::mapSupplier> MapGenUtil::m_mapSupByMapSupName;
 map<MapGenEnums::mapSupplier, MC2String> MapGenUtil::m_mapSupNameByMapSup;
 
+namespace {
+/// Protects the initialization of the map supplier mappings.
+ISABMutex mapSupMappingMutex;
+}
+
 
 uint32 
 MapGenUtil::getNextMapID( uint32 startID, const char* mapPath )
@@ -290,6 +296,8 @@ MapGenUtil::getMapSupplier( const char* gdfMapOrigin ){
 
 void
 MapGenUtil::initMapSupMapping(){
+   // The maps may be processed by several threads.
+   ISABSync sync( mapSupMappingMutex );
 
    if (m_mapSupByMapSupName.size() == 0){
       // Only init if not inited before.
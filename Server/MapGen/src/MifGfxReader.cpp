@@ -0,0 +1,351 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "MifGfxReader.h"
+
+#include "GMSGfxData.h"
+#include "ISABThread.h"
+#include "DebugClock.h"
+
+#include <streambuf>
+#include <istream>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+/**
+ *   Stream buffer reading directly from a range of memory.
+ */
+class MemoryStreamBuf : public std::streambuf {
+public:
+   MemoryStreamBuf( const char* begin, const char* end ) {
+      char* b = const_cast<char*>( begin );
+      setg( b, b, const_cast<char*>( end ) );
+   }
+
+   /// @return The number of characters read.
+   size_t getNbrRead() const { return gptr() - eback(); }
+};
+
+/// Marks that no feature has been started.
+const size_t NO_FEATURE = size_t( -1 );
+
+/// @return True if c is a space or tab.
+inline bool isBlank( char c ) {
+   return c == ' ' || c == '\t';
+}
+
+/**
+ *   Compares the first word at pos with a keyword, ignoring case.
+ */
+bool wordIs( const char* pos, const char* end, const char* word ) {
+   size_t len = strlen( word );
+   if ( size_t( end - pos ) < len ||
+        strncasecmp( pos, word, len ) != 0 ) {
+      return false;
+   }
+   return pos + len == end || ! isalnum( pos[ len ] );
+}
+
+/**
+ *   The features of one batch. Shared by the threads parsing it.
+ */
+class BatchState {
+public:
+   BatchState( const char* data,
+               const vector< pair<size_t, size_t> >& ranges,
+               vector<GMSGfxData*>& gfxs,
+               const MifGfxReader& header )
+         : m_data( data ),
+           m_ranges( ranges ),
+           m_gfxs( gfxs ),
+           m_header( header ),
+           m_nextIndex( 0 ),
+           m_parseTime( 0 ) {
+   }
+
+   /**
+    * Parses features until there are no more features in the batch.
+    */
+   void parseFeatures() {
+      DebugClock clock;
+      uint32 begin = 0;
+      uint32 end = 0;
+      while ( getNextFeatures( begin, end ) ) {
+         for ( uint32 i = begin; i < end; ++i ) {
+            m_gfxs[ i ] = parseFeature( m_ranges[ i ] );
+         }
+      }
+      ISABSync sync( m_mutex );
+      m_parseTime += clock.getTime();
+   }
+
+   uint64 getParseTime() const { return m_parseTime; }
+
+private:
+   /// The number of features taken by a thread at a time.
+   static const uint32 FEATURES_PER_TAKE = 16;
+
+   /// Gets the indexes of the next features to parse.
+   bool getNextFeatures( uint32& begin, uint32& end ) {
+      ISABSync sync( m_mutex );
+      if ( m_nextIndex >= m_ranges.size() ) {
+         return false;
+      }
+      begin = m_nextIndex;
+      end = MIN( m_nextIndex + FEATURES_PER_TAKE, m_ranges.size() );
+      m_nextIndex = end;
+      return true;
+   }
+
+   /// Parses one feature, returns NULL if it could not be read.
+   GMSGfxData* parseFeature( const pair<size_t, size_t>& range ) const {
+      MemoryStreamBuf buf( m_data + range.first, m_data + range.second );
+      istream stream( &buf );
+      GMSGfxData* gfx = GMSGfxData::createNewGfxData( 
+         static_cast<OldGenericMap*>( NULL ), false );
+      if ( ! gfx->createGfxFromMif( stream, 
+                                    m_header.getCoordSys(),
+                                    m_header.getNormalCoordinateOrder(),
+                                    m_header.getUTMZone(),
+                                    m_header.getFalseNorthing(),
+                                    m_header.getFalseEasting() ) ) {
+         delete gfx;
+         gfx = NULL;
+      }
+      return gfx;
+   }
+
+   const char* m_data;
+   const vector< pair<size_t, size_t> >& m_ranges;
+   vector<GMSGfxData*>& m_gfxs;
+   const MifGfxReader& m_header;
+
+   /// Protects the members below.
+   ISABMutex m_mutex;
+   /// Index in m_ranges of the next feature to parse.
+   uint32 m_nextIndex;
+   /// Summed parse time in ms.
+   uint64 m_parseTime;
+};
+
+/**
+ *   Thread parsing features from a BatchState.
+ */
+class ParseThread : public ISABThread {
+public:
+   explicit ParseThread( BatchState& state )
+         : ISABThread( NULL, "MifParseThread" ),
+           m_state( state ) {
+   }
+
+   void run() {
+      m_state.parseFeatures();
+   }
+
+private:
+   BatchState& m_state;
+};
+
+}
+
+MifGfxReader::MifGfxReader( uint32 nbrThreads, uint32 batchSize )
+      : m_nbrThreads( MAX( nbrThreads, 1 ) ),
+        m_batchSize( MAX( batchSize, 1 ) ),
+        m_data( NULL ),
+        m_size( 0 ),
+        m_pos( 0 ),
+        m_batchPos( 0 ),
+        m_coordsys( CoordinateTransformer::mc2 ),
+        m_normalOrder( true ),
+        m_utmzone( 0 ),
+        m_falseNorthing( 0 ),
+        m_falseEasting( 0 ),
+        m_parseTime( 0 ) {
+}
+
+MifGfxReader::~MifGfxReader() {
+   close();
+}
+
+void
+MifGfxReader::close() {
+   for ( uint32 i = m_batchPos; i < m_batch.size(); ++i ) {
+      delete m_batch[ i ];
+   }
+   m_batch.clear();
+   m_batchPos = 0;
+   if ( m_data != NULL ) {
+      munmap( const_cast<char*>( m_data ), m_size );
+   }
+   m_data = NULL;
+   m_size = 0;
+   m_pos = 0;
+}
+
+bool
+MifGfxReader::open( const char* fileName ) {
+   close();
+
+   int fd = ::open( fileName, O_RDONLY );
+   if ( fd == -1 ) {
+      mc2log << error << "[MifGfxReader]: Could not open " << fileName 
+             << endl;
+      return false;
+   }
+   struct stat st;
+   if ( fstat( fd, &st ) != 0 || st.st_size == 0 ) {
+      mc2log << error << "[MifGfxReader]: Could not stat or empty file "
+             << fileName << endl;
+      ::close( fd );
+      return false;
+   }
+   void* data = mmap( NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+   // The mapping stays valid after the file is closed.
+   ::close( fd );
+   if ( data == MAP_FAILED ) {
+      mc2log << error << "[MifGfxReader]: Could not map " << fileName 
+             << endl;
+      return false;
+   }
+   madvise( data, st.st_size, MADV_SEQUENTIAL );
+   m_data = static_cast<const char*>( data );
+   m_size = st.st_size;
+
+   MemoryStreamBuf buf( m_data, m_data + m_size );
+   istream stream( &buf );
+   if ( ! GMSGfxData::readMifHeader( stream, m_coordsys, m_normalOrder,
+                                     m_utmzone, m_falseNorthing, 
+                                     m_falseEasting ) ) {
+      close();
+      return false;
+   }
+   m_pos = buf.getNbrRead();
+   return true;
+}
+
+void
+MifGfxReader::splitFeatures( uint32 maxNbr, vector<range_t>& ranges ) {
+   ranges.clear();
+   const char* end = m_data + m_size;
+   // The rest of the line of the previous feature or the header
+   // is never the start of a feature.
+   const char* lineStart = static_cast<const char*>
+      ( memchr( m_data + m_pos, '\n', m_size - m_pos ) );
+   lineStart = lineStart == NULL ? end : lineStart + 1;
+   size_t featureStart = NO_FEATURE;
+   bool inHeader = false;
+
+   while ( lineStart < end ) {
+      const char* word = lineStart;
+      while ( word < end && isBlank( *word ) ) {
+         ++word;
+      }
+      // Same words as in GMSGfxData::findNextMifFeature, any other
+      // word is a feature so that createGfxFromMif can complain.
+      bool newFeature = false;
+      if ( inHeader ) {
+         inHeader = ! wordIs( word, end, "Data" );
+      } else if ( wordIs( word, end, "VERSION" ) ) {
+         // Another mif header, skip it.
+         inHeader = true;
+      } else if ( word < end && isalpha( *word ) &&
+                  ! wordIs( word, end, "Pen" ) &&
+                  ! wordIs( word, end, "Brush" ) &&
+                  ! wordIs( word, end, "Center" ) &&
+                  ! wordIs( word, end, "Symbol" ) &&
+                  ! wordIs( word, end, "Smooth" ) &&
+                  ! wordIs( word, end, "Font" ) ) {
+         newFeature = true;
+      }
+
+      if ( ( newFeature || inHeader ) && featureStart != NO_FEATURE ) {
+         ranges.push_back( range_t( featureStart, lineStart - m_data ) );
+         featureStart = NO_FEATURE;
+         if ( ranges.size() >= maxNbr ) {
+            break;
+         }
+      }
+      if ( newFeature ) {
+         featureStart = lineStart - m_data;
+      }
+
+      const char* lineEnd = static_cast<const char*>
+         ( memchr( lineStart, '\n', end - lineStart ) );
+      lineStart = lineEnd == NULL ? end : lineEnd + 1;
+   }
+
+   if ( featureStart != NO_FEATURE ) {
+      ranges.push_back( range_t( featureStart, m_size ) );
+   }
+   if ( ranges.empty() ) {
+      m_pos = m_size;
+   } else {
+      // Continue the next split on the last line of this batch.
+      m_pos = ranges.back().second;
+      m_pos = m_pos == 0 ? 0 : m_pos - 1;
+   }
+}
+
+bool
+MifGfxReader::readBatch() {
+   m_batch.clear();
+   m_batchPos = 0;
+   if ( m_data == NULL || m_pos >= m_size ) {
+      return false;
+   }
+
+   vector<range_t> ranges;
+   splitFeatures( m_batchSize * m_nbrThreads, ranges );
+   if ( ranges.empty() ) {
+      return false;
+   }
+
+   m_batch.resize( ranges.size(), NULL );
+   BatchState state( m_data, ranges, m_batch, *this );
+   uint32 nbrThreads = MIN( m_nbrThreads, 
+                            ( ranges.size() + m_batchSize - 1 ) / 
+                            m_batchSize );
+   if ( nbrThreads <= 1 ) {
+      state.parseFeatures();
+   } else {
+      vector<ISABThreadHandle> threads;
+      for ( uint32 i = 0; i < nbrThreads; ++i ) {
+         threads.push_back( new ParseThread( state ) );
+         threads.back()->start();
+      }
+      for ( uint32 i = 0; i < threads.size(); ++i ) {
+         threads[ i ]->join();
+      }
+   }
+   m_parseTime += state.getParseTime();
+   return true;
+}
+
+bool
+MifGfxReader::readNext( GMSGfxData*& gfx ) {
+   gfx = NULL;
+   if ( m_batchPos >= m_batch.size() && ! readBatch() ) {
+      return false;
+   }
+   gfx = m_batch[ m_batchPos ];
+   m_batch[ m_batchPos ] = NULL;
+   ++m_batchPos;
+   return true;
+}
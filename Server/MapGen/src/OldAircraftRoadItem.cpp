@@ -37,8 +37,8 @@ char* OldAircraftRoadItem::toString()
 {
    char tmpStr[1024];
    strcpy(tmpStr, OldItem::toString());
-   sprintf(itemAsString, "***** AircraftRoadItem\n%s", tmpStr);
-   return itemAsString;
+   sprintf(getItemAsString(), "***** AircraftRoadItem\n%s", tmpStr);
+   return getItemAsString();
 }
 
 bool
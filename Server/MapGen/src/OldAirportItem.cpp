@@ -37,8 +37,8 @@ char* OldAirportItem::toString()
 {
    char tmpStr[1024];
    strcpy(tmpStr, OldItem::toString());
-   sprintf(itemAsString, "***** AirportItem\n%s", tmpStr);
-   return itemAsString;
+   sprintf(getItemAsString(), "***** AirportItem\n%s", tmpStr);
+   return getItemAsString();
 }
 
 bool
@@ -43,8 +43,8 @@ char* OldBuildingItem::toString()
 {
    char tmpStr[1024];
    strcpy(tmpStr, OldItem::toString());
-   sprintf(itemAsString, "***** BuildingItem\n%s", tmpStr);
-   return itemAsString;
+   sprintf(getItemAsString(), "***** BuildingItem\n%s", tmpStr);
+   return getItemAsString();
 }
 
 bool
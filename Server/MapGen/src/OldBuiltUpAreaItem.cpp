@@ -65,10 +65,10 @@ char* OldBuiltUpAreaItem::toString()
 {
    char tmpStr[1024];
    strcpy(tmpStr, OldItem::toString());
-   sprintf(itemAsString,   "***** BuiltUpAreaItem\n"
+   sprintf(getItemAsString(),   "***** BuiltUpAreaItem\n"
                            "%s",
                            tmpStr);
-   return itemAsString;
+   return getItemAsString();
 }
 
 
@@ -52,13 +52,13 @@ char* OldBusRouteItem::toString()
    char tmpStr[ITEM_AS_STRING_LENGTH];
 
    strcpy(tmpStr, OldRouteableItem::toString());
-   sprintf(itemAsString,   "***** BusRouteItem\n%s"
+   sprintf(getItemAsString(),   "***** BusRouteItem\n%s"
                            "   busRouteID=%u\n"
                            "   offsetInClosestStreet=%u\n",
                            tmpStr,
                            m_busRouteID,
                            m_offsetInClosestStreet);
-   return itemAsString;
+   return getItemAsString();
 }
 
 uint32 
@@ -44,11 +44,11 @@ char* OldCartographicItem::toString()
 {
    char tmpStr[1024];
    strcpy(tmpStr, OldItem::toString());
-   sprintf(itemAsString, 
+   sprintf(getItemAsString(), 
            "***** CartographicItem\n   cartographic type=%u\n%s", 
            m_cartographicType, 
            tmpStr);
-   return itemAsString;
+   return getItemAsString();
 }
 
 bool
@@ -42,10 +42,10 @@ char* OldCategoryItem::toString()
 {
    char tmpStr[4096];
    strcpy(tmpStr, OldGroupItem::toString());
-   sprintf(itemAsString,
+   sprintf(getItemAsString(),
            "***** CategoryItem\n%s",
            tmpStr);
-   return itemAsString;
+   return getItemAsString();
 }
 
 
@@ -37,8 +37,8 @@ char* OldCityPartItem::toString()
 {
    char tmpStr[1024];
    strcpy(tmpStr, OldItem::toString());
-   sprintf(itemAsString, "***** CityPartItem\n%s", tmpStr);
-   return itemAsString;
+   sprintf(getItemAsString(), "***** CityPartItem\n%s", tmpStr);
+   return getItemAsString();
 }
 
 bool
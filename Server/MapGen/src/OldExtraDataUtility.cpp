@@ -36,6 +36,7 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include "GfxConstants.h"
 #include "MC2MapGenUtil.h"
 #include "ExtraDataUtility.h"
+#include "ISABThread.h"
 
 #define END_OF_RECORD "EndOfRecord"
 
@@ -45,9 +46,16 @@ OldExtraDataUtility::selectConnMap_t OldExtraDataUtility::m_selectConns;
 
 const MC2String OldExtraDataUtility::edFieldSep = MC2MapGenUtil::poiWaspFieldSep;
 
+namespace {
+/// Protects the initialization of the dictionaries.
+ISABMutex initMutex;
+}
+
 void
 OldExtraDataUtility::init()
 {
+   // The maps may be processed by several threads.
+   ISABSync sync( initMutex );
    if (!m_initiated) {
       m_recordTypes["addNameToItem"] = m_recordTypes["ai"] = ADD_NAME_TO_ITEM;
       m_recordTypes["addcitypart"] = m_recordTypes["acp"] = ADD_CITYPART;
@@ -52,9 +52,9 @@ OldFerryItem::toString()
    char tmpStr[ITEM_AS_STRING_LENGTH];
 
    strcpy(tmpStr, OldRouteableItem::toString());
-   sprintf(itemAsString,   "***** FerryItem\n%s",
+   sprintf(getItemAsString(),   "***** FerryItem\n%s",
                            tmpStr);
-   return itemAsString;
+   return getItemAsString();
 }
 
 uint32 
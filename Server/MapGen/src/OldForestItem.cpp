@@ -38,8 +38,8 @@ OldForestItem::toString()
 {
    char tmpStr[1024];
    strcpy(tmpStr, OldItem::toString());
-   sprintf(itemAsString, "***** ForestItem\n%s", tmpStr);
-   return itemAsString;
+   sprintf(getItemAsString(), "***** ForestItem\n%s", tmpStr);
+   return getItemAsString();
 }
 
 bool
@@ -85,7 +85,7 @@ OldGroupItem::removeItemWithID(uint32 id)
 char* OldGroupItem::toString()
 {
    // Copy the OldItem to tmpStr
-   strcpy(itemAsString, OldItem::toString());
+   strcpy(getItemAsString(), OldItem::toString());
 
    // Print this item into tmpStr
    char tmpStr[4096];
@@ -104,8 +104,8 @@ char* OldGroupItem::toString()
    }
 
    // Concatenate the global one and the temporary string
-   strcat(itemAsString, tmpStr);
-   return itemAsString;
+   strcat(getItemAsString(), tmpStr);
+   return getItemAsString();
 }
 
 uint32 
@@ -43,8 +43,8 @@ OldIndividualBuildingItem::toString()
 {
    char tmpStr[1024];
    strcpy(tmpStr, OldItem::toString());
-   sprintf(itemAsString, "***** IndividualBuildingItem\n%s", tmpStr);
-   return itemAsString;
+   sprintf(getItemAsString(), "***** IndividualBuildingItem\n%s", tmpStr);
+   return getItemAsString();
 }
 
 bool
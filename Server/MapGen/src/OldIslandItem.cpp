@@ -36,8 +36,8 @@ char* OldIslandItem::toString()
 {
    char tmpStr[1024];
    strcpy(tmpStr, OldItem::toString());
-   sprintf(itemAsString, "***** IslandItem\n%s", tmpStr);
-   return itemAsString;
+   sprintf(getItemAsString(), "***** IslandItem\n%s", tmpStr);
+   return getItemAsString();
 }
 
 bool
@@ -57,6 +57,7 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include "MapBits.h"
 
 #include "Utility.h"
+#include "ISABThread.h"
 
 void 
 OldItem::setGfxData( GfxDataFull* gfx, bool deleteOld)
@@ -548,11 +549,29 @@ OldItem::removeAllNames()
    return true;
 }
 
-char OldItem::itemAsString[ITEM_AS_STRING_LENGTH] = "Empty";
+namespace {
+/// The buffer of OldItem::getItemAsString.
+struct ItemAsStringBuffer {
+   ItemAsStringBuffer() {
+      strcpy( buffer, "Empty" );
+   }
+   char buffer[ ITEM_AS_STRING_LENGTH ];
+};
+
+/// One buffer per thread.
+ISABThreadSpecific<ItemAsStringBuffer> itemAsStringBuffers;
+}
+
+char*
+OldItem::getItemAsString()
+{
+   return itemAsStringBuffers.get().buffer;
+}
 
 char* 
 OldItem::toString()
 {
+   char* itemAsString = getItemAsString();
    uint32 i;
    char charHasGfxData;
    if (m_gfxData == NULL)
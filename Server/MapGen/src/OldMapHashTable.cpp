@@ -155,9 +155,8 @@ uint64 OldMapHashCell::minSquaredistToBoundingbox( uint32 index, const int32 hpo
    MC2_ASSERT(item != NULL);
    MC2_ASSERT(m_hashTable->getGfxData(item) != NULL);
 
-   //     This is just a quick fix. The methods should be implemented in
-   //     the GfxData instead. Static variables are not thread safe...
-   static MC2BoundingBox bb;
+   // Not static, the maps may be processed by several threads.
+   MC2BoundingBox bb;
    m_hashTable->getGfxData(item)->getMC2BoundingBox(bb);
    return (bb.squareMC2ScaleDistTo( vpos, hpos ));
 }
@@ -180,9 +179,8 @@ uint64 OldMapHashCell::maxSquaredistToBoundingbox( uint32 index, const int32 hpo
    //return (item->getGfxData()->getMC2BoundingBox()
    //            ->maxMC2ScaleSquareDistTo( vpos, hpos ));
 
-   //     This is just a quick fix. The methods should be implemented in
-   //     the GfxData instead. Static variables are not thread safe...
-   static MC2BoundingBox bb;
+   // Not static, the maps may be processed by several threads.
+   MC2BoundingBox bb;
    m_hashTable->getGfxData(item)->getMC2BoundingBox(bb);
    return (bb.maxMC2ScaleSquareDistTo( vpos, hpos ));
 }
@@ -37,8 +37,8 @@ char* OldMilitaryBaseItem::toString()
 {
    char tmpStr[1024];
    strcpy(tmpStr, OldItem::toString());
-   sprintf(itemAsString, "***** MilitaryBaseItem\n%s", tmpStr);
-   return itemAsString;
+   sprintf(getItemAsString(), "***** MilitaryBaseItem\n%s", tmpStr);
+   return getItemAsString();
 }
 
 bool
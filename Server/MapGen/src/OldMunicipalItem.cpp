@@ -61,8 +61,8 @@ char* OldMunicipalItem::toString()
 {
    char tmpStr[1024];
    strcpy(tmpStr, OldItem::toString());
-   sprintf(itemAsString, "***** MunicipalItem\n%s", tmpStr);
-   return itemAsString;
+   sprintf(getItemAsString(), "***** MunicipalItem\n%s", tmpStr);
+   return getItemAsString();
 }
 
 
@@ -34,8 +34,8 @@ OldNullItem::save(DataBuffer* dataBuffer) const
 char*
 OldNullItem::toString()
 {
-   sprintf(itemAsString, "OldNullItem");
-   return (itemAsString);
+   sprintf(getItemAsString(), "OldNullItem");
+   return (getItemAsString());
 }
 
 bool
@@ -45,8 +45,8 @@ OldParkItem::toString()
 {
    char tmpStr[1024];
    strcpy(tmpStr, OldItem::toString());
-   sprintf(itemAsString, "***** ParkItem\n%s", tmpStr);
-   return itemAsString;
+   sprintf(getItemAsString(), "***** ParkItem\n%s", tmpStr);
+   return getItemAsString();
 }
 
 bool
@@ -37,8 +37,8 @@ char* OldPedestrianAreaItem::toString()
 {
    char tmpStr[1024];
    strcpy(tmpStr, OldItem::toString());
-   sprintf(itemAsString, "***** PedestrianAreaItem\n%s", tmpStr);
-   return itemAsString;
+   sprintf(getItemAsString(), "***** PedestrianAreaItem\n%s", tmpStr);
+   return getItemAsString();
 }
 
 bool
@@ -95,7 +95,7 @@ char* OldPointOfInterestItem::toString()
 {
    char tmpStr[1024];
    strcpy(tmpStr, OldItem::toString());
-   sprintf(itemAsString,   "***** PointOfInterestItem\n"
+   sprintf(getItemAsString(),   "***** PointOfInterestItem\n"
                            "%s"
                            "streetSegmentID=%u\n"
                            "offsetOnStreet=%u\n"
@@ -104,7 +104,7 @@ char* OldPointOfInterestItem::toString()
                            m_streetSegmentID,
                            m_offsetOnStreet,
                            m_waspID);
-   return itemAsString;
+   return getItemAsString();
 }
 
 uint32
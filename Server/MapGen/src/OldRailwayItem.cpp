@@ -38,8 +38,8 @@ char* OldRailwayItem::toString()
 {
    char tmpStr[1024];
    strcpy(tmpStr, OldItem::toString());
-   sprintf(itemAsString, "***** RailwayItem\n%s", tmpStr);
-   return itemAsString;
+   sprintf(getItemAsString(), "***** RailwayItem\n%s", tmpStr);
+   return getItemAsString();
 }
 
 bool
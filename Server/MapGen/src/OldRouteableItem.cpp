@@ -171,13 +171,13 @@ char* OldRouteableItem::toString()
       m_node1Str[0] = '\0';
     
    strcpy(tmpStr, OldItem::toString());
-   sprintf(itemAsString,   "%s"
+   sprintf(getItemAsString(),   "%s"
                            "   node 0 :\n%s"
                            "   node 1 :\n%s",
                            tmpStr,
                            m_node0Str,
                            m_node1Str);
-   return itemAsString;
+   return getItemAsString();
 }
 
 
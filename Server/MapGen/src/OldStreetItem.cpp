@@ -50,8 +50,8 @@ char* OldStreetItem::toString()
 {
    char tmpStr[4096];
    strcpy(tmpStr, OldGroupItem::toString());
-   sprintf(itemAsString, "***** StreetItem\n%s", tmpStr);
-   return itemAsString;
+   sprintf(getItemAsString(), "***** StreetItem\n%s", tmpStr);
+   return getItemAsString();
 }
 
 bool
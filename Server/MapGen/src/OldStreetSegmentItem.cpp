@@ -138,7 +138,7 @@ char* OldStreetSegmentItem::toString()
       controlledAccessVal = 'T';
     
    strcpy(tmpStr, OldRouteableItem::toString());
-   sprintf(itemAsString,   "***** StreetSegmentItem\n%s"
+   sprintf(getItemAsString(),   "***** StreetSegmentItem\n%s"
                            "   width=%u\n"
                            "   streetNumberType=%u\n"
                            "   leftsideNumberStart=%u\n"
@@ -166,7 +166,7 @@ char* OldStreetSegmentItem::toString()
                            dividedVal,
                            multiDigitisedVal,
                            controlledAccessVal);
-   return itemAsString;
+   return getItemAsString();
 }
 
 
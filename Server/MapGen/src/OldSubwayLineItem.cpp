@@ -34,8 +34,8 @@ OldSubwayLineItem::toString()
 {
    char tmpStr[1024];
    strcpy(tmpStr, OldItem::toString());
-   sprintf(itemAsString, "***** SubwayLineItem\n%s", tmpStr);
-   return itemAsString;
+   sprintf(getItemAsString(), "***** SubwayLineItem\n%s", tmpStr);
+   return getItemAsString();
 }
 
 bool
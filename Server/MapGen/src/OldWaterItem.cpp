@@ -45,8 +45,8 @@ char* OldWaterItem::toString()
 {
    char tmpStr[1024];
    strcpy(tmpStr, OldItem::toString());
-   sprintf(itemAsString, "***** WaterItem\n%s", tmpStr);
-   return itemAsString;
+   sprintf(getItemAsString(), "***** WaterItem\n%s", tmpStr);
+   return getItemAsString();
 }
 
 bool
@@ -0,0 +1,195 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "MC2UnitTestMain.h"
+
+#include "ExtSearchCache.h"
+#include "ExternalSearchRequestData.h"
+#include "SearchRequestParameters.h"
+#include "Packet.h"
+#include "ISABThread.h"
+
+namespace {
+
+/// Makes a search for a what and a where value.
+ExternalSearchRequestData makeSearch( const MC2String& what, 
+                                      const MC2String& where,
+                                      const MC2Coordinate& coord ) {
+   ExternalSearchRequestData::stringMap_t values;
+   values[ 1 ] = what;
+   values[ 2 ] = where;
+   return ExternalSearchRequestData( SearchRequestParameters(), 
+                                     6, // service
+                                     values, 0, 10,
+                                     ItemInfoEnums::All, coord );
+}
+
+/// Makes a reply with a number after the header.
+ReplyPacket* makeReply( const RequestPacket& req, uint32 value ) {
+   ReplyPacket* reply = 
+      new ReplyPacket( 256, Packet::PACKETTYPE_EXTERNALSEARCH_REPLY );
+   reply->init( Packet::PACKETTYPE_EXTERNALSEARCH_REPLY, &req, 
+                StringTable::OK );
+   int pos = REPLY_HEADER_SIZE;
+   reply->incWriteLong( pos, value );
+   reply->setLength( pos );
+   return reply;
+}
+
+/// Reads the number of makeReply.
+uint32 getValue( const ReplyPacket* reply ) {
+   int pos = REPLY_HEADER_SIZE;
+   return reply->incReadLong( pos );
+}
+
+/// Looks up a key and answers it after a while if not found.
+class Searcher: public ISABThread {
+public:
+   Searcher( ExtSearchCache& cache, const MC2String& key, 
+             const RequestPacket& req )
+         : m_cache( cache ), m_key( key ), m_req( req ), m_value( 0 ) {
+   }
+
+   void run() {
+      auto_ptr< ReplyPacket > reply( m_cache.find( m_key, &m_req, 100 ) );
+      if ( reply.get() == NULL ) {
+         // Ask the "provider"
+         ISABThread::sleep( 200 );
+         reply.reset( makeReply( m_req, 42 ) );
+         m_cache.insert( m_key, *reply, 60, 100 );
+      }
+      m_value = getValue( reply.get() );
+   }
+
+   uint32 getResult() const { return m_value; }
+
+private:
+   ExtSearchCache& m_cache;
+   MC2String m_key;
+   const RequestPacket& m_req;
+   uint32 m_value;
+};
+
+}
+
+MC2_UNIT_TEST_FUNCTION( keyTest ) {
+   const MC2Coordinate coord( 664000000, 157000000 );
+   MC2String key = ExtSearchCache::makeKey( makeSearch( "Pizza", "Lund",
+                                                        coord ) );
+   // Case, spaces and small moves do not matter
+   MC2_TEST_CHECK( key == ExtSearchCache::makeKey( 
+                      makeSearch( " pizza ", "LUND", 
+                                  MC2Coordinate( 664000010, 157000010 ) ) ) );
+   MC2_TEST_CHECK( key != ExtSearchCache::makeKey( 
+                      makeSearch( "pizza", "Malmo", coord ) ) );
+   MC2_TEST_CHECK( key != ExtSearchCache::makeKey( 
+                      makeSearch( "pizza", "lund", 
+                                  MC2Coordinate( 664100000, 157000000 ) ) ) );
+   // The values can not be shifted into each other
+   MC2_TEST_CHECK( ExtSearchCache::makeKey( makeSearch( "a;", "b", coord ) ) !=
+                   ExtSearchCache::makeKey( makeSearch( "a", ";b", coord ) ) );
+}
+
+MC2_UNIT_TEST_FUNCTION( findTest ) {
+   ExtSearchCache cache( 2, 60 );
+   RequestPacket req( 256, 0, Packet::PACKETTYPE_EXTERNALSEARCH_REQUEST,
+                      17, 4711, 0 );
+
+   MC2_TEST_CHECK( cache.find( "a", &req, 100 ) == NULL );
+   auto_ptr< ReplyPacket > reply( makeReply( req, 1 ) );
+   cache.insert( "a", *reply, 60, 100 );
+
+   // A new request gets the cached reply with its own ids
+   RequestPacket req2( 256, 0, Packet::PACKETTYPE_EXTERNALSEARCH_REQUEST,
+                       18, 4712, 0 );
+   reply.reset( cache.find( "a", &req2, 120 ) );
+   MC2_TEST_REQUIRED( reply.get() != NULL );
+   MC2_TEST_CHECK( getValue( reply.get() ) == 1 );
+   MC2_TEST_CHECK( reply->getPacketID() == 18 );
+   MC2_TEST_CHECK( reply->getRequestID() == 4712 );
+   MC2_TEST_CHECK( reply->getSubType() == 
+                   Packet::PACKETTYPE_EXTERNALSEARCH_REPLY );
+   MC2_TEST_CHECK( reply->getStatus() == StringTable::OK );
+
+   // Too old
+   MC2_TEST_CHECK( cache.find( "a", &req, 160 ) == NULL );
+   cache.cancel( "a" );
+
+   // Least recently used is removed
+   reply.reset( makeReply( req, 2 ) );
+   cache.insert( "b", *reply, 60, 200 );
+   cache.insert( "c", *reply, 60, 200 );
+   delete cache.find( "b", &req, 200 );
+   cache.insert( "d", *reply, 60, 200 );
+   MC2_TEST_CHECK( cache.find( "c", &req, 200 ) == NULL );
+   cache.cancel( "c" );
+   reply.reset( cache.find( "b", &req, 200 ) );
+   MC2_TEST_CHECK( reply.get() != NULL );
+
+   ExtSearchCache::Statistics stats = cache.getStatistics();
+   MC2_TEST_CHECK( stats.nbrEntries == 2 );
+   MC2_TEST_CHECK( stats.hits == 3 );
+   MC2_TEST_CHECK( stats.misses == 3 );
+   MC2_TEST_CHECK( stats.coalesced == 0 );
+}
+
+MC2_UNIT_TEST_FUNCTION( providerTTLTest ) {
+   // No default time to live, but a provider can have its own.
+   ExtSearchCache cache( 2, 0 );
+   RequestPacket req( 256, 0, Packet::PACKETTYPE_EXTERNALSEARCH_REQUEST,
+                      17, 4711, 0 );
+   MC2_TEST_CHECK( ! cache.isEnabled( "NoSuchProvider" ) );
+
+   MC2_TEST_CHECK( cache.find( "a", &req, 100 ) == NULL );
+   auto_ptr< ReplyPacket > reply( makeReply( req, 1 ) );
+   cache.insert( "a", *reply, 60, 100 );
+   reply.reset( cache.find( "a", &req, 120 ) );
+   MC2_TEST_REQUIRED( reply.get() != NULL );
+   MC2_TEST_CHECK( getValue( reply.get() ) == 1 );
+
+   // The default time to live.
+   MC2_TEST_CHECK( ExtSearchCache( 2, 60 ).isEnabled( "NoSuchProvider" ) );
+
+   // No cache at all.
+   ExtSearchCache disabled( 0, 60 );
+   MC2_TEST_CHECK( ! disabled.isEnabled( "NoSuchProvider" ) );
+   MC2_TEST_CHECK( disabled.find( "a", &req, 100 ) == NULL );
+   disabled.insert( "a", *reply, 60, 100 );
+   MC2_TEST_CHECK( disabled.find( "a", &req, 120 ) == NULL );
+}
+
+MC2_UNIT_TEST_FUNCTION( coalesceTest ) {
+   ISABThreadInitialize initThreads;
+   ExtSearchCache cache;
+   RequestPacket req( 256, 0, Packet::PACKETTYPE_EXTERNALSEARCH_REQUEST,
+                      17, 4711, 0 );
+
+   // All but one wait for the first to answer
+   const uint32 NBR_SEARCHERS = 4;
+   vector< ISABThreadHandle > handles;
+   vector< Searcher* > searchers;
+   for ( uint32 i = 0; i < NBR_SEARCHERS; ++i ) {
+      searchers.push_back( new Searcher( cache, "key", req ) );
+      handles.push_back( searchers.back() );
+      handles.back()->start();
+   }
+   for ( uint32 i = 0; i < NBR_SEARCHERS; ++i ) {
+      handles[ i ]->join();
+      MC2_TEST_CHECK( searchers[ i ]->getResult() == 42 );
+   }
+   ExtSearchCache::Statistics stats = cache.getStatistics();
+   MC2_TEST_CHECK( stats.misses == 1 );
+   MC2_TEST_CHECK( stats.hits == NBR_SEARCHERS - 1 );
+   MC2_TEST_CHECK( stats.coalesced == NBR_SEARCHERS - 1 );
+}
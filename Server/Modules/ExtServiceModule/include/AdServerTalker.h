@@ -27,7 +27,7 @@ class Expression;
 }
 
 class AdServerMatches;
-class URLFetcher;
+class ParallelURLFetcher;
 
 /**
  * Handles Advertisement matches
@@ -81,7 +81,7 @@ private:
    /// number of hits in the search reply
    auto_ptr<XMLTool::XPath::Expression> m_docCountExp;
    /// fetches the results
-   auto_ptr<URLFetcher> m_urlFetcher;
+   auto_ptr<ParallelURLFetcher> m_urlFetcher;
 };
 
 #endif // ADSERVERTALKER_H
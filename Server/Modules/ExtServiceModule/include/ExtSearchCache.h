@@ -0,0 +1,236 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#ifndef EXT_SEARCH_CACHE_H
+#define EXT_SEARCH_CACHE_H
+
+#include "config.h"
+#include "ISABThread.h"
+#include "NotCopyable.h"
+#include "MC2String.h"
+
+#include <vector>
+#include <list>
+#include <map>
+#include <memory>
+
+class DataBuffer;
+class ExternalSearchRequestData;
+class RequestPacket;
+class ReplyPacket;
+
+/**
+ *    Cache of the replies to external searches.
+ *
+ *    Popular searches are sent to the providers over and over again.
+ *    The cache keeps the reply packets of the searches, keyed on the
+ *    normalized search, so that identical searches within the time to
+ *    live of the provider are answered without asking the provider.
+ *
+ *    When several processors get the same search at the same time only
+ *    the first one asks the provider, the others wait for its reply.
+ *
+ *    If memcached servers are given the replies are also stored there,
+ *    so that all ExtServiceModules share them.
+ *
+ *    The cache is thread safe.
+ */
+class ExtSearchCache: private NotCopyable {
+public:
+   /// The default maximum number of replies to keep.
+   static const uint32 DEFAULT_MAX_NBR_ENTRIES = 1024;
+
+   /// The default time to live in seconds.
+   static const uint32 DEFAULT_TTL = 300;
+
+   /// The default time to wait for an identical search, in ms.
+   static const uint32 DEFAULT_MAX_WAIT = 10000;
+
+   /**
+    *    Counters for the cache.
+    */
+   struct Statistics {
+      /// The number of replies found in the cache.
+      uint32 hits;
+      /// The number of replies found in memcached.
+      uint32 memcachedHits;
+      /// The number of searches that had to ask the provider.
+      uint32 misses;
+      /// The number of searches that waited for an identical one.
+      uint32 coalesced;
+      /// The number of replies in the cache.
+      uint32 nbrEntries;
+   };
+
+   /**
+    *    @param maxNbrEntries  The maximum number of replies to keep,
+    *                          0 disables the cache.
+    *    @param ttl            The default time to live in seconds.
+    *    @param maxWait        The maximum time in ms to wait for an
+    *                          identical search.
+    *    @param memcachedHosts Memcached servers to share the replies
+    *                          with, empty for none.
+    */
+   explicit ExtSearchCache( uint32 maxNbrEntries = DEFAULT_MAX_NBR_ENTRIES,
+                            uint32 ttl = DEFAULT_TTL,
+                            uint32 maxWait = DEFAULT_MAX_WAIT,
+                            const MC2String& memcachedHosts = "" );
+
+   ~ExtSearchCache();
+
+   /**
+    *    Returns the cache used by the ExtServiceProcessors. The size,
+    *    time to live and memcached servers are set by the properties
+    *    EXT_SEARCH_CACHE_SIZE, EXT_SEARCH_CACHE_TTL and
+    *    EXT_SEARCH_CACHE_MEMCACHED_SERVERS.
+    */
+   static ExtSearchCache& getInstance();
+
+   /**
+    *    Makes the key of a search. Values are trimmed and made lower
+    *    case and the coordinate is rounded to about 75 meters, so that
+    *    searches that the providers would answer the same way get the
+    *    same key.
+    *
+    *    @param data The search.
+    *    @return The key.
+    */
+   static MC2String makeKey( const ExternalSearchRequestData& data );
+
+   /**
+    *    @param serviceName The name of a provider.
+    *    @return True if the cache keeps replies from the provider.
+    */
+   bool isEnabled( const MC2String& serviceName ) const;
+
+   /**
+    *    @param serviceName The name of a provider.
+    *    @return The time to live for the provider, set by the property
+    *            EXT_SEARCH_CACHE_TTL_<NAME> or the default if not set.
+    */
+   uint32 getTTL( const MC2String& serviceName ) const;
+
+   /**
+    *    Looks for the reply to a search. If another thread is asking
+    *    the provider for the same search, waits for it.
+    *
+    *    If NULL is returned the caller must ask the provider and then
+    *    call insert or cancel with the key.
+    *
+    *    @param key The key of the search.
+    *    @param req The request, the reply is made for it.
+    *    @param now The current time in seconds.
+    *    @return A new reply to be deleted by the caller or NULL.
+    */
+   ReplyPacket* find( const MC2String& key,
+                      const RequestPacket* req,
+                      uint32 now );
+
+   /**
+    *    Adds a reply to the cache and wakes the threads waiting for it.
+    *
+    *    @param key   The key of the search.
+    *    @param reply The reply, its contents are copied.
+    *    @param ttl   The time to live of the reply in seconds.
+    *    @param now   The current time in seconds.
+    */
+   void insert( const MC2String& key,
+                const ReplyPacket& reply,
+                uint32 ttl,
+                uint32 now );
+
+   /**
+    *    Tells the cache that the search was not answered, e.g. the
+    *    provider failed. Wakes the threads waiting for it.
+    *
+    *    @param key The key of the search.
+    */
+   void cancel( const MC2String& key );
+
+   /**
+    *    @return The counters for the cache.
+    */
+   Statistics getStatistics() const;
+
+private:
+   /// A cached reply.
+   struct Entry {
+      /// Creates an empty entry.
+      Entry();
+
+      /// The key.
+      MC2String key;
+      /// The time in seconds when the reply is too old.
+      uint32 expires;
+      /// The status of the reply.
+      uint32 status;
+      /// The packet contents after the reply header.
+      std::vector< byte > body;
+
+      /// @return The entry in a buffer, for memcached.
+      DataBuffer getDataBuffer() const;
+
+      /// Loads the entry from memcached.
+      void load( DataBuffer& buffer );
+   };
+
+   typedef std::list< Entry > Entries;
+   typedef std::map< MC2String, Entries::iterator > Index;
+
+   /// Makes a reply to req from an entry.
+   static ReplyPacket* makeReply( const Entry& entry,
+                                  const RequestPacket* req );
+
+   /// Adds an entry, replacing an old one with the same key.
+   void add( const Entry& entry );
+
+   /// Removes a claim on a key and wakes the waiting threads.
+   void release( const MC2String& key );
+
+   /// Looks in memcached, adds the entry if found.
+   bool findShared( const MC2String& key, uint32 now, Entry& entry );
+
+   /// Stores an entry in memcached.
+   void addShared( const Entry& entry, uint32 ttl );
+
+   /// The most recently used entry first.
+   Entries m_entries;
+
+   /// Finds the entries.
+   Index m_index;
+
+   /// The number of threads asking the provider for each key.
+   std::map< MC2String, uint32 > m_fetching;
+
+   /// The maximum number of entries.
+   uint32 m_maxNbrEntries;
+
+   /// The default time to live in seconds.
+   uint32 m_ttl;
+
+   /// The maximum time to wait for another thread, in ms.
+   uint32 m_maxWait;
+
+   /// Counters.
+   Statistics m_stats;
+
+   /// The memcached servers, if any.
+   class SharedCache;
+   std::auto_ptr< SharedCache > m_shared;
+
+   /// Protects the members and signals finished searches.
+   mutable ISABMonitor m_monitor;
+};
+
+#endif // EXT_SEARCH_CACHE_H
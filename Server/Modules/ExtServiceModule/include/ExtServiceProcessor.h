@@ -22,6 +22,7 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include "MC2String.h"
 #include "ISABThread.h"
 #include "Talkers.h"
+#include "IntervalTimer.h"
 
 #include <memory>
 
@@ -111,6 +112,12 @@ private:
 
    ReplyPacket* handleExtServiceRequest( const RequestPacket& packet );
 
+   /**
+    * Logs the latency and errors of the external providers, at most
+    * once a minute and only if there have been new requests.
+    */
+   void logProviderStatistics();
+
    /// holds all talkers
    Talkers::Talkers m_talkers;
 
@@ -120,6 +127,12 @@ private:
    /// Used for checking in-parameters
    auto_ptr<ExternalSearchDescGenerator> m_searchDescGenerator;
    ISABThreadHandle m_startup;
+
+   /// When the provider statistics are due to be logged.
+   IntervalTimer m_statisticsTimer;
+
+   /// The total number of provider requests when last logged.
+   uint32 m_lastNbrRequests;
 };
 
 #endif // EXTSERVICE_PROCESSOR_H
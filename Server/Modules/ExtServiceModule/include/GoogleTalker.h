@@ -16,7 +16,7 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 
 #include "ExtServiceTalker.h"
 
-class URLFetcher;
+class ParallelURLFetcher;
 
 class GoogleMatches;
 
@@ -71,7 +71,7 @@ public:
 private:
 
    /// For querying searches
-   auto_ptr<URLFetcher> m_urlFetcher;
+   auto_ptr<ParallelURLFetcher> m_urlFetcher;
    GoogleMatches* m_matches;
    auto_ptr< MC2JSON::JPath::MultiExpression > m_expr;
    uint32 m_estimatedResultCount;
@@ -16,7 +16,7 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 
 #include "config.h"
 
-class URLFetcher;
+class ParallelURLFetcher;
 struct QypeReviewInfo;
 struct QypeImageInfo;
 class VanillaMatch;
@@ -325,7 +325,7 @@ private:
    /// Constant for the Qype url
    const MC2String m_qypeUrl;
 
-   auto_ptr<URLFetcher> m_urlFetcher; ///< fetching query urls
+   auto_ptr<ParallelURLFetcher> m_urlFetcher; ///< fetching query urls
 
    /// XPath expressions for main XML
    auto_ptr<XMLTool::XPath::MultiExpression> m_expression; 
@@ -25,7 +25,7 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include "StringUtility.h"
 
 #include "URL.h"
-#include "URLFetcher.h"
+#include "ParallelURLFetcher.h"
 #include "HttpHeader.h"
 
 #include "STLStringUtility.h"
@@ -141,7 +141,7 @@ AdServerTalker::AdServerTalker():
    m_matches( new AdServerMatches() ),
    m_rootExp( new Expression( "/results" ) ),
    m_docCountExp( new Expression( "/results/@total" ) ),
-   m_urlFetcher( new URLFetcher() ) {
+   m_urlFetcher( new ParallelURLFetcher() ) {
 
    AdServerMatch& currMatch = m_matches->getCurrMatch();
 
@@ -199,7 +199,7 @@ sendRequest( MC2String& xml_result, MC2String& url,
    mc2dbg << "[AdServerTalker] url = " << url << endl;
    
    HttpHeader urlHeader;
-   return m_urlFetcher->get( xml_result, url, 5000, &urlHeader );
+   return m_urlFetcher->get( xml_result, "AdServer", url, 5000, &urlHeader );
 }
 
 
@@ -0,0 +1,351 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "ExtSearchCache.h"
+
+#include "ExternalSearchRequestData.h"
+#include "Packet.h"
+#include "Properties.h"
+#include "StringUtility.h"
+#include "STLStringUtility.h"
+#include "TimeUtility.h"
+#include "DataBuffer.h"
+#include "MD5Hash.h"
+
+#ifdef HAVE_MEMCACHED
+#include "Memcached.h"
+#endif
+
+namespace {
+
+/// The coordinates are rounded to this many mc2 units, about 75 meters.
+const int32 COORD_GRID = 8192;
+
+/// Appends a string with its length, so that keys can not collide.
+void addString( MC2String& key, const MC2String& str ) {
+   STLStringUtility::uint2str( str.length(), key );
+   key += ':';
+   key += str;
+   key += ';';
+}
+
+/// Appends a number.
+void addInt( MC2String& key, int32 value ) {
+   STLStringUtility::int2str( value, key );
+   key += ';';
+}
+
+}
+
+#ifdef HAVE_MEMCACHED
+
+/// The replies in memcached.
+class ExtSearchCache::SharedCache:
+      public Memcached::SimpleNoThrowCache< ExtSearchCache::Entry > {
+public:
+   explicit SharedCache( const MC2String& hosts )
+         : Memcached::SimpleNoThrowCache< ExtSearchCache::Entry >( 
+            hosts, "ES-" ) {
+   }
+};
+
+#else
+
+/// Nothing without memcached.
+class ExtSearchCache::SharedCache {
+};
+
+#endif
+
+ExtSearchCache::Entry::Entry()
+      : expires( 0 ),
+        status( 0 )
+{
+}
+
+DataBuffer
+ExtSearchCache::Entry::getDataBuffer() const
+{
+   DataBuffer buf( 4 * 3 + key.length() + 1 + body.size() + 4 );
+   buf.writeNextLong( expires );
+   buf.writeNextLong( status );
+   buf.writeNextLong( body.size() );
+   buf.writeNextString( key.c_str() );
+   if ( ! body.empty() ) {
+      buf.writeNextByteArray( &body.front(), body.size() );
+   }
+   return buf;
+}
+
+void
+ExtSearchCache::Entry::load( DataBuffer& buf )
+{
+   expires = buf.readNextLong();
+   status = buf.readNextLong();
+   uint32 size = buf.readNextLong();
+   key = buf.readNextString();
+   const byte* data = buf.readNextByteArray( size );
+   body.assign( data, data + size );
+}
+
+ExtSearchCache::ExtSearchCache( uint32 maxNbrEntries,
+                                uint32 ttl,
+                                uint32 maxWait,
+                                const MC2String& memcachedHosts )
+      : m_maxNbrEntries( maxNbrEntries ),
+        m_ttl( ttl ),
+        m_maxWait( maxWait )
+{
+   m_stats.hits = 0;
+   m_stats.memcachedHits = 0;
+   m_stats.misses = 0;
+   m_stats.coalesced = 0;
+   m_stats.nbrEntries = 0;
+#ifdef HAVE_MEMCACHED
+   if ( ! memcachedHosts.empty() ) {
+      m_shared.reset( new SharedCache( memcachedHosts ) );
+   }
+#else
+   if ( ! memcachedHosts.empty() ) {
+      mc2log << warn << "[ExtSearchCache] Built without memcached, "
+             << "not using " << memcachedHosts << endl;
+   }
+#endif
+}
+
+ExtSearchCache::~ExtSearchCache()
+{
+}
+
+ExtSearchCache&
+ExtSearchCache::getInstance()
+{
+   static ExtSearchCache
+      cache( Properties::getUint32Property( "EXT_SEARCH_CACHE_SIZE",
+                                            DEFAULT_MAX_NBR_ENTRIES ),
+             Properties::getUint32Property( "EXT_SEARCH_CACHE_TTL",
+                                            DEFAULT_TTL ),
+             Properties::getUint32Property( "EXT_SEARCH_CACHE_MAX_WAIT",
+                                            DEFAULT_MAX_WAIT ),
+             Properties::getProperty( "EXT_SEARCH_CACHE_MEMCACHED_SERVERS",
+                                      "" ) );
+   return cache;
+}
+
+MC2String
+ExtSearchCache::makeKey( const ExternalSearchRequestData& data )
+{
+   MC2String key;
+   addInt( key, data.getService() );
+   addInt( key, data.getLang() );
+   addInt( key, data.getStartHitIdx() );
+   addInt( key, data.getEndHitIdx() );
+   addInt( key, data.getInfoFilterLevel() );
+   const MC2Coordinate& coord = data.getCoordinate();
+   if ( coord.isValid() ) {
+      addInt( key, coord.lat & ~( COORD_GRID - 1 ) );
+      addInt( key, coord.lon & ~( COORD_GRID - 1 ) );
+   } else {
+      key += "-;";
+   }
+   addInt( key, data.getDistance() );
+   for ( ExternalSearchRequestData::stringMap_t::const_iterator it =
+            data.getValues().begin(); it != data.getValues().end(); ++it ) {
+      MC2String value = StringUtility::copyLower(
+         StringUtility::trimStartEnd( it->second ) );
+      if ( ! value.empty() ) {
+         addInt( key, it->first );
+         addString( key, value );
+      }
+   }
+   return key;
+}
+
+bool
+ExtSearchCache::isEnabled( const MC2String& serviceName ) const
+{
+   return m_maxNbrEntries > 0 && getTTL( serviceName ) > 0;
+}
+
+uint32
+ExtSearchCache::getTTL( const MC2String& serviceName ) const
+{
+   MC2String name( "EXT_SEARCH_CACHE_TTL_" );
+   name += StringUtility::copyUpper( serviceName );
+   return Properties::getUint32Property( name.c_str(), m_ttl );
+}
+
+ReplyPacket*
+ExtSearchCache::makeReply( const Entry& entry, const RequestPacket* req )
+{
+   ReplyPacket* reply = new ReplyPacket( REPLY_HEADER_SIZE + 
+                                         entry.body.size(),
+                                         Packet::PACKETTYPE_EXTERNALSEARCH_REPLY );
+   reply->init( Packet::PACKETTYPE_EXTERNALSEARCH_REPLY, req,
+                entry.status );
+   reply->setResendNbr( req->getResendNbr() );
+   if ( ! entry.body.empty() ) {
+      memcpy( reply->getBuf() + REPLY_HEADER_SIZE, &entry.body.front(),
+              entry.body.size() );
+   }
+   reply->setLength( REPLY_HEADER_SIZE + entry.body.size() );
+   return reply;
+}
+
+ReplyPacket*
+ExtSearchCache::find( const MC2String& key,
+                      const RequestPacket* req,
+                      uint32 now )
+{
+   if ( m_maxNbrEntries == 0 ) {
+      return NULL;
+   }
+   {
+      ISABSync sync( m_monitor );
+      const uint32 startTime = TimeUtility::getCurrentTime();
+      bool waited = false;
+      for ( ;; ) {
+         Index::iterator it = m_index.find( key );
+         if ( it != m_index.end() ) {
+            Entries::iterator entry = it->second;
+            if ( entry->expires > now ) {
+               ++m_stats.hits;
+               // Most recently used first
+               m_entries.splice( m_entries.begin(), m_entries, entry );
+               return makeReply( *entry, req );
+            }
+            m_entries.erase( entry );
+            m_index.erase( it );
+         }
+
+         const uint32 waitedTime = TimeUtility::getCurrentTime() - startTime;
+         if ( m_fetching[ key ] == 0 || waitedTime >= m_maxWait ) {
+            break;
+         }
+         // Someone else is asking the provider, wait for the reply.
+         if ( ! waited ) {
+            ++m_stats.coalesced;
+            waited = true;
+         }
+         m_monitor.wait( m_maxWait - waitedTime );
+      }
+      // The caller will ask the provider.
+      ++m_fetching[ key ];
+   }
+
+   // Look in memcached without holding the lock.
+   Entry entry;
+   if ( findShared( key, now, entry ) ) {
+      ISABSync sync( m_monitor );
+      ++m_stats.memcachedHits;
+      add( entry );
+      release( key );
+      return makeReply( entry, req );
+   }
+
+   ISABSync sync( m_monitor );
+   ++m_stats.misses;
+   return NULL;
+}
+
+void
+ExtSearchCache::insert( const MC2String& key,
+                        const ReplyPacket& reply,
+                        uint32 ttl,
+                        uint32 now )
+{
+   if ( m_maxNbrEntries == 0 ) {
+      return;
+   }
+   Entry entry;
+   entry.key = key;
+   entry.expires = now + ttl;
+   entry.status = reply.getStatus();
+   entry.body.assign( reply.getBuf() + REPLY_HEADER_SIZE,
+                      reply.getBuf() + reply.getLength() );
+   if ( ttl > 0 ) {
+      addShared( entry, ttl );
+   }
+
+   ISABSync sync( m_monitor );
+   if ( ttl > 0 ) {
+      add( entry );
+   }
+   release( key );
+}
+
+void
+ExtSearchCache::cancel( const MC2String& key )
+{
+   ISABSync sync( m_monitor );
+   release( key );
+}
+
+ExtSearchCache::Statistics
+ExtSearchCache::getStatistics() const
+{
+   ISABSync sync( m_monitor );
+   Statistics stats = m_stats;
+   stats.nbrEntries = m_index.size();
+   return stats;
+}
+
+void
+ExtSearchCache::add( const Entry& entry )
+{
+   Index::iterator it = m_index.find( entry.key );
+   if ( it != m_index.end() ) {
+      m_entries.erase( it->second );
+      m_index.erase( it );
+   }
+   m_entries.push_front( entry );
+   m_index[ entry.key ] = m_entries.begin();
+   while ( m_index.size() > m_maxNbrEntries ) {
+      m_index.erase( m_entries.back().key );
+      m_entries.pop_back();
+   }
+}
+
+void
+ExtSearchCache::release( const MC2String& key )
+{
+   std::map< MC2String, uint32 >::iterator it = m_fetching.find( key );
+   if ( it != m_fetching.end() && --it->second == 0 ) {
+      m_fetching.erase( it );
+   }
+   m_monitor.notifyAll();
+}
+
+bool
+ExtSearchCache::findShared( const MC2String& key, uint32 now, Entry& entry )
+{
+#ifdef HAVE_MEMCACHED
+   if ( m_shared.get() != NULL &&
+        m_shared->get( HashUtility::createMD5Hash( key ), entry ) ) {
+      // The md5 could collide, check the whole key
+      return entry.key == key && entry.expires > now;
+   }
+#endif
+   return false;
+}
+
+void
+ExtSearchCache::addShared( const Entry& entry, uint32 ttl )
+{
+#ifdef HAVE_MEMCACHED
+   if ( m_shared.get() != NULL ) {
+      m_shared->set( HashUtility::createMD5Hash( entry.key ), entry, ttl );
+   }
+#endif
+}
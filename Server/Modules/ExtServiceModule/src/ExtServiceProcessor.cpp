@@ -30,13 +30,18 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 
 #include "ExternalSearchHeadingDesc.h"
 #include "ExtServicePacket.h"
+#include "ParallelURLFetcher.h"
+#include "ExtSearchCache.h"
+#include "TimeUtility.h"
 
 #include <memory>
 
 ExtServiceProcessor::
 ExtServiceProcessor( MapSafeVector* loadedMaps ):
    Processor(loadedMaps),
-   m_searchDescGenerator( new ExternalSearchDescGenerator() )
+   m_searchDescGenerator( new ExternalSearchDescGenerator() ),
+   m_statisticsTimer( 60 ),
+   m_lastNbrRequests( 0 )
 {
    Talkers::setupTalkers( m_talkerMap, m_talkers );
 }
@@ -65,6 +70,7 @@ ExtServiceProcessor::handleRequestPacket( const RequestPacket& request,
       break;
    case Packet::PACKETTYPE_PERIODIC_REQUEST:
       // Periodic checkups here
+      logProviderStatistics();
       break;
    case Packet::PACKETTYPE_EXTSERVICE_LIST_REQUEST:
       reply = handleExtServiceRequest( request );
@@ -79,6 +85,37 @@ ExtServiceProcessor::handleRequestPacket( const RequestPacket& request,
 }
 
 
+void
+ExtServiceProcessor::logProviderStatistics() {
+   if ( ! m_statisticsTimer.isDue() ) {
+      return;
+   }
+
+   ParallelURLFetcher::Statistics stats = 
+      ParallelURLFetcher::getStatistics();
+   uint32 nbrRequests = 0;
+   for ( ParallelURLFetcher::Statistics::const_iterator it = stats.begin();
+         it != stats.end(); ++it ) {
+      nbrRequests += it->second.nbrRequests;
+   }
+   if ( nbrRequests == m_lastNbrRequests ) {
+      return;
+   }
+   m_lastNbrRequests = nbrRequests;
+
+   for ( ParallelURLFetcher::Statistics::const_iterator it = stats.begin();
+         it != stats.end(); ++it ) {
+      const ParallelURLFetcher::ProviderStatistics& s = it->second;
+      mc2log << info << "[EXTP]: Provider " << it->first
+             << " requests " << s.nbrRequests
+             << " errors " << s.nbrErrors
+             << " timeouts " << s.nbrTimeouts
+             << " reused " << s.nbrReused
+             << " avg " << ( s.totalTime / MAX( s.nbrRequests, 1u ) )
+             << " ms max " << s.maxTime << " ms" << endl;
+   }
+}
+
 int 
 ExtServiceProcessor::getCurrentStatus() {
    return 0;
@@ -184,16 +221,47 @@ ExtServiceProcessor::handleTalkerSearch(
       return NULL;
    }
 
+   sprintf( packetInfo, talker->getServiceName().c_str() );
+
+   ExtSearchCache& cache = ExtSearchCache::getInstance();
+   const uint32 ttl = cache.getTTL( talker->getServiceName() );
+   const bool useCache = cache.isEnabled( talker->getServiceName() );
+   const MC2String key = ExtSearchCache::makeKey( searchData );
+   if ( useCache ) {
+      ReplyPacket* reply = cache.find( key, extReq, 
+                                       TimeUtility::getRealTime() );
+      if ( reply != NULL ) {
+         mc2dbg << "[EXTP]: Search reply from cache" << endl;
+         return reply;
+      }
+   }
+
    SearchReplyData searchReply;
-   int result = talker->doQuery( searchReply, searchData, 1 );
+   int result = -1;
+   try {
+      result = talker->doQuery( searchReply, searchData, 1 );
+   } catch ( ... ) {
+      // Let the waiting searches ask the provider themselves
+      if ( useCache ) {
+         cache.cancel( key );
+      }
+      throw;
+   }
    ReplyPacket* reply = new ExternalSearchReplyPacket( extReq,
                                                        searchReply );
 
-   sprintf( packetInfo, talker->getServiceName().c_str() );
-
    if ( result < 0 ) {
       reply->setStatus( StringTable::NOTOK );
    }
+
+   if ( useCache ) {
+      if ( result < 0 ) {
+         // Do not keep errors, the next search asks the provider again
+         cache.cancel( key );
+      } else {
+         cache.insert( key, *reply, ttl, TimeUtility::getRealTime() );
+      }
+   }
    
    return reply;
 }
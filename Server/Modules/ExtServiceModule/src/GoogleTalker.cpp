@@ -33,7 +33,7 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include "ExternalSearchDesc.h"
 #include "ExtServices.h"
 
-#include "URLFetcher.h"
+#include "ParallelURLFetcher.h"
 #include "HttpHeader.h"
 #include "URL.h"
 #include "URLParams.h"
@@ -248,7 +248,7 @@ void createSearchMatches( vector< VanillaMatch* >& finalMatches,
 
 GoogleTalker::GoogleTalker():
    ExtServiceTalker( "Google" ),
-   m_urlFetcher( new URLFetcher() ),
+   m_urlFetcher( new ParallelURLFetcher() ),
    m_matches( new GoogleMatches() ),
    m_estimatedResultCount( 0 ) {
 
@@ -340,7 +340,7 @@ GoogleTalker::doQuery( SearchReplyData& reply,
 
    MC2String jsonResult;
    HttpHeader urlHeader;
-   m_urlFetcher->get( jsonResult, url,
+   m_urlFetcher->get( jsonResult, "Google", url,
                       5000,  // timeout in ms
                       &urlHeader );
 
@@ -14,7 +14,7 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include "QypeHandler.h"
 
 #include "HttpHeader.h"
-#include "URLFetcher.h"
+#include "ParallelURLFetcher.h"
 #include "Properties.h"
 #include "TalkerUtility.h"
 #include "SearchFields.h"
@@ -35,6 +35,7 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include "ExtInfoQuery.h"
 #include "Encoding.h"
 #include "POIReview.h"
+#include "DeleteHelpers.h"
 
 static const uint32 MAX_REVIEWS = 10;
 static const uint32 MAX_IMAGES = 10;
@@ -169,7 +170,7 @@ QypeHandler::QypeHandler() :
                                               "" ) ),
       m_qypeUrl( Properties::getProperty( "QYPE_URL",
                                           "http://api.qype.com/v1/" ) ),
-      m_urlFetcher( new URLFetcher() ),
+      m_urlFetcher( new ParallelURLFetcher() ),
       m_matches( new QypeHandler::Matches() ),
       m_reviews( new QypeHandler::ReviewMatches() ),
       m_images( new QypeHandler::ImageMatches() ) {
@@ -338,7 +339,7 @@ QypeHandler::sendRequest( MC2String& qype_xml,
    mc2dbg << "[QypeHandler]: URL request " << MC2CITE( url ) << endl;
 
    HttpHeader urlHeader;
-   int res = m_urlFetcher->get( qype_xml, URL( url ), 
+   int res = m_urlFetcher->get( qype_xml, "Qype", URL( url ), 
                                 Properties::getUint32Property( "QYPE_TIMEOUT",
                                                                5000 ),
                                 &urlHeader );
@@ -510,25 +511,54 @@ QypeHandler::createSearchMatches( vector<VanillaMatch*>& finalMatches,
          // Check if we have any reviews or photos to parse
          URLParams params;
          params.add("consumer_key", m_consumerKey );
+         const MC2String paramString( params );
 
-         // Get the reviews
+         // Fetch the reviews and the images at the same time
          vector<ReviewLink> reviewLinks = match.m_reviewLinks;
          filterReviews( reviewLinks, lang );
+         vector<AssetsLink> images = match.m_imageLinks;
+         typedef ParallelURLFetcher::Request Request;
+         STLUtility::AutoContainer< vector< Request* > > reviewRequests;
+         STLUtility::AutoContainer< vector< Request* > > imageRequests;
+         // Only fetch the links needed for MAX_REVIEWS and MAX_IMAGES
+         uint32 reviewsLeft = MAX_REVIEWS;
+         for ( vector< ReviewLink >::const_iterator it = reviewLinks.begin(); 
+               it != reviewLinks.end() && reviewsLeft > 0; ++it ) {
+            if ( it->m_count > 0 ) {
+               reviewRequests.push_back( 
+                  new Request( "Qype", URL( it->m_href + paramString ) ) );
+               reviewsLeft -= MIN( reviewsLeft, it->m_count );
+            }
+         }
+         uint32 imagesLeft = MAX_IMAGES;
+         for ( vector< AssetsLink >::const_iterator it = images.begin(); 
+               it != images.end() && imagesLeft > 0; ++it ) {
+            if ( it->m_count > 0 ) {
+               imageRequests.push_back( 
+                  new Request( "Qype", URL( it->m_href + paramString ) ) );
+               imagesLeft -= MIN( imagesLeft, it->m_count );
+            }
+         }
+         vector< Request* > requests( reviewRequests.begin(), 
+                                      reviewRequests.end() );
+         requests.insert( requests.end(), 
+                          imageRequests.begin(), imageRequests.end() );
+         m_urlFetcher->fetch( requests, 
+                              Properties::getUint32Property( "QYPE_TIMEOUT",
+                                                             5000 ) );
+
+         // Get the reviews
          if ( ! reviewLinks.empty() ) {                     
-            MC2String xml_result;
             vector< POIReview > reviews;
             uint32 reviewsToFetch = MAX_REVIEWS;
-            for ( vector< ReviewLink >::const_iterator it = reviewLinks.begin(); 
-                  it != reviewLinks.end() && reviewsToFetch > 0; ++it ) {
-               if ( it->m_count > 0 ) {
-                  MC2String url = it->m_href;
-                  url += params;                  
-                  int res = sendRequest( xml_result, url ); 
-                  if ( res != 200 ) {
-                     mc2log << warn << "[QypeHandler] Failed to fetch review url: " << url << endl;
-                  } else {
-                     parseReviews( xml_result, url, reviewsToFetch, reviews );
-                  }
+            for ( uint32 i = 0; 
+                  i < reviewRequests.size() && reviewsToFetch > 0; ++i ) {
+               Request& req = *reviewRequests[ i ];
+               MC2String url = req.getURL().getSpec();
+               if ( req.getStatus() != 200 ) {
+                  mc2log << warn << "[QypeHandler] Failed to fetch review url: " << url << endl;
+               } else {
+                  parseReviews( req.getBody(), url, reviewsToFetch, reviews );
                }
             }
 
@@ -537,22 +567,17 @@ QypeHandler::createSearchMatches( vector<VanillaMatch*>& finalMatches,
          }
          
          // Get the images
-         vector<AssetsLink> images = match.m_imageLinks;
          if( ! images.empty() ) {
-            MC2String xml_result;
             vector< MC2String > imageURLs;
             uint32 imagesToFetch = MAX_IMAGES;
-            for ( vector< AssetsLink >::const_iterator it = images.begin(); 
-                  it != images.end() && imagesToFetch > 0; ++it ) {
-               if ( it->m_count > 0 ) {
-                  MC2String url = it->m_href;
-                  url += params;                  
-                  int res = sendRequest( xml_result, url ); 
-                  if ( res != 200 ) {
-                     mc2log << warn << "[QypeHandler] Failed to fetch images url: " << url << endl;
-                  } else {
-                     parseImages( xml_result, url, imagesToFetch, imageURLs );
-                  }
+            for ( uint32 i = 0; 
+                  i < imageRequests.size() && imagesToFetch > 0; ++i ) {
+               Request& req = *imageRequests[ i ];
+               MC2String url = req.getURL().getSpec();
+               if ( req.getStatus() != 200 ) {
+                  mc2log << warn << "[QypeHandler] Failed to fetch images url: " << url << endl;
+               } else {
+                  parseImages( req.getBody(), url, imagesToFetch, imageURLs );
                }
             }       
             mc2dbg << "[QypeHandler] #" << imageURLs.size() << " imagess." << endl;            
@@ -17,6 +17,7 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include "config.h"
 
 #include "Processor.h"
+#include "IntervalTimer.h"
 
 class GfxFeatureMapImageReplyPacket;
 class GfxFeatureMapImageRequestPacket;
@@ -88,6 +89,8 @@ private:
    ServerTileMapFormatDesc* m_stmfd;
    /// Translation table for custom poi images.
    POIImageIdentificationTable* m_poiImageTable;
+   /// When the drawing caches are due to be logged.
+   IntervalTimer m_statisticsTimer;
 };
 
 #endif
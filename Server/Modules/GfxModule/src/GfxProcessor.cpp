@@ -37,7 +37,8 @@ GfxProcessor::GfxProcessor( MapSafeVector* loadedMaps,
    m_stmfd( new 
             ServerTileMapFormatDesc( STMFDParams( LangTypes::english, 
                                                   false ) ) ),
-   m_poiImageTable( NULL )
+   m_poiImageTable( NULL ),
+   m_statisticsTimer( 60 )
 {
    m_stmfd->setData();
    m_poiImageTable = new POIImageIdentificationTable( *m_stmfd );
@@ -99,6 +100,11 @@ processGfxFeatureMapImageRequest( const GfxFeatureMapImageRequestPacket* p)
       reply.reset( new GfxFeatureMapImageReplyPacket(imageSize, p, true) );
      
       reply->setImageData(imageSize, imageBuff.get());
+
+      if ( m_statisticsTimer.isDue() ) {
+         mc2log << info << "[GfxProcessor] Drawing caches:" << endl;
+         MapDrawer::printCacheStatistics( mc2log );
+      }
      
    } else {
 
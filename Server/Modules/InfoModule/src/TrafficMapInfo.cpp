@@ -275,6 +275,17 @@ removeDisturbance( const DisturbanceElement* disturbance ) {
 
 void TrafficMapInfo::
 updateDisturbances( Disturbances& updated, const Disturbances& removed ) {
+   // Remove first, a changed disturbance is both removed and updated
+   for ( Disturbances::const_iterator
+            it = removed.begin(), itEnd = removed.end();
+         it != itEnd; ++it ) {
+      const Disturbances::value_type disturbance = *it;
+      if ( disturbance->getSituationReference().empty() ) {
+         continue;
+      }
+      m_impl->removeDisturbance( disturbance );
+   }
+
    Disturbances notAdded;
    for ( Disturbances::iterator it = updated.begin(), itEnd = updated.end();
          it != itEnd; ++it ) {
@@ -291,15 +302,5 @@ updateDisturbances( Disturbances& updated, const Disturbances& removed ) {
    updated.clear();
    // destroy the disturbances that wasn't added or updated.
    STLUtility::deleteValues( notAdded );
-
-   for ( Disturbances::const_iterator
-            it = removed.begin(), itEnd = removed.end();
-         it != itEnd; ++it ) {
-      const Disturbances::value_type disturbance = *it;
-      if ( disturbance->getSituationReference().empty() ) {
-         continue;
-      }
-      m_impl->removeDisturbance( disturbance );
-   }
 }
 
@@ -0,0 +1,122 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "MC2UnitTestMain.h"
+
+#include "MapCoverageIndex.h"
+#include "MapModuleNoticeContainer.h"
+#include "MapModuleNotice.h"
+#include "MC2BoundingBox.h"
+#include "GfxDataFull.h"
+#include "MapBits.h"
+
+#include <stdlib.h>
+
+namespace {
+
+/// Adds a map covering a triangle with the corners in the box.
+void addMap( WriteableMapModuleNoticeContainer& maps, uint32 mapID,
+             int32 lat, int32 lon, int32 size ) {
+   GfxDataFull gfx;
+   gfx.addCoordinate( lat, lon, true );
+   gfx.addCoordinate( lat, lon + size );
+   gfx.addCoordinate( lat + size, lon );
+   gfx.setClosed( 0, true );
+   gfx.updateBBox();
+   // Copies the gfx and sets the bounding box like when loaded.
+   MapModuleNotice* notice = new MapModuleNotice( mapID );
+   notice->setGfxData( &gfx );
+   maps.addLast( notice );
+}
+
+}
+
+MC2_UNIT_TEST_FUNCTION( sameAsLinearTest ) {
+   srand( 4711 );
+   WriteableMapModuleNoticeContainer maps;
+   for ( uint32 i = 0; i < 200; ++i ) {
+      addMap( maps, i, rand() % 100000, rand() % 100000, 
+              1000 + rand() % 20000 );
+   }
+   // A country map covering all the others.
+   addMap( maps, FIRST_OVERVIEWMAP_ID + 1, -1000, -1000, 300000 );
+
+   MapCoverageIndex index( maps );
+   MC2_TEST_CHECK( index.getNbrMaps() == maps.getSize() );
+
+   uint32 nbrFound = 0;
+   for ( uint32 i = 0; i < 2000; ++i ) {
+      int32 lat = rand() % 120000;
+      int32 lon = rand() % 120000;
+      vector<uint32> expected;
+      for ( uint32 pos = 0; pos < maps.getSize(); ++pos ) {
+         if ( maps[ pos ]->getGfxData()->insidePolygon( lat, lon ) > 0 ) {
+            expected.push_back( pos );
+         }
+      }
+      vector<uint32> candidates;
+      index.getCandidates( lat, lon, candidates );
+      vector<uint32> found;
+      for ( uint32 c = 0; c < candidates.size(); ++c ) {
+         MC2_TEST_CHECK( maps[ candidates[ c ] ]->getBBox().
+                         contains( lat, lon ) );
+         if ( index.insidePolygon( candidates[ c ], lat, lon ) > 0 ) {
+            found.push_back( candidates[ c ] );
+         }
+      }
+      MC2_TEST_CHECK( found == expected );
+      nbrFound += found.size();
+   }
+   MC2_TEST_CHECK( nbrFound > 2000 );
+
+   // Bounding boxes.
+   for ( uint32 i = 0; i < 200; ++i ) {
+      int32 lat = rand() % 120000;
+      int32 lon = rand() % 120000;
+      MC2BoundingBox bbox( lat + rand() % 5000, lon, lat, 
+                           lon + rand() % 5000 );
+      vector<uint32> expected;
+      for ( uint32 pos = 0; pos < maps.getSize(); ++pos ) {
+         if ( bbox.overlaps( maps[ pos ]->getBBox() ) ) {
+            expected.push_back( pos );
+         }
+      }
+      vector<uint32> candidates;
+      index.getCandidates( bbox, candidates );
+      vector<uint32> found;
+      for ( uint32 c = 0; c < candidates.size(); ++c ) {
+         if ( bbox.overlaps( maps[ candidates[ c ] ]->getBBox() ) ) {
+            found.push_back( candidates[ c ] );
+         }
+      }
+      MC2_TEST_CHECK( found == expected );
+   }
+}
+
+MC2_UNIT_TEST_FUNCTION( dateLineTest ) {
+   WriteableMapModuleNoticeContainer maps;
+   addMap( maps, 0, 0, 0, 1000 );
+   addMap( maps, 1, 0, MAX_INT32 - 500, 1000 );
+
+   MapCoverageIndex index( maps );
+   // The map crossing the date line is always a candidate.
+   vector<uint32> candidates;
+   index.getCandidates( 100, 100, candidates );
+   MC2_TEST_REQUIRED( candidates.size() == 2 );
+   MC2_TEST_CHECK( candidates[ 0 ] == 0 );
+   MC2_TEST_CHECK( candidates[ 1 ] == 1 );
+   MC2_TEST_CHECK( index.insidePolygon( 1, 100, 100 ) ==
+                   maps[ 1 ]->getGfxData()->insidePolygon( 100, 100 ) );
+   MC2_TEST_CHECK( index.insidePolygon( 0, 100, 100 ) == 2 );
+}
@@ -0,0 +1,96 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#ifndef MAPCOVERAGEINDEX_H
+#define MAPCOVERAGEINDEX_H
+
+#include "config.h"
+#include "BoundingBoxTree.h"
+#include "NotCopyable.h"
+
+#include <vector>
+
+class MapModuleNoticeContainer;
+class MC2BoundingBox;
+class PreparedGfxData;
+
+/**
+  *   Index of the coverage of the maps in a MapModuleNoticeContainer,
+  *   used by the MapReader to find the maps at a coordinate or in a
+  *   bounding box.
+  *
+  *   The bounding boxes of the maps are kept in an R-tree and the
+  *   coverage polygons of the underview maps are prepared for fast
+  *   point in polygon tests.
+  *
+  *   The maps are identified by their position in the container.
+  *   The index must be recreated when the maps in the container change.
+  */
+class MapCoverageIndex: private NotCopyable {
+ public:
+   /**
+    * Creates the index.
+    *
+    * @param maps The maps to index, must be kept as long as the index.
+    */
+   explicit MapCoverageIndex( const MapModuleNoticeContainer& maps );
+
+   ~MapCoverageIndex();
+
+   /// @return The number of maps indexed.
+   uint32 getNbrMaps() const { return m_polygons.size(); }
+
+   /**
+    * Finds the maps whose bounding box may contain a coordinate.
+    *
+    * @param lat       The latitude of the coordinate.
+    * @param lon       The longitude of the coordinate.
+    * @param positions Set to the positions of the maps in increasing
+    *                  order.
+    */
+   void getCandidates( int32 lat, int32 lon,
+                       std::vector<uint32>& positions ) const;
+
+   /**
+    * Finds the maps whose bounding box may overlap a bounding box.
+    *
+    * @param bbox      The bounding box.
+    * @param positions Set to the positions of the maps in increasing
+    *                  order.
+    */
+   void getCandidates( const MC2BoundingBox& bbox,
+                       std::vector<uint32>& positions ) const;
+
+   /**
+    * Same as GfxData::insidePolygon for the map at pos.
+    *
+    * @return 0 if outside, 1 on the boundry and 2 inside.
+    */
+   int insidePolygon( uint32 pos, int32 lat, int32 lon ) const;
+
+ private:
+   /// The maps.
+   const MapModuleNoticeContainer& m_maps;
+
+   /// The prepared polygons of the underview maps, NULL for the others.
+   std::vector<PreparedGfxData*> m_polygons;
+
+   /// The bounding boxes of the maps.
+   BoundingBoxTree m_tree;
+
+   /// Maps that cross the date line or have no gfx, always candidates.
+   std::vector<uint32> m_alwaysTested;
+};
+
+#endif // MAPCOVERAGEINDEX_H
@@ -42,6 +42,7 @@ class AllMapRequestPacket;
 class AllMapReplyPacket;
 class CopyrightBoxRequestPacket;
 class CopyrightBoxReplyPacket;
+class MapCoverageIndex;
 
 /**
   *   Class that handles some packets to the MapModule in a special way.
@@ -172,9 +173,9 @@ private:
             const SmallestRoutingCostRequestPacket* p ) const;
 
       /**
-        *   Used internal to get the map where a point is located.\\
-        *   {\it  Currently this method uses linear search among the 
-        *         maps!}
+        *   Used internal to get the map where a point is located.
+        *   Uses linear search among the maps if the point is outside
+        *   all the maps.
         *   
         *   @param   lat   The latitude for the point.
         *   @param   lon   The longitude for the point.
@@ -185,6 +186,14 @@ private:
       uint32 findMapFromCoordinate( int32 lat, int32 lon, float64* 
                                     mapDist = NULL );
 
+      /**
+        *   Used internally to get the underview maps whose coverage
+        *   contains a point.
+        *
+        *   @param   lat     The latitude for the point.
+        *   @param   lon     The longitude for the point.
+        *   @param   mapIDs  The ids of the maps are added here.
+        */
       void findMapsAtCoordinate(int32 lat, int32 lon, Vector* mapIDs); 
       
       /**
@@ -193,8 +202,6 @@ private:
         *   really are not covered, since it uses the boundingboxes of
         *   the maps to compare with. This on the other hand a 
         *   much faster way to do it.
-        *   {\it  Currently this method uses linear search among the 
-        *         maps!}
         *   
         *   @param   bbox     The boundingbox.
         *   @param   mapIDs   Preallocated empty vector which will 
@@ -248,6 +255,18 @@ private:
        */
       MapModuleNoticeContainer m_indexDB;
 
+      /**
+       *    Returns the index of the coverage of the maps in m_indexDB.
+       *    Creates it if the maps have changed since last time.
+       */
+      const MapCoverageIndex& getCoverageIndex();
+
+      /**
+       *    Index of the coverage of the maps in m_indexDB.
+       *    NULL until used.
+       */
+      MapCoverageIndex* m_coverageIndex;
+
       /**
        *    A table containing the smallest routing costs
        *    from map to map.
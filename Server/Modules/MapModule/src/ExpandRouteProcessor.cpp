@@ -1107,8 +1107,7 @@ ExpandRouteProcessor::addLandmarks(uint32 prevCountryID,
    ExpandRouteLink* curLink = 
       static_cast<ExpandRouteLink*>(prevLink->suc());
 
-   typedef GenericMap::landmarkTable_t::iterator LI;
-   GenericMap::landmarkTable_t lmTable = m_map->getLandmarkTable();
+   typedef GenericMap::LandmarkIndex::const_iterator LI;
    
 
    // Used when finding "pass"-buas resp "turn after"-buas
@@ -1241,56 +1240,55 @@ ExpandRouteProcessor::addLandmarks(uint32 prevCountryID,
       // First look if there are any landmarks in the landmark table
       uint32 fromNode = prevLink->m_nodeID;
       uint32 toNode = curLink->m_nodeID;
-      uint64 key = (uint64(fromNode) << 32) | uint64(toNode);
+      GenericMap::LandmarkRange landmarks =
+         m_map->getLandmarks( fromNode, toNode );
 
-      for (LI it = lmTable.lower_bound(key); 
-           it != lmTable.upper_bound(key); it++) {
-         if ( ((*it).first == key) &&  // not necessary? should be key
-              (allBuas.linearSearch((*it).second.itemID) == MAX_UINT32) &&
+      for (LI lm = landmarks.first; lm != landmarks.second; ++lm) {
+         if ( (allBuas.linearSearch(lm->value.itemID) == MAX_UINT32) &&
               !((static_cast<StreetSegmentItem*>(prevLink->m_item)->
-                  isControlledAccess()) && ((*it).second.importance == 4)) ) {
+                  isControlledAccess()) && (lm->value.importance == 4)) ) {
             // add the landmark to curLink
             // not if importance=4 and routing from ssi with controlled access
             
             // get the name of the landmark
             char name[50];
-            if ((*it).second.type == ItemTypes::railwayLM) {
+            if (lm->value.type == ItemTypes::railwayLM) {
                strcpy(name, StringTable::getString(StringTable::RAILWAYITEM,
                             StringTable::languageCode(
                                m_preferedLanguages.getElementAt(0))));
             } else if (StringUtility::strcasecmp(
-               m_map->getFirstItemName((*it).second.itemID), "missing") == 0) {
+               m_map->getFirstItemName(lm->value.itemID), "missing") == 0) {
                strcpy(name, "");
             } else {
                const char* tmpname = m_map->getItemName(
-                   (*it).second.itemID,
+                   lm->value.itemID,
                    LangTypes::language_t(m_preferedLanguages.getElementAt(0)),
                    ItemTypes::invalidName);
                if (tmpname != NULL)
                   strcpy(name, tmpname);
                else 
-                  strcpy(name, m_map->getFirstItemName((*it).second.itemID));
+                  strcpy(name, m_map->getFirstItemName(lm->value.itemID));
             }
             
             // get the dist of the landmark
             int32 dist = curLink->m_dist;
-            if (((*it).second.location == ItemTypes::pass) &&
-                ((*it).second.type == ItemTypes::builtUpAreaLM)) {
+            if ((lm->value.location == ItemTypes::pass) &&
+                (lm->value.type == ItemTypes::builtUpAreaLM)) {
                dist = dist / 2;
             }
             
-            mc2dbg1 << "Landmark: itemID=" << (*it).second.itemID 
+            mc2dbg1 << "Landmark: itemID=" << lm->value.itemID 
                     << " " << name 
-                    << " (lmTable: imp=" << int((*it).second.importance)
-                    << " loc=" << int((*it).second.location)
-                    << " side=" << int((*it).second.side) << ")" << endl;
+                    << " (lmTable: imp=" << int(lm->value.importance)
+                    << " loc=" << int(lm->value.location)
+                    << " side=" << int(lm->value.side) << ")" << endl;
             
             LandmarkLink* newLM = 
-               new LandmarkLink((*it).second, dist);
+               new LandmarkLink(lm->value, dist);
             newLM->setLMName(name);
             newLM->into(curLink->m_landmarks);
-            if ( (*it).second.type == ItemTypes::builtUpAreaLM ) {
-               allBuas.addLast((*it).second.itemID);
+            if ( lm->value.type == ItemTypes::builtUpAreaLM ) {
+               allBuas.addLast(lm->value.itemID);
             }
          }
       }
@@ -0,0 +1,103 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "MapCoverageIndex.h"
+
+#include "MapModuleNoticeContainer.h"
+#include "MapModuleNotice.h"
+#include "MC2BoundingBox.h"
+#include "GfxData.h"
+#include "PreparedGfxData.h"
+#include "MapBits.h"
+#include "DeleteHelpers.h"
+
+#include <algorithm>
+
+namespace {
+
+/**
+ * @return True if the box is not a plain longitude range, i.e. it
+ *         crosses the date line or is wider than half the earth.
+ *         MC2BoundingBox compares those with wrapping arithmetics.
+ */
+bool isWrapped( int32 minLon, int32 maxLon ) {
+   int64 width = int64( maxLon ) - minLon;
+   return width < 0 || width > MAX_INT32;
+}
+
+}
+
+MapCoverageIndex::MapCoverageIndex( const MapModuleNoticeContainer& maps )
+      : m_maps( maps ),
+        m_polygons( maps.getSize(), NULL ) {
+   for ( uint32 pos = 0; pos < m_maps.getSize(); ++pos ) {
+      const MapModuleNotice* mn = m_maps[ pos ];
+      const GfxData* gfx = mn->getGfxData();
+      if ( gfx == NULL || gfx->getNbrPolygons() == 0 ||
+           gfx->getNbrCoordinates( 0 ) == 0 ) {
+         m_alwaysTested.push_back( pos );
+         continue;
+      }
+      if ( MapBits::isUnderviewMap( mn->getMapID() ) ) {
+         m_polygons[ pos ] = new PreparedGfxData( *gfx );
+      }
+      const MC2BoundingBox& bbox = mn->getBBox();
+      if ( isWrapped( bbox.getMinLon(), bbox.getMaxLon() ) ) {
+         m_alwaysTested.push_back( pos );
+      } else {
+         m_tree.add( bbox, pos );
+      }
+   }
+   m_tree.build();
+}
+
+MapCoverageIndex::~MapCoverageIndex() {
+   STLUtility::deleteValues( m_polygons );
+}
+
+void
+MapCoverageIndex::getCandidates( int32 lat, int32 lon,
+                                 vector<uint32>& positions ) const {
+   positions = m_alwaysTested;
+   m_tree.getContaining( lat, lon, positions );
+   std::sort( positions.begin(), positions.end() );
+}
+
+void
+MapCoverageIndex::getCandidates( const MC2BoundingBox& bbox,
+                                 vector<uint32>& positions ) const {
+   if ( isWrapped( bbox.getMinLon(), bbox.getMaxLon() ) ) {
+      // All maps may overlap.
+      positions.resize( getNbrMaps() );
+      for ( uint32 pos = 0; pos < positions.size(); ++pos ) {
+         positions[ pos ] = pos;
+      }
+      return;
+   }
+   positions = m_alwaysTested;
+   m_tree.getOverlapping( bbox, positions );
+   std::sort( positions.begin(), positions.end() );
+}
+
+int
+MapCoverageIndex::insidePolygon( uint32 pos, int32 lat, int32 lon ) const {
+   if ( m_polygons[ pos ] != NULL ) {
+      return m_polygons[ pos ]->insidePolygon( lat, lon );
+   }
+   const GfxData* gfx = m_maps[ pos ]->getGfxData();
+   if ( gfx == NULL ) {
+      return 0;
+   }
+   return gfx->insidePolygon( lat, lon );
+}
@@ -44,13 +44,17 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include "MapModuleNotice.h"
 #include "MapSafeVector.h"
 #include "ProcessorFactory.h"
+#include "ExpandRouteProcessor.h"
+#include "ExpandRoutePacket.h"
 
 #include "DataBuffer.h"
 #include "FilePtr.h"
 #include "MapBits.h"
+#include "DeleteHelpers.h"
 
 #include <iostream>
 #include <vector>
+#include <map>
 #include <memory>
 #include <stdlib.h>
 
@@ -62,6 +66,7 @@ void mmExit();
 int testLoadAll();
 bool uint32StringToVector( const char* ids, vector<uint32>& list );
 void playBackFromFile( FILE* file, const char* packetFileName );
+void benchExpandRoute( FILE* file, uint32 nbrIterations );
 
 bool saveModuleMap( uint32 mapID, uint32 mapType, 
                     MapModuleNoticeContainer* indexdb = NULL,
@@ -222,6 +227,8 @@ try {
    char* mapsToSave = NULL;
    
    char* CL_profileFile = NULL;
+   char* CL_benchExpandFile = NULL;
+   uint32 CL_benchIterations = 10;
    bool CL_testLoadAll = false;
    bool CL_cacheUpdate = false;
 
@@ -243,6 +250,18 @@ try {
                   "thread and read packets of the format 4 bytes len, "
                   "len bytes packet from file");
 
+   coh->addOption("", "--bench-expand-route",
+                  CommandlineOptionHandler::stringVal,
+                  1, &CL_benchExpandFile, "",
+                  "Replay the expand route requests in a file saved with "
+                  "--save-packets, print the time to expand the routes and "
+                  "to look up their landmarks, and exit");
+
+   coh->addOption("", "--bench-iterations",
+                  CommandlineOptionHandler::uint32Val,
+                  1, &CL_benchIterations, "10",
+                  "Number of times --bench-expand-route replays the file");
+
    coh->addOption("", "--saveSearchMap",
                   CommandlineOptionHandler::stringVal,
                   1, &searchMapsToSave, "",              
@@ -338,6 +357,20 @@ try {
       exit( 0 );
    }
 
+   if ( CL_benchExpandFile != NULL && *CL_benchExpandFile != '\0' ) {
+      FileUtils::FilePtr benchFD( fopen( CL_benchExpandFile, "r" ) );
+      if ( benchFD.get() == NULL ) {
+         mc2dbg << fatal << "[MM]: Can not load bench file: "
+                << CL_benchExpandFile << endl;
+         mc2dbg << fatal << " Error: " << strerror( errno ) << endl;
+         exit( EXIT_FAILURE );
+      }
+
+      benchExpandRoute( benchFD.get(), CL_benchIterations );
+
+      exit( 0 );
+   }
+
    mapModule->init();
    mapModule->start();
    mapModule->gotoWork( init );
@@ -625,3 +658,128 @@ playBackFromFile(FILE* file, const char* packetFileName)
       delete processor.handleRequest(packet, packinfo);
    }
 }
+
+void
+benchExpandRoute( FILE* file, uint32 nbrIterations )
+{
+   // Read the routes and load their maps, other packets are skipped.
+   vector<ExpandRouteRequestPacket*> routes;
+   map<uint32, GenericMap*> maps;
+   while ( ! feof( file ) ) {
+      Packet* packet = PacketUtils::loadPacketFromFile( file );
+      if ( packet == NULL ) {
+         break;
+      }
+      if ( packet->getSubType() != Packet::PACKETTYPE_EXPANDROUTEREQUEST ) {
+         delete packet;
+         continue;
+      }
+      ExpandRouteRequestPacket* route =
+         static_cast<ExpandRouteRequestPacket*>( packet );
+      uint32 mapID = route->getMapID();
+      if ( maps.find( mapID ) == maps.end() ) {
+         maps[ mapID ] = GenericMap::createMap( mapID );
+      }
+      if ( maps[ mapID ] == NULL ) {
+         mc2log << error << "[MM]: Could not load map "
+                << prettyMapIDFill( mapID ) << endl;
+         delete route;
+         continue;
+      }
+      routes.push_back( route );
+   }
+
+   // The connections of each route, as passed by addLandmarks.
+   vector< vector< pair<uint32, uint32> > > connections( routes.size() );
+   uint32 nbrConnections = 0;
+   for ( uint32 i = 0; i < routes.size(); ++i ) {
+      list<uint32> nodeIDs;
+      routes[ i ]->getRouteItems( maps[ routes[ i ]->getMapID() ], nodeIDs );
+      uint32 prevNodeID = MAX_UINT32;
+      for ( list<uint32>::const_iterator it = nodeIDs.begin();
+            it != nodeIDs.end(); ++it ) {
+         if ( prevNodeID != MAX_UINT32 ) {
+            connections[ i ].push_back( make_pair( prevNodeID, *it ) );
+         }
+         prevNodeID = *it;
+      }
+      nbrConnections += connections[ i ].size();
+   }
+
+   // The landmark table as the maps kept it before the landmark index.
+   map<uint32, GenericMap::landmarkTable_t> tables;
+   for ( map<uint32, GenericMap*>::const_iterator it = maps.begin();
+         it != maps.end(); ++it ) {
+      if ( it->second == NULL ) {
+         continue;
+      }
+      const GenericMap::LandmarkIndex& index =
+         it->second->getLandmarkIndex();
+      GenericMap::landmarkTable_t& table = tables[ it->first ];
+      for ( GenericMap::LandmarkIndex::const_iterator lm = index.begin();
+            lm != index.end(); ++lm ) {
+         table.insert( make_pair( lm->key, lm->value ) );
+      }
+   }
+
+   ExpandRouteProcessor expander;
+   uint32 startTime = TimeUtility::getCurrentTime();
+   for ( uint32 it = 0; it < nbrIterations; ++it ) {
+      for ( uint32 i = 0; i < routes.size(); ++i ) {
+         delete expander.processExpandRouteRequestPacket(
+            routes[ i ], maps[ routes[ i ]->getMapID() ] );
+      }
+   }
+   const uint32 expandTime = TimeUtility::getCurrentTime() - startTime;
+
+   // The old scan copied the whole table for every expansion.
+   uint32 nbrOldLandmarks = 0;
+   startTime = TimeUtility::getCurrentTime();
+   for ( uint32 it = 0; it < nbrIterations; ++it ) {
+      for ( uint32 i = 0; i < routes.size(); ++i ) {
+         GenericMap::landmarkTable_t lmTable =
+            tables[ routes[ i ]->getMapID() ];
+         for ( uint32 c = 0; c < connections[ i ].size(); ++c ) {
+            uint64 key = ( uint64( connections[ i ][ c ].first ) << 32 ) |
+               uint64( connections[ i ][ c ].second );
+            for ( GenericMap::landmarkTable_t::const_iterator lm =
+                     lmTable.lower_bound( key );
+                  lm != lmTable.upper_bound( key ); ++lm ) {
+               ++nbrOldLandmarks;
+            }
+         }
+      }
+   }
+   const uint32 oldScanTime = TimeUtility::getCurrentTime() - startTime;
+
+   uint32 nbrLandmarks = 0;
+   startTime = TimeUtility::getCurrentTime();
+   for ( uint32 it = 0; it < nbrIterations; ++it ) {
+      for ( uint32 i = 0; i < routes.size(); ++i ) {
+         const GenericMap* theMap = maps[ routes[ i ]->getMapID() ];
+         for ( uint32 c = 0; c < connections[ i ].size(); ++c ) {
+            GenericMap::LandmarkRange range =
+               theMap->getLandmarks( connections[ i ][ c ].first,
+                                     connections[ i ][ c ].second );
+            nbrLandmarks += distance( range.first, range.second );
+         }
+      }
+   }
+   const uint32 indexTime = TimeUtility::getCurrentTime() - startTime;
+
+   cout << routes.size() << " routes, " << nbrConnections
+        << " connections, " << maps.size() << " maps, "
+        << nbrIterations << " iterations" << endl;
+   cout << "Expand: " << expandTime << " ms" << endl;
+   cout << "Landmarks, old scan: " << oldScanTime << " ms, "
+        << nbrOldLandmarks << " found" << endl;
+   cout << "Landmarks, index: " << indexTime << " ms, "
+        << nbrLandmarks << " found" << endl;
+   if ( nbrLandmarks != nbrOldLandmarks ) {
+      cout << "The index and the old scan found different landmarks!"
+           << endl;
+   }
+
+   STLUtility::deleteValues( routes );
+   STLUtility::deleteAllSecond( maps );
+}
@@ -69,6 +69,8 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include "MapGenerator.h"
 
 #include "MapBits.h"
+#include "SimpleBalancer.h"
+#include "MapCoverageIndex.h"
 #include "Math.h"
 
 MapReader::MapReader(Queue *q,
@@ -89,14 +91,30 @@ MapReader::MapReader(Queue *q,
    this->m_startWithMaps = startWithMaps;
    // Create the table 
    m_routingCostTable = new MMRoutingCostTable();
+   m_coverageIndex = NULL;
 }
 
 
 MapReader::~MapReader()
 {
+   delete m_coverageIndex;
    delete m_routingCostTable;
 }
 
+const MapCoverageIndex&
+MapReader::getCoverageIndex()
+{
+   if ( m_coverageIndex == NULL ||
+        m_coverageIndex->getNbrMaps() != m_indexDB.getSize() ) {
+      delete m_coverageIndex;
+      DebugClock clock;
+      m_coverageIndex = new MapCoverageIndex( m_indexDB );
+      mc2dbg << "[MapReader] Indexed the coverage of "
+             << m_indexDB.getSize() << " maps in " << clock << endl;
+   }
+   return *m_coverageIndex;
+}
+
 inline MapReplyPacket*
 MapReader::handleMapRequestPacket(Packet* p)
 {
@@ -810,6 +828,7 @@ MapReader::initLeader(set<MapID>& allMaps)
       } else {
          mc2dbg2 << "To insert " << m_indexDB.getSize() 
             << " maps into the allMap array" << endl;
+         map<MapID, MC2BoundingBox> mapBoxes;
          for (uint32 i=0; i < m_indexDB.getSize(); i++)
          {
             if ( (mn = m_indexDB[i]) != NULL){
@@ -817,6 +836,7 @@ MapReader::initLeader(set<MapID>& allMaps)
                mc2dbg4 << "Inserts map ID " << mapID 
                        << " inte the allMaps array" << endl;
                allMaps.insert( mapID );
+               mapBoxes[ mapID ] = mn->getBBox();
             } else {
                mc2log << error << "ERROR: dynamic_cast<MapModuleNotice*> "
                       << "(m_indexDB[" 
@@ -824,6 +844,12 @@ MapReader::initLeader(set<MapID>& allMaps)
                exit(2);
             }
          }
+         // The index already has the boxes, no need to ask for them.
+         SimpleBalancer* simpleBalancer =
+            dynamic_cast<SimpleBalancer*>( m_balancer );
+         if ( simpleBalancer != NULL ) {
+            simpleBalancer->setMapBoundingBoxes( mapBoxes );
+         }
       }
 
    } else {
@@ -844,6 +870,25 @@ MapReader::findMapFromCoordinate(int32 lat, int32 lon, float64* mapDist)
       mc2dbg2 << "FindMapFromCoordinate(" << lat <<", " << lon 
               << ")" << endl;
 
+      // The first map with the point inside or on the boundry is
+      // returned. Those maps have a bounding box containing the point.
+      vector<uint32> candidates;
+      getCoverageIndex().getCandidates( lat, lon, candidates );
+      for ( uint32 c = 0; c < candidates.size(); ++c ) {
+         const MapModuleNotice* mn = m_indexDB[ candidates[ c ] ];
+         if ( MapBits::isUnderviewMap( mn->getMapID() ) ) {
+            float64 tmpDist = mn->getGfxData()->signedSquareDistTo(lat, lon);
+            if ( tmpDist <= 0 ) {
+               mc2dbg2 << "   Inside map " << mn->getMapID() << endl;
+               if ( mapDist != NULL ) {
+                  *mapDist = tmpDist;
+               }
+               return mn->getMapID();
+            }
+         }
+      }
+
+      // Outside all maps, look for the closest one.
       uint32 closestID = MAX_UINT32;
       float64 closestDist = MAX_FLOAT64;
       uint32 i=0;
@@ -877,11 +922,14 @@ MapReader::findMapsAtCoordinate(int32 lat, int32 lon, Vector* mapIDs)
 {
   mc2dbg4 << "FindMapsAtCooridinate()" << endl;
    
-   for (uint32 i = 0; i < m_indexDB.getSize(); i++) {
+   const MapCoverageIndex& index = getCoverageIndex();
+   vector<uint32> candidates;
+   index.getCandidates( lat, lon, candidates );
+   for (uint32 c = 0; c < candidates.size(); c++) {
       // Add if orinary map and (lat,lon) inside that
-      const MapModuleNotice* mn = m_indexDB[i];
+      const MapModuleNotice* mn = m_indexDB[ candidates[ c ] ];
       if ( (MapBits::isUnderviewMap(mn->getMapID())) &&
-           (mn->getGfxData()->insidePolygon(lat, lon) > 0)) {
+           (index.insidePolygon( candidates[ c ], lat, lon ) > 0)) {
          mc2dbg4 << "   Coordinate inside map " << mn->getMapID() 
                  << endl;
          mapIDs->addLast(mn->getMapID());
@@ -931,8 +979,10 @@ MapReader::findMapsInMC2BoundingBox(const MC2BoundingBox* bbox,
    
    MC2BoundingBox mapBBox;
    
-   for (uint32 i = 0; i < m_indexDB.getSize(); i++) {      
-      const MapModuleNotice* mn = m_indexDB[i];
+   vector<uint32> candidates;
+   getCoverageIndex().getCandidates( *bbox, candidates );
+   for (uint32 c = 0; c < candidates.size(); c++) {      
+      const MapModuleNotice* mn = m_indexDB[ candidates[ c ] ];
          // Either only countrymaps or non-overviewmaps.
          if ( ( onlyAddCountryMaps && 
                 MapBits::isCountryMap( mn->getMapID() ) ) ||
@@ -104,6 +104,9 @@ class CalcRoute
        * @param sendSubRoutes   True if the answer should contain nodes.
        *                        If the results should only be sorted by cost
        *                        the subroutes does not have to contain nodes.
+       * @param nbrAlternatives The number of alternative routes to add
+       *                        to the result when the origin and the
+       *                        destination are on this map.
        * @return                A status code to tell if everything went
        *                        OK.
        */
@@ -117,7 +120,8 @@ class CalcRoute
                    bool routeToAll,
                    const DisturbanceVector* disturbances,
                    bool calcCostSums,
-                   bool sendSubRoutes);
+                   bool sendSubRoutes,
+                   uint32 nbrAlternatives = 0);
 
       /**
        *   Returns the external nodes that exist on the specified
@@ -237,7 +241,8 @@ class CalcRoute
                           bool originalRequest,
                           bool routeToAll,
                           bool calcCostSums,
-                          bool sendSubRoutes);
+                          bool sendSubRoutes,
+                          uint32 nbrAlternatives);
    
          /**
           * Initializes the route. If original is true this method calls 
@@ -954,6 +959,60 @@ class CalcRoute
       inline uint32 checkAdditionalCosts(RoutingNode* fromNode,
                                          RoutingNode* toNode);
 
+      /**
+       *   Adds up to nbrAlternatives alternative routes to the best
+       *   route that readResult has put in resultList. The alternatives
+       *   are found using one search from the origin and one from the
+       *   destination of the best route. Each node reached by both
+       *   searches gives a route via the node and the routes with
+       *   small stretch, little sharing with the routes already chosen
+       *   and a long plateau, i.e. a long part that is shortest path
+       *   in both searches, are chosen.
+       *   The alternatives are added with the same externals as the best
+       *   route and with SubRoute::setAlternative set.
+       *   @param resultList      The result of readResult.
+       *   @param driverParam     The driver preferences.
+       *   @param nbrAlternatives The maximum number of alternatives.
+       */
+      void calcAlternatives( SubRouteList* resultList,
+                             const RMDriverPref* driverParam,
+                             uint32 nbrAlternatives );
+
+      /**
+       *   The result of an alternativeSearch, indexed by node index.
+       *   Kept between the searches so the arrays are only allocated
+       *   once per map, only the reached nodes are reset.
+       */
+      struct AlternativeSearch {
+         /// The costs from start, MAX_UINT32 for nodes not reached.
+         vector<uint32> costs;
+         /// The previous node index for each node, MAX_UINT32 for
+         /// start and nodes not reached.
+         vector<uint32> parents;
+         /// The indices of the reached nodes.
+         vector<uint32> reached;
+      };
+
+      /**
+       *   Dijkstra search for calcAlternatives which does not touch the
+       *   costs in the RoutingNodes. The search continues until
+       *   the costs exceed the cost to target with the stretch added.
+       *   @param start       The node to start at.
+       *   @param target      The node to stop at.
+       *   @param forward     True to follow the connections forward.
+       *   @param driverParam The driver preferences.
+       *   @param stretch     The allowed extra cost in percent.
+       *   @param search      The result of the previous search, which
+       *                      is replaced.
+       *   @return The cost to target or MAX_UINT32 if not reached.
+       */
+      uint32 alternativeSearch( RoutingNode* start,
+                                RoutingNode* target,
+                                bool forward,
+                                const RMDriverPref* driverParam,
+                                uint32 stretch,
+                                AlternativeSearch& search );
+
 
       /**
        *   Reads the result from the supplied destination and fills 
@@ -1118,6 +1177,14 @@ class CalcRoute
     *   on from lower level nodes to lower level nodes.
     */
    MC2BoundingBox* m_outerLowerLevelBBox;
+
+   /**
+    *   The searches from the origin and from the destination of
+    *   calcAlternatives. Like the costs in the map they are used by
+    *   one thread at a time.
+    */
+   AlternativeSearch m_altForward;
+   AlternativeSearch m_altBackward;
    
 #ifdef USE_RESET_THREAD_IN_CALCROUTE
 
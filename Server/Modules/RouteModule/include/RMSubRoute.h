@@ -306,6 +306,19 @@ class RMSubRoute
        */
       inline void setForward( bool forward );
    
+      /**
+       *    @return 0 for the best route to the destination and 1, 2, ...
+       *            for the alternative routes to it.
+       */
+      inline uint16 getAlternative() const;
+
+      /**
+       *    Marks the subroute as an alternative route.
+       *    @param alternative The number of the alternative, 0 for
+       *                       the best route.
+       */
+      inline void setAlternative( uint16 alternative );
+
       /**
        */
       inline bool isNodeOnLowLevel( uint32 index );
@@ -486,6 +499,11 @@ class RMSubRoute
       /**
        */
       bool m_forwardRoute;
+
+      /**
+       *    The number of the alternative route, 0 for the best one.
+       */
+      uint16 m_alternative;
 }; // RMSubRoute
 
 
@@ -919,6 +937,18 @@ RMSubRoute::setForward( bool forward )
    m_forwardRoute = forward;
 }
 
+inline uint16
+RMSubRoute::getAlternative() const
+{
+   return m_alternative;
+}
+
+inline void
+RMSubRoute::setAlternative( uint16 alternative )
+{
+   m_alternative = alternative;
+}
+
 inline bool  
 RMSubRoute::isNodeOnLowLevel( uint32 index ) 
 {
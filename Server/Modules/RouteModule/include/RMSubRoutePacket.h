@@ -261,6 +261,12 @@ class RMSubRouteRequestPacket : public RequestPacket
        *   sent in the replypacket.
        */
       inline bool getDontSendSubRoutes() const;
+
+      /**
+       *   Returns the number of alternative routes to calculate
+       *   in addition to the best one.
+       */
+      inline uint32 getNbrAlternatives() const;
    
       /**
        * Tells if this is the first time a subrouteRequest
@@ -453,6 +459,17 @@ class RMSubRouteRequestPacket : public RequestPacket
           *   The bit-position of the DONT_SEND_SUBROUTES flag.
           */
          static const int DONT_SEND_SUBROUTES_BIT_POS = 2;
+
+         /**
+          *   The number of alternative routes wanted is stored in
+          *   bits 3-5 of the same byte as ROUTE_TO_ALL.
+          */
+         static const int NBR_ALTERNATIVES_POS = ROUTE_TO_ALL_POS;
+
+         /**
+          *   The lowest bit of the number of alternatives.
+          */
+         static const int NBR_ALTERNATIVES_BIT_POS = 3;
    
          /**
           * The position in the packet of listType.
@@ -601,6 +618,13 @@ RMSubRouteRequestPacket::getDontSendSubRoutes() const
                          DONT_SEND_SUBROUTES_BIT_POS) );
 }
 
+inline uint32
+RMSubRouteRequestPacket::getNbrAlternatives() const
+{
+   return ( readByte( NBR_ALTERNATIVES_POS ) >> NBR_ALTERNATIVES_BIT_POS ) &
+      0x7;
+}
+
 inline bool
 RMSubRouteRequestPacket::isOriginalRequest() const
 {
@@ -76,6 +76,16 @@ class SubRouteList : public VectorElement
        */
       virtual uint32 addSubRoute( RMSubRoute* subRoute );
 
+      /**
+       * Adds an alternative route. Unlike addSubRoute it is added even
+       * if there already is a cheaper route with the same externals.
+       * The subroute is owned by the list afterwards.
+       *
+       * @param  subRoute The alternative route.
+       * @return          The vector index of the added subroute.
+       */
+      uint32 addAlternativeSubRoute( RMSubRoute* subRoute );
+
       /**
        * Get the number of sub routes in this list.
        * 
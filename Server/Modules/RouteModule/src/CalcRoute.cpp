@@ -50,6 +50,8 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 
 #include <set>
 #include <sstream>
+#include <queue>
+#include <algorithm>
 
 // TODO: (When time permits or climate changes)
 // * Better division of maps. (Divide where there are few external conns)
@@ -3982,6 +3984,358 @@ CalcRoute::readResultFromDestination(SubRouteList* incoming,
    return subRoute;
 } // ReadResultFromDestination
 
+namespace {
+   /// Cost and node index, the elements of the heap in alternativeSearch.
+   typedef pair<uint32, uint32> altHeapElem_t;
+
+   /// Adds percent percent to cost, saturating below MAX_UINT32.
+   inline uint32 addPercent( uint32 cost, uint32 percent )
+   {
+      uint64 result = uint64( cost ) * ( 100 + percent ) / 100;
+      return uint32( MIN( result, uint64( MAX_UINT32 - 1 ) ) );
+   }
+
+   /// A route via one node, a candidate for an alternative route.
+   struct viaRoute_t {
+      /// The cost of the whole route.
+      uint32 cost;
+      /// The cost of the part that is shortest path in both searches.
+      uint32 plateau;
+      /// The node indices from the origin to the destination.
+      vector<uint32> nodes;
+      /// The cost of the connection from each node to the next.
+      vector<uint32> costs;
+   };
+}
+
+uint32
+CalcRoute::alternativeSearch( RoutingNode* start,
+                              RoutingNode* target,
+                              bool forward,
+                              const RMDriverPref* driverParam,
+                              uint32 stretch,
+                              AlternativeSearch& search )
+{
+   const bool usingCostC = driverParam->getCostC() != 0;
+   const uint32 restriction = driverParam->getVehicleRestriction();
+   const uint32 nbrNodes = m_map->getNbrNodes();
+   vector<uint32>& costs = search.costs;
+   vector<uint32>& parents = search.parents;
+   vector<uint32>& reached = search.reached;
+
+   if ( costs.size() != nbrNodes ) {
+      costs.assign( nbrNodes, MAX_UINT32 );
+      parents.assign( nbrNodes, MAX_UINT32 );
+   } else {
+      // Only the nodes reached by the previous search are set.
+      for ( uint32 i = 0; i < reached.size(); ++i ) {
+         costs[ reached[ i ] ] = MAX_UINT32;
+         parents[ reached[ i ] ] = MAX_UINT32;
+      }
+   }
+   reached.clear();
+
+   priority_queue<altHeapElem_t, vector<altHeapElem_t>,
+      greater<altHeapElem_t> > heap;
+   costs[ start->getIndex() ] = 0;
+   reached.push_back( start->getIndex() );
+   heap.push( altHeapElem_t( 0, start->getIndex() ) );
+
+   uint32 targetCost = MAX_UINT32;
+   uint32 maxCost = MAX_UINT32 - 1;
+   while ( ! heap.empty() ) {
+      const altHeapElem_t cur = heap.top();
+      heap.pop();
+      if ( cur.first != costs[ cur.second ] ) {
+         // Already dequeued with a lower cost.
+         continue;
+      }
+      if ( cur.first > maxCost ) {
+         break;
+      }
+      if ( cur.second == target->getIndex() ) {
+         targetCost = cur.first;
+         maxCost = addPercent( targetCost, stretch );
+      }
+      RoutingNode* curNode = m_map->getNode( cur.second );
+      for ( const RoutingConnection* conn =
+               curNode->getFirstConnection( forward );
+            conn != NULL;
+            conn = conn->getNext() ) {
+         const RoutingConnectionData* data = conn->getData();
+         if ( ! ( restriction & data->getVehicleRestriction( usingCostC ) ) ) {
+            continue;
+         }
+         RoutingNode* nextNode = conn->getNode();
+         const uint32 nextIndex = nextNode->getIndex();
+         if ( nextIndex >= nbrNodes ) {
+            continue;
+         }
+         // Same rule as calcCostDijkstra for the node driven into,
+         // except for the ends which the best route already uses.
+         const RoutingNode* enteredNode = forward ? nextNode : curNode;
+         if ( ! HAS_NO_RESTRICTIONS( enteredNode->getRestriction() ) &&
+              enteredNode != start && enteredNode != target ) {
+            continue;
+         }
+         const uint64 cost = uint64( cur.first ) +
+            calcConnectionCost( driverParam->getCostA(),
+                                driverParam->getCostB(),
+                                driverParam->getCostC(),
+                                0,
+                                restriction,
+                                data );
+         if ( cost <= maxCost && cost < costs[ nextIndex ] ) {
+            if ( costs[ nextIndex ] == MAX_UINT32 ) {
+               reached.push_back( nextIndex );
+            }
+            costs[ nextIndex ] = uint32( cost );
+            parents[ nextIndex ] = cur.second;
+            heap.push( altHeapElem_t( uint32( cost ), nextIndex ) );
+         }
+      }
+   }
+   return targetCost;
+}
+
+void
+CalcRoute::calcAlternatives( SubRouteList* resultList,
+                             const RMDriverPref* driverParam,
+                             uint32 nbrAlternatives )
+{
+   // The limits in percent of the cost of the best route.
+   const uint32 maxStretch = Properties::getUint32Property(
+      "ROUTE_ALTERNATIVE_MAX_STRETCH_PERCENT", 25 );
+   const uint32 maxSharing = Properties::getUint32Property(
+      "ROUTE_ALTERNATIVE_MAX_SHARING_PERCENT", 80 );
+   // In percent of the part of the alternative not shared.
+   const uint32 minPlateau = Properties::getUint32Property(
+      "ROUTE_ALTERNATIVE_MIN_PLATEAU_PERCENT", 25 );
+   // The number of via routes to build and compare.
+   const uint32 maxNbrCandidates = 64;
+
+   // The best route is the cheapest complete one.
+   CompleteRMSubRoute* best = NULL;
+   uint32 bestCost = MAX_UINT32;
+   uint32 bestEstCost = MAX_UINT32;
+   for ( uint32 i = 0; i < resultList->getNbrSubRoutes(); ++i ) {
+      CompleteRMSubRoute* subRoute =
+         static_cast<CompleteRMSubRoute*>( resultList->getSubRoute( i ) );
+      if ( ! subRoute->getRouteComplete() ||
+           subRoute->getNbrConnections() == 0 ) {
+         continue;
+      }
+      uint32 mapID, nodeID, cost, estCost;
+      subRoute->getExternal( 0, mapID, nodeID, cost, estCost );
+      if ( cost < bestCost ) {
+         best = subRoute;
+         bestCost = cost;
+         bestEstCost = estCost;
+      }
+   }
+   if ( best == NULL ) {
+      return;
+   }
+
+   // The first and last nodes of the best route, without the state
+   // elements around them.
+   const Vector& bestNodes = *best->getNodeIDs();
+   uint32 firstPos = 0;
+   while ( firstPos < bestNodes.getSize() &&
+           IS_STATE_ELEMENT( bestNodes[ firstPos ] ) ) {
+      ++firstPos;
+   }
+   uint32 endPos = bestNodes.getSize();
+   while ( endPos > firstPos && IS_STATE_ELEMENT( bestNodes[ endPos - 1 ] ) ) {
+      --endPos;
+   }
+   if ( endPos - firstPos < 2 ) {
+      return;
+   }
+   RoutingNode* origNode =
+      m_map->getNodeFromTrueNodeNumber( bestNodes[ firstPos ] );
+   RoutingNode* destNode =
+      m_map->getNodeFromTrueNodeNumber( bestNodes[ endPos - 1 ] );
+   if ( origNode == NULL || destNode == NULL || origNode == destNode ) {
+      return;
+   }
+
+   const uint32 optCost = alternativeSearch( origNode, destNode, true,
+                                             driverParam, maxStretch,
+                                             m_altForward );
+   if ( optCost == MAX_UINT32 || optCost == 0 ) {
+      return;
+   }
+   alternativeSearch( destNode, origNode, false, driverParam, maxStretch,
+                      m_altBackward );
+   const vector<uint32>& fwdCosts = m_altForward.costs;
+   const vector<uint32>& fwdParents = m_altForward.parents;
+   const vector<uint32>& fwdReached = m_altForward.reached;
+   const vector<uint32>& bwdCosts = m_altBackward.costs;
+   const vector<uint32>& bwdParents = m_altBackward.parents;
+   const uint32 maxCost = addPercent( optCost, maxStretch );
+
+   // Every node reached by both searches gives a route via it. All
+   // nodes on the same plateau give the same route, so only the first
+   // node of each plateau is kept, with the best possible objective,
+   // see below, and the plateau cost.
+   vector< pair<uint64, pair<uint32, uint32> > > plateaus;
+   set<uint32> plateauStarts;
+   for ( uint32 i = 0; i < fwdReached.size(); ++i ) {
+      const uint32 via = fwdReached[ i ];
+      if ( bwdCosts[ via ] == MAX_UINT32 ||
+           uint64( fwdCosts[ via ] ) + bwdCosts[ via ] > maxCost ) {
+         continue;
+      }
+      uint32 start = via;
+      while ( fwdParents[ start ] != MAX_UINT32 &&
+              bwdParents[ fwdParents[ start ] ] == start ) {
+         start = fwdParents[ start ];
+      }
+      if ( ! plateauStarts.insert( start ).second ) {
+         continue;
+      }
+      uint32 end = via;
+      while ( bwdParents[ end ] != MAX_UINT32 &&
+              fwdParents[ bwdParents[ end ] ] == end ) {
+         end = bwdParents[ end ];
+      }
+      const uint32 plateau = fwdCosts[ end ] - fwdCosts[ start ];
+      const uint64 cost = uint64( fwdCosts[ via ] ) + bwdCosts[ via ];
+      plateaus.push_back( make_pair( 2 * cost - plateau,
+                                     make_pair( via, plateau ) ) );
+   }
+   sort( plateaus.begin(), plateaus.end() );
+   if ( plateaus.size() > maxNbrCandidates ) {
+      plateaus.resize( maxNbrCandidates );
+   }
+
+   // Build the via routes. The ones with loops are skipped.
+   vector<viaRoute_t> candidates;
+   candidates.reserve( plateaus.size() );
+   for ( uint32 i = 0; i < plateaus.size(); ++i ) {
+      const uint32 via = plateaus[ i ].second.first;
+      viaRoute_t route;
+      route.cost = fwdCosts[ via ] + bwdCosts[ via ];
+      for ( uint32 cur = via; cur != MAX_UINT32; cur = fwdParents[ cur ] ) {
+         route.nodes.push_back( cur );
+      }
+      std::reverse( route.nodes.begin(), route.nodes.end() );
+      const uint32 viaPos = route.nodes.size() - 1;
+      for ( uint32 cur = bwdParents[ via ]; cur != MAX_UINT32;
+            cur = bwdParents[ cur ] ) {
+         route.nodes.push_back( cur );
+      }
+      set<uint32> uniqueNodes( route.nodes.begin(), route.nodes.end() );
+      if ( uniqueNodes.size() != route.nodes.size() ) {
+         continue;
+      }
+      for ( uint32 j = 0; j < viaPos; ++j ) {
+         route.costs.push_back( fwdCosts[ route.nodes[ j + 1 ] ] -
+                                fwdCosts[ route.nodes[ j ] ] );
+      }
+      for ( uint32 j = viaPos; j + 1 < route.nodes.size(); ++j ) {
+         route.costs.push_back( bwdCosts[ route.nodes[ j ] ] -
+                                bwdCosts[ route.nodes[ j + 1 ] ] );
+      }
+      route.plateau = plateaus[ i ].second.second;
+      candidates.push_back( route );
+   }
+
+   // The connections of the routes chosen so far.
+   set< pair<uint32, uint32> > usedConns;
+   uint32 prevIndex = MAX_UINT32;
+   for ( uint32 i = firstPos; i < endPos; ++i ) {
+      RoutingNode* node = m_map->getNodeFromTrueNodeNumber( bestNodes[ i ] );
+      if ( node == NULL ) {
+         continue;
+      }
+      if ( prevIndex != MAX_UINT32 && prevIndex != node->getIndex() ) {
+         usedConns.insert( make_pair( prevIndex, node->getIndex() ) );
+      }
+      prevIndex = node->getIndex();
+   }
+
+   // Choose the alternatives one at a time, since the sharing
+   // depends on the ones already chosen.
+   uint16 nbrFound = 0;
+   while ( nbrFound < nbrAlternatives && ! candidates.empty() ) {
+      uint32 bestIdx = MAX_UINT32;
+      uint64 bestObjective = 0;
+      for ( uint32 i = 0; i < candidates.size(); ++i ) {
+         const viaRoute_t& route = candidates[ i ];
+         uint32 shared = 0;
+         for ( uint32 j = 0; j < route.costs.size(); ++j ) {
+            if ( usedConns.count( make_pair( route.nodes[ j ],
+                                             route.nodes[ j + 1 ] ) ) ) {
+               shared += route.costs[ j ];
+            }
+         }
+         // Limited sharing and local optimality, approximated by the
+         // plateau covering enough of the part that is not shared.
+         if ( uint64( shared ) * 100 > uint64( optCost ) * maxSharing ||
+              uint64( route.plateau ) * 100 <
+              uint64( route.cost - shared ) * minPlateau ) {
+            continue;
+         }
+         const uint64 objective =
+            2 * uint64( route.cost ) + shared - route.plateau;
+         if ( bestIdx == MAX_UINT32 || objective < bestObjective ) {
+            bestIdx = i;
+            bestObjective = objective;
+         }
+      }
+      if ( bestIdx == MAX_UINT32 ) {
+         break;
+      }
+      const viaRoute_t& route = candidates[ bestIdx ];
+      ++nbrFound;
+
+      // Same externals, offsets and previous subroute as the best route.
+      CompleteRMSubRoute* subRoute = new CompleteRMSubRoute( best, true );
+      Vector* nodeIDs = subRoute->getNodeIDs();
+      nodeIDs->reset();
+      for ( uint32 i = 0; i < firstPos; ++i ) {
+         nodeIDs->addLast( bestNodes[ i ] );
+      }
+      // readResult may repeat the end nodes, do the same.
+      if ( bestNodes[ firstPos ] == bestNodes[ firstPos + 1 ] ) {
+         nodeIDs->addLast( bestNodes[ firstPos ] );
+      }
+      for ( uint32 i = 0; i < route.nodes.size(); ++i ) {
+         RoutingNode* node = m_map->getNode( route.nodes[ i ] );
+         if ( i > 0 ) {
+            RoutingNode* prevNode = m_map->getNode( route.nodes[ i - 1 ] );
+            uint32 extraCostSec = checkAdditionalCosts( prevNode, node );
+            if ( extraCostSec ) {
+               nodeIDs->addLast( ADD_COST_STATE_MASK | extraCostSec );
+            }
+            usedConns.insert( make_pair( route.nodes[ i - 1 ],
+                                         route.nodes[ i ] ) );
+         }
+         nodeIDs->addLast( node->getItemID() );
+      }
+      if ( bestNodes[ endPos - 1 ] == bestNodes[ endPos - 2 ] ) {
+         nodeIDs->addLast( bestNodes[ endPos - 1 ] );
+      }
+      for ( uint32 i = endPos; i < bestNodes.getSize(); ++i ) {
+         nodeIDs->addLast( bestNodes[ i ] );
+      }
+      const uint32 extraCost = route.cost - optCost;
+      subRoute->setCost( 0, bestCost + extraCost, bestEstCost + extraCost );
+      subRoute->setAlternative( nbrFound );
+      resultList->addAlternativeSubRoute( subRoute );
+
+      mc2dbg << "[CR]: Alternative " << nbrFound << " costs "
+             << route.cost << " where the best costs " << optCost
+             << ", plateau " << route.plateau << endl;
+      candidates.erase( candidates.begin() + bestIdx );
+   }
+   mc2dbg << "[CR]: Found " << nbrFound << " of " << nbrAlternatives
+          << " alternatives from " << plateaus.size() << " plateaus"
+          << endl;
+}
+
 ////////////////////////////////////////////////////////
 // Help methods for reading the result
 ////////////////////////////////////////////////////////
@@ -4706,7 +5060,8 @@ CalcRoute::realRoute(Head* origin,
                      bool originalRequest,
                      bool routeToAll,
                      bool calcCostSums,
-                     bool sendSubRoutes)
+                     bool sendSubRoutes,
+                     uint32 nbrAlternatives)
 {
    mc2dbg << "RouteToAll has value " << BP(routeToAll) << endl;
    mc2dbg << "SendSubRoutes has value " << BP(sendSubRoutes) << endl;
@@ -4845,6 +5200,15 @@ CalcRoute::realRoute(Head* origin,
                                    driverParam,
                                    forward,
                                    calcCostSums);
+               // Alternatives are only calculated when the whole
+               // route is on this map.
+               if ( status == StringTable::OK && nbrAlternatives > 0 &&
+                    originalRequest && forward &&
+                    ! MapBits::isOverviewMap( m_map->getMapID() ) &&
+                    IS_DRIVING( driverParam->getVehicleRestriction() ) ) {
+                  calcAlternatives( resultList, driverParam,
+                                    nbrAlternatives );
+               }
             } else {
                status = readResultToAll(origin,
                                         destination,
@@ -5075,7 +5439,8 @@ CalcRoute::route(Head* origin,
                  bool routeToAll,
                  const DisturbanceVector* disturbances,
                  bool calcCostSums,
-                 bool sendSubRoutes)
+                 bool sendSubRoutes,
+                 uint32 nbrAlternatives)
 {
    // Ugly. Set the default penalties for toll roads
    Connection::tollRoadTimeDefaultPenalty_s =
@@ -5141,7 +5506,7 @@ CalcRoute::route(Head* origin,
    uint32 result = realRoute(origin, destination, allDestinations,
                              incomingList, resultList, driverParam,
                              originalRequest, routeToAll, calcCostSums,
-                             sendSubRoutes);
+                             sendSubRoutes, nbrAlternatives);
 
    if ( disturbances != NULL ) {
       m_map->rollBack(true);
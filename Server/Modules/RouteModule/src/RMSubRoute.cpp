@@ -32,6 +32,7 @@ RMSubRoute::RMSubRoute() : m_extMapID( 1, 1 ),
    m_routeComplete = false;
    m_forwardRoute = true;
    m_nbrMapsVisited = 0;
+   m_alternative = 0;
 }
 
 RMSubRoute::RMSubRoute( RMSubRoute* subRoute, bool copyVisitedAndComplete )
@@ -50,6 +51,7 @@ RMSubRoute::RMSubRoute( RMSubRoute* subRoute, bool copyVisitedAndComplete )
    m_prevSubRouteID = subRoute->getPrevSubRouteID();
    m_sucSubRouteID = subRoute->getSucSubRouteID();
    m_forwardRoute = subRoute->isForward();
+   m_alternative = subRoute->getAlternative();
    
    for( uint32 i = 0; i < subRoute->getNbrConnections(); i++ ) {
       m_extMapID.addLast( subRoute->m_extMapID[i] );
@@ -58,11 +58,11 @@ RMSubRouteRequestPacket::RMSubRouteRequestPacket(uint32 leaderIP,
       mc2dbg << "RMSubRouteRequestPacket - buffer too small reallocing"
              << endl;
       
-      byte* temp = MAKE_UINT32_ALIGNED_BYTE_BUFFER( reqSize );
-      memcpy(temp, this->buffer, SUBROUTE_REQUEST_HEADER_SIZE);      
-      delete this->buffer;
-      this->buffer = temp;
-      this->bufSize = reqSize;
+      // Keep the whole header when growing the buffer
+      uint32 oldLength = getLength();
+      setLength( SUBROUTE_REQUEST_HEADER_SIZE );
+      resize( reqSize );
+      setLength( oldLength );
    }
    
    setOriginIP(leaderIP);
@@ -479,7 +479,7 @@ RMSubRouteReplyPacket::addSubRouteList(SubRouteList* subRouteList)
       incWriteLong(pos, subRoute->getPrevSubRouteID());
       incWriteByte(pos, uint8(subRoute->getRouteComplete()));
       incWriteByte(pos, uint8(subRoute->isForward()));
-      incWriteShort(pos , 0);
+      incWriteShort(pos, subRoute->getAlternative());
       incWriteLong(pos, subRoute->getMapID());
          
       const uint32 nbrConnections = subRoute->getNbrConnections();
@@ -567,7 +567,7 @@ void RMSubRouteReplyPacket::getSubRouteList( SubRouteList* subRouteList )
       subRoute->setPrevSubRouteID(incReadLong(pos));
       subRoute->setRouteComplete(bool(incReadByte(pos)));
       subRoute->setForward(bool(incReadByte(pos)));
-      incReadShort( pos );
+      subRoute->setAlternative( incReadShort( pos ) );
       subRoute->setMapID( incReadLong(pos) );
       
       uint32 nbrConnections = incReadLong(pos);
@@ -609,7 +609,8 @@ RouteProcessor::processSubRouteRequestPacket(const RMSubRouteRequestPacket*
                               subRouteRequestPacket->getRouteToAll(),
                               &disturbances,
                               subRouteRequestPacket->getCalcSums(),
-                              !subRouteRequestPacket->getDontSendSubRoutes());
+                              !subRouteRequestPacket->getDontSendSubRoutes(),
+                              subRouteRequestPacket->getNbrAlternatives());
          
       }
       else {
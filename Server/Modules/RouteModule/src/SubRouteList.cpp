@@ -125,6 +125,13 @@ SubRouteList::addSubRoute(RMSubRoute* subRoute)
           << endl;
 } // addSubRoute
 
+uint32
+SubRouteList::addAlternativeSubRoute( RMSubRoute* subRoute )
+{
+   m_subRouteVect.push_back( subRoute );
+   return m_subRouteVect.size() - 1;
+}
+
 bool
 SubRouteList::operator == (const VectorElement& elm) const
 {
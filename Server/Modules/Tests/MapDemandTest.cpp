@@ -0,0 +1,49 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "MC2UnitTestMain.h"
+
+#include "MapDemand.h"
+
+MC2_UNIT_TEST_FUNCTION( mapDemandRateTest ) {
+   MapDemand demand( 0, 60000 );
+   MC2_TEST_CHECK( demand.getRate( 1 ) == 0 );
+   MC2_TEST_CHECK( ! demand.isWarm() );
+
+   for ( int i = 0; i < 100; ++i ) {
+      demand.addRequest( 1 );
+   }
+   demand.addRequest( 2 );
+
+   // A full half life with 100 requests per minute gives half the rate.
+   demand.update( 60000 );
+   MC2_TEST_CHECK( fabs( demand.getRate( 1 ) - 50 ) < 0.01 );
+   MC2_TEST_CHECK( fabs( demand.getRate( 2 ) - 0.5 ) < 0.01 );
+   MC2_TEST_CHECK( demand.isWarm() );
+
+   vector< pair<float, uint32> > maps;
+   demand.getMapsByRate( maps );
+   MC2_TEST_REQUIRED( maps.size() == 2 );
+   MC2_TEST_CHECK( maps[ 0 ].second == 1 );
+   MC2_TEST_CHECK( maps[ 1 ].second == 2 );
+
+   // Without requests the rate halves every half life.
+   demand.update( 120000 );
+   MC2_TEST_CHECK( fabs( demand.getRate( 1 ) - 25 ) < 0.01 );
+
+   // Until it is forgotten.
+   demand.update( 1200000 );
+   MC2_TEST_CHECK( demand.getRate( 1 ) == 0 );
+   demand.getMapsByRate( maps );
+   MC2_TEST_CHECK( maps.empty() );
+}
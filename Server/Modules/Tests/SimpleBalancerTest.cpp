@@ -374,3 +374,185 @@ MC2_UNIT_TEST_FUNCTION( simpleBalancerDeleteOrder ) {
       clearPacketSendList( packetList );
    }
 }
+
+/**
+ * Tests that a map that gets many requests and queues up in the
+ * module that has it is replicated to an idle module and that the
+ * replica is dropped again when the requests stop.
+ */
+MC2_UNIT_TEST_FUNCTION( simpleBalancerReplicateHotMap ) {
+   SimpleBalancerTestFixture fix( true /* uses maps */ );
+   TimeUtility::startTestTime( 1 );
+
+   // the leader has map 1 and a long queue, host2 is idle
+   delete fix.thisModule;
+   fix.thisModule = new TestModule( host1, "1:10", 100, 200, 5000 );
+   fix.availables.push_back( new TestModule( host2, "2:10" ) );
+
+   PacketSendList packetList;
+   fix.balancer->updateStats( fix.thisModule->createStatisticsPacket(),
+                              packetList );
+   fix.balancer->updateStats( fix.availables[ 0 ]->createStatisticsPacket(),
+                              packetList );
+   MC2_TEST_CHECK( packetList.empty() );
+
+   // lots of requests for map 1
+   for ( int i = 0; i < 2000; ++i ) {
+      fix.useMap( Assert::MAPLOADEDORLOADING,
+                  1,
+                  host1, // origin of the request
+                  host1  // expected destination
+                  );
+   }
+
+   TimeUtility::testSleep( 10000 );
+   fix.balancer->updateStats( fix.availables[ 0 ]->createStatisticsPacket(),
+                              packetList );
+   fix.balancer->timeout( fix.thisModule->createStatisticsPacket(),
+                          packetList );
+
+   // map 1 should be loaded in host2 as well
+   MC2_TEST_REQUIRED( packetList.size() == 1 );
+   MC2_TEST_CHECK( packetList.front().first == host2 );
+   LoadMapRequestPacket* loadPacket =
+      dynamic_cast<LoadMapRequestPacket*>( packetList.front().second );
+   MC2_TEST_REQUIRED( loadPacket != NULL );
+   MC2_TEST_CHECK( loadPacket->getMapID() == 1 );
+   clearPacketSendList( packetList );
+
+   fix.availables[ 0 ]->loadMap( 1, 10 );
+   fix.balancer->updateStats( fix.availables[ 0 ]->createStatisticsPacket(),
+                              packetList );
+   MC2_TEST_CHECK( packetList.empty() );
+
+   // no more requests, the replica should be dropped when the map cools
+   DeleteMapRequestPacket* deletePacket = NULL;
+   for ( int i = 0; i < 100 && deletePacket == NULL; ++i ) {
+      TimeUtility::testSleep( 10000 );
+      fix.balancer->updateStats(
+         fix.availables[ 0 ]->createStatisticsPacket(), packetList );
+      fix.balancer->timeout( fix.thisModule->createStatisticsPacket(),
+                             packetList );
+      if ( ! packetList.empty() ) {
+         MC2_TEST_REQUIRED( packetList.size() == 1 );
+         deletePacket = dynamic_cast<DeleteMapRequestPacket*>(
+            packetList.front().second );
+         MC2_TEST_REQUIRED( deletePacket != NULL );
+         // host2 uses the most memory
+         MC2_TEST_CHECK( packetList.front().first == host2 );
+         MC2_TEST_CHECK( deletePacket->getMapID() == 1 );
+         clearPacketSendList( packetList );
+      }
+   }
+   MC2_TEST_CHECK( deletePacket != NULL );
+}
+
+/**
+ * Tests that preload requests from the servers are answered at once
+ * and loaded with low priority until the map is really needed.
+ */
+MC2_UNIT_TEST_FUNCTION( simpleBalancerPreloadMap ) {
+   SimpleBalancerTestFixture fix( true /* uses maps */ );
+
+   fix.availables.push_back( new TestModule( host2, "" ) );
+   PacketSendList packetList;
+   fix.balancer->updateStats( fix.availables[ 0 ]->createStatisticsPacket(),
+                              packetList );
+   MC2_TEST_CHECK( packetList.empty() );
+
+   // a server wants map 5 preloaded
+   LoadMapRequestPacket* preload = new LoadMapRequestPacket( 5 );
+   preload->setPreload( true );
+   preload->setOriginAddr( host3 );
+   MC2_TEST_CHECK( preload->getPriority() == PRELOAD_MAP_REQUEST_PRIO );
+   fix.balancer->getModulePackets( packetList, preload );
+
+   // one low priority load and an immediate reply to the server
+   MC2_TEST_REQUIRED( packetList.size() == 2 );
+   LoadMapRequestPacket* loadPacket =
+      dynamic_cast<LoadMapRequestPacket*>( packetList.front().second );
+   MC2_TEST_REQUIRED( loadPacket != NULL );
+   MC2_TEST_CHECK( loadPacket->getMapID() == 5 );
+   MC2_TEST_CHECK( loadPacket->isPreload() );
+   MC2_TEST_CHECK( loadPacket->getPriority() == PRELOAD_MAP_REQUEST_PRIO );
+   const IPnPort loader = packetList.front().first;
+   MC2_TEST_CHECK( packetList.back().first == host3 );
+   LoadMapReplyPacket* reply =
+      dynamic_cast<LoadMapReplyPacket*>( packetList.back().second );
+   MC2_TEST_REQUIRED( reply != NULL );
+   MC2_TEST_CHECK( reply->getStatus() == StringTable::OK );
+   clearPacketSendList( packetList );
+
+   // a real request for the map should bring the load forward
+   RequestPacket* request =
+      new ItemInfoRequestPacket( IDPair_t( 5, 0 ), NULL );
+   request->setOriginAddr( host3 );
+   fix.balancer->getModulePackets( packetList, request );
+   MC2_TEST_REQUIRED( packetList.size() == 2 );
+   MC2_TEST_CHECK( packetList.front().first == loader );
+   loadPacket =
+      dynamic_cast<LoadMapRequestPacket*>( packetList.front().second );
+   MC2_TEST_REQUIRED( loadPacket != NULL );
+   MC2_TEST_CHECK( ! loadPacket->isPreload() );
+   MC2_TEST_CHECK( loadPacket->getPriority() == LOAD_MAP_REQUEST_PRIO );
+   MC2_TEST_CHECK( packetList.back().first == loader );
+   MC2_TEST_CHECK( packetList.back().second == request );
+   clearPacketSendList( packetList );
+
+   // a preload of a map that is loading does nothing
+   preload = new LoadMapRequestPacket( 5 );
+   preload->setPreload( true );
+   preload->setOriginAddr( host3 );
+   fix.balancer->getModulePackets( packetList, preload );
+   MC2_TEST_REQUIRED( packetList.size() == 1 );
+   MC2_TEST_CHECK( packetList.front().first == host3 );
+   clearPacketSendList( packetList );
+}
+
+/**
+ * Tests that the nearest neighbour of a map loaded on demand
+ * is preloaded while a module is left free.
+ */
+MC2_UNIT_TEST_FUNCTION( simpleBalancerPreloadNeighbours ) {
+   SimpleBalancerTestFixture fix( true /* uses maps */ );
+
+   fix.availables.push_back( new TestModule( host2, "" ) );
+   fix.availables.push_back( new TestModule( host3, "" ) );
+   PacketSendList packetList;
+   for ( uint32 i = 0; i < fix.availables.size(); ++i ) {
+      fix.balancer->updateStats(
+         fix.availables[ i ]->createStatisticsPacket(), packetList );
+   }
+   MC2_TEST_CHECK( packetList.empty() );
+
+   // maps 1, 2 and 3 in a row, 2 overlaps 1 more than 3 does
+   map<MapID, MC2BoundingBox> mapBoxes;
+   mapBoxes[ 1 ] = MC2BoundingBox( 1000, 0, 0, 1000 );
+   mapBoxes[ 2 ] = MC2BoundingBox( 1000, 500, 0, 1500 );
+   mapBoxes[ 3 ] = MC2BoundingBox( 1000, 1000, 0, 2000 );
+   mapBoxes[ 4 ] = MC2BoundingBox( 1000, 5000, 0, 6000 );
+   fix.balancer->setMapBoundingBoxes( mapBoxes );
+   MC2_TEST_CHECK( fix.balancer->preloadsNeighbourMaps() );
+
+   RequestPacket* request =
+      new ItemInfoRequestPacket( IDPair_t( 1, 0 ), NULL );
+   request->setOriginAddr( host1 );
+   fix.balancer->getModulePackets( packetList, request );
+
+   // the load, the request and a preload of map 2
+   MC2_TEST_REQUIRED( packetList.size() == 3 );
+   PacketSendList::iterator it = packetList.begin();
+   LoadMapRequestPacket* loadPacket =
+      dynamic_cast<LoadMapRequestPacket*>( it->second );
+   MC2_TEST_REQUIRED( loadPacket != NULL );
+   MC2_TEST_CHECK( loadPacket->getMapID() == 1 );
+   MC2_TEST_CHECK( ! loadPacket->isPreload() );
+   ++it;
+   MC2_TEST_CHECK( it->second == request );
+   ++it;
+   loadPacket = dynamic_cast<LoadMapRequestPacket*>( it->second );
+   MC2_TEST_REQUIRED( loadPacket != NULL );
+   MC2_TEST_CHECK( loadPacket->getMapID() == 2 );
+   MC2_TEST_CHECK( loadPacket->isPreload() );
+   clearPacketSendList( packetList );
+}
@@ -108,10 +108,10 @@ private:
    /// Start logging, i.e set special prefix.
    void startLog( const Packet* packet, JobReply& reply );
 
-   /// Update processing time.
+   /// Update processing time and the trace context of the reply.
    void updateLogProcess();
 
-   /// End logging, i.e set default prefix.
+   /// End logging, i.e set default prefix, and add the latencies.
    void endLog();
 
    /// Set current log prefix from packet info.
@@ -125,6 +125,12 @@ private:
    clock_t m_startClock;
    /// Packet arrival time.
    int m_arrivalTime;
+   /// Subtype of the request.
+   uint16 m_subType;
+   /// True if the request wants the trace times in the reply.
+   bool m_traced;
+   /// The server send queue time of the request, returned in the reply.
+   uint32 m_traceSendQueueTime;
    /// JobCourier ID.
    uint32 m_id;
    /// Buffer for packet info during logging
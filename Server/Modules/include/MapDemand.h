@@ -0,0 +1,92 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef MAPDEMAND_H
+#define MAPDEMAND_H
+
+#include "config.h"
+
+#include <map>
+#include <vector>
+
+/**
+ *   Keeps track of how many requests the leader sends for each map.
+ *   The requests are counted as they are balanced and folded into an
+ *   exponentially decaying rate, in requests per minute, every time
+ *   update is called.
+ */
+class MapDemand {
+public:
+   /**
+    *   Creates a new MapDemand.
+    *   @param now          The current time in ms.
+    *   @param halfLifeMS   The time it takes for old requests to lose
+    *                       half of their weight.
+    */
+   MapDemand( uint32 now, uint32 halfLifeMS = 120000 );
+
+   /**
+    *   Counts one request for the map.
+    */
+   void addRequest( uint32 mapID );
+
+   /**
+    *   Folds the requests counted since the last update into the
+    *   rates. Maps whose rate has decayed to nothing are forgotten.
+    *   @param now The current time in ms.
+    */
+   void update( uint32 now );
+
+   /**
+    *   @return The request rate for the map in requests per minute.
+    */
+   float getRate( uint32 mapID ) const;
+
+   /**
+    *   Fills maps with the rate and id of all maps with demand,
+    *   the map with the highest rate first.
+    */
+   void getMapsByRate( vector< pair<float, uint32> >& maps ) const;
+
+   /**
+    *   @return True if requests have been counted for at least one
+    *           half life, i.e. the rates can be trusted.
+    */
+   bool isWarm() const;
+
+private:
+   /// The demand for one map.
+   struct Demand {
+      Demand() : count( 0 ), rate( 0 ) {}
+      /// Requests since the last update.
+      uint32 count;
+      /// Requests per minute.
+      float rate;
+   };
+
+   typedef map<uint32, Demand> demandMap_t;
+
+   /// The demand per map id.
+   demandMap_t m_demand;
+
+   /// The time of the first update.
+   uint32 m_startTime;
+
+   /// The time of the last update.
+   uint32 m_lastUpdate;
+
+   /// The half life of the rates.
+   uint32 m_halfLife;
+};
+
+#endif // MAPDEMAND_H
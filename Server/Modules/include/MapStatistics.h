@@ -276,6 +276,11 @@ public:
     */
    bool isMapLoaded(uint32 mapID) const;
 
+   /**
+    *    Returns the size of the map or 0 if the map is unknown.
+    */
+   uint32 getMapSize( uint32 mapID ) const;
+
    /**
     *  @param mapID The map id.
     *  @param size The size of the map that was loaded.
@@ -99,6 +99,13 @@ public:
          return m_recentNbrOfReq;
       }
 
+      /**
+       *    Returns the estimated time in ms that a new request would
+       *    wait in the module, i.e. the packets in the queue and the
+       *    ones sent since last statistics times the processing time.
+       */
+      uint32 getQueueTime() const;
+
       
       /**
        *    Marks the map as being deleted.
@@ -20,8 +20,11 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include "Balancer.h"
 #include "IPnPort.h"
 #include "MapBits.h"
+#include "MapDemand.h"
+#include "MC2BoundingBox.h"
 #include <memory>
 #include <set>
+#include <map>
 
 class ModuleNotice;
 class RequestPacket;
@@ -106,6 +109,19 @@ class SimpleBalancer : public Balancer {
     *  @param allMaps The maps.
     */
    void setAllMaps( const set<MapID>& allMaps );
+
+   /**
+    *  Lets the balancer know where the maps are, used to find
+    *  the neighbours of a map that should be preloaded.
+    *  @param mapBoxes The bounding boxes of the maps.
+    */
+   void setMapBoundingBoxes( const map<MapID, MC2BoundingBox>& mapBoxes );
+
+   /**
+    *  @return True if the neighbours of maps that are loaded
+    *          on demand should be preloaded.
+    */
+   bool preloadsNeighbourMaps() const;
    
 protected:
    
@@ -153,6 +169,58 @@ protected:
     *   time and starts deleting them.
     */
    int checkOldAge( PacketSendList& packetList );
+
+   /**
+    *   Adds a replica of the most requested map if the modules
+    *   that have it are queueing up and drops a replica of a map
+    *   that gets too few requests for the modules that have it.
+    *   At most one map is loaded and one deleted per call.
+    *   @return Number of load and delete packets added.
+    */
+   int checkMapDemand( PacketSendList& packetList );
+
+   /**
+    *   Returns the shortest queue time of the modules that have
+    *   the map loaded. Returns 0 if a module is still loading the
+    *   map, since that module will soon take some of the requests.
+    */
+   uint32 getMapQueueTime( uint32 mapID ) const;
+
+   /**
+    *   Returns the module best suited for an extra replica of
+    *   the map, i.e. the module with the shortest queue of the
+    *   ones that can load the map without exceeding optimal memory.
+    *   @return ModuleNotice or NULL.
+    */
+   ModuleNotice* getModuleForReplica( uint32 mapID ) const;
+
+   /**
+    *   Returns the module with the least memory of the ones that
+    *   are not loading or deleting, have a short queue and room
+    *   for a map of the given size.
+    *   @return ModuleNotice or NULL.
+    */
+   ModuleNotice* getLightlyLoadedModule( uint32 mapID,
+                                         uint32 mapSize ) const;
+
+   /**
+    *   Starts a low priority load of a map that will probably be
+    *   needed soon. Nothing is done if the map is already loaded
+    *   or loading or if no module has time and memory to spare.
+    *   @param request The request that causes the preload or NULL.
+    *   @return True if a load packet was added.
+    */
+   bool preloadMap( const RequestPacket* request,
+                    PacketSendList& packetList,
+                    uint32 mapID );
+
+   /**
+    *   Preloads the nearest maps overlapping the map, up to
+    *   the number of neighbours in the properties.
+    *   @return Number of load packets added.
+    */
+   int preloadNeighbourMaps( PacketSendList& packetList,
+                             uint32 mapID );
    
    /**
     *   Tell a module to delete a map.
@@ -170,11 +238,14 @@ protected:
     *   @param mapID   The ID of the map that should be loaded.
     *   @param mn      The notice for the module that should be told
     *                  to load the map.
+    *   @param preload True if the map is loaded in advance, the load
+    *                  is then done after the ordinary requests.
     *   
     */
    void moduleLoadMap( const RequestPacket* request,
                        PacketSendList& packetList,
-                       uint32 mapID, ModuleNotice* mn );
+                       uint32 mapID, ModuleNotice* mn,
+                       bool preload = false );
 
     /**
      *    Checks if the map id of the request packet exists in the
@@ -270,6 +341,36 @@ private:
    /// True if the (experimental) map balancing should be used
    bool m_useMapBalancing;
 
+   /// The request rates of the maps, only updated when leader.
+   MapDemand m_mapDemand;
+
+   /// True if replicas of hot maps should be added and removed.
+   bool m_replicateHotMaps;
+
+   /// A map with more requests per minute and replica than this is hot.
+   uint32 m_hotMapRequestsPerMinute;
+
+   /// Hot maps get another replica when the queue time exceeds this.
+   uint32 m_hotMapQueueTimeMS;
+
+   /// Replicas are dropped when the requests per minute are less than this.
+   uint32 m_coldMapRequestsPerMinute;
+
+   /// The maximum number of replicas of a map, 0 means no limit.
+   uint32 m_maxMapReplicas;
+
+   /// True if preload requests from the servers should be handled.
+   bool m_preloadMaps;
+
+   /// The number of neighbours to preload when a map is loaded on demand.
+   uint32 m_preloadNeighbourMaps;
+
+   /// The bounding boxes of the maps, empty if not known.
+   map<MapID, MC2BoundingBox> m_mapBoxes;
+
+   /// Maps with a low priority load that has not finished.
+   set<uint32> m_preloadingMaps;
+
    /// Used for logging
    MC2String m_moduleName;
 };
@@ -35,7 +35,6 @@ class RequestPacket;       // forward decl
 
 class AliveRequestPacket;  // forward decl
 class AliveReplyPacket;    // forward decl
-class AllMapReplyPacket;
 
 class ModulePushList;      // forward decl
 class PushService;
@@ -46,6 +45,7 @@ class JobTimeoutHandler;
 
 #include "PushService.h" // For PacketContainerList
 #include "ModuleTypes.h"
+#include "AllMapPacket.h" // For allmap_t
 #include "PointerFifoTemplate.h"
 
 /** 
@@ -187,9 +187,19 @@ protected:
    /**
     *    Requests allmappacket from the MapModule. Not to be used
     *    in the MapModule.
+    *    @param type The type of information wanted.
     *    @return NULL if failure.
     */
-   AllMapReplyPacket* requestAllMapPacket();
+   AllMapReplyPacket* requestAllMapPacket(
+      AllMapRequestPacket::allmap_t type = AllMapRequestPacket::ONLY_MAPID );
+
+   /**
+    *    Gives the bounding boxes of the maps to the balancer if
+    *    it preloads the neighbours of the maps. Failures are
+    *    only logged, the boxes are not needed to balance the load.
+    *    @param allMaps The maps to get the boxes for.
+    */
+   void initMapBoundingBoxes( const set<MapID>& allMaps );
    
    /**
     *    Processes an AliveRequestPacket and returns an AliveReplyPacket.
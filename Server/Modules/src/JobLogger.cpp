@@ -19,6 +19,7 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include "TimeUtility.h"
 #include "Packet.h"
 #include "MakeInfoString.h"
+#include "LatencyStatistics.h"
 
 JobLogger::JobLogger( uint32 id,
                       const PacketQueue& receiveQueue ):
@@ -26,6 +27,9 @@ JobLogger::JobLogger( uint32 id,
    m_startTimeMillis( 0 ),
    m_startClock( 0 ),
    m_arrivalTime( 0 ),
+   m_subType( 0 ),
+   m_traced( false ),
+   m_traceSendQueueTime( 0 ),
    m_id( id ),
    m_packetInfo( Processor::c_maxPackInfo ),
    m_logPrefix( 32 ),
@@ -49,7 +53,9 @@ void JobLogger::startLog( const Packet* packet,
 
    m_startClock = clock();
    m_arrivalTime = packet->getArrivalTime();
-
+   m_subType = packet->getSubType();
+   m_traced = packet->isTraced();
+   m_traceSendQueueTime = packet->getTraceSendQueueTime();
 }
 
 uint32 JobLogger::getProcessingTime() const {
@@ -69,6 +75,15 @@ void JobLogger::updateLogProcess() {
       m_reply->m_reply->setDebInfo( m_reply->m_processingTimeMillis );
       m_reply->m_reply->setCPUTime( static_cast< uint32 >
                                     ( m_reply->m_processorTimeMillis ) );
+      if ( m_traced ) {
+         // Send the server its own send queue time back together
+         // with our queue time, the processing time is the DebInfo.
+         m_reply->m_reply->setTraceFlags( Packet::TRACE_REQUESTED |
+                                          Packet::TRACE_MODULE_TIMES );
+         m_reply->m_reply->setTraceSendQueueTime( m_traceSendQueueTime );
+         m_reply->m_reply->
+            setTraceModuleQueueTime( m_startTimeMillis - m_arrivalTime );
+      }
    }
 
 }
@@ -77,6 +92,14 @@ void JobLogger::endLog() {
 
    m_reply->m_timeSinceArrival = TimeUtility::getCurrentTime() - m_arrivalTime;
 
+   LatencyStatistics& latency = LatencyStatistics::getInstance();
+   if ( m_arrivalTime != 0 ) {
+      latency.add( m_subType, LatencyStatistics::MODULE_QUEUE,
+                   m_startTimeMillis - m_arrivalTime );
+   }
+   latency.add( m_subType, LatencyStatistics::PROCESSING,
+                m_reply->m_processingTimeMillis );
+
    JobThreadString::addReceiveQueueInfo( *m_reply, m_receiveQueue );
    JobThreadString::makeInfoString( m_packetInfo, *m_reply );
 
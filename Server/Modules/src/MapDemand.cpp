@@ -0,0 +1,89 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "config.h"
+
+#include "MapDemand.h"
+
+#include <algorithm>
+#include <functional>
+#include <math.h>
+
+MapDemand::MapDemand( uint32 now, uint32 halfLifeMS )
+      : m_startTime( now ),
+        m_lastUpdate( now ),
+        m_halfLife( MAX( halfLifeMS, 1 ) )
+{
+}
+
+void
+MapDemand::addRequest( uint32 mapID )
+{
+   ++m_demand[ mapID ].count;
+}
+
+void
+MapDemand::update( uint32 now )
+{
+   uint32 elapsed = now - m_lastUpdate;
+   if ( elapsed == 0 ) {
+      return;
+   }
+   m_lastUpdate = now;
+
+   // The weight of the old rate.
+   const float oldWeight = pow( 0.5, double( elapsed ) / m_halfLife );
+   const float perMinute = 60000.0 / elapsed;
+
+   for ( demandMap_t::iterator it = m_demand.begin();
+         it != m_demand.end(); ) {
+      Demand& demand = it->second;
+      demand.rate = oldWeight * demand.rate +
+         ( 1 - oldWeight ) * demand.count * perMinute;
+      demand.count = 0;
+      if ( demand.rate < 0.01 ) {
+         m_demand.erase( it++ );
+      } else {
+         ++it;
+      }
+   }
+}
+
+float
+MapDemand::getRate( uint32 mapID ) const
+{
+   demandMap_t::const_iterator it = m_demand.find( mapID );
+   if ( it == m_demand.end() ) {
+      return 0;
+   }
+   return it->second.rate;
+}
+
+void
+MapDemand::getMapsByRate( vector< pair<float, uint32> >& maps ) const
+{
+   maps.clear();
+   maps.reserve( m_demand.size() );
+   for ( demandMap_t::const_iterator it = m_demand.begin();
+         it != m_demand.end(); ++it ) {
+      maps.push_back( make_pair( it->second.rate, it->first ) );
+   }
+   std::sort( maps.begin(), maps.end(),
+              std::greater< pair<float, uint32> >() );
+}
+
+bool
+MapDemand::isWarm() const
+{
+   return m_lastUpdate - m_startTime >= m_halfLife;
+}
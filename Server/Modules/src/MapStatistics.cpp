@@ -392,6 +392,16 @@ MapStatistics::isMapLoaded(uint32 mapID) const
    }
 }
 
+uint32
+MapStatistics::getMapSize( uint32 mapID ) const
+{
+   const_iterator it = find( mapID );
+   if ( it == end() ) {
+      return 0;
+   }
+   return it->second.getMapSize();
+}
+
 
 bool
 MapStatistics::removeMap(uint32 mapID)
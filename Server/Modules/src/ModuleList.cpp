@@ -168,6 +168,12 @@ ModuleNotice::getPacketsInQueue() const
    return m_moduleMapStats->getQueueLength();
 }
 
+uint32
+ModuleNotice::getQueueTime() const
+{
+   return ( getPacketsInQueue() + getRequests() ) * getProcessTime();
+}
+
 void
 ModuleNotice::markLoadingMap(uint32 mapID)
 {
@@ -25,6 +25,7 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include "DeleteHelpers.h"
 #include "StringUtility.h"
 #include "StringTable.h"
+#include "TimeUtility.h"
 
 #include <algorithm>
 #include <vector>
@@ -55,6 +56,7 @@ SimpleBalancer::SimpleBalancer(const IPnPort& ownAddr,
                                bool usesMaps,
                                bool multipleMaps)
       : m_ownAddr( ownAddr ),
+        m_mapDemand( TimeUtility::getCurrentTime() ),
         m_moduleName( moduleName )
 {
    m_moduleUsesMaps  = usesMaps;
@@ -70,6 +72,18 @@ SimpleBalancer::SimpleBalancer(const IPnPort& ownAddr,
 
    // Max age of a map
    m_maxMapAgeMinutes = MAX_UINT32;
+
+   // Replicate maps with more than 600 requests per minute and module
+   // if they wait for more than two seconds in the queues.
+   m_replicateHotMaps = true;
+   m_hotMapRequestsPerMinute = 600;
+   m_hotMapQueueTimeMS = 2000;
+   m_coldMapRequestsPerMinute = 60;
+   m_maxMapReplicas = 0;
+
+   // Preload the four nearest neighbours of maps loaded on demand.
+   m_preloadMaps = true;
+   m_preloadNeighbourMaps = 4;
    
 
    readPropValues();
@@ -119,6 +133,10 @@ SimpleBalancer::becomeAvailable()
    // remove all other modules from the list, but keep our own module notice
    m_moduleList->clear();
    m_moduleList->push_back( myNotice );
+
+   // Start over if we become leader again.
+   m_mapDemand = MapDemand( TimeUtility::getCurrentTime() );
+   m_preloadingMaps.clear();
 }
 
 void
@@ -247,6 +265,10 @@ SimpleBalancer::timeout( StatisticsPacket* ownStatistics,
    m_moduleList->checkTimeForStatistics();
 
    checkMemOverUse(packets);
+
+   if ( m_moduleUsesMaps && m_multipleMaps && m_replicateHotMaps ) {
+      checkMapDemand( packets );
+   }
    
    return 10000;
 }
@@ -336,7 +358,8 @@ SimpleBalancer::moduleDeleteMap( PacketSendList& packetList,
 void 
 SimpleBalancer::moduleLoadMap( const RequestPacket* request,
                                PacketSendList& packetList,
-                               uint32 mapID, ModuleNotice* mn )
+                               uint32 mapID, ModuleNotice* mn,
+                               bool preload )
 {
    if(!m_moduleUsesMaps) {
       mc2log << fatal << "[SimpleBalancer] " << getModuleName()
@@ -355,7 +378,8 @@ SimpleBalancer::moduleLoadMap( const RequestPacket* request,
    
    mc2dbg << "SimpleBalancer::moduleLoadMap(): module "
           << IPnPort(mn->getIP(), mn->getPort())
-          << " loading map " << prettyMapID( mapID )
+          << ( preload ? " preloading map " : " loading map " )
+          << prettyMapID( mapID )
           << endl;
    
    LoadMapRequestPacket* p
@@ -366,6 +390,10 @@ SimpleBalancer::moduleLoadMap( const RequestPacket* request,
                                  mn->getPort());
    p->setArrivalTime();
    p->copyRequestInfoFrom( request );
+   if ( preload ) {
+      p->setPreload( true );
+      m_preloadingMaps.insert( mapID );
+   }
    
    packetList.push_back( make_pair( IPnPort(mn->getIP(),
                                             mn->getPort()),
@@ -430,6 +458,254 @@ SimpleBalancer::checkMemOverUse(PacketSendList& packets)
    return nbrDeleted;
 }
 
+uint32
+SimpleBalancer::getMapQueueTime( uint32 mapID ) const
+{
+   uint32 queueTime = MAX_UINT32;
+   for ( ModuleList::const_iterator it = m_moduleList->begin();
+         it != m_moduleList->end();
+         ++it ) {
+      const ModuleNotice* mn = *it;
+      if ( mn->isMapLoading( mapID ) ) {
+         return 0;
+      }
+      if ( mn->isMapLoaded( mapID ) ) {
+         queueTime = MIN( queueTime, mn->getQueueTime() );
+      }
+   }
+   return queueTime;
+}
+
+ModuleNotice*
+SimpleBalancer::getModuleForReplica( uint32 mapID ) const
+{
+   // The size is only known by the modules that have loaded the map.
+   uint32 mapSize = 0;
+   for ( ModuleList::const_iterator it = m_moduleList->begin();
+         it != m_moduleList->end();
+         ++it ) {
+      mapSize = MAX( mapSize, (*it)->getStats().getMapSize( mapID ) );
+   }
+
+   ModuleNotice* best = NULL;
+   for ( ModuleList::const_iterator it = m_moduleList->begin();
+         it != m_moduleList->end();
+         ++it ) {
+      ModuleNotice* mn = *it;
+      if ( mn->isMapLoadedOrLoading( mapID ) ||
+           mn->isLoading() || mn->isDeleting() ) {
+         continue;
+      }
+      // Only lightly loaded modules with room for the map.
+      if ( mn->getQueueTime() >= m_hotMapQueueTimeMS ||
+           mn->getXSMem() + int64( mapSize ) > 0 ) {
+         continue;
+      }
+      if ( best == NULL ||
+           mn->getQueueTime() < best->getQueueTime() ||
+           ( mn->getQueueTime() == best->getQueueTime() &&
+             mn->getXSMem() < best->getXSMem() ) ) {
+         best = mn;
+      }
+   }
+   return best;
+}
+
+ModuleNotice*
+SimpleBalancer::getLightlyLoadedModule( uint32 mapID,
+                                        uint32 mapSize ) const
+{
+   ModuleNotice* best = NULL;
+   uint32 nbrNotLoading = 0;
+   for ( ModuleList::const_iterator it = m_moduleList->begin();
+         it != m_moduleList->end();
+         ++it ) {
+      ModuleNotice* mn = *it;
+      if ( mn->isLoading() ) {
+         continue;
+      }
+      ++nbrNotLoading;
+      if ( mn->isMapLoadedOrLoading( mapID ) || mn->isDeleting() ) {
+         continue;
+      }
+      if ( mn->getQueueTime() >= m_hotMapQueueTimeMS ||
+           mn->getXSMem() + int64( mapSize ) > 0 ) {
+         continue;
+      }
+      if ( best == NULL || mn->getXSMem() < best->getXSMem() ) {
+         best = mn;
+      }
+   }
+   // Requests are refused when all modules are loading, so always
+   // leave one module free for the maps that are really needed.
+   if ( nbrNotLoading < 2 ) {
+      return NULL;
+   }
+   return best;
+}
+
+bool
+SimpleBalancer::preloadMap( const RequestPacket* request,
+                            PacketSendList& packets,
+                            uint32 mapID )
+{
+   if ( m_allMaps.count( mapID ) == 0 ||
+        m_moduleList->countModulesWithMap( mapID ) > 0 ) {
+      return false;
+   }
+   // The size of a map that is not loaded is not known, guess that
+   // it is as large as the average map in the modules.
+   uint64 usedMem = 0;
+   uint32 nbrMaps = 0;
+   for ( ModuleList::const_iterator it = m_moduleList->begin();
+         it != m_moduleList->end();
+         ++it ) {
+      usedMem += (*it)->getUsedMem();
+      nbrMaps += (*it)->getNbrMaps();
+   }
+   uint32 mapSize = nbrMaps == 0 ? 0 : uint32( usedMem / nbrMaps );
+
+   ModuleNotice* mn = getLightlyLoadedModule( mapID, mapSize );
+   if ( mn == NULL ) {
+      mc2dbg2 << "[SimpleBalancer]: No module can preload map "
+              << prettyMapID( mapID ) << endl;
+      return false;
+   }
+   moduleLoadMap( request, packets, mapID, mn, true );
+   return true;
+}
+
+int
+SimpleBalancer::preloadNeighbourMaps( PacketSendList& packets,
+                                      uint32 mapID )
+{
+   map<MapID, MC2BoundingBox>::const_iterator found =
+      m_mapBoxes.find( mapID );
+   if ( m_preloadNeighbourMaps == 0 || found == m_mapBoxes.end() ) {
+      return 0;
+   }
+   const MC2BoundingBox& bbox = found->second;
+   MC2Coordinate center = bbox.getCenter();
+   const float64 cosLat = bbox.getCosLat();
+
+   // Sort the overlapping maps on the same level by the distance
+   // between the centers.
+   vector< pair<float64, uint32> > neighbours;
+   for ( map<MapID, MC2BoundingBox>::const_iterator it = m_mapBoxes.begin();
+         it != m_mapBoxes.end();
+         ++it ) {
+      if ( it->first == mapID ||
+           MapBits::isUnderviewMap( it->first ) !=
+           MapBits::isUnderviewMap( mapID ) ||
+           ! bbox.overlaps( it->second ) ) {
+         continue;
+      }
+      MC2Coordinate other = it->second.getCenter();
+      float64 dLat = float64( other.lat ) - center.lat;
+      float64 dLon = ( float64( other.lon ) - center.lon ) * cosLat;
+      neighbours.push_back( make_pair( dLat * dLat + dLon * dLon,
+                                       uint32( it->first ) ) );
+   }
+   std::sort( neighbours.begin(), neighbours.end() );
+
+   int nbrPreloaded = 0;
+   for ( uint32 i = 0;
+         i < neighbours.size() &&
+            uint32( nbrPreloaded ) < m_preloadNeighbourMaps;
+         ++i ) {
+      if ( preloadMap( NULL, packets, neighbours[ i ].second ) ) {
+         ++nbrPreloaded;
+      }
+   }
+   if ( nbrPreloaded > 0 ) {
+      mc2dbg << "[SimpleBalancer]: Preloading " << nbrPreloaded
+             << " neighbours of map " << prettyMapID( mapID ) << endl;
+   }
+   return nbrPreloaded;
+}
+
+int
+SimpleBalancer::checkMapDemand( PacketSendList& packets )
+{
+   m_mapDemand.update( TimeUtility::getCurrentTime() );
+   int nbrPackets = 0;
+
+   // Add a replica of the hottest map that is queueing up.
+   vector< pair<float, uint32> > maps;
+   m_mapDemand.getMapsByRate( maps );
+   for ( vector< pair<float, uint32> >::const_iterator it = maps.begin();
+         it != maps.end();
+         ++it ) {
+      const float rate = it->first;
+      const uint32 mapID = it->second;
+      if ( rate < m_hotMapRequestsPerMinute ) {
+         // The rest are colder.
+         break;
+      }
+      // Maps not loaded anywhere are loaded when requested.
+      const uint32 nbrReplicas = m_moduleList->countModulesWithMap( mapID );
+      if ( nbrReplicas == 0 ||
+           ( m_maxMapReplicas != 0 && nbrReplicas >= m_maxMapReplicas ) ) {
+         continue;
+      }
+      // Don't add a replica that would be dropped as cold right away.
+      if ( rate / nbrReplicas < m_hotMapRequestsPerMinute ||
+           rate / ( nbrReplicas + 1 ) < m_coldMapRequestsPerMinute ) {
+         continue;
+      }
+      if ( getMapQueueTime( mapID ) < m_hotMapQueueTimeMS ) {
+         continue;
+      }
+      ModuleNotice* mn = getModuleForReplica( mapID );
+      if ( mn == NULL ) {
+         continue;
+      }
+      mc2dbg << "[SimpleBalancer]: Map " << prettyMapID( mapID )
+             << " is hot, " << rate << " req/min in " << nbrReplicas
+             << " modules. Adding replica in " << mn->getAddr() << endl;
+      moduleLoadMap( NULL, packets, mapID, mn );
+      ++nbrPackets;
+      break;
+   }
+
+   if ( ! m_mapDemand.isWarm() ) {
+      // Too early to tell which maps are cold.
+      return nbrPackets;
+   }
+
+   // Drop a replica of a map that has cooled down.
+   for ( set<MapID>::const_iterator it = m_allMaps.begin();
+         it != m_allMaps.end();
+         ++it ) {
+      const uint32 mapID = *it;
+      const int nbrReplicas = m_moduleList->countModulesWithMap( mapID );
+      if ( nbrReplicas <= 1 ||
+           m_mapDemand.getRate( mapID ) / ( nbrReplicas - 1 ) >=
+           m_coldMapRequestsPerMinute ) {
+         continue;
+      }
+      // Delete it in the module using most memory.
+      vector<ModuleNotice*> mods;
+      m_moduleList->getModulesMostMemFirst( mods );
+      for ( vector<ModuleNotice*>::iterator mt = mods.begin();
+            mt != mods.end();
+            ++mt ) {
+         ModuleNotice* mn = *mt;
+         if ( mn->isMapLoaded( mapID ) && ! mn->isDeleting() ) {
+            mc2dbg << "[SimpleBalancer]: Map " << prettyMapID( mapID )
+                   << " is cold, " << m_mapDemand.getRate( mapID )
+                   << " req/min in " << nbrReplicas
+                   << " modules. Dropping replica in " << mn->getAddr()
+                   << endl;
+            moduleDeleteMap( packets, mapID, mn );
+            return nbrPackets + 1;
+         }
+      }
+   }
+
+   return nbrPackets;
+}
+
 /**
  *   Compare the amount of memory used by modules.
  */
@@ -610,7 +886,34 @@ SimpleBalancer::getModulePackets(PacketSendList& packets,
       request = NULL;
       return true;
    }
-   
+
+   const bool realRequest =
+      request->getSubType() != Packet::PACKETTYPE_LOADMAPREQUEST &&
+      request->getSubType() != Packet::PACKETTYPE_DELETEMAPREQUEST &&
+      request->getSubType() != Packet::PACKETTYPE_ACKNOWLEDGE;
+   if ( realRequest ) {
+      m_mapDemand.addRequest( mapID );
+   }
+
+   // A server wants a map that it will probably need soon. The server
+   // does not wait for the map, so answer at once and load the map
+   // only if there is time and memory to spare.
+   if ( request->getSubType() == Packet::PACKETTYPE_LOADMAPREQUEST &&
+        static_cast<LoadMapRequestPacket*>( request )->isPreload() ) {
+      if ( m_preloadMaps && m_multipleMaps ) {
+         preloadMap( request, packets, mapID );
+      }
+      if ( request->getOriginIP() != 0 ) {
+         packets.push_back(
+            make_pair( request->getOriginAddr(),
+                       new LoadMapReplyPacket(
+                          *static_cast<LoadMapRequestPacket*>( request ),
+                          StringTable::OK, 0 ) ) );
+      }
+      delete request;
+      return true;
+   }
+
    bool mapHasBeenLoaded = false;
    // 2. Check if there is a module with the map loaded.
    //    Return the best module with the mapID   
@@ -618,6 +921,20 @@ SimpleBalancer::getModulePackets(PacketSendList& packets,
    if ( mn == NULL ) {
       // Check if a module is loading the map.
       mn = m_moduleList->getBestModuleLoadingMap(mapID);
+      if ( mn != NULL && realRequest &&
+           m_preloadingMaps.erase( mapID ) > 0 ) {
+         // The map is needed now, load it before the request instead
+         // of after the other requests in the module.
+         LoadMapRequestPacket* p =
+            new LoadMapRequestPacket( mapID,
+                                      m_ownAddr.getIP(),
+                                      m_ownAddr.getPort(),
+                                      mn->getIP(),
+                                      mn->getPort() );
+         p->setArrivalTime();
+         p->copyRequestInfoFrom( request );
+         packets.push_back( make_pair( mn->getAddr(), p ) );
+      }
       if ( mn == NULL ) {
          // No-one has loaded the map - tell someone to do it.
          // We will still keep the behaviour that we refuse requests
@@ -686,6 +1003,11 @@ SimpleBalancer::getModulePackets(PacketSendList& packets,
    //           used since all maps will probably have different sizes).
    if ( mapHasBeenLoaded ) {
       checkMemOverUse(packets);
+      // Neighbouring maps are often needed next, e.g. by routes
+      // and searches crossing the map borders.
+      if ( realRequest && m_preloadMaps && m_multipleMaps ) {
+         preloadNeighbourMaps( packets, mapID );
+      }
    }
    
    return true;
@@ -695,6 +1017,7 @@ void
 SimpleBalancer::reactToMapLoaded(PacketSendList& packetList,
                                  LoadMapReplyPacket* replyPacket)
 {
+   m_preloadingMaps.erase( replyPacket->getMapID() );
    // I would like to avoid the "All modules are loading"
    mc2dbg << "[SimpleBalancer]: React to map loaded" << endl;
    // SearchModule never returns OK...
@@ -841,6 +1164,37 @@ SimpleBalancer::readPropValues(const MC2String& prefix,
                                                       "MODULE_USE_MAPBALANCING"
                                                       + suffix,
                                                       m_useMapBalancing );
+
+   m_replicateHotMaps =
+      Properties::getUint32Property( prefix +
+                                     "MODULE_REPLICATE_HOT_MAPS" + suffix,
+                                     m_replicateHotMaps );
+   m_hotMapRequestsPerMinute =
+      Properties::getUint32Property( prefix +
+                                     "MODULE_HOT_MAP_REQUESTS_PER_MINUTE" +
+                                     suffix,
+                                     m_hotMapRequestsPerMinute );
+   m_hotMapQueueTimeMS =
+      Properties::getUint32Property( prefix +
+                                     "MODULE_HOT_MAP_QUEUE_TIME_MS" + suffix,
+                                     m_hotMapQueueTimeMS );
+   m_coldMapRequestsPerMinute =
+      Properties::getUint32Property( prefix +
+                                     "MODULE_COLD_MAP_REQUESTS_PER_MINUTE" +
+                                     suffix,
+                                     m_coldMapRequestsPerMinute );
+   m_maxMapReplicas =
+      Properties::getUint32Property( prefix +
+                                     "MODULE_MAX_MAP_REPLICAS" + suffix,
+                                     m_maxMapReplicas );
+   m_preloadMaps =
+      Properties::getUint32Property( prefix +
+                                     "MODULE_PRELOAD_MAPS" + suffix,
+                                     m_preloadMaps );
+   m_preloadNeighbourMaps =
+      Properties::getUint32Property( prefix +
+                                     "MODULE_PRELOAD_NEIGHBOUR_MAPS" + suffix,
+                                     m_preloadNeighbourMaps );
    
 
    // This is a bit ugly. Use the default list etc.
@@ -890,6 +1244,16 @@ void SimpleBalancer::setAllMaps( const set<MapID>& allMaps ) {
    m_allMaps = allMaps;
 }
 
+void SimpleBalancer::setMapBoundingBoxes(
+   const map<MapID, MC2BoundingBox>& mapBoxes ) {
+   m_mapBoxes = mapBoxes;
+}
+
+bool SimpleBalancer::preloadsNeighbourMaps() const {
+   return m_moduleUsesMaps && m_multipleMaps &&
+      m_preloadMaps && m_preloadNeighbourMaps > 0;
+}
+
 InfoModuleSimpleBalancer::InfoModuleSimpleBalancer( 
    const IPnPort& ownAddr,
    const MC2String& moduleName,
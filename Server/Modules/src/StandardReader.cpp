@@ -1054,7 +1054,7 @@ void StandardReader::becomeAvailable()
 }
 
 AllMapReplyPacket*
-StandardReader::requestAllMapPacket()
+StandardReader::requestAllMapPacket( AllMapRequestPacket::allmap_t type )
 {
    DatagramSender udpSender;
    DatagramReceiver udpReceiver( MultiCastProperties::changeMapSetPort( 8000 ), 
@@ -1063,7 +1063,8 @@ StandardReader::requestAllMapPacket()
    auto_ptr<AllMapReplyPacket> reply( new AllMapReplyPacket() );
 
    AllMapRequestPacket req( NetUtility::getLocalIP(),
-                            udpReceiver.getPort() );
+                            udpReceiver.getPort(),
+                            type );
    uint32 mapip = MultiCastProperties::getNumericIP( MODULE_TYPE_MAP,
                                                      true );
    uint16 mapport = MultiCastProperties::getPort( MODULE_TYPE_MAP, true );
@@ -1147,6 +1148,36 @@ void StandardReader::initLeader(set<MapID>& allMaps)
          allMaps.insert( mapID );
       }
    }
+
+   initMapBoundingBoxes( allMaps );
+}
+
+void
+StandardReader::initMapBoundingBoxes( const set<MapID>& allMaps )
+{
+   SimpleBalancer* simpleBalancer = dynamic_cast<SimpleBalancer*>(m_balancer);
+   if ( simpleBalancer == NULL || ! simpleBalancer->preloadsNeighbourMaps() ) {
+      return;
+   }
+
+   auto_ptr<AllMapReplyPacket> reply(
+      requestAllMapPacket( AllMapRequestPacket::BOUNDINGBOX ) );
+   if ( reply.get() == NULL ||
+        reply->getType() != AllMapRequestPacket::BOUNDINGBOX ) {
+      mc2log << warn << "[StandardReader]: Could not get the bounding "
+             << "boxes of the maps, no neighbours will be preloaded" << endl;
+      return;
+   }
+
+   map<MapID, MC2BoundingBox> mapBoxes;
+   uint32 nbrMaps = reply->getNbrMaps();
+   for ( uint32 i = 0; i < nbrMaps; ++i ) {
+      uint32 mapID = reply->getMapID( i );
+      if ( allMaps.count( mapID ) != 0 ) {
+         reply->setMC2BoundingBox( i, &mapBoxes[ mapID ] );
+      }
+   }
+   simpleBalancer->setMapBoundingBoxes( mapBoxes );
 }
 
 void StandardReader::replyToHeartBeat()
@@ -37,6 +37,7 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include "RouteRequestParams.h"
 #include "UnexpandedRoute.h"
 #include "SubRouteVector.h"
+#include "ServerSubRouteVector.h"
 #include "BitUtility.h"
 #include "TimeUtility.h"
 #include "NavRequestData.h"
@@ -48,6 +49,7 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 
 #include "HttpInterfaceRequest.h"
 #include "IP.h"
+#include "Properties.h"
 
 #include <set>
 
@@ -486,6 +488,16 @@ NavRouteHandler::handleRoute( NavRequestData& rd ) {
          return ok;
       }
 
+      // When off track only the way back to the old route is needed.
+      // Only a route calculated by this server is used, fetching it
+      // would delay the reroute more than it saves.
+      ServerSubRouteVector* oldRoute = NULL;
+      if ( reason == 2/*off_track*/ && oldRouteID.isValid() &&
+           Properties::getUint32Property( "INCREMENTAL_REROUTE", 1 ) ) {
+         oldRoute = m_thread->getRoutedRoute( oldRouteID );
+         rr->setRerouteBase( oldRoute );
+      }
+
       m_thread->sendRequest( rr );
 
       // While RouteRequest is processing do the checkService
@@ -572,6 +584,7 @@ NavRouteHandler::handleRoute( NavRequestData& rd ) {
 
       // Wait for the RouteRequest to finish
       m_thread->waitForRequest( rr->getID() );
+      delete oldRoute;
 
       if ( rr->getStatus() == StringTable::OK && ok ) {
 
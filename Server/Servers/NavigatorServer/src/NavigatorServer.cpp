@@ -18,6 +18,7 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include "SSLSocket.h"
 #include "HttpInterfaceRequest.h"
 #include "ngpmaker.h"
+#include "NavPacket.h"
 #include "PropertyHelper.h"
 #include "XMLInit.h"
 #include "PTServer.h"
@@ -267,6 +268,13 @@ try {
       Properties::insertProperty( "WF_CATEGORIES_DIR", CL_categories );
    }
 
+   if ( ! NavPacket::setCompressionLevels( 
+           Properties::getProperty( "NAV_GZIP_LEVELS", "" ) ) ) {
+      mc2log << error << "Bad NAV_GZIP_LEVELS "
+             << Properties::getProperty( "NAV_GZIP_LEVELS", "" ) << endl;
+      exit( 1 );
+   }
+
    if ( CL_periodicTrafficUpdateInterval == MAX_UINT32 ) {
       CL_periodicTrafficUpdateInterval = 
          Properties::getUint32Property("NAV_PERIODIC_TRAFFIC_UPDATE_INTERVAL");
@@ -0,0 +1,104 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "MC2UnitTestMain.h"
+
+#include "RouteAlternatives.h"
+#include "ServerSubRouteVector.h"
+#include "SubRoute.h"
+#include "OrigDestInfo.h"
+#include "DriverPref.h"
+
+namespace {
+
+/// Creates a SubRoute from orig to dest with the cost to dest.
+SubRoute* createSubRoute( const DriverPref& pref, uint32 prevSubRouteID,
+                          uint32 origMapID, uint32 origNodeID,
+                          uint32 destMapID, uint32 destNodeID,
+                          uint32 cost, uint16 alternative = 0 ) {
+   OrigDestInfo orig( &pref, origMapID, origNodeID, MAX_INT32, MAX_INT32,
+                      0.0 );
+   OrigDestInfo dest( &pref, destMapID, destNodeID, MAX_INT32, MAX_INT32,
+                      0.0 );
+   dest.setCost( cost );
+   SubRoute* subRoute = new SubRoute( orig, dest );
+   subRoute->setPrevSubRouteID( prevSubRouteID );
+   subRoute->setAlternative( alternative );
+   subRoute->addNodeID( origNodeID );
+   return subRoute;
+}
+
+/**
+ * The origin at node 10 on map 1 and a SubRoute from it to node 20 on
+ * map 2.
+ */
+void addOrigin( ServerSubRouteVector& finished, const DriverPref& pref ) {
+   finished.insertSubRoute( createSubRoute( pref, MAX_UINT32,
+                                            MAX_UINT32, 1, 1, 10, 0 ) );
+   finished.insertSubRoute( createSubRoute( pref, 0, 1, 10, 2, 20, 50 ) );
+}
+
+}
+
+MC2_UNIT_TEST_FUNCTION( routeAlternativesAppendTest ) {
+   DriverPref pref;
+   ServerSubRouteVector finished( 1 );
+   addOrigin( finished, pref );
+   RouteAlternatives alternatives;
+
+   // The best route to node 40 on map 1.
+   finished.insertSubRoute( createSubRoute( pref, 0, 1, 10, 1, 40, 100 ),
+                            true );
+   alternatives.insert( finished,
+                        createSubRoute( pref, 0, 1, 10, 1, 40, 120, 1 ) );
+   alternatives.insert( finished,
+                        createSubRoute( pref, 0, 1, 10, 1, 40, 150, 2 ) );
+   // Found on map 2, which the best route does not pass.
+   alternatives.insert( finished,
+                        createSubRoute( pref, 1, 2, 20, 1, 40, 130, 1 ) );
+   MC2_TEST_CHECK( alternatives.size() == 3 );
+   // The alternatives are not destinations.
+   MC2_TEST_CHECK( finished.getDestIndexArray()[ 0 ] == 2 );
+
+   ServerSubRouteVectorVector routes;
+   routes.push_back( finished.getResultVector( 0 ) );
+   MC2_TEST_CHECK( alternatives.appendTo( finished, routes ) == 2 );
+   MC2_TEST_REQUIRED( routes.size() == 3 );
+
+   MC2_TEST_CHECK( routes[ 0 ]->back()->getAlternative() == 0 );
+   MC2_TEST_CHECK( routes[ 0 ]->back()->getCost() == 100 );
+   MC2_TEST_CHECK( routes[ 1 ]->getSize() == 1 );
+   MC2_TEST_CHECK( routes[ 1 ]->back()->getAlternative() == 1 );
+   MC2_TEST_CHECK( routes[ 1 ]->back()->getCost() == 120 );
+   MC2_TEST_CHECK( routes[ 2 ]->getSize() == 1 );
+   MC2_TEST_CHECK( routes[ 2 ]->back()->getAlternative() == 2 );
+   MC2_TEST_CHECK( routes[ 2 ]->back()->getCost() == 150 );
+}
+
+MC2_UNIT_TEST_FUNCTION( routeAlternativesNoBestRouteTest ) {
+   DriverPref pref;
+   ServerSubRouteVector finished( 1 );
+   addOrigin( finished, pref );
+   RouteAlternatives alternatives;
+   alternatives.insert( finished,
+                        createSubRoute( pref, 0, 1, 10, 1, 40, 120, 1 ) );
+
+   // No routes to append to.
+   ServerSubRouteVectorVector routes;
+   MC2_TEST_CHECK( alternatives.appendTo( finished, routes ) == 0 );
+
+   // The destination was never reached.
+   routes.push_back( new ServerSubRouteVector );
+   MC2_TEST_CHECK( alternatives.appendTo( finished, routes ) == 0 );
+   MC2_TEST_CHECK( routes.size() == 1 );
+}
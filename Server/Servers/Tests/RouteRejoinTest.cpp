@@ -0,0 +1,152 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "MC2UnitTestMain.h"
+
+#include "RouteRejoin.h"
+#include "ServerSubRouteVector.h"
+#include "SubRoute.h"
+#include "OrigDestInfo.h"
+#include "DriverPref.h"
+
+#include <memory>
+
+namespace {
+
+/// Adds a SubRoute from orig to dest with the cost to dest.
+void addSubRoute( ServerSubRouteVector& route, const DriverPref& pref,
+                  uint32 origMapID, uint32 origNodeID,
+                  uint32 destMapID, uint32 destNodeID,
+                  uint32 cost ) {
+   OrigDestInfo orig( &pref, origMapID, origNodeID, MAX_INT32, MAX_INT32,
+                      0.0 );
+   OrigDestInfo dest( &pref, destMapID, destNodeID,
+                      destNodeID * 100, destNodeID * 200, 0.0 );
+   dest.setCost( cost );
+   SubRoute* subRoute = new SubRoute( orig, dest );
+   subRoute->addNodeID( origNodeID );
+   route.insertSubRoute( subRoute );
+}
+
+/**
+ * The old route goes through map 1, 2, 1 and ends at node 40 on map 3.
+ */
+ServerSubRouteVector* createOldRoute( const DriverPref& pref ) {
+   ServerSubRouteVector* route = new ServerSubRouteVector;
+   addSubRoute( *route, pref, 1, 1, 2, 10, 100 );
+   addSubRoute( *route, pref, 2, 10, 1, 20, 200 );
+   addSubRoute( *route, pref, 1, 20, 3, 30, 300 );
+   addSubRoute( *route, pref, 3, 30, 3, 40, 400 );
+   route->back()->setDestOffset( 0.5 );
+   return route;
+}
+
+OrigDestInfoList createList( const DriverPref& pref,
+                             uint32 mapID, uint32 nodeID, float offset ) {
+   OrigDestInfoList list;
+   list.addOrigDestInfo( OrigDestInfo( &pref, mapID, nodeID, 1, 2,
+                                       offset ) );
+   return list;
+}
+
+}
+
+MC2_UNIT_TEST_FUNCTION( routeRejoinChoiceTest ) {
+   DriverPref pref;
+   std::auto_ptr<ServerSubRouteVector> oldRoute( createOldRoute( pref ) );
+   OrigDestInfoList dests = createList( pref, 3, 40, 0.5 );
+
+   // Rejoin where the route leaves the map of the origin the last time.
+   RouteRejoin fromMap1( *oldRoute, pref, createList( pref, 1, 5, 0.0 ),
+                         dests );
+   MC2_TEST_REQUIRED( fromMap1.isValid() );
+   MC2_TEST_CHECK( fromMap1.getRejoinIndex() == 2 );
+   OrigDestInfo point = fromMap1.getRejoinPoint( &pref );
+   MC2_TEST_CHECK( point.getMapID() == 3 );
+   MC2_TEST_CHECK( point.getNodeID() == 30 );
+   // The coordinate of the rejoin node, not of the origin.
+   MC2_TEST_CHECK( point.getLat() == 3000 );
+   MC2_TEST_CHECK( point.getLon() == 6000 );
+
+   RouteRejoin fromMap2( *oldRoute, pref, createList( pref, 2, 5, 0.0 ),
+                         dests );
+   MC2_TEST_CHECK( fromMap2.getRejoinIndex() == 1 );
+
+   // Not on the old route.
+   RouteRejoin fromMap4( *oldRoute, pref, createList( pref, 4, 5, 0.0 ),
+                         dests );
+   MC2_TEST_CHECK( ! fromMap4.isValid() );
+
+   // Already on the map of the destination.
+   RouteRejoin fromMap3( *oldRoute, pref, createList( pref, 3, 5, 0.0 ),
+                         dests );
+   MC2_TEST_CHECK( ! fromMap3.isValid() );
+
+   // Another destination.
+   RouteRejoin otherDest( *oldRoute, pref, createList( pref, 1, 5, 0.0 ),
+                          createList( pref, 3, 40, 0.9 ) );
+   MC2_TEST_CHECK( ! otherDest.isValid() );
+}
+
+MC2_UNIT_TEST_FUNCTION( routeRejoinTailCostTest ) {
+   DriverPref pref;
+   std::auto_ptr<ServerSubRouteVector> oldRoute( createOldRoute( pref ) );
+   RouteRejoin rejoin( *oldRoute, pref, createList( pref, 2, 5, 0.0 ),
+                       createList( pref, 3, 40, 0.5 ) );
+   MC2_TEST_REQUIRED( rejoin.isValid() );
+
+   // The route back to node 20 on map 1, ending with the SubRoute on
+   // map 1 from the rejoin node to itself.
+   ServerSubRouteVector route;
+   addSubRoute( route, pref, 2, 5, 1, 20, 50 );
+   addSubRoute( route, pref, 1, 20, 1, 20, 50 );
+
+   std::auto_ptr<ServerSubRouteVector> joined( rejoin.join( route ) );
+   MC2_TEST_REQUIRED( joined->getSize() == 3 );
+   MC2_TEST_CHECK( joined->getSubRouteAt( 0 )->getCost() == 50 );
+   // The remaining cost of the old route is added to the rejoin cost.
+   MC2_TEST_CHECK( joined->getSubRouteAt( 1 )->getThisMapID() == 1 );
+   MC2_TEST_CHECK( joined->getSubRouteAt( 1 )->getOrigNodeID() == 20 );
+   MC2_TEST_CHECK( joined->getSubRouteAt( 1 )->getCost() == 150 );
+   MC2_TEST_CHECK( joined->getSubRouteAt( 2 )->getDestNodeID() == 40 );
+   MC2_TEST_CHECK( joined->getSubRouteAt( 2 )->getCost() == 250 );
+   MC2_TEST_CHECK( joined->getSubRouteAt( 2 )->getPrevSubRouteID() ==
+                   joined->getSubRouteAt( 1 )->getSubRouteID() );
+}
+
+MC2_UNIT_TEST_FUNCTION( routeRejoinNode1DestTest ) {
+   DriverPref pref;
+   std::auto_ptr<ServerSubRouteVector> route( createOldRoute( pref ) );
+   route->back()->setDestOffset( 0.75 );
+
+   // The route ends at node 0, 0.75 from it.
+   MC2_TEST_CHECK( RouteRejoin::endsAt(
+                      *route, createList( pref, 3, 40, 0.75 ) ) );
+   // Node 1 of the same item, 0.25 from node 1.
+   MC2_TEST_CHECK( RouteRejoin::endsAt(
+                      *route, createList( pref, 3, 0x80000028, 0.25 ) ) );
+   MC2_TEST_CHECK( ! RouteRejoin::endsAt(
+                      *route, createList( pref, 3, 0x80000028, 0.75 ) ) );
+
+   // The route ends at node 1 with the offset on the node 0 form.
+   OrigDestInfo dest( *route->back()->getDestInfo() );
+   dest.setNodeID( 0x80000028 );
+   route->back()->setDestInfo( dest );
+   route->back()->setDestOffset( 0.75 );
+   MC2_TEST_CHECK( RouteRejoin::endsAt(
+                      *route, createList( pref, 3, 0x80000028, 0.25 ) ) );
+   MC2_TEST_CHECK( RouteRejoin::endsAt(
+                      *route, createList( pref, 3, 40, 0.75 ) ) );
+   MC2_TEST_CHECK( ! RouteRejoin::endsAt(
+                      *route, createList( pref, 4, 40, 0.75 ) ) );
+}
@@ -0,0 +1,137 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "MC2UnitTestMain.h"
+
+#include "RouteResultCache.h"
+#include "ServerSubRouteVector.h"
+#include "SubRoute.h"
+#include "OrigDestInfo.h"
+#include "DriverPref.h"
+
+namespace {
+
+/// Creates a route with two SubRoutes from orig to dest.
+ServerSubRouteVectorVector* createRoute( const DriverPref& pref,
+                                         const OrigDestInfo& orig,
+                                         const OrigDestInfo& dest ) {
+   OrigDestInfo middle( &pref, orig.getMapID(), 17, MAX_INT32, MAX_INT32,
+                        0.0 );
+   ServerSubRouteVector* route = new ServerSubRouteVector;
+   SubRoute* first = new SubRoute( orig, middle );
+   first->addNodeID( orig.getNodeID() );
+   first->addNodeID( 17 );
+   route->insertSubRoute( first );
+   SubRoute* second = new SubRoute( middle, dest );
+   second->addNodeID( dest.getNodeID() );
+   second->setCost( 100 );
+   route->insertSubRoute( second );
+   ServerSubRouteVectorVector* routes = new ServerSubRouteVectorVector;
+   routes->push_back( route );
+   return routes;
+}
+
+}
+
+MC2_UNIT_TEST_FUNCTION( routeResultCacheTest ) {
+   RouteResultCache cache( 2, 60 );
+   MC2_TEST_REQUIRED( cache.isEnabled() );
+
+   DriverPref pref;
+   OrigDestInfoList origs;
+   origs.addOrigDestInfo( OrigDestInfo( &pref, 1, 10, MAX_INT32, MAX_INT32,
+                                        0.25 ) );
+   OrigDestInfoList dests;
+   dests.addOrigDestInfo( OrigDestInfo( &pref, 1, 20, MAX_INT32, MAX_INT32,
+                                        0.5 ) );
+
+   RouteResultCache::Key key( NULL, origs, dests, pref, MAX_UINT32, 60 );
+   MC2_TEST_CHECK( cache.find( key, pref, 1000 ) == NULL );
+
+   ServerSubRouteVectorVector* routes =
+      createRoute( pref, origs.front(), dests.front() );
+   RouteResultCache::trafficVersions_t traffic;
+   traffic[ make_pair( 1, 7 ) ] = 100;
+   MC2_TEST_CHECK( cache.insert( key, *routes, traffic, 1000 ) );
+   delete routes;
+
+   // Found and with the vehicles of the new DriverPref.
+   DriverPref otherPref;
+   ServerSubRouteVectorVector* found = cache.find( key, otherPref, 1010 );
+   MC2_TEST_REQUIRED( found != NULL );
+   MC2_TEST_REQUIRED( found->size() == 1 );
+   const ServerSubRouteVector* route = found->front();
+   MC2_TEST_REQUIRED( route->size() == 2 );
+   MC2_TEST_CHECK( route->back()->getCost() == 100 );
+   MC2_TEST_CHECK( route->back()->getDestNodeID() == 20 );
+   MC2_TEST_CHECK( route->back()->getPrevSubRouteID() == MAX_UINT32 );
+   MC2_TEST_CHECK( route->front()->getOrigVehicle() ==
+                   otherPref.getBestVehicle() );
+   MC2_TEST_CHECK( route->back()->getDestInfo()->getVehicle() ==
+                   otherPref.getBestVehicle() );
+   delete found;
+
+   // Other preferences do not match.
+   DriverPref shortest;
+   shortest.setRoutingCosts( 0x01000000 );
+   RouteResultCache::Key otherKey( NULL, origs, dests, shortest,
+                                   MAX_UINT32, 60 );
+   MC2_TEST_CHECK( cache.find( otherKey, shortest, 1010 ) == NULL );
+
+   // Same traffic does not invalidate, new traffic does.
+   cache.updateTraffic( make_pair( 1, 7 ), 100 );
+   cache.updateTraffic( make_pair( 1, 8 ), 200 );
+   delete cache.find( key, pref, 1020 );
+   MC2_TEST_CHECK( cache.getStatistics().hits == 2 );
+   cache.updateTraffic( make_pair( 1, 7 ), 101 );
+   MC2_TEST_CHECK( cache.find( key, pref, 1020 ) == NULL );
+   MC2_TEST_CHECK( cache.getStatistics().invalidations == 1 );
+
+   // Routes calculated with the old traffic are not added.
+   routes = createRoute( pref, origs.front(), dests.front() );
+   MC2_TEST_CHECK( ! cache.insert( key, *routes, traffic, 1030 ) );
+   traffic[ make_pair( 1, 7 ) ] = 101;
+   MC2_TEST_CHECK( cache.insert( key, *routes, traffic, 1030 ) );
+   delete routes;
+
+   // Too old.
+   MC2_TEST_CHECK( cache.find( key, pref, 1090 ) == NULL );
+   MC2_TEST_CHECK( cache.getStatistics().nbrEntries == 0 );
+}
+
+MC2_UNIT_TEST_FUNCTION( routeResultCacheEvictTest ) {
+   RouteResultCache cache( 2, 60 );
+   DriverPref pref;
+   RouteResultCache::trafficVersions_t traffic;
+   OrigDestInfoList origs;
+   origs.addOrigDestInfo( OrigDestInfo( &pref, 1, 10, MAX_INT32, MAX_INT32,
+                                        0.0 ) );
+   for ( uint32 i = 0; i < 3; ++i ) {
+      OrigDestInfoList dests;
+      dests.addOrigDestInfo( OrigDestInfo( &pref, 1, 20 + i,
+                                           MAX_INT32, MAX_INT32, 0.0 ) );
+      RouteResultCache::Key key( NULL, origs, dests, pref, MAX_UINT32, 60 );
+      ServerSubRouteVectorVector* routes =
+         createRoute( pref, origs.front(), dests.front() );
+      MC2_TEST_CHECK( cache.insert( key, *routes, traffic, 1000 ) );
+      delete routes;
+   }
+   MC2_TEST_CHECK( cache.getStatistics().nbrEntries == 2 );
+
+   // The first one is the least recently used.
+   OrigDestInfoList dests;
+   dests.addOrigDestInfo( OrigDestInfo( &pref, 1, 20, MAX_INT32, MAX_INT32,
+                                        0.0 ) );
+   RouteResultCache::Key key( NULL, origs, dests, pref, MAX_UINT32, 60 );
+   MC2_TEST_CHECK( cache.find( key, pref, 1000 ) == NULL );
+}
@@ -0,0 +1,74 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "MC2UnitTestMain.h"
+
+#include "TileETagTable.h"
+
+MC2_UNIT_TEST_FUNCTION( matchTest ) {
+   const MC2String etag = TileETagTable::makeETag( 0x12, 0xabcdef01 );
+   MC2_TEST_CHECK( etag == "\"00000012-abcdef01\"" );
+
+   MC2String list( "\"other\", W/\"00000012-abcdef01\"" );
+   MC2_TEST_CHECK( TileETagTable::notModified( &list, 0, etag, 100 ) );
+   MC2String star( "*" );
+   MC2_TEST_CHECK( TileETagTable::notModified( &star, 0, etag, 100 ) );
+   MC2String other( "\"other\"" );
+   MC2_TEST_CHECK( ! TileETagTable::notModified( &other, 0, etag, 100 ) );
+   // If-None-Match wins over If-Modified-Since
+   MC2_TEST_CHECK( ! TileETagTable::notModified( &other, 200, etag, 100 ) );
+
+   MC2_TEST_CHECK( TileETagTable::notModified( NULL, 100, etag, 100 ) );
+   MC2_TEST_CHECK( ! TileETagTable::notModified( NULL, 99, etag, 100 ) );
+   MC2_TEST_CHECK( ! TileETagTable::notModified( NULL, 0, etag, 100 ) );
+}
+
+MC2_UNIT_TEST_FUNCTION( tableTest ) {
+   TileETagTable table( 2, 60 );
+   const MC2String etag = TileETagTable::makeETag( 1, 2 );
+   MC2String current;
+
+   // Nothing known yet.
+   MC2_TEST_CHECK( ! table.checkEarly( "a", 1, &etag, 0, 100, current ) );
+
+   MC2_TEST_CHECK( table.update( "a", 1, 2, 100 ) == 100 );
+   MC2_TEST_CHECK( table.checkEarly( "a", 1, &etag, 0, 150, current ) );
+   MC2_TEST_CHECK( current == etag );
+   // The ETag for the 304 also when only If-Modified-Since is sent.
+   current.clear();
+   MC2_TEST_CHECK( table.checkEarly( "a", 1, NULL, 100, 150, current ) );
+   MC2_TEST_CHECK( current == etag );
+   // Other format desc.
+   MC2_TEST_CHECK( ! table.checkEarly( "a", 3, &etag, 0, 150, current ) );
+   // Too old.
+   MC2_TEST_CHECK( ! table.checkEarly( "a", 1, &etag, 0, 161, current ) );
+
+   // Same crc keeps the last modified time, new crc changes it.
+   MC2_TEST_CHECK( table.update( "a", 1, 2, 200 ) == 100 );
+   MC2_TEST_CHECK( table.update( "a", 1, 5, 300 ) == 300 );
+   MC2_TEST_CHECK( ! table.checkEarly( "a", 1, &etag, 0, 310, current ) );
+
+   // The oldest entry is dropped when full.
+   table.update( "b", 1, 2, 300 );
+   table.update( "c", 1, 2, 300 );
+   MC2_TEST_CHECK( table.update( "a", 1, 5, 400 ) == 400 );
+
+   table.countLate( true );
+   table.countLate( false );
+   TileETagTable::Statistics stats = table.getStatistics();
+   MC2_TEST_CHECK( stats.earlyNotModified == 2 );
+   MC2_TEST_CHECK( stats.lateNotModified == 1 );
+   MC2_TEST_CHECK( stats.modified == 1 );
+   MC2_TEST_CHECK( stats.nbrEntries == 2 );
+}
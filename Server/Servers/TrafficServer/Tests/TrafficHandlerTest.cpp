@@ -56,6 +56,7 @@ public:
 
    virtual ~TestTrafficIPC() {
       reset();
+      STLUtility::deleteValues( m_storedElements );
    }
 
    bool sendChangeset( const Disturbances& newElements,
@@ -82,7 +83,17 @@ public:
 
    bool getAllDisturbances( const MC2String& provider,
                             Disturbances& disturbances ) {
-      return false;
+      if ( m_storedElements.empty() ) {
+         return false;
+      }
+      clone( m_storedElements, disturbances );
+      return true;
+   }
+
+   /// Sets the elements returned by \c getAllDisturbances
+   void setStoredElements( const Disturbances& elements ) {
+      STLUtility::deleteValues( m_storedElements );
+      clone( elements, m_storedElements );
    }
 
    void reset() {
@@ -108,6 +119,7 @@ public:
 private:
    Disturbances m_newElements;
    Disturbances m_removedElements;
+   Disturbances m_storedElements;
    bool m_fakeResult;
 };
 
@@ -298,3 +310,135 @@ MC2_UNIT_TEST_FUNCTION( testTrafficHandler ) {
    STLUtility::deleteValues( parsedSits );
    STLUtility::deleteValues( newElemsExpected );
 }
+
+MC2_UNIT_TEST_FUNCTION( testChangedSituations ) {
+   TestTrafficIPC* ttipc = new TestTrafficIPC();
+   ttipc->setFakeResult( true );
+
+   TrafficHandler handler( "dummy", ttipc );
+
+   TrafficHandler::SitCont parsedSits;
+   createTrafficSituations( 0, 5, parsedSits );
+   // 0,...,4 are stored now
+   handler.processSituations( parsedSits );
+   MC2_TEST_CHECK( ttipc->getNewElements().size() == 5 );
+
+   // The same situations again, nothing should be sent.
+   ttipc->reset();
+   createTrafficSituations( 0, 5, parsedSits );
+   handler.processSituations( parsedSits );
+   MC2_TEST_CHECK( ttipc->getNewElements().empty() );
+   MC2_TEST_CHECK( ttipc->getRemovedElements().empty() );
+
+   // Change the text of situation 2, only it should be replaced.
+   createTrafficSituations( 0, 5, parsedSits );
+   vector<pair<int32, int32> > coords;
+   TrafficSituation* changed = new TrafficSituation( "2", "foo" );
+   changed->addSituationElement( 
+      new TrafficSituationElement( "2",
+                                   1218454200, // start time
+                                   1918454200, // expiry time
+                                   1218024613,  // creation time
+                                   TrafficDataTypes::Accident, // type
+                                   TrafficDataTypes::ACI,      // phrase
+                                   TrafficDataTypes::Closed,   // severity
+                                   "Chuck Norris has left the road.",
+                                   "EE3316185", // first location
+                                   "EE3316184", // second location
+                                   MAX_UINT16, // event code
+                                   0, // extent
+                                   TrafficDataTypes::Positive,
+                                   0, // queue length
+                                   coords ) );
+   delete parsedSits[ 2 ];
+   parsedSits[ 2 ] = changed;
+   handler.processSituations( parsedSits );
+
+   MC2_TEST_REQUIRED( ttipc->getNewElements().size() == 1 );
+   MC2_TEST_REQUIRED( ttipc->getRemovedElements().size() == 1 );
+   MC2_TEST_CHECK( ttipc->getNewElements()[ 0 ]->getSituationReference() ==
+                   "2" );
+   MC2_TEST_CHECK( ttipc->getNewElements()[ 0 ]->getText() ==
+                   "Chuck Norris has left the road." );
+   MC2_TEST_CHECK( ttipc->getRemovedElements()[ 0 ]->
+                   getSituationReference() == "2" );
+
+   // And now the changed one is the stored one.
+   ttipc->reset();
+   handler.processSituations( parsedSits );
+   MC2_TEST_CHECK( ttipc->getNewElements().empty() );
+   MC2_TEST_CHECK( ttipc->getRemovedElements().empty() );
+
+   STLUtility::deleteValues( parsedSits );
+}
+
+/// @return A slow traffic situation with a severity factor.
+TrafficSituation* 
+createSlowSituation( const MC2String& sitRef, uint32 expiryTime,
+                     TrafficDataTypes::severity_factor severityFactor ) {
+   vector<pair<int32, int32> > coords;
+   TrafficSituation* sit = new TrafficSituation( sitRef, "foo" );
+   sit->addSituationElement( 
+      new TrafficSituationElement( sitRef,
+                                   1218454200, // start time
+                                   expiryTime,
+                                   1218024613,  // creation time
+                                   TrafficDataTypes::Accident, // type
+                                   TrafficDataTypes::ACI,      // phrase
+                                   TrafficDataTypes::SlowTraffic,
+                                   "Slow traffic after an accident.",
+                                   "EE3316185", // first location
+                                   "EE3316184", // second location
+                                   MAX_UINT16, // event code
+                                   0, // extent
+                                   TrafficDataTypes::Positive,
+                                   0, // queue length
+                                   coords,
+                                   "", // tmc version
+                                   severityFactor ) );
+   return sit;
+}
+
+MC2_UNIT_TEST_FUNCTION( testHashesAfterRestart ) {
+   TrafficHandler::SitCont parsedSits;
+   parsedSits.push_back( createSlowSituation( "1", 1918454200,
+                                              TrafficDataTypes::Severe ) );
+
+   // Store the situation as the feed gives it.
+   TestTrafficIPC* firstIPC = new TestTrafficIPC();
+   firstIPC->setFakeResult( true );
+   TrafficHandler first( "dummy", firstIPC );
+   first.processSituations( parsedSits );
+   MC2_TEST_REQUIRED( firstIPC->getNewElements().size() == 1 );
+
+   // Restart with the stored disturbances in the module, the same
+   // situation from the feed is not changed.
+   TestTrafficIPC* ttipc = new TestTrafficIPC();
+   ttipc->setFakeResult( true );
+   ttipc->setStoredElements( firstIPC->getNewElements() );
+   TrafficHandler handler( "dummy", ttipc );
+   handler.setup();
+   handler.processSituations( parsedSits );
+   MC2_TEST_CHECK( ttipc->getNewElements().empty() );
+   MC2_TEST_CHECK( ttipc->getRemovedElements().empty() );
+
+   // Only the expiry time changed.
+   STLUtility::deleteValues( parsedSits );
+   parsedSits.push_back( createSlowSituation( "1", 1918457800,
+                                              TrafficDataTypes::Severe ) );
+   handler.processSituations( parsedSits );
+   MC2_TEST_REQUIRED( ttipc->getNewElements().size() == 1 );
+   MC2_TEST_CHECK( ttipc->getRemovedElements().size() == 1 );
+   MC2_TEST_CHECK( ttipc->getNewElements()[ 0 ]->getEndTime() == 1918457800 );
+
+   // Only the severity factor changed.
+   ttipc->reset();
+   STLUtility::deleteValues( parsedSits );
+   parsedSits.push_back( createSlowSituation( "1", 1918457800,
+                                              TrafficDataTypes::Slight ) );
+   handler.processSituations( parsedSits );
+   MC2_TEST_CHECK( ttipc->getNewElements().size() == 1 );
+   MC2_TEST_CHECK( ttipc->getRemovedElements().size() == 1 );
+
+   STLUtility::deleteValues( parsedSits );
+}
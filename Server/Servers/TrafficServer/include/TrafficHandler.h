@@ -19,6 +19,7 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include "MC2String.h"
 
 #include <vector>
+#include <map>
 
 // forward declarations
 class TrafficIPC;
@@ -41,6 +42,9 @@ public:
    /// A Container containing the TrafficSituations to process.
    typedef std::vector< TrafficSituation* > SitCont;
 
+   /// Situation reference to hash of the situation content.
+   typedef std::map< MC2String, uint32 > SituationHashes;
+
    /**
     * Constructor.
     *
@@ -76,10 +80,11 @@ private:
 
    /**
     * Creates a unique set of situations to be added, updated or removed
-    * from the database.
+    * from the database. Situations that are stored but whose content
+    * has changed are both removed and added.
     * @param parsedSitCont SitCont from parser.
     * @param removed Disturbances of elements to be removed.
-    * @param newSitCont SitCont not yet in database.
+    * @param newSitCont SitCont not yet in database or changed.
     */
    void createUniqueSet( const SitCont& parsedSitCont,
                          Disturbances& removedElements,
@@ -115,12 +120,35 @@ private:
    void updateStoredElements( const Disturbances& newElements,
                               const Disturbances& removedElements );
 
+   /**
+    * Replaces the hashes in m_situationHashes with the hashes of
+    * situations.
+    * @param situations The situations that are stored now.
+    */
+   void updateSituationHashes( const SitCont& situations );
+
+   /**
+    * Replaces the hashes in m_situationHashes with the hashes of
+    * stored disturbances, as fetched at startup.
+    * @param disturbances The disturbances that are stored now.
+    */
+   void updateSituationHashes( const Disturbances& disturbances );
+
+   /**
+    * @param sit A situation with the same reference as a stored element.
+    * @return True if the content of sit differs from the stored one.
+    */
+   bool isChanged( const TrafficSituation& sit ) const;
+
    /// The provider for this feed.
    MC2String m_provider;
 
    /// Elements that are stored.
    Disturbances m_storedElements;
 
+   /// Hashes of the situations that the stored elements were made from.
+   SituationHashes m_situationHashes;
+
    TrafficIPC* m_communicator;
 };
 
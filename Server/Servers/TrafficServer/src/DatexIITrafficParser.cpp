@@ -25,7 +25,11 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 
 #include "DatexIIStructs.h"
 
-#include <sax/HandlerBase.hpp>
+#include <sax2/DefaultHandler.hpp>
+#include <sax2/SAX2XMLReader.hpp>
+#include <sax2/XMLReaderFactory.hpp>
+#include <sax2/Attributes.hpp>
+#include <framework/MemBufInputSource.hpp>
 
 #include <memory>
 
@@ -33,10 +37,159 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 
 using namespace DatexIIStructs;
 
+namespace {
+
+/**
+ * Reads a DatexII document with SAX and evaluates each situation as soon
+ * as it has been read.
+ *
+ * Only the situation being read is kept as a DOM tree, in a document of
+ * its own that is released when the situation has been evaluated. The
+ * memory used is thus bounded by the largest situation and not by the
+ * size of the feed.
+ */
+class SituationReader: public DefaultHandler {
+public:
+   SituationReader( SituationExpression& situationExp ):
+      m_situationExp( situationExp ),
+      m_impl( DOMImplementationRegistry::getDOMImplementation( X( "Core" ) ) ),
+      m_document( NULL ),
+      m_current( NULL ),
+      m_foundRoot( false ),
+      m_nbrSituations( 0 ) {
+   }
+
+   ~SituationReader() {
+      if ( m_document != NULL ) {
+         m_document->release();
+      }
+   }
+
+   void startElement( const XMLCh* const uri,
+                      const XMLCh* const localname,
+                      const XMLCh* const qname,
+                      const Attributes& attrs ) {
+      MC2String name = XMLUtility::transcodefrom( qname );
+      if ( m_document != NULL ) {
+         // Inside a situation, add to its tree.
+         DOMElement* element = m_document->createElement( qname );
+         setAttributes( element, attrs );
+         m_current->appendChild( element );
+         m_current = element;
+      } else if ( name == "situation" && 
+                  isPath( "d2LogicalModel", "payloadPublication" ) ) {
+         m_document = m_impl->createDocument( NULL, X( "situations" ), NULL );
+         DOMElement* element = m_document->createElement( qname );
+         setAttributes( element, attrs );
+         m_document->getDocumentElement()->appendChild( element );
+         m_current = element;
+      } else if ( name == "d2LogicalModel" && m_path.empty() ) {
+         m_foundRoot = true;
+      }
+      m_path.push_back( name );
+      m_text.clear();
+   }
+
+   void endElement( const XMLCh* const uri,
+                    const XMLCh* const localname,
+                    const XMLCh* const qname ) {
+      m_path.pop_back();
+      if ( m_document != NULL ) {
+         if ( m_current->getParentNode() == 
+              m_document->getDocumentElement() ) {
+            // The situation is complete
+            m_situationExp( m_current );
+            ++m_nbrSituations;
+            m_document->release();
+            m_document = NULL;
+            m_current = NULL;
+         } else {
+            m_current = static_cast< DOMElement* >( 
+               m_current->getParentNode() );
+         }
+      } else if ( isPath( "d2LogicalModel", "exchange", 
+                          "supplierIdentification" ) ) {
+         MC2String name = XMLUtility::transcodefrom( qname );
+         if ( name == "country" ) {
+            m_country = XMLUtility::transcodefrom( m_text.c_str() );
+         } else if ( name == "nationalIdentifier" ) {
+            m_messageSender = XMLUtility::transcodefrom( m_text.c_str() );
+         }
+      }
+      m_text.clear();
+   }
+
+   void characters( const XMLCh* const chars,
+                    const unsigned int length ) {
+      if ( m_document == NULL ) {
+         // Only the supplier identification is needed outside situations
+         m_text.append( chars, length );
+         return;
+      }
+
+      // Merge adjacent text like the DOM parser does
+      basic_string< XMLCh > text( chars, length );
+      DOMNode* last = m_current->getLastChild();
+      if ( last != NULL && last->getNodeType() == DOMNode::TEXT_NODE ) {
+         static_cast< DOMText* >( last )->appendData( text.c_str() );
+      } else {
+         m_current->appendChild( m_document->createTextNode( text.c_str() ) );
+      }
+   }
+
+   /// @return True if the root element d2LogicalModel was found.
+   bool foundRoot() const { return m_foundRoot; }
+
+   /// @return The country of the supplier.
+   const MC2String& getCountry() const { return m_country; }
+
+   /// @return The national identifier of the supplier.
+   const MC2String& getMessageSender() const { return m_messageSender; }
+
+   /// @return The number of situations read.
+   uint32 getNbrSituations() const { return m_nbrSituations; }
+
+private:
+   /// Copies the attributes to element.
+   static void setAttributes( DOMElement* element, const Attributes& attrs ) {
+      for ( uint32 i = 0; i < attrs.getLength(); ++i ) {
+         element->setAttribute( attrs.getQName( i ), attrs.getValue( i ) );
+      }
+   }
+
+   /// @return True if the current path is exactly the given elements.
+   bool isPath( const char* first, const char* second, 
+                const char* third = NULL ) const {
+      const uint32 size = third == NULL ? 2 : 3;
+      return m_path.size() == size &&
+         m_path[ 0 ] == first && m_path[ 1 ] == second &&
+         ( third == NULL || m_path[ 2 ] == third );
+   }
+
+   /// Evaluates each complete situation.
+   SituationExpression& m_situationExp;
+   /// Creates the documents for the situations.
+   DOMImplementation* m_impl;
+   /// The document for the situation being read, NULL outside situations.
+   DOMDocument* m_document;
+   /// The element being read in m_document.
+   DOMElement* m_current;
+   /// The names of the open elements.
+   vector< MC2String > m_path;
+   /// Text of the current element outside situations.
+   basic_string< XMLCh > m_text;
+   bool m_foundRoot;
+   MC2String m_country;
+   MC2String m_messageSender;
+   uint32 m_nbrSituations;
+};
+
+}
+
 struct DatexIITrafficParser::Impl {
    explicit Impl( const MC2String& provider ):
       m_provider( provider ) { }
-   bool parseXMLFile( const char* xmlFile );
+   bool parseXMLFile( const char* xmlFile, uint32 length );
    DatexIITrafficParser::Situations m_trafficSituations;
    MC2String m_provider;
 };
@@ -51,34 +204,45 @@ DatexIITrafficParser::~DatexIITrafficParser() {
    delete m_impl;
 }
 
-bool DatexIITrafficParser::Impl::parseXMLFile( const char* xmlFile ) {
+bool DatexIITrafficParser::Impl::parseXMLFile( const char* xmlFile, 
+                                               uint32 length ) {
 
    mc2log << info << DIIPT << "Parsing XML-file." << endl;
-   MC2String country;
-   MC2String messageSender;
-
-   MultiExpression::NodeDescription desc[] = {
-      {"exchange/supplierIdentification/country",
-       makeAssigner( country ) },
-      {"exchange/supplierIdentification/nationalIdentifier", 
-       makeAssigner( messageSender ) },
-      {"payloadPublication/situation*",
-       new SituationExpression( m_trafficSituations, m_provider ) }
-   };
 
-   uint32 descSize = sizeof( desc ) / sizeof( desc[ 0 ] ) ;
-   MultiExpression supplierInfo( MultiExpression::
-                                 Description( desc, desc + descSize ) );
+   /* Each situation in payloadPublication is evaluated by the
+    * SituationExpression when it has been read:
+    *  * SituationExpression
+    *  |
+    *  |-> * AccidentExpression : SituationRecordExpression
+    *  |   |-> * AlertCMethod4Expression
+    *  |   |-> * AlertCMethod2Expression
+    *  |
+    *  |-> * NetworkManagementExpression : SituationRecordExpression
+    *  |-> * MaintenanceWorksExpression : SituationRecordExpression
+    *  |-> * ConstructionWorksExpression : SituationRecordExpression
+    *  |-> * AbnormalTrafficExpression : SituationRecordExpression
+    *  |-> * Activities : SituationRecordExpression
+    *  |-> * AnimalPresenceObstruction : SituationRecordExpression
+    *  |-> * GeneralObstruction : SituationRecordExpression
+    *  |-> * NonWeatherRelatedRoadConditions : SituationRecordExpression
+    *  |-> * VehicleObstruction : SituationRecordExpression
+    *      |-> * AlertCMethod4Expression
+    *      |-> * AlertCMethod2Expression
+    */
+   SituationExpression situationExp( m_trafficSituations, m_provider );
+   SituationReader reader( situationExp );
 
-   XercesDOMParser parser;
-   parser.setValidationScheme( XercesDOMParser::Val_Auto );
-   parser.setIncludeIgnorableWhitespace( false );
+   auto_ptr< SAX2XMLReader > parser( XMLReaderFactory::createXMLReader() );
+   // Same names as the DOM parser, without namespace processing
+   parser->setFeature( XMLUni::fgSAX2CoreNameSpaces, false );
+   parser->setFeature( XMLUni::fgSAX2CoreValidation, false );
+   parser->setContentHandler( &reader );
+   parser->setErrorHandler( &reader );
 
-   MemBufInputSource xmlBuff( (byte*)xmlFile, 
-                              strlen( xmlFile ), "xmlRequest" );
+   MemBufInputSource xmlBuff( (byte*)xmlFile, length, "xmlRequest" );
 
    try {
-      parser.parse( xmlBuff );
+      parser->parse( xmlBuff );
    } catch (const XMLException& e) {
       MC2String message = XMLUtility::transcodefrom( e.getMessage() );
       mc2log << error << DIIPT << "XML Exception message is: " 
@@ -95,76 +259,24 @@ bool DatexIITrafficParser::Impl::parseXMLFile( const char* xmlFile ) {
              << ", column " << e.getColumnNumber() << endl;
    }
 
-   mc2dbg << "looking for root node " << endl;
-   const char* rootName = "d2LogicalModel";
-   const DOMNode* root = XMLTool::findNodeConst( parser.getDocument(),
-                                                 rootName );
-   mc2dbg << "found root node " << endl;
-
-   /* This will evalute a multiexpression built up in this way:
-    *  * suplierInfo
-    *  |
-    *  |-> * SituationExpression
-    *      |
-    *      |-> * AccidentExpression : SituationRecordExpression
-    *      |   |-> * AlertCMethod4Expression
-    *      |   |-> * AlertCMethod2Expression
-    *      |
-    *      |-> * NetworkManagementExpression : SituationRecordExpression
-    *      |   |-> * AlertCMethod4Expression
-    *      |   |-> * AlertCMethod2Expression
-    *      |
-    *      |-> * MaintenanceWorksExpression : SituationRecordExpression
-    *      |   |-> * AlertCMethod4Expression
-    *      |   |-> * AlertCMethod2Expression
-    *      |
-    *      |-> * ConstructionWorksExpression : SituationRecordExpression
-    *      |   |-> * AlertCMethod4Expression
-    *      |   |-> * AlertCMethod2Expression
-    *      |
-    *      |-> * AbnormalTrafficExpression : SituationRecordExpression
-    *      |   |-> * AlertCMethod4Expression
-    *      |   |-> * AlertCMethod2Expression
-    *      |
-    *      |-> * Activities : SituationRecordExpression
-    *      |   |-> * AlertCMethod4Expression
-    *      |   |-> * AlertCMethod2Expression
-    *      |
-    *      |-> * AnimalPresenceObstruction : SituationRecordExpression
-    *      |   |-> * AlertCMethod4Expression
-    *      |   |-> * AlertCMethod2Expression
-    *      |
-    *      |-> * GeneralObstruction : SituationRecordExpression
-    *      |   |-> * AlertCMethod4Expression
-    *      |   |-> * AlertCMethod2Expression
-    *      |
-    *      |-> * NonWeatherRelatedRoadConditions : SituationRecordExpression
-    *      |   |-> * AlertCMethod4Expression
-    *      |   |-> * AlertCMethod2Expression
-    *      |
-    *      |-> * VehicleObstruction : SituationRecordExpression
-    *          |-> * AlertCMethod4Expression
-    *          |-> * AlertCMethod2Expression
-    */
-
    // Check for the root node
-   if ( root == NULL ) {
+   if ( ! reader.foundRoot() ) {
       mc2log << warn << DIIPT << "could not find root node: " 
-             << rootName << endl;
+             << "d2LogicalModel" << endl;
       return false;
-   } else { 
-      supplierInfo.evaluate( root );
    }
 
    // Check if there is a country and a supplier info in the data
-   if ( country.empty() || messageSender.empty() ) {
+   if ( reader.getCountry().empty() || reader.getMessageSender().empty() ) {
       mc2log << warn << DIIPT << " not a valid DatexII format."
              << " Supplier identification data incorrect." << endl;
       return false;
    }
 
-   mc2log << info << DIIPT << "Reference Name: " << messageSender
-          << " Country: " << country << endl;
+   mc2log << info << DIIPT << "Reference Name: " 
+          << reader.getMessageSender()
+          << " Country: " << reader.getCountry() 
+          << " Situations: " << reader.getNbrSituations() << endl;
 
    return true;
 }
@@ -172,7 +284,7 @@ bool DatexIITrafficParser::Impl::parseXMLFile( const char* xmlFile ) {
 bool DatexIITrafficParser::
 parse( const MC2String& data, Situations& situations ) {
 
-   if ( ! m_impl->parseXMLFile( data.c_str() ) ) {
+   if ( ! m_impl->parseXMLFile( data.data(), data.size() ) ) {
       return false;
    }
 
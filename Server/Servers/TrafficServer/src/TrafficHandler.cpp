@@ -21,6 +21,7 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include "DisturbanceElement.h"
 #include "DeleteHelpers.h"
 #include "IDPairVector.h"
+#include "MC2CRC32.h"
 
 #include <algorithm>
 #include <iterator>
@@ -48,6 +49,7 @@ TrafficHandler::TrafficHandler( const MC2String& provider,
                                 TrafficIPC* communicator ):
    m_provider( provider ),
    m_storedElements(),
+   m_situationHashes(),
    m_communicator( communicator ) {
 }
 
@@ -127,6 +129,10 @@ bool TrafficHandler::fetchSituationsFromModule() {
       return false;
    }
 
+   // The hashes are made from what is stored, the situations made from
+   // it lack the severity factor.
+   updateSituationHashes( disturbances );
+
    // create temporary traffic situations 
    SitCont trafficSits;
    createTrafficSituations( disturbances, trafficSits );
@@ -152,6 +158,130 @@ bool isValid( const TrafficSituation& sit ) {
    return timeNow < tseVect.front()->getExpiryTime();
 }
 
+namespace {
+
+/// Appends the bytes of value to data.
+template < typename T >
+void appendBytes( MC2String& data, const T& value ) {
+   data.append( reinterpret_cast< const char* >( &value ), sizeof( value ) );
+}
+
+/// Appends str and its terminating zero to data.
+void appendBytes( MC2String& data, const MC2String& str ) {
+   data.append( str.c_str(), str.size() + 1 );
+}
+
+/**
+ * Creates the disturbance that is stored for a situation, without map
+ * and coordinates. Only the first element of the situation is used.
+ */
+DisturbanceElement* createDisturbance( const TrafficSituation& sit ) {
+   const TrafficSituationElement* trafficElem = 
+      sit.getSituationElements().front();
+   // This is needed since some parsers have a severity factor
+   TrafficDataTypes::severity severity = trafficElem->getSeverity();
+   uint32 costFactor = TrafficDataTypes::
+      getCostFactorFromSeverity( severity );
+
+   if ( costFactor != MAX_UINT32 ) {
+      TrafficDataTypes::severity_factor severityFactor = 
+         trafficElem->getSeverityFactor();
+      costFactor = 
+         (uint32)( (float)costFactor * 
+                   TrafficDataTypes::
+                   getCostFactorFromSeverityFactor( severityFactor ) );
+   }
+
+   return new DisturbanceElement( MAX_UINT32, // disturbanceID
+                                  sit.getSituationReference(),
+                                  trafficElem->getType(),
+                                  trafficElem->getPhrase(),
+                                  trafficElem->getEventCode(),
+                                  trafficElem->getStartTime(),
+                                  trafficElem->getExpiryTime(),
+                                  trafficElem->getCreationTime(),
+                                  severity,
+                                  trafficElem->getDirection(),
+                                  trafficElem->getFirstLocationCode(),
+                                  trafficElem->getSecondLocationCode(),
+                                  trafficElem->getExtent(),
+                                  costFactor,
+                                  trafficElem->getText(),
+                                  trafficElem->getQueueLength() );
+}
+
+/**
+ * Hashes the fields of a stored disturbance that come from the feed,
+ * that is all but the id, map and coordinates.
+ */
+uint32 hashDisturbance( const DisturbanceElement& disturbance ) {
+   MC2String data;
+   appendBytes( data, disturbance.getSituationReference() );
+   appendBytes( data, uint32( disturbance.getType() ) );
+   appendBytes( data, uint32( disturbance.getPhrase() ) );
+   appendBytes( data, disturbance.getEventCode() );
+   appendBytes( data, disturbance.getStartTime() );
+   appendBytes( data, disturbance.getEndTime() );
+   appendBytes( data, disturbance.getCreationTime() );
+   appendBytes( data, uint32( disturbance.getSeverity() ) );
+   appendBytes( data, uint32( disturbance.getDirection() ) );
+   appendBytes( data, disturbance.getFirstLocation() );
+   appendBytes( data, disturbance.getSecondLocation() );
+   appendBytes( data, disturbance.getExtent() );
+   appendBytes( data, disturbance.getCostFactor() );
+   appendBytes( data, disturbance.getText() );
+   appendBytes( data, disturbance.getQueueLength() );
+   return MC2CRC32::crc32( reinterpret_cast< const byte* >( data.data() ),
+                           data.size() );
+}
+
+/**
+ * Hashes a situation from the feed as it would be stored, so the hash
+ * equals the one of the stored disturbances made from it.
+ */
+uint32 hashSituation( const TrafficSituation& sit ) {
+   if ( sit.getNbrElements() == 0 ) {
+      // Nothing is stored, only tell the references apart.
+      return MC2CRC32::crc32( reinterpret_cast< const byte* >( 
+                                 sit.getSituationReference().c_str() ),
+                              sit.getSituationReference().size() + 1 );
+   }
+   auto_ptr< DisturbanceElement > disturbance( createDisturbance( sit ) );
+   return hashDisturbance( *disturbance );
+}
+
+}
+
+bool TrafficHandler::isChanged( const TrafficSituation& sit ) const {
+   SituationHashes::const_iterator it = 
+      m_situationHashes.find( sit.getSituationReference() );
+   if ( it == m_situationHashes.end() ) {
+      // Nothing to compare with, keep the stored one.
+      return false;
+   }
+   return it->second != hashSituation( sit );
+}
+
+void TrafficHandler::updateSituationHashes( const SitCont& situations ) {
+   m_situationHashes.clear();
+   for ( SitCont::const_iterator it = situations.begin(); 
+         it != situations.end(); ++it ) {
+      m_situationHashes[ (*it)->getSituationReference() ] = 
+         hashSituation( **it );
+   }
+}
+
+void 
+TrafficHandler::updateSituationHashes( const Disturbances& disturbances ) {
+   m_situationHashes.clear();
+   for ( Disturbances::const_iterator it = disturbances.begin(); 
+         it != disturbances.end(); ++it ) {
+      // The disturbances of the maps of a situation have the same hash.
+      m_situationHashes[ (*it)->getSituationReference() ] = 
+         hashDisturbance( **it );
+   }
+}
+
 void TrafficHandler::
 createUniqueSet( const SitCont& parsedSitCont,
                  Disturbances& removedElements,
@@ -170,7 +300,12 @@ createUniqueSet( const SitCont& parsedSitCont,
       if ( result.first != removedElements.end() &&
            (*result.first)->getSituationReference() ==
            (*pIt)->getSituationReference() ) {
-         removedElements.erase( result.first, result.second );
+         if ( ! isChanged( **pIt ) ) {
+            removedElements.erase( result.first, result.second );
+         } else if ( isValid( **pIt ) ) {
+            // changed, remove the stored elements and add the new ones.
+            newSituations.push_back( *pIt );
+         }
       } else {
          // new situation not in m_storedElements, add it.
          // check if the time has expired. If it has, skip it.
@@ -200,6 +335,7 @@ bool TrafficHandler::processSituations( const SitCont& trafficSits ) {
 
    if ( sendChangeset( newElements, removedElements ) ) {
       updateStoredElements( newElements, removedElements );
+      updateSituationHashes( trafficSits );
    } else {
       // the changeset failed, we need to resync with the database again
       mc2log << "[TrafficHandler] Changeset failed, resyncing with database..."
@@ -228,22 +364,6 @@ void TrafficHandler::composeNewElements( const SitCont& newSituations,
          cSitIt != newSituations.end(); ++cSitIt ) {
 
       const TrafficSituation& traffSit( **cSitIt );
-      vector< TrafficSituationElement* > tse = traffSit.getSituationElements();
-
-      TrafficSituationElement* trafficElem( tse.front() );
-      // This is needed since some parsers have a severity factor
-      TrafficDataTypes::severity severity = trafficElem->getSeverity();
-      uint32 costFactor = TrafficDataTypes::
-         getCostFactorFromSeverity( severity );
-
-      if ( costFactor != MAX_UINT32 ) {
-         TrafficDataTypes::severity_factor severityFactor = 
-            trafficElem->getSeverityFactor();
-         costFactor = 
-            (uint32)( (float)costFactor * 
-                      TrafficDataTypes::
-                      getCostFactorFromSeverityFactor( severityFactor ) );
-      }
       
       TrafficIPC::IDPairsToCoords idPairsToCoords;
       m_communicator->getMapIDsNodeIDsCoords( traffSit, idPairsToCoords );
@@ -253,22 +373,7 @@ void TrafficHandler::composeNewElements( const SitCont& newSituations,
             it != idPairsToCoords.end(); ) {
          // one element per map..
          auto_ptr< DisturbanceElement > disturbance( 
-               new DisturbanceElement( MAX_UINT32, // disturbanceID
-                                       traffSit.getSituationReference(),
-                                       trafficElem->getType(),
-                                       trafficElem->getPhrase(),
-                                       trafficElem->getEventCode(),
-                                       trafficElem->getStartTime(),
-                                       trafficElem->getExpiryTime(),
-                                       trafficElem->getCreationTime(),
-                                       severity,
-                                       trafficElem->getDirection(),
-                                       trafficElem->getFirstLocationCode(),
-                                       trafficElem->getSecondLocationCode(),
-                                       trafficElem->getExtent(),
-                                       costFactor,
-                                       trafficElem->getText(),
-                                       trafficElem->getQueueLength() ) );
+               createDisturbance( traffSit ) );
 
          disturbance->setMapID( it->first.first );
 
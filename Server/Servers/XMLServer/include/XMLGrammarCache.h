@@ -0,0 +1,99 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#ifndef XMLGRAMMARCACHE_H
+#define XMLGRAMMARCACHE_H
+
+#include "config.h"
+#include "NotCopyable.h"
+
+#include <boost/shared_ptr.hpp>
+
+class XMLGrammarCache;
+
+/// The grammar cache is shared by the group and its threads.
+typedef boost::shared_ptr<XMLGrammarCache> XMLGrammarCachePtr;
+
+#ifdef USE_XML
+#include <parsers/XercesDOMParser.hpp>
+#include <sax2/SAX2XMLReader.hpp>
+#include <framework/XMLGrammarPool.hpp>
+
+#if (XERCES_VERSION_MAJOR == 2 && XERCES_VERSION_MINOR >= 4) || (XERCES_VERSION_MAJOR > 2)
+using namespace xercesc;
+#endif
+
+/**
+ * Holds the pre-parsed grammars of isab-mc2.dtd and public.dtd for all
+ * XMLParserThreads.
+ *
+ * The grammars are parsed once when the cache is created and the pool is
+ * then locked, which makes it safe to share between the parsers of all
+ * threads. Parsers and SAX2 readers created by the cache validate against
+ * the cached grammars and never read the DTDs again.
+ */
+class XMLGrammarCache: private NotCopyable {
+public:
+   /**
+    * Parses the DTDs into the grammar pool. Exits the server if the
+    * DTDs can not be parsed, as nothing can be validated without them.
+    */
+   XMLGrammarCache();
+
+   /**
+    * Deletes the grammar pool. All parsers created by the cache must
+    * be deleted before the cache.
+    */
+   ~XMLGrammarCache();
+
+   /**
+    * Creates a new parser that uses the cached grammars. The parser has
+    * an XMLParserErrorReporter and an XMLParserEntityResolver that the
+    * caller should delete with the parser, see deleteParser.
+    *
+    * @return A new parser, delete it using deleteParser.
+    */
+   XercesDOMParser* createParser() const;
+
+   /**
+    * Deletes a parser created by createParser.
+    *
+    * @param parser The parser to delete.
+    */
+   static void deleteParser( XercesDOMParser* parser );
+
+   /**
+    * Creates a new SAX2 reader that validates like the parsers from
+    * createParser. The reader has an XMLParserErrorReporter and an
+    * XMLParserEntityResolver but no content handler.
+    *
+    * @return A new reader, delete it using deleteReader.
+    */
+   SAX2XMLReader* createReader() const;
+
+   /**
+    * Deletes a reader created by createReader.
+    *
+    * @param reader The reader to delete.
+    */
+   static void deleteReader( SAX2XMLReader* reader );
+
+private:
+   /// The grammars, locked after the initial parse.
+   XMLGrammarPool* m_grammarPool;
+};
+
+#endif // USE_XML
+
+#endif // XMLGRAMMARCACHE_H
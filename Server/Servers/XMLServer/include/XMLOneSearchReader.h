@@ -0,0 +1,163 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef XMLONESEARCHREADER_H
+#define XMLONESEARCHREADER_H
+
+#include "config.h"
+
+#ifdef USE_XML
+
+#include "NotCopyable.h"
+#include "MC2String.h"
+#include "CompactSearch.h"
+#include "XMLCommonEntities.h"
+
+#include <dom/DOM.hpp>
+#include <sax2/DefaultHandler.hpp>
+#include <sax2/Attributes.hpp>
+
+#include <map>
+#include <vector>
+#include <string>
+
+#if (XERCES_VERSION_MAJOR == 2 && XERCES_VERSION_MINOR >= 4) || (XERCES_VERSION_MAJOR > 2)
+using namespace xercesc;
+#endif
+
+/**
+ * Reads an isab-mc2 document with a one_search_request using SAX2.
+ *
+ * The search parameters are set from the parse events, no DOM tree is
+ * built of the request. Only the auth element is kept as a small DOM
+ * document, as the authorization checks are written against it.
+ *
+ * A document with any other element than auth and one_search_request in
+ * isab-mc2 is not supported, the reader stops collecting and the document
+ * should be handled by the DOM parser as before. Use isSupported while
+ * parsing to stop early.
+ */
+class XMLOneSearchReader: public DefaultHandler, private NotCopyable {
+public:
+   XMLOneSearchReader();
+
+   ~XMLOneSearchReader();
+
+   void startElement( const XMLCh* const uri,
+                      const XMLCh* const localname,
+                      const XMLCh* const qname,
+                      const Attributes& attrs );
+
+   void endElement( const XMLCh* const uri,
+                    const XMLCh* const localname,
+                    const XMLCh* const qname );
+
+   void characters( const XMLCh* const chars,
+                    const unsigned int length );
+
+   /// @return False if the document has elements not read here.
+   bool isSupported() const { return m_supported; }
+
+   /// @return True if a whole supported document has been read.
+   bool isComplete() const;
+
+   /// @return Document with the auth elements of the request.
+   const DOMDocument* getAuthDocument() const { return m_authDocument; }
+
+   /// @return The transaction_id of the one_search_request.
+   const MC2String& getTransactionID() const { return m_transactionID; }
+
+   /// @return The search parameters, valid if getError is empty.
+   const CompactSearch& getParams() const { return m_params; }
+
+   /// @return The position system to use in the reply.
+   XMLCommonEntities::coordinateType getPositionSystem() const {
+      return m_positionSystem;
+   }
+
+   /// @return The problem with the request, empty if none.
+   const MC2String& getError() const { return m_error; }
+
+private:
+   /**
+    * Sets the search parameters from the collected attributes and texts,
+    * in the same way and order as xmlParseOneSearchRequest reads them
+    * from the DOM. Sets m_error if there is a problem.
+    */
+   void readParams();
+
+   /// Sets the parameters, throws like XMLTool and MC2Exception.
+   void setParams();
+
+   /// Reads the position_item into m_params.m_location, throws on problem.
+   void readPosition();
+
+   /// @return Value of an attribute of one_search_request, NULL if none.
+   const MC2String* findAttrib( const char* name ) const;
+
+   /// @return Text of a child element of one_search_request, NULL if none.
+   const MC2String* findChildText( const char* name ) const;
+
+   /// Sets dest from an attribute that must be present.
+   template < typename T >
+   void getAttrib( T& dest, const char* name ) const;
+
+   /// Sets dest from an attribute, or to defaultValue if no valid one.
+   template < typename T >
+   void getAttrib( T& dest, const char* name, const T& defaultValue ) const;
+
+   /// Sets dest from a child element that must be present.
+   template < typename T >
+   void getChildValue( T& dest, const char* name ) const;
+
+   typedef std::map< MC2String, MC2String > StringMap;
+
+   /// Creates the documents for the auth elements.
+   DOMImplementation* m_impl;
+   /// Document with the auth elements, rooted in isab-mc2.
+   DOMDocument* m_authDocument;
+   /// The element being read in m_authDocument, NULL outside auth.
+   DOMElement* m_authCurrent;
+   /// The names of the open elements.
+   std::vector< MC2String > m_path;
+   /// Text of the current element outside auth.
+   std::basic_string< XMLCh > m_text;
+   /// False when something not read here has been found.
+   bool m_supported;
+   /// If the root element isab-mc2 has ended.
+   bool m_rootEnded;
+   /// Number of one_search_request elements.
+   uint32 m_nbrRequests;
+
+   /// The attributes of one_search_request.
+   StringMap m_attributes;
+   /// The texts of the children of one_search_request.
+   StringMap m_childTexts;
+   /// The texts of the category_id elements in category_list.
+   std::vector< MC2String > m_categoryIDs;
+   /// If the request has a position_item.
+   bool m_hasPosition;
+   /// The position_system attribute of position_item, empty if none.
+   MC2String m_positionItemSystem;
+   /// The texts of the children of position_item.
+   StringMap m_positionTexts;
+
+   MC2String m_transactionID;
+   CompactSearch m_params;
+   XMLCommonEntities::coordinateType m_positionSystem;
+   MC2String m_error;
+};
+
+#endif // USE_XML
+
+#endif // XMLONESEARCHREADER_H
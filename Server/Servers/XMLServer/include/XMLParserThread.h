@@ -23,6 +23,7 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include "RouteMessageRequestType.h"
 #include "ExpandedRouteItem.h"
 #include "ParserUserHandler.h"
+#include "XMLGrammarCache.h"
 
 #ifdef USE_XML
 
@@ -90,6 +91,9 @@ class SearchMatch;
 class XMLExtServiceHelper;
 class XMLAuthData;
 class SearchParserHandler;
+class XMLParserThreadGroup;
+class XMLOneSearchReader;
+class XMLStreamWriter;
 
 
 /**
@@ -100,10 +104,10 @@ class XMLParserThread : public HttpParserThread {
    public:
       /**
        * Creates a new XMLParserThread.
-       * @param group The HttpParserThreadGroup that this XMLParserThread
+       * @param group The XMLParserThreadGroup that this XMLParserThread
        *              is part of.
        */
-      XMLParserThread( HttpParserThreadGroup* group );
+      XMLParserThread( XMLParserThreadGroup* group );
 
       
       /**
@@ -255,6 +259,16 @@ class XMLParserThread : public HttpParserThread {
                                       DOMDocument* reply,
                                       bool indent ); 
 
+   /**
+    * Handles a one_search_request read by an XMLOneSearchReader and
+    * writes the one_search_reply.
+    *
+    * @param request The read request.
+    * @param writer Where to write the reply, in the current element.
+    */
+   void writeOneSearchReply( const XMLOneSearchReader& request,
+                             XMLStreamWriter& writer );
+
    /**
     * Parse and handle category_list_request element
     */
@@ -942,6 +956,7 @@ class XMLParserThread : public HttpParserThread {
             bool& routeItems,
             bool& abbreviateRouteNames,
             bool& routeLandmarks,
+            uint32& routeAlternatives,
             uint32& routeOverviewImageWidth,
             uint32& routeOverviewImageHeight,
             uint32& routeTurnImageWidth,
@@ -981,6 +996,7 @@ class XMLParserThread : public HttpParserThread {
             bool routeItems,
             bool abbreviateRouteNames,
             bool routeLandmarks,
+            uint32 routeAlternatives,
             uint32 routeOverviewImageWidth,
             uint32 routeOverviewImageHeight,
             uint32 routeTurnImageWidth,
@@ -1019,6 +1035,7 @@ class XMLParserThread : public HttpParserThread {
             bool& routeItems,
             bool& abbreviateRouteNames,
             bool& routeLandmarks,
+            uint32& routeAlternatives,
             uint32& routeOverviewImageWidth,
             uint32& routeOverviewImageHeight,
             uint32& routeTurnImageWidth,
@@ -1554,6 +1571,39 @@ class XMLParserThread : public HttpParserThread {
                                  uint32 now,
                                  const char* dateStr );
 
+      /**
+       * Handles an isab-mc2 request with only a one_search_request, the
+       * most common request, without building DOM trees of the request
+       * and the reply. The request is read with SAX2 and the reply is
+       * written with an XMLStreamWriter.
+       *
+       * @param inHead The HTTP header of the request.
+       * @param inBody The body content, checked by checkAndFixHeader.
+       * @param outHead The HTTP header of the reply.
+       * @param outBody The content of the reply.
+       * @return True if the request was handled, false if it should be
+       *         handled by handleXMLHttpRequest using the DOM. Nothing
+       *         is done to the request or the reply if false.
+       */
+      bool handleStreamedRequest( HttpHeader* inHead, 
+                                  HttpBody* inBody,
+                                  HttpHeader* outHead, 
+                                  HttpBody* outBody );
+
+      /**
+       * Sets the log name, client setting and request data from the
+       * user of an authorized request.
+       */
+      void setRequestUser();
+
+      /**
+       * Parses the reply against the DTD and adds the problems, if any,
+       * as a comment to the reply. For XML_SERVER_REPLY_DTD_CHECK.
+       *
+       * @param outBody The reply to check.
+       */
+      void checkReplyAgainstDTD( HttpBody* outBody );
+
        /**
         * Makes a favorite element.
         * @param favorite The UserFavorite to make an element for.
@@ -1704,6 +1754,17 @@ class XMLParserThread : public HttpParserThread {
        */
       XercesDOMParser* m_parser;
 
+      /**
+       * The SAX2 reader for the requests handled by handleStreamedRequest.
+       */
+      SAX2XMLReader* m_reader;
+
+      /**
+       * The grammars used by m_parser and m_reader, kept until they are
+       * deleted.
+       */
+      XMLGrammarCachePtr m_grammarCache;
+
       /**
        * Get the user for a set of hardware keys.
        */
@@ -1807,6 +1868,20 @@ class XMLParserThread : public HttpParserThread {
          const UserLicenceKey* autoKey = NULL,
          bool checkAndUseAC = false );
 
+   /**
+    * Check with external authority if user is allowed to search.
+    *
+    * @param params CompactSearch settings used
+    * @param errorCode Set to the status code if not allowed.
+    * @param errorMessage Set to the status message if not allowed.
+    * @param errorURI Set to the status URI, empty if none.
+    * @return True if allowed to search otherwise false.
+    */
+   bool checkAllowedToSearch( const CompactSearch& params,
+                              MC2String& errorCode,
+                              MC2String& errorMessage,
+                              MC2String& errorURI );
+
    /**
     * Check with external authority if user is allowed to search.
     *
@@ -18,7 +18,7 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include "HttpParserThreadConfig.h"
 #include "HttpParserThreadGroup.h"
 #include "MC2String.h"
-
+#include "XMLGrammarCache.h"
 
 /**
  * Subclass to HttpParserThreadGroup that creates XMLParserThreads.
@@ -55,6 +55,14 @@ class XMLParserThreadGroup : public HttpParserThreadGroup {
       ~XMLParserThreadGroup();
 
 
+      /**
+       * Get the grammars shared by the parsers of all threads.
+       * The threads keep the returned pointer until their parser is
+       * deleted, as the threads may outlive the group.
+       */
+      XMLGrammarCachePtr getGrammarCache() const;
+
+
    protected:
       /**
        * Create a new XMLPaserThread for processing.
@@ -69,6 +77,10 @@ class XMLParserThreadGroup : public HttpParserThreadGroup {
        * @return A MC2String with the default page for a request for "/".
        */
       virtual MC2String getDefaultPage() const;
+
+   private:
+      /// The pre-parsed DTDs.
+      XMLGrammarCachePtr m_grammarCache;
 };
 
 
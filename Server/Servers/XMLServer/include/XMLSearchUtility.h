@@ -26,6 +26,7 @@ class OverviewMatch;
 class VanillaRegionMatch;
 class SearchMatch;
 class XMLParserThread;
+class XMLStreamWriter;
 
 namespace XMLSearchUtility {
 
@@ -412,6 +413,24 @@ void appendSearchListElement( DOMNode* parentNode,
                               XMLCommonEntities::coordinateType positionSystem,
                               LangTypes::language_t language,
                               XMLParserThread* thread);
+
+/**
+ * Writes a search_list element including the list of matches, the same
+ * as appendSearchListElement makes. Only one search_match at a time is
+ * built as DOM nodes, they are released when written.
+ *
+ * @param writer Where to write the search_list.
+ * @param req The search result request with the matches
+ * @param maxHits Maximum number of hits to print
+ * @param positionSystem Coordinate system
+ * @param thread The parser thread.
+ */
+void writeSearchListElement( XMLStreamWriter& writer,
+                             const SearchResultRequest* req,
+                             uint32 maxHits,
+                             XMLCommonEntities::coordinateType positionSystem,
+                             LangTypes::language_t language,
+                             XMLParserThread* thread );
 } // End namespace XMLSearchUtility
 
 #endif // XMLSEARCHUTILITY_H
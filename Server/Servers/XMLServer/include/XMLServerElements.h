@@ -19,6 +19,7 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include "MC2String.h"
 
 class NamedServerList;
+class XMLStreamWriter;
 
 // most function moved from XMLParserThread
 namespace XMLServerUtility {
@@ -87,6 +88,23 @@ void appendStatusNodes( DOMNode* out,
                         const char* extendedCode = NULL,
                         const char* uri = NULL );
 
+/**
+ * Writes status_code and status_message elements, and the optional
+ * ones, like appendStatusNodes does.
+ * @param writer Where to write the elements, in the current element.
+ * @param code String with the code of the status.
+ * @param message String with the message of the status.
+ * @param extendedCode String with the extended code of the status,
+ *                     default NULL and not written if so.
+ * @param uri String with the status URI, default NULL and not 
+ *            written if so.
+ */
+void writeStatusNodes( XMLStreamWriter& writer,
+                       const char* const code,
+                       const char* const message,
+                       const char* extendedCode = NULL,
+                       const char* uri = NULL );
+
 /**
  * Appends a server list to out.
  *
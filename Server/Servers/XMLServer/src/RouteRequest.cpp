@@ -31,6 +31,8 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include "RouteID.h"
 #include "SearchReplyPacket.h"
 #include "RoutePacket.h"
+#include "ServerSubRouteVector.h"
+#include "SubRoute.h"
 #include "RequestUserData.h"
 #include "StringConversion.h"
 #include "XMLAuthData.h"
@@ -697,6 +699,7 @@ XMLParserThread::xmlParseRouteRequest( DOMNode* cur,
    bool routeItems = true;
    bool abbreviateRouteNames = true;
    bool routeLandmarks = false;
+   uint32 routeAlternatives = 0;
    uint32 routeOverviewImageWidth = 100;
    uint32 routeOverviewImageHeight = 100;
    uint32 routeTurnImageWidth = 100;
@@ -778,6 +781,7 @@ XMLParserThread::xmlParseRouteRequest( DOMNode* cur,
                   routeItems,
                   abbreviateRouteNames,
                   routeLandmarks,
+                  routeAlternatives,
                   routeOverviewImageWidth,
                   routeOverviewImageHeight,
                   routeTurnImageWidth,
@@ -840,6 +844,7 @@ XMLParserThread::xmlParseRouteRequest( DOMNode* cur,
                                   routeItems,
                                   abbreviateRouteNames,
                                   routeLandmarks,
+                                  routeAlternatives,
                                   routeOverviewImageWidth,
                                   routeOverviewImageHeight,
                                   routeTurnImageWidth,
@@ -903,6 +908,7 @@ XMLParserThread::xmlParseRouteRequestRouteRequestHeader(
    bool& routeItems,
    bool& abbreviateRouteNames,
    bool& routeLandmarks,
+   uint32& routeAlternatives,
    uint32& routeOverviewImageWidth,
    uint32& routeOverviewImageHeight,
    uint32& routeTurnImageWidth,
@@ -955,6 +961,7 @@ XMLParserThread::xmlParseRouteRequestRouteRequestHeader(
                      routeItems,
                      abbreviateRouteNames,
                      routeLandmarks,
+                     routeAlternatives,
                      routeOverviewImageWidth,
                      routeOverviewImageHeight,
                      routeTurnImageWidth,
@@ -1012,6 +1019,7 @@ XMLParserThread::xmlHandleRouteRequest(
    bool routeItems,
    bool abbreviateRouteNames,
    bool routeLandmarks,
+   uint32 routeAlternatives,
    uint32 routeOverviewImageWidth,
    uint32 routeOverviewImageHeight,
    uint32 routeTurnImageWidth,
@@ -1190,6 +1198,7 @@ XMLParserThread::xmlHandleRouteRequest(
                             routeLandmarks,
                             avoidtollroad,
                             avoidhighway );
+   req->setNbrAlternatives( routeAlternatives );
    
    req->setCompareDisturbanceRoute(routeCostC != 0);
 
@@ -1517,6 +1526,29 @@ XMLParserThread::xmlHandleRouteRequest(
                                    routeReplyHeaderIndentLevel, indent );
          }
 
+         // route_alternative elements, the alternatives are after the
+         // best route.
+         ServerSubRouteVectorVector* srvv = req->getRoute();
+         for ( uint32 i = 1 ; srvv != NULL && i < srvv->size() ; ++i ) {
+            const ServerSubRouteVector* srv = (*srvv)[ i ];
+            if ( srv->empty() || srv->back()->getAlternative() == 0 ) {
+               continue;
+            }
+            if ( indent ) {
+               route_reply_header->appendChild( reply->createTextNode( 
+                  Xroute_reply_header_indentStr.XMLStr() ) );
+            }
+            DOMElement* route_alternative = reply->createElement( 
+               X( "route_alternative" ) );
+            sprintf( ctmp, "%u", srv->getTotalDistanceCm() / 100 );
+            route_alternative->setAttribute( X( "total_distance_nbr" ),
+                                             X( ctmp ) );
+            sprintf( ctmp, "%u", srv->getTotalTimeSec( false ) );
+            route_alternative->setAttribute( X( "total_time_nbr" ),
+                                             X( ctmp ) );
+            route_reply_header->appendChild( route_alternative );
+         }
+
          if ( indent ) {
             // Newline and indent before end route_reply_header tag
             route_reply_header->appendChild( 
@@ -1795,6 +1827,7 @@ XMLParserThread::xmlParseRouteRequestRouteRequestHeaderRoutePreferences(
    bool& routeItems,
    bool& abbreviateRouteNames,
    bool& routeLandmarks,
+   uint32& routeAlternatives,
    uint32& routeOverviewImageWidth,
    uint32& routeOverviewImageHeight,
    uint32& routeTurnImageWidth,
@@ -1848,6 +1881,20 @@ XMLParserThread::xmlParseRouteRequestRouteRequestHeaderRoutePreferences(
                                      "route_landmarks" ) ) 
       {
          routeLandmarks = StringUtility::checkBoolean( tmpStr );
+      } else if ( XMLString::equals( attribute->getNodeName(),
+                                     "route_alternatives" ) ) 
+      {
+         char* tmpPtr = NULL;
+         uint32 tmp = strtoul( tmpStr, &tmpPtr, 10 );
+         if ( tmpPtr != tmpStr ) {
+            routeAlternatives = tmp;
+         } else {
+            mc2log << warn << "XMLParserThread::"
+                   << "xmlParseRouteRequestRouteRequestHeader"
+                   << "RoutePreferences "
+                   << "route_alternatives not number"
+                   << "   value " << tmpStr << endl;
+         }
       } else if ( XMLString::equals( attribute->getNodeName(),
                                      "route_measurment_system" ) ) 
       {
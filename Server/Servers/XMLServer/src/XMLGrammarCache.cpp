@@ -0,0 +1,156 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "XMLGrammarCache.h"
+
+#ifdef USE_XML
+
+#include "XMLParserErrorReporter.h"
+#include "XMLParserEntityResolver.h"
+
+#include <framework/MemBufInputSource.hpp>
+#include <sax2/XMLReaderFactory.hpp>
+#include <internal/XMLGrammarPoolImpl.hpp>
+#include <util/PlatformUtils.hpp>
+#include <sax/SAXParseException.hpp>
+
+namespace {
+
+/// Sets the options used by all the parsers.
+void setupParser( XercesDOMParser* parser ) {
+   parser->setValidationScheme( XercesDOMParser::Val_Auto );
+   parser->setErrorHandler( new XMLParserErrorReporter() );
+   parser->setIncludeIgnorableWhitespace( false );
+   parser->setEntityResolver( new XMLParserEntityResolver() );
+}
+
+}
+
+XMLGrammarCache::XMLGrammarCache()
+      : m_grammarPool( new XMLGrammarPoolImpl( 
+                          XMLPlatformUtils::fgMemoryManager ) ) 
+{
+   // Parse one document of each type to get the grammars into the pool
+   XercesDOMParser* parser = 
+      new XercesDOMParser( NULL, XMLPlatformUtils::fgMemoryManager,
+                           m_grammarPool );
+   setupParser( parser );
+   parser->cacheGrammarFromParse( true );
+
+   bool ok = true;
+   const char* xmlReqStr = 
+      "<?xml version='1.0' encoding='ascii' ?>\r\n"
+      "<!DOCTYPE isab-mc2 SYSTEM 'isab-mc2.dtd'>\r\n"
+      "<isab-mc2>\r\n"
+      "<auth><auth_user></auth_user><auth_passwd></auth_passwd></auth>\r\n"
+      "<user_login_request transaction_id='a'>"
+      "<user_name></user_name><user_password></user_password>"
+      "</user_login_request>\r\n"
+      " <!-- comment -->\r\n"
+      "</isab-mc2>\r\n";
+   MemBufInputSource xmlBuff( (byte*)xmlReqStr, 
+                              strlen( xmlReqStr ), "xmlInitRequest" );
+   const char* pubXmlReqStr =
+      "<?xml version='1.0' encoding='ascii' ?>\r\n"
+      "<!DOCTYPE request SYSTEM 'public.dtd'>\r\n"
+      "<request>\r\n"
+      "<auth login='mylogin' password='mypass'/>\r\n"
+      "<user_favorites_request transaction_id='U1'/>\r\n"
+      "</request>\r\n";
+   MemBufInputSource pubXmlBuff( (byte*)pubXmlReqStr, 
+                                 strlen( pubXmlReqStr ), 
+                                 "pubXmlInitRequest" );
+   try {
+      parser->parse( xmlBuff );
+      parser->parse( pubXmlBuff );
+   } catch ( const XMLException& e ) {
+      mc2log << error 
+             << "XMLGrammarCache::XMLGrammarCache an XMLerror occured "
+             << "during parsing of initialize request: "
+             << e.getMessage() << " line " 
+             << e.getSrcLine() << endl;
+      ok = false;
+   } catch( const SAXParseException& e) {
+      mc2log << error
+             << "XMLGrammarCache::XMLGrammarCache an SAXerror occured "
+             << "during parsing of initialize request: "
+             << e.getMessage() << ", "
+             << "line " << e.getLineNumber() << ", column " 
+             << e.getColumnNumber() << endl;
+      ok = false;
+   }
+   deleteParser( parser );
+
+   if ( !ok ) {
+      mc2log << fatal << "XMLGrammarCache::XMLGrammarCache "
+             << "initialization of xml grammars failed, quiting." << endl;
+      exit( 1 );
+   }
+
+   // No more grammars, from now on the pool is shared by all threads
+   m_grammarPool->lockPool();
+}
+
+XMLGrammarCache::~XMLGrammarCache() {
+   delete m_grammarPool;
+}
+
+XercesDOMParser*
+XMLGrammarCache::createParser() const {
+   XercesDOMParser* parser = 
+      new XercesDOMParser( NULL, XMLPlatformUtils::fgMemoryManager,
+                           m_grammarPool );
+   setupParser( parser );
+   parser->cacheGrammarFromParse( false );
+   parser->useCachedGrammarInParse( true );
+   return parser;
+}
+
+void
+XMLGrammarCache::deleteParser( XercesDOMParser* parser ) {
+   if ( parser == NULL ) {
+      return;
+   }
+   delete parser->getErrorHandler();
+   delete parser->getEntityResolver();
+   delete parser;
+}
+
+SAX2XMLReader*
+XMLGrammarCache::createReader() const {
+   SAX2XMLReader* reader = 
+      XMLReaderFactory::createXMLReader( XMLPlatformUtils::fgMemoryManager,
+                                         m_grammarPool );
+   // Same names and validation as the DOM parsers, Val_Auto
+   reader->setFeature( XMLUni::fgSAX2CoreNameSpaces, false );
+   reader->setFeature( XMLUni::fgSAX2CoreValidation, true );
+   reader->setFeature( XMLUni::fgXercesDynamic, true );
+   reader->setFeature( XMLUni::fgXercesCacheGrammarFromParse, false );
+   reader->setFeature( XMLUni::fgXercesUseCachedGrammarInParse, true );
+   reader->setErrorHandler( new XMLParserErrorReporter() );
+   reader->setEntityResolver( new XMLParserEntityResolver() );
+   return reader;
+}
+
+void
+XMLGrammarCache::deleteReader( SAX2XMLReader* reader ) {
+   if ( reader == NULL ) {
+      return;
+   }
+   delete reader->getErrorHandler();
+   delete reader->getEntityResolver();
+   delete reader;
+}
+
+#endif // USE_XML
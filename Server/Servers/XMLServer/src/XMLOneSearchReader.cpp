@@ -0,0 +1,360 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "XMLOneSearchReader.h"
+
+#ifdef USE_XML
+
+#include "XMLUtility.h"
+#include "XMLTool.h"
+#include "StringConvert.h"
+#include "STLStringUtility.h"
+#include "SearchTypes.h"
+#include "LangTypes.h"
+
+#include <boost/lexical_cast.hpp>
+
+XMLOneSearchReader::XMLOneSearchReader():
+   m_impl( DOMImplementationRegistry::getDOMImplementation( X( "Core" ) ) ),
+   m_authDocument( NULL ),
+   m_authCurrent( NULL ),
+   m_supported( true ),
+   m_rootEnded( false ),
+   m_nbrRequests( 0 ),
+   m_hasPosition( false ),
+   m_positionSystem( XMLCommonEntities::MC2 )
+{
+   m_authDocument = m_impl->createDocument( NULL, X( "isab-mc2" ), NULL );
+}
+
+XMLOneSearchReader::~XMLOneSearchReader() {
+   m_authDocument->release();
+}
+
+bool
+XMLOneSearchReader::isComplete() const {
+   return m_supported && m_rootEnded && m_nbrRequests == 1;
+}
+
+void
+XMLOneSearchReader::startElement( const XMLCh* const uri,
+                                  const XMLCh* const localname,
+                                  const XMLCh* const qname,
+                                  const Attributes& attrs ) {
+   MC2String name = XMLUtility::transcodefrom( qname );
+   if ( ! m_supported ) {
+      m_path.push_back( name );
+      return;
+   }
+
+   if ( m_authCurrent != NULL ||
+        ( m_path.size() == 1 && name == "auth" ) ) {
+      // Inside auth, add to its tree
+      DOMElement* element = m_authDocument->createElement( qname );
+      for ( uint32 i = 0; i < attrs.getLength(); ++i ) {
+         element->setAttribute( attrs.getQName( i ), attrs.getValue( i ) );
+      }
+      if ( m_authCurrent != NULL ) {
+         m_authCurrent->appendChild( element );
+      } else {
+         m_authDocument->getDocumentElement()->appendChild( element );
+      }
+      m_authCurrent = element;
+   } else if ( m_path.empty() ) {
+      m_supported = name == "isab-mc2";
+   } else if ( m_path.size() == 1 ) {
+      if ( name == "one_search_request" && m_nbrRequests == 0 ) {
+         ++m_nbrRequests;
+         for ( uint32 i = 0; i < attrs.getLength(); ++i ) {
+            m_attributes[ XMLUtility::transcodefrom( attrs.getQName( i ) ) ] =
+               XMLUtility::transcodefrom( attrs.getValue( i ) );
+         }
+         const MC2String* transactionID = findAttrib( "transaction_id" );
+         if ( transactionID != NULL ) {
+            m_transactionID = *transactionID;
+         }
+      } else {
+         // Some other request, or more than one, for the DOM parser
+         m_supported = false;
+      }
+   } else if ( m_path.size() == 2 && name == "position_item" ) {
+      m_hasPosition = true;
+      const XMLCh* system = attrs.getValue( X( "position_system" ) );
+      if ( system != NULL ) {
+         m_positionItemSystem = XMLUtility::transcodefrom( system );
+      }
+   }
+
+   m_path.push_back( name );
+   m_text.clear();
+}
+
+void
+XMLOneSearchReader::endElement( const XMLCh* const uri,
+                                const XMLCh* const localname,
+                                const XMLCh* const qname ) {
+   m_path.pop_back();
+   if ( ! m_supported ) {
+      return;
+   }
+
+   if ( m_authCurrent != NULL ) {
+      if ( m_authCurrent->getParentNode() ==
+           m_authDocument->getDocumentElement() ) {
+         // The auth element is complete
+         m_authCurrent = NULL;
+      } else {
+         m_authCurrent = static_cast< DOMElement* >(
+            m_authCurrent->getParentNode() );
+      }
+   } else if ( m_path.empty() ) {
+      m_rootEnded = true;
+   } else if ( m_path.size() == 1 ) {
+      // The one_search_request is complete
+      readParams();
+   } else if ( m_path.size() == 2 ) {
+      // Child of one_search_request, the first one counts like findNode
+      m_childTexts.insert( make_pair( XMLUtility::transcodefrom( qname ),
+                                      XMLUtility::transcodefrom(
+                                         m_text.c_str() ) ) );
+   } else if ( m_path.size() == 3 ) {
+      MC2String name = XMLUtility::transcodefrom( qname );
+      if ( m_path[ 2 ] == "category_list" && name == "category_id" ) {
+         m_categoryIDs.push_back( XMLUtility::
+                                  transcodefrom( m_text.c_str() ) );
+      } else if ( m_path[ 2 ] == "position_item" ) {
+         m_positionTexts.insert( make_pair( name, XMLUtility::
+                                            transcodefrom( m_text.c_str() ) ) );
+      }
+   }
+   m_text.clear();
+}
+
+void
+XMLOneSearchReader::characters( const XMLCh* const chars,
+                                const unsigned int length ) {
+   if ( ! m_supported ) {
+      return;
+   }
+   if ( m_authCurrent == NULL ) {
+      m_text.append( chars, length );
+      return;
+   }
+
+   // Merge adjacent text like the DOM parser does
+   basic_string< XMLCh > text( chars, length );
+   DOMNode* last = m_authCurrent->getLastChild();
+   if ( last != NULL && last->getNodeType() == DOMNode::TEXT_NODE ) {
+      static_cast< DOMText* >( last )->appendData( text.c_str() );
+   } else {
+      m_authCurrent->appendChild(
+         m_authDocument->createTextNode( text.c_str() ) );
+   }
+}
+
+const MC2String*
+XMLOneSearchReader::findAttrib( const char* name ) const {
+   StringMap::const_iterator it = m_attributes.find( name );
+   if ( it == m_attributes.end() ) {
+      return NULL;
+   }
+   return &it->second;
+}
+
+const MC2String*
+XMLOneSearchReader::findChildText( const char* name ) const {
+   StringMap::const_iterator it = m_childTexts.find( name );
+   if ( it == m_childTexts.end() ) {
+      return NULL;
+   }
+   return &it->second;
+}
+
+template < typename T >
+void
+XMLOneSearchReader::getAttrib( T& dest, const char* name ) const {
+   const MC2String* value = findAttrib( name );
+   if ( value == NULL ) {
+      throw XMLTool::Exception( "No such attribute", name );
+   }
+   try {
+      StringConvert::assign<T>( dest, *value );
+   } catch ( const StringConvert::ConvertException& e ) {
+      throw XMLTool::Exception( e.what(), name );
+   }
+}
+
+template < typename T >
+void
+XMLOneSearchReader::getAttrib( T& dest, const char* name,
+                               const T& defaultValue ) const {
+   try {
+      getAttrib<T>( dest, name );
+   } catch ( const XMLTool::Exception& e ) {
+      dest = defaultValue;
+   }
+}
+
+template < typename T >
+void
+XMLOneSearchReader::getChildValue( T& dest, const char* name ) const {
+   const MC2String* value = findChildText( name );
+   if ( value == NULL ) {
+      throw XMLTool::Exception( "No such node", name );
+   }
+   try {
+      StringConvert::assign<T>( dest, *value );
+   } catch ( const StringConvert::ConvertException& e ) {
+      throw XMLTool::Exception( e.what(), name );
+   }
+}
+
+void
+XMLOneSearchReader::readParams() {
+   try {
+      setParams();
+   } catch ( const XMLTool::Exception& e ) {
+      // ::error as DefaultHandler::error hides the log level
+      mc2log << ::error << "[OneSearchRequest]  " << e.what() << endl;
+      m_error = e.what();
+   } catch ( const MC2Exception& e ) {
+      mc2log << info << "[OneSearchRequest]  " << e.what() << endl;
+      m_error = e.what();
+   }
+}
+
+void
+XMLOneSearchReader::setParams() {
+   // This is one_search_request...
+   m_params.m_oneResultList = true;
+
+   // must have these
+   getAttrib( m_params.m_maxHits, "max_number_matches" );
+   getAttrib( m_params.m_language, "language" );
+   getAttrib( m_params.m_round, "round" );
+
+   MC2String strSorting;
+   getAttrib( strSorting, "sorting" );
+   if ( STLStringUtility::strtoul( strSorting ) == 1 ) {
+      m_params.m_sorting = SearchTypes::AlphaSort;
+   } else {
+      m_params.m_sorting = SearchTypes::DistanceSort;
+   }
+
+   // Set start and end index from max hit
+   m_params.m_startIndex = 0;
+   m_params.m_endIndex = m_params.m_maxHits - 1;
+
+   // these attributes are optional
+   getAttrib( m_params.m_includeInfoItem, "include_detail_fields", true );
+   if ( m_params.m_includeInfoItem ) {
+      m_params.m_itemInfoFilter = ItemInfoEnums::OneSearch_All;
+   } else {
+      m_params.m_itemInfoFilter = ItemInfoEnums::None;
+   }
+
+   MC2String positionSystemString( "MC2" );
+   getAttrib( positionSystemString, "position_system", positionSystemString );
+   m_positionSystem = XMLCommonEntities::
+      coordinateFormatFromString( positionSystemString.c_str(),
+                                  XMLCommonEntities::MC2 );
+
+   MC2String searchType( "all" );
+   getAttrib( searchType, "search_type", searchType );
+   if ( searchType == "address" && m_params.m_round == 0 ) {
+      // We only want to search for address
+      m_params.m_heading = 1; // Addresses heading
+   }
+
+   const MC2String* query = findChildText( "search_match_query" );
+   if ( query != NULL ) {
+      m_params.m_what = *query;
+   }
+
+   for ( uint32 i = 0; i < m_categoryIDs.size(); ++i ) {
+      try {
+         m_params.m_categoryIDs.push_back(
+            boost::lexical_cast< CategoryTreeUtils::CategoryID >(
+               m_categoryIDs[ i ] ) );
+      } catch ( const boost::bad_lexical_cast& ) {
+         mc2dbg << "[XMLCompactSearchRequest] "
+                << "invalid category id: " << m_categoryIDs[ i ] << endl;
+      }
+   }
+
+   if ( query == NULL && m_params.m_categoryIDs.empty() ) {
+      // No search data provided.
+      throw MC2Exception(
+         "Nothing to search for. Please provide a search_match_query or a category_list." );
+   }
+
+   if ( m_hasPosition ) {
+      readPosition();
+      try {
+         getChildValue( m_params.m_distance, "distance" );
+      } catch ( const XMLTool::Exception& e ) {
+         m_params.m_distance = 100000; // 100km
+      }
+   } else {
+      // Position not set. Get query_location and top_region_id instead
+      getChildValue( m_params.m_where, "query_location" );
+      getChildValue( m_params.m_topRegionID, "top_region_id" );
+   }
+}
+
+void
+XMLOneSearchReader::readPosition() {
+   XMLCommonEntities::coordinateType coordinateSystem =
+      XMLCommonEntities::WGS84;
+   if ( ! m_positionItemSystem.empty() ) {
+      coordinateSystem = XMLCommonEntities::
+         coordinateFormatFromString( m_positionItemSystem.c_str(),
+                                     XMLCommonEntities::WGS84 );
+   }
+
+   CompactSearch::Location location;
+   location.m_angle = MAX_UINT16; // Not set
+
+   // Same codes and messages as XMLCommonElements::getPositionItemData
+   StringMap::const_iterator it = m_positionTexts.find( "lat" );
+   if ( it != m_positionTexts.end() &&
+        ! XMLCommonEntities::coordinateFromString(
+           it->second.c_str(), location.m_coord.lat, coordinateSystem ) ) {
+      throw XMLTool::Exception( "-1:Problem with lat-coordinate of"
+                                " position_item.", "position_item" );
+   }
+   it = m_positionTexts.find( "lon" );
+   if ( it != m_positionTexts.end() &&
+        ! XMLCommonEntities::coordinateFromString(
+           it->second.c_str(), location.m_coord.lon, coordinateSystem ) ) {
+      throw XMLTool::Exception( "-1:Problem with lon-coordinate of"
+                                " position_item.", "position_item" );
+   }
+   it = m_positionTexts.find( "angle" );
+   if ( it != m_positionTexts.end() ) {
+      try {
+         StringConvert::assign( location.m_angle, it->second );
+      } catch ( const StringConvert::ConvertException& e ) {
+         throw XMLTool::Exception( MC2String( "-1:" ) + e.what(),
+                                   "position_item" );
+      }
+      if ( location.m_angle > 360 ) {
+         throw XMLTool::Exception( "-1:Angle of position item is out of"
+                                   " range.", "position_item" );
+      }
+   }
+
+   m_params.m_location = location;
+}
+
+#endif // USE_XML
@@ -36,8 +36,11 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include "XMLServerElements.h"
 #include "XMLSearchUtility.h"
 #include "XMLCategoryListNode.h"
+#include "XMLOneSearchReader.h"
+#include "XMLStreamWriter.h"
 
 using XMLServerUtility::appendStatusNodes;
+using XMLServerUtility::writeStatusNodes;
 
 namespace {
 SearchTypes::SearchSorting getSorting( MC2String& strSorting ) {
@@ -233,3 +236,64 @@ try {
                       "-1", e.what() );
    return true;
 }
+
+void
+XMLParserThread::writeOneSearchReply( const XMLOneSearchReader& request,
+                                      XMLStreamWriter& writer ) {
+   writer.startElement( "one_search_reply" );
+   if ( ! request.getTransactionID().empty() ) {
+      writer.addAttribute( "transaction_id", request.getTransactionID() );
+   }
+   // The elements to end if the search fails while writing the results
+   const uint32 depth = writer.getDepth();
+
+   try {
+      const CompactSearch& params = request.getParams();
+      MC2String errorCode;
+      MC2String errorMessage;
+      MC2String errorURI;
+      if ( ! request.getError().empty() ) {
+         // Logged by the reader
+         writeStatusNodes( writer, "-1", request.getError().c_str() );
+      } else if ( ! checkAllowedToSearch( params, errorCode, errorMessage,
+                                          errorURI ) ) {
+         writeStatusNodes( writer, errorCode.c_str(), errorMessage.c_str(),
+                           NULL/*extendedCode*/, errorURI.c_str() );
+      } else {
+         typedef STLUtility::AutoContainerMap< 
+            SearchParserHandler::SearchResults > SearchResults;
+
+         SearchResults results( getSearchHandler().compactSearch( params ) );
+
+         if ( results.empty() ) { 
+            mc2log << warn << "[OneSearchRequest]: no results!" << endl;
+         }
+
+         SearchResults::const_iterator resultIt = results.begin();
+         if ( resultIt != results.end() ) {
+            XMLSearchUtility::
+               writeSearchListElement( writer, 
+                                       resultIt->second->
+                                       getSearchResultRequest(),
+                                       params.m_maxHits, 
+                                       request.getPositionSystem(), 
+                                       params.m_language, this );
+         }
+      }
+   } catch ( const XMLServerErrorMsg& error ) {
+      writer.endElementsTo( depth );
+      writeStatusNodes( writer, error.getCode().c_str(), 
+                        error.getMsg().c_str(), 
+                        NULL/*extendedCode*/, error.getURI().c_str() );
+   } catch ( const XMLTool::Exception& e ) {
+      mc2log << error << "[OneSearchRequest]  " << e.what() << endl;
+      writer.endElementsTo( depth );
+      writeStatusNodes( writer, "-1", e.what() );
+   } catch ( const MC2Exception& e ) {
+      mc2log << info << "[OneSearchRequest]  " << e.what() << endl;
+      writer.endElementsTo( depth );
+      writeStatusNodes( writer, "-1", e.what() );
+   }
+
+   writer.endElement();
+}
@@ -12,11 +12,11 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 */
 
 #include "XMLParserThread.h"
-#include "HttpParserThreadGroup.h"
+#include "XMLParserThreadGroup.h"
+#include "XMLGrammarCache.h"
 #include "StringUtility.h"
 #include "SinglePacketRequest.h"
 #include "UserData.h"
-#include "XMLParserEntityResolver.h"
 #include "HttpHeader.h"
 #include "HttpBody.h"
 #include "SearchReplyPacket.h"
@@ -35,12 +35,15 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include "XMLServerUtility.h"
 #include "XMLSearchUtility.h"
 #include "XMLServerElements.h"
+#include "XMLOneSearchReader.h"
+#include "XMLStreamWriter.h"
 #include "InfoTypeConverter.h"
 #include "HttpHeaderLines.h"
 #include "XMLTool.h"
 #include "XSData.h"
 #include "NetUtility.h"
 
+#include <framework/XMLPScanToken.hpp>
 
 #include <sstream>
 #include <iomanip>
@@ -170,6 +173,50 @@ const char* getReplyDocumentName( const char* requestName ) {
    }
 }
 
+/**
+ * Resets the document pool of a parser when going out of scope, so no
+ * request document is kept in the parser whatever way the request ends.
+ */
+class DocumentPoolResetter {
+public:
+   explicit DocumentPoolResetter( XercesDOMParser* parser ) 
+         : m_parser( parser ) {}
+   ~DocumentPoolResetter() {
+      m_parser->resetDocumentPool();
+   }
+private:
+   XercesDOMParser* m_parser;
+};
+
+/**
+ * Returns the encoding in the xml declaration of a document, in lower
+ * case, or utf-8 if it has none as that is the default in XML.
+ *
+ * @param body The document.
+ * @return The declared encoding of the document.
+ */
+MC2String getDeclaredEncoding( const char* body ) {
+   const char* declEnd = strstr( body, "?>" );
+   const char* encoding = strstr( body, "encoding" );
+   if ( declEnd == NULL || encoding == NULL || encoding > declEnd ) {
+      return "utf-8";
+   }
+   encoding += strlen( "encoding" );
+   while ( isspace( *encoding ) || *encoding == '=' ) {
+      ++encoding;
+   }
+   const char quote = *encoding;
+   if ( quote != '"' && quote != '\'' ) {
+      return "utf-8";
+   }
+   ++encoding;
+   const char* encodingEnd = strchr( encoding, quote );
+   if ( encodingEnd == NULL || encodingEnd > declEnd ) {
+      return "utf-8";
+   }
+   return StringUtility::copyLower( MC2String( encoding, encodingEnd ) );
+}
+
 }
 
 
@@ -183,7 +230,7 @@ bool equalVanillaMatch::operator()( const VanillaMatch* x,
 const MC2String XMLParserThread::ContentTypeStr = "Content-Type";
 
 
-XMLParserThread::XMLParserThread( HttpParserThreadGroup* group ) 
+XMLParserThread::XMLParserThread( XMLParserThreadGroup* group ) 
    : HttpParserThread( group ),
      m_infoTypes( new InfoTypeConverter() ) {
 
@@ -206,66 +253,10 @@ XMLParserThread::XMLParserThread( HttpParserThreadGroup* group )
    strcpy( m_serverName, serverName );
 
 #ifdef USE_XML
-   m_parser = new XercesDOMParser();
-   m_parser->setValidationScheme( XercesDOMParser::Val_Auto );
-   ErrorHandler* errReporter = new XMLParserErrorReporter();
-   m_parser->setErrorHandler( errReporter );
-//   m_parser->setToCreateXMLDeclTypeNode( true );
-   m_parser->setIncludeIgnorableWhitespace( false );
-   m_parser->cacheGrammarFromParse( true ); // Cache this
-   delete m_parser->getEntityResolver(); // Any old one
-   m_parser->setEntityResolver( new XMLParserEntityResolver() );
-
-   // Initialize with isab-mc2.dtd to be able to resuse grammar
-   bool ok = true;
-   const char* xmlReqStr = 
-      "<?xml version='1.0' encoding='ascii' ?>\r\n"
-      "<!DOCTYPE isab-mc2 SYSTEM 'isab-mc2.dtd'>\r\n"
-      "<isab-mc2>\r\n"
-      "<auth><auth_user></auth_user><auth_passwd></auth_passwd></auth>\r\n"
-      "<user_login_request transaction_id='a'>"
-      "<user_name></user_name><user_password></user_password>"
-      "</user_login_request>\r\n"
-      " <!-- comment -->\r\n"
-      "</isab-mc2>\r\n";
-   MemBufInputSource xmlBuff( (byte*)xmlReqStr, 
-                              strlen( xmlReqStr ), "xmlInitRequest" );
-   const char* pubXmlReqStr =
-      "<?xml version='1.0' encoding='ascii' ?>\r\n"
-      "<!DOCTYPE request SYSTEM 'public.dtd'>\r\n"
-      "<request>\r\n"
-      "<auth login='mylogin' password='mypass'/>\r\n"
-      "<user_favorites_request transaction_id='U1'/>\r\n"
-      "</request>\r\n";
-   MemBufInputSource pubXmlBuff( (byte*)pubXmlReqStr, 
-                                 strlen( pubXmlReqStr ), 
-                                 "pubXmlInitRequest" );
-   try {
-      m_parser->parse( xmlBuff );
-      m_parser->parse( pubXmlBuff );
-   } catch ( const XMLException& e ) {
-      mc2log << error 
-             << "XMLParserThread::XMLParserThread an XMLerror occured "
-             << "during parsing of initialize request: "
-             << e.getMessage() << " line " 
-             << e.getSrcLine() << endl;
-      ok = false;
-   } catch( const SAXParseException& e) {
-      mc2log << error
-             << "XMLParserThread::XMLParserThread an SAXerror occured "
-             << "during parsing of initialize request: "
-             << e.getMessage() << ", "
-             << "line " << e.getLineNumber() << ", column " 
-             << e.getColumnNumber() << endl;
-      ok = false;
-   }
-   if ( !ok ) {
-      mc2log << fatal << "XMLParserThread::XMLParserThread "
-             << "initialization of xml parser failed, quiting." << endl;
-      exit( 1 );
-   }
-   m_parser->cacheGrammarFromParse( false ); // Cache no more
-   m_parser->useCachedGrammarInParse( true ); // Use cached grammar
+   // Validates against the grammars parsed once by the group
+   m_grammarCache = group->getGrammarCache();
+   m_parser = m_grammarCache->createParser();
+   m_reader = m_grammarCache->createReader();
 #endif
 #if 0
    HttpParserThreadGroup* group2 = (HttpParserThreadGroup*)10;
@@ -282,9 +273,10 @@ XMLParserThread::~XMLParserThread() {
    delete [] m_serverName;
    delete m_authData;
 #ifdef USE_XML
-   delete m_parser->getErrorHandler();
-   delete m_parser->getEntityResolver();
-   delete m_parser;
+   XMLGrammarCache::deleteParser( m_parser );
+   XMLGrammarCache::deleteReader( m_reader );
+   // The parsers are gone, the cache may go too if they were the last users.
+   m_grammarCache.reset();
 #endif
 }
 
@@ -2019,9 +2011,15 @@ XMLParserThread::handleXMLHttpRequest( HttpHeader* inHead,
       return true;
    }
 
+   if ( handleStreamedRequest( inHead, inBody, outHead, outBody ) ) {
+      return true;
+   }
+
    // Make XML Document of request data
    MemBufInputSource xmlBuff( (byte*)inBody->getBody(), 
                               inBody->getBodyLength(), "xmlRequest" );
+   // Don't keep request in parser
+   DocumentPoolResetter resetter( m_parser );
 
       
    try {
@@ -2153,18 +2151,7 @@ XMLParserThread::handleXMLHttpRequest( HttpHeader* inHead,
       return true;
    }
    
-   // Set m_logname to users name
-   if ( m_user ) {
-      m_logname = m_user->getUser()->getLogonID();
-      if ( m_authData ) {
-         setClientSetting( m_authData->clientSetting );
-         setRequestData( m_authData );
-      }
-   } else {
-      m_logname = "";
-   }
-   setLogUserName( m_logname.c_str() );
-
+   setRequestUser();
 
    mc2dbg8 << "Auth ok " << endl;
    // Handle Requests in document
@@ -2248,56 +2235,10 @@ XMLParserThread::handleXMLHttpRequest( HttpHeader* inHead,
    outBody->setBody( &replyString );
 
    
-   if ( Properties::getUint32Property( "XML_SERVER_REPLY_DTD_CHECK", 0 ) ) {
-      MC2String requestName2;
-      uint32 linesAdded2;
-      HttpBody testBody( MC2String( outBody->getBody(), 
-                                    outBody->getBodyLength() ) );
-      checkAndFixHeader( &testBody, errStr, linesAdded2, requestName2 );
-   
-      // Check reply against dtd
-      MemBufInputSource xmlReplyBuff( (byte*)testBody.getBody(),
-                                      testBody.getBodyLength(), "xmlReply" );
-      try {
-         mc2dbg << "XMLParserThread::handleHttpRequest About to parse "
-                 << "reply (xerces)" << endl;
-         uint32 startProcessTime = TimeUtility::getCurrentMicroTime();
-         m_parser->parse( xmlReplyBuff );
-         uint32 stopProcessTime = TimeUtility::getCurrentMicroTime();
-         mc2dbg << "XMLParserThread::handleHttpRequest xml reply "
-                   "xerces parse time "
-                << (stopProcessTime - startProcessTime)/1000 << " ms" 
-                 << endl;
-         mc2dbg << "XMLParserThread::handleHttpRequest Done parsing "
-                 << "reply (xerces)" << endl;         
-      } catch ( const XMLException& e ) {
-         ostringstream x;
-         x << "An XMLerror occured during parsing of reply" << endl
-           << "   Message: "
-           << e.getMessage() << " line " 
-           << e.getSrcLine() << endl << ends;
-         mc2log << x;
-         outBody->addString( "<!--\n" );
-         outBody->addString( x.str() );
-         outBody->addString( "-->\n" );
-      } catch( const SAXParseException& e) {
-         ostringstream x;
-         x << "An SAXerror occured during parsing of reply" << endl
-           << "   Message: "
-           << e.getMessage() << ", "
-           << "line " << (int)e.getLineNumber() << ", column " 
-           << (int)e.getColumnNumber() << endl;
-         mc2log << x;
-         outBody->addString( "<!--\n" );
-         outBody->addString( x.str() );
-         outBody->addString( "-->\n" );         
-      }
-   }
+   checkReplyAgainstDTD( outBody );
 
    // Return memory for reply
    reply->release();
-   // Don't keep request in parser
-   m_parser->resetDocumentPool();
 
    releaseUserItem( m_user );
    clearUserItem();
@@ -2318,6 +2259,223 @@ XMLParserThread::handleXMLHttpRequest( HttpHeader* inHead,
 }
 
 
+bool
+XMLParserThread::handleStreamedRequest( HttpHeader* inHead, 
+                                        HttpBody* inBody,
+                                        HttpHeader* outHead, 
+                                        HttpBody* outBody )
+{
+   const char* body = inBody->getBody();
+   // Only try the documents that may be supported, others are only
+   // parsed once, by the DOM parser.
+   if ( strncmp( body, "<?xml", 5 ) != 0 || 
+        strstr( body, "one_search_request" ) == NULL ) {
+      return false;
+   }
+
+   MemBufInputSource xmlBuff( (byte*)body, inBody->getBodyLength(), 
+                              "xmlRequest" );
+   XMLOneSearchReader request;
+   m_reader->setContentHandler( &request );
+   bool parsed = true;
+   uint32 startProcessTime = TimeUtility::getCurrentMicroTime();
+   try {
+      XMLPScanToken token;
+      bool more = m_reader->parseFirst( xmlBuff, token );
+      while ( more && request.isSupported() ) {
+         more = m_reader->parseNext( token );
+      }
+      if ( more ) {
+         // Stopped at something not read here
+         m_reader->parseReset( token );
+      }
+   } catch ( const XMLException& e ) {
+      // The DOM parser reports it
+      parsed = false;
+   } catch ( const SAXParseException& e ) {
+      // The DOM parser reports it
+      parsed = false;
+   }
+   m_reader->setContentHandler( NULL );
+   uint32 stopProcessTime = TimeUtility::getCurrentMicroTime();
+
+   if ( ! parsed || ! request.isComplete() ) {
+      mc2dbg2 << "XMLParserThread::handleStreamedRequest not streamed, "
+              << "parsed " << parsed << " supported " 
+              << request.isSupported() << endl;
+      return false;
+   }
+   mc2dbg2 << "XMLParserThread::handleStreamedRequest xml request"
+              " xerces parse time "
+           << (stopProcessTime - startProcessTime)/1000 << " ms" << endl;
+
+   MC2String charSet = inHead->getAcceptCharset();
+   bool indent = true; // If reply should contain indentation
+   bool development = true; // If to be verbose, like loging reply
+
+   // If no Accept-Charset then use charset of incoming xml
+   if ( inHead->getHeaderValue( HttpHeaderLines::ACCEPT_CHARSET ) == NULL ) {
+      charSet = ::getDeclaredEncoding( body );
+      mc2log << info << "XMLParserThread::handleHttpRequest using "
+             << "charSet from request document " << charSet << endl;
+   }
+
+   // Only written to if the user is unauthorized
+   DOMDocument* reply = ::makeDocument( "isab-mc2", charSet.c_str() );
+   outBody->setCharSet( charSet.c_str() );
+
+   if ( !checkAuthorization( request.getAuthDocument(), reply, 
+                             indent, development, *inHead ) ) { 
+      mc2dbg8 << "User unauthorized" << endl;
+      MC2String replyString = 
+         XMLTreeFormatter::makeStringOfTree( reply, charSet.c_str() );
+      outHead->addHeaderLine( &ContentTypeStr, 
+                              new MC2String( "text/xml" ) );
+      outBody->setBody( &replyString );      
+      releaseUserItem( m_user );
+      clearUserItem();
+      m_allowedRequests.clear();
+      reply->release();
+      return true;
+   }
+   reply->release();
+
+   setRequestUser();
+
+   mc2dbg8 << "Auth ok " << endl;
+   using XMLServerUtility::printWithLineNumbers; 
+   MC2String replyString;
+   startProcessTime = TimeUtility::getCurrentMicroTime();
+   try {
+      XMLStreamWriter writer( replyString, charSet.c_str(), indent );
+      writer.writeDeclaration( "isab-mc2" );
+      writer.startElement( "isab-mc2" );
+      if ( m_allowedRequests.empty() || 
+           m_allowedRequests.find( "one_search_request" ) != 
+           m_allowedRequests.end() ) {
+         REQNAME( "ONE_SEARCH" );
+         writeOneSearchReply( request, writer );
+      } else {
+         mc2log << warn << "XMLParserThread::handleStreamedRequest "
+                << "unallowed element in isab-mc2 element: "
+                << "one_search_request skipping it" << endl;
+      }
+      writer.endElement();
+   } catch ( const XMLException& e ) {
+      // Like XMLTreeFormatter, an empty reply
+      mc2log << error << "XMLParserThread::handleStreamedRequest "
+             << "XMLException " << e.getMessage() << endl;
+      replyString.clear();
+   } catch ( const DOMException& e ) {
+      char* error = XMLUtility::transcodefromucs( e.msg );
+      mc2log << warn << "An error occured during creating reply" 
+             << "   Message: " << error << endl;
+      ::makeErrorReply( outBody, outHead, *inHead,
+                        "-1", error, indent, "isab-mc2" );
+      delete [] error;
+      releaseUserItem( m_user );
+      clearUserItem();
+      m_authData->reset();
+      m_allowedRequests.clear();
+      return true;
+   }
+   stopProcessTime = TimeUtility::getCurrentMicroTime();
+   mc2dbg2 << "XMLParserThread::handleStreamedRequest write xml reply"
+              " time "
+           << (stopProcessTime - startProcessTime)/1000 << " ms" 
+           << ", size " << replyString.size() << endl;
+
+   if ( development ) {
+      mc2log << info << "XMLParserThread::run ReplyTree:"
+             << endl;
+      printWithLineNumbers( mc2log, replyString.c_str() );
+   }
+
+   outHead->addHeaderLine( &ContentTypeStr, new MC2String( "text/xml" ) );
+   outBody->setBody( &replyString );
+
+   checkReplyAgainstDTD( outBody );
+
+   releaseUserItem( m_user );
+   clearUserItem();
+   m_authData->reset();
+   m_allowedRequests.clear();
+
+   return true;
+}
+
+
+void
+XMLParserThread::setRequestUser() {
+   // Set m_logname to users name
+   if ( m_user ) {
+      m_logname = m_user->getUser()->getLogonID();
+      if ( m_authData ) {
+         setClientSetting( m_authData->clientSetting );
+         setRequestData( m_authData );
+      }
+   } else {
+      m_logname = "";
+   }
+   setLogUserName( m_logname.c_str() );
+}
+
+
+void
+XMLParserThread::checkReplyAgainstDTD( HttpBody* outBody ) {
+   if ( ! Properties::getUint32Property( "XML_SERVER_REPLY_DTD_CHECK", 0 ) ) {
+      return;
+   }
+
+   MC2String requestName2;
+   uint32 linesAdded2;
+   HttpBody testBody( MC2String( outBody->getBody(), 
+                                 outBody->getBodyLength() ) );
+   MC2String errStr;
+   checkAndFixHeader( &testBody, errStr, linesAdded2, requestName2 );
+
+   // Check reply against dtd
+   MemBufInputSource xmlReplyBuff( (byte*)testBody.getBody(),
+                                   testBody.getBodyLength(), "xmlReply" );
+   // Don't keep reply in parser
+   DocumentPoolResetter resetter( m_parser );
+   try {
+      mc2dbg << "XMLParserThread::handleHttpRequest About to parse "
+              << "reply (xerces)" << endl;
+      uint32 startProcessTime = TimeUtility::getCurrentMicroTime();
+      m_parser->parse( xmlReplyBuff );
+      uint32 stopProcessTime = TimeUtility::getCurrentMicroTime();
+      mc2dbg << "XMLParserThread::handleHttpRequest xml reply "
+                "xerces parse time "
+             << (stopProcessTime - startProcessTime)/1000 << " ms" 
+              << endl;
+      mc2dbg << "XMLParserThread::handleHttpRequest Done parsing "
+              << "reply (xerces)" << endl;         
+   } catch ( const XMLException& e ) {
+      ostringstream x;
+      x << "An XMLerror occured during parsing of reply" << endl
+        << "   Message: "
+        << e.getMessage() << " line " 
+        << e.getSrcLine() << endl << ends;
+      mc2log << x;
+      outBody->addString( "<!--\n" );
+      outBody->addString( x.str() );
+      outBody->addString( "-->\n" );
+   } catch( const SAXParseException& e) {
+      ostringstream x;
+      x << "An SAXerror occured during parsing of reply" << endl
+        << "   Message: "
+        << e.getMessage() << ", "
+        << "line " << (int)e.getLineNumber() << ", column " 
+        << (int)e.getColumnNumber() << endl;
+      mc2log << x;
+      outBody->addString( "<!--\n" );
+      outBody->addString( x.str() );
+      outBody->addString( "-->\n" );         
+   }
+}
+
+
 bool 
 XMLParserThread::checkPublicAuth( 
    const DOMDocument* doc, DOMDocument* reply,
@@ -2826,11 +2984,10 @@ void XMLParserThread::logUserAccepted( const MC2String& prefix ) {
 
 
 bool
-XMLParserThread::checkAllowedToSearch( DOMNode* root,
-                                       DOMDocument* reply,
-                                       CompactSearch& params,
-                                       bool indent
-                                       ) {
+XMLParserThread::checkAllowedToSearch( const CompactSearch& params,
+                                       MC2String& errorCode,
+                                       MC2String& errorMessage,
+                                       MC2String& errorURI ) {
    PurchaseOptions purchaseOptions( m_authData->clientType );
    set< MC2String > checkedServiceIDs;
    if ( ! checkService( getClientSetting(), getHttpInterfaceRequest(),
@@ -2844,6 +3001,8 @@ XMLParserThread::checkAllowedToSearch( DOMNode* root,
       // User not allowed to search, present purchase options
       using namespace PurchaseOption;
       mc2log << warn << "[XMLParserThread]: checkService failed.";
+      errorCode = "-1";
+      errorURI.clear();
       if ( purchaseOptions.getReasonCode() == NEEDS_TO_BUY_APP_STORE_ADDON ) {
          // User not allowed to route, present purchase options
          // return the uri to the client so it can send it to the web server
@@ -2851,33 +3010,44 @@ XMLParserThread::checkAllowedToSearch( DOMNode* root,
          //        java-clients.
          mc2log << " User has no accsess for searching."
                 << " Returning purchase options. ";
-         appendStatusNodes( root, reply, 1, false, "-1", 
-                            "Searching not allowed.",
-                            NULL, purchaseOptions.getURL().c_str() );
+         errorMessage = "Searching not allowed.";
+         errorURI = purchaseOptions.getURL();
       } else {
          mc2log << " General error.";
          if ( purchaseOptions.getReasonCode() == SERVICE_NOT_FOUND ) {
             // Service id not possible to purchase
             mc2log << " Service id not possible to purchase";
             
-            MC2String noServiceIdURL( "http://show_msg/?txt=" );
-            noServiceIdURL += StringUtility::URLEncode(
-               StringTable::getString( StringTable::WF_NO_BILL_AREA,
-                                       m_authData->clientLang ) );
-            
-            appendStatusNodes( root, reply, 1, false, "-1",
-                               StringTable::
-                               getString( StringTable::WF_NO_BILL_AREA,
-                                          m_authData->clientLang ),
-                               NULL,
-                               noServiceIdURL.c_str() );
+            errorMessage = StringTable::getString( 
+               StringTable::WF_NO_BILL_AREA, m_authData->clientLang );
+            errorURI = "http://show_msg/?txt=";
+            errorURI += StringUtility::URLEncode( errorMessage );
          } else {
-            appendStatusNodes( root, reply, 1, false, "-1",
-                               "General error." );
+            errorMessage = "General error.";
          }
       }
       mc2log << endl;
       
+      return false;
+   }
+   
+   return true;
+}
+
+
+bool
+XMLParserThread::checkAllowedToSearch( DOMNode* root,
+                                       DOMDocument* reply,
+                                       CompactSearch& params,
+                                       bool indent
+                                       ) {
+   MC2String errorCode;
+   MC2String errorMessage;
+   MC2String errorURI;
+   if ( ! checkAllowedToSearch( params, errorCode, errorMessage, 
+                                errorURI ) ) {
+      appendStatusNodes( root, reply, 1, false, errorCode.c_str(), 
+                         errorMessage.c_str(), NULL, errorURI.c_str() );
       if ( indent ) {
          XMLUtility::indentPiece( *root, 1 );
       }
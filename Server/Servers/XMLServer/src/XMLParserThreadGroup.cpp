@@ -14,6 +14,7 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include "XMLParserThreadGroup.h"
 #include "XMLParserThread.h"
 #include "XMLCategoriesData.h"
+#include "XMLGrammarCache.h"
 #include "ServerTypes.h"
 
 XMLParserThreadGroup::XMLParserThreadGroup( 
@@ -28,11 +29,22 @@ XMLParserThreadGroup::XMLParserThreadGroup(
                           queueOverFullFactor )
 {
    m_categoriesData = new XMLCategoriesDataHolder();
+#ifdef USE_XML
+   m_grammarCache.reset( new XMLGrammarCache() );
+#endif
 }
 
 
 XMLParserThreadGroup::~XMLParserThreadGroup() {
    delete m_categoriesData;
+   // The threads still running hold the grammar cache until they
+   // have deleted their parsers.
+}
+
+
+XMLGrammarCachePtr
+XMLParserThreadGroup::getGrammarCache() const {
+   return m_grammarCache;
 }
 
 
@@ -27,6 +27,7 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include "XMLParserThread.h"
 #include "XMLItemInfoUtility.h"
 #include "XMLItemDetailUtility.h"
+#include "XMLStreamWriter.h"
 #include <memory>
 
 namespace XMLSearchUtility {
@@ -1212,4 +1213,47 @@ void appendSearchListElement( DOMNode* parentNode,
    }
 }
 
+void writeSearchListElement( XMLStreamWriter& writer,
+                             const SearchResultRequest* req,
+                             uint32 maxHits,
+                             XMLCommonEntities::coordinateType positionSystem,
+                             LangTypes::language_t language,
+                             XMLParserThread* thread ) {
+   const vector<VanillaMatch*>& matches = req->getMatches();
+
+   uint32 numberMatches = MIN( maxHits, matches.size() );
+
+   writer.startElement( "search_list" );
+   writer.addAttribute( "number_matches", numberMatches );
+   writer.addAttribute( "total_number_matches", 
+                        req->getTotalNbrMatches() );
+
+   // The nodes of each match are released after writing, the document
+   // reuses them for the next match.
+   DOMDocument* matchDoc = DOMImplementationRegistry::
+      getDOMImplementation( X( "Core" ) )->
+      createDocument( NULL, X( "search_list" ), NULL );
+   DOMElement* searchListElement = matchDoc->getDocumentElement();
+   try {
+      for ( uint32 i = 0 ; i < numberMatches ; ++i ) {
+         appendSearchMatchElement( searchListElement, 
+                                   matchDoc, 
+                                   matches[i],
+                                   positionSystem, 
+                                   language,
+                                   thread );
+         DOMNode* matchElement = searchListElement->
+            removeChild( searchListElement->getLastChild() );
+         writer.writeNode( *matchElement );
+         matchElement->release();
+      }
+   } catch ( ... ) {
+      matchDoc->release();
+      throw;
+   }
+   matchDoc->release();
+
+   writer.endElement();
+}
+
 }
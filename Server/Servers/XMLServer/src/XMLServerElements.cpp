@@ -18,6 +18,7 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include "UserFavorites.h"
 #include "XMLSearchUtility.h"
 #include "XMLTool.h"
+#include "XMLStreamWriter.h"
 
 namespace XMLServerUtility {
 
@@ -122,6 +123,24 @@ appendStatusNodes( DOMNode* out,
    }
 }
 
+void
+writeStatusNodes( XMLStreamWriter& writer,
+                  const char* const code,
+                  const char* const message,
+                  const char* extendedCode,
+                  const char* uri ) {
+   writer.addElementWithText( "status_code", code );
+   writer.addElementWithText( "status_message", message );
+   if ( extendedCode != NULL ) {
+      writer.addElementWithText( "status_code_extended", extendedCode );
+   }
+   if ( uri != NULL && *uri ) {
+      writer.startElement( "status_uri" );
+      writer.addAttribute( "href", MC2String( uri ) );
+      writer.endElement();
+   }
+}
+
 void
 appendServerList( DOMNode* out, 
                   DOMDocument* reply,
@@ -94,6 +94,18 @@ class HttpInterfaceRequest : public SocketInterfaceRequest {
        */
       void setReply( HttpHeader* outHead, HttpBody* outBody );
 
+      /**
+       * Sets a file to send after the reply set with setReply,
+       * the file descriptor is now owned by this class. The reply
+       * header must have the Content-Length of the whole file.
+       * Not for https, the file is sent directly to the socket.
+       *
+       * @param fd The open file.
+       * @param size The number of bytes to send from the start of
+       *             the file.
+       */
+      void setReplyFile( int fd, uint64 size );
+
       /**
        * Sets a standard reply indicated by the statusNbr.
        * Returns false if the statusNbr is unknown and the standard
@@ -324,6 +336,21 @@ class HttpInterfaceRequest : public SocketInterfaceRequest {
        */
       uint32 m_replyPos;
 
+      /**
+       * The file to send after the reply buffer, -1 if none.
+       */
+      int m_replyFile;
+
+      /**
+       * The number of bytes to send from m_replyFile.
+       */
+      uint64 m_replyFileSize;
+
+      /**
+       * The position in m_replyFile.
+       */
+      off_t m_replyFilePos;
+
       /**
        * The peer IPnPort.
        */
@@ -237,6 +237,18 @@ protected:
       MC2String m_requestName;
 
 
+      /**
+       * A large file to send straight from disk as the body of the
+       * reply, set by handleHttpRequest. -1 if none.
+       */
+      int m_replyFile;
+
+      /**
+       * The size of m_replyFile.
+       */
+      uint64 m_replyFileSize;
+
+
    private:
       /**
        * Parses a string starting with ?paramname=paramvalue&paramname=...
@@ -328,6 +340,26 @@ protected:
                               uint32& bodyLength );
 
 
+      /**
+       * Checks the Accept-Encoding in inHead for the encodings
+       * supported by encodeBody. Nothing is accepted for content types
+       * that are already compressed.
+       *
+       * @param inHead The request's header.
+       * @param outHead The reply's header with the Content-Type.
+       * @param acceptGzip Set if gzip is accepted.
+       * @param acceptXGzip Set if x-gzip is accepted.
+       * @param acceptXWayf Set if x-wayf is accepted.
+       * @param acceptDeflate Set if deflate is accepted.
+       */
+      static void getAcceptedEncodings( HttpHeader* inHead,
+                                        HttpHeader* outHead,
+                                        bool& acceptGzip,
+                                        bool& acceptXGzip,
+                                        bool& acceptXWayf,
+                                        bool& acceptDeflate );
+
+
       /**
        * Sets the cache variables in the outheader to the appropriate 
        * values.
@@ -428,6 +460,25 @@ protected:
                               HttpBody* outBody,
                               uint32 now );
 
+      /**
+       * Replies with the request latency histograms of the server
+       * as text, one line per packet type.
+       *
+       * @param inHead    The incoming header.
+       * @param inBody    The incoming body.
+       * @param paramsMap Map of parameters.
+       * @param outHead   The outgoing header.
+       * @param outBody   The outgoing body.
+       * @param now       Current time.
+       * @return True if the special file was handled.
+       */
+      bool handleLatencyStatsRequest( HttpHeader* inHead, 
+                                      HttpBody* inBody,
+                                      stringMap* paramsMap,
+                                      HttpHeader* outHead, 
+                                      HttpBody* outBody,
+                                      uint32 now );
+
      /**
       * Handles a XSMap request.
       *
@@ -112,6 +112,24 @@ class HttpParserThreadGroup : public InterfaceParserThreadGroup {
                     int& length, 
                     struct stat *fStat);
 
+      /**
+       * Returns the gzipped version of a file read with getFile.
+       * @param fileString the path and filename. 
+       *        The path is relative the HTML_ROOT.
+       * @param length is set to the length of the gzipped file.
+       * @return The gzipped file, NULL if not smaller than the file.
+       */
+      byte* getGzippedFile( const MC2String* fileString, int& length );
+
+      /**
+       * Opens a file that is too large to keep in memory.
+       * @param fileString the path and filename. 
+       *        The path is relative the HTML_ROOT.
+       * @param fStat struct is set to contain the status of the file.
+       * @return The file descriptor, -1 if not a large file.
+       */
+      int openLargeFile( const MC2String* fileString, struct stat* fStat );
+
 
       /**
        * Puts an entry in the httplog.
@@ -62,6 +62,8 @@ public:
        * Adds and sends a new PacketContainer.
        * If moduleType in cont is MODULE_TYPE_INVALID the getSendIP and
        * getSendPort is used as destination.
+       * The packet is marked for latency tracing unless the
+       * LATENCY_TRACING property is false.
        * Monitor function.
        *
        * @param cont The PacketContainer with packet to send.
@@ -316,6 +318,8 @@ private:
 
    auto_ptr<PacketSenderReceiver> m_senderReceiver;
    auto_ptr<ServerPacketSender> m_packetSender;
+   /// If the modules should return latency trace times in the replies.
+   bool m_traceLatency;
 };
 
 
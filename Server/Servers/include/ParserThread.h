@@ -45,6 +45,7 @@ class UserUser;
 class UserCellular;
 class UserItem;
 class RouteReplyPacket;
+class ServerSubRouteVector;
 class MC2Coordinate;
 class PushPacket;
 class DataBuffer;
@@ -309,6 +310,16 @@ class ParserThread : public ISABThread, public MapRequester {
        *           by the caller or NULL if failure.
        */
       RouteReplyPacket* getStoredRoute(const RouteID& routeID);
+
+      /**
+       *   Returns the route with the supplied id, with its costs, if
+       *   it was stored by this server. Never asks the UserModule.
+       *   @param routeID The id of the route.
+       *   @return A new ServerSubRouteVector for
+       *           RouteRequest::setRerouteBase which should be deleted
+       *           by the caller or NULL if not found.
+       */
+      ServerSubRouteVector* getRoutedRoute( const RouteID& routeID );
       
 
       /**
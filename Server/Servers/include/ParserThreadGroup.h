@@ -55,6 +55,7 @@ class CategoriesDataHolder;
 class NamedServerList;
 struct PreCacheRouteData;
 class ExpandedRoute;
+class ServerSubRouteVector;
 class POIImageIdentificationTable;
 class SFDHolder;
 class SearchHeadingManager;
@@ -525,6 +526,26 @@ class ParserThreadGroup : public ISABThreadGroup, private NotCopyable {
       RouteReplyPacket* getStoredRoute( const RouteID& routeID,
                                         ParserThreadHandle thread );
 
+      /**
+       * Keeps a copy of a route as calculated by the RouteSender, with
+       * its costs, so that it can be reused when the user leaves it.
+       *
+       * @param routeID The id of the route.
+       * @param route The route to copy.
+       */
+      void cacheRoutedRoute( const RouteID& routeID,
+                             const ServerSubRouteVector& route );
+
+      /**
+       * Returns a copy of a route added by cacheRoutedRoute. Only
+       * looks in the cache of this server so it never blocks.
+       *
+       * @param routeID The id of the route.
+       * @return A new ServerSubRouteVector with detached vehicles to
+       *         be deleted by the caller or NULL if not cached.
+       */
+      ServerSubRouteVector* getRoutedRoute( const RouteID& routeID );
+
    
       /**
        * Adds a route id to be expanded to tilemap params
@@ -972,6 +993,15 @@ private:
        */
       routeStorage_t m_routeStorage;
 
+      /// Type of storage for the routes with costs.
+      typedef map<RouteID, ServerSubRouteVector*> routedRoutes_t;
+
+      /**
+       *    The latest calculated routes, for rerouting. Uses
+       *    m_routeStorageMutex.
+       */
+      routedRoutes_t m_routedRoutes;
+
       /**
        *   The mutex that is used for route storage.
        */
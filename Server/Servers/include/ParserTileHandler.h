@@ -154,6 +154,15 @@ public:
                               const char* cacheName,
                               uint32 cacheMaxSize,
                               bool useGzip );
+
+   /**
+    *   Returns the crc of the TileMapFormatDesc that would be used
+    *   for a tile map param, for use in ETags.
+    *
+    *   @param paramString The tile map param string.
+    *   @return The crc or 0 if the TileMapFormatDesc could not be made.
+    */
+   uint32 getTileMapFormatDescCRC( const char* paramString );
    
 private:
 
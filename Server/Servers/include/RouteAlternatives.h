@@ -0,0 +1,70 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef ROUTEALTERNATIVES_H
+#define ROUTEALTERNATIVES_H
+
+#include "config.h"
+
+#include <vector>
+
+class SubRoute;
+class ServerSubRouteVector;
+class ServerSubRouteVectorVector;
+
+/**
+ *    Keeps the alternative routes that the RouteModule returns
+ *    together with the best route to the destination.
+ *
+ *    The alternatives are kept in the vector of finished SubRoutes,
+ *    but not as destinations, so they never compete with the best
+ *    route. They are added after the best route when the routes are
+ *    collected.
+ */
+class RouteAlternatives {
+public:
+   /**
+    *    Inserts the last SubRoute of an alternative route into the
+    *    finished SubRoutes.
+    *
+    *    @param finished The finished SubRoutes of the RouteSender.
+    *    @param subRoute The SubRoute, owned by finished afterwards.
+    */
+   void insert( ServerSubRouteVector& finished, SubRoute* subRoute );
+
+   /**
+    *    Appends the alternative routes after the best route. Only the
+    *    alternatives that start where the best route starts are added,
+    *    the others were found on a map that the best route left.
+    *
+    *    @param finished The finished SubRoutes of the RouteSender.
+    *    @param routes   The finished routes, the best one first.
+    *    @return The number of alternatives appended.
+    */
+   uint32 appendTo( ServerSubRouteVector& finished,
+                    ServerSubRouteVectorVector& routes ) const;
+
+   /**
+    *    @return The number of alternatives inserted.
+    */
+   uint32 size() const;
+
+private:
+   /**
+    *    The indices in the finished SubRoutes of the last SubRoutes
+    *    of the alternative routes.
+    */
+   std::vector<uint32> m_indices;
+};
+
+#endif // ROUTEALTERNATIVES_H
@@ -37,6 +37,8 @@ class RouteSender;                   // forward decl
 class DisturbanceList;              // forward decl
 class OrigDestInfoList;            // forward decl
 class ServerSubRouteVectorVector; // forward decl
+class ServerSubRouteVector;
+class RouteRejoin;
 class RoutingInfo;               // forward decl
 class RouteAllowedMap;          // forward decl
 class UnexpandedRoute;         // forward decl
@@ -673,6 +675,28 @@ class RouteObject {
        */
       inline void setAllowedMaps( RouteAllowedMap* maps );
 
+      /**
+       * Set the route that the user was following before leaving it.
+       * The new route is then calculated from the origin back to the
+       * old route, where the old route is reused to the destination.
+       * If the old route cannot be reused a full route is calculated.
+       *
+       * @param oldRoute The old route as calculated by a RouteSender,
+       *                 with costs and detached vehicles. Not deleted
+       *                 by this object and must be kept until the
+       *                 object is done. NULL means route the whole way.
+       */
+      inline void setRerouteBase( const ServerSubRouteVector* oldRoute );
+
+      /**
+       * Set the number of alternative routes to calculate. The
+       * alternatives follow the best route in the route result vector.
+       * Not used when rerouting.
+       *
+       * @param nbrAlternatives The number of alternatives, default 0.
+       */
+      inline void setNbrAlternatives( uint32 nbrAlternatives );
+
 
       /**
        * Get the prefered language.
@@ -1013,6 +1037,35 @@ class RouteObject {
        */
       state_t createAndPrepareRoutePacket(bool checkProcessed = false);
 
+      /**
+       *    Takes care of the routes when the RouteSender is done.
+       *    Sets m_state to the next state of this object.
+       */
+      void handleFinishedRouting();
+
+      /**
+       *    Creates the RouteSender and gets the first packets from it.
+       *    Routes to m_rejoinList if a rerouting is prepared and to
+       *    m_destList otherwise.
+       *    @return The next state of this object.
+       */
+      state_t startRouteSender();
+
+      /**
+       *    Looks for a place where the route from the origins can
+       *    rejoin m_rerouteBase. Fills in m_rejoin and m_rejoinList
+       *    if such a place is found.
+       *    @return True if only the route to the rejoin point has to
+       *            be calculated.
+       */
+      bool prepareReroute();
+
+      /**
+       *    Deletes the rerouting data so that the next RouteSender
+       *    routes the whole way.
+       */
+      void clearReroute();
+
       /**
        *    Create the packets that should be send to the map module to
        *    get the names of the valid origins and destinations.
@@ -1378,6 +1431,29 @@ class RouteObject {
        */
       RouteAllowedMap* m_allowedMaps;
 
+      /**
+       *   The route that the user left, NULL if not rerouting.
+       *   Not owned.
+       */
+      const ServerSubRouteVector* m_rerouteBase;
+
+      /**
+       *   The number of alternative routes to calculate.
+       */
+      uint32 m_nbrAlternatives;
+
+      /**
+       *   The place where the new route rejoins m_rerouteBase.
+       *   NULL if routing the whole way.
+       */
+      OrigDestInfoList* m_rejoinList;
+
+      /**
+       *   Joins the route to the rejoin point with m_rerouteBase.
+       *   NULL if routing the whole way.
+       */
+      RouteRejoin* m_rejoin;
+
       /**
        *   User - owned by the RouteRequest.
        */
@@ -1887,6 +1963,16 @@ RouteObject::setAllowedMaps( RouteAllowedMap* maps ) {
    m_allowedMaps = maps;
 }
 
+inline void 
+RouteObject::setRerouteBase( const ServerSubRouteVector* oldRoute ) {
+   m_rerouteBase = oldRoute;
+}
+
+inline void 
+RouteObject::setNbrAlternatives( uint32 nbrAlternatives ) {
+   m_nbrAlternatives = nbrAlternatives;
+}
+
 
 inline StringTable::languageCode
 RouteObject::getLanguage() const {
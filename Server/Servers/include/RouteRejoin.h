@@ -0,0 +1,113 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef ROUTEREJOIN_H
+#define ROUTEREJOIN_H
+
+#include "config.h"
+#include "NotCopyable.h"
+
+class DriverPref;
+class OrigDestInfo;
+class OrigDestInfoList;
+class SubRouteVector;
+class ServerSubRouteVector;
+
+/**
+ *    Reuses a route that the user has left.
+ *
+ *    Finds the place where a new route from the origins can rejoin
+ *    the old route and joins the route to that place with the rest
+ *    of the old route. The old route is only reused if it ends at one
+ *    of the destinations. It is rejoined where it leaves the map of
+ *    one of the origins for the last time, the user has probably
+ *    driven past any earlier visits.
+ */
+class RouteRejoin: private NotCopyable {
+public:
+   /**
+    *    Looks for the place to rejoin the old route.
+    *
+    *    @param oldRoute The route that the user left, as calculated
+    *                    by the RouteSender. It is copied and the
+    *                    vehicles are taken from pref.
+    *    @param pref     The driver preferences of the new route.
+    *    @param origs    The origins of the new route.
+    *    @param dests    The destinations of the new route.
+    */
+   RouteRejoin( const ServerSubRouteVector& oldRoute,
+                const DriverPref& pref,
+                const OrigDestInfoList& origs,
+                const OrigDestInfoList& dests );
+
+   /**
+    *    Deletes the copy of the old route.
+    */
+   ~RouteRejoin();
+
+   /**
+    *    @return True if the old route can be rejoined.
+    */
+   bool isValid() const;
+
+   /**
+    *    @return The index of the SubRoute of the old route that ends
+    *            where the new route rejoins it, MAX_UINT32 if the old
+    *            route can not be rejoined.
+    */
+   uint32 getRejoinIndex() const;
+
+   /**
+    *    @param pref The driver preferences of the new route.
+    *    @return The place to route to, on the map after the rejoin
+    *            index. Only valid if isValid.
+    */
+   OrigDestInfo getRejoinPoint( const DriverPref* pref ) const;
+
+   /**
+    *    Appends the rest of the old route to the route to the rejoin
+    *    point. The costs of the appended SubRoutes are the cost to the
+    *    rejoin point plus the remaining cost of the old route.
+    *
+    *    @param route The route to the rejoin point with offsets on the
+    *                 node 0 form.
+    *    @return A new vector with the whole route.
+    */
+   ServerSubRouteVector* join( const ServerSubRouteVector& route ) const;
+
+   /**
+    *    Checks if a route ends at one of the destinations. Node 0 and
+    *    node 1 of the same item are the same place.
+    *
+    *    @param route The route with offsets on the node 0 form.
+    *    @param dests The destinations with offsets from their node.
+    *    @return True if the route ends at one of the destinations.
+    */
+   static bool endsAt( const SubRouteVector& route,
+                       const OrigDestInfoList& dests );
+
+private:
+   /// The old route with the vehicles of the new route.
+   ServerSubRouteVector* m_oldRoute;
+
+   /// The index of the SubRoute ending at the rejoin point.
+   uint32 m_rejoinIdx;
+
+   /// Used if the rejoin point has no coordinate.
+   int32 m_origLat;
+
+   /// Used if the rejoin point has no coordinate.
+   int32 m_origLon;
+};
+
+#endif // ROUTEREJOIN_H
@@ -27,6 +27,7 @@ class RouteObject;
 class ExpandedRoute;
 class RouteRequestPacket;
 class ServerSubRouteVectorVector;
+class ServerSubRouteVector;
 class RouteReplyPacket;
 class PacketContainer;
 class RouteRequestData;
@@ -132,7 +133,8 @@ public:
     *    will be deleted when the vector is deleted in both cases.
     *    @param steal If true the route will <b>not</b> be deleted
     *                 by the RouteObject.
-    *    @return The route as a ServerSubRouteVector.
+    *    @return The route as a ServerSubRouteVector, followed by
+    *            the alternative routes if any were requested.
     */
    ServerSubRouteVectorVector* getRoute(bool steal = false);
    
@@ -574,6 +576,25 @@ public:
        * @param maps The allowed maps. NULL means all maps are allowed.
        */
       void setAllowedMaps( RouteAllowedMap* maps );
+
+      /**
+       * Set the route that the user has left. Only the route back to
+       * it is calculated if possible.
+       *
+       * @param oldRoute The old route from ParserThread::getRoutedRoute.
+       *                 Not deleted by the request and must be kept
+       *                 until the request is done.
+       */
+      void setRerouteBase( const ServerSubRouteVector* oldRoute );
+
+      /**
+       * Set the number of alternative routes to calculate. They are
+       * only found when the whole route is on one map and are then
+       * returned after the best route by getRoute.
+       *
+       * @param nbrAlternatives The number of alternatives, at most 7.
+       */
+      void setNbrAlternatives( uint32 nbrAlternatives );
       
       /**
        * Set if aheads should be removed from the expanded route even if
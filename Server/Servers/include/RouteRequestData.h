@@ -24,6 +24,7 @@ class RouteObject;
 class ExpandedRoute;
 class DisturbanceList;
 class RouteAllowedMap;
+class ServerSubRouteVector;
 class SearchMatch;
 class RequestUserData;
 /**
@@ -167,6 +168,12 @@ private:
    SearchMatch* m_originalOrigin;
    /// Original dest
    SearchMatch* m_originalDest;
+
+   /// The route the user left when rerouting, not owned. May be NULL.
+   const ServerSubRouteVector* m_rerouteBase;
+
+   /// The number of alternative routes to calculate.
+   uint32 m_nbrAlternatives;
 };
 
 // -- Implementation of inlined methods.
@@ -0,0 +1,230 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef ROUTERESULTCACHE_H
+#define ROUTERESULTCACHE_H
+
+#include "config.h"
+#include "ISABThread.h"
+#include "NotCopyable.h"
+#include "MapRights.h"
+
+#include <vector>
+#include <list>
+#include <map>
+
+class UserUser;
+class DriverPref;
+class OrigDestInfoList;
+class ServerSubRouteVector;
+class ServerSubRouteVectorVector;
+
+/**
+ *    Cache of finished routes from the RouteSender.
+ *
+ *    Commuters and fleets ask for the same routes over and over again.
+ *    The cache keeps the result of the RouteSender, keyed on the snapped
+ *    origins and destinations, the driver preferences and the traffic
+ *    rights of the user, so that identical requests within the time to
+ *    live do not have to be routed again.
+ *
+ *    Each entry remembers the crc of the traffic that was used on each
+ *    map. When a RouteSender receives traffic for a map that differs
+ *    from the one the entry was routed with, the entry is removed.
+ *
+ *    The cache is thread safe.
+ */
+class RouteResultCache: private NotCopyable {
+public:
+   /// The default maximum number of routes to keep.
+   static const uint32 DEFAULT_MAX_NBR_ENTRIES = 4096;
+
+   /// The default time to live in seconds.
+   static const uint32 DEFAULT_TTL = 60;
+
+   /// Map id and crc of the traffic rights of the user on the map.
+   typedef std::pair< uint32, uint32 > mapAndRights_t;
+
+   /// The crc of the traffic used for each map and rights.
+   typedef std::map< mapAndRights_t, uint32 > trafficVersions_t;
+
+   /**
+    *    Counters for the cache.
+    */
+   struct Statistics {
+      /// The number of routes found in the cache.
+      uint32 hits;
+      /// The number of routes not found in the cache.
+      uint32 misses;
+      /// The number of routes removed due to changed traffic.
+      uint32 invalidations;
+      /// The number of routes in the cache.
+      uint32 nbrEntries;
+   };
+
+   /**
+    *    The key of a route.
+    */
+   class Key {
+   public:
+      /**
+       *    @param user         The user, for the traffic rights.
+       *    @param origs        The origins of the route.
+       *    @param dests        The destinations of the route.
+       *    @param pref         The driver preferences. The time is
+       *                        rounded to whole time to live periods.
+       *    @param nbrBestDests The number of routes wanted.
+       *    @param ttl          The time to live of the cache.
+       */
+      Key( const UserUser* user,
+           const OrigDestInfoList& origs,
+           const OrigDestInfoList& dests,
+           const DriverPref& pref,
+           uint32 nbrBestDests,
+           uint32 ttl );
+
+      bool operator < ( const Key& other ) const;
+
+   private:
+      /// Adds the position and offset of the origins or destinations.
+      void addOrigDests( const OrigDestInfoList& list );
+
+      /// The origins, destinations and preferences.
+      std::vector< uint32 > m_words;
+
+      /// The traffic rights of the user, per region.
+      std::vector< std::pair< uint32, MapRights > > m_rights;
+   };
+
+   /**
+    *    @param maxNbrEntries The maximum number of routes to keep,
+    *                         0 disables the cache.
+    *    @param ttl           The time to live of the routes in seconds.
+    */
+   explicit RouteResultCache( uint32 maxNbrEntries = DEFAULT_MAX_NBR_ENTRIES,
+                              uint32 ttl = DEFAULT_TTL );
+
+   /**
+    *    Deletes the cached routes.
+    */
+   ~RouteResultCache();
+
+   /**
+    *    Returns the cache used by the RouteSender. The size and time to
+    *    live are set by the properties ROUTE_CACHE_SIZE and
+    *    ROUTE_CACHE_TTL.
+    */
+   static RouteResultCache& getInstance();
+
+   /**
+    *    @return True if the cache can keep any routes.
+    */
+   bool isEnabled() const;
+
+   /**
+    *    @return The time to live of the routes in seconds.
+    */
+   uint32 getTTL() const;
+
+   /**
+    *    Looks for a route.
+    *
+    *    @param key  The key of the route.
+    *    @param pref The driver preferences of the request, the vehicles
+    *                of the returned SubRoutes are taken from these.
+    *    @param now  The current time in seconds.
+    *    @return A copy of the cached routes to be deleted by the caller
+    *            or NULL if not found or too old.
+    */
+   ServerSubRouteVectorVector* find( const Key& key,
+                                     const DriverPref& pref,
+                                     uint32 now );
+
+   /**
+    *    Adds a route to the cache. The routes are copied. Nothing is
+    *    added if the traffic has changed on any of the maps since
+    *    the routing started.
+    *
+    *    @param key     The key of the route.
+    *    @param routes  The routes to copy into the cache.
+    *    @param traffic The traffic used when routing.
+    *    @param now     The current time in seconds.
+    *    @return True if the routes were added.
+    */
+   bool insert( const Key& key,
+                const ServerSubRouteVectorVector& routes,
+                const trafficVersions_t& traffic,
+                uint32 now );
+
+   /**
+    *    Tells the cache about the latest traffic for a map. The routes
+    *    that were calculated using other traffic for the map and rights
+    *    are removed.
+    *
+    *    @param mapAndRights The map and crc of the traffic rights.
+    *    @param trafficCRC   The crc of the traffic.
+    */
+   void updateTraffic( const mapAndRights_t& mapAndRights,
+                       uint32 trafficCRC );
+
+   /**
+    *    @return The counters for the cache.
+    */
+   Statistics getStatistics() const;
+
+private:
+   /// A cached route.
+   struct Entry {
+      Key key;
+      /// The time the entry was added.
+      uint32 created;
+      /// The routes, owned by the entry, with detached vehicles.
+      std::vector< ServerSubRouteVector* > routes;
+      /// The traffic used for the routes.
+      trafficVersions_t traffic;
+   };
+
+   typedef std::list< Entry > Entries;
+   typedef std::map< Key, Entries::iterator > Index;
+
+   /// Removes an entry and deletes its routes.
+   void erase( Entries::iterator it );
+
+   /// Removes the least recently used entries until size fits.
+   void evict();
+
+   /// The most recently used entry first.
+   Entries m_entries;
+
+   /// Finds the entries.
+   Index m_index;
+
+   /// The latest traffic for each map and rights.
+   trafficVersions_t m_traffic;
+
+   /// The maximum number of entries.
+   uint32 m_maxNbrEntries;
+
+   /// Time to live in seconds.
+   uint32 m_ttl;
+
+   /// Counters.
+   uint32 m_hits;
+   uint32 m_misses;
+   uint32 m_invalidations;
+
+   /// Protects the members.
+   mutable ISABMutex m_mutex;
+};
+
+#endif // ROUTERESULTCACHE_H
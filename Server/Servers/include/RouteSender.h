@@ -24,6 +24,8 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include "PacketContainerTree.h"
 #include "SubRouteContainer.h"
 #include "IDPairVector.h"
+#include "RouteResultCache.h"
+#include "RouteAlternatives.h"
 
 class SubRouteVector;        // forward decl
 class ServerSubRouteVector;  // forward decl
@@ -91,6 +93,10 @@ public:
     *                             MAX_UINT32. (For distsort).
     *    @param lowerLevelDestMaps Destination maps on low level.
     *    @param allowedMaps The allowed maps to route on, NULL means all.
+    *    @param nbrAlternatives The number of alternative routes to
+    *                           return after the best one. Only used on
+    *                           level 0 when nbrBestDests is MAX_UINT32
+    *                           and allDestInfoList is NULL.
     */
    RouteSender( const RequestUserData& user,
                 Request* request,
@@ -107,7 +113,8 @@ public:
                 bool calcCostSums = false,
                 bool dontSendSubRoutes = false,
                 set<uint32>* lowerLevelDestMaps = NULL,
-                RouteAllowedMap* allowedMaps = NULL );
+                RouteAllowedMap* allowedMaps = NULL,
+                uint32 nbrAlternatives = 0 );
 
    /**
     *    Delete this RouteSender, and release allocated memory.
@@ -136,7 +143,8 @@ public:
     *
     *    @return  A ServerSubRouteVectorVector containing all the
     *             ServerSubRouteVectors that represent finished routes
-    *             to the requested destinations.
+    *             to the requested destinations. Alternative routes,
+    *             if any, follow the best route.
     */
    ServerSubRouteVectorVector* getRoute( );
 
@@ -183,6 +191,30 @@ private:
     */
    void initAllowedMaps();
 
+   /**
+    *    Looks for the route in the RouteResultCache if the
+    *    request can be cached. If found the routing is done.
+    *    @param origInfoList The origins.
+    *    @param nbrBestDests The number of routes to calculate.
+    */
+   void lookupInCache( const OrigDestInfoList* origInfoList,
+                       uint32 nbrBestDests );
+
+   /**
+    *    Adds the finished routes to the RouteResultCache if the
+    *    request can be cached.
+    *    @param routes The routes from getRoute.
+    */
+   void insertInCache( const ServerSubRouteVectorVector& routes );
+
+   /**
+    *    Adds the traffic used by this and the higher level
+    *    RouteSenders to versions.
+    *    @return False if the traffic could not be fetched for some map.
+    */
+   bool getTrafficVersions( RouteResultCache::trafficVersions_t&
+                            versions ) const;
+
    /**
     *    Returns the disturbance vector to use in packets.
     */
@@ -281,6 +313,14 @@ private:
     */
    bool createAndEnqueueSubRouteRequest();
 
+   /**
+    *    Asks the RouteModule leader to load the destination maps
+    *    in the background, so that they are loaded when the
+    *    route reaches them. The leader replies at once.
+    *    @param origInfoList The origins, their maps are loaded anyway.
+    */
+   void enqueuePreloadRequests( const OrigDestInfoList* origInfoList );
+
    /**
     *    Creates a SubRouteRequestPacket from m_nextMapAndSubRouteVector
     *    and enqueues it in the outgoing queue.
@@ -596,6 +636,27 @@ private:
 
    /// True if traffic should be used if costC is set
    bool m_useTrafficIfC;
+
+   /// The key in the RouteResultCache, NULL if not to be cached.
+   RouteResultCache::Key* m_cacheKey;
+
+   /// The routes found in the RouteResultCache, NULL if not found.
+   ServerSubRouteVectorVector* m_cachedRoutes;
+
+   /// Crc of the rights in the outstanding traffic request.
+   uint32 m_trafficRightsCRC;
+
+   /// The traffic received from the InfoModule for each map.
+   RouteResultCache::trafficVersions_t m_trafficVersions;
+
+   /// False if some traffic request failed.
+   bool m_trafficComplete;
+
+   /// The number of alternative routes to ask the RouteModule for.
+   uint32 m_nbrAlternatives;
+
+   /// The alternative routes in m_finishedServerSubRouteVector.
+   RouteAlternatives m_alternatives;
 };
 
 // -----------------------------------------------------------------------
@@ -609,6 +670,9 @@ RouteSender::insertOrigDestInfo(const OrigDestInfo& insertInfo) {
 inline bool
 RouteSender::requestDone()
 {
+   if ( m_cachedRoutes != NULL ) {
+      return true;
+   }
    if ( ( m_requestSubRouteContainer.getSize() == 0 &&
           m_nbrOutstanding == 0 &&
           m_outgoingQueue.getCardinal() == 0 )
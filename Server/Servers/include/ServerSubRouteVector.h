@@ -19,6 +19,8 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 
 #include "SubRouteVector.h"
 
+class DriverPref;
+
 /**
  *    Vector containing pointers to SubRoutes.
  *    The class is used by RouteSender and RouteObject to manipulate SubRoutes
@@ -119,6 +121,41 @@ public:
     *                   up the route.
     */
    ServerSubRouteVector* getResultVector(uint32 index);
+
+   /**
+    *    Like getResultVector, but backtracks from any SubRoute in
+    *    this vector, e.g. the last SubRoute of an alternative route.
+    *
+    *    @param  subRouteIndex The index in this vector of the last
+    *                          SubRoute of the route.
+    *    @return        A new SubRouteVector with the SubRoutes making
+    *                   up the route.
+    */
+   ServerSubRouteVector* getResultVectorFrom(uint32 subRouteIndex);
+
+   /**
+    *    Creates a deep copy of this vector. The copy owns new
+    *    copies of all the SubRoutes and keeps their ids.
+    *
+    *    @return A new ServerSubRouteVector to be deleted by the caller.
+    */
+   ServerSubRouteVector* getCopy() const;
+
+   /**
+    *    Replaces the vehicles of the SubRoutes with their masks.
+    *    The vehicles belong to the DriverPref of a request, so this
+    *    must be done before the vector is kept longer than the request.
+    */
+   void detachVehicles();
+
+   /**
+    *    Sets the vehicles of the SubRoutes again after detachVehicles.
+    *
+    *    @param pref The DriverPref to take the vehicles from. The
+    *                vehicle with the same mask is used, or the best
+    *                vehicle if there is none.
+    */
+   void attachVehicles( const DriverPref& pref );
    
    /**
     *    Returns the number of elements in m_destIndexArray
@@ -217,6 +254,12 @@ private:
     *    when this ServerSubRouteVector is deleted.
     */
    vector<bool> m_ownedByMe;
+
+   /**
+    *    The masks of the orig and dest vehicles of each SubRoute
+    *    after detachVehicles. Empty when the vehicles are attached.
+    */
+   vector<uint32> m_vehicleMasks;
 };
 
 /**
@@ -0,0 +1,192 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#ifndef TILEETAGTABLE_H
+#define TILEETAGTABLE_H
+
+#include "config.h"
+#include "ISABThread.h"
+#include "NotCopyable.h"
+#include "MC2String.h"
+
+#include <list>
+#include <map>
+
+/**
+ *    The ETags of the tile maps sent by the HttpParserThreads.
+ *
+ *    The ETag of a tile map is made from the crc of the
+ *    TileMapFormatDesc it was made with and the crc of the tile map
+ *    buffer. The table remembers the ETag and the last modified time
+ *    of the tile maps recently sent, so that a conditional request
+ *    for a tile map that has not changed can be answered with
+ *    304 Not Modified without asking the modules for the tile map.
+ *
+ *    An entry is trusted for the time to live after the tile map was
+ *    last fetched, after that the tile map is fetched again and its
+ *    crc is compared to the one in the request instead.
+ *
+ *    The table is thread safe.
+ */
+class TileETagTable: private NotCopyable {
+public:
+   /// The default maximum number of tile maps to keep.
+   static const uint32 DEFAULT_MAX_NBR_ENTRIES = 65536;
+
+   /// The default time to live in seconds.
+   static const uint32 DEFAULT_TTL = 600;
+
+   /// The statistics are logged every this many conditional requests.
+   static const uint32 LOG_INTERVAL = 10000;
+
+   /**
+    *    Counters for the conditional requests.
+    */
+   struct Statistics {
+      /// 304 replies sent without fetching the tile map.
+      uint32 earlyNotModified;
+      /// 304 replies sent after fetching the tile map.
+      uint32 lateNotModified;
+      /// Conditional requests answered with the whole tile map.
+      uint32 modified;
+      /// The number of tile maps in the table.
+      uint32 nbrEntries;
+   };
+
+   /**
+    *    @param maxNbrEntries The maximum number of tile maps to keep,
+    *                         0 disables the early 304 replies.
+    *    @param ttl           The time to live of the entries in seconds.
+    */
+   explicit TileETagTable( uint32 maxNbrEntries = DEFAULT_MAX_NBR_ENTRIES,
+                           uint32 ttl = DEFAULT_TTL );
+
+   /**
+    *    Returns the table used by the HttpParserThreads. The size and
+    *    time to live are set by the properties HTTP_TILE_ETAG_SIZE and
+    *    HTTP_TILE_ETAG_TTL.
+    */
+   static TileETagTable& getInstance();
+
+   /**
+    *    @param descCRC The crc of the TileMapFormatDesc.
+    *    @param tileCRC The crc of the tile map buffer.
+    *    @return The quoted ETag.
+    */
+   static MC2String makeETag( uint32 descCRC, uint32 tileCRC );
+
+   /**
+    *    Checks the conditions of a request against an ETag and the
+    *    last modified time. If-Modified-Since is only used when there
+    *    is no If-None-Match.
+    *
+    *    @param ifNoneMatch     The If-None-Match header, NULL if none.
+    *    @param ifModifiedSince The If-Modified-Since time, 0 if none.
+    *    @param etag            The current ETag.
+    *    @param lastModified    The current last modified time.
+    *    @return True if 304 Not Modified should be sent.
+    */
+   static bool notModified( const MC2String* ifNoneMatch,
+                            uint32 ifModifiedSince,
+                            const MC2String& etag,
+                            uint32 lastModified );
+
+   /**
+    *    Checks a conditional request against the table, before the
+    *    tile map is fetched.
+    *
+    *    @param param           The tile map param string.
+    *    @param descCRC         The crc of the current TileMapFormatDesc.
+    *    @param ifNoneMatch     The If-None-Match header, NULL if none.
+    *    @param ifModifiedSince The If-Modified-Since time, 0 if none.
+    *    @param now             The current time in seconds.
+    *    @param etag            Set to the ETag to send with the 304.
+    *    @return True if 304 Not Modified can be sent at once.
+    */
+   bool checkEarly( const MC2String& param,
+                    uint32 descCRC,
+                    const MC2String* ifNoneMatch,
+                    uint32 ifModifiedSince,
+                    uint32 now,
+                    MC2String& etag );
+
+   /**
+    *    Remembers the crc of a fetched tile map.
+    *
+    *    @param param   The tile map param string.
+    *    @param descCRC The crc of the current TileMapFormatDesc.
+    *    @param tileCRC The crc of the tile map buffer.
+    *    @param now     The current time in seconds.
+    *    @return The last modified time of the tile map, which is the
+    *            first time it was seen with this crc.
+    */
+   uint32 update( const MC2String& param,
+                  uint32 descCRC,
+                  uint32 tileCRC,
+                  uint32 now );
+
+   /**
+    *    Counts a conditional request that was checked after the tile
+    *    map was fetched.
+    *
+    *    @param notModified True if 304 Not Modified was sent.
+    */
+   void countLate( bool notModified );
+
+   /**
+    *    @return The counters for the table.
+    */
+   Statistics getStatistics() const;
+
+private:
+   /// What is known about a tile map.
+   struct Entry {
+      /// The crc of the TileMapFormatDesc.
+      uint32 descCRC;
+      /// The crc of the tile map buffer.
+      uint32 tileCRC;
+      /// The first time the tile map was seen with the crcs.
+      uint32 lastModified;
+      /// The last time the tile map was fetched.
+      uint32 fetched;
+   };
+
+   typedef std::map< MC2String, Entry > Entries;
+
+   /**
+    *    Logs the statistics every LOG_INTERVAL conditional requests.
+    *    Called with the mutex held after a counter is increased.
+    */
+   void counted() const;
+
+   /// The maximum number of entries.
+   uint32 m_maxNbrEntries;
+
+   /// The time to live in seconds.
+   uint32 m_ttl;
+
+   /// The entries.
+   Entries m_entries;
+
+   /// The params in the order they were added, oldest first.
+   std::list< MC2String > m_order;
+
+   /// The counters.
+   Statistics m_stats;
+
+   /// Protects all the members.
+   mutable ISABMutex m_mutex;
+};
+
+#endif // TILEETAGTABLE_H
@@ -43,7 +43,8 @@ HttpInterfaceRequest::HttpInterfaceRequest( TCPSocket* reqSock, const IPnPort& s
         m_requestHeader( new HttpHeader() ), m_bodyRequestLength( 0 ),
         m_requestBody( new HttpBody() ), m_replyHeader( NULL ),
         m_replyBody( NULL ), m_replyBuffer( NULL ), m_replySize( 0 ),
-        m_replyPos( 0 ), m_IPnPort( 0 ,0 ),
+        m_replyPos( 0 ), m_replyFile( -1 ), m_replyFileSize( 0 ),
+        m_replyFilePos( 0 ), m_IPnPort( 0 ,0 ),
         m_serverAddress( serverAddress )
 {
    // Setup socket
@@ -704,12 +705,26 @@ HttpInterfaceRequest::handleIO( bool readyRead, bool readyWrite ) {
       case writing_reply_body:
          if ( readyWrite || (readyRead && m_invIO) ) {
             // Write some more
-            int res = m_reqSock->write( m_replyBuffer + m_replyPos, 
-                                        m_replySize - m_replyPos );
+            int res = 0;
+            if ( m_replyPos < m_replySize ) {
+               res = m_reqSock->write( m_replyBuffer + m_replyPos, 
+                                       m_replySize - m_replyPos );
+               if ( res > 0 ) {
+                  m_replyPos += res;
+               }
+            } else {
+               // The header is sent, now the file. At most 2 GB per
+               // call so the length fits a 32 bit size_t.
+               res = m_reqSock->sendFile( m_replyFile, m_replyFilePos,
+                                          size_t( MIN( m_replyFileSize - 
+                                                       m_replyFilePos,
+                                                       uint64( MAX_INT32 ) ) ) );
+            }
             if ( res > 0 ) {
-               m_replyPos += res;
                // If sent reply
-               if ( m_replyPos >= m_replySize ) {
+               if ( m_replyPos >= m_replySize &&
+                    ( m_replyFile == -1 || 
+                      m_replyFilePos >= off_t( m_replyFileSize ) ) ) {
                   // Set state etc.
                   if ( keepConnection( m_replyCode ) ) {
                      // More read again setState( Ready_To_IO_Request )
@@ -829,6 +844,18 @@ HttpInterfaceRequest::setReply( HttpHeader* outHead, HttpBody* outBody ) {
 }
 
 
+void
+HttpInterfaceRequest::setReplyFile( int fd, uint64 size ) {
+   MC2_ASSERT( ! isHttps() );
+   if ( m_replyFile != -1 ) {
+      close( m_replyFile );
+   }
+   m_replyFile = fd;
+   m_replyFileSize = size;
+   m_replyFilePos = 0;
+}
+
+
 bool
 HttpInterfaceRequest::setStatusReply( 
    uint32 statusNbr, uint32 retryTime,
@@ -947,6 +974,12 @@ HttpInterfaceRequest::reset() {
    m_replyBuffer = NULL;
    m_replySize = 0;
    m_replyPos = 0;
+   if ( m_replyFile != -1 ) {
+      close( m_replyFile );
+      m_replyFile = -1;
+   }
+   m_replyFileSize = 0;
+   m_replyFilePos = 0;
    m_invIO = false;
    m_replyCode = 0;
    setState( Ready_To_IO_Request );
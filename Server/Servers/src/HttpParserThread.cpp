@@ -32,10 +32,16 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include "HttpMapFunctions.h"
 
 #include "STLStringUtility.h"
+#include "TileETagTable.h"
+#include "ParserTileHandler.h"
+#include "MC2CRC32.h"
 #include "UserData.h"
 #include "UserSwitch.h"
 #include "XSData.h"
 #include "Utility.h"
+#include "LatencyStatistics.h"
+
+#include <sstream>
 
 // fstat includes
 #ifdef __linux
@@ -60,6 +66,8 @@ using namespace HttpHeaderLines;
 
 HttpParserThread::HttpParserThread( HttpParserThreadGroup* group ):
    InterfaceParserThread( group, "HttpParserThread" ),
+   m_replyFile( -1 ),
+   m_replyFileSize( 0 ),
    m_functions( new HttpFunctionHandler() )
 {
 }
@@ -203,7 +211,11 @@ HttpParserThread::makeDateStr( char* dateStr, uint32 date ) {
 uint32
 HttpParserThread::dateStrToInt( const char* dateStr ) {
    struct tm tm; 
-   strptime( dateStr, "%a, %d %b %Y %H:%M:%S GMT", &tm );
+   memset( &tm, 0, sizeof( tm ) );
+   if ( strptime( dateStr, "%a, %d %b %Y %H:%M:%S GMT", &tm ) == NULL ) {
+      // Unparsable date, treat as the very beginning of time
+      return 0;
+   }
    time_t t = timegm( &tm );
 
    return uint32( t );
@@ -370,9 +382,32 @@ HttpParserThread::handleInterfaceRequest( InterfaceRequest* ireq ) {
            << inHead.getStartLine()->c_str() << endl;
    uint32 startProcessTime = TimeUtility::getCurrentMicroTime();
 
-   if ( handleHttpRequest( &inHead, &inBody, &paramsMap,
-                           outHead, outBody, now, dateStr ) )
-   {
+   const bool handled = handleHttpRequest( &inHead, &inBody, &paramsMap,
+                                           outHead, outBody, now, dateStr );
+   if ( handled && m_replyFile != -1 ) {
+      // The body is sent straight from the file
+      MC2String* contentLength = new MC2String();
+      STLStringUtility::int2str( m_replyFileSize, *contentLength );
+      outHead->addHeaderLine( &CONTENTLENGTH, contentLength );
+      // The log and statistics sizes are 32 bits
+      const uint32 loggedSize = 
+         uint32( MIN( m_replyFileSize, uint64( MAX_UINT32 ) ) );
+      irequest->setReply( outHead, outBody );
+      irequest->setReplyFile( m_replyFile, m_replyFileSize );
+      m_replyFile = -1;
+
+      HttpParserThreadGroupHandle( 
+         static_cast<HttpParserThreadGroup*>( 
+            m_group.get() ) )->httpLog( 
+               NULL, irequest->getPeer().getIP(), now, 
+               StringUtility::trimStartEnd(*inHead.getStartLine()).c_str(),
+               outHead->getStartLineCode(), 
+               loggedSize,
+               userAgent.c_str(),
+               "-",
+               m_logname.empty() ? NULL : m_logname.c_str() );
+      replySize = loggedSize;
+   } else if ( handled ) {
       uint32 bodyLength = outBody->getBodyLength();
       MC2String body( outBody->getBody(), bodyLength );
 
@@ -528,6 +563,30 @@ HttpParserThread::handleTileMapRequest( HttpHeader* inHead,
    // Extract the request string from the url-path
    const MC2String* specString = inHead->getPagename();
    mc2log << info << "handleTileMapRequest " << *specString << endl;
+
+   // Conditional request, answer 304 without fetching the tile map
+   // if the client already has it.
+   TileETagTable& etags = TileETagTable::getInstance();
+   const MC2String* ifNoneMatch = inHead->getHeaderValue( "If-None-Match" );
+   const MC2String* ifModifiedSinceStr = 
+      inHead->getHeaderValue( "If-Modified-Since" );
+   uint32 ifModifiedSince = 0;
+   if ( ifModifiedSinceStr != NULL ) {
+      ifModifiedSince = dateStrToInt( ifModifiedSinceStr->c_str() );
+   }
+   const bool conditional = ifNoneMatch != NULL || ifModifiedSince != 0;
+   const uint32 descCRC = 
+      getTileHandler()->getTileMapFormatDescCRC( specString->c_str() );
+   MC2String etag;
+   if ( conditional &&
+        etags.checkEarly( *specString, descCRC, 
+                          ifNoneMatch, ifModifiedSince, now, etag ) ) {
+      vector< MC2String > extraHeaderFields;
+      extraHeaderFields.push_back( "ETag: " + etag );
+      m_irequest->setStatusReply( HttpCode::NOT_MODIFIED, 0,
+                                  &extraHeaderFields );
+      return false;
+   }
    
    DataBuffer* buf = getTileMap( specString->c_str() );
    
@@ -537,6 +596,26 @@ HttpParserThread::handleTileMapRequest( HttpHeader* inHead,
       return false;
    } 
 
+   const uint32 tileCRC = MC2CRC32::crc32( buf->getBufferAddress(),
+                                           buf->getCurrentOffset() );
+   const uint32 lastModified = 
+      etags.update( *specString, descCRC, tileCRC, now );
+   etag = TileETagTable::makeETag( descCRC, tileCRC );
+   if ( conditional ) {
+      const bool notModified = 
+         TileETagTable::notModified( ifNoneMatch, ifModifiedSince,
+                                     etag, lastModified );
+      etags.countLate( notModified );
+      if ( notModified ) {
+         delete buf;
+         vector< MC2String > extraHeaderFields;
+         extraHeaderFields.push_back( "ETag: " + etag );
+         m_irequest->setStatusReply( HttpCode::NOT_MODIFIED, 0,
+                                     &extraHeaderFields );
+         return false;
+      }
+   }
+
    // Set the body.
    outBody->setBody( buf->getBufferAddress(),
                      buf->getCurrentOffset() );
@@ -558,6 +637,11 @@ HttpParserThread::handleTileMapRequest( HttpHeader* inHead,
    // Set last-mod date to the output of date +"%s" the 22 of dec 2003.
    fStat.st_atime = fStat.st_mtime = fStat.st_ctime = 1072094201;
    setCacheHeaders( outHead, "GET", false, true, now, NULL, &fStat);
+   // The validators for conditional requests.
+   outHead->addHeaderLine( "ETag", etag );
+   char dateStr[ 64 ];
+   makeDateStr( dateStr, lastModified );
+   outHead->addHeaderLine( "Last-modified", dateStr );
 
    return true;
 }
@@ -675,6 +759,26 @@ HttpParserThread::handleEchoRequest( HttpHeader* inHead,
    return copyEchoRequestToReply( inHead, inBody, outHead, outBody );
 }
 
+bool
+HttpParserThread::handleLatencyStatsRequest( HttpHeader* inHead, 
+                                             HttpBody* inBody,
+                                             stringMap* paramsMap,
+                                             HttpHeader* outHead, 
+                                             HttpBody* outBody,
+                                             uint32 now )
+{
+   m_requestName = "LATENCY_STATS";
+
+   ostringstream stats;
+   LatencyStatistics::getInstance().print( stats );
+   MC2String body = stats.str();
+   outBody->setBody( &body );
+   outBody->setBinary( false );
+   outHead->addHeaderLine( CONTENT_TYPE, "text/plain" );
+
+   return true;
+}
+
 bool
 HttpParserThread::handleXSMapRequest( HttpHeader* inHead, 
                                      HttpBody* inBody,
@@ -732,6 +836,10 @@ HttpParserThread::handleSpecialFiles( HttpHeader* inHead,
       res = handleEchoRequest( inHead, inBody, paramsMap,
                                outHead, outBody, now );
       return true; // handled the request, maybe set error reply
+   } else if ( *urlPath == "/latencystats" ) {
+      res = handleLatencyStatsRequest( inHead, inBody, paramsMap,
+                                       outHead, outBody, now );
+      return true;
    } else if ( urlPath->find("/XSMap") == 0 && 
                inHead->getMethod() == HttpHeader::POST_METHOD ) {
       res = handleXSMapRequest( inHead, inBody, paramsMap,
@@ -784,6 +892,20 @@ HttpParserThread::handleHttpRequest( HttpHeader* inHead,
    }
    // Get file
    const MC2String* constString = inHead->getURLPath();
+   if ( inHead->getMethod() == HttpHeader::GET_METHOD && 
+        ! m_irequest->isHttps() ) {
+      // Large files are sent straight from the file to the socket
+      int fd = HttpParserThreadGroupHandle( 
+         static_cast<HttpParserThreadGroup*>( 
+            m_group.get() ) )->openLargeFile( constString, &fStat );
+      if ( fd != -1 ) {
+         m_replyFile = fd;
+         m_replyFileSize = fStat.st_size;
+         setCacheHeaders( outHead, inHead->getMethodString(), 
+                          false, true, now, dateStr, &fStat );
+         return true;
+      }
+   }
    byte* file = HttpParserThreadGroupHandle( 
       static_cast<HttpParserThreadGroup*>( 
          m_group.get() ) )->getFile( constString, length, &fStat );
@@ -810,7 +932,30 @@ HttpParserThread::handleHttpRequest( HttpHeader* inHead,
       delete tmpString;
       tmpString = NULL;
    } else { // Send raw file   
-      outBody->setBody( file, length );
+      bool acceptGzip = false;
+      bool acceptXGzip = false;
+      bool acceptXWayf = false;
+      bool acceptDeflate = false;
+      getAcceptedEncodings( inHead, outHead, acceptGzip, acceptXGzip,
+                            acceptXWayf, acceptDeflate );
+      byte* gzipped = NULL;
+      int gzLength = 0;
+      if ( acceptGzip || acceptXGzip || acceptXWayf ) {
+         // The gzipped file is kept so encodeBody need not gzip it.
+         gzipped = HttpParserThreadGroupHandle( 
+            static_cast<HttpParserThreadGroup*>( 
+               m_group.get() ) )->getGzippedFile( constString, gzLength );
+      }
+      if ( gzipped != NULL ) {
+         outBody->setBody( gzipped, gzLength );
+         outBody->setBinary( true );
+         delete [] gzipped;
+         outHead->addHeaderLine( "Content-Encoding", 
+                                 acceptGzip ? "gzip" : 
+                                 acceptXGzip ? "x-gzip" : "x-wayf" );
+      } else {
+         outBody->setBody( file, length );
+      }
 
       setCacheHeaders( outHead, inHead->getMethodString(), 
                        false, true, now, dateStr, &fStat );
@@ -1203,19 +1348,15 @@ HttpParserThread::setBodyCharset( HttpBody& outBody,
 }
 
 
-void 
-HttpParserThread::encodeBody( MC2String& body, 
-                              HttpHeader* inHead,
-                              HttpHeader* outHead,
-                              HttpBody* outBody,
-                              uint32& bodyLength )
+void
+HttpParserThread::getAcceptedEncodings( HttpHeader* inHead,
+                                        HttpHeader* outHead,
+                                        bool& acceptGzip,
+                                        bool& acceptXGzip,
+                                        bool& acceptXWayf,
+                                        bool& acceptDeflate )
 {
    const MC2String AcceptEncoding = "Accept-Encoding";
-   const MC2String ContentEncoding = "Content-Encoding";
-   bool acceptGzip = false;
-   bool acceptXGzip = false;
-   bool acceptXWayf = false;
-   bool acceptDeflate = false;
 
    // Check the inHead for Accept-Encoding
    const MC2String* accept = inHead->getHeaderValue( &AcceptEncoding );
@@ -1253,7 +1394,31 @@ HttpParserThread::encodeBody( MC2String& body,
          
          matchStr = HttpHeader::getNextStringIn( accept, pos );
       }
-      
+   }
+}
+
+
+void 
+HttpParserThread::encodeBody( MC2String& body, 
+                              HttpHeader* inHead,
+                              HttpHeader* outHead,
+                              HttpBody* outBody,
+                              uint32& bodyLength )
+{
+   const MC2String ContentEncoding = "Content-Encoding";
+   bool acceptGzip = false;
+   bool acceptXGzip = false;
+   bool acceptXWayf = false;
+   bool acceptDeflate = false;
+
+   if ( outHead->getHeaderValue( &ContentEncoding ) != NULL ) {
+      // Already encoded, e.g. a gzipped file from the file cache
+      return;
+   }
+
+   getAcceptedEncodings( inHead, outHead, acceptGzip, acceptXGzip,
+                         acceptXWayf, acceptDeflate );
+   if ( acceptGzip || acceptXGzip || acceptXWayf || acceptDeflate ) {
       if ( acceptGzip || acceptXGzip || acceptXWayf ) {
          // Encode with zlib (gzip)
          uint32 startTime = TimeUtility::getCurrentMicroTime();
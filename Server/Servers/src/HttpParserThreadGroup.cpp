@@ -92,6 +92,24 @@ HttpParserThreadGroup::getFile(const MC2String* fileString,
 }
 
 
+byte*
+HttpParserThreadGroup::getGzippedFile( const MC2String* fileString, 
+                                       int& length )
+{
+   ISABSync sync( m_fileMonitor );
+   return m_files->getGzippedFile( *fileString, length );
+}
+
+
+int
+HttpParserThreadGroup::openLargeFile( const MC2String* fileString, 
+                                      struct stat* fStat )
+{
+   ISABSync sync( m_fileMonitor );
+   return m_files->openLargeFile( *fileString, fStat );
+}
+
+
 void 
 HttpParserThreadGroup::httpLog( TCPSocket* sock, uint32 peerIP, 
                                 uint32 time,
@@ -26,6 +26,7 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include "PacketContainerTree.h"
 #include "PacketDump.h"
 #include "StringTable.h"
+#include "Properties.h"
 
 class ServerPacketSender: public QueuedPacketSender {
 public:
@@ -132,7 +133,8 @@ PacketResendHandler::PacketResendHandler( uint16 port ):
    m_senderReceiver( new PacketSenderReceiver( port ) ),
    m_packetSender( new
                    ::ServerPacketSender( *m_senderReceiver,
-                                         Packet::getTCPLimitSize() ) )
+                                         Packet::getTCPLimitSize() ) ),
+   m_traceLatency( Properties::getBoolProperty( "LATENCY_TRACING", true ) )
 {
 
 }
@@ -178,6 +180,9 @@ void
 PacketResendHandler::addAndSend( PacketContainer* cont ) {
    ISABSync sync( m_monitor );
    cont->setServerTimestamp( TimeUtility::getCurrentTime() );
+   if ( m_traceLatency ) {
+      cont->getPacket()->setTraceFlags( Packet::TRACE_REQUESTED );
+   }
    m_contTree->add( cont );
    send( cont );
    m_monitor.notifyAll();
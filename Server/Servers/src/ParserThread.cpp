@@ -417,6 +417,11 @@ ParserThread::getStoredRoute( const RouteID& routeID ) {
    return m_group->getStoredRoute( routeID, this );
 }                           
 
+ServerSubRouteVector*
+ParserThread::getRoutedRoute( const RouteID& routeID ) {
+   return m_group->getRoutedRoute( routeID );
+}
+
 bool
 ParserThread::storeRoute( RouteRequest* req,
                           uint32 UIN,
@@ -527,6 +532,14 @@ ParserThread::storeRoute( RouteRequest* req,
                  << createTime 
                  << " for UIN " << UIN 
                  << " extraUserinfo " << extraUserinfo << endl;
+         // Keep the costs too, for rerouting when the user leaves it.
+         const ServerSubRouteVectorVector* routes = req->getRoute();
+         if ( routes != NULL && ! routes->empty() &&
+              routes->front()->getSize() > 0 &&
+              Properties::getUint32Property( "INCREMENTAL_REROUTE", 1 ) ) {
+            m_group->cacheRoutedRoute( RouteID( routeID, createTime ),
+                                       *routes->front() );
+         }
       }
    } else {
       mc2log << warn << "ParserThread::storeRoute no routedata to store"
@@ -31,6 +31,7 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include "CopyrightRequest.h"
 #include "UserPacket.h"
 #include "RouteStoragePacket.h"
+#include "ServerSubRouteVector.h"
 
 #include "ServerTileMapFormatDesc.h"
 #include "SFDHolder.h"
@@ -215,6 +216,7 @@ ParserThreadGroup::~ParserThreadGroup()
       delete rit->second;
    }
    m_routeStorage.clear();
+   deleteAllSecond( m_routedRoutes );
 
    mc2dbg1 << "ParserThreadGroup::~ParserThreadGroup "
            << "all threads done" << endl;
@@ -1845,6 +1847,39 @@ ParserThreadGroup::getStoredRoute( const RouteID& routeID,
    delete pc;
    return routePack;
 }                           
+
+void
+ParserThreadGroup::cacheRoutedRoute( const RouteID& routeID,
+                                     const ServerSubRouteVector& route )
+{
+   ServerSubRouteVector* copy = route.getCopy();
+   copy->detachVehicles();
+   ISABSync sync( m_routeStorageMutex );
+   pair<routedRoutes_t::iterator, bool> insres =
+      m_routedRoutes.insert( make_pair( routeID, copy ) );
+   if ( ! insres.second ) {
+      delete insres.first->second;
+      insres.first->second = copy;
+   }
+   // Assume that the oldest route will be least used.
+   if ( m_routedRoutes.size() > 
+        Properties::getUint32Property( "ROUTE_STORAGE_CACHE_MAX_NBR", 100 ) )
+   {
+      delete m_routedRoutes.begin()->second;
+      m_routedRoutes.erase( m_routedRoutes.begin() );
+   }
+}
+
+ServerSubRouteVector*
+ParserThreadGroup::getRoutedRoute( const RouteID& routeID )
+{
+   ISABSync sync( m_routeStorageMutex );
+   routedRoutes_t::const_iterator it = m_routedRoutes.find( routeID );
+   if ( it == m_routedRoutes.end() ) {
+      return NULL;
+   }
+   return it->second->getCopy();
+}
 void ParserThreadGroup::preCacheRoute( const ExpandedRoute* expRoute,
                                        const RouteID& routeID,
                                        LangTypes::language_t lang,
@@ -1605,6 +1605,18 @@ inline bool isFormatDescOrCRC( const TileMapParamTypes::param_t type ) {
 
 }
 
+uint32
+ParserTileHandler::getTileMapFormatDescCRC( const char* paramString )
+{
+   const ServerTileMapFormatDesc* desc =
+      m_group->getTileMapFormatDesc( getDefaultSTMFDParams( paramString ),
+                                     m_thread );
+   if ( desc == NULL ) {
+      return 0;
+   }
+   return desc->getCRC();
+}
+
 STMFDParams ParserTileHandler::getDefaultSTMFDParams( const char* paramString ) const {
 
    uint32 layers = STMFDParams::DEFAULT_LAYERS;
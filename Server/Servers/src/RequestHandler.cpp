@@ -18,6 +18,49 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include "Packet.h"
 #include "RequestTime.h"
 #include "DebugClock.h"
+#include "LatencyStatistics.h"
+#include "TimeUtility.h"
+
+namespace {
+
+/**
+ * Adds the latencies of a request packet to the LatencyStatistics.
+ * Only packets that were not resent are added, the server timestamp
+ * of the others is the time of the last resend.
+ *
+ * @param request The request packet.
+ * @param reply   The answer to request.
+ */
+void addLatencies( const PacketContainer& request, const Packet& reply ) {
+   if ( request.getServerResend() != 0 || reply.getArrivalTime() == 0 ) {
+      return;
+   }
+   const uint16 subType = request.getPacket()->getSubType();
+   const uint32 now = TimeUtility::getCurrentTime();
+   const uint32 sent = request.getServerTimestamp();
+   LatencyStatistics& latency = LatencyStatistics::getInstance();
+
+   latency.add( subType, LatencyStatistics::TOTAL, now - sent );
+   latency.add( subType, LatencyStatistics::REPLY_QUEUE,
+                now - reply.getArrivalTime() );
+
+   if ( ! ( reply.getTraceFlags() & Packet::TRACE_MODULE_TIMES ) ) {
+      return;
+   }
+   const uint32 sendQueue = reply.getTraceSendQueueTime();
+   const uint32 moduleQueue = reply.getTraceModuleQueueTime();
+   const uint32 processing = reply.getDebInfo();
+   // What is left of the round trip is spent on the network.
+   const uint32 known = sendQueue + moduleQueue + processing;
+   const uint32 roundTrip = reply.getArrivalTime() - sent;
+   latency.add( subType, LatencyStatistics::SERVER_SEND_QUEUE, sendQueue );
+   latency.add( subType, LatencyStatistics::NETWORK,
+                roundTrip > known ? roundTrip - known : 0 );
+   latency.add( subType, LatencyStatistics::MODULE_QUEUE, moduleQueue );
+   latency.add( subType, LatencyStatistics::PROCESSING, processing );
+}
+
+}
 
 PacketContainer* 
 RequestHandler::getPacketAnswer() {
@@ -281,6 +324,7 @@ void RequestHandler::RequestThread::run() {
          if ( cont != NULL ) {
 
             cont->setModuleType( pc->getModuleType() );
+            addLatencies( *pc, *cont->getPacket() );
             rc = m_handler->processPacket( cont );
             if ( rc != NULL ) {
                // Return done request
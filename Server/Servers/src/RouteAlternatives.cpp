@@ -0,0 +1,60 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "RouteAlternatives.h"
+
+#include "ServerSubRouteVector.h"
+#include "SubRoute.h"
+
+void
+RouteAlternatives::insert( ServerSubRouteVector& finished,
+                           SubRoute* subRoute )
+{
+   finished.insertSubRoute( subRoute, false );
+   m_indices.push_back( finished.getSize() - 1 );
+}
+
+uint32
+RouteAlternatives::appendTo( ServerSubRouteVector& finished,
+                             ServerSubRouteVectorVector& routes ) const
+{
+   if ( m_indices.empty() || routes.empty() ||
+        finished.getNbrDest() == 0 ||
+        finished.getDestIndexArray()[ 0 ] == MAX_UINT32 ) {
+      return 0;
+   }
+   const uint32 bestPrevID =
+      finished[ finished.getDestIndexArray()[ 0 ] ]->getPrevSubRouteID();
+
+   uint32 nbrAppended = 0;
+   for ( uint32 i = 0; i < m_indices.size(); ++i ) {
+      if ( finished[ m_indices[ i ] ]->getPrevSubRouteID() != bestPrevID ) {
+         continue;
+      }
+      ServerSubRouteVector* route =
+         finished.getResultVectorFrom( m_indices[ i ] );
+      if ( route->size() != 0 ) {
+         routes.push_back( route );
+         ++nbrAppended;
+      } else {
+         delete route;
+      }
+   }
+   return nbrAppended;
+}
+
+uint32
+RouteAlternatives::size() const
+{
+   return m_indices.size();
+}
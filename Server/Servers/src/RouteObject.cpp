@@ -28,6 +28,7 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include "TimeUtility.h"
 #include "Math.h"
 #include "STLUtility.h"
+#include "RouteRejoin.h"
 
 #include <algorithm>
 
@@ -83,6 +84,10 @@ RouteObject::RouteObject( const RequestUserData& user,
    memset( &m_origPoint, 0, sizeof( origDestFinalPoint_t ) );
    memset( &m_destPoint, 0, sizeof( origDestFinalPoint_t ) );
    m_allowedMaps = NULL;
+   m_rerouteBase = NULL;
+   m_nbrAlternatives = 0;
+   m_rejoinList = NULL;
+   m_rejoin = NULL;
    mc2dbg2 << ROU << "dist = " << disturbances << endl;
 
    if (m_expandType == 0) {
@@ -370,6 +375,8 @@ RouteObject::~RouteObject()
 
    delete m_origList;
    delete m_destList;
+   delete m_rejoinList;
+   delete m_rejoin;
 
    delete m_unexpandedRoute;
    delete m_routeResultVector;
@@ -730,89 +737,7 @@ RouteObject::processPacket( const PacketContainer* packetContainer )
          
          // If RouteSender is finished routing and take care of the answer.
          if ( m_routeSender->requestDone() == true ) {
-            if ( m_routeSender->getStatus() == StringTable::OK ) {
-               // In the future, it will be possible to get more
-               // than one route here.
-               ServerSubRouteVectorVector* SRVV =
-                  m_routeSender->getSortedRoute();
-
-               // Fix the offsets.
-               for(uint32 i = 0; i < SRVV->size(); ++i ) {
-                  ServerSubRouteVector* srVect = (*SRVV)[i];
-                  if ( srVect->getSize() > 0 ) {
-                     SubRoute* firstSR = srVect->getSubRouteAt( 0 );
-                     // Fixing the offsets, which were manipulated to be on the
-                     // form that the RouteModule requires
-                     if ( firstSR->getOrigNodeID() & 0x80000000 ){
-                        firstSR->setOrigOffset(1.0-firstSR->getOrigOffset() );
-                     }
-                     SubRoute* lastSR = srVect->getSubRouteAt(
-                        srVect->getSize() - 1 );
-                     if ( lastSR->getDestNodeID() & 0x80000000 ){
-                        lastSR->setDestOffset( 1.0 - lastSR->getDestOffset() );
-                     }
-                  }
-               }
-               ServerSubRouteVector* srVect =
-                  SRVV->empty() ? NULL : SRVV->front();
-               // Only handle RouteReply if there is something in
-               // the vector and we should expand the route.
-               if ( srVect != NULL &&
-                    srVect->getSize() > 0 ) {
-                  mc2dbg1 << ROU << "[RO]: Size of srVect = "
-                         << srVect->getSize();
-                  mc2dbg4 << " Cost of first "
-                          << srVect->front()->getCost();
-                  mc2dbg2 << " Cost of last " << srVect->back()->getCost();
-                  uint32 secs =
-                     Connection::timeCostToSec(srVect->back()->getCost());
-                  mc2dbg2 << " Number of seconds "
-                          << secs;
-                  mc2dbg2 << " That is " << (secs / 60)
-                          << " minutes and " <<  (secs % 60) << " sec";
-                  mc2dbg4 << " Time : " << srVect->getTotalTimeSec(false);
-                  mc2dbg1 << " Routing time: "
-                          << (TimeUtility::getCurrentTime()-m_routingStartTime)
-                          << endl;
-                  if ( m_expandType != 0 ) {
-                     RouteReplyPacket* p = 
-                        new RouteReplyPacket(m_driverPref, *srVect);
-                     m_state = handleRouteReplyPacket( p );
-                     delete p;
-                  } else {
-
-                     // To store the packet.
-                     m_routeReplyPacket = new RouteReplyPacket(m_driverPref,
-                                                               *srVect);
-                  }
-                  
-               } else {
-                  mc2log << info << ROU 
-                         << "No route was found to the destination"
-                         << endl;
-                  m_state = setErrorState( StringTable::ERROR_NO_ROUTE );
-               }
-               // Remove unwanted routes.
-               if ( m_nbrWantedRoutes != MAX_UINT32 )
-                  fixupRouteResult(SRVV, m_nbrWantedRoutes);
-               
-               m_routeResultVector = SRVV;
-
-               if ( srVect ) {
-                  m_unexpandedRoute = new UnexpandedRoute(*srVect,
-                                                          *m_driverPref);
-               } else {
-                  m_unexpandedRoute = NULL;
-               }
-               if ( m_expandType == 0 ) {
-                  // That concludes it - we're done.
-                  if ( m_status == StringTable::TIMEOUT_ERROR)
-                     m_status = StringTable::OK;
-                  m_state = DONE;
-               }
-            } else {
-               m_state = setErrorState( m_routeSender->getStatus() );
-            }
+            handleFinishedRouting();
          }
       }
       break;
@@ -1822,9 +1747,17 @@ RouteObject::fixupRouteResult(ServerSubRouteVectorVector* srvv,
    // FIXME: Only go through the vector until we have the right number
    //        of routes left. After that we will remove the unneeded
    //        routes from the back instead.
+   // The alternative routes share the destination of the best route,
+   // keep them aside and put them back after it.
+   vector<ServerSubRouteVector*> alternatives;
    ServerSubRouteVectorVector::iterator it = srvv->begin();
    while ( it != srvv->end() ) {
       SubRouteVector* srv = *it;
+      if ( srv->back()->getAlternative() != 0 ) {
+         alternatives.push_back( *it );
+         it = srvv->erase( it );
+         continue;
+      }
       // Compare itemID - not nodeID
       IDPair_t idpair(srv->back()->getNextMapID(),
                       srv->back()->getDestNodeID() & 0x7fffffff);
@@ -1858,6 +1791,7 @@ RouteObject::fixupRouteResult(ServerSubRouteVectorVector* srvv,
       delete srv;
       srvv->pop_back();
    }
+   srvv->insert( srvv->end(), alternatives.begin(), alternatives.end() );
    
    mc2dbg2 << ROU << "Size of route vector vector is now " << srvv->size() 
            << endl;
@@ -1924,6 +1858,192 @@ RouteObject::calcMinDistFromOrigsToDest(const OrigDestInfoList& origs,
    return int(::sqrt(minDist));
 }
 
+RouteObject::state_t
+RouteObject::startRouteSender()
+{
+   // Route to the old route if rerouting, else to the destinations.
+   OrigDestInfoList* dests = m_rejoinList != NULL ? m_rejoinList : m_destList;
+
+   // Calc the nbr of routes needed to satisfy the user.
+   uint32 nbrRoutesToCalc = calcNbrWantedRoutes(m_nbrWantedRoutes);
+   // If we have both origins and destinations, create a RouteSender
+   // and start getting packets from it.     
+   m_routingStartTime = TimeUtility::getCurrentTime();
+   m_routeSender = new RouteSender( m_user,
+                                    m_request,
+                                    m_origList,
+                                    dests,
+                                    NULL,
+                                    m_driverPref,
+                                    m_routingInfo,
+                                    calcMinDistFromOrigsToDest(*m_origList,
+                                                               *dests),
+                                    m_disturbances,
+                                    nbrRoutesToCalc,
+                                    0,MAX_UINT32,false,false,NULL,
+                                    m_allowedMaps,
+                                    // No alternatives to the old route
+                                    m_rejoinList != NULL ?
+                                    0 : m_nbrAlternatives
+                                    );
+   PacketContainer* pc = m_routeSender->getNextPacket();
+   while (pc != NULL) {
+      m_packetsReadyToSend.add( pc );
+      pc = m_routeSender->getNextPacket( );
+   }
+      
+   if ( m_routeSender->getStatus() == StringTable::OK ) {
+      if ( m_routeSender->requestDone() ) {
+         // The route was cached, no packets to wait for.
+         handleFinishedRouting();
+         return m_state;
+      }
+      return (SENDING_ROUTE);
+   } else {
+      return setErrorState( m_routeSender->getStatus() );
+   }
+}
+
+bool
+RouteObject::prepareReroute()
+{
+   m_rejoin = new RouteRejoin( *m_rerouteBase, *m_driverPref,
+                               *m_origList, *m_destList );
+   if ( ! m_rejoin->isValid() ) {
+      clearReroute();
+      return false;
+   }
+
+   m_rejoinList = new OrigDestInfoList;
+   m_rejoinList->addOrigDestInfo( m_rejoin->getRejoinPoint( m_driverPref ) );
+   const OrigDestInfo& rejoin = m_rejoinList->front();
+   mc2log << info << ROU << "[RO]: Rerouting to "
+          << MC2HEX( rejoin.getMapID() ) << ":"
+          << MC2HEX( rejoin.getNodeID() ) << " reusing "
+          << ( m_rerouteBase->getSize() - m_rejoin->getRejoinIndex() - 1 )
+          << " of " << m_rerouteBase->getSize()
+          << " SubRoutes of the old route" << endl;
+   return true;
+}
+
+void
+RouteObject::clearReroute()
+{
+   delete m_rejoinList;
+   m_rejoinList = NULL;
+   delete m_rejoin;
+   m_rejoin = NULL;
+}
+
+void
+RouteObject::handleFinishedRouting()
+{
+   // In the future, it will be possible to get more
+   // than one route here.
+   ServerSubRouteVectorVector* SRVV = NULL;
+   if ( m_routeSender->getStatus() == StringTable::OK ) {
+      SRVV = m_routeSender->getSortedRoute();
+   }
+   if ( m_rejoin != NULL &&
+        m_routeSender->getStatus() != StringTable::TIMEOUT_ERROR &&
+        ( SRVV == NULL || SRVV->empty() || SRVV->front()->getSize() == 0 ) ) {
+      // Could not get back to the old route, route the whole way.
+      mc2log << info << ROU << "[RO]: No route to the old route, "
+             << "routing the whole way" << endl;
+      delete SRVV;
+      delete m_routeSender;
+      m_routeSender = NULL;
+      clearReroute();
+      m_state = startRouteSender();
+      return;
+   }
+
+   if ( m_routeSender->getStatus() == StringTable::OK ) {
+
+      // Fix the offsets.
+      for(uint32 i = 0; i < SRVV->size(); ++i ) {
+         ServerSubRouteVector* srVect = (*SRVV)[i];
+         if ( srVect->getSize() > 0 ) {
+            SubRoute* firstSR = srVect->getSubRouteAt( 0 );
+            // Fixing the offsets, which were manipulated to be on the
+            // form that the RouteModule requires
+            if ( firstSR->getOrigNodeID() & 0x80000000 ){
+               firstSR->setOrigOffset(1.0-firstSR->getOrigOffset() );
+            }
+            SubRoute* lastSR = srVect->getSubRouteAt(
+               srVect->getSize() - 1 );
+            if ( lastSR->getDestNodeID() & 0x80000000 ){
+               lastSR->setDestOffset( 1.0 - lastSR->getDestOffset() );
+            }
+         }
+      }
+      if ( m_rejoin != NULL ) {
+         ServerSubRouteVector* joined = m_rejoin->join( *SRVV->front() );
+         delete SRVV->front();
+         SRVV->front() = joined;
+      }
+      ServerSubRouteVector* srVect =
+         SRVV->empty() ? NULL : SRVV->front();
+      // Only handle RouteReply if there is something in
+      // the vector and we should expand the route.
+      if ( srVect != NULL &&
+           srVect->getSize() > 0 ) {
+         mc2dbg1 << ROU << "[RO]: Size of srVect = "
+                << srVect->getSize();
+         mc2dbg4 << " Cost of first "
+                 << srVect->front()->getCost();
+         mc2dbg2 << " Cost of last " << srVect->back()->getCost();
+         uint32 secs =
+            Connection::timeCostToSec(srVect->back()->getCost());
+         mc2dbg2 << " Number of seconds "
+                 << secs;
+         mc2dbg2 << " That is " << (secs / 60)
+                 << " minutes and " <<  (secs % 60) << " sec";
+         mc2dbg4 << " Time : " << srVect->getTotalTimeSec(false);
+         mc2dbg1 << " Routing time: "
+                 << (TimeUtility::getCurrentTime()-m_routingStartTime)
+                 << endl;
+         if ( m_expandType != 0 ) {
+            RouteReplyPacket* p = 
+               new RouteReplyPacket(m_driverPref, *srVect);
+            m_state = handleRouteReplyPacket( p );
+            delete p;
+         } else {
+
+            // To store the packet.
+            m_routeReplyPacket = new RouteReplyPacket(m_driverPref,
+                                                      *srVect);
+         }
+         
+      } else {
+         mc2log << info << ROU 
+                << "No route was found to the destination"
+                << endl;
+         m_state = setErrorState( StringTable::ERROR_NO_ROUTE );
+      }
+      // Remove unwanted routes.
+      if ( m_nbrWantedRoutes != MAX_UINT32 )
+         fixupRouteResult(SRVV, m_nbrWantedRoutes);
+      
+      m_routeResultVector = SRVV;
+
+      if ( srVect ) {
+         m_unexpandedRoute = new UnexpandedRoute(*srVect,
+                                                 *m_driverPref);
+      } else {
+         m_unexpandedRoute = NULL;
+      }
+      if ( m_expandType == 0 ) {
+         // That concludes it - we're done.
+         if ( m_status == StringTable::TIMEOUT_ERROR)
+            m_status = StringTable::OK;
+         m_state = DONE;
+      }
+   } else {
+      m_state = setErrorState( m_routeSender->getStatus() );
+   }
+}
+
 RouteObject::state_t
 RouteObject::createAndPrepareRoutePacket(bool checkProcessed) 
 {
@@ -2067,37 +2187,11 @@ RouteObject::createAndPrepareRoutePacket(bool checkProcessed)
                                         *m_destList);
    
    if ( (m_origList->size() > 0) && (m_destList->size() > 0) && allowed ) {
-
-      // Calc the nbr of routes needed to satisfy the user.
-      uint32 nbrRoutesToCalc = calcNbrWantedRoutes(m_nbrWantedRoutes);
-      // If we have both origins and destinations, create a RouteSender
-      // and start getting packets from it.     
-      m_routingStartTime = TimeUtility::getCurrentTime();
-      m_routeSender = new RouteSender( m_user,
-                                       m_request,
-                                       m_origList,
-                                       m_destList,
-                                       NULL,
-                                       m_driverPref,
-                                       m_routingInfo,
-                                       calcMinDistFromOrigsToDest(*m_origList,
-                                                                  *m_destList),
-                                       m_disturbances,
-                                       nbrRoutesToCalc,
-                                       0,MAX_UINT32,false,false,NULL,
-                                       m_allowedMaps
-                                       );
-      PacketContainer* pc = m_routeSender->getNextPacket();
-      while (pc != NULL) {
-         m_packetsReadyToSend.add( pc );
-         pc = m_routeSender->getNextPacket( );
-      }
-      
-      if ( m_routeSender->getStatus() == StringTable::OK ) {
-         return (SENDING_ROUTE);
-      } else {
-         return setErrorState( m_routeSender->getStatus() );
+      if ( m_rerouteBase != NULL && ! prepareReroute() ) {
+         mc2log << info << ROU << "[RO]: Old route can not be reused, "
+                << "routing the whole way" << endl;
       }
+      return startRouteSender();
    } else if ( m_origList->size() == 0 ){
       // No routing if we have no origins or no destinations
       mc2log << error << ROU 
@@ -0,0 +1,162 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "RouteRejoin.h"
+
+#include "ServerSubRouteVector.h"
+#include "SubRoute.h"
+#include "OrigDestInfo.h"
+
+#include <math.h>
+
+namespace {
+/// The cost of a SubRoute after the rejoin point of the old route.
+uint32 tailCost( uint32 newRejoinCost, uint32 oldCost, uint32 oldRejoinCost )
+{
+   return newRejoinCost +
+      ( oldCost > oldRejoinCost ? oldCost - oldRejoinCost : 0 );
+}
+}
+
+RouteRejoin::RouteRejoin( const ServerSubRouteVector& oldRoute,
+                          const DriverPref& pref,
+                          const OrigDestInfoList& origs,
+                          const OrigDestInfoList& dests )
+      : m_oldRoute( oldRoute.getCopy() ),
+        m_rejoinIdx( MAX_UINT32 ),
+        m_origLat( MAX_INT32 ),
+        m_origLon( MAX_INT32 )
+{
+   m_oldRoute->attachVehicles( pref );
+   if ( origs.size() > 0 ) {
+      m_origLat = origs.front().getLat();
+      m_origLon = origs.front().getLon();
+   }
+
+   // The last SubRoute is on the map of the destination, so rejoining
+   // there would not save anything.
+   if ( m_oldRoute->getSize() < 2 || ! endsAt( *m_oldRoute, dests ) ) {
+      return;
+   }
+
+   for ( uint32 i = 0; i < m_oldRoute->getSize() - 1; ++i ) {
+      uint32 mapID = m_oldRoute->getSubRouteAt( i )->getThisMapID();
+      for ( OrigDestInfoList::const_iterator it = origs.begin();
+            it != origs.end(); ++it ) {
+         if ( it->getMapID() == mapID ) {
+            m_rejoinIdx = i;
+            break;
+         }
+      }
+   }
+}
+
+RouteRejoin::~RouteRejoin()
+{
+   delete m_oldRoute;
+}
+
+bool
+RouteRejoin::isValid() const
+{
+   return m_rejoinIdx != MAX_UINT32;
+}
+
+uint32
+RouteRejoin::getRejoinIndex() const
+{
+   return m_rejoinIdx;
+}
+
+OrigDestInfo
+RouteRejoin::getRejoinPoint( const DriverPref* pref ) const
+{
+   const SubRoute* rejoin = m_oldRoute->getSubRouteAt( m_rejoinIdx );
+   int32 lat = rejoin->getDestLat();
+   int32 lon = rejoin->getDestLon();
+   if ( lat == MAX_INT32 ) {
+      // The origin is on the map before, close enough to keep the
+      // RouteSender from going to higher levels.
+      lat = m_origLat;
+      lon = m_origLon;
+   }
+   return OrigDestInfo( pref, rejoin->getNextMapID(),
+                        rejoin->getDestNodeID(), lat, lon, 0.0 );
+}
+
+ServerSubRouteVector*
+RouteRejoin::join( const ServerSubRouteVector& route ) const
+{
+   const SubRoute* rejoin = m_oldRoute->getSubRouteAt( m_rejoinIdx );
+   const SubRoute* tail = m_oldRoute->getSubRouteAt( m_rejoinIdx + 1 );
+   // The RouteSender ends the route with a SubRoute from the rejoin
+   // node to itself on the next map. The tail starts there instead.
+   uint32 nbrNew = route.getSize();
+   const SubRoute* last = route.getSubRouteAt( nbrNew - 1 );
+   if ( nbrNew > 1 && last->getThisMapID() == tail->getThisMapID() &&
+        last->getOrigNodeID() == tail->getOrigNodeID() ) {
+      --nbrNew;
+   }
+
+   ServerSubRouteVector* joined = new ServerSubRouteVector;
+   joined->setOriginalDestIndex( route.getOriginalDestIndex() );
+   for ( uint32 i = 0; i < nbrNew; ++i ) {
+      joined->insertSubRoute( new SubRoute( *route.getSubRouteAt( i ) ) );
+   }
+   // The offset fixing has treated the rejoin node as the end.
+   joined->back()->setDestOffset( 0.0 );
+
+   // The costs of the old route are from its origin.
+   const SubRoute newRejoin( *joined->back() );
+   for ( uint32 i = m_rejoinIdx + 1; i < m_oldRoute->getSize(); ++i ) {
+      const SubRoute* old = m_oldRoute->getSubRouteAt( i );
+      SubRoute* subRoute = new SubRoute( *old );
+      subRoute->setCost( tailCost( newRejoin.getCost(), old->getCost(),
+                                   rejoin->getCost() ) );
+      subRoute->setCostASum( tailCost( newRejoin.getCostASum(),
+                                       old->getCostASum(),
+                                       rejoin->getCostASum() ) );
+      subRoute->setCostBSum( tailCost( newRejoin.getCostBSum(),
+                                       old->getCostBSum(),
+                                       rejoin->getCostBSum() ) );
+      subRoute->setCostCSum( tailCost( newRejoin.getCostCSum(),
+                                       old->getCostCSum(),
+                                       rejoin->getCostCSum() ) );
+      subRoute->setPrevSubRouteID( joined->back()->getSubRouteID() );
+      joined->insertSubRoute( subRoute );
+   }
+   return joined;
+}
+
+bool
+RouteRejoin::endsAt( const SubRouteVector& route,
+                     const OrigDestInfoList& dests )
+{
+   const SubRoute* last = route.back();
+   for ( OrigDestInfoList::const_iterator it = dests.begin();
+         it != dests.end(); ++it ) {
+      // The destinations have both node 0 and node 1 of the item with
+      // the offset from their node.
+      float offset = it->getOffset();
+      if ( it->getNodeID() & 0x80000000 ) {
+         offset = 1.0 - offset;
+      }
+      if ( it->getMapID() == last->getNextMapID() &&
+           ( it->getNodeID() & 0x7fffffff ) ==
+           ( last->getDestNodeID() & 0x7fffffff ) &&
+           fabs( offset - last->getDestOffset() ) < 0.01 ) {
+         return true;
+      }
+   }
+   return false;
+}
@@ -156,6 +156,11 @@ RouteRequest::prepareRouteObject(bool expand, bool costC)
                            m_data->m_avoidTollRoads,
                            m_data->m_avoidHighways );
    ro->setAllowedMaps( m_data->m_allowedMaps );
+   // The route without traffic is a reference, route it the whole way.
+   if ( costC ) {
+      ro->setRerouteBase( m_data->m_rerouteBase );
+      ro->setNbrAlternatives( m_data->m_nbrAlternatives );
+   }
 
    // Add the origins.
    for( uint32 i = 0; i < m_data->m_origins.size(); ++i ) {
@@ -1113,6 +1118,18 @@ RouteRequest::setAllowedMaps( RouteAllowedMap* maps )
    m_data->m_allowedMaps = maps;
 }
 
+void 
+RouteRequest::setRerouteBase( const ServerSubRouteVector* oldRoute )
+{
+   m_data->m_rerouteBase = oldRoute;
+}
+
+void 
+RouteRequest::setNbrAlternatives( uint32 nbrAlternatives )
+{
+   m_data->m_nbrAlternatives = nbrAlternatives;
+}
+
 void 
 RouteRequest::setRemoveAheadIfDiff( bool removeAheadIfDiff)
 {
@@ -61,4 +61,6 @@ void RouteRequestData::init()
 
    m_originalDest   = NULL;
    m_originalOrigin = NULL;
+   m_rerouteBase    = NULL;
+   m_nbrAlternatives = 0;
 }
@@ -0,0 +1,255 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "RouteResultCache.h"
+
+#include "ServerSubRouteVector.h"
+#include "SubRoute.h"
+#include "OrigDestInfo.h"
+#include "DriverPref.h"
+#include "UserData.h"
+#include "Properties.h"
+#include "DeleteHelpers.h"
+
+RouteResultCache::Key::Key( const UserUser* user,
+                            const OrigDestInfoList& origs,
+                            const OrigDestInfoList& dests,
+                            const DriverPref& pref,
+                            uint32 nbrBestDests,
+                            uint32 ttl )
+{
+   addOrigDests( origs );
+   addOrigDests( dests );
+
+   m_words.push_back( pref.getVehicleRestriction() );
+   m_words.push_back( pref.getRoutingCosts() );
+   m_words.push_back( pref.useUturn() );
+   // Routes starting within the same period share the traffic.
+   m_words.push_back( ttl == 0 ? pref.getTime() : pref.getTime() / ttl );
+   m_words.push_back( pref.getIsStartTime() );
+   m_words.push_back( pref.avoidTollRoads() );
+   m_words.push_back( pref.avoidHighways() );
+   m_words.push_back( pref.getMinWaitTime() );
+   m_words.push_back( nbrBestDests );
+
+   if ( user != NULL ) {
+      const MapRights mask( MapRights::TRAFFIC_AND_SPEEDCAM );
+      const UserUser::regionRightMap_t& rights =
+         user->getRegionRightsCache();
+      for ( UserUser::regionRightMap_t::const_iterator it = rights.begin();
+            it != rights.end(); ++it ) {
+         MapRights trafficRights = it->second & mask;
+         if ( trafficRights ) {
+            m_rights.push_back( make_pair( it->first, trafficRights ) );
+         }
+      }
+   } else {
+      // Same as UserRightsMapInfo, all is allowed.
+      m_rights.push_back( make_pair( MAX_UINT32, ~MapRights() ) );
+   }
+}
+
+void
+RouteResultCache::Key::addOrigDests( const OrigDestInfoList& list )
+{
+   m_words.push_back( list.size() );
+   for ( OrigDestInfoList::const_iterator it = list.begin();
+         it != list.end(); ++it ) {
+      m_words.push_back( it->getMapID() );
+      m_words.push_back( it->getNodeID() );
+      m_words.push_back( uint32( it->getOffset() * MAX_UINT16 + 0.5 ) );
+      m_words.push_back( it->getAngle() );
+   }
+}
+
+bool
+RouteResultCache::Key::operator < ( const Key& other ) const
+{
+   if ( m_words != other.m_words ) {
+      return m_words < other.m_words;
+   }
+   return m_rights < other.m_rights;
+}
+
+RouteResultCache::RouteResultCache( uint32 maxNbrEntries, uint32 ttl )
+      : m_maxNbrEntries( maxNbrEntries ),
+        m_ttl( ttl ),
+        m_hits( 0 ),
+        m_misses( 0 ),
+        m_invalidations( 0 )
+{
+}
+
+RouteResultCache::~RouteResultCache()
+{
+   while ( ! m_entries.empty() ) {
+      erase( m_entries.begin() );
+   }
+}
+
+RouteResultCache&
+RouteResultCache::getInstance()
+{
+   static RouteResultCache
+      cache( Properties::getUint32Property( "ROUTE_CACHE_SIZE",
+                                            DEFAULT_MAX_NBR_ENTRIES ),
+             Properties::getUint32Property( "ROUTE_CACHE_TTL",
+                                            DEFAULT_TTL ) );
+   return cache;
+}
+
+bool
+RouteResultCache::isEnabled() const
+{
+   return m_maxNbrEntries > 0 && m_ttl > 0;
+}
+
+uint32
+RouteResultCache::getTTL() const
+{
+   return m_ttl;
+}
+
+ServerSubRouteVectorVector*
+RouteResultCache::find( const Key& key, const DriverPref& pref, uint32 now )
+{
+   ISABSync sync( m_mutex );
+   Index::iterator found = m_index.find( key );
+   if ( found == m_index.end() ) {
+      ++m_misses;
+      return NULL;
+   }
+   Entries::iterator it = found->second;
+   if ( now - it->created >= m_ttl ) {
+      erase( it );
+      ++m_misses;
+      return NULL;
+   }
+   ++m_hits;
+   // Most recently used first.
+   m_entries.splice( m_entries.begin(), m_entries, it );
+
+   ServerSubRouteVectorVector* result = new ServerSubRouteVectorVector;
+   result->reserve( it->routes.size() );
+   for ( uint32 i = 0; i < it->routes.size(); ++i ) {
+      ServerSubRouteVector* copy = it->routes[ i ]->getCopy();
+      // The vehicles belong to the DriverPref of the request.
+      copy->attachVehicles( pref );
+      result->push_back( copy );
+   }
+   return result;
+}
+
+bool
+RouteResultCache::insert( const Key& key,
+                          const ServerSubRouteVectorVector& routes,
+                          const trafficVersions_t& traffic,
+                          uint32 now )
+{
+   if ( ! isEnabled() ) {
+      return false;
+   }
+
+   ISABSync sync( m_mutex );
+   for ( trafficVersions_t::const_iterator it = traffic.begin();
+         it != traffic.end(); ++it ) {
+      trafficVersions_t::iterator latest = m_traffic.find( it->first );
+      if ( latest == m_traffic.end() ) {
+         m_traffic.insert( *it );
+      } else if ( latest->second != it->second ) {
+         // Traffic has changed while routing.
+         return false;
+      }
+   }
+
+   Index::iterator found = m_index.find( key );
+   if ( found != m_index.end() ) {
+      erase( found->second );
+   }
+
+   Entry newEntry = { key, now };
+   m_entries.push_front( newEntry );
+   Entry& entry = m_entries.front();
+   entry.traffic = traffic;
+   entry.routes.reserve( routes.size() );
+   for ( uint32 i = 0; i < routes.size(); ++i ) {
+      ServerSubRouteVector* copy = routes[ i ]->getCopy();
+      // Do not keep pointers into the DriverPref of the request.
+      copy->detachVehicles();
+      entry.routes.push_back( copy );
+   }
+   m_index.insert( make_pair( key, m_entries.begin() ) );
+
+   evict();
+   return true;
+}
+
+void
+RouteResultCache::updateTraffic( const mapAndRights_t& mapAndRights,
+                                 uint32 trafficCRC )
+{
+   if ( ! isEnabled() ) {
+      return;
+   }
+
+   ISABSync sync( m_mutex );
+   trafficVersions_t::iterator latest = m_traffic.find( mapAndRights );
+   if ( latest == m_traffic.end() ) {
+      m_traffic.insert( make_pair( mapAndRights, trafficCRC ) );
+      return;
+   }
+   if ( latest->second == trafficCRC ) {
+      return;
+   }
+   latest->second = trafficCRC;
+
+   // Remove the routes using the old traffic.
+   for ( Entries::iterator it = m_entries.begin(); it != m_entries.end(); ) {
+      trafficVersions_t::const_iterator used =
+         it->traffic.find( mapAndRights );
+      if ( used != it->traffic.end() && used->second != trafficCRC ) {
+         erase( it++ );
+         ++m_invalidations;
+      } else {
+         ++it;
+      }
+   }
+}
+
+void
+RouteResultCache::erase( Entries::iterator it )
+{
+   STLUtility::deleteValues( it->routes );
+   m_index.erase( it->key );
+   m_entries.erase( it );
+}
+
+void
+RouteResultCache::evict()
+{
+   while ( m_entries.size() > m_maxNbrEntries ) {
+      erase( --m_entries.end() );
+   }
+}
+
+RouteResultCache::Statistics
+RouteResultCache::getStatistics() const
+{
+   ISABSync sync( m_mutex );
+   Statistics stats;
+   stats.hits = m_hits;
+   stats.misses = m_misses;
+   stats.invalidations = m_invalidations;
+   stats.nbrEntries = m_entries.size();
+   return stats;
+}
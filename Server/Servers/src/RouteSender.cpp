@@ -37,6 +37,8 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include "MapBits.h"
 #include "NodeBits.h"
 #include "Math.h"
+#include "TimeUtility.h"
+#include "LoadMapPacket.h"
 
 #include <algorithm>
 #include <set>
@@ -281,6 +283,9 @@ RouteSender::enqueueSubRouteRequest()
                                  m_dontSendSubRoutes,
                                  infoModuleDists );
 
+   // The RouteModule only calculates them for the original request.
+   pack->setNbrAlternatives( m_nbrAlternatives );
+
    // Don't delete the subroutes when the vector is deleted.
    m_nextMapAndSubRouteVector.second.resetAll();
    pack->setRequestID( m_request->getID() );
@@ -320,7 +325,8 @@ RouteSender::RouteSender(const RequestUserData& user,
                          bool calcCostSums /* = false */,
                          bool dontSendSubRoutes,/* = false */
                          set<uint32>* lowerLevelDestMaps, /* = NULL */
-                         RouteAllowedMap* allowedMaps /* = NULL */ )
+                         RouteAllowedMap* allowedMaps, /* = NULL */
+                         uint32 nbrAlternatives /* = 0 */ )
       : m_requestSubRouteContainer(destInfoList),
       m_tooFarSubRouteContainer(),
       // Create subrouteVector with one
@@ -343,7 +349,12 @@ RouteSender::RouteSender(const RequestUserData& user,
       m_routingInfo(routingInfo),
       m_minDistFromOrigToDest( distFromStartToFinish ),
       m_user( user ),
-      m_useTrafficIfC( true )
+      m_useTrafficIfC( true ),
+      m_cacheKey( NULL ),
+      m_cachedRoutes( NULL ),
+      m_trafficRightsCRC( MAX_UINT32 ),
+      m_trafficComplete( true ),
+      m_nbrAlternatives( 0 )
 {
    mc2dbg << RSU << "[RouteSender::RouteSender]: cost (A B C D) = ("
           << uint32(pref->getCostA()) << " "
@@ -407,6 +418,9 @@ RouteSender::RouteSender(const RequestUserData& user,
    if ( nbrBestDests != MAX_UINT32 ) {
       m_calcCostSums      = true;
       m_dontSendSubRoutes = true;
+   } else if ( m_level == 0 && allDestInfoList == NULL ) {
+      // Alternatives only make sense for one route to one destination.
+      m_nbrAlternatives = nbrAlternatives;
    }
 
    // Initialize the allowedMapsStuff
@@ -466,7 +480,116 @@ RouteSender::RouteSender(const RequestUserData& user,
    m_minNbrHighLevelNodes =
       Properties::getUint32Property("ROUTE_MIN_NBR_HIGHLEVELNODES", 16);
 
-   createAndEnqueueSubRouteRequest();
+   // Only the complete route on the lowest level is cached.
+   if ( m_level == 0 && m_status == StringTable::OK &&
+        allDestInfoList == NULL && m_allowedMaps == NULL &&
+        ! calcCostSums && ! dontSendSubRoutes && m_nbrAlternatives == 0 &&
+        ( m_disturbances == NULL ||
+          m_disturbances->getDisturbances()->empty() ) ) {
+      lookupInCache( origInfoList, nbrBestDests );
+   }
+
+   if ( m_cachedRoutes == NULL ) {
+      createAndEnqueueSubRouteRequest();
+      if ( m_level == 0 && m_status == StringTable::OK ) {
+         enqueuePreloadRequests( origInfoList );
+      }
+   }
+}
+
+void
+RouteSender::enqueuePreloadRequests( const OrigDestInfoList* origInfoList )
+{
+   // The maximum number of destination maps to preload.
+   const uint32 maxNbrMaps =
+      Properties::getUint32Property( "ROUTE_PRELOAD_MAPS", 4 );
+   
+   set<uint32> origMaps;
+   for ( OrigDestInfoList::const_iterator it = origInfoList->begin();
+         it != origInfoList->end();
+         ++it ) {
+      origMaps.insert( it->getMapID() );
+   }
+
+   uint32 nbrMaps = 0;
+   for ( set<uint32>::const_iterator it = m_destMaps.begin();
+         it != m_destMaps.end() && nbrMaps < maxNbrMaps;
+         ++it ) {
+      if ( origMaps.count( *it ) != 0 ) {
+         continue;
+      }
+      LoadMapRequestPacket* pack = new LoadMapRequestPacket( *it );
+      pack->setPreload( true );
+      pack->setRequestID( m_request->getID() );
+      pack->setPacketID( m_request->getNextPacketID() );
+      // Nothing waits for the preload, a timeout must not fail the
+      // route. The answer is ignored in processPacket.
+      PacketContainer* pc = new PacketContainer( pack, 0, 0,
+                                                 MODULE_TYPE_ROUTE,
+                                                 1000, 1 );
+      pc->putTimeoutPacket(
+         new LoadMapReplyPacket( *pack, StringTable::TIMEOUT_ERROR, 0 ) );
+      m_outgoingQueue.add( pc );
+      ++nbrMaps;
+   }
+   mc2dbg2 << RSU << "[RS]: Preloading " << nbrMaps
+           << " destination maps" << endl;
+}
+
+void
+RouteSender::lookupInCache( const OrigDestInfoList* origInfoList,
+                            uint32 nbrBestDests )
+{
+   RouteResultCache& cache = RouteResultCache::getInstance();
+   if ( ! cache.isEnabled() ) {
+      return;
+   }
+   m_cacheKey = new RouteResultCache::Key( m_user.getUser(),
+                                           *origInfoList,
+                                           *m_destInfoList,
+                                           *m_driverPref,
+                                           nbrBestDests,
+                                           cache.getTTL() );
+   m_cachedRoutes = cache.find( *m_cacheKey, *m_driverPref,
+                                TimeUtility::getRealTime() );
+   if ( m_cachedRoutes != NULL ) {
+      mc2dbg << RSU << "[RS]: Route found in cache" << endl;
+      m_state = DONE;
+      // Already in the cache.
+      delete m_cacheKey;
+      m_cacheKey = NULL;
+   }
+}
+
+bool
+RouteSender::getTrafficVersions( RouteResultCache::trafficVersions_t&
+                                 versions ) const
+{
+   if ( ! m_useTrafficIfC || ! m_trafficComplete ) {
+      return false;
+   }
+   versions.insert( m_trafficVersions.begin(), m_trafficVersions.end() );
+   if ( m_higherLevelRouteSender != NULL ) {
+      return m_higherLevelRouteSender->getTrafficVersions( versions );
+   }
+   return true;
+}
+
+void
+RouteSender::insertInCache( const ServerSubRouteVectorVector& routes )
+{
+   if ( m_cacheKey == NULL ) {
+      return;
+   }
+   RouteResultCache::trafficVersions_t versions;
+   if ( m_status == StringTable::OK && ! routes.empty() &&
+        getTrafficVersions( versions ) ) {
+      RouteResultCache::getInstance().insert( *m_cacheKey, routes, versions,
+                                              TimeUtility::getRealTime() );
+   }
+   // Only once.
+   delete m_cacheKey;
+   m_cacheKey = NULL;
 }
 
 RouteSender::~RouteSender() 
@@ -476,6 +599,8 @@ RouteSender::~RouteSender()
    delete m_higherOrigList;
    delete m_levelTransitObject;
    delete m_routingCostTable;
+   delete m_cacheKey;
+   delete m_cachedRoutes;
 
    m_nextMapAndSubRouteVector.second.resetAll();
 
@@ -593,7 +718,13 @@ RouteSender::processStartRouting( SubRouteVector* srv )
             
       // It used to say m_level > 0 here, but we don't know
       // if we're done until we have tried all maps.
-      if ( isDest ) {
+      if ( incomingSubRouteVector[subRouteCounter]->getAlternative() != 0 ) {
+         // Alternative routes to the destination must not compete
+         // with the best one, keep them aside for getRoute.
+         m_alternatives.insert( m_finishedServerSubRouteVector,
+                                incomingSubRouteVector[subRouteCounter] );
+         incomingSubRouteVector.resetIndex( subRouteCounter );
+      } else if ( isDest ) {
          // Finished routes go into the vector.
          // Also sets the subRouteID of the route.
          m_finishedServerSubRouteVector.insertSubRoute(
@@ -1402,6 +1533,8 @@ RouteSender::prepareGettingTraffic( uint32 mapID )
       new RouteTrafficCostRequestPacket( m_user.getUser(),
                                          mapID, // map id
                                          ++m_packetCounter );
+   // Only one traffic request at the time.
+   m_trafficRightsCRC = rtcrp->getRightsCRC();
    
    // Set ID:s
    rtcrp->setRequestID( m_request->getID() );
@@ -1446,6 +1579,18 @@ RouteSender::processTrafficReplyPacket( const Packet* packet )
       m_useTrafficIfC = false;
    }
 
+   if ( rtcrp->getStatus() == StringTable::OK ) {
+      // Remember the traffic used and let the cache know about it.
+      RouteResultCache::mapAndRights_t mapAndRights( mapID,
+                                                     m_trafficRightsCRC );
+      uint32 trafficCRC = rtcrp->getTrafficCRC();
+      m_trafficVersions[ mapAndRights ] = trafficCRC;
+      RouteResultCache::getInstance().updateTraffic( mapAndRights,
+                                                     trafficCRC );
+   } else {
+      m_trafficComplete = false;
+   }
+
    MC2_ASSERT( mapID == m_nextMapAndSubRouteVector.first );
 
    // Never request info on this map again.
@@ -1517,6 +1662,11 @@ RouteSender::processPacket( const PacketContainer* p)
       return;
    }
    
+   if ( p->getPacket()->getSubType() == Packet::PACKETTYPE_LOADMAPREPLY ) {
+      // Answer to a preload or its timeout, not counted as outstanding.
+      return;
+   }
+
    m_nbrOutstanding--;
 
    // Check the state, and distribute the packet accordingly
@@ -1660,14 +1810,25 @@ RouteSender::getNextPacket()
    if (m_outgoingQueue.getMin() == NULL) {
       return NULL;
    } else {
-      m_nbrOutstanding++;
-      return m_outgoingQueue.extractMin();
+      PacketContainer* pc = m_outgoingQueue.extractMin();
+      // The routing does not wait for preloads.
+      if ( pc->getPacket()->getSubType() !=
+           Packet::PACKETTYPE_LOADMAPREQUEST ) {
+         m_nbrOutstanding++;
+      }
+      return pc;
    }
 }
 
 ServerSubRouteVectorVector*
 RouteSender::getRoute()
 {
+   if ( m_cachedRoutes != NULL ) {
+      ServerSubRouteVectorVector* returnVector = m_cachedRoutes;
+      m_cachedRoutes = NULL;
+      return returnVector;
+   }
+
    ServerSubRouteVectorVector* returnVector = new ServerSubRouteVectorVector;
 
    // Make room for the routes.
@@ -1693,6 +1854,15 @@ RouteSender::getRoute()
          
    }
 
+   // Add the alternatives after the best route.
+   if ( m_alternatives.size() != 0 ) {
+      uint32 nbrAlternatives =
+         m_alternatives.appendTo( m_finishedServerSubRouteVector,
+                                  *returnVector );
+      mc2dbg << RSU << "[RS]: " << nbrAlternatives
+             << " alternative routes" << endl;
+   }
+
    // Print visited maps.
    if ( true ) {
       mc2dbg << RSU << "[RS]: Visited Maps : ";
@@ -1715,6 +1885,8 @@ RouteSender::getRoute()
       }
       mc2dbg << endl;
    }
+
+   insertInCache( *returnVector );
    
    return returnVector;
 }
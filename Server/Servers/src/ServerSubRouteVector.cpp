@@ -18,6 +18,8 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include "SubRoute.h"
 #include "OverviewMap.h"
 #include "IDPairVector.h"
+#include "DriverPref.h"
+#include "Vehicle.h"
 
 // Temporary function for testing
 
@@ -257,11 +259,93 @@ ServerSubRouteVector::resetAll( )
    }
 }
 
+ServerSubRouteVector*
+ServerSubRouteVector::getCopy() const
+{
+   ServerSubRouteVector* copy = new ServerSubRouteVector( m_maxNbrDest );
+   copy->reserve( size() );
+   for ( const_iterator it = begin(); it != end(); ++it ) {
+      // Not insertSubRoute since it renumbers the SubRoutes.
+      copy->push_back( *it == NULL ? NULL : new SubRoute( **it ) );
+      copy->m_ownedByMe.push_back( true );
+   }
+   for ( uint32 i = 0; i < m_maxNbrDest; ++i ) {
+      copy->m_destIndexArray[ i ] = m_destIndexArray[ i ];
+   }
+   copy->m_nbrDest = m_nbrDest;
+   copy->m_prevSubRouteVectorIndex = m_prevSubRouteVectorIndex;
+   copy->m_externalCutOff = m_externalCutOff;
+   copy->setOriginalDestIndex( getOriginalDestIndex() );
+   copy->m_vehicleMasks = m_vehicleMasks;
+   return copy;
+}
+
+namespace {
+/// Finds the vehicle of pref with the mask.
+const Vehicle* findVehicle( const DriverPref& pref, uint32 mask )
+{
+   if ( mask == MAX_UINT32 ) {
+      return NULL;
+   }
+   for ( int i = 0; i < pref.getNbrVehicles(); ++i ) {
+      if ( pref.getVehicle( i )->getVehicleMask() == mask ) {
+         return pref.getVehicle( i );
+      }
+   }
+   return pref.getBestVehicle();
+}
+}
+
+void
+ServerSubRouteVector::detachVehicles()
+{
+   m_vehicleMasks.clear();
+   m_vehicleMasks.reserve( size() * 2 );
+   for ( iterator it = begin(); it != end(); ++it ) {
+      SubRoute* subRoute = *it;
+      const Vehicle* orig = subRoute->getOrigVehicle();
+      const Vehicle* dest = subRoute->getDestInfo()->getVehicle();
+      m_vehicleMasks.push_back( orig == NULL ? MAX_UINT32 :
+                                orig->getVehicleMask() );
+      m_vehicleMasks.push_back( dest == NULL ? MAX_UINT32 :
+                                dest->getVehicleMask() );
+      subRoute->setOrigVehicle( NULL );
+      OrigDestInfo destInfo( *subRoute->getDestInfo() );
+      destInfo.setVehicle( NULL );
+      subRoute->setDestInfo( destInfo );
+   }
+}
+
+void
+ServerSubRouteVector::attachVehicles( const DriverPref& pref )
+{
+   if ( m_vehicleMasks.empty() ) {
+      // Not detached.
+      return;
+   }
+   MC2_ASSERT( m_vehicleMasks.size() == size() * 2 );
+   vector<uint32>::const_iterator mask = m_vehicleMasks.begin();
+   for ( iterator it = begin(); it != end(); ++it ) {
+      SubRoute* subRoute = *it;
+      subRoute->setOrigVehicle( findVehicle( pref, *mask++ ) );
+      OrigDestInfo destInfo( *subRoute->getDestInfo() );
+      destInfo.setVehicle( findVehicle( pref, *mask++ ) );
+      subRoute->setDestInfo( destInfo );
+   }
+   m_vehicleMasks.clear();
+}
+
 // FIXME: Avoid copies if possible.
 ServerSubRouteVector*
 ServerSubRouteVector::getResultVector(uint32 index)
 {
-   uint32 currentSubRouteIndex = getDestIndexArray()[index];
+   return getResultVectorFrom( getDestIndexArray()[index] );
+}
+
+ServerSubRouteVector*
+ServerSubRouteVector::getResultVectorFrom(uint32 subRouteIndex)
+{
+   uint32 currentSubRouteIndex = subRouteIndex;
    
    ServerSubRouteVector* returnVector = new ServerSubRouteVector;
    if ( currentSubRouteIndex != MAX_UINT32 ) {
@@ -0,0 +1,172 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "TileETagTable.h"
+#include "Properties.h"
+#include "StringUtility.h"
+#include "MC2Logging.h"
+
+#include <stdio.h>
+
+TileETagTable::TileETagTable( uint32 maxNbrEntries, uint32 ttl )
+      : m_maxNbrEntries( maxNbrEntries ),
+        m_ttl( ttl )
+{
+   m_stats.earlyNotModified = 0;
+   m_stats.lateNotModified = 0;
+   m_stats.modified = 0;
+   m_stats.nbrEntries = 0;
+}
+
+TileETagTable&
+TileETagTable::getInstance()
+{
+   static TileETagTable
+      table( Properties::getUint32Property( "HTTP_TILE_ETAG_SIZE",
+                                            DEFAULT_MAX_NBR_ENTRIES ),
+             Properties::getUint32Property( "HTTP_TILE_ETAG_TTL",
+                                            DEFAULT_TTL ) );
+   return table;
+}
+
+MC2String
+TileETagTable::makeETag( uint32 descCRC, uint32 tileCRC )
+{
+   char etag[ 24 ];
+   sprintf( etag, "\"%08x-%08x\"", descCRC, tileCRC );
+   return etag;
+}
+
+bool
+TileETagTable::notModified( const MC2String* ifNoneMatch,
+                            uint32 ifModifiedSince,
+                            const MC2String& etag,
+                            uint32 lastModified )
+{
+   if ( ifNoneMatch != NULL ) {
+      // A list of ETags, possibly weak, or "*".
+      const MC2String& list = *ifNoneMatch;
+      MC2String::size_type pos = 0;
+      while ( pos < list.size() ) {
+         MC2String::size_type end = list.find( ',', pos );
+         if ( end == MC2String::npos ) {
+            end = list.size();
+         }
+         MC2String tag = StringUtility::trimStartEnd(
+            list.substr( pos, end - pos ) );
+         if ( tag.compare( 0, 2, "W/" ) == 0 ) {
+            tag.erase( 0, 2 );
+         }
+         if ( tag == "*" || tag == etag ) {
+            return true;
+         }
+         pos = end + 1;
+      }
+      return false;
+   }
+   return ifModifiedSince != 0 && lastModified <= ifModifiedSince;
+}
+
+bool
+TileETagTable::checkEarly( const MC2String& param,
+                           uint32 descCRC,
+                           const MC2String* ifNoneMatch,
+                           uint32 ifModifiedSince,
+                           uint32 now,
+                           MC2String& etag )
+{
+   ISABSync sync( m_mutex );
+   Entries::const_iterator it = m_entries.find( param );
+   if ( it == m_entries.end() ||
+        it->second.descCRC != descCRC ||
+        now - it->second.fetched > m_ttl ) {
+      return false;
+   }
+   const MC2String current = makeETag( descCRC, it->second.tileCRC );
+   if ( ! notModified( ifNoneMatch, ifModifiedSince,
+                       current, it->second.lastModified ) ) {
+      return false;
+   }
+   etag = current;
+   ++m_stats.earlyNotModified;
+   counted();
+   return true;
+}
+
+uint32
+TileETagTable::update( const MC2String& param,
+                       uint32 descCRC,
+                       uint32 tileCRC,
+                       uint32 now )
+{
+   ISABSync sync( m_mutex );
+   if ( m_maxNbrEntries == 0 ) {
+      return now;
+   }
+   Entries::iterator it = m_entries.find( param );
+   if ( it == m_entries.end() ) {
+      if ( m_entries.size() >= m_maxNbrEntries ) {
+         m_entries.erase( m_order.front() );
+         m_order.pop_front();
+      }
+      Entry entry;
+      entry.descCRC = descCRC;
+      entry.tileCRC = tileCRC;
+      entry.lastModified = now;
+      it = m_entries.insert( make_pair( param, entry ) ).first;
+      m_order.push_back( param );
+   } else if ( it->second.descCRC != descCRC ||
+               it->second.tileCRC != tileCRC ) {
+      it->second.descCRC = descCRC;
+      it->second.tileCRC = tileCRC;
+      it->second.lastModified = now;
+   }
+   it->second.fetched = now;
+   return it->second.lastModified;
+}
+
+void
+TileETagTable::countLate( bool notModified )
+{
+   ISABSync sync( m_mutex );
+   if ( notModified ) {
+      ++m_stats.lateNotModified;
+   } else {
+      ++m_stats.modified;
+   }
+   counted();
+}
+
+void
+TileETagTable::counted() const
+{
+   uint32 total = m_stats.earlyNotModified + m_stats.lateNotModified +
+      m_stats.modified;
+   if ( total % LOG_INTERVAL == 0 ) {
+      mc2log << info << "[TileETagTable] conditional requests " << total
+             << " early 304 " << m_stats.earlyNotModified
+             << " late 304 " << m_stats.lateNotModified
+             << " modified " << m_stats.modified
+             << " entries " << m_entries.size() << endl;
+   }
+}
+
+TileETagTable::Statistics
+TileETagTable::getStatistics() const
+{
+   ISABSync sync( m_mutex );
+   Statistics stats = m_stats;
+   stats.nbrEntries = m_entries.size();
+   return stats;
+}
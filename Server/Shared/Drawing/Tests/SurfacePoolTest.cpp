@@ -0,0 +1,62 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "MC2UnitTestMain.h"
+
+#include "Cairo.h"
+
+// Cairo.h is empty without cairo.
+#ifdef HAVE_CAIRO
+
+using namespace GSystem::Cairo;
+
+// Tests that the surfaces are reused per size.
+MC2_UNIT_TEST_FUNCTION( surfacePoolTest ) {
+   Statistics before = getStatistics();
+
+   std::auto_ptr< Surface > surface( SurfacePool::acquire( 20, 10 ) );
+   MC2_TEST_REQUIRED( surface.get() != NULL );
+   MC2_TEST_CHECK( surface->getWidth() == 20 );
+   MC2_TEST_CHECK( surface->getHeight() == 10 );
+   const Surface* first = surface.get();
+   SurfacePool::release( surface );
+
+   // Same size, should be the same surface.
+   surface = SurfacePool::acquire( 20, 10 );
+   MC2_TEST_CHECK( surface.get() == first );
+
+   // Other size, a new one.
+   std::auto_ptr< Surface > other( SurfacePool::acquire( 10, 20 ) );
+   MC2_TEST_CHECK( other.get() != first );
+   MC2_TEST_CHECK( other->getWidth() == 10 );
+
+   Statistics after = getStatistics();
+   MC2_TEST_CHECK( after.surfaces.hits - before.surfaces.hits == 1 );
+   MC2_TEST_CHECK( after.surfaces.misses - before.surfaces.misses == 2 );
+
+   SurfacePool::release( surface );
+   SurfacePool::release( other );
+
+   // The pool only keeps a few surfaces per thread.
+   for ( uint32 i = 0; i < SurfacePool::MAX_SURFACES_PER_THREAD + 2; ++i ) {
+      SurfacePool::release( std::auto_ptr< Surface >( new Surface( i + 1,
+                                                                   1 ) ) );
+   }
+   before = getStatistics();
+   surface = SurfacePool::acquire( 20, 10 );
+   after = getStatistics();
+   MC2_TEST_CHECK( after.surfaces.misses - before.surfaces.misses == 1 );
+}
+
+#endif // HAVE_CAIRO
@@ -31,6 +31,8 @@ namespace GSystem {
 
 namespace Cairo {
 
+struct FontFace;
+
 /**
  * A surface used by cairo.
  * Uses 24 bits RGB surface internaly.
@@ -110,6 +112,8 @@ private:
  * Font implementation for cairo.
  * This implementation uses Freetype fonts since we
  * are suppose to load the font directly from a file.
+ * The faces are loaded once per file and shared by all fonts in the
+ * process, so that cairo can reuse the glyphs it has rendered.
  */
 class Font: public GSystem::Font {
 public:
@@ -148,12 +152,14 @@ public:
                         const char* text ) const;
 
 private:
-   /// Does this font support all characters in text?
-   bool supportsAllCharacters( const char* text ) const;
+   /**
+    * Does this font support all characters in text?
+    * @param gc The context with this font set.
+    * @param text The text to check.
+    */
+   bool supportsAllCharacters( cairo_t* gc, const char* text ) const;
    
-   FT_Library m_library; ///< used to initialize freetype library 
-   FT_Face m_fontFace; ///< the font used for drawing
-   cairo_font_face_t* m_cairoFontFace; ///< the cairo font used for drawing
+   FontFace* m_face; ///< the shared face used for drawing
    const Font* m_unicodeFallback; ///< a fallback font or NULL
 };
 
@@ -249,6 +255,51 @@ void drawPolygon( GContext& gc,
  */
 std::auto_ptr<Surface> loadPNG( const MC2String& filename );
 
+/**
+ * Loads a png file once and keeps it for the rest of the process.
+ * Used for the symbols, which are drawn in most images.
+ * The returned surface shares the pixels with the cache and must
+ * only be used as a source, never drawn on.
+ * @param filename the filename of the png file
+ * @return pointer to allocated surface on success.
+ */
+std::auto_ptr<Surface> loadCachedPNG( const MC2String& filename );
+
+/**
+ * Per thread pool of surfaces to draw images on. The image drawers
+ * of a thread usually draw images of the same few sizes, so the
+ * surfaces are kept and reused instead of being allocated and freed
+ * for each image. The reused surfaces are not cleared.
+ */
+class SurfacePool {
+public:
+   /// The maximum number of surfaces kept by each thread.
+   static const uint32 MAX_SURFACES_PER_THREAD = 4;
+
+   /**
+    * @param width The width of the surface.
+    * @param height The height of the surface.
+    * @return A surface from the pool of the calling thread or a new one.
+    */
+   static std::auto_ptr<Surface> acquire( uint32 width, uint32 height );
+
+   /**
+    * Puts a surface in the pool of the calling thread.
+    * @param surface The surface to keep, may be NULL.
+    */
+   static void release( std::auto_ptr<Surface> surface );
+};
+
+/// The counters of the caches used when drawing with cairo.
+struct Statistics {
+   CacheStatistics fonts; ///< font faces
+   CacheStatistics symbols; ///< png files from loadCachedPNG
+   CacheStatistics surfaces; ///< surfaces from the SurfacePool
+};
+
+/// @return The counters of the caches, summed over all threads.
+Statistics getStatistics();
+
 /**
  * Paint a surface to another surface
  * @param gc graphic context, the destination context.
@@ -22,6 +22,7 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include <stdexcept>
 #include <MC2String.h>
 #include <map>
+#include <iosfwd>
 
 namespace GSystem {
 
@@ -210,6 +211,23 @@ private:
    double m_size; ///< font size
 };
 
+/**
+ * Hit and miss counters of the caches used when drawing.
+ */
+struct CacheStatistics {
+   CacheStatistics(): hits( 0 ), misses( 0 ) { }
+
+   /// @return The part of the lookups that were hits, 0-1.
+   float getHitRate() const;
+
+   uint64 hits; ///< lookups found in the cache
+   uint64 misses; ///< lookups that had to load or create
+};
+
+/// Prints hits, misses and hit rate.
+std::ostream& operator << ( std::ostream& stream,
+                            const CacheStatistics& stats );
+
 /**
  * Cache system for class Font
  */
@@ -0,0 +1,102 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#ifndef GLYPHCACHE_H
+#define GLYPHCACHE_H
+
+#include "config.h"
+#include "ISABThread.h"
+#include "NotCopyable.h"
+#include "GSystem.h"
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+#include <map>
+
+/**
+ * Process wide cache of the advances of FreeType glyphs.
+ *
+ * The text placement asks for the size of every character of every
+ * label in every image. Loading the glyphs from the faces takes a
+ * large part of the drawing time and the faces can not be used by
+ * several threads at once, so the advances are kept here and the
+ * faces are only used, under a lock, when a glyph is not found.
+ *
+ * The faces are used as keys and must live as long as the cache,
+ * like the faces cached by GDImageDraw::loadFace.
+ */
+class GlyphCache: private NotCopyable {
+public:
+   /// The maximum number of glyphs to keep, the cache is emptied when full.
+   static const uint32 MAX_NBR_GLYPHS = 65536;
+
+   /// The advance of a glyph in whole pixels.
+   struct Advance {
+      int32 x;
+      int32 y;
+   };
+
+   /// @return The cache used by the image drawers.
+   static GlyphCache& getInstance();
+
+   GlyphCache();
+
+   /**
+    * Gets the advance of a glyph, from the cache or from the face.
+    *
+    * @param face The face of the font.
+    * @param fontSize The size in points, at 72 dpi.
+    * @param charCode The unicode character.
+    * @param advance Set to the advance of the glyph.
+    * @return False if the glyph could not be loaded.
+    */
+   bool getAdvance( FT_Face face, int fontSize, uint32 charCode,
+                    Advance& advance );
+
+   /// @return The hits and misses of the cache.
+   GSystem::CacheStatistics getStatistics() const;
+
+private:
+   /// Face, size and character.
+   struct Key {
+      Key( FT_Face inFace, int inSize, uint32 inCharCode ):
+         face( inFace ), size( inSize ), charCode( inCharCode ) { }
+
+      bool operator < ( const Key& other ) const {
+         if ( face != other.face ) {
+            return face < other.face;
+         }
+         if ( size != other.size ) {
+            return size < other.size;
+         }
+         return charCode < other.charCode;
+      }
+
+      FT_Face face;
+      int size;
+      uint32 charCode;
+   };
+
+   typedef std::map< Key, Advance > Glyphs;
+
+   /// Protects m_glyphs, m_statistics and the faces while loading.
+   mutable ISABMutex m_mutex;
+   /// The cached glyphs.
+   Glyphs m_glyphs;
+   /// The hits and misses.
+   GSystem::CacheStatistics m_statistics;
+};
+
+#endif // GLYPHCACHE_H
@@ -95,6 +95,14 @@ public:
                            const POIImageIdentificationTable* 
                            imageTable = NULL );
 
+   /**
+    *   Prints the counters of the glyph, font, symbol and surface
+    *   caches shared by all drawers, one cache per line.
+    *
+    *   @param stream The stream to print to.
+    */
+   static void printCacheStatistics( ostream& stream );
+
 private:
    /**
     * Sets basic image parameters.
@@ -16,6 +16,7 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 
 #include "MC2BoundingBox.h"
 #include "PixelBox.h"
+#include "BoundingBoxGrid.h"
 
 class DrawingProjection;
 
@@ -32,6 +33,8 @@ PixelBox createPixelBox( const MC2BoundingBox& box,
 
 /**
  * Holds world boxes and their associated pixel boxes.
+ * The boxes are indexed in grids so that the boxes near a box
+ * can be found without testing all of them.
  */
 class ObjectBoxes {
 public:
@@ -40,6 +43,13 @@ public:
 
    typedef WorldBoxes::size_type SizeType;
 
+   /// The cell size of the pixel box grid, in pixels.
+   static const uint32 PIXEL_CELL_SIZE = 32;
+
+   ObjectBoxes():
+      m_pixelGrid( PIXEL_CELL_SIZE ) {
+   }
+
    /**
     * Adds a bounding box. It will create a matching pixel box.
     * @param proj Current projection.
@@ -47,8 +57,21 @@ public:
     */
    void addBox( const MC2BoundingBox& worldCoordinates,
                 const DrawingProjection& proj ) {
+      m_worldGrid.add( worldCoordinates, m_worldBoxes.size() );
       m_worldBoxes.push_back( worldCoordinates );
       m_pixelBoxes.push_back( createPixelBox( worldCoordinates, proj ) );
+      m_pixelGrid.add( m_pixelBoxes.back(), m_pixelBoxes.size() - 1 );
+   }
+
+   /**
+    * Adds the world box of a placed text. The text boxes are kept
+    * apart from the other boxes and are only used for testing new
+    * texts against the placed ones.
+    * @param worldCoordinates bounding box in world coordinates.
+    */
+   void addTextBox( const MC2BoundingBox& worldCoordinates ) {
+      m_textGrid.add( worldCoordinates, m_textBoxes.size() );
+      m_textBoxes.push_back( worldCoordinates );
    }
 
    /**
@@ -79,11 +102,63 @@ public:
       return m_worldBoxes;
    }
 
+   /**
+    * Fetch text box at index. Undefined behavior if index is not inside
+    * getNbrTextBoxes().
+    * @return text box at index \c pos.
+    */
+   const MC2BoundingBox& getTextBox( SizeType pos ) const {
+      return m_textBoxes[ pos ];
+   }
+
+   /// @return Number of text boxes.
+   SizeType getNbrTextBoxes() const {
+      return m_textBoxes.size();
+   }
+
+   /**
+    * Finds the boxes that overlap a world box, borders included.
+    * @param box The box to search with.
+    * @param indices The indices of the boxes are added here.
+    */
+   void getOverlappingWorldBoxes( const MC2BoundingBox& box,
+                                  std::vector< uint32 >& indices ) const {
+      m_worldGrid.getOverlapping( box, indices );
+   }
+
+   /**
+    * Finds the boxes that overlap a pixel box, borders included.
+    * @param box The box to search with.
+    * @param indices The indices of the boxes are added here.
+    */
+   void getOverlappingPixelBoxes( const PixelBox& box,
+                                  std::vector< uint32 >& indices ) const {
+      m_pixelGrid.getOverlapping( box, indices );
+   }
+
+   /**
+    * Finds the text boxes that overlap a world box, borders included.
+    * @param box The box to search with.
+    * @param indices The indices of the text boxes are added here.
+    */
+   void getOverlappingTextBoxes( const MC2BoundingBox& box,
+                                 std::vector< uint32 >& indices ) const {
+      m_textGrid.getOverlapping( box, indices );
+   }
+
 public:
    /// World boxes.
    WorldBoxes m_worldBoxes;
    /// Matching pixel boxes for the world boxes.
    std::vector< PixelBox > m_pixelBoxes;
+   /// Boxes of the placed texts.
+   WorldBoxes m_textBoxes;
+   /// Index of the world boxes.
+   BoundingBoxGrid m_worldGrid;
+   /// Index of the pixel boxes.
+   BoundingBoxGrid m_pixelGrid;
+   /// Index of the text boxes.
+   BoundingBoxGrid m_textGrid;
 };
 
 } // MapDrawingCommon
@@ -22,6 +22,7 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include "ImageMagick.h"
 #include "DeleteHelpers.h"
 #include "TextIterator.h"
+#include "ISABThread.h"
 
 #ifndef M_PI
 #define M_PI 3.141592
@@ -51,6 +52,136 @@ inline void fill( GSystem::Cairo::GContext& cairoGC ) {
 }
 }
 
+namespace GSystem {
+namespace Cairo {
+
+/**
+ * A font file loaded by freetype and cairo. The faces are never
+ * deleted since cairo keeps rendered glyphs per face.
+ */
+struct FontFace {
+   FT_Library library; ///< used to initialize freetype library
+   FT_Face face; ///< the font used for drawing
+   cairo_font_face_t* cairoFace; ///< the cairo font used for drawing
+};
+
+}
+}
+
+namespace {
+
+/// The font faces, symbols and counters shared by all threads.
+struct SharedCaches {
+   typedef std::map< MC2String, GSystem::Cairo::FontFace* > Faces;
+   typedef std::map< MC2String, cairo_surface_t* > Symbols;
+
+   /// Protects everything else.
+   ISABMutex mutex;
+   /// The loaded font faces, by file name.
+   Faces faces;
+   /// The loaded symbols, by file name.
+   Symbols symbols;
+   /// The counters.
+   GSystem::Cairo::Statistics statistics;
+};
+
+/// Never deleted, the faces may be used during static destruction.
+SharedCaches* sharedCaches = NULL;
+
+/// Makes sure the caches are only created once.
+ISABOnceFlag sharedCachesInited = ISAB_ONCE_INIT;
+
+/// Creates the shared caches.
+void initSharedCaches() {
+   sharedCaches = new SharedCaches();
+}
+
+/// @return The caches shared by all threads.
+SharedCaches& getSharedCaches() {
+   ISABCallOnce( &initSharedCaches, sharedCachesInited );
+   return *sharedCaches;
+}
+
+/**
+ * @param filename The font file.
+ * @return The shared face for the file, loaded if needed.
+ */
+GSystem::Cairo::FontFace* getFontFace( const MC2String& filename )
+   throw ( GSystem::Exception ) {
+   SharedCaches& caches = getSharedCaches();
+   ISABSync sync( caches.mutex );
+   SharedCaches::Faces::const_iterator it = caches.faces.find( filename );
+   if ( it != caches.faces.end() ) {
+      ++caches.statistics.fonts.hits;
+      return it->second;
+   }
+   ++caches.statistics.fonts.misses;
+
+   std::auto_ptr<GSystem::Cairo::FontFace> 
+      fontFace( new GSystem::Cairo::FontFace() );
+   fontFace->library = NULL;
+   fontFace->face = NULL;
+   FT_Init_FreeType( &fontFace->library );
+   // FIXME: error checking
+   FT_New_Face( fontFace->library,
+                filename.c_str(),
+                0,
+                &fontFace->face );
+
+   if ( fontFace->face == NULL ) {
+      FT_Done_FreeType( fontFace->library );
+      throw GSystem::
+         Exception( MC2String("[Cairo::Font] Failed to load font: ") + 
+                    filename );
+   }
+
+   fontFace->cairoFace = 
+      cairo_ft_font_face_create_for_ft_face( fontFace->face, 
+                                             FT_LOAD_FORCE_AUTOHINT );
+   caches.faces[ filename ] = fontFace.get();
+   return fontFace.release();
+}
+
+/// The surfaces kept by one thread.
+struct ThreadSurfaces {
+   ~ThreadSurfaces() {
+      STLUtility::deleteValues( surfaces );
+   }
+
+   /// The surfaces, the most recently used last.
+   std::vector< GSystem::Cairo::Surface* > surfaces;
+};
+
+/// Deletes the surfaces of a thread when it terminates.
+void deleteThreadSurfaces( void* ptr ) {
+   delete static_cast<ThreadSurfaces*>( ptr );
+}
+
+/// Makes sure the key is only created once.
+ISABOnceFlag surfacesTSSInited = ISAB_ONCE_INIT;
+
+/// The key to the surfaces of the threads.
+ISABTSS::TSSKey surfacesTSSKey;
+
+/// Creates surfacesTSSKey.
+void initSurfacesTSS() {
+   surfacesTSSKey = ISABTSS::createKey( deleteThreadSurfaces );
+}
+
+/// @return The surfaces of the calling thread.
+ThreadSurfaces& getThreadSurfaces() {
+   ISABCallOnce( &initSurfacesTSS, surfacesTSSInited );
+   ThreadSurfaces* surfaces =
+      static_cast<ThreadSurfaces*>( ISABTSS::get( surfacesTSSKey ) );
+   if ( surfaces == NULL ) {
+      surfaces = new ThreadSurfaces();
+      ISABTSS::set( surfacesTSSKey, surfaces );
+   }
+   return *surfaces;
+}
+
+}
+
 namespace GSystem {
 namespace Cairo {
 inline void drawText( cairo_t* gc, int x, int y, double angle, const char* text  ) {
@@ -152,43 +283,22 @@ Font::Font( const MC2String& filename,
             const Font* unicodeFallback ) throw ( GSystem::Exception ) :
    GSystem::Font( GSystem::Font::SLANT_NORMAL, 
                   GSystem::Font::WEIGHT_NORMAL ),
-   m_library( NULL ),
-   m_fontFace( NULL ),
-   m_cairoFontFace( NULL ),
+   m_face( ::getFontFace( filename ) ),
    m_unicodeFallback( unicodeFallback ) {
 
-   FT_Init_FreeType( &m_library );
-   // FIXME: error checking
-   FT_New_Face( m_library,
-                filename.c_str(),
-                0,
-                &m_fontFace );
-
-   if ( m_fontFace == NULL ) {
-      throw GSystem::
-         Exception( MC2String("[Cairo::Font] Failed to load font: ") + 
-                    filename );
-   }
-
-   m_cairoFontFace = 
-      cairo_ft_font_face_create_for_ft_face( m_fontFace, 
-                                             FT_LOAD_FORCE_AUTOHINT );
-
-   cairo_font_face_reference( m_cairoFontFace );
    // setup parent Font stuff
-   if ( m_fontFace->style_flags & FT_STYLE_FLAG_BOLD ) {
+   if ( m_face->face->style_flags & FT_STYLE_FLAG_BOLD ) {
       setWeight( Font::WEIGHT_BOLD );
    }
 
-   if ( m_fontFace->style_flags & FT_STYLE_FLAG_ITALIC ) {
+   if ( m_face->face->style_flags & FT_STYLE_FLAG_ITALIC ) {
       setSlant( Font::SLANT_ITALIC );
    }
 
 }
 
 Font::~Font() {
-   cairo_font_face_destroy( m_cairoFontFace );
-   FT_Done_FreeType( m_library );
+   // The face is shared, see getFontFace.
 }
 
 
@@ -196,17 +306,17 @@ void Font::drawText( Cairo::GContext& context,
                      int x, int y, double angle,
                      const char* text ) const {
 
+   cairo_t* gc = context.getContext();
+   cairo_set_font_face( gc, m_face->cairoFace );
+   cairo_set_font_size( gc, getSize() );
+
    // Should we fall back on a different font?
    if ( m_unicodeFallback != NULL &&
-        !supportsAllCharacters( text ) ) {
+        !supportsAllCharacters( gc, text ) ) {
       m_unicodeFallback->drawText( context, x, y, angle, text );
       return;
    }
 
-   cairo_t* gc = context.getContext();
-   cairo_set_font_face( gc, m_cairoFontFace );
-   cairo_set_font_size( gc, getSize() );
-
    // if outline size is larger than zero then 
    // draw the outline first and then the real text
    if ( getOutlineSize() > 0 ) {
@@ -223,16 +333,16 @@ void Font::drawText( Cairo::GContext& context,
 void Font::getTextExtents( GContext& gc, Extents& extents,
                            const char* text ) const {
 
+   cairo_set_font_face( gc.getContext(), m_face->cairoFace );
+   cairo_set_font_size( gc.getContext(), getSize() );
+
    // Should we fall back on a different font?
    if ( m_unicodeFallback != NULL &&
-        !supportsAllCharacters( text ) ) {
+        !supportsAllCharacters( gc.getContext(), text ) ) {
       m_unicodeFallback->getTextExtents( gc, extents, text );
       return;
    }
 
-   cairo_set_font_face( gc.getContext(), m_cairoFontFace );
-   cairo_set_font_size( gc.getContext(), getSize() );
-
    cairo_text_extents_t cairoExtents;
    cairo_text_extents( gc.getContext(), text, &cairoExtents );
 
@@ -244,18 +354,25 @@ void Font::getTextExtents( GContext& gc, Extents& extents,
    extents.height = (uint32)cairoExtents.height;
 }
 
-bool Font::supportsAllCharacters( const char* text ) const {
-   mc2TextIterator itr( text );
-   
-   while ( *itr ) {
+bool Font::supportsAllCharacters( cairo_t* gc, const char* text ) const {
+   // Cairo uses the face too, so it must be locked through cairo.
+   cairo_scaled_font_t* scaledFont = cairo_get_scaled_font( gc );
+   FT_Face face = cairo_ft_scaled_font_lock_face( scaledFont );
+   if ( face == NULL ) {
+      return true;
+   }
+
+   bool supported = true;
+   for ( mc2TextIterator itr( text ); *itr; ++itr ) {
       // Does the font have a glyph for this character?
-      if ( FT_Get_Char_Index( m_fontFace, *itr ) == 0 ) {
-         return false;
+      if ( FT_Get_Char_Index( face, *itr ) == 0 ) {
+         supported = false;
+         break;
       }
-      ++itr;
    }
+   cairo_ft_scaled_font_unlock_face( scaledFont );
 
-   return true;
+   return supported;
 }
 
 FontCache::FontCache( const MC2String& unicodeFallback )
@@ -368,6 +485,75 @@ std::auto_ptr<Surface> loadPNG( const MC2String& filename ) {
    return surf;
 }
 
+std::auto_ptr<Surface> loadCachedPNG( const MC2String& filename ) {
+   SharedCaches& caches = getSharedCaches();
+   {
+      ISABSync sync( caches.mutex );
+      SharedCaches::Symbols::const_iterator it = 
+         caches.symbols.find( filename );
+      if ( it != caches.symbols.end() ) {
+         ++caches.statistics.symbols.hits;
+         return std::auto_ptr<Surface>
+            ( new Surface( cairo_surface_reference( it->second ) ) );
+      }
+      ++caches.statistics.symbols.misses;
+   }
+
+   // Load without holding the lock, the files are small.
+   std::auto_ptr<Surface> surf( loadPNG( filename ) );
+   if ( surf.get() != NULL ) {
+      ISABSync sync( caches.mutex );
+      cairo_surface_t*& cached = caches.symbols[ filename ];
+      if ( cached == NULL ) {
+         cached = cairo_surface_reference( surf->getSurface() );
+      }
+   }
+   return surf;
+}
+
+std::auto_ptr<Surface> SurfacePool::acquire( uint32 width, uint32 height ) {
+   ThreadSurfaces& pool = getThreadSurfaces();
+   std::auto_ptr<Surface> surface;
+   for ( uint32 i = pool.surfaces.size(); i > 0; --i ) {
+      Surface* candidate = pool.surfaces[ i - 1 ];
+      if ( candidate->getWidth() == width &&
+           candidate->getHeight() == height ) {
+         surface.reset( candidate );
+         pool.surfaces.erase( pool.surfaces.begin() + ( i - 1 ) );
+         break;
+      }
+   }
+
+   SharedCaches& caches = getSharedCaches();
+   ISABSync sync( caches.mutex );
+   if ( surface.get() != NULL ) {
+      ++caches.statistics.surfaces.hits;
+   } else {
+      ++caches.statistics.surfaces.misses;
+      surface.reset( new Surface( width, height ) );
+   }
+   return surface;
+}
+
+void SurfacePool::release( std::auto_ptr<Surface> surface ) {
+   if ( surface.get() == NULL ) {
+      return;
+   }
+   ThreadSurfaces& pool = getThreadSurfaces();
+   if ( pool.surfaces.size() >= MAX_SURFACES_PER_THREAD ) {
+      // Drop the least recently used.
+      delete pool.surfaces.front();
+      pool.surfaces.erase( pool.surfaces.begin() );
+   }
+   pool.surfaces.push_back( surface.release() );
+}
+
+Statistics getStatistics() {
+   SharedCaches& caches = getSharedCaches();
+   ISABSync sync( caches.mutex );
+   return caches.statistics;
+}
+
 void blitSurface( GContext& gc, Surface& surf, int x, int y ) {
    cairo_set_source_surface( gc.getContext(), 
                              surf.getSurface(),
@@ -79,7 +79,7 @@ const uint32 CairoImageDraw::OUTLINE_SIZE = 1;
 CairoImageDraw::CairoImageDraw( uint32 width, uint32 height,
                                 GDUtils::Color::CoolColor color ):
    ImageDraw( width, height ),
-   m_surface( new Surface( width, height ) ),
+   m_surface( SurfacePool::acquire( width, height ) ),
    m_gc( new GContext( *m_surface ) ),
    m_fontCache( 0 ),
    m_drawingProjection( NULL ),
@@ -97,7 +97,9 @@ CairoImageDraw::CairoImageDraw( uint32 width, uint32 height,
 }
 
 CairoImageDraw::~CairoImageDraw() {
-
+   // Let the next image of this size in the thread draw on the surface.
+   m_gc.reset();
+   SurfacePool::release( m_surface );
 }
 
 byte* CairoImageDraw::getImageAsBuffer( uint32& size, 
@@ -599,7 +601,7 @@ void CairoImageDraw::drawSymbol( DrawSettings::symbol_t sym,
       filename += ".png";
    } 
    auto_ptr<GSystem::Cairo::Surface> 
-      surf( GSystem::Cairo::loadPNG( filename ) );
+      surf( GSystem::Cairo::loadCachedPNG( filename ) );
 
    if ( surf.get() == NULL ) {
       mc2dbg << warn << "[CairoImageDraw] Failed to load png: " << filename << endl;
@@ -625,7 +627,7 @@ drawGfxFeatureRoadSign( const char* name, const char* signName,
                         const char* fontName ) {
 
    auto_ptr<GSystem::Cairo::Surface>
-      surf( GSystem::Cairo::loadPNG( getImageFullPath( signName ) ) );
+      surf( GSystem::Cairo::loadCachedPNG( getImageFullPath( signName ) ) );
 
    if ( surf.get() == NULL ) {
       return;
@@ -23,6 +23,7 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include "MC2Point.h"
 #include "ScopedArray.h"
 #include "GDImagePtr.h"
+#include "GlyphCache.h"
 #include "FilePtr.h"
 #include "StringTableUtility.h"
 #include "GSystem.h"
@@ -1001,23 +1002,14 @@ GDImageDraw::getGlyphDimensions( int fontSize,
       return (false);
    }
 
-   FT_Error error;
-   
-   error = FT_Set_Char_Size( face, 
-                             0,
-                             int(fontSize * 64), 
-                             0,
-                             0 ); // 0 - defaults to 72 dpi
+   // The face is shared by all threads, the glyph cache loads the
+   // glyphs under its lock.
+   GlyphCache& glyphCache = GlyphCache::getInstance();
 
     for (mc2TextIterator it = mc2TextIterator(text);
         *it != 0; ++it ) {
-      // Seems like FT_Get_Char_Index wants unicode. Nice.
-      FT_UInt glyph_index = FT_Get_Char_Index( face, *it ); 
-
-      error = FT_Load_Glyph( face, 
-                             glyph_index,
-                             FT_LOAD_DEFAULT );
-      if ( error ) {
+      GlyphCache::Advance advance;
+      if ( ! glyphCache.getAdvance( face, fontSize, *it, advance ) ) {
          return (false);
       }
 
@@ -1026,9 +1018,9 @@ GDImageDraw::getGlyphDimensions( int fontSize,
       // WARNING: We increase the width by one pixel because the text looks
       // too compressed otherwise (very strange).
       dim.width = 
-         int32( ((1+((face)->glyph->advance.x >> 6)) * xFactor) + 0.5 );
+         int32( ((1+advance.x) * xFactor) + 0.5 );
       dim.height = 
-         int32( (((face)->glyph->advance.y >> 6) * yFactor) + 0.5 );
+         int32( (advance.y * yFactor) + 0.5 );
       dim.width++;
       dimensions.push_back( dim );
    }
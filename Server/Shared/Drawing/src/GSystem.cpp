@@ -13,6 +13,8 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 
 #include "GSystem.h"
 
+#include <iostream>
+
 namespace GSystem {
 Font::Font( Slant slant, Weight weight,
             int32 options ):
@@ -26,6 +28,19 @@ Font::Font( Slant slant, Weight weight,
 }
 
 
+float CacheStatistics::getHitRate() const {
+   if ( hits + misses == 0 ) {
+      return 0;
+   }
+   return float( hits ) / ( hits + misses );
+}
+
+std::ostream& operator << ( std::ostream& stream,
+                            const CacheStatistics& stats ) {
+   return stream << stats.hits << " hits, " << stats.misses << " misses, "
+                 << int( stats.getHitRate() * 100 + 0.5 ) << "% hit rate";
+}
+
 FontCache::FontCache() {
 
 }
@@ -0,0 +1,60 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "GlyphCache.h"
+
+GlyphCache&
+GlyphCache::getInstance() {
+   static GlyphCache cache;
+   return cache;
+}
+
+GlyphCache::GlyphCache() {
+}
+
+bool
+GlyphCache::getAdvance( FT_Face face, int fontSize, uint32 charCode,
+                        Advance& advance ) {
+   ISABSync sync( m_mutex );
+   Key key( face, fontSize, charCode );
+   Glyphs::const_iterator it = m_glyphs.find( key );
+   if ( it != m_glyphs.end() ) {
+      ++m_statistics.hits;
+      advance = it->second;
+      return true;
+   }
+   ++m_statistics.misses;
+
+   FT_Set_Char_Size( face, 0, fontSize * 64,
+                     0, 0 ); // 0 - defaults to 72 dpi
+   // Seems like FT_Get_Char_Index wants unicode. Nice.
+   FT_UInt glyphIndex = FT_Get_Char_Index( face, charCode );
+   if ( FT_Load_Glyph( face, glyphIndex, FT_LOAD_DEFAULT ) ) {
+      return false;
+   }
+   advance.x = face->glyph->advance.x >> 6;
+   advance.y = face->glyph->advance.y >> 6;
+
+   if ( m_glyphs.size() >= MAX_NBR_GLYPHS ) {
+      m_glyphs.clear();
+   }
+   m_glyphs.insert( make_pair( key, advance ) );
+   return true;
+}
+
+GSystem::CacheStatistics
+GlyphCache::getStatistics() const {
+   ISABSync sync( m_mutex );
+   return m_statistics;
+}
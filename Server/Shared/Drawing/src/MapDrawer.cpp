@@ -29,6 +29,8 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 
 #include "CairoImageDraw.h"
 #include "GDImageDraw.h"
+#include "GlyphCache.h"
+#include "Cairo.h"
 
 #include "Properties.h"
 
@@ -182,6 +184,17 @@ inline ImageDraw* createImageDraw( uint32 w, uint32 h ) {
 #endif
 }
 
+void
+MapDrawer::printCacheStatistics( ostream& stream ) {
+   stream << "Glyphs: " << GlyphCache::getInstance().getStatistics() << endl;
+#ifdef HAVE_CAIRO
+   GSystem::Cairo::Statistics cairo = GSystem::Cairo::getStatistics();
+   stream << "Fonts: " << cairo.fonts << endl
+          << "Symbols: " << cairo.symbols << endl
+          << "Surfaces: " << cairo.surfaces << endl;
+#endif
+}
+
 void
 MapDrawer::init( uint32 screenX, uint32 screenY,
                  MapSettings* mapSettings ) {
@@ -40,6 +40,7 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include "Math.h"
 
 #include <set>
+#include <algorithm>
 
 namespace {
 
@@ -158,44 +159,40 @@ bool containsWithin( const MC2BoundingBox& lhs,
 
 /**
  * Do collision test with "currTextBBox" against already added collision boxes.
+ * Only the boxes near "currTextBBox" in the grids of "objectBBoxes" are
+ * tested.
  *
  * @param currTextBBox the box to test collision against the others
- * @param gfxTextArray a set of text bounding boxes as gfx data to test against
- *                     "currTextBBox"
- * @param objectBBoxes bounding boxes from other types of objects to test
- *                     against "currTextBBox"
+ * @param objectBBoxes bounding boxes from other types of objects and
+ *                     from the placed texts to test against "currTextBBox"
  * @return true if there was a collision
  */
 inline bool 
 collisionTest( MC2BoundingBox currTextBBox,
-               vector<GfxData*>& gfxTextArray,
                MapDrawingCommon::ObjectBoxes& objectBBoxes,
                const DrawingProjection& proj ) {
 
    PixelBox pixelBox = MapDrawingCommon::createPixelBox( currTextBBox, proj );
+   vector<uint32> nearBoxes;
 
    // Check if the text boundary crosses any
    // points of interests or any streets
-   for ( MapDrawingCommon::ObjectBoxes::SizeType boxIndex = 0;
-         boxIndex < objectBBoxes.getNbrBoxes();
-         ++boxIndex ) {
-      if ( containsWithin( objectBBoxes.getPixelBox( boxIndex ), pixelBox ) ) {
+   objectBBoxes.getOverlappingPixelBoxes( pixelBox, nearBoxes );
+   for ( uint32 i = 0; i < nearBoxes.size(); ++i ) {
+      if ( containsWithin( objectBBoxes.getPixelBox( nearBoxes[ i ] ),
+                           pixelBox ) ) {
          return true;
       }
    }
 
    // Check if the text boundary crosses any previous
    // text boundary
-                  
-   for ( uint32  i = 0; i < gfxTextArray.size(); ++i ) {
-      //First check if the boundingboxes overlap.
-      const GfxData* existingTextGfx = gfxTextArray[ i ];
-      if ( existingTextGfx != NULL ) {
-         MC2BoundingBox existingTextBBox;
-         existingTextGfx->getMC2BoundingBox( existingTextBBox );
-         if ( containsWithin( currTextBBox, existingTextBBox ) ) {
-            return true;
-         }
+   nearBoxes.clear();
+   objectBBoxes.getOverlappingTextBoxes( currTextBBox, nearBoxes );
+   for ( uint32 i = 0; i < nearBoxes.size(); ++i ) {
+      if ( containsWithin( currTextBBox,
+                           objectBBoxes.getTextBox( nearBoxes[ i ] ) ) ) {
+         return true;
       }
    }
    // no collision
@@ -1631,11 +1628,11 @@ getTextLocationRotated( GfxFeature* feature,
                   if (signBBox.inside(bbox)) {
                      bool cont = true;
 
-                     for ( MapDrawingCommon::
-                              ObjectBoxes::SizeType boxIndex = 0;
-                           boxIndex < objectBBoxes.getNbrBoxes();
-                           ++boxIndex ) {
-                        if ( objectBBoxes.getWorldBox( boxIndex ).
+                     vector<uint32> nearBoxes;
+                     objectBBoxes.getOverlappingWorldBoxes( signBBox,
+                                                            nearBoxes );
+                     for ( uint32 i = 0; i < nearBoxes.size(); ++i ) {
+                        if ( objectBBoxes.getWorldBox( nearBoxes[ i ] ).
                              overlaps( signBBox ) ) {
                            cont = false;
                            break;
@@ -1792,17 +1789,33 @@ getTextLocationRotated( GfxFeature* feature,
          polyIndex < useGfx->getNbrPolygons();
          ++polyIndex ){
 
+      // Only the boxes overlapping the polygon can collide with the
+      // text, so fetch them from the grids instead of copying all.
+      // The order is the one of a full scan: the boxes around, the
+      // world boxes and last the boxes of the placed texts.
+      MC2BoundingBox gfxBBox;
+      useGfx->getMC2BoundingBox( gfxBBox, polyIndex );
       vector<MC2BoundingBox> around = getBoxesAround( bbox );
-      MapDrawingCommon::ObjectBoxes::WorldBoxes worldBoxes = 
-         objectBBoxes.getWorldBoxes();
-
-      for ( size_t i = 0; i < around.size(); ++i ) {
-         worldBoxes.insert( worldBoxes.begin(), around[ i ] );
+      MapDrawingCommon::ObjectBoxes::WorldBoxes nearBoxes( around.rbegin(),
+                                                           around.rend() );
+      vector<uint32> indices;
+      objectBBoxes.getOverlappingWorldBoxes( gfxBBox, indices );
+      std::sort( indices.begin(), indices.end() );
+      for ( uint32 i = 0; i < indices.size(); ++i ) {
+         nearBoxes.push_back( objectBBoxes.getWorldBox( indices[ i ] ) );
+      }
+      indices.clear();
+      objectBBoxes.getOverlappingTextBoxes( gfxBBox, indices );
+      std::sort( indices.begin(), indices.end() );
+      for ( uint32 i = 0; i < indices.size(); ++i ) {
+         nearBoxes.push_back( objectBBoxes.getTextBox( indices[ i ] ) );
       }
 
-      if ( ! useGfx->getTextPosition( worldBoxes,
+      // The text boxes are the boxes of gfxTextArray, already added.
+      const vector<GfxData*> noTextGfxs;
+      if ( ! useGfx->getTextPosition( nearBoxes,
                                       polyIndex, tmpGfx2.get(),
-                                      gfxTextArray ) ){
+                                      noTextGfxs ) ){
          continue;
       }
 
@@ -1970,7 +1983,7 @@ placeOtherText( MapSettings* mapSettings,
 
          // Text is ok to try to add, do collision test
          cont = ! Collision::collisionTest( currTextBBox,
-                                            gfxTextArray, objectBBoxes, *projection );
+                                            objectBBoxes, *projection );
       } else {
          cont = false;
       }
@@ -2014,6 +2027,7 @@ placeOtherText( MapSettings* mapSettings,
                        ! polBBox.inside( projection->getBoundingBox() ) ) {
                      feature->setDisplayText( false );
                   } else {
+                     objectBBoxes.addTextBox( polBBox );
                      gfxTextArray.push_back(textGfx.release());
                   }
                }
@@ -0,0 +1,101 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "MC2UnitTestMain.h"
+
+#include "PreparedGfxData.h"
+#include "GfxDataFull.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+namespace {
+
+/// Adds a star shaped polygon around the center.
+void addStar( GfxDataFull& gfx, int32 lat, int32 lon, uint32 nbrCoords,
+              bool newPolygon ) {
+   for ( uint32 i = 0; i < nbrCoords; ++i ) {
+      float64 angle = 2 * M_PI * i / nbrCoords;
+      int32 radius = 1000 + ( i % 2 ) * 600 + rand() % 200;
+      gfx.addCoordinate( lat + int32( radius * sin( angle ) ),
+                         lon + int32( radius * cos( angle ) ),
+                         newPolygon && i == 0 );
+   }
+}
+
+/// Checks that the prepared gfx gives the same results as gfx.
+void checkSame( const GfxData& gfx, const PreparedGfxData& prepared,
+                uint32& nbrInside ) {
+   for ( int32 lat = gfx.getMinLat() - 100; lat <= gfx.getMaxLat() + 100;
+         lat += 37 ) {
+      for ( int32 lon = gfx.getMinLon() - 100; 
+            lon <= gfx.getMaxLon() + 100; lon += 41 ) {
+         int expected = gfx.insidePolygon( lat, lon );
+         MC2_TEST_CHECK( prepared.insidePolygon( lat, lon ) == expected );
+         if ( expected == 2 ) {
+            ++nbrInside;
+         }
+      }
+   }
+   // The coordinates themselves are on the boundry.
+   for ( uint16 p = 0; p < gfx.getNbrPolygons(); ++p ) {
+      for ( uint32 i = 0; i < gfx.getNbrCoordinates( p ); ++i ) {
+         MC2_TEST_CHECK( prepared.insidePolygon( gfx.getLat( p, i ),
+                                                 gfx.getLon( p, i ) ) ==
+                         gfx.insidePolygon( gfx.getLat( p, i ),
+                                            gfx.getLon( p, i ) ) );
+      }
+   }
+}
+
+}
+
+MC2_UNIT_TEST_FUNCTION( sameAsGfxDataTest ) {
+   srand( 17 );
+   GfxDataFull gfx;
+   addStar( gfx, 0, 0, 200, true );
+   addStar( gfx, 5000, 5000, 37, true );
+   gfx.setClosed( 0, true );
+   gfx.setClosed( 1, true );
+   gfx.updateBBox();
+
+   PreparedGfxData prepared( gfx );
+   uint32 nbrInside = 0;
+   checkSame( gfx, prepared, nbrInside );
+   MC2_TEST_CHECK( nbrInside > 0 );
+}
+
+MC2_UNIT_TEST_FUNCTION( squareTest ) {
+   GfxDataFull gfx;
+   gfx.addCoordinate( 0, 0, true );
+   gfx.addCoordinate( 0, 1000 );
+   // Repeated coordinate
+   gfx.addCoordinate( 0, 1000 );
+   gfx.addCoordinate( 1000, 1000 );
+   gfx.addCoordinate( 1000, 0 );
+   gfx.setClosed( 0, true );
+   gfx.updateBBox();
+
+   PreparedGfxData prepared( gfx );
+   MC2_TEST_CHECK( prepared.insidePolygon( 500, 500 ) == 2 );
+   MC2_TEST_CHECK( prepared.insidePolygon( 0, 500 ) == 1 );
+   MC2_TEST_CHECK( prepared.insidePolygon( 500, 1001 ) == 0 );
+   uint32 nbrInside = 0;
+   checkSame( gfx, prepared, nbrInside );
+
+   // Not closed is never inside.
+   gfx.setClosed( 0, false );
+   PreparedGfxData open( gfx );
+   MC2_TEST_CHECK( open.insidePolygon( 500, 500 ) == 0 );
+}
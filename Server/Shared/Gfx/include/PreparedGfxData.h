@@ -0,0 +1,100 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#ifndef PREPAREDGFXDATA_H
+#define PREPAREDGFXDATA_H
+
+#include "config.h"
+
+#include <vector>
+
+class GfxData;
+
+/**
+ *   A copy of the polygons of a GfxData prepared for testing many
+ *   points against it.
+ *
+ *   The edges of each polygon are put in buckets of latitude bands,
+ *   so only the edges crossing the band of the point are looked at.
+ *   insidePolygon gives exactly the same results as
+ *   GfxData::insidePolygon did for the GfxData when it was prepared.
+ *   The PreparedGfxData must be recreated if the GfxData changes.
+ */
+class PreparedGfxData {
+public:
+   /**
+    * Prepares gfx.
+    *
+    * @param gfx The GfxData to copy the polygons from.
+    */
+   explicit PreparedGfxData( const GfxData& gfx );
+
+   /**
+    * Same as GfxData::insidePolygon for all polygons.
+    *
+    * @return 0 if outside, 1 on the boundry and 2 inside.
+    */
+   int insidePolygon( int32 lat, int32 lon ) const;
+
+private:
+   /// An edge of a polygon.
+   struct Edge {
+      int32 lat1;
+      int32 lon1;
+      int32 lat2;
+      int32 lon2;
+   };
+
+   /// A polygon with the edges in bands.
+   struct Polygon {
+      /// The number of coordinates in the polygon.
+      uint32 nbrCoords;
+      /// The last coordinate.
+      int32 lastLat;
+      int32 lastLon;
+      /// The latitude range of the edges.
+      int32 minLat;
+      int32 maxLat;
+      /// The height of a band.
+      int64 bandHeight;
+      /// The edges of band i are m_edges[bandStart[i]-bandStart[i+1]].
+      std::vector<uint32> bandStart;
+   };
+
+   /// Prepares one polygon.
+   void addPolygon( const GfxData& gfx, uint16 poly );
+
+   /// @return The band of lat in poly.
+   static uint32 getBand( const Polygon& poly, int32 lat );
+
+   /// Tests one polygon, the return values are like insidePolygon.
+   int insidePolygon( const Polygon& poly, int32 lat, int32 lon ) const;
+
+   /// True if the GfxData was closed.
+   bool m_closed;
+
+   /// The bounding box of the GfxData.
+   int32 m_minLat;
+   int32 m_maxLat;
+   int32 m_minLon;
+   int32 m_maxLon;
+
+   /// The polygons.
+   std::vector<Polygon> m_polygons;
+
+   /// The edges of all the polygons, sorted in bands.
+   std::vector<Edge> m_edges;
+};
+
+#endif // PREPAREDGFXDATA_H
@@ -20,6 +20,7 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include "GenericMap.h"
 
 #include "GfxUtility.h"
+#include "GeometryKernels.h"
 #include "GfxDataFull.h"
 #include "GfxDataFactory.h"
 
@@ -944,9 +945,12 @@ GfxData::insidePolygon(coordinate_type lat, coordinate_type lon,
          return 1;
 
       int32 counter = 0;
-      for (uint32 i = 0; i < getNbrCoordinates(p); ++i) {
-         coordinate_type d_lat2 = getLat(p, i) - lat;
-         coordinate_type d_lon2 = getLon(p, i) - lon;
+      const uint32 nbrCoordinates = getNbrCoordinates(p);
+      // MC2Coordinate is lat followed by lon.
+      const int32* coords = &polyBegin(p)->lat;
+      for (uint32 i = 0; i < nbrCoordinates; ) {
+         coordinate_type d_lat2 = coords[2 * i] - lat;
+         coordinate_type d_lon2 = coords[2 * i + 1] - lon;
          if(d_lat1 != d_lat2 || d_lon1 != d_lon2) {
             //If 2 consecutive polygon points are identical we loop on.
             if((d_lat1 <= 0 && d_lat2 >= 0)
@@ -991,6 +995,18 @@ GfxData::insidePolygon(coordinate_type lat, coordinate_type lon,
          // Setting current point as previos point!
          d_lat1 = d_lat2;
          d_lon1 = d_lon2;
+
+         // Skip the lines that are completely above or below the
+         // point, they do not change the counter.
+         uint32 next =
+            GeometryKernels::findLatCrossing( coords, i + 1, nbrCoordinates,
+                                              GeometryKernels::LAT_LON,
+                                              lat );
+         if ( next != i + 1 ) {
+            d_lat1 = coords[2 * (next - 1)] - lat;
+            d_lon1 = coords[2 * (next - 1) + 1] - lon;
+         }
+         i = next;
       }
 #ifdef __linux
       //if(counter % 4) {
@@ -0,0 +1,183 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "PreparedGfxData.h"
+
+#include "GfxData.h"
+
+namespace {
+/// The max number of bands of a polygon.
+const uint32 MAX_NBR_BANDS = 4096;
+/// The average number of edges per band to aim for.
+const uint32 EDGES_PER_BAND = 4;
+}
+
+PreparedGfxData::PreparedGfxData( const GfxData& gfx )
+      : m_closed( false ),
+        m_minLat( 0 ),
+        m_maxLat( 0 ),
+        m_minLon( 0 ),
+        m_maxLon( 0 ) {
+   // Same check as GfxData::insidePolygon, anything else is outside.
+   if ( ! gfx.closed() || gfx.getNbrPolygons() == 0 ||
+        gfx.getNbrCoordinates( 0 ) == 0 ) {
+      return;
+   }
+   m_closed = true;
+   m_minLat = gfx.getMinLat();
+   m_maxLat = gfx.getMaxLat();
+   m_minLon = gfx.getMinLon();
+   m_maxLon = gfx.getMaxLon();
+   for ( uint16 p = 0; p < gfx.getNbrPolygons(); ++p ) {
+      addPolygon( gfx, p );
+   }
+}
+
+uint32
+PreparedGfxData::getBand( const Polygon& poly, int32 lat ) {
+   return uint32( ( int64( lat ) - poly.minLat ) / poly.bandHeight );
+}
+
+void
+PreparedGfxData::addPolygon( const GfxData& gfx, uint16 p ) {
+   m_polygons.push_back( Polygon() );
+   Polygon& poly = m_polygons.back();
+   poly.nbrCoords = gfx.getNbrCoordinates( p );
+   poly.lastLat = 0;
+   poly.lastLon = 0;
+   poly.minLat = MAX_INT32;
+   poly.maxLat = MIN_INT32;
+   poly.bandHeight = 1;
+   if ( poly.nbrCoords == 0 ) {
+      return;
+   }
+   poly.lastLat = gfx.getLastLat( p );
+   poly.lastLon = gfx.getLastLon( p );
+
+   // The edges in the order GfxData::insidePolygon visits them,
+   // starting with the one from the last coordinate.
+   std::vector<Edge> edges;
+   edges.reserve( poly.nbrCoords );
+   Edge edge;
+   edge.lat1 = poly.lastLat;
+   edge.lon1 = poly.lastLon;
+   for ( uint32 i = 0; i < poly.nbrCoords; ++i ) {
+      edge.lat2 = gfx.getLat( p, i );
+      edge.lon2 = gfx.getLon( p, i );
+      // Repeated coordinates are skipped by insidePolygon too.
+      if ( edge.lat1 != edge.lat2 || edge.lon1 != edge.lon2 ) {
+         edges.push_back( edge );
+         poly.minLat = MIN( poly.minLat, MIN( edge.lat1, edge.lat2 ) );
+         poly.maxLat = MAX( poly.maxLat, MAX( edge.lat1, edge.lat2 ) );
+      }
+      edge.lat1 = edge.lat2;
+      edge.lon1 = edge.lon2;
+   }
+   if ( edges.empty() ) {
+      return;
+   }
+
+   uint32 nbrBands = MIN( MAX( edges.size() / EDGES_PER_BAND, 1 ), 
+                          MAX_NBR_BANDS );
+   poly.bandHeight = 
+      ( int64( poly.maxLat ) - poly.minLat ) / nbrBands + 1;
+
+   // Count the edges per band, an edge is put in all bands it crosses.
+   std::vector<uint32> counts( nbrBands + 1, 0 );
+   for ( uint32 i = 0; i < edges.size(); ++i ) {
+      uint32 first = getBand( poly, MIN( edges[ i ].lat1, edges[ i ].lat2 ) );
+      uint32 last = getBand( poly, MAX( edges[ i ].lat1, edges[ i ].lat2 ) );
+      for ( uint32 b = first; b <= last; ++b ) {
+         ++counts[ b ];
+      }
+   }
+   poly.bandStart.resize( nbrBands + 1 );
+   uint32 pos = m_edges.size();
+   for ( uint32 b = 0; b <= nbrBands; ++b ) {
+      poly.bandStart[ b ] = pos;
+      pos += counts[ b ];
+   }
+   m_edges.resize( pos );
+   std::vector<uint32> next( poly.bandStart );
+   for ( uint32 i = 0; i < edges.size(); ++i ) {
+      uint32 first = getBand( poly, MIN( edges[ i ].lat1, edges[ i ].lat2 ) );
+      uint32 last = getBand( poly, MAX( edges[ i ].lat1, edges[ i ].lat2 ) );
+      for ( uint32 b = first; b <= last; ++b ) {
+         m_edges[ next[ b ]++ ] = edges[ i ];
+      }
+   }
+}
+
+int
+PreparedGfxData::insidePolygon( const Polygon& poly, 
+                                int32 lat, int32 lon ) const {
+   GfxData::coordinate_type d_lat1 = poly.lastLat - lat;
+   GfxData::coordinate_type d_lon1 = poly.lastLon - lon;
+   if ( d_lat1 == 0 && d_lon1 == 0 ) {
+      return 1;
+   }
+   if ( poly.bandStart.empty() || lat < poly.minLat || lat > poly.maxLat ) {
+      // No edge crosses the latitude of the point.
+      return 0;
+   }
+
+   // The same calculation as GfxData::insidePolygon, but only for the
+   // edges that can cross the latitude of the point.
+   int32 counter = 0;
+   const uint32 band = getBand( poly, lat );
+   for ( uint32 i = poly.bandStart[ band ]; 
+         i < poly.bandStart[ band + 1 ]; ++i ) {
+      const Edge& edge = m_edges[ i ];
+      d_lat1 = edge.lat1 - lat;
+      d_lon1 = edge.lon1 - lon;
+      GfxData::coordinate_type d_lat2 = edge.lat2 - lat;
+      GfxData::coordinate_type d_lon2 = edge.lon2 - lon;
+      if ( ( d_lat1 <= 0 && d_lat2 >= 0 ) ||
+           ( d_lat1 >= 0 && d_lat2 <= 0 ) ) {
+         int64 volprod = ((int64)d_lon1) * (d_lat2 - d_lat1)
+            - ((int64)d_lat1) * (d_lon2 - d_lon1);
+         if ( volprod == 0 ) {
+            if ( ( d_lon1 <= 0 && d_lon2 >= 0 ) ||
+                 ( d_lon1 >= 0 && d_lon2 <= 0 ) ) {
+               // On the edge
+               return 1;
+            }
+         } else if ( d_lat1 == 0 || d_lat2 == 0 ) {
+            counter += volprod > 0 ? 1 : -1;
+         } else {
+            counter += volprod > 0 ? 2 : -2;
+         }
+      }
+   }
+   return counter != 0 ? 2 : 0;
+}
+
+int
+PreparedGfxData::insidePolygon( int32 lat, int32 lon ) const {
+   if ( ! m_closed ||
+        lat < m_minLat || lat > m_maxLat ||
+        lon - m_maxLon > 0 || lon - m_minLon < 0 ) {
+      return 0;
+   }
+   for ( uint32 p = 0; p < m_polygons.size(); ++p ) {
+      if ( m_polygons[ p ].nbrCoords == 0 ) {
+         return 0;
+      }
+      int res = insidePolygon( m_polygons[ p ], lat, lon );
+      if ( res != 0 ) {
+         return res;
+      }
+   }
+   return 0;
+}
@@ -57,10 +57,14 @@ class NParamBlock {
 
       /**
        * Writes params to byte array.
+       *
+       * @param compressionLevel The gzip level to use if mayUseGzip,
+       *                         -1 for zlib default, 0-9.
        */
       void writeParams( vector< byte >& buff, byte protVer,
                         bool mayUseGzip = false,
-                        uint32* uncompressedSize = NULL ) const;
+                        uint32* uncompressedSize = NULL,
+                        int compressionLevel = -1 ) const;
 
 
       /**
@@ -0,0 +1,149 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#ifndef NPARAMBLOCKGZIPCACHE_H
+#define NPARAMBLOCKGZIPCACHE_H
+
+#include "config.h"
+#include "ISABThread.h"
+#include "NotCopyable.h"
+
+#include <vector>
+#include <list>
+#include <map>
+
+/**
+ * Cache of gzipped parameter blocks.
+ *
+ * Many replies, like category trees, server info and latest news, are
+ * identical for many clients. The cache keeps the gzipped data of the
+ * most recently used blocks, keyed on the crc of the block, so identical
+ * blocks are only compressed once. The uncompressed data is kept too
+ * and compared, so a crc collision never gives the wrong reply.
+ *
+ * Small blocks are cheap to compress and are not cached.
+ * The cache is thread safe.
+ */
+class NParamBlockGzipCache: private NotCopyable {
+public:
+   /// Blocks smaller than this are compressed but not cached.
+   static const uint32 MIN_CACHED_SIZE = 1024;
+
+   /// The default size of the cache.
+   static const uint32 DEFAULT_MAX_BYTES = 16*1024*1024;
+
+   /**
+    * Counters for the cache.
+    */
+   struct Statistics {
+      /// The number of blocks found in the cache.
+      uint32 hits;
+      /// The number of blocks compressed.
+      uint32 misses;
+      /// The number of blocks in the cache.
+      uint32 nbrEntries;
+      /// Bytes used by the cache.
+      uint32 bytes;
+   };
+
+   /**
+    * @param maxBytes The maximum number of uncompressed and compressed
+    *                 bytes to keep.
+    */
+   explicit NParamBlockGzipCache( uint32 maxBytes = DEFAULT_MAX_BYTES );
+
+   /**
+    * @return The cache used by NParamBlock::writeParams.
+    */
+   static NParamBlockGzipCache& getInstance();
+
+   /**
+    * Gzips data, using the cached result if the same data has been
+    * compressed before with the same level.
+    *
+    * @param data The data to compress.
+    * @param len The length of data.
+    * @param level The compression level, -1 for default, 0-9.
+    * @param out The gzipped data is appended to this.
+    * @return True if the data was compressed into fewer bytes than len,
+    *         if false nothing has been added to out.
+    */
+   bool gzip( const byte* data, uint32 len, int level, 
+              std::vector< byte >& out );
+
+   /**
+    * @return The counters for the cache.
+    */
+   Statistics getStatistics() const;
+
+private:
+   /// The key for a block.
+   struct Key {
+      uint32 crc;
+      uint32 len;
+      int level;
+
+      bool operator < ( const Key& o ) const {
+         if ( crc != o.crc ) {
+            return crc < o.crc;
+         }
+         if ( len != o.len ) {
+            return len < o.len;
+         }
+         return level < o.level;
+      }
+   };
+
+   /// A cached block.
+   struct Entry {
+      Key key;
+      /// The uncompressed block.
+      std::vector< byte > data;
+      /// The gzipped block.
+      std::vector< byte > gzipped;
+   };
+
+   typedef std::list< Entry > Entries;
+   typedef std::map< Key, Entries::iterator > Index;
+
+   /**
+    * Compresses data without using the cache.
+    */
+   static bool compress( const byte* data, uint32 len, int level,
+                         std::vector< byte >& out );
+
+   /// Removes the least recently used entries until size fits.
+   void evict();
+
+   /// The most recently used entry first.
+   Entries m_entries;
+
+   /// Finds the entries.
+   Index m_index;
+
+   /// Bytes in the entries.
+   uint32 m_bytes;
+
+   /// The maximum of m_bytes.
+   uint32 m_maxBytes;
+
+   /// Counters.
+   uint32 m_hits;
+   uint32 m_misses;
+
+   /// Protects the members.
+   mutable ISABMutex m_mutex;
+};
+
+#endif // NPARAMBLOCKGZIPCACHE_H
@@ -233,6 +233,25 @@ class NavPacket {
        */
       static uint8 magicBytes[];
 
+      /**
+       * Sets the gzip levels to use for the replies.
+       * The format is "default[,type:level]*", where the type is the
+       * number of the reply type and the levels are -1 for zlib default
+       * or 0-9. For example "6,0x2b:9,0x1f:1".
+       *
+       * @param levels The levels, NULL or empty string resets to -1 for
+       *               all types.
+       * @return True if levels could be parsed, if not nothing is
+       *         changed.
+       */
+      static bool setCompressionLevels( const char* levels );
+
+      /**
+       * @param type The type of packet.
+       * @return The gzip level to use for the type.
+       */
+      static int getCompressionLevel( uint16 type );
+
    protected:
        /// The protocol version.
        byte m_protoVer;
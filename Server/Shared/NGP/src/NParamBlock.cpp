@@ -15,6 +15,7 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include "TimeUtility.h"
 #include "Utility.h"
 #include "GzipUtil.h"
+#include "NParamBlockGzipCache.h"
 #include "GunzipUtil.h"
 #include "StringUtility.h"
 
@@ -144,7 +145,8 @@ NParamBlock::getAllParams( uint16 paramID,
 
 void
 NParamBlock::writeParams( vector< byte >& buff, byte protVer,
-                          bool mayUseGzip, uint32* uncompressedSize ) const 
+                          bool mayUseGzip, uint32* uncompressedSize,
+                          int compressionLevel ) const 
 {
    uint32 flags = 0x0;
    uint32 startSize = buff.size();
@@ -164,21 +166,18 @@ NParamBlock::writeParams( vector< byte >& buff, byte protVer,
       *uncompressedSize = buff.size();
    }
    if ( flags & 0x2 && mayUseGzip ) {
-      // Try gzip
+      // Try gzip, identical blocks are taken from the cache
       uint32 startTime = TimeUtility::getCurrentMicroTime();
       vector<byte> gzBuff( buff.begin(), buff.begin() + startSize );
       NParam::addUint32ToByteVector( gzBuff, flags | 0x1 ); /* gziped */
       uint32 flagsSize = 4;
-      gzBuff.resize( buff.size() );
-      mc2dbg4 << "gzBuff.size() " << gzBuff.size() << endl;
-      int gres = GzipUtil::gzip( &gzBuff.front() + startSize + flagsSize, 
-                                 gzBuff.size()   - startSize - flagsSize,
-                                 &buff.front()   + startSize + flagsSize, 
-                                 buff.size()     - startSize - flagsSize );
+      gzBuff.reserve( buff.size() );
+      bool gzipped = NParamBlockGzipCache::getInstance().gzip( 
+         &buff.front() + startSize + flagsSize,
+         buff.size()   - startSize - flagsSize,
+         compressionLevel, gzBuff );
       uint32 stopTime = TimeUtility::getCurrentMicroTime();
-      if ( gres > 0 ) {
-         gzBuff.erase( gzBuff.begin() + gres + startSize + flagsSize, 
-                       gzBuff.end() );
+      if ( gzipped ) {
          mc2dbg4 << "Gziped " << (buff.size() - 4) << " bytes into "
                 << gzBuff.size() << " bytes in " 
                 << (stopTime - startTime) << "us" << endl;
@@ -186,8 +185,8 @@ NParamBlock::writeParams( vector< byte >& buff, byte protVer,
 //                            gzBuff.size() );
          buff.swap( gzBuff );
       } else {
-         mc2dbg4 << "Gziped failed res " << gres << " size " 
-                << gzBuff.size() << " in " 
+         mc2dbg4 << "Gziped failed size " 
+                << buff.size() << " in " 
                 << (stopTime - startTime) << "us" << endl;
       }
    }
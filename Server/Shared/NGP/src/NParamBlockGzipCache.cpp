@@ -0,0 +1,124 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "NParamBlockGzipCache.h"
+
+#include "GzipUtil.h"
+#include "MC2CRC32.h"
+
+NParamBlockGzipCache::NParamBlockGzipCache( uint32 maxBytes )
+      : m_bytes( 0 ),
+        m_maxBytes( maxBytes ),
+        m_hits( 0 ),
+        m_misses( 0 ) {
+}
+
+NParamBlockGzipCache&
+NParamBlockGzipCache::getInstance() {
+   static NParamBlockGzipCache cache;
+   return cache;
+}
+
+bool
+NParamBlockGzipCache::compress( const byte* data, uint32 len, int level,
+                                vector< byte >& out ) {
+   const uint32 startSize = out.size();
+   // Only worth it if it gets smaller
+   out.resize( startSize + len );
+   int gres = GzipUtil::gzip( &out.front() + startSize, len,
+                              data, len, level );
+   if ( gres > 0 ) {
+      out.resize( startSize + gres );
+      return true;
+   } else {
+      out.resize( startSize );
+      return false;
+   }
+}
+
+bool
+NParamBlockGzipCache::gzip( const byte* data, uint32 len, int level,
+                            vector< byte >& out ) {
+   if ( len < MIN_CACHED_SIZE ) {
+      return compress( data, len, level, out );
+   }
+
+   Key key;
+   key.crc = MC2CRC32::crc32( data, len );
+   key.len = len;
+   key.level = level;
+
+   {
+      ISABSync sync( m_mutex );
+      Index::iterator it = m_index.find( key );
+      if ( it != m_index.end() &&
+           memcmp( &it->second->data.front(), data, len ) == 0 ) {
+         ++m_hits;
+         // Most recently used first
+         m_entries.splice( m_entries.begin(), m_entries, it->second );
+         const vector< byte >& gzipped = it->second->gzipped;
+         out.insert( out.end(), gzipped.begin(), gzipped.end() );
+         return true;
+      }
+      ++m_misses;
+   }
+
+   // Compress without holding the lock
+   const uint32 startSize = out.size();
+   if ( ! compress( data, len, level, out ) ) {
+      return false;
+   }
+
+   if ( len * 2 > m_maxBytes / 8 ) {
+      // Too large to be worth keeping
+      return true;
+   }
+
+   ISABSync sync( m_mutex );
+   if ( m_index.find( key ) != m_index.end() ) {
+      // Another thread added it meanwhile, or a crc collision
+      return true;
+   }
+   m_entries.push_front( Entry() );
+   Entry& entry = m_entries.front();
+   entry.key = key;
+   entry.data.assign( data, data + len );
+   entry.gzipped.assign( out.begin() + startSize, out.end() );
+   m_index[ key ] = m_entries.begin();
+   m_bytes += entry.data.size() + entry.gzipped.size();
+   evict();
+
+   return true;
+}
+
+void
+NParamBlockGzipCache::evict() {
+   while ( m_bytes > m_maxBytes && ! m_entries.empty() ) {
+      Entry& entry = m_entries.back();
+      m_bytes -= entry.data.size() + entry.gzipped.size();
+      m_index.erase( entry.key );
+      m_entries.pop_back();
+   }
+}
+
+NParamBlockGzipCache::Statistics
+NParamBlockGzipCache::getStatistics() const {
+   ISABSync sync( m_mutex );
+   Statistics stats;
+   stats.hits = m_hits;
+   stats.misses = m_misses;
+   stats.nbrEntries = m_entries.size();
+   stats.bytes = m_bytes;
+   return stats;
+}
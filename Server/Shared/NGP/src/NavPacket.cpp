@@ -14,9 +14,68 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include "NavPacket.h"
 #include "MC2CRC32.h"
 
+#include <map>
+#include <stdlib.h>
+
 
 byte NavPacket::MAX_PROTOVER = 0x0c;
 
+namespace {
+/// The gzip level per reply type, set once at startup.
+typedef map< uint16, int > CompressionLevels;
+CompressionLevels compressionLevels;
+/// The gzip level for types not in compressionLevels.
+int defaultCompressionLevel = -1;
+
+bool parseLevel( const char* str, char** end, int& level ) {
+   long val = strtol( str, end, 0 );
+   if ( *end == str || val < -1 || val > 9 ) {
+      return false;
+   }
+   level = val;
+   return true;
+}
+}
+
+bool
+NavPacket::setCompressionLevels( const char* levels ) {
+   CompressionLevels newLevels;
+   int newDefault = -1;
+   if ( levels != NULL && levels[ 0 ] != '\0' ) {
+      char* end = NULL;
+      if ( ! parseLevel( levels, &end, newDefault ) ) {
+         return false;
+      }
+      while ( *end == ',' ) {
+         const char* typeStr = end + 1;
+         unsigned long type = strtoul( typeStr, &end, 0 );
+         if ( end == typeStr || *end != ':' || type > MAX_UINT16 ) {
+            return false;
+         }
+         int level = -1;
+         if ( ! parseLevel( end + 1, &end, level ) ) {
+            return false;
+         }
+         newLevels[ type ] = level;
+      }
+      if ( *end != '\0' ) {
+         return false;
+      }
+   }
+   compressionLevels.swap( newLevels );
+   defaultCompressionLevel = newDefault;
+   return true;
+}
+
+int
+NavPacket::getCompressionLevel( uint16 type ) {
+   CompressionLevels::const_iterator it = compressionLevels.find( type );
+   if ( it != compressionLevels.end() ) {
+      return it->second;
+   }
+   return defaultCompressionLevel;
+}
+
 uint8 NavPacket::magicBytes[256] = {
    0x37, 0x77, 0x89, 0x05, 0x28, 0x72, 0x5b, 0x2a, 0xce, 0xe4, 0x44, 0x1a,
    0x28, 0x72, 0x5b, 0x2a, 0xce, 0xe4, 0x44, 0x1a, 0x79, 0x8a, 0xdb, 0x90,
@@ -230,7 +289,8 @@ NavPacket::writeLengthAndParams( vector< byte >& buff,
                                  uint32* uncompressedSize ) const
 {
    // ParamBlock
-   m_params.writeParams( buff, m_protoVer, mayUseGzip, uncompressedSize );
+   m_params.writeParams( buff, m_protoVer, mayUseGzip, uncompressedSize,
+                         getCompressionLevel( m_type ) );
    if ( uncompressedSize ) {
       *uncompressedSize += 4; // crc
    }
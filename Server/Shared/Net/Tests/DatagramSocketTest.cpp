@@ -0,0 +1,93 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "MC2UnitTestMain.h"
+
+#include "DatagramSocket.h"
+#include "IPnPort.h"
+#include "NetUtility.h"
+#include "DeleteHelpers.h"
+
+#include <string.h>
+
+namespace {
+
+/// @return A packet of length bytes with the payload filled with value.
+Packet* makePacket( uint32 length, byte value ) {
+   Packet* packet = new Packet( length );
+   memset( packet->getBuf() + HEADER_SIZE, value, length - HEADER_SIZE );
+   packet->setLength( length );
+   return packet;
+}
+
+/// @return True if the packets have the same length and contents.
+bool samePacket( const Packet* a, const Packet* b ) {
+   return a->getLength() == b->getLength() &&
+      memcmp( a->getBuf(), b->getBuf(), a->getLength() ) == 0;
+}
+
+}
+
+MC2_UNIT_TEST_FUNCTION( datagramBatchTest ) {
+   DatagramReceiver receiver( 34711, DatagramReceiver::FINDFREEPORT );
+   DatagramSender sender;
+   const IPnPort dest( NetUtility::iptoh( "127.0.0.1" ), receiver.getPort() );
+
+   // Different sizes, the largest one the max of one UDP.
+   const uint32 nbrPackets = 5;
+   const uint32 lengths[ nbrPackets ] = {
+      HEADER_SIZE, HEADER_SIZE + 1, 100, 1500, Packet::MAX_UDP_PACKET_SIZE
+   };
+   vector<Packet*> sent;
+   vector<IPnPort> dests( nbrPackets, dest );
+   for ( uint32 i = 0; i < nbrPackets; ++i ) {
+      sent.push_back( makePacket( lengths[ i ], byte( 'a' + i ) ) );
+   }
+
+   MC2_TEST_REQUIRED( sender.sendBatch( &sent.front(), &dests.front(),
+                                        nbrPackets ) == nbrPackets );
+   MC2_TEST_CHECK( sender.getStatistics().datagrams == nbrPackets );
+#ifdef __linux
+   // All in one sendmmsg.
+   MC2_TEST_CHECK( sender.getStatistics().syscalls == 1 );
+#endif
+
+   // The limit is kept and the rest are left for the next call.
+   vector<Packet*> received;
+   MC2_TEST_REQUIRED( receiver.receivePackets( received, 3 ) == 3 );
+   MC2_TEST_REQUIRED( received.size() == 3 );
+   MC2_TEST_REQUIRED( receiver.receivePackets( received, 16 ) == 2 );
+   MC2_TEST_REQUIRED( received.size() == nbrPackets );
+
+   for ( uint32 i = 0; i < nbrPackets; ++i ) {
+      MC2_TEST_CHECK( received[ i ]->getLength() == lengths[ i ] );
+      // Buffers the size of the datagrams.
+      MC2_TEST_CHECK( received[ i ]->getBufSize() == lengths[ i ] );
+      MC2_TEST_CHECK( samePacket( received[ i ], sent[ i ] ) );
+   }
+
+   MC2_TEST_CHECK( receiver.getStatistics().datagrams == nbrPackets );
+#ifdef __linux
+   // One recvmmsg per call.
+   MC2_TEST_CHECK( receiver.getStatistics().syscalls == 2 );
+#endif
+
+   uint32 ip = 0;
+   uint16 port = 0;
+   MC2_TEST_CHECK( receiver.getPeerName( ip, port ) );
+   MC2_TEST_CHECK( ip == dest.getIP() );
+
+   STLUtility::deleteValues( sent );
+   STLUtility::deleteValues( received );
+}
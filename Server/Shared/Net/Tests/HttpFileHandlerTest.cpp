@@ -0,0 +1,110 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "MC2UnitTestMain.h"
+
+#include "HttpFileHandler.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+namespace {
+
+/// Writes a file in the test root.
+void writeFile( const MC2String& root, const char* name,
+                const MC2String& data ) {
+   FILE* f = fopen( ( root + name ).c_str(), "w" );
+   fwrite( data.data(), 1, data.size(), f );
+   fclose( f );
+}
+
+/// Reads a file with the handler into a string.
+MC2String readFile( HttpFileHandler& files, const char* name ) {
+   int length = 0;
+   struct stat status;
+   byte* data = files.getFile( name, length, &status );
+   if ( data == NULL ) {
+      return "<NULL>";
+   }
+   MC2String res( (const char*)data, length );
+   delete [] data;
+   return res;
+}
+
+}
+
+MC2_UNIT_TEST_FUNCTION( httpFileHandlerTest ) {
+   char tmpl[] = "/tmp/HttpFileHandlerTestXXXXXX";
+   MC2_TEST_REQUIRED( mkdtemp( tmpl ) != NULL );
+   const MC2String root( tmpl );
+
+   const MC2String text( 90, 'a' );
+   writeFile( root, "/a.txt", text );
+   writeFile( root, "/b.txt", text );
+   writeFile( root, "/large.bin", MC2String( 200, 'l' ) );
+   writeFile( root, "/tags.html", "<!--ISAB_TAGS" + MC2String( 200, 't' ) );
+
+   // Room for one small file and its gzipped copy, check every time.
+   HttpFileHandler files( root, 150, 100, 0 );
+
+   MC2_TEST_CHECK( readFile( files, "/a.txt" ) == text );
+   MC2_TEST_CHECK( readFile( files, "/../a.txt" ) == "<NULL>" );
+   MC2_TEST_CHECK( readFile( files, "/none.txt" ) == "<NULL>" );
+
+   // The gzipped copy is made from the cached file.
+   int length = 0;
+   byte* gzipped = files.getGzippedFile( "/a.txt", length );
+   MC2_TEST_REQUIRED( gzipped != NULL );
+   MC2_TEST_CHECK( length > 0 && length < int( text.size() ) );
+   MC2_TEST_CHECK( gzipped[ 0 ] == 0x1f && gzipped[ 1 ] == 0x8b );
+   delete [] gzipped;
+
+   // A changed file is read again.
+   writeFile( root, "/a.txt", "changed" );
+   MC2_TEST_CHECK( readFile( files, "/a.txt" ) == "changed" );
+
+   // Reading b pushes a out of the cache.
+   MC2_TEST_CHECK( readFile( files, "/b.txt" ) == text );
+   MC2_TEST_CHECK( files.getGzippedFile( "/a.txt", length ) == NULL );
+   gzipped = files.getGzippedFile( "/b.txt", length );
+   MC2_TEST_CHECK( gzipped != NULL );
+   delete [] gzipped;
+
+   // Large files are opened, but not pages with tags.
+   struct stat status;
+   MC2_TEST_CHECK( files.openLargeFile( "/b.txt", &status ) == -1 );
+   MC2_TEST_CHECK( files.openLargeFile( "/tags.html", &status ) == -1 );
+   int fd = files.openLargeFile( "/large.bin", &status );
+   MC2_TEST_CHECK( fd != -1 );
+   MC2_TEST_CHECK( status.st_size == 200 );
+   close( fd );
+   MC2_TEST_CHECK( readFile( files, "/large.bin" ) == MC2String( 200, 'l' ) );
+
+   // Room for both small files, but the gzipped copy of b pushes a out.
+   HttpFileHandler twoFiles( root, 200, 100, 0 );
+   writeFile( root, "/a.txt", text );
+   MC2_TEST_CHECK( readFile( twoFiles, "/a.txt" ) == text );
+   MC2_TEST_CHECK( readFile( twoFiles, "/b.txt" ) == text );
+   gzipped = twoFiles.getGzippedFile( "/b.txt", length );
+   MC2_TEST_CHECK( gzipped != NULL );
+   delete [] gzipped;
+   MC2_TEST_CHECK( twoFiles.getGzippedFile( "/a.txt", length ) == NULL );
+
+   const char* names[] = { "/a.txt", "/b.txt", "/large.bin", "/tags.html" };
+   for ( uint32 i = 0; i < NBR_ITEMS( names ); ++i ) {
+      unlink( ( root + names[ i ] ).c_str() );
+   }
+   rmdir( root.c_str() );
+}
@@ -0,0 +1,215 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "MC2UnitTestMain.h"
+
+#include "ParallelURLFetcher.h"
+
+#include "TCPSocket.h"
+#include "ISABThread.h"
+#include "TimeUtility.h"
+#include "STLStringUtility.h"
+
+//
+// Tests the ParallelURLFetcher against a small local http server.
+//
+
+namespace {
+
+/**
+ *   Answers the requests on one connection. The path decides the reply:
+ *   /length   "hello" with Content-Length.
+ *   /chunked  "hello" in two chunks.
+ *   /delay    "late" after 300 ms.
+ *   /slow     "slow" after 1500 ms.
+ *   /close    "bye" and closes the connection.
+ */
+class Connection: public ISABThread {
+public:
+   explicit Connection( TCPSocket* sock ): m_sock( sock ) {
+   }
+
+   void run() {
+      MC2String in;
+      byte buf[ 4096 ];
+      while ( ! terminated ) {
+         MC2String::size_type end = in.find( "\r\n\r\n" );
+         if ( end == MC2String::npos ) {
+            ssize_t res = m_sock->read( buf, sizeof( buf ), 100000 );
+            if ( res == -2 ) {
+               continue;
+            }
+            if ( res <= 0 ) {
+               break;
+            }
+            in.append( (const char*)buf, res );
+            continue;
+         }
+         MC2String path = in.substr( 4, in.find( ' ', 4 ) - 4 );
+         in.erase( 0, end + 4 );
+         MC2String reply;
+         bool close = false;
+         if ( path == "/length" ) {
+            reply = "HTTP/1.1 200 OK\r\nContent-Length: 5\r\n\r\nhello";
+         } else if ( path == "/chunked" ) {
+            reply = "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n"
+               "3\r\nhel\r\n2\r\nlo\r\n0\r\n\r\n";
+         } else if ( path == "/delay" ) {
+            ISABThread::sleep( 300 );
+            reply = "HTTP/1.1 200 OK\r\nContent-Length: 4\r\n\r\nlate";
+         } else if ( path == "/slow" ) {
+            ISABThread::sleep( 1500 );
+            reply = "HTTP/1.1 200 OK\r\nContent-Length: 4\r\n\r\nslow";
+         } else if ( path == "/close" ) {
+            reply = "HTTP/1.1 200 OK\r\nConnection: close\r\n\r\nbye";
+            close = true;
+         } else {
+            reply = "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n\r\n";
+         }
+         if ( m_sock->writeAll( (const byte*)reply.data(), 
+                                reply.size() ) != ssize_t( reply.size() ) ||
+              close ) {
+            break;
+         }
+      }
+      delete m_sock;
+   }
+
+private:
+   TCPSocket* m_sock;
+};
+
+/**
+ *   Accepts connections and counts them.
+ */
+class Server: public ISABThread {
+public:
+   Server(): m_port( 0 ), m_nbrAccepted( 0 ) {
+      m_listen.open();
+      m_port = m_listen.listen( 18080, TCPSocket::FINDFREEPORT );
+   }
+
+   void run() {
+      while ( ! terminated ) {
+         TCPSocket* sock = m_listen.accept( 100000 );
+         if ( sock == NULL ) {
+            continue;
+         }
+         {
+            ISABSync sync( m_mutex );
+            ++m_nbrAccepted;
+         }
+         ISABThreadHandle conn = new Connection( sock );
+         conn->start();
+         m_connections.push_back( conn );
+      }
+      for ( uint32 i = 0; i < m_connections.size(); ++i ) {
+         m_connections[ i ]->terminate();
+         m_connections[ i ]->join();
+      }
+   }
+
+   uint16 getPort() const { return m_port; }
+
+   uint32 getNbrAccepted() {
+      ISABSync sync( m_mutex );
+      return m_nbrAccepted;
+   }
+
+   URL getURL( const char* path ) const {
+      return URL( "http://localhost:" + 
+                  STLStringUtility::uint2str( m_port ) + path );
+   }
+
+private:
+   TCPSocket m_listen;
+   uint16 m_port;
+   ISABMutex m_mutex;
+   uint32 m_nbrAccepted;
+   vector< ISABThreadHandle > m_connections;
+};
+
+}
+
+MC2_UNIT_TEST_FUNCTION( parallelURLFetcherTest ) {
+   ISABThreadInitialize initThreads;
+   Server* server = new Server();
+   ISABThreadHandle serverHandle = server;
+   MC2_TEST_REQUIRED( server->getPort() != 0 );
+   server->start();
+
+   ParallelURLFetcher fetcher;
+   MC2String result;
+
+   // Content-Length and then chunked on the same connection
+   MC2_TEST_CHECK( fetcher.get( result, "test", server->getURL( "/length" ),
+                                2000 ) == 200 );
+   MC2_TEST_CHECK( result == "hello" );
+   MC2_TEST_CHECK( fetcher.getNbrIdleConnections() == 1 );
+   MC2_TEST_CHECK( fetcher.get( result, "test", server->getURL( "/chunked" ),
+                                2000 ) == 200 );
+   MC2_TEST_CHECK( result == "hello" );
+   MC2_TEST_CHECK( server->getNbrAccepted() == 1 );
+
+   // Read until closed, the connection is not kept
+   MC2_TEST_CHECK( fetcher.get( result, "test", server->getURL( "/close" ),
+                                2000 ) == 200 );
+   MC2_TEST_CHECK( result == "bye" );
+   MC2_TEST_CHECK( fetcher.getNbrIdleConnections() == 0 );
+
+   // Three delayed requests at once take about as long as one
+   ParallelURLFetcher::Request first( "delay", server->getURL( "/delay" ) );
+   ParallelURLFetcher::Request second( "delay", server->getURL( "/delay" ) );
+   ParallelURLFetcher::Request third( "delay", server->getURL( "/delay" ) );
+   vector< ParallelURLFetcher::Request* > requests;
+   requests.push_back( &first );
+   requests.push_back( &second );
+   requests.push_back( &third );
+   uint32 startTime = TimeUtility::getCurrentTime();
+   fetcher.fetch( requests, 2000 );
+   uint32 time = TimeUtility::getCurrentTime() - startTime;
+   for ( uint32 i = 0; i < requests.size(); ++i ) {
+      MC2_TEST_CHECK( requests[ i ]->getStatus() == 200 );
+      MC2_TEST_CHECK( requests[ i ]->getBody() == "late" );
+      MC2_TEST_CHECK( requests[ i ]->getTime() >= 300 );
+   }
+   MC2_TEST_CHECK( time < 800 );
+   MC2_TEST_CHECK( fetcher.getNbrIdleConnections() == 3 );
+
+   // Timeout
+   ParallelURLFetcher::Request slow( "slow", server->getURL( "/slow" ) );
+   ParallelURLFetcher::Request fast( "test", server->getURL( "/length" ) );
+   requests.clear();
+   requests.push_back( &slow );
+   requests.push_back( &fast );
+   fetcher.fetch( requests, 500 );
+   MC2_TEST_CHECK( slow.getStatus() == -2 );
+   MC2_TEST_CHECK( fast.getStatus() == 200 );
+   MC2_TEST_CHECK( fast.getBody() == "hello" );
+
+   // Invalid url
+   MC2_TEST_CHECK( fetcher.get( result, "test", URL( "/no/host" ), 
+                                100 ) == -15 );
+
+   ParallelURLFetcher::Statistics stats = ParallelURLFetcher::getStatistics();
+   MC2_TEST_CHECK( stats[ "test" ].nbrRequests == 5 );
+   MC2_TEST_CHECK( stats[ "test" ].nbrErrors == 1 );
+   MC2_TEST_CHECK( stats[ "test" ].nbrReused >= 2 );
+   MC2_TEST_CHECK( stats[ "delay" ].nbrRequests == 3 );
+   MC2_TEST_CHECK( stats[ "delay" ].maxTime >= 300 );
+   MC2_TEST_CHECK( stats[ "slow" ].nbrTimeouts == 1 );
+
+   server->terminate();
+   server->join();
+}
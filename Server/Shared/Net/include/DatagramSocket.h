@@ -18,6 +18,9 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include "Socket.h"
 #include "Packet.h"
 
+#include <vector>
+#include <iosfwd>
+
 class IPnPort;
 
 /*
@@ -46,8 +49,28 @@ class IPnPort;
  */
 class DatagramSocket : public Socket {
 public:
+   /**
+    *   The number of system calls and datagrams of a socket.
+    *   Sockets are used by one thread at a time so the counters
+    *   are not locked.
+    */
+   struct Statistics {
+      Statistics();
+
+      /// The number of send or receive system calls.
+      uint64 syscalls;
+      /// The number of datagrams sent or received.
+      uint64 datagrams;
+
+      /// @return The average number of datagrams per system call.
+      float getDatagramsPerSyscall() const;
+   };
+
    virtual selectable getSelectable() const;
 
+   /// @return The system call statistics of this socket.
+   const Statistics& getStatistics() const;
+
    protected:
       /**
         *   Create a new DatagramSocket. Declaired protected to avoid
@@ -75,8 +98,17 @@ public:
        *   when called in different threads at the same time
        */
       static int c_udp_proto_nbr;
+
+      /**
+       *   The system call statistics.
+       */
+      Statistics m_stats;
 };
 
+/// Prints the statistics on one line.
+std::ostream& operator << ( std::ostream& stream,
+                            const DatagramSocket::Statistics& stats );
+
 /**
  *    Objects of this class is to be used when sending mc2-packets or
  *    other data via UDP.
@@ -119,6 +151,22 @@ class DatagramSender : public DatagramSocket {
        */
       bool send( byte* buffer, uint32 buffSize, uint32 ip, uint16 port );
 
+      /**
+       *    Sends packets, each in one UDP, with as few system calls
+       *    as possible. Uses sendmmsg where available and one sendto
+       *    per packet elsewhere. The packets must fit in one UDP.
+       *
+       *    @param packets    The packets to send.
+       *    @param destAddrs  The destination of each packet.
+       *    @param nbrPackets The number of packets.
+       *    @return The number of packets sent before the first one that
+       *            failed, errno tells why that one failed. nbrPackets
+       *            if all were sent.
+       */
+      uint32 sendBatch( const Packet* const* packets,
+                        const IPnPort* destAddrs,
+                        uint32 nbrPackets );
+
    private:
       /**
        * Sends a header and data part.
@@ -208,6 +256,22 @@ class DatagramReceiver : public DatagramSocket {
        */
       int32 receive( byte* buff, uint32 buffSize, uint32 micros );
 
+      /**
+       *    Receives the datagrams waiting on the socket with as few
+       *    system calls as possible. Uses recvmmsg where available and
+       *    receives one datagram per call elsewhere. Hangs until the
+       *    first datagram is received, the rest are only taken if they
+       *    are already waiting. After the call getPeerName returns the
+       *    address of the last datagram.
+       *
+       *    @param packets The received packets are added here, with
+       *                   buffers the size of their datagrams. The
+       *                   caller must delete them.
+       *    @param maxNbr  The max number of datagrams to receive.
+       *    @return The number of packets added, < 0 means error.
+       */
+      int32 receivePackets( std::vector<Packet*>& packets, uint32 maxNbr );
+
       /**
         *   Used to make this receiver join a multicast group.
         *   @param   ip The ip of the multicast group to join.
@@ -255,6 +319,12 @@ class DatagramReceiver : public DatagramSocket {
        * Is set to contain only zeros in constructor and before each receive.
        */
       struct sockaddr_in m_peerAddr;
+
+      /**
+       * The buffers that receivePackets receives into, 
+       * Packet::MAX_UDP_PACKET_SIZE bytes per datagram.
+       */
+      std::vector<byte> m_batchBuffer;
 };
 
 
@@ -264,6 +334,11 @@ DatagramSocket::getSelectable() const {
    return fd;
 }
 
+inline const DatagramSocket::Statistics&
+DatagramSocket::getStatistics() const {
+   return m_stats;
+}
+
 
 #endif //DATAGRAMSOCKET_H
 
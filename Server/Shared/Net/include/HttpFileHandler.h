@@ -19,6 +19,10 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include "config.h"
 #include "MC2String.h"
 #include "NotCopyable.h"
+
+#include <map>
+#include <list>
+#include <vector>
 #ifdef __linux
 #include <sys/stat.h>
 #endif
@@ -31,6 +35,15 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 /**
  * HttpFileHandler - Handles files for the http-server.
  *
+ * Files up to a maximum size are kept in memory, least recently used
+ * first out, together with a gzipped copy made the first time it is
+ * asked for. A cached file is checked against the file on disk at most
+ * once per check interval and is read again if its modification time,
+ * size or inode has changed. Larger files are not cached, they can be
+ * opened with openLargeFile and sent straight from the file.
+ *
+ * Not thread safe, the caller must lock.
+ *
  * @version 1.0
  */
 class HttpFileHandler: private NotCopyable {
@@ -41,6 +54,21 @@ class HttpFileHandler: private NotCopyable {
       HttpFileHandler();
 
 
+      /**
+       * Constructor with explicit settings, mainly for tests.
+       * @param htmlRoot The path to the html root.
+       * @param maxCacheSize The maximum number of bytes to cache,
+       *        0 disables the cache.
+       * @param maxFileSize The largest file to cache.
+       * @param checkInterval Seconds between checks of a cached file
+       *        against the file on disk.
+       */
+      HttpFileHandler( const MC2String& htmlRoot,
+                       uint32 maxCacheSize,
+                       uint32 maxFileSize,
+                       uint32 checkInterval );
+
+
       /**
        *  Removes allocated resources.
        */
@@ -57,6 +85,31 @@ class HttpFileHandler: private NotCopyable {
       byte* getFile(const MC2String& fileString, 
                     int& length, 
                     struct stat* status);
+
+
+      /**
+       * Delivers the gzipped version of a cached file, made the first
+       * time it is asked for. Call after getFile for the same file.
+       * The user must delete the file.
+       * @param fileString is the path and name of the file.
+       * @param length is set to the length of the buffer.
+       * @return the gzipped file, NULL if the file is not cached or
+       *         does not get smaller when gzipped.
+       */
+      byte* getGzippedFile( const MC2String& fileString, int& length );
+
+
+      /**
+       * Opens a regular file that is too large to be cached, for
+       * sending it straight from the file. Pages with tags are never
+       * returned.
+       * @param fileString is the path and name of the file.
+       * @param status is set to the status of the file.
+       * @return The open file descriptor that the user must close,
+       *         -1 if the file is not a large regular file.
+       */
+      int openLargeFile( const MC2String& fileString, 
+                         struct stat* status );
       
    
       /**
@@ -71,9 +124,105 @@ class HttpFileHandler: private NotCopyable {
       
 
    private:
+      /**
+       * Converts the html root to use the separators of the platform.
+       */
+      void fixRootSeparators();
+
+
+      /**
+       * Makes the path on disk of a requested file.
+       * @param fileString is the path and name of the file.
+       * @param fileName Set to the path on disk.
+       * @return False if the file is outside the html root.
+       */
+      bool makeFileName( const MC2String& fileString, 
+                         MC2String& fileName ) const;
+
+
+      /**
+       * Reads a file from disk.
+       * @param fileName The path on disk.
+       * @param length is set to the length of the buffer.
+       * @param status is set to the status of the file.
+       * @return the file as a byte vector, NULL if not a readable file.
+       */
+      byte* readFile( const MC2String& fileName, 
+                      int& length, 
+                      struct stat* status );
+
+
+      /// A file in the cache.
+      struct CachedFile {
+         /// The content of the file.
+         std::vector<byte> data;
+         /// The gzipped content, empty if not made or not smaller.
+         std::vector<byte> gzipped;
+         /// If the gzipped content has been made.
+         bool gzipTried;
+         /// The status of the file when read.
+         struct stat status;
+         /// When the file was last checked against the disk.
+         uint32 checkTime;
+         /// The position in m_lru.
+         std::list< MC2String >::iterator lruPos;
+      };
+
+
+      typedef std::map< MC2String, CachedFile* > FileMap;
+
+
+      /**
+       * Finds a cached file that is still the same as on disk.
+       * Removes it from the cache if changed.
+       * @param fileName The path on disk.
+       * @return The cached file or NULL if not cached.
+       */
+      CachedFile* findCached( const MC2String& fileName );
+
+
+      /**
+       * Adds a file to the cache, removing the least recently used
+       * files if needed.
+       */
+      void addCached( const MC2String& fileName, const byte* data,
+                      uint32 length, const struct stat& status );
+
+
+      /**
+       * Removes the least recently used files until length more
+       * bytes fit in the cache.
+       */
+      void makeRoom( uint32 length );
+
+
+      /**
+       * Removes a file from the cache.
+       */
+      void removeCached( FileMap::iterator it );
+
+
       /** 
        * The path to the html-root
        */
       MC2String* m_htmlRoot;
+
+      /// The maximum number of bytes in the cache.
+      uint32 m_maxCacheSize;
+
+      /// The largest file to cache.
+      uint32 m_maxFileSize;
+
+      /// Seconds between checks of a cached file against the disk.
+      uint32 m_checkInterval;
+
+      /// The cached files by path on disk.
+      FileMap m_files;
+
+      /// The paths of the cached files, least recently used first.
+      std::list< MC2String > m_lru;
+
+      /// The number of bytes in the cache, including gzipped copies.
+      uint32 m_cacheSize;
 };
 #endif // HTTPFILEHANDLER_H 
@@ -0,0 +1,258 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#ifndef PARALLEL_URL_FETCHER_H
+#define PARALLEL_URL_FETCHER_H
+
+#include "config.h"
+
+#include "MC2String.h"
+#include "NotCopyable.h"
+#include "HttpHeader.h"
+#include "URL.h"
+
+#include <map>
+#include <vector>
+#include <deque>
+#include <memory>
+
+class TCPSocket;
+class URLFetcher;
+
+/**
+ *   Fetches several urls at the same time over http.
+ *
+ *   All requests given to fetch are sent at once on non-blocking
+ *   sockets and the replies are read as they arrive, so the time for
+ *   a set of requests is the time of the slowest one instead of the sum.
+ *   Connections are kept alive and reused for later requests to the
+ *   same host and port. Idle connections are closed after a while.
+ *
+ *   Urls that are not http, e.g. https and file, are fetched one at a
+ *   time with a URLFetcher.
+ *
+ *   The time and result of each request are summed per provider in
+ *   statistics shared by all fetchers in the process.
+ *
+ *   Not thread safe, but the statistics are.
+ */
+class ParallelURLFetcher: private NotCopyable {
+public:
+   /// The default maximum number of idle connections per host.
+   static const uint32 DEFAULT_MAX_IDLE_PER_HOST = 4;
+
+   /// The default number of seconds to keep an idle connection.
+   static const uint32 DEFAULT_IDLE_TIMEOUT = 30;
+
+   /**
+    *   A request and its reply.
+    */
+   class Request {
+   public:
+      /**
+       *   @param provider The name of the provider, for the statistics.
+       *   @param url      The url to get or post to.
+       *   @param postData Data to post, get if empty.
+       *   @param inHeaders Extra headers to send, not copied.
+       */
+      Request( const MC2String& provider,
+               const URL& url,
+               const MC2String& postData = MC2String(),
+               const HttpHeader* inHeaders = NULL );
+
+      /// @return The name of the provider.
+      const MC2String& getProvider() const { return m_provider; }
+
+      /// @return The url.
+      const URL& getURL() const { return m_url; }
+
+      /**
+       *   @return The status code from http. Negative numbers for
+       *           other errors, -2 for timeout, like URLFetcherNoSSL.
+       */
+      int getStatus() const { return m_status; }
+
+      /// @return The headers of the reply.
+      const HttpHeader& getHeader() const { return m_header; }
+
+      /// @return The body of the reply.
+      MC2String& getBody() { return m_body; }
+
+      /// @return The time the request took in milliseconds.
+      uint32 getTime() const { return m_time; }
+
+   private:
+      friend class ParallelURLFetcher;
+
+      /// The name of the provider.
+      MC2String m_provider;
+      /// The url.
+      URL m_url;
+      /// The data to post.
+      MC2String m_postData;
+      /// Extra headers.
+      const HttpHeader* m_inHeaders;
+      /// The result.
+      int m_status;
+      /// The reply headers.
+      HttpHeader m_header;
+      /// The reply body.
+      MC2String m_body;
+      /// The time in ms.
+      uint32 m_time;
+   };
+
+   /**
+    *   The statistics for one provider.
+    */
+   struct ProviderStatistics {
+      ProviderStatistics();
+
+      /// The number of requests.
+      uint32 nbrRequests;
+      /// Requests that failed, including timeouts.
+      uint32 nbrErrors;
+      /// Requests that timed out.
+      uint32 nbrTimeouts;
+      /// Requests sent on a kept alive connection.
+      uint32 nbrReused;
+      /// The summed time of the requests in ms.
+      uint64 totalTime;
+      /// The longest time of a request in ms.
+      uint32 maxTime;
+   };
+
+   /// Statistics per provider name.
+   typedef std::map< MC2String, ProviderStatistics > Statistics;
+
+   /**
+    *   @param maxIdlePerHost The maximum number of idle connections to
+    *                         keep per host and port.
+    *   @param idleTimeout    Seconds to keep an idle connection.
+    */
+   explicit ParallelURLFetcher( 
+      uint32 maxIdlePerHost = DEFAULT_MAX_IDLE_PER_HOST,
+      uint32 idleTimeout = DEFAULT_IDLE_TIMEOUT );
+
+   /**
+    *   Closes the idle connections.
+    */
+   ~ParallelURLFetcher();
+
+   /**
+    *   Sends all the requests and waits for the replies.
+    *
+    *   @param requests   The requests, the results are set in them.
+    *   @param timeout_ms The maximum time for all the requests.
+    */
+   void fetch( const std::vector< Request* >& requests,
+               uint32 timeout_ms );
+
+   /**
+    *   Gets one url.
+    *
+    *   @param result     Set to the body of the reply.
+    *   @param provider   The name of the provider, for the statistics.
+    *   @param url        The url.
+    *   @param timeout_ms The maximum time for the request.
+    *   @param inHeaders  Extra headers to send, default none.
+    *   @return The status code from http. Negative numbers for other
+    *           errors.
+    */
+   int get( MC2String& result,
+            const MC2String& provider,
+            const URL& url,
+            uint32 timeout_ms,
+            const HttpHeader* inHeaders = NULL );
+
+   /**
+    *   @return The number of idle connections kept.
+    */
+   uint32 getNbrIdleConnections() const;
+
+   /**
+    *   @return The statistics of all fetchers in the process.
+    */
+   static Statistics getStatistics();
+
+private:
+   /// A request in progress.
+   struct Transfer;
+
+   /// An idle connection.
+   struct IdleConnection {
+      /// The socket.
+      TCPSocket* sock;
+      /// When it was last used, in seconds.
+      uint32 lastUsed;
+   };
+
+   typedef std::map< MC2String, std::deque< IdleConnection > > IdlePool;
+
+   /**
+    *   Starts a transfer, on an idle connection if there is one.
+    *   @return False if it failed at once, the status is set then.
+    */
+   bool start( Transfer& transfer );
+
+   /**
+    *   Does the io that the socket of a transfer is ready for.
+    *   @return True when the transfer is done.
+    */
+   bool handleIO( Transfer& transfer, short revents );
+
+   /**
+    *   Parses what has been read so far.
+    *   @return True when the whole reply has been read.
+    */
+   bool parseReply( Transfer& transfer, bool closed );
+
+   /**
+    *   Finishes a transfer, keeps the connection if possible.
+    */
+   void finish( Transfer& transfer, int status );
+
+   /**
+    *   @return An idle connection to hostPort that is still open, or
+    *           NULL.
+    */
+   TCPSocket* getIdle( const MC2String& hostPort );
+
+   /**
+    *   Closes the idle connections that have been idle too long.
+    */
+   void closeOldIdle();
+
+   /**
+    *   Adds the results of the requests to the statistics.
+    */
+   static void addStatistics( const std::vector< Transfer >& transfers );
+
+   /// The maximum number of idle connections per host.
+   uint32 m_maxIdlePerHost;
+
+   /// Seconds to keep an idle connection.
+   uint32 m_idleTimeout;
+
+   /// The idle connections by "host:port".
+   IdlePool m_idle;
+
+   /// For the urls that are not http.
+   std::auto_ptr< URLFetcher > m_fallback;
+
+   /// User agent
+   MC2String m_userAgent;
+};
+
+#endif // PARALLEL_URL_FETCHER_H
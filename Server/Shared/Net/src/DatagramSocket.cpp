@@ -17,14 +17,29 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include "DatagramSocket.h"
 #include "NetUtility.h"
 #include "Properties.h"
+#include "AlignUtility.h"
 
 #include <stdlib.h>
+#include <iostream>
 
 #ifdef __linux
 // Defines __u32 and __u8 used by errqueue
 #include <asm/types.h>
 // Msg error queue used by recvmsg
 #include <linux/errqueue.h>
+#ifdef __GLIBC_PREREQ
+#if __GLIBC_PREREQ( 2, 14 )
+// recvmmsg and sendmmsg are available.
+#define HAVE_MMSG
+#endif
+#endif
+#endif
+
+#ifdef HAVE_MMSG
+namespace {
+/// Set if the kernel turns out not to have recvmmsg and sendmmsg.
+bool c_noMmsg = false;
+}
 #endif
 
 // ========================================================================
@@ -42,6 +57,29 @@ int DatagramSocket::c_udp_proto_nbr =
 int DatagramSocket::c_udp_proto_nbr = -1;
 #endif
 
+DatagramSocket::Statistics::Statistics()
+      : syscalls( 0 ),
+        datagrams( 0 )
+{
+}
+
+float
+DatagramSocket::Statistics::getDatagramsPerSyscall() const
+{
+   if ( syscalls == 0 ) {
+      return 0;
+   }
+   return float( datagrams ) / syscalls;
+}
+
+ostream& operator << ( ostream& stream,
+                       const DatagramSocket::Statistics& stats )
+{
+   return stream << "syscalls " << stats.syscalls 
+                 << " datagrams " << stats.datagrams
+                 << " per syscall " << stats.getDatagramsPerSyscall();
+}
+
 DatagramSocket::DatagramSocket()
 {
    if ( c_udp_proto_nbr <= 0 ) {
@@ -209,6 +247,7 @@ DatagramSender::send( byte* buffer, uint32 buffSize,
    addr.sin_addr.s_addr = htonl(ip);
    addr.sin_port = htons(port);
 
+   ++m_stats.syscalls;
    if (sendto( fd,
                (char *)buffer,
                buffSize,
@@ -230,6 +269,7 @@ DatagramSender::send( byte* buffer, uint32 buffSize,
             }
          ); // DEBUG
          usleep(100);
+         ++m_stats.syscalls;
          if (sendto( fd,
                      (char *)buffer,
                      buffSize,
@@ -238,6 +278,7 @@ DatagramSender::send( byte* buffer, uint32 buffSize,
                      sizeof(addr)   ) == 0) 
          {
             mc2dbg4 << "DatagramSender::send SendTo sent!" << endl;
+            ++m_stats.datagrams;
             return true;
          } else {
             mc2dbg4 << "DatagramSender Sendto: " 
@@ -252,10 +293,75 @@ DatagramSender::send( byte* buffer, uint32 buffSize,
       return false;
    }
 
-
+   ++m_stats.datagrams;
    return true;
 }
 
+uint32
+DatagramSender::sendBatch( const Packet* const* packets,
+                           const IPnPort* destAddrs,
+                           uint32 nbrPackets )
+{
+   for ( uint32 i = 0; i < nbrPackets; ++i ) {
+      // Should be sent by tcp if too large.
+      MC2_ASSERT( packets[ i ]->getLength() <= Packet::MAX_UDP_PACKET_SIZE );
+      ((Packet*)packets[ i ])->setNbrPackets( 1 );
+      ((Packet*)packets[ i ])->setPacketNbr( 0 );
+   }
+
+   uint32 nbrSent = 0;
+#ifdef HAVE_MMSG
+   if ( nbrPackets > 1 && ! c_noMmsg ) {
+      vector<struct mmsghdr> msgs( nbrPackets );
+      vector<struct iovec> iovecs( nbrPackets );
+      vector<struct sockaddr_in> addrs( nbrPackets );
+      for ( uint32 i = 0; i < nbrPackets; ++i ) {
+         addrs[ i ].sin_family = AF_INET;
+         addrs[ i ].sin_addr.s_addr = htonl( destAddrs[ i ].getIP() );
+         addrs[ i ].sin_port = htons( destAddrs[ i ].getPort() );
+         iovecs[ i ].iov_base = packets[ i ]->getBuf();
+         iovecs[ i ].iov_len = packets[ i ]->getLength();
+         msgs[ i ].msg_hdr.msg_name = &addrs[ i ];
+         msgs[ i ].msg_hdr.msg_namelen = sizeof( struct sockaddr_in );
+         msgs[ i ].msg_hdr.msg_iov = &iovecs[ i ];
+         msgs[ i ].msg_hdr.msg_iovlen = 1;
+      }
+
+      while ( nbrSent < nbrPackets ) {
+         int res = 0;
+         do {
+            errno = 0;
+            ++m_stats.syscalls;
+            res = sendmmsg( fd, &msgs[ nbrSent ], nbrPackets - nbrSent, 0 );
+         } while ( res < 0 && errno == EINTR );
+
+         if ( res < 0 && errno == ENOSYS ) {
+            mc2log << warn << "DatagramSender: no sendmmsg, "
+                   << "sending one packet per call" << endl;
+            c_noMmsg = true;
+            break;
+         }
+         if ( res <= 0 ) {
+            mc2dbg2 << "__sendmmsg: " << strerror( errno )
+                    << " sending to " << destAddrs[ nbrSent ] << endl;
+            return nbrSent;
+         }
+         // If not all were sent the next call gets the error
+         // of the first one not sent.
+         m_stats.datagrams += res;
+         nbrSent += res;
+      }
+   }
+#endif
+
+   for ( ; nbrSent < nbrPackets; ++nbrSent ) {
+      if ( ! send( packets[ nbrSent ], destAddrs[ nbrSent ] ) ) {
+         break;
+      }
+   }
+   return nbrSent;
+}
+
 
 // ========================================================================
 //                                                       DatagramReceiver =
@@ -374,6 +480,7 @@ DatagramReceiver::receive( byte* buff, uint32 buffSize )
 #ifdef EINTR
    do {
 #endif // EINTR
+      ++m_stats.syscalls;
 #ifndef _MSC_VER
       errno = 0;
       length = recvfrom(fd, (char *)buff,
@@ -397,10 +504,87 @@ DatagramReceiver::receive( byte* buff, uint32 buffSize )
              << "DatagramReceiver: recvfrom: "
              << strerror(errno) << endl;
 #endif // __unix
-   }      
+   } else {
+      ++m_stats.datagrams;
+   }
    return length;
 }
 
+int32
+DatagramReceiver::receivePackets( vector<Packet*>& packets, uint32 maxNbr )
+{
+   maxNbr = MAX( maxNbr, 1u );
+   const uint32 slotSize = Packet::MAX_UDP_PACKET_SIZE;
+   if ( m_batchBuffer.size() < maxNbr * slotSize ) {
+      m_batchBuffer.resize( maxNbr * slotSize );
+   }
+   vector<uint32> sizes( maxNbr );
+   int32 nbrReceived = -1;
+   bool received = false;
+
+#ifdef HAVE_MMSG
+   if ( maxNbr > 1 && ! c_noMmsg ) {
+      vector<struct mmsghdr> msgs( maxNbr );
+      vector<struct iovec> iovecs( maxNbr );
+      vector<struct sockaddr_in> addrs( maxNbr );
+      for ( uint32 i = 0; i < maxNbr; ++i ) {
+         iovecs[ i ].iov_base = &m_batchBuffer[ i * slotSize ];
+         iovecs[ i ].iov_len = slotSize;
+         msgs[ i ].msg_hdr.msg_name = &addrs[ i ];
+         msgs[ i ].msg_hdr.msg_namelen = sizeof( struct sockaddr_in );
+         msgs[ i ].msg_hdr.msg_iov = &iovecs[ i ];
+         msgs[ i ].msg_hdr.msg_iovlen = 1;
+      }
+
+      do {
+         errno = 0;
+         ++m_stats.syscalls;
+         // Waits for the first datagram only.
+         nbrReceived = recvmmsg( fd, &msgs.front(), maxNbr, 
+                                 MSG_WAITFORONE, NULL );
+      } while ( nbrReceived < 0 && errno == EINTR );
+
+      if ( nbrReceived < 0 && errno == ENOSYS ) {
+         mc2log << warn << "DatagramReceiver: no recvmmsg, "
+                << "receiving one packet per call" << endl;
+         c_noMmsg = true;
+      } else {
+         received = true;
+         if ( nbrReceived < 0 ) {
+            mc2log << error << "DatagramReceiver: recvmmsg: "
+                   << strerror( errno ) << endl;
+         } else if ( nbrReceived > 0 ) {
+            m_stats.datagrams += nbrReceived;
+            for ( int32 i = 0; i < nbrReceived; ++i ) {
+               sizes[ i ] = msgs[ i ].msg_len;
+            }
+            m_peerAddr = addrs[ nbrReceived - 1 ];
+         }
+      }
+   }
+#endif
+
+   if ( ! received ) {
+      int32 length = receive( &m_batchBuffer.front(), slotSize );
+      if ( length >= 0 ) {
+         sizes[ 0 ] = length;
+         nbrReceived = 1;
+      }
+   }
+
+   for ( int32 i = 0; i < nbrReceived; ++i ) {
+      // Room for the header even if the datagram is shorter.
+      const uint32 bufSize = MAX( sizes[ i ], uint32( HEADER_SIZE ) );
+      byte* buffer = MAKE_UINT32_ALIGNED_BYTE_BUFFER( bufSize );
+      memcpy( buffer, &m_batchBuffer[ i * slotSize ], sizes[ i ] );
+      memset( buffer + sizes[ i ], 0, bufSize - sizes[ i ] );
+      Packet* packet = Packet::makePacket( buffer, bufSize );
+      packet->setLength( sizes[ i ] );
+      packets.push_back( packet );
+   }
+   return nbrReceived;
+}
+
 
 bool
 DatagramReceiver::receive(Packet *packet, uint32 micros)
@@ -16,6 +16,8 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include "Properties.h"
 
 #include "Utility.h"
+#include "TimeUtility.h"
+#include "GzipUtil.h"
 
 #include <iostream>
 #include <fcntl.h>
@@ -25,12 +27,48 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 
 
 
-HttpFileHandler::HttpFileHandler(){
+HttpFileHandler::HttpFileHandler()
+      : m_maxCacheSize( Properties::getUint32Property( "HTTP_FILE_CACHE_SIZE",
+                                                       33554432 ) ),
+        m_maxFileSize( Properties::getUint32Property( 
+                          "HTTP_FILE_CACHE_MAX_FILE_SIZE", 1048576 ) ),
+        m_checkInterval( Properties::getUint32Property( 
+                            "HTTP_FILE_CACHE_CHECK_INTERVAL", 2 ) ),
+        m_cacheSize( 0 )
+{
    mc2dbg8 << "HttpFileHandler getting root" << endl;
    const char* root = Properties::getProperty("HTML_ROOT");
    mc2dbg8 << "root is " << root << endl;
    if ( root == NULL ) root = "./";
    m_htmlRoot = new MC2String(root);
+   fixRootSeparators();
+}
+
+
+HttpFileHandler::HttpFileHandler( const MC2String& htmlRoot,
+                                  uint32 maxCacheSize,
+                                  uint32 maxFileSize,
+                                  uint32 checkInterval )
+      : m_htmlRoot( new MC2String( htmlRoot ) ),
+        m_maxCacheSize( maxCacheSize ),
+        m_maxFileSize( maxFileSize ),
+        m_checkInterval( checkInterval ),
+        m_cacheSize( 0 )
+{
+   fixRootSeparators();
+}
+
+
+HttpFileHandler::~HttpFileHandler(){
+   while ( ! m_files.empty() ) {
+      removeCached( m_files.begin() );
+   }
+   delete m_htmlRoot;
+}
+
+
+void
+HttpFileHandler::fixRootSeparators() {
    MC2String::size_type pos = 0;
 
    while ( pos < m_htmlRoot->size() ) {
@@ -49,35 +87,13 @@ HttpFileHandler::HttpFileHandler(){
 }
 
 
-HttpFileHandler::~HttpFileHandler(){
-   delete m_htmlRoot;
-}
-
-
-byte*
-HttpFileHandler::getFile(const MC2String& fileString, 
-			 int& length, 
-			 struct stat* status) {
-   MC2String fileName; 
-   byte* inBuff = NULL;
-   int file;
-   uint32 fSize;
-   size_t pos;
+bool
+HttpFileHandler::makeFileName( const MC2String& fileString, 
+                               MC2String& fileName ) const {
    // Convert / and \ to correct values for filesystem.
-   pos = 0;
    fileName = fileString;
-   
-#ifdef __linux
-   /*
-   while ( pos < fileName.size() ) {
-     pos = fileName.find('\\', pos);
-      //  mc2dbg8 << "found \\ at: " << pos << endl;
-      if ( pos != MC2String::npos ) 
-	 fileName.replace(pos, 1, 1, '/');
-   }
-   */
-#endif
 #ifdef _WIN32
+   size_t pos = 0;
    while ( pos < fileName.size() ) {
       pos = fileName.find('/', pos);
       if ( pos != MC2String::npos )
@@ -85,71 +101,177 @@ HttpFileHandler::getFile(const MC2String& fileString,
    }
 #endif   
 
-   
    // Test if above the root
    if ( (fileString.find("../") != MC2String::npos) ||
         (fileString.find("..\\") != MC2String::npos) ) { // Hacker!
-      return NULL;
+      return false;
    }
    fileName.insert(0, m_htmlRoot->c_str()); // Put path first
-   
-   if (fileString[0] == '/') { // Ok rootdir first    
-      stat(fileName.c_str(), status);
+   return true;
+}
+
+
+byte*
+HttpFileHandler::readFile( const MC2String& fileName, 
+                           int& length, 
+                           struct stat* status ) {
+   byte* inBuff = NULL;
+   int file;
+   uint32 fSize;
+
+   stat(fileName.c_str(), status);
       
-      /* mc2dbg4 << "getFile " <<
-         fileName << " status: " << endl << 
-             "Size=" << status->st_size << endl <<
-	     "Modified=" << status->st_mtime << endl;*/
-      length = fSize = status->st_size;
-      file = open(fileName.c_str(), O_RDONLY);
-      if (file == -1) { // Not found
-         mc2dbg4 << "Unable to open file: " << fileName << endl;
-         return NULL;
+   /* mc2dbg4 << "getFile " <<
+      fileName << " status: " << endl << 
+      "Size=" << status->st_size << endl <<
+      "Modified=" << status->st_mtime << endl;*/
+   length = fSize = status->st_size;
+   file = open(fileName.c_str(), O_RDONLY);
+   if (file == -1) { // Not found
+      mc2dbg4 << "Unable to open file: " << fileName << endl;
+      return NULL;
+   }
+   // Test type of file
+   if ( ! (S_ISLNK(status->st_mode)  || S_ISREG(status->st_mode) || 
+           S_ISFIFO(status->st_mode) || S_ISBLK(status->st_mode)) ) 
+   {
+      mc2dbg << "Not a permitted filetype: " << fileName << endl;
+      if ( (S_ISLNK(status->st_mode)) ) {
+         mc2dbg4 << "Is a LINK" << endl;
       }
-      // Test type of file
-      if ( ! (S_ISLNK(status->st_mode)  || S_ISREG(status->st_mode) || 
-              S_ISFIFO(status->st_mode) || S_ISBLK(status->st_mode)) ) 
-      {
-         mc2dbg << "Not a permitted filetype: " << fileName << endl;
-         if ( (S_ISLNK(status->st_mode)) ) {
-            mc2dbg4 << "Is a LINK" << endl;
-         }
-         if ( S_ISREG(status->st_mode) ) {
-            mc2dbg4 << "Is a REGULARFILE" << endl;
-         } 
-         if ( S_ISFIFO(file) ) {
-            mc2dbg4 << "Is a FIFOFile" << endl;
-         }
-         if ( S_ISBLK(file) ) {
-            mc2dbg4 << "Is a BLOCKDEVFILE" << endl;
-         } 
-         if ( S_ISDIR(status->st_mode) ) {
-            mc2dbg4 << "Is a DIRECTORY" << endl;
-         }
-         if ( S_ISCHR(status->st_mode) ) {
-            mc2dbg4 << "Is a Character device!" << endl;
-         }
-         if ( S_ISSOCK(status->st_mode) ) {
-            mc2dbg4 << "Is a SOCKET!" << endl;
-         }
-         return NULL;
+      if ( S_ISREG(status->st_mode) ) {
+         mc2dbg4 << "Is a REGULARFILE" << endl;
+      } 
+      if ( S_ISFIFO(file) ) {
+         mc2dbg4 << "Is a FIFOFile" << endl;
+      }
+      if ( S_ISBLK(file) ) {
+         mc2dbg4 << "Is a BLOCKDEVFILE" << endl;
+      } 
+      if ( S_ISDIR(status->st_mode) ) {
+         mc2dbg4 << "Is a DIRECTORY" << endl;
       }
-      inBuff = new byte[fSize];
-      if ( !Utility::read(file, inBuff, fSize) ) {
-         DEBUG1(mc2log << error << "getFile failed to read all of: " <<
-                fileString << endl);
-         length = 0;
+      if ( S_ISCHR(status->st_mode) ) {
+         mc2dbg4 << "Is a Character device!" << endl;
+      }
+      if ( S_ISSOCK(status->st_mode) ) {
+         mc2dbg4 << "Is a SOCKET!" << endl;
       }
       close(file);
+      return NULL;
+   }
+   inBuff = new byte[fSize];
+   if ( !Utility::read(file, inBuff, fSize) ) {
+      DEBUG1(mc2log << error << "getFile failed to read all of: " <<
+             fileName << endl);
+      length = 0;
+   }
+   close(file);
+
+   return inBuff;
+}
+
+
+HttpFileHandler::CachedFile*
+HttpFileHandler::findCached( const MC2String& fileName ) {
+   FileMap::iterator it = m_files.find( fileName );
+   if ( it == m_files.end() ) {
+      return NULL;
+   }
+   CachedFile* cached = it->second;
+   uint32 now = TimeUtility::getRealTime();
+   if ( now - cached->checkTime >= m_checkInterval ) {
+      struct stat status;
+      if ( stat( fileName.c_str(), &status ) != 0 ||
+           status.st_mtime != cached->status.st_mtime ||
+           status.st_size != cached->status.st_size ||
+           status.st_ino != cached->status.st_ino ) {
+         // Changed or removed
+         removeCached( it );
+         return NULL;
+      }
+      cached->checkTime = now;
+   }
+   // Most recently used last
+   m_lru.splice( m_lru.end(), m_lru, cached->lruPos );
+   return cached;
+}
+
+
+void
+HttpFileHandler::addCached( const MC2String& fileName, const byte* data,
+                            uint32 length, const struct stat& status ) {
+   if ( length == 0 || length > m_maxFileSize || 
+        length > m_maxCacheSize ) {
+      return;
+   }
+   makeRoom( length );
+   CachedFile* cached = new CachedFile();
+   cached->data.assign( data, data + length );
+   cached->gzipTried = false;
+   cached->status = status;
+   cached->checkTime = TimeUtility::getRealTime();
+   cached->lruPos = m_lru.insert( m_lru.end(), fileName );
+   m_files.insert( make_pair( fileName, cached ) );
+   m_cacheSize += length;
+}
+
+
+void
+HttpFileHandler::makeRoom( uint32 length ) {
+   while ( m_cacheSize + length > m_maxCacheSize ) {
+      removeCached( m_files.find( m_lru.front() ) );
+   }
+}
+
+
+void
+HttpFileHandler::removeCached( FileMap::iterator it ) {
+   CachedFile* cached = it->second;
+   m_cacheSize -= cached->data.size() + cached->gzipped.size();
+   m_lru.erase( cached->lruPos );
+   delete cached;
+   m_files.erase( it );
+}
+
+
+byte*
+HttpFileHandler::getFile(const MC2String& fileString, 
+			 int& length, 
+			 struct stat* status) {
+   MC2String fileName; 
+   byte* inBuff = NULL;
+   
+   if ( ! makeFileName( fileString, fileName ) ) {
+      return NULL;
+   }
+   
+   // INFO: HACK TO REMOVE ROUTEFILES, they are generated and are not on disc
+   const bool routeFile = 
+      ( fileString.find( ".dat" ) != MC2String::npos ) &&
+      ( fileString.find( "routefile" ) != MC2String::npos );
+
+   if (fileString[0] == '/') { // Ok rootdir first    
+      CachedFile* cached = routeFile ? NULL : findCached( fileName );
+      if ( cached != NULL ) {
+         *status = cached->status;
+         length = cached->data.size();
+         inBuff = new byte[ length ];
+         memcpy( inBuff, &cached->data.front(), length );
+         return inBuff;
+      }
+      inBuff = readFile( fileName, length, status );
+      if ( inBuff != NULL && ! routeFile && 
+           length == status->st_size && S_ISREG( status->st_mode ) ) {
+         addCached( fileName, inBuff, length, *status );
+      }
    } else {
       DEBUG1(mc2log << warn << "getFile odd filename " <<
              fileString << endl;);
    }
 
-   // INFO: HACK TO REMOVE ROUTEFILES, they are generated and are not on disc
    mc2dbg8 << "Trying file " << fileString << endl;
-   if( ( fileString.find(".dat", pos) != MC2String::npos ) &&
-       ( fileString.find("routefile", pos) != MC2String::npos ) ){
+   if ( routeFile ) {
       mc2dbg8 << "Removing file " <<  fileName.c_str() <<endl;
       remove( fileName.c_str() );
    }
@@ -158,6 +280,80 @@ HttpFileHandler::getFile(const MC2String& fileString,
 }
 
 
+byte*
+HttpFileHandler::getGzippedFile( const MC2String& fileString, 
+                                 int& length ) {
+   MC2String fileName;
+   if ( ! makeFileName( fileString, fileName ) ) {
+      return NULL;
+   }
+   FileMap::iterator it = m_files.find( fileName );
+   if ( it == m_files.end() ) {
+      return NULL;
+   }
+   CachedFile* cached = it->second;
+   if ( ! cached->gzipTried && ! cached->data.empty() ) {
+      cached->gzipTried = true;
+      // Only worth it if it gets smaller, so no need for a larger buffer
+      std::vector<byte> gzipped( cached->data.size() );
+      int gzLength = GzipUtil::gzip( &gzipped.front(), gzipped.size(),
+                                     &cached->data.front(),
+                                     cached->data.size() );
+      if ( gzLength > 0 && uint32( gzLength ) < cached->data.size() &&
+           cached->data.size() + gzLength <= m_maxCacheSize ) {
+         gzipped.resize( gzLength );
+         // Most recently used last, so that it is not removed itself
+         m_lru.splice( m_lru.end(), m_lru, cached->lruPos );
+         makeRoom( gzipped.size() );
+         cached->gzipped.swap( gzipped );
+         m_cacheSize += cached->gzipped.size();
+      }
+   }
+   if ( cached->gzipped.empty() ) {
+      return NULL;
+   }
+   length = cached->gzipped.size();
+   byte* inBuff = new byte[ length ];
+   memcpy( inBuff, &cached->gzipped.front(), length );
+   return inBuff;
+}
+
+
+int
+HttpFileHandler::openLargeFile( const MC2String& fileString, 
+                                struct stat* status ) {
+   MC2String fileName;
+   if ( fileString.empty() || fileString[ 0 ] != '/' ||
+        ! makeFileName( fileString, fileName ) ) {
+      return -1;
+   }
+   if ( fileString.find( "routefile" ) != MC2String::npos ) {
+      // Removed when read, see getFile
+      return -1;
+   }
+   if ( m_files.find( fileName ) != m_files.end() ||
+        stat( fileName.c_str(), status ) != 0 ||
+        ! S_ISREG( status->st_mode ) ||
+        uint64( status->st_size ) <= m_maxFileSize ) {
+      return -1;
+   }
+   int file = open( fileName.c_str(), O_RDONLY );
+   if ( file == -1 ) {
+      return -1;
+   }
+   // Pages with tags must be parsed
+   const char tags[] = "<!--ISAB_TAGS";
+   char start[ sizeof( tags ) - 1 ];
+   if ( pread( file, start, sizeof( start ), 0 ) == 
+        ssize_t( sizeof( start ) ) &&
+        strncmp( start, tags, sizeof( start ) ) == 0 ) {
+      close( file );
+      return -1;
+   }
+   return file;
+}
+
+
 const char*
 HttpFileHandler::getFileType(const MC2String& ext, byte* file) {
    const char* type;
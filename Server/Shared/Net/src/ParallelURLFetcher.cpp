@@ -0,0 +1,576 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "ParallelURLFetcher.h"
+
+#include "URLFetcher.h"
+#include "TCPSocket.h"
+#include "ISABThread.h"
+#include "TimeUtility.h"
+#include "StringUtility.h"
+#include "STLStringUtility.h"
+
+#include <poll.h>
+#include <errno.h>
+#include <sys/socket.h>
+
+namespace {
+
+/// Protects the statistics.
+ISABMutex statisticsMutex;
+
+/// The statistics of all fetchers.
+ParallelURLFetcher::Statistics statistics;
+
+/// @return "host:port" of the url.
+MC2String getHostPort( const URL& url ) {
+   return MC2String( url.getHost() ) + ":" +
+      STLStringUtility::uint2str( url.getPort() );
+}
+
+}
+
+/// A request in progress.
+struct ParallelURLFetcher::Transfer {
+   /// The states of a transfer.
+   enum state_t {
+      /// Waiting for the connect to finish.
+      connecting,
+      /// Sending the request.
+      writing,
+      /// Reading the reply.
+      reading,
+      /// Done.
+      done
+   };
+
+   explicit Transfer( Request* request )
+         : req( request ), sock( NULL ), reused( false ),
+           state( connecting ), outPos( 0 ), headerEnd( 0 ),
+           contentLength( 0 ), hasContentLength( false ),
+           chunked( false ), keepAlive( false ), chunkPos( 0 ),
+           startTime( TimeUtility::getCurrentTime() ) {
+   }
+
+   /// The request.
+   Request* req;
+   /// The connection.
+   TCPSocket* sock;
+   /// If the connection was kept from an earlier request.
+   bool reused;
+   /// The state.
+   state_t state;
+   /// "host:port" of the url.
+   MC2String hostPort;
+   /// The request to send.
+   MC2String out;
+   /// The number of bytes sent of out.
+   uint32 outPos;
+   /// What has been read.
+   MC2String in;
+   /// The position after the headers in in, 0 if not read yet.
+   uint32 headerEnd;
+   /// The Content-Length of the reply.
+   uint32 contentLength;
+   /// If there was a Content-Length.
+   bool hasContentLength;
+   /// If the reply is chunked.
+   bool chunked;
+   /// If the connection can be kept after the reply.
+   bool keepAlive;
+   /// The position of the next chunk in in.
+   uint32 chunkPos;
+   /// When the request started, in ms.
+   uint32 startTime;
+};
+
+ParallelURLFetcher::Request::Request( const MC2String& provider,
+                                      const URL& url,
+                                      const MC2String& postData,
+                                      const HttpHeader* inHeaders )
+      : m_provider( provider ),
+        m_url( url ),
+        m_postData( postData ),
+        m_inHeaders( inHeaders ),
+        m_status( -1 ),
+        m_time( 0 )
+{
+}
+
+ParallelURLFetcher::ProviderStatistics::ProviderStatistics()
+      : nbrRequests( 0 ),
+        nbrErrors( 0 ),
+        nbrTimeouts( 0 ),
+        nbrReused( 0 ),
+        totalTime( 0 ),
+        maxTime( 0 )
+{
+}
+
+ParallelURLFetcher::ParallelURLFetcher( uint32 maxIdlePerHost,
+                                        uint32 idleTimeout )
+      : m_maxIdlePerHost( maxIdlePerHost ),
+        m_idleTimeout( idleTimeout ),
+        m_userAgent( "MC2-ParallelURLFetcher/1.0" )
+{
+#ifdef __linux__
+   m_userAgent += " (linux)";
+#endif
+}
+
+ParallelURLFetcher::~ParallelURLFetcher() {
+   for ( IdlePool::iterator it = m_idle.begin(); it != m_idle.end(); ++it ) {
+      for ( uint32 i = 0; i < it->second.size(); ++i ) {
+         delete it->second[ i ].sock;
+      }
+   }
+}
+
+int
+ParallelURLFetcher::get( MC2String& result,
+                         const MC2String& provider,
+                         const URL& url,
+                         uint32 timeout_ms,
+                         const HttpHeader* inHeaders ) {
+   Request request( provider, url, MC2String(), inHeaders );
+   fetch( std::vector< Request* >( 1, &request ), timeout_ms );
+   result.swap( request.getBody() );
+   return request.getStatus();
+}
+
+uint32
+ParallelURLFetcher::getNbrIdleConnections() const {
+   uint32 nbr = 0;
+   for ( IdlePool::const_iterator it = m_idle.begin(); 
+         it != m_idle.end(); ++it ) {
+      nbr += it->second.size();
+   }
+   return nbr;
+}
+
+ParallelURLFetcher::Statistics
+ParallelURLFetcher::getStatistics() {
+   ISABSync sync( statisticsMutex );
+   return statistics;
+}
+
+void
+ParallelURLFetcher::addStatistics( const std::vector< Transfer >& transfers )
+{
+   ISABSync sync( statisticsMutex );
+   for ( uint32 i = 0; i < transfers.size(); ++i ) {
+      const Request& req = *transfers[ i ].req;
+      ProviderStatistics& stats = statistics[ req.getProvider() ];
+      ++stats.nbrRequests;
+      if ( req.getStatus() < 0 ) {
+         ++stats.nbrErrors;
+      }
+      if ( req.getStatus() == -2 ) {
+         ++stats.nbrTimeouts;
+      }
+      if ( transfers[ i ].reused ) {
+         ++stats.nbrReused;
+      }
+      stats.totalTime += req.getTime();
+      stats.maxTime = MAX( stats.maxTime, req.getTime() );
+   }
+}
+
+void
+ParallelURLFetcher::closeOldIdle() {
+   const uint32 now = TimeUtility::getRealTime();
+   IdlePool::iterator it = m_idle.begin();
+   while ( it != m_idle.end() ) {
+      std::deque< IdleConnection >& conns = it->second;
+      // The oldest are first
+      while ( ! conns.empty() && 
+              now - conns.front().lastUsed > m_idleTimeout ) {
+         delete conns.front().sock;
+         conns.pop_front();
+      }
+      if ( conns.empty() ) {
+         m_idle.erase( it++ );
+      } else {
+         ++it;
+      }
+   }
+}
+
+TCPSocket*
+ParallelURLFetcher::getIdle( const MC2String& hostPort ) {
+   IdlePool::iterator it = m_idle.find( hostPort );
+   if ( it == m_idle.end() ) {
+      return NULL;
+   }
+   std::deque< IdleConnection >& conns = it->second;
+   while ( ! conns.empty() ) {
+      // The most recently used is the most likely to still be open
+      TCPSocket* sock = conns.back().sock;
+      conns.pop_back();
+      // Nothing to read and no EOF means it is still open
+      byte buf;
+      if ( sock->read( &buf, 1 ) == -3 ) {
+         return sock;
+      }
+      delete sock;
+   }
+   return NULL;
+}
+
+bool
+ParallelURLFetcher::start( Transfer& transfer ) {
+   const URL& url = transfer.req->getURL();
+   const MC2String& postData = transfer.req->m_postData;
+   transfer.hostPort = getHostPort( url );
+
+   // Make the request
+   const char* newline = "\r\n";
+   MC2String& req = transfer.out;
+   req.reserve( 1024 + postData.length() );
+   req = postData.empty() ? "GET " : "POST ";
+   req += url.getPath();
+   req += MC2String( " HTTP/1.1" ) + newline;
+   req += "User-Agent: " + m_userAgent + newline;
+   req += MC2String( "Host: " ) + url.getHost();
+   if ( url.getPort() != 80 ) {
+      req += ":" + STLStringUtility::uint2str( url.getPort() );
+   }
+   req += newline;
+   req += MC2String( "Connection: Keep-Alive" ) + newline;
+   if ( ! postData.empty() ) {
+      req += "Content-Length: " + 
+         STLStringUtility::uint2str( postData.length() ) + newline;
+   }
+   const HttpHeader* inHeaders = transfer.req->m_inHeaders;
+   if ( inHeaders != NULL ) {
+      for ( HttpHeader::HeaderMap::const_iterator it = 
+               inHeaders->getHeaderMap().begin() ;
+            it != inHeaders->getHeaderMap().end() ; ++it ) {
+         req += it->first + ": " + *it->second + newline;
+      }
+   }
+   req += newline;
+   req += postData;
+
+   transfer.sock = getIdle( transfer.hostPort );
+   if ( transfer.sock != NULL ) {
+      transfer.reused = true;
+      transfer.state = Transfer::writing;
+      return true;
+   }
+
+   auto_ptr< TCPSocket > sock( new TCPSocket() );
+   if ( ! sock->open() ) {
+      mc2log << error << "[ParallelURLFetcher]: Could not open socket! ("
+             << strerror( errno ) << ")" << endl;
+      finish( transfer, -16 );
+      return false;
+   }
+   sock->setBlocking( false );
+   errno = 0;
+   if ( ! sock->connect( url.getHost(), url.getPort() ) ) {
+      mc2log << warn << "[ParallelURLFetcher]: Could not connect to "
+             << transfer.hostPort << " (" << strerror( errno ) << ")" 
+             << endl;
+      finish( transfer, -17 );
+      return false;
+   }
+   transfer.sock = sock.release();
+   transfer.state = Transfer::connecting;
+   return true;
+}
+
+bool
+ParallelURLFetcher::handleIO( Transfer& transfer, short revents ) {
+   if ( transfer.state == Transfer::connecting ) {
+      int err = 0;
+      socklen_t len = sizeof( err );
+      if ( getsockopt( transfer.sock->getSOCKET(), SOL_SOCKET, SO_ERROR,
+                       &err, &len ) != 0 || err != 0 ) {
+         mc2log << warn << "[ParallelURLFetcher]: Could not connect to "
+                << transfer.hostPort << " (" << strerror( err ) << ")" 
+                << endl;
+         finish( transfer, -17 );
+         return true;
+      }
+      transfer.state = Transfer::writing;
+   }
+
+   if ( transfer.state == Transfer::writing ) {
+      ssize_t res = transfer.sock->write( 
+         (const byte*)transfer.out.data() + transfer.outPos,
+         transfer.out.size() - transfer.outPos );
+      if ( res > 0 ) {
+         transfer.outPos += res;
+         if ( transfer.outPos == transfer.out.size() ) {
+            transfer.state = Transfer::reading;
+         }
+      } else if ( res != -3 ) {
+         finish( transfer, -4 );
+         return true;
+      }
+      return false;
+   }
+
+   // Reading
+   byte buf[ 65536 ];
+   ssize_t res = transfer.sock->read( buf, sizeof( buf ) );
+   if ( res > 0 ) {
+      transfer.in.append( (const char*)buf, res );
+      return parseReply( transfer, false );
+   } else if ( res == -3 ) {
+      return false;
+   } else if ( res == 0 ) {
+      return parseReply( transfer, true );
+   }
+   finish( transfer, -7 );
+   return true;
+}
+
+bool
+ParallelURLFetcher::parseReply( Transfer& transfer, bool closed ) {
+   MC2String& in = transfer.in;
+   HttpHeader& header = transfer.req->m_header;
+
+   if ( transfer.headerEnd == 0 ) {
+      MC2String::size_type end = in.find( "\r\n\r\n" );
+      if ( end == MC2String::npos ) {
+         if ( closed ) {
+            mc2log << warn << "[ParallelURLFetcher]: End of file while "
+                   << "parsing headers from " << transfer.hostPort << endl;
+            finish( transfer, -6 );
+            return true;
+         }
+         return false;
+      }
+      transfer.headerEnd = end + 4;
+      // Parse the lines
+      MC2String::size_type pos = 0;
+      bool first = true;
+      while ( pos < end ) {
+         MC2String::size_type lineEnd = in.find( "\r\n", pos );
+         MC2String line( in, pos, lineEnd - pos );
+         if ( first ) {
+            header.setStartLine( new MC2String( line ) );
+            first = false;
+         } else if ( ! header.addHeaderLine( line.c_str() ) ) {
+            mc2log << warn << "[ParallelURLFetcher]: Error while parsing "
+                   << "header line " << line << endl;
+            finish( transfer, -5 );
+            return true;
+         }
+         pos = lineEnd + 2;
+      }
+      const MC2String* te = header.getHeaderValue( "Transfer-Encoding" );
+      transfer.chunked = te != NULL && 
+         te->find( "chunked" ) != MC2String::npos;
+      transfer.hasContentLength = 
+         header.getHeaderValue( "Content-Length" ) != NULL;
+      transfer.contentLength = header.getContentLength();
+      const MC2String* conn = header.getHeaderValue( "Connection" );
+      const MC2String connection = 
+         conn != NULL ? StringUtility::copyUpper( *conn ) : "";
+      if ( strstr( header.getStartLine()->c_str(), "HTTP/1.0" ) != NULL ) {
+         transfer.keepAlive = 
+            connection.find( "KEEP-ALIVE" ) != MC2String::npos;
+      } else {
+         transfer.keepAlive = connection.find( "CLOSE" ) == MC2String::npos;
+      }
+      transfer.chunkPos = transfer.headerEnd;
+   }
+
+   const uint32 code = header.getStartLineCode();
+   MC2String& body = transfer.req->m_body;
+   if ( code == 204 || code == 304 || ( code >= 100 && code < 200 ) ) {
+      // No body
+   } else if ( transfer.chunked ) {
+      // Decode the complete chunks
+      for ( ;; ) {
+         MC2String::size_type lineEnd = in.find( "\r\n", transfer.chunkPos );
+         if ( lineEnd == MC2String::npos ) {
+            break;
+         }
+         char* endPtr;
+         const char* lengthStr = in.c_str() + transfer.chunkPos;
+         uint32 length = strtoul( lengthStr, &endPtr, 16 );
+         if ( endPtr == lengthStr ) {
+            finish( transfer, -11 );
+            return true;
+         }
+         if ( length == 0 ) {
+            // Skip the trailer up to the empty line
+            MC2String::size_type trailerEnd = 
+               in.find( "\r\n\r\n", lineEnd );
+            if ( trailerEnd == MC2String::npos ) {
+               break;
+            }
+            transfer.chunkPos = in.size();
+            if ( trailerEnd + 4 != in.size() ) {
+               // More than the reply, do not reuse
+               transfer.keepAlive = false;
+            }
+            finish( transfer, code );
+            return true;
+         }
+         if ( in.size() < lineEnd + 2 + length + 2 ) {
+            break;
+         }
+         body.append( in, lineEnd + 2, length );
+         transfer.chunkPos = lineEnd + 2 + length + 2;
+      }
+      if ( closed ) {
+         finish( transfer, -9 );
+         return true;
+      }
+      return false;
+   } else if ( transfer.hasContentLength ) {
+      if ( in.size() - transfer.headerEnd < transfer.contentLength ) {
+         if ( closed ) {
+            finish( transfer, -8 );
+            return true;
+         }
+         return false;
+      }
+      if ( in.size() - transfer.headerEnd > transfer.contentLength ) {
+         transfer.keepAlive = false;
+      }
+      body.assign( in, transfer.headerEnd, transfer.contentLength );
+   } else {
+      // Read until closed
+      if ( ! closed ) {
+         return false;
+      }
+      transfer.keepAlive = false;
+      body.assign( in, transfer.headerEnd, MC2String::npos );
+   }
+   if ( closed ) {
+      transfer.keepAlive = false;
+   }
+   finish( transfer, code );
+   return true;
+}
+
+void
+ParallelURLFetcher::finish( Transfer& transfer, int status ) {
+   transfer.state = Transfer::done;
+   transfer.req->m_status = status;
+   transfer.req->m_time = TimeUtility::getCurrentTime() - transfer.startTime;
+   if ( transfer.sock == NULL ) {
+      return;
+   }
+   std::deque< IdleConnection >& conns = m_idle[ transfer.hostPort ];
+   if ( status > 0 && transfer.keepAlive && 
+        conns.size() < m_maxIdlePerHost ) {
+      IdleConnection conn = { transfer.sock, TimeUtility::getRealTime() };
+      conns.push_back( conn );
+   } else {
+      delete transfer.sock;
+   }
+   transfer.sock = NULL;
+}
+
+void
+ParallelURLFetcher::fetch( const std::vector< Request* >& requests,
+                           uint32 timeout_ms ) {
+   closeOldIdle();
+
+   const uint32 startTime = TimeUtility::getCurrentTime();
+   std::vector< Transfer > transfers;
+   transfers.reserve( requests.size() );
+   for ( uint32 i = 0; i < requests.size(); ++i ) {
+      Request* req = requests[ i ];
+      req->m_status = -1;
+      req->m_header.clear();
+      req->m_body.clear();
+      transfers.push_back( Transfer( req ) );
+      const char* proto = req->getURL().getProto();
+      if ( ! req->getURL().isValid() ) {
+         finish( transfers.back(), -15 );
+      } else if ( proto == NULL || strcasecmp( proto, "http" ) != 0 ) {
+         // https and file one at a time
+         if ( m_fallback.get() == NULL ) {
+            m_fallback.reset( new URLFetcher() );
+         }
+         int status = m_fallback->post( req->m_body, req->m_header, 
+                                        req->getURL(), req->m_postData,
+                                        timeout_ms, req->m_inHeaders );
+         finish( transfers.back(), status );
+      } else {
+         start( transfers.back() );
+      }
+   }
+
+   std::vector< pollfd > fds;
+   std::vector< uint32 > active;
+   for ( ;; ) {
+      fds.clear();
+      active.clear();
+      for ( uint32 i = 0; i < transfers.size(); ++i ) {
+         Transfer& transfer = transfers[ i ];
+         if ( transfer.state == Transfer::done ) {
+            continue;
+         }
+         pollfd fd;
+         fd.fd = transfer.sock->getSOCKET();
+         fd.events = transfer.state == Transfer::reading ? POLLIN : POLLOUT;
+         fd.revents = 0;
+         fds.push_back( fd );
+         active.push_back( i );
+      }
+      if ( active.empty() ) {
+         break;
+      }
+      const uint32 used = TimeUtility::getCurrentTime() - startTime;
+      if ( used >= timeout_ms ) {
+         for ( uint32 i = 0; i < active.size(); ++i ) {
+            Transfer& transfer = transfers[ active[ i ] ];
+            mc2log << warn << "[ParallelURLFetcher]: Timeout for "
+                   << transfer.req->getProvider() << " "
+                   << transfer.hostPort << endl;
+            // The connection is in an unknown state, do not keep it
+            transfer.keepAlive = false;
+            finish( transfer, -2 );
+         }
+         break;
+      }
+      int res = poll( &fds.front(), fds.size(), timeout_ms - used );
+      if ( res < 0 && errno != EINTR ) {
+         mc2log << error << "[ParallelURLFetcher]: poll failed ("
+                << strerror( errno ) << ")" << endl;
+         for ( uint32 i = 0; i < active.size(); ++i ) {
+            transfers[ active[ i ] ].keepAlive = false;
+            finish( transfers[ active[ i ] ], -1 );
+         }
+         break;
+      }
+      for ( uint32 i = 0; res > 0 && i < fds.size(); ++i ) {
+         if ( fds[ i ].revents == 0 ) {
+            continue;
+         }
+         Transfer& transfer = transfers[ active[ i ] ];
+         const bool reused = transfer.reused && transfer.in.empty();
+         if ( handleIO( transfer, fds[ i ].revents ) &&
+              reused && transfer.req->m_status < 0 ) {
+            // The server closed the kept connection, try a new one.
+            Request* req = transfer.req;
+            transfer = Transfer( req );
+            transfer.reused = false;
+            req->m_header.clear();
+            start( transfer );
+         }
+      }
+   }
+
+   addStatistics( transfers );
+}
@@ -0,0 +1,119 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "MC2UnitTestMain.h"
+
+#include "GenericMap.h"
+
+#include <algorithm>
+
+namespace {
+
+/// Adds a landmark to the index as GenericMap does when loading.
+void addLandmark( GenericMap::LandmarkIndex& index,
+                  uint32 fromNodeID, uint32 toNodeID, uint32 itemID ) {
+   ItemTypes::lmdescription_t description;
+   description.itemID = itemID;
+   description.importance = 0;
+   description.side = SearchTypes::undefined_side;
+   description.location = ItemTypes::pass;
+   description.type = ItemTypes::builtUpAreaLM;
+   uint64 key = (uint64(fromNodeID) << 32) | uint64(toNodeID);
+   index.push_back( GenericMap::LandmarkPair( key, description ) );
+}
+
+/// @return The item ids of the landmarks of a connection.
+vector<uint32> getItemIDs( const GenericMap::LandmarkIndex& index,
+                           uint32 fromNodeID, uint32 toNodeID ) {
+   vector<uint32> itemIDs;
+   GenericMap::LandmarkRange range =
+      GenericMap::getLandmarks( index, fromNodeID, toNodeID );
+   for ( GenericMap::LandmarkIndex::const_iterator it = range.first;
+         it != range.second; ++it ) {
+      itemIDs.push_back( it->value.itemID );
+   }
+   return itemIDs;
+}
+
+}
+
+MC2_UNIT_TEST_FUNCTION( landmarkIndexEmptyTest ) {
+   GenericMap::LandmarkIndex index;
+   MC2_TEST_CHECK( getItemIDs( index, 1, 2 ).empty() );
+}
+
+MC2_UNIT_TEST_FUNCTION( landmarkIndexLookupTest ) {
+   GenericMap::LandmarkIndex index;
+   // Unsorted, like a map saved before the index existed.
+   addLandmark( index, 7, 3, 100 );
+   addLandmark( index, 3, 7, 101 );
+   addLandmark( index, 0x80000003, 7, 102 );
+   addLandmark( index, 3, 7, 103 );
+   addLandmark( index, 3, 0x80000007, 104 );
+   addLandmark( index, 2, 7, 105 );
+   std::stable_sort( index.begin(), index.end() );
+
+   // The landmarks of a connection keep the order they were read in.
+   vector<uint32> itemIDs = getItemIDs( index, 3, 7 );
+   MC2_TEST_REQUIRED( itemIDs.size() == 2 );
+   MC2_TEST_CHECK( itemIDs[ 0 ] == 101 );
+   MC2_TEST_CHECK( itemIDs[ 1 ] == 103 );
+
+   // Both directions and both nodes of an item are separate connections.
+   itemIDs = getItemIDs( index, 7, 3 );
+   MC2_TEST_REQUIRED( itemIDs.size() == 1 );
+   MC2_TEST_CHECK( itemIDs[ 0 ] == 100 );
+   itemIDs = getItemIDs( index, 0x80000003, 7 );
+   MC2_TEST_REQUIRED( itemIDs.size() == 1 );
+   MC2_TEST_CHECK( itemIDs[ 0 ] == 102 );
+   itemIDs = getItemIDs( index, 3, 0x80000007 );
+   MC2_TEST_REQUIRED( itemIDs.size() == 1 );
+   MC2_TEST_CHECK( itemIDs[ 0 ] == 104 );
+   itemIDs = getItemIDs( index, 2, 7 );
+   MC2_TEST_REQUIRED( itemIDs.size() == 1 );
+   MC2_TEST_CHECK( itemIDs[ 0 ] == 105 );
+
+   // Connections without landmarks, also between existing keys.
+   MC2_TEST_CHECK( getItemIDs( index, 3, 6 ).empty() );
+   MC2_TEST_CHECK( getItemIDs( index, 7, 2 ).empty() );
+   MC2_TEST_CHECK( getItemIDs( index, 0, 0 ).empty() );
+   MC2_TEST_CHECK( getItemIDs( index, MAX_UINT32, MAX_UINT32 ).empty() );
+}
+
+MC2_UNIT_TEST_FUNCTION( landmarkIndexMatchesTableTest ) {
+   // The index must give the same landmarks as the old multimap.
+   GenericMap::landmarkTable_t table;
+   GenericMap::LandmarkIndex index;
+   for ( uint32 i = 0; i < 200; ++i ) {
+      uint32 fromNodeID = ( i * 7919 ) % 23;
+      uint32 toNodeID = ( i * 104729 ) % 19;
+      addLandmark( index, fromNodeID, toNodeID, i );
+      table.insert( make_pair( index.back().key, index.back().value ) );
+   }
+   std::stable_sort( index.begin(), index.end() );
+
+   for ( uint32 fromNodeID = 0; fromNodeID < 24; ++fromNodeID ) {
+      for ( uint32 toNodeID = 0; toNodeID < 20; ++toNodeID ) {
+         uint64 key = (uint64(fromNodeID) << 32) | uint64(toNodeID);
+         vector<uint32> expected;
+         for ( GenericMap::landmarkTable_t::const_iterator it =
+                  table.lower_bound( key );
+               it != table.upper_bound( key ); ++it ) {
+            expected.push_back( it->second.itemID );
+         }
+         MC2_TEST_CHECK( getItemIDs( index, fromNodeID, toNodeID ) ==
+                         expected );
+      }
+   }
+}
@@ -0,0 +1,118 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "MC2UnitTestMain.h"
+
+#include "SubRoutePacket.h"
+#include "SubRouteVector.h"
+#include "SubRoute.h"
+#include "OrigDestInfo.h"
+#include "DriverPref.h"
+
+namespace {
+
+/// The flags in the byte shared with the number of alternatives.
+byte getRouteFlags( const SubRouteRequestPacket& packet ) {
+   return packet.getBuf()[ SubRouteRequestPacket::NBR_ALTERNATIVES_POS ] &
+      ~( 0x7 << SubRouteRequestPacket::NBR_ALTERNATIVES_BIT_POS );
+}
+
+}
+
+MC2_UNIT_TEST_FUNCTION( subRouteRequestAlternativesTest ) {
+   DriverPref pref;
+   OrigDestInfo orig( &pref, 1, 10, MAX_INT32, MAX_INT32, 0.0 );
+   SubRouteVector origs;
+   origs.insertSubRoute( new SubRoute( orig, orig ) );
+   OrigDestInfoList dests;
+   dests.addOrigDestInfo( OrigDestInfo( &pref, 1, 20, MAX_INT32, MAX_INT32,
+                                        0.5 ) );
+
+   SubRouteRequestPacket packet( &pref, &origs, &dests, &dests,
+                                 false, // routeToOneDest
+                                 MAX_UINT32,
+                                 0, NULL,
+                                 true,  // calcCostSums
+                                 true );// dontSendSubRoutes
+   MC2_TEST_CHECK( packet.getNbrAlternatives() == 0 );
+   const byte flags = getRouteFlags( packet );
+   // routeToAll, calcCostSums and dontSendSubRoutes
+   MC2_TEST_CHECK( flags == 0x7 );
+
+   packet.setNbrAlternatives( 3 );
+   MC2_TEST_CHECK( packet.getNbrAlternatives() == 3 );
+   MC2_TEST_CHECK( getRouteFlags( packet ) == flags );
+
+   // Only three bits.
+   packet.setNbrAlternatives( 100 );
+   MC2_TEST_CHECK( packet.getNbrAlternatives() == 7 );
+   MC2_TEST_CHECK( getRouteFlags( packet ) == flags );
+
+   packet.setNbrAlternatives( 0 );
+   MC2_TEST_CHECK( packet.getNbrAlternatives() == 0 );
+   MC2_TEST_CHECK( getRouteFlags( packet ) == flags );
+
+   // The flags do not touch the number of alternatives.
+   packet.setNbrAlternatives( 5 );
+   packet.setRouteToAll( false );
+   packet.setDontSendSubRoutes( false );
+   MC2_TEST_CHECK( packet.getNbrAlternatives() == 5 );
+}
+
+MC2_UNIT_TEST_FUNCTION( subRouteReplyAlternativeTest ) {
+   // A reply with one SubRoute from node 10 on map 1 to node 30 on
+   // map 2, the second alternative route.
+   ReplyPacket packet( 1024, Packet::PACKETTYPE_SUBROUTEREPLY );
+   int pos = REPLY_HEADER_SIZE;
+   packet.incWriteLong( pos, SubRouteListTypes::LOWER_LEVEL );
+   packet.incWriteLong( pos, 0 );          // routeID
+   packet.incWriteLong( pos, MAX_UINT32 ); // cutOff
+   packet.incWriteLong( pos, 1 );          // nbrSubRoutes
+
+   packet.incWriteLong( pos, 0 );          // subRouteID
+   packet.incWriteLong( pos, 4 );          // prevSubRouteID
+   packet.incWriteByte( pos, 1 );          // complete
+   packet.incWriteByte( pos, 1 );          // forward
+   packet.incWriteShort( pos, 2 );         // alternative
+   packet.incWriteLong( pos, 1 );          // mapID
+   packet.incWriteLong( pos, 1 );          // nbrConnections
+   packet.incWriteLong( pos, 3 );          // nbrNodes
+
+   packet.incWriteLong( pos, 2 );          // mapID
+   packet.incWriteLong( pos, 30 );         // nodeID
+   packet.incWriteLong( pos, 500 );        // cost
+   packet.incWriteLong( pos, 600 );        // estCost
+   packet.incWriteLong( pos, 100 );        // lat
+   packet.incWriteLong( pos, 200 );        // lon
+   packet.incWriteShort( pos, 0 );         // offset
+   packet.incWriteShort( pos, 0 );         // nbrCosts
+
+   packet.incWriteLong( pos, 10 );
+   packet.incWriteLong( pos, 11 );
+   packet.incWriteLong( pos, 12 );
+   packet.setLength( pos );
+
+   DriverPref pref;
+   SubRouteVector subRoutes;
+   static_cast< SubRouteReplyPacket& >( packet ).
+      getSubRouteVector( &pref, subRoutes );
+
+   MC2_TEST_REQUIRED( subRoutes.getSize() == 1 );
+   const SubRoute* subRoute = subRoutes.getSubRouteAt( 0 );
+   MC2_TEST_CHECK( subRoute->getAlternative() == 2 );
+   MC2_TEST_CHECK( subRoute->getPrevSubRouteID() == 4 );
+   MC2_TEST_CHECK( subRoute->getThisMapID() == 1 );
+   MC2_TEST_CHECK( subRoute->getNextMapID() == 2 );
+   MC2_TEST_CHECK( subRoute->getDestNodeID() == 30 );
+   MC2_TEST_CHECK( subRoute->getCost() == 500 );
+}
@@ -0,0 +1,103 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "MC2UnitTestMain.h"
+
+#include "XMLStreamWriter.h"
+#include "XMLInit.h"
+
+//
+// This is a test for writing XML with the XMLStreamWriter.
+//
+
+namespace {
+/// The start of the documents written with iso-8859-1.
+const char* DECLARATION = 
+   "<?xml version=\"1.0\" encoding=\"iso-8859-1\" standalone=\"no\" ?>\n"
+   "<!DOCTYPE main>\n";
+
+/// Writes the same elements in all tests.
+void writeElements( XMLStreamWriter& writer ) {
+   writer.writeDeclaration( "main" );
+   writer.startElement( "main" );
+   writer.addAttribute( "id", MC2String( "a<\"&" ) );
+   writer.startElement( "a" );
+   writer.addAttribute( "nbr", uint32( 42 ) );
+   writer.addElementWithText( "b", "the_b <&>" );
+   writer.startElement( "c" );
+   writer.addAttribute( "flag", true );
+   writer.endElement();
+   writer.endElement();
+   writer.addElementWithText( "d", "the_d" );
+   writer.endElement();
+}
+}
+
+MC2_UNIT_TEST_FUNCTION( nestingAndEscapingTest ) {
+   XMLTool::XMLInit initXML;
+
+   MC2String out;
+   {
+      XMLStreamWriter writer( out, "iso-8859-1", false );
+      writeElements( writer );
+      MC2_TEST_CHECK( writer.getDepth() == 0 );
+   }
+
+   MC2_TEST_CHECK_EXT( out == MC2String( DECLARATION ) +
+                       "<main id=\"a&lt;&quot;&amp;\">"
+                       "<a nbr=\"42\"><b>the_b &lt;&amp;&gt;</b>"
+                       "<c flag=\"true\"/></a>"
+                       "<d>the_d</d></main>", out );
+}
+
+MC2_UNIT_TEST_FUNCTION( indentTest ) {
+   XMLTool::XMLInit initXML;
+
+   MC2String out;
+   {
+      XMLStreamWriter writer( out, "iso-8859-1", true );
+      writeElements( writer );
+   }
+
+   // Same whitespace as XMLUtility::indentPiece adds
+   MC2_TEST_CHECK_EXT( out == MC2String( DECLARATION ) +
+                       "<main id=\"a&lt;&quot;&amp;\">\n"
+                       "   <a nbr=\"42\">\n"
+                       "      <b>the_b &lt;&amp;&gt;</b>\n"
+                       "      <c flag=\"true\"/>\n"
+                       "   </a>\n"
+                       "   <d>the_d</d>\n"
+                       "</main>", out );
+}
+
+MC2_UNIT_TEST_FUNCTION( endElementsToTest ) {
+   XMLTool::XMLInit initXML;
+
+   MC2String out;
+   {
+      XMLStreamWriter writer( out, "iso-8859-1", false );
+      writer.startElement( "main" );
+      const uint32 depth = writer.getDepth();
+      writer.startElement( "a" );
+      writer.startElement( "b" );
+      writer.addText( "the_b" );
+      MC2_TEST_CHECK( writer.getDepth() == 3 );
+      writer.endElementsTo( depth );
+      MC2_TEST_CHECK( writer.getDepth() == depth );
+      writer.addElementWithText( "status_code", "-1" );
+      writer.endElement();
+   }
+
+   MC2_TEST_CHECK_EXT( out == "<main><a><b>the_b</b></a>"
+                       "<status_code>-1</status_code></main>", out );
+}
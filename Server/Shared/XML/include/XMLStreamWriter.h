@@ -0,0 +1,173 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef XMLSTREAMWRITER_H
+#define XMLSTREAMWRITER_H
+
+#ifdef USE_XML
+#include "config.h"
+#include "NotCopyable.h"
+#include "MC2String.h"
+
+#include <dom/DOM.hpp>
+#include <framework/XMLFormatter.hpp>
+
+#include <vector>
+#include <string>
+
+#if (XERCES_VERSION_MAJOR == 2 && XERCES_VERSION_MINOR >= 4) || (XERCES_VERSION_MAJOR > 2)
+using namespace xercesc;
+#endif
+
+/**
+ * Writes an XML document element by element into a string, without
+ * building a DOM tree of it first.
+ *
+ * The text is written in the charset of the document and characters
+ * that can not be represented in it are written as character references.
+ * When indenting, the whitespace is the same as XMLUtility::indentPiece
+ * adds to a DOM tree, with three spaces per level.
+ */
+class XMLStreamWriter: private XMLFormatTarget, private NotCopyable {
+public:
+   /**
+    * @param out The string to append the document to.
+    * @param charset The charset of the document.
+    * @param indent If to add newlines and indentation.
+    */
+   XMLStreamWriter( MC2String& out, const char* charset, bool indent );
+
+   ~XMLStreamWriter();
+
+   /**
+    * Writes the xml declaration and a DOCTYPE without external id, like
+    * XMLTreeFormatter does for the documents of the servers.
+    *
+    * @param documentType The name of the document element.
+    */
+   void writeDeclaration( const char* documentType );
+
+   /**
+    * Starts a new element inside the current one.
+    *
+    * @param name The name of the element.
+    */
+   void startElement( const char* name );
+
+   /**
+    * Adds an attribute to the element just started, before any content
+    * has been added to it.
+    *
+    * @param name The name of the attribute.
+    * @param value The value of the attribute.
+    */
+   void addAttribute( const char* name, const MC2String& value );
+
+   /// @see addAttribute
+   void addAttribute( const char* name, uint32 value );
+
+   /// @see addAttribute, writes "true" or "false".
+   void addAttribute( const char* name, bool value );
+
+   /**
+    * Adds text to the current element.
+    *
+    * @param text The text to add.
+    */
+   void addText( const MC2String& text );
+
+   /**
+    * Adds an element with only text in it.
+    *
+    * @param name The name of the element.
+    * @param text The text of the element.
+    */
+   void addElementWithText( const char* name, const MC2String& text );
+
+   /**
+    * Ends the current element.
+    */
+   void endElement();
+
+   /**
+    * Ends the elements that were started after the writer was at depth.
+    *
+    * @param depth The depth to go back to, see getDepth.
+    */
+   void endElementsTo( uint32 depth );
+
+   /**
+    * Writes a DOM node, with attributes and children, inside the current
+    * element. Comments are left out.
+    *
+    * @param node The node to write.
+    */
+   void writeNode( const DOMNode& node );
+
+   /// @return The number of elements that are started but not ended.
+   uint32 getDepth() const { return m_openElements.size(); }
+
+private:
+   /// Writes the bytes from the formatter to the string.
+   void writeChars( const XMLByte* const toWrite,
+                    const unsigned int count,
+                    XMLFormatter* const formatter );
+
+   /// Starts an element with the name.
+   void startElement( const XMLCh* name );
+
+   /// Adds an attribute to the element just started.
+   void addAttribute( const XMLCh* name, const XMLCh* value );
+
+   /// Adds text to the current element.
+   void addText( const XMLCh* text );
+
+   /// Writes the end of the start tag of the current element, if open.
+   void closeStartTag();
+
+   /// Marks that the current element has content, first being text or not.
+   void addContent( bool text );
+
+   /// Writes a newline and the indentation for level.
+   void writeIndent( uint32 level );
+
+   /// An element that is started but not ended.
+   struct OpenElement {
+      explicit OpenElement( const XMLCh* name ):
+         m_name( name ), m_hasContent( false ), m_indentEnd( false ) {}
+
+      /// The name of the element, for the end tag.
+      std::basic_string< XMLCh > m_name;
+      /// If anything has been added inside the element.
+      bool m_hasContent;
+      /// If the first thing in the element was an element.
+      bool m_indentEnd;
+   };
+
+   /// The string the document is written to.
+   MC2String& m_out;
+   /// Transcodes and escapes the text for the document.
+   XMLFormatter* m_formatter;
+   /// The charset of the document.
+   MC2String m_charset;
+   /// If to add newlines and indentation.
+   bool m_indent;
+   /// If the start tag of the last started element lacks its '>'.
+   bool m_startTagOpen;
+   /// The elements that are started but not ended, innermost last.
+   std::vector< OpenElement > m_openElements;
+};
+
+#endif // USE_XML
+
+#endif // XMLSTREAMWRITER_H
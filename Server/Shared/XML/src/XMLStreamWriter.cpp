@@ -0,0 +1,212 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "XMLStreamWriter.h"
+
+#ifdef USE_XML
+
+#include "XMLUtility.h"
+
+#include <util/XMLUniDefs.hpp>
+
+namespace {
+/// The deepest level that is indented, as in XMLUtility::indentPiece.
+const uint32 MAX_INDENT_LEVEL = 10;
+/// The number of spaces per indentation level.
+const uint32 INDENT_SPACES = 3;
+}
+
+XMLStreamWriter::XMLStreamWriter( MC2String& out, const char* charset,
+                                  bool indent ):
+   m_out( out ),
+   m_formatter( NULL ),
+   m_charset( charset ),
+   m_indent( indent ),
+   m_startTagOpen( false )
+{
+   // Throws if the charset is unknown, before anything is written
+   m_formatter = new XMLFormatter( charset, "1.0", this,
+                                   XMLFormatter::NoEscapes,
+                                   XMLFormatter::UnRep_CharRef );
+}
+
+XMLStreamWriter::~XMLStreamWriter() {
+   delete m_formatter;
+}
+
+void
+XMLStreamWriter::writeChars( const XMLByte* const toWrite,
+                             const unsigned int count,
+                             XMLFormatter* const formatter ) {
+   m_out.append( reinterpret_cast< const char* >( toWrite ), count );
+}
+
+void
+XMLStreamWriter::writeDeclaration( const char* documentType ) {
+   *m_formatter << XMLFormatter::NoEscapes
+                << X( "<?xml version=\"1.0\" encoding=\"" )
+                << X( m_charset )
+                << X( "\" standalone=\"no\" ?>\n<!DOCTYPE " )
+                << X( documentType ) << chCloseAngle << chLF;
+}
+
+void
+XMLStreamWriter::startElement( const char* name ) {
+   startElement( X( name ) );
+}
+
+void
+XMLStreamWriter::startElement( const XMLCh* name ) {
+   closeStartTag();
+   if ( ! m_openElements.empty() ) {
+      addContent( false );
+      if ( m_indent ) {
+         writeIndent( m_openElements.size() );
+      }
+   }
+   *m_formatter << XMLFormatter::NoEscapes << chOpenAngle << name;
+   m_startTagOpen = true;
+   m_openElements.push_back( OpenElement( name ) );
+}
+
+void
+XMLStreamWriter::addAttribute( const char* name, const MC2String& value ) {
+   addAttribute( X( name ), X( value ) );
+}
+
+void
+XMLStreamWriter::addAttribute( const char* name, uint32 value ) {
+   addAttribute( X( name ), XUint32( value ) );
+}
+
+void
+XMLStreamWriter::addAttribute( const char* name, bool value ) {
+   addAttribute( X( name ), X( value ? "true" : "false" ) );
+}
+
+void
+XMLStreamWriter::addAttribute( const XMLCh* name, const XMLCh* value ) {
+   MC2_ASSERT( m_startTagOpen );
+   *m_formatter << XMLFormatter::NoEscapes << chSpace << name
+                << chEqual << chDoubleQuote
+                << XMLFormatter::AttrEscapes << value
+                << XMLFormatter::NoEscapes << chDoubleQuote;
+}
+
+void
+XMLStreamWriter::addText( const MC2String& text ) {
+   addText( X( text ) );
+}
+
+void
+XMLStreamWriter::addText( const XMLCh* text ) {
+   closeStartTag();
+   addContent( true );
+   *m_formatter << XMLFormatter::CharEscapes << text;
+}
+
+void
+XMLStreamWriter::addElementWithText( const char* name,
+                                     const MC2String& text ) {
+   startElement( name );
+   addText( text );
+   endElement();
+}
+
+void
+XMLStreamWriter::endElement() {
+   MC2_ASSERT( ! m_openElements.empty() );
+   const OpenElement& element = m_openElements.back();
+   if ( m_startTagOpen ) {
+      // Nothing inside the element
+      *m_formatter << XMLFormatter::NoEscapes << chForwardSlash
+                   << chCloseAngle;
+      m_startTagOpen = false;
+   } else {
+      if ( m_indent && element.m_indentEnd ) {
+         writeIndent( m_openElements.size() - 1 );
+      }
+      *m_formatter << XMLFormatter::NoEscapes << chOpenAngle
+                   << chForwardSlash << element.m_name.c_str()
+                   << chCloseAngle;
+   }
+   m_openElements.pop_back();
+}
+
+void
+XMLStreamWriter::endElementsTo( uint32 depth ) {
+   while ( m_openElements.size() > depth ) {
+      endElement();
+   }
+}
+
+void
+XMLStreamWriter::writeNode( const DOMNode& node ) {
+   switch ( node.getNodeType() ) {
+      case DOMNode::ELEMENT_NODE : {
+         startElement( node.getNodeName() );
+         const DOMNamedNodeMap* attributes = node.getAttributes();
+         for ( XMLSize_t i = 0 ; i < attributes->getLength() ; ++i ) {
+            const DOMNode* attribute = attributes->item( i );
+            addAttribute( attribute->getNodeName(),
+                          attribute->getNodeValue() );
+         }
+         for ( const DOMNode* child = node.getFirstChild() ;
+               child != NULL ; child = child->getNextSibling() ) {
+            writeNode( *child );
+         }
+         endElement();
+      }
+      break;
+      case DOMNode::TEXT_NODE :
+      case DOMNode::CDATA_SECTION_NODE :
+         addText( node.getNodeValue() );
+         break;
+      default:
+         // Comments and such are not part of the replies
+         break;
+   }
+}
+
+void
+XMLStreamWriter::closeStartTag() {
+   if ( m_startTagOpen ) {
+      *m_formatter << XMLFormatter::NoEscapes << chCloseAngle;
+      m_startTagOpen = false;
+   }
+}
+
+void
+XMLStreamWriter::addContent( bool text ) {
+   OpenElement& element = m_openElements.back();
+   if ( ! element.m_hasContent ) {
+      element.m_hasContent = true;
+      // Like indentPiece, no indentation before the end tag when the
+      // element starts with text.
+      element.m_indentEnd = ! text;
+   }
+}
+
+void
+XMLStreamWriter::writeIndent( uint32 level ) {
+   XMLCh indentStr[ MAX_INDENT_LEVEL * INDENT_SPACES + 2 ];
+   uint32 nbrSpaces = MIN( level, MAX_INDENT_LEVEL ) * INDENT_SPACES;
+   indentStr[ 0 ] = chLF;
+   for ( uint32 i = 1 ; i <= nbrSpaces ; ++i ) {
+      indentStr[ i ] = chSpace;
+   }
+   indentStr[ nbrSpaces + 1 ] = chNull;
+   *m_formatter << XMLFormatter::NoEscapes << indentStr;
+}
+
+#endif // USE_XML
@@ -42,7 +42,7 @@ class DOMPrintFormatTarget : public XMLFormatTarget {
       const unsigned int count,
       XMLFormatter* const formatter ) 
       {
-         m_out << (char *) toWrite;
+         m_out.write( (const char *) toWrite, count );
       }
 
 
@@ -57,7 +57,10 @@ class DOMPrintFormatTarget : public XMLFormatTarget {
 // Local class, for printing tree into string
 class StringPrintFormatTarget : public XMLFormatTarget {
    public:
-      StringPrintFormatTarget()  {m_string.reserve(10000);}
+      /// Appends the output to str.
+      StringPrintFormatTarget( MC2String& str ) : m_string( str ) {
+         m_string.reserve( 10000 );
+      }
       ~StringPrintFormatTarget() {} 
 
     ///  Implementations of the format target interface
@@ -66,16 +69,11 @@ class StringPrintFormatTarget : public XMLFormatTarget {
       const unsigned int count,
       XMLFormatter* const formatter ) 
       {
-         m_string.append( (char *) toWrite );
-      }
-
-
-      MC2String getString() {
-         return m_string;
+         m_string.append( (const char *) toWrite, count );
       }
 
    private:
-      MC2String m_string;
+      MC2String& m_string;
 
       ///  Unimplemented methods.
       StringPrintFormatTarget(const StringPrintFormatTarget& other);
@@ -141,12 +139,11 @@ XMLTreeFormatter::formatTree( XMLFormatTarget* formatTarget,
 
 MC2String
 XMLTreeFormatter::makeStringOfTree( DOMNode* doc, const char* charset ) {
-   StringPrintFormatTarget* formatTarget = new StringPrintFormatTarget();  
+   // Written directly into the returned string, no copies
+   MC2String res;
+   StringPrintFormatTarget formatTarget( res );
 
-   formatTree( formatTarget, doc, charset );
-
-   MC2String res = formatTarget->getString();
-   delete formatTarget;
+   formatTree( &formatTarget, doc, charset );
 
    return res;
 }
@@ -154,12 +151,10 @@ XMLTreeFormatter::makeStringOfTree( DOMNode* doc, const char* charset ) {
 MC2String XMLTreeFormatter::makeIndentedStringOfTree( DOMNode* doc, 
                                                       const char* charset )
 {
-   StringPrintFormatTarget* formatTarget = new StringPrintFormatTarget();  
+   MC2String res;
+   StringPrintFormatTarget formatTarget( res );
 
-   formatTree( formatTarget, doc, charset, true);
-
-   MC2String res = formatTarget->getString();
-   delete formatTarget;
+   formatTree( &formatTarget, doc, charset, true );
 
    return res;
 }
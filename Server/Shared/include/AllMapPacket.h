@@ -82,8 +82,10 @@ class AllMapRequestPacket : public Packet
         *   @param   aIP   IP of the sender.
         *   @param   aPort Portnumber that the sender whant the answer
         *                  send to.
+        *   @param   type  The type of information wanted.
         */      
-      AllMapRequestPacket(uint32 aIP, uint16 aPort);
+      AllMapRequestPacket(uint32 aIP, uint16 aPort,
+                          allmap_t type = ONLY_MAPID);
 
       /**
         *   Creates a AllMapRequestPacket with specified originIP
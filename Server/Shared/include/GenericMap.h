@@ -1221,11 +1221,48 @@ public:
    typedef multimap<uint64, ItemTypes::lmdescription_t> landmarkTable_t;
       
    /**
-    *   Get the landmark table of this map.
+    *   Get the landmark table of this map. Only used when creating
+    *   maps, loaded maps keep their landmarks in the landmark index.
     */
    inline landmarkTable_t& getLandmarkTable();
    inline const landmarkTable_t& getLandmarkTable() const;
 
+   /// A landmark with the key fromNodeID.toNodeID of its connection.
+   typedef STLUtility::ValuePair< uint64, ItemTypes::lmdescription_t >
+      LandmarkPair;
+   /// Landmarks sorted on the connection.
+   typedef vector< LandmarkPair, MC2Map::Allocator< LandmarkPair > >
+      LandmarkIndex;
+   /// The landmarks of one connection.
+   typedef pair< LandmarkIndex::const_iterator,
+                 LandmarkIndex::const_iterator > LandmarkRange;
+
+   /**
+    *   Get the landmarks of a connection in a loaded map.
+    *
+    *   @param fromNodeID The node the connection comes from.
+    *   @param toNodeID   The node the connection leads to.
+    *   @return The landmarks of the connection, empty if none.
+    */
+   LandmarkRange getLandmarks( uint32 fromNodeID, uint32 toNodeID ) const;
+
+   /**
+    *   Get the landmarks of a connection from a landmark index.
+    *
+    *   @param index      Landmarks sorted on their connection.
+    *   @param fromNodeID The node the connection comes from.
+    *   @param toNodeID   The node the connection leads to.
+    *   @return The landmarks of the connection, empty if none.
+    */
+   inline static LandmarkRange getLandmarks( const LandmarkIndex& index,
+                                             uint32 fromNodeID,
+                                             uint32 toNodeID );
+
+   /**
+    *   Get all the landmarks of a loaded map, sorted on the connection.
+    */
+   inline const LandmarkIndex& getLandmarkIndex() const;
+
    /**
     *    Find an unique item described by the specified ItemIdentifier.
     *    In case a unique item can't be found, NULL is returned.
@@ -1965,6 +2002,9 @@ private:
 
    /// Lookup for itemID to index area order.
    IndexAreaOrderMap m_indexAreaOrderMap;
+
+   /// The landmarks of a loaded map, replaces m_landmarkTable.
+   LandmarkIndex m_landmarkIndex;
 };
 
 // ========================================================================
@@ -2042,6 +2082,20 @@ GenericMap::getLandmarkTable() const
    return (m_landmarkTable);
 }
 
+inline GenericMap::LandmarkRange
+GenericMap::getLandmarks( const LandmarkIndex& index,
+                          uint32 fromNodeID, uint32 toNodeID )
+{
+   uint64 key = (uint64(fromNodeID) << 32) | uint64(toNodeID);
+   return equal_range( index.begin(), index.end(), LandmarkPair( key ) );
+}
+
+inline const GenericMap::LandmarkIndex&
+GenericMap::getLandmarkIndex() const
+{
+   return m_landmarkIndex;
+}
+
 inline const uint32* 
 GenericMap::getItemGroups() const {
    return m_groups.data();
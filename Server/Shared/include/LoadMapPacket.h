@@ -16,6 +16,8 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 
 #define LOAD_MAP_REQUEST_PRIO DEFAULT_PACKET_PRIO
 #define LOAD_MAP_REPLY_PRIO 0
+/// Lower priority than all ordinary requests.
+#define PRELOAD_MAP_REQUEST_PRIO 12
 
 #include "config.h"
 #include "Packet.h"
@@ -52,12 +54,29 @@ public:
     *   Returns the destination port of the packet.
     */
    inline uint32 getMapLoaderPort() const;
+
+   /**
+    *   Marks the request as a speculative load of a map that will
+    *   probably be needed soon. Also lowers the priority of the packet
+    *   so that the module handles it after the ordinary requests.
+    *   When a server sends a preload to the leader the leader replies
+    *   at once and only loads the map if a module has time and memory
+    *   to spare.
+    */
+   inline void setPreload( bool preload );
+
+   /**
+    *   Returns true if the request is a speculative load.
+    */
+   inline bool isPreload() const;
    
 private:
    /** Position of destIP ( 4 bytes ) */
    static const int DEST_IP_POS = REQUEST_HEADER_SIZE;
    /** Position of destPort ( 4 bytes ) */
    static const int DEST_PORT_POS = DEST_IP_POS + 4;
+   /** Position of the preload flag ( 4 bytes ) */
+   static const int PRELOAD_POS = DEST_PORT_POS + 4;
    
 };
 
@@ -138,6 +157,20 @@ LoadMapRequestPacket::getMapLoaderPort() const
    return readLong(DEST_PORT_POS);
 }
 
+inline void
+LoadMapRequestPacket::setPreload( bool preload )
+{
+   writeLong( PRELOAD_POS, preload );
+   setPriority( preload ? PRELOAD_MAP_REQUEST_PRIO : LOAD_MAP_REQUEST_PRIO );
+}
+
+inline bool
+LoadMapRequestPacket::isPreload() const
+{
+   // Older packets have no flag.
+   return getLength() >= PRELOAD_POS + 4 && readLong( PRELOAD_POS ) != 0;
+}
+
 
 // === LoadMapReply
 
@@ -51,10 +51,19 @@ public:
    /// @return destination
    const IPnPort& getDestination() const { return m_destination; }
 
+   /**
+    * Writes the time since this NetPacket was created into the
+    * trace context of the packet, if it is a traced request.
+    * Call just before the packet is sent.
+    */
+   void setSendQueueTime();
+
 private:
    std::auto_ptr<Packet> m_packet;
    IPnPort m_destination;
    Type m_type;
+   /// When the packet was put in the send queue.
+   uint32 m_enqueueTime;
 };
 
 #endif // NETPACKET_H
@@ -18,6 +18,8 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include "SocketReceiver.h"
 
 #include <set>
+#include <deque>
+#include <vector>
 
 class DatagramReceiver;
 class Packet;
@@ -27,6 +29,9 @@ class TCPSocket;
   *   Class to receive a packet from Datagram- or TCPsockets.
   *   The functions are thread unsafe.
   *
+  *   The datagrams waiting on a DatagramReceiver are received in
+  *   batches of at most UDP_RECEIVE_BATCH_SIZE (default 16) and
+  *   returned one at a time before the sockets are selected again.
   */
 class PacketReceiver {
    public:
@@ -92,8 +97,9 @@ class PacketReceiver {
       
       /**
         *   The socket that received last.
-        *   @return pointer to the last socket that recived. May be
-        *           DatagramReceiver or TCPSocket pointer.
+        *   @return pointer to the socket that received the last
+        *           returned packet. May be DatagramReceiver or
+        *           TCPSocket pointer.
         */
       void *getSocketThatReceived();
 
@@ -146,6 +152,36 @@ class PacketReceiver {
        */
       set<TCPSocket*> m_permanentSockets;
 
+      /// A packet received in a batch but not returned yet.
+      struct pendingPacket_t {
+         /// The packet.
+         Packet* packet;
+         /// The socket it was received on.
+         DatagramReceiver* socket;
+      };
+
+      /**
+       *   The packets received in the last batch that have not
+       *   been returned yet.
+       */
+      std::deque<pendingPacket_t> m_pendingPackets;
+
+      /**
+       *   The socket of the last returned packet if it was pending,
+       *   else NULL.
+       */
+      DatagramReceiver* m_pendingSocket;
+
+      /**
+       *   The max number of datagrams to receive at once.
+       */
+      uint32 m_batchSize;
+
+      /**
+       *   The packets of a batch, kept to save allocations.
+       */
+      std::vector<Packet*> m_batch;
+
 };
 
 #endif
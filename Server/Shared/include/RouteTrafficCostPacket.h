@@ -48,6 +48,12 @@ public:
     *    Fills in the rights from the packet.
     */
    int getRights( UserRightsMapInfo& rights ) const;
+
+   /**
+    *    Returns a crc of the rights in the packet. Requests with the
+    *    same crc get the same traffic from the InfoModule.
+    */
+   uint32 getRightsCRC() const;
    
 private:
    /// Calculates the needed size of the packet buffer.
@@ -88,6 +94,12 @@ public:
     *    Puts the traffic info in the vector.
     */
    uint32 getTraffic( DisturbanceVector& resVect, bool costC ) const;
+
+   /**
+    *    Returns a crc of the traffic info in the packet. Can be
+    *    used to find out if the traffic on the map has changed.
+    */
+   uint32 getTrafficCRC() const;
       
 private:
    /**  The position of the map id */
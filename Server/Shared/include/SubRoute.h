@@ -181,6 +181,11 @@ public:
     *    @return The starting vehicle for this SubRoute.
     */
    inline const Vehicle* getOrigVehicle() const;
+
+   /**
+    *    Sets the vehicle of the origin.
+    */
+   inline void setOrigVehicle( const Vehicle* vehicle );
    
    /**
     *    @return  True if origInfo and destInfo in same map
@@ -228,6 +233,19 @@ public:
     *
     */
    inline void setCostCSum(uint32 costSum);
+
+   /**
+    *    @return The number of the alternative route this SubRoute
+    *            belongs to, 0 for the best route.
+    */
+   inline uint16 getAlternative() const;
+
+   /**
+    *    Sets the number of the alternative route this SubRoute
+    *    belongs to.
+    *    @param alternative 0 for the best route.
+    */
+   inline void setAlternative( uint16 alternative );
    
 private:
 
@@ -240,6 +258,12 @@ private:
     *    information about the end of the SubRoute
     */
    OrigDestInfo m_destInfo;
+
+   /**
+    *    The alternative route this SubRoute belongs to, 0 for the
+    *    best route.
+    */
+   uint16 m_alternative;
 };
 
 // -----------------------------------------------------------------------
@@ -395,6 +419,12 @@ SubRoute::getOrigVehicle() const
    return m_origInfo.getVehicle();
 }
 
+inline void
+SubRoute::setOrigVehicle( const Vehicle* vehicle )
+{
+   m_origInfo.setVehicle( vehicle );
+}
+
 inline bool
 SubRoute::hasOneMap() const
 {
@@ -449,6 +479,18 @@ SubRoute::setCostCSum(uint32 costSum)
    return m_destInfo.setCostCSum(costSum);
 }
 
+inline uint16
+SubRoute::getAlternative() const
+{
+   return m_alternative;
+}
+
+inline void
+SubRoute::setAlternative( uint16 alternative )
+{
+   m_alternative = alternative;
+}
+
 #endif
 
 
@@ -172,6 +172,20 @@ public:
     * @param original if true this is the first time a subrouteRequest.
     */
    inline void setIsOriginalRequest( bool original ); 
+
+   /**
+    *   Sets the number of alternative routes that the RouteModule
+    *   should return together with the best route. Only used
+    *   for original requests that stay on one map.
+    *
+    *   @param nbrAlternatives The number of alternatives, at most 7.
+    */
+   inline void setNbrAlternatives( uint32 nbrAlternatives );
+
+   /**
+    *   Returns the number of alternative routes to return.
+    */
+   inline uint32 getNbrAlternatives() const;
    
    /**
     * Tells if we should use a u-turn cost when routing.
@@ -377,6 +391,17 @@ public:
     */
    static const int DONT_SEND_SUBROUTES_BIT_POS = 2;
 
+   /**
+    *   The position of the number of alternative routes.
+    *   Currently the same as ROUTE_TO_ALL_POS.
+    */
+   static const int NBR_ALTERNATIVES_POS = ROUTE_TO_ALL_POS;
+
+   /**
+    *   The first bit of the number of alternatives. Three bits are used.
+    */
+   static const int NBR_ALTERNATIVES_BIT_POS = 3;
+
    /**
     * The position in the packet of listType.
     */
@@ -495,6 +520,23 @@ SubRouteRequestPacket::setDontSendSubRoutes( bool dont )
              dont);
 }
 
+inline void
+SubRouteRequestPacket::setNbrAlternatives( uint32 nbrAlternatives )
+{
+   byte value = readByte( NBR_ALTERNATIVES_POS );
+   value &= ~( 0x7 << NBR_ALTERNATIVES_BIT_POS );
+   value |= ( nbrAlternatives > 7 ? 7 : nbrAlternatives )
+      << NBR_ALTERNATIVES_BIT_POS;
+   writeByte( NBR_ALTERNATIVES_POS, value );
+}
+
+inline uint32
+SubRouteRequestPacket::getNbrAlternatives() const
+{
+   return ( readByte( NBR_ALTERNATIVES_POS ) >> NBR_ALTERNATIVES_BIT_POS ) &
+      0x7;
+}
+
 inline void
 SubRouteRequestPacket::setIsOriginalRequest( bool original ) 
 {
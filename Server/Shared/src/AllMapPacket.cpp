@@ -15,7 +15,8 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 
 // ******************************************************************
 //                                                AllMapRequestPacket
-AllMapRequestPacket::AllMapRequestPacket(uint32 aIP, uint16 aPort)
+AllMapRequestPacket::AllMapRequestPacket(uint32 aIP, uint16 aPort,
+                                         allmap_t type)
   : Packet( HEADER_SIZE+4,
             ALLMAP_REQUEST_PRIO, 
             PACKETTYPE_ALLMAPREQUEST, 
@@ -25,7 +26,7 @@ AllMapRequestPacket::AllMapRequestPacket(uint32 aIP, uint16 aPort)
             0, // reqID
             0 /* deb */ ) 
 {
-   writeLong(HEADER_SIZE, 0);    // 0 = ONLY_MAPID
+   writeLong(HEADER_SIZE, type);
    setLength(HEADER_SIZE+4);
 }
 
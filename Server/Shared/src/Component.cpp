@@ -19,6 +19,7 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include "CommandlineOptionHandler.h"
 #include "FDSelectable.h"
 #include "SysUtility.h"
+#include "PacketBufferPool.h"
 
 #include <memory>
 #include <sys/types.h>
@@ -152,6 +153,8 @@ int Component::handleCommand(const char* input)
            << endl;
    } else if ( token == "heapstatus" ) {
       SysUtility::printHeapStatus( cout );
+      cout << "  packet buffers : " << PacketBufferPool::getStatistics()
+           << endl;
    } else if ( token == "abort" ) {
       mc2log << fatal << "Component aborted by user" << endl;
       PANIC("Aborted by user!", "");
@@ -216,7 +216,8 @@ GenericMap::createMap( const char* mcmName )
    m_nodeLane( m_stlAllocator ), \
    m_connectionLaneIdx( m_stlAllocator ), \
    m_categoryIds( m_stlAllocator ), \
-   m_indexAreaOrderMap( m_stlAllocator )
+   m_indexAreaOrderMap( m_stlAllocator ), \
+   m_landmarkIndex( m_stlAllocator )
 GenericMap::GenericMap()
       : GENERICMAP_STL_INIT
 {
@@ -840,6 +841,10 @@ GenericMap::loadFirstBodyBlock(DataBuffer& dataBuffer)
    // ******************************************************************
    mc2dbg2 << "To load the landmark table" << endl;
    uint32 landmarkSize = dataBuffer.readNextLong();
+   // The route expansion looks up the landmarks of every connection in
+   // the route, a sorted vector is smaller and faster than a multimap.
+   m_landmarkIndex.clear();
+   m_landmarkIndex.reserve( landmarkSize );
    if (landmarkSize > 0) {
       for (uint32 i = 0; i < landmarkSize; i++) {
          uint32 fromNodeID = dataBuffer.readNextLong();
@@ -855,10 +860,11 @@ GenericMap::loadFirstBodyBlock(DataBuffer& dataBuffer)
                ItemTypes::landmark_t(dataBuffer.readNextByte());
             
             uint64 key = (uint64(fromNodeID) << 32) | uint64(toNodeID);
-            m_landmarkTable.insert(
-                  pair<uint64, ItemTypes::lmdescription_t>(key, description));
+            m_landmarkIndex.push_back( LandmarkPair( key, description ) );
       }
    }
+   // Saved from the multimap, so already sorted unless very old.
+   std::stable_sort( m_landmarkIndex.begin(), m_landmarkIndex.end() );
    
    mc2dbg4 << "internalLoad_t after landmark table" << endl;
    CLOCK_MAPLOAD(mc2log << "[" << prettyMapIDFill(m_mapID) 
@@ -1309,24 +1315,31 @@ GenericMap::internalSave(int outfile) try
    // ***************************************************************
 
    mc2dbg2 << "saveLandmarkTable" << endl;
-   typedef landmarkTable_t::const_iterator LI;
-   uint32 landmarkSize = m_landmarkTable.size();
+   // A loaded map has its landmarks in the index.
+   vector< LandmarkPair > landmarks( m_landmarkIndex.begin(),
+                                     m_landmarkIndex.end() );
+   for ( landmarkTable_t::const_iterator it = m_landmarkTable.begin();
+         it != m_landmarkTable.end(); ++it ) {
+      landmarks.push_back( LandmarkPair( it->first, it->second ) );
+   }
+   uint32 landmarkSize = landmarks.size();
 
    dataBuffer.reset( new DataBuffer(10000000) ); // FIXME: Hardcoded size
    dataBuffer->fillWithZeros();
 
    dataBuffer->writeNextLong(landmarkSize);
-   for (LI it = m_landmarkTable.begin(); it != m_landmarkTable.end(); it++) {
-      uint32 fromNodeID = uint32 (((*it).first >> 32) & 0x00000000ffffffff);
-      uint32 toNodeID = uint32 ((*it).first & 0x00000000ffffffff);
+   for ( vector< LandmarkPair >::const_iterator it = landmarks.begin();
+         it != landmarks.end(); ++it ) {
+      uint32 fromNodeID = uint32 ((it->key >> 32) & 0x00000000ffffffff);
+      uint32 toNodeID = uint32 (it->key & 0x00000000ffffffff);
       
       dataBuffer->writeNextLong(fromNodeID);
       dataBuffer->writeNextLong(toNodeID);
-      dataBuffer->writeNextLong((*it).second.itemID);
-      dataBuffer->writeNextByte((byte) (*it).second.importance);
-      dataBuffer->writeNextByte((*it).second.side);
-      dataBuffer->writeNextByte((*it).second.location);
-      dataBuffer->writeNextByte((*it).second.type);
+      dataBuffer->writeNextLong(it->value.itemID);
+      dataBuffer->writeNextByte((byte) it->value.importance);
+      dataBuffer->writeNextByte(it->value.side);
+      dataBuffer->writeNextByte(it->value.location);
+      dataBuffer->writeNextByte(it->value.type);
    }
 
    saveBuffer( *dataBuffer.get(), outfile );
@@ -3453,6 +3466,11 @@ GenericMap::getNodeLanes( uint32 nodeId ) const {
    }
 }
 
+GenericMap::LandmarkRange
+GenericMap::getLandmarks( uint32 fromNodeID, uint32 toNodeID ) const {
+   return getLandmarks( m_landmarkIndex, fromNodeID, toNodeID );
+}
+
 const GenericMap::ConnectionSignPostMapArray*
 GenericMap::getConnectionSigns( uint32 conID ) const {
    ConnectionSignPostMap::const_iterator findIt =
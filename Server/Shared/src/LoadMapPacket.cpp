@@ -18,7 +18,7 @@ LoadMapRequestPacket::LoadMapRequestPacket(  uint32 mapID,
                                              uint16 originPort,
                                              uint32 destIP,
                                              uint16 destPort)
-      :  RequestPacket( REQUEST_HEADER_SIZE + 8,
+      :  RequestPacket( REQUEST_HEADER_SIZE + 12,
                         LOAD_MAP_REQUEST_PRIO,
                         Packet::PACKETTYPE_LOADMAPREQUEST,
                         0, // PacketID
@@ -30,6 +30,7 @@ LoadMapRequestPacket::LoadMapRequestPacket(  uint32 mapID,
    int pos = REQUEST_HEADER_SIZE;
    incWriteLong(pos, destIP);
    incWriteLong(pos, destPort);
+   incWriteLong(pos, 0); // Not a preload
    setLength(pos);
 }
 
@@ -129,9 +129,8 @@ uint64 MapHashCell::minSquaredistToBoundingbox( uint32 index, const int32 hpos,
    //return (item->getGfxData()->getMC2BoundingBox()
    //            ->squareMC2ScaleDistTo( vpos, hpos ));
 
-   // TODO: This is just a quick fix. The methods should be implemented in
-   //       the GfxData instead. Static variables are not thread safe...
-   static MC2BoundingBox bb;
+   // Not static, the map may be searched by several threads.
+   MC2BoundingBox bb;
    m_hashTable->getGfxData(item)->getMC2BoundingBox(bb);
    return (bb.squareMC2ScaleDistTo( vpos, hpos ));
 }
@@ -154,9 +153,8 @@ uint64 MapHashCell::maxSquaredistToBoundingbox( uint32 index, const int32 hpos,
    //return (item->getGfxData()->getMC2BoundingBox()
    //            ->maxMC2ScaleSquareDistTo( vpos, hpos ));
 
-   // TODO: This is just a quick fix. The methods should be implemented in
-   //       the GfxData instead. Static variables are not thread safe...
-   static MC2BoundingBox bb;
+   // Not static, the map may be searched by several threads.
+   MC2BoundingBox bb;
    m_hashTable->getGfxData(item)->getMC2BoundingBox(bb);
    return (bb.maxMC2ScaleSquareDistTo( vpos, hpos ));
 }
@@ -14,15 +14,27 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include "NetPacket.h"
 
 #include "Packet.h"
+#include "TimeUtility.h"
+
 NetPacket::NetPacket( Packet* packet, 
                       const IPnPort& destination,
                       Type type ):
    m_packet( packet ), 
    m_destination( destination ),
-   m_type( type )
+   m_type( type ),
+   m_enqueueTime( TimeUtility::getCurrentTime() )
 {
 } 
 
 NetPacket::~NetPacket() 
 {
 }
+
+void NetPacket::setSendQueueTime()
+{
+   // Replies carry the time of the request back, leave it.
+   if ( m_packet->getTraceFlags() == Packet::TRACE_REQUESTED ) {
+      m_packet->setTraceSendQueueTime( TimeUtility::getCurrentTime() -
+                                       m_enqueueTime );
+   }
+}
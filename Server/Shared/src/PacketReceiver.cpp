@@ -17,13 +17,20 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include "DatagramSocket.h"
 #include "PacketReceiver.h"
 #include "PacketReceiveSocket.h"
+#include "Properties.h"
 #include <stdlib.h>
 
-PacketReceiver::PacketReceiver() {
+PacketReceiver::PacketReceiver():
+   m_pendingSocket( NULL ),
+   m_batchSize( Properties::getUint32Property( "UDP_RECEIVE_BATCH_SIZE",
+                                               16 ) ) {
 }
 
 PacketReceiver::~PacketReceiver() {
    mc2dbg4 << "~PacketReceiver" << endl;
+   for ( uint32 i = 0; i < m_pendingPackets.size(); ++i ) {
+      delete m_pendingPackets[ i ].packet;
+   }
 }
 
 void
@@ -42,6 +49,19 @@ PacketReceiver::addDatagramSocket(DatagramReceiver *sock) {
 void
 PacketReceiver::removeDatagramSocket(DatagramReceiver *sock) {
    m_receiver.removeDatagramSocket( sock );
+   // Drop the packets received on it.
+   std::deque<pendingPacket_t> pending;
+   for ( uint32 i = 0; i < m_pendingPackets.size(); ++i ) {
+      if ( m_pendingPackets[ i ].socket == sock ) {
+         delete m_pendingPackets[ i ].packet;
+      } else {
+         pending.push_back( m_pendingPackets[ i ] );
+      }
+   }
+   m_pendingPackets.swap( pending );
+   if ( m_pendingSocket == sock ) {
+      m_pendingSocket = NULL;
+   }
 }
 
 void
@@ -69,6 +89,9 @@ PacketReceiver::isPermanent(TCPSocket* sock)
 
 void*
 PacketReceiver::getSocketThatReceived() {
+   if ( m_pendingSocket != NULL ) {
+      return m_pendingSocket;
+   }
    return m_receiver.getSocketThatReceived();
 }
 
@@ -90,6 +113,15 @@ PacketReceiver::receiveAndCreatePacket(int32 micros,
    if ( tcpReceiverSock != NULL ) {
       *tcpReceiverSock = NULL;
    }
+
+   // Return the rest of the last batch of datagrams first.
+   m_pendingSocket = NULL;
+   if ( ! m_pendingPackets.empty() ) {
+      Packet* packet = m_pendingPackets.front().packet;
+      m_pendingSocket = m_pendingPackets.front().socket;
+      m_pendingPackets.pop_front();
+      return packet;
+   }
    
    if ( m_receiver.select( micros, tcpSock, datagramSock ) ) {
       if ( tcpSock != NULL ) {
@@ -202,13 +234,18 @@ PacketReceiver::receiveAndCreatePacket(int32 micros,
          }
          
       } else if ( datagramSock != NULL ) {
-         // Create buffer.
-         bufferLength = Packet::MAX_UDP_PACKET_SIZE;
-         buffer = new byte[bufferLength];
-         packetLength = datagramSock->receive(buffer, bufferLength);
-         if (packetLength < 0) {
-            delete [] buffer;
-            buffer = NULL;
+         // Receive the waiting datagrams, return the first one now
+         // and the rest on the following calls.
+         m_batch.clear();
+         datagramSock->receivePackets( m_batch, m_batchSize );
+         for ( uint32 i = 1; i < m_batch.size(); ++i ) {
+            pendingPacket_t pending;
+            pending.packet = m_batch[ i ];
+            pending.socket = datagramSock;
+            m_pendingPackets.push_back( pending );
+         }
+         if ( ! m_batch.empty() ) {
+            return m_batch.front();
          }
       }
    }
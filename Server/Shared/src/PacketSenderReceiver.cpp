@@ -27,6 +27,8 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include "QueuedPacketReceiver.h"
 #include "NetUtility.h"
 #include "DeleteHelpers.h"
+#include "Properties.h"
+#include "IntervalTimer.h"
 
 #include <memory>
 #include <typeinfo>
@@ -74,35 +76,54 @@ handleIO( bool readyRead, bool readyWrite ) {
                                                           m_packetQueue ) );
    }
 }
-// specialization for UDP Socket
-template <>
-void TimedSelectorHelper<DatagramReceiver>::
-handleIO( bool readyRead, bool readyWrite ) 
-{
-   // create receive buffer and receive data to it
-   if ( ! readyRead ) {
-      return;
-   }
 
-   ScopedArray<byte>
-      buffer( new byte[ Packet::MAX_UDP_PACKET_SIZE ] );
+/// Receives the waiting UDP packets in batches into the receive queue.
+class DatagramReceiverHelper: public TimedSelectable {
+public:
+   typedef PacketSenderReceiver::ReceiveQueue ReceiveQueue;
 
-   int size = m_socket.receive( buffer.get(), 
-                                Packet::MAX_UDP_PACKET_SIZE );
-   if ( size < 0 ) {
-      return;
+   DatagramReceiverHelper( DatagramReceiver& socket,
+                           ReceiveQueue& packetQueue ):
+      m_socket( socket ),
+      m_packetQueue( packetQueue ),
+      m_batchSize( Properties::getUint32Property( "UDP_RECEIVE_BATCH_SIZE",
+                                                  16 ) ) {
    }
 
-   Packet* packet = Packet::makePacket( buffer.release(), 
-                                        Packet::MAX_UDP_PACKET_SIZE );
-   packet->setLength( size );
+   selectable getSelectable() const { return m_socket.getSelectable(); }
+   bool wantRead() const { return true; }
+   bool wantWrite() const { return false; }
+   void handleIO( bool readyRead, bool readyWrite ) {
+      if ( ! readyRead ) {
+         return;
+      }
 
-   m_packetQueue.enqueue( packet );
-}
+      m_packets.clear();
+      m_socket.receivePackets( m_packets, m_batchSize );
+      for ( uint32 i = 0; i < m_packets.size(); ++i ) {
+         m_packetQueue.enqueue( m_packets[ i ] );
+      }
+      m_packets.clear();
+   }
+   void handleTimeout() { 
+      mc2dbg2 << "[PacketSenderReceiver]: datagram receiver timed out" << endl;
+      // not used
+      resetTimeout();
+   } 
+private:
+   DatagramReceiver& m_socket;
+   ReceiveQueue& m_packetQueue;
+   /// The max number of packets to receive per system call.
+   uint32 m_batchSize;
+   /// The received packets, kept to save allocations.
+   vector<Packet*> m_packets;
+};
 
 class DatagramSenderHelper: public TimedSelectable {
 public:
-   DatagramSenderHelper() {
+   DatagramSenderHelper():
+      m_batchSize( MAX( Properties::getUint32Property( "UDP_SEND_BATCH_SIZE",
+                                                       16 ), 1u ) ) {
    }
 
    ~DatagramSenderHelper() {
@@ -120,26 +141,49 @@ public:
 
    selectable getSelectable() const { return m_sender.getSelectable(); }
    void handleIO( bool read, bool write ) {
-      if ( write && ! m_sendQueue.empty() ) {
-         auto_ptr<NetPacket> packet( m_sendQueue.front() );
+      if ( ! write || m_sendQueue.empty() ) {
+         return;
+      }
+
+      // Send up to m_batchSize packets with as few calls as possible.
+      STLUtility::AutoContainer< vector<NetPacket*> > packets;
+      vector<const Packet*> batch;
+      vector<IPnPort> destinations;
+      while ( ! m_sendQueue.empty() && packets.size() < m_batchSize ) {
+         packets.push_back( m_sendQueue.front() );
          m_sendQueue.pop();
+         batch.push_back( &packets.back()->getPacket() );
+         destinations.push_back( packets.back()->getDestination() );
+      }
 
-         DebugClock clock;
+      DebugClock clock;
 
-         if ( ! m_sender.
-              send( &packet->getPacket(), packet->getDestination() ) ) {
+      uint32 pos = 0;
+      while ( pos < batch.size() ) {
+         pos += m_sender.sendBatch( &batch[ pos ], &destinations[ pos ],
+                                    batch.size() - pos );
+         if ( pos < batch.size() ) {
+            // Skip the one that failed.
             mc2log << warn << " Failed to send packet ["
-                   << packet->getPacket().getSubTypeAsString()
+                   << batch[ pos ]->getSubTypeAsString()
                    << "] via UDP to destination "
-                   << packet->getDestination() 
+                   << destinations[ pos ]
                    << " error: " << strerror( errno ) << endl;
+            ++pos;
          }
-
-         if ( clock.getTime() > 800 ) {
-            mc2log << warn << "[PSR] Took " << clock << " to send UDP" << endl;
-         } 
       }
+
+      if ( clock.getTime() > 800 ) {
+         mc2log << warn << "[PSR] Took " << clock << " to send "
+                << batch.size() << " UDP" << endl;
+      } 
    }
+
+   /// @return The system call statistics of the sending socket.
+   const DatagramSocket::Statistics& getStatistics() const {
+      return m_sender.getStatistics();
+   }
+
    void handleTimeout() {
       // should never happen
       MC2_ASSERT( false );
@@ -147,6 +191,8 @@ public:
 private:
    queue<NetPacket*> m_sendQueue;
    DatagramSender m_sender;
+   /// The max number of packets to send per system call.
+   uint32 m_batchSize;
 };
 
 typedef SelectableSelector::selSet SelectableSet;
@@ -203,8 +249,8 @@ public:
          // Create helper for datagram receiver
          //
          TimedSelectable* bridge = 
-            new TimedSelectorHelper<DatagramReceiver>( static_cast<DatagramReceiver&>( sel ), 
-                                                       m_selector, m_receiveQueue );
+            new DatagramReceiverHelper( static_cast<DatagramReceiver&>( sel ), 
+                                        m_receiveQueue );
          m_selector.addSelectable( bridge );
          // we are must delete this one, add it to delete container
          m_selectableBridges.push_back( bridge );
@@ -271,6 +317,8 @@ public:
 private:
    void select();
    void dequeueSendPackets();
+   /// Logs the UDP system call statistics at most once a minute.
+   void logStatistics();
    bool sendWithCached( const NetPacket& packet );
 
    void addCache( const IPnPort& addr, MultiPacketSender* sender );
@@ -292,6 +340,8 @@ private:
    IPnPort m_addr;
 
    SelectableSet m_permanent;
+   /// When the UDP statistics are due to be logged.
+   IntervalTimer m_statisticsTimer;
    ISABMonitor m_permMonitor;
    ISABMonitor m_cacheMonitor;
    /**
@@ -400,7 +450,8 @@ WorkThread::WorkThread( PacketSenderReceiver& psr,
    ISABThread( NULL, "PacketSenderReceiver::WorkThread" ),
    m_receiveQueue( psr.getReceiveQueue() ),
    m_sendQueue( psr.getSendQueue() ),
-   m_handler( psr )
+   m_handler( psr ),
+   m_statisticsTimer( 60 )
 {
    m_sendQueue.setSelectNotify( &m_selector.getSelector() );
 
@@ -467,6 +518,7 @@ void WorkThread::run()
       // notify handler that we are done with select/read/write
       m_handler.selectDone();
 
+      logStatistics();
    }
 
    mc2dbg2 << "[PSR] WorkThread is closing." << endl;
@@ -525,6 +577,7 @@ void WorkThread::dequeueSendPackets()
       MC2_ASSERT( *it );
 
       auto_ptr<NetPacket> packet( *it );
+      packet->setSendQueueTime();
 
       mc2dbg4 << "[PSR] sending packet: " << packet->getPacket().getSubTypeAsString()
               << ", destination: " << packet->getDestination() 
@@ -574,6 +627,18 @@ void WorkThread::dequeueSendPackets()
    }
 }
 
+void WorkThread::logStatistics()
+{
+   if ( ! m_statisticsTimer.isDue() ) {
+      return;
+   }
+
+   mc2log << info << "[PSR] UDP receive: " 
+          << m_datagramReceiver->getStatistics() << endl;
+   mc2log << info << "[PSR] UDP send: " 
+          << m_datagramSender.getStatistics() << endl;
+}
+
 bool WorkThread::sendWithCached( const NetPacket& packet ) 
 {
    //
@@ -16,6 +16,7 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include "RouteTrafficCostPacket.h"
 #include "DisturbanceList.h"
 #include "UserRightsMapInfo.h"
+#include "MC2CRC32.h"
 
 #define ROUTETRAFFICCOSTREQUESTPACKET_MAX_LENGTH 65536
 #define ROUTETRAFFICCOSTREQUESTPACKET_PRIO       DEFAULT_PACKET_PRIO
@@ -67,6 +68,12 @@ RouteTrafficCostRequestPacket::getRights( UserRightsMapInfo& rights ) const
    return rights.load( this, pos );
 }
 
+uint32
+RouteTrafficCostRequestPacket::getRightsCRC() const
+{
+   return MC2CRC32::crc32( getBuf() + RIGHTS_POS, getLength() - RIGHTS_POS );
+}
+
 
 int
 RouteTrafficCostReplyPacket::
@@ -138,3 +145,10 @@ getTraffic( DisturbanceVector& resultVect, bool costC ) const
    }
    return size;
 }
+
+uint32
+RouteTrafficCostReplyPacket::getTrafficCRC() const
+{
+   uint32 size = readLong( NBR_TRAFFIC_DATA_POS );
+   return MC2CRC32::crc32( getBuf() + NBR_TRAFFIC_DATA_POS, 4 + size * 8 );
+}
@@ -14,6 +14,6 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include "SubRoute.h"
 
 SubRoute::SubRoute(const OrigDestInfo& origInfo, const OrigDestInfo& destInfo) :
-      m_origInfo(origInfo), m_destInfo(destInfo)
+      m_origInfo(origInfo), m_destInfo(destInfo), m_alternative( 0 )
 {
 }   
@@ -99,11 +99,11 @@ SubRouteRequestPacket::SubRouteRequestPacket(const DriverPref* driverPref,
    if ( reqSize > getBufSize() ) {
       mc2dbg2 << "SubRouteRequestPacket - buffer too small reallocing"
               << endl;
-      byte* temp = MAKE_UINT32_ALIGNED_BYTE_BUFFER( reqSize * 2);
-      memcpy(temp, this->buffer, SUBROUTE_REQUEST_HEADER_SIZE);      
-      delete [] this->buffer;
-      this->buffer = temp;
-      this->bufSize = reqSize * 2;
+      // Keep the whole header when growing the buffer
+      uint32 oldLength = getLength();
+      setLength( SUBROUTE_REQUEST_HEADER_SIZE );
+      resize( reqSize * 2 );
+      setLength( oldLength );
    }
 
    // First request? Won't exactly work all the time...
@@ -394,7 +394,7 @@ void SubRouteReplyPacket::getSubRouteVector( const DriverPref* driverPref,
       const uint32 prevSubRouteID = incReadLong(pos);
       incReadByte(pos); // Complete - not used
       incReadByte(pos); // Forward - Not used
-      incReadShort( pos ); // Skip something
+      const uint16 alternative    = incReadShort( pos );
       const uint32 mapID          = incReadLong(pos);
       
       const int nbrConnections = incReadLong(pos);
@@ -488,6 +488,7 @@ void SubRouteReplyPacket::getSubRouteVector( const DriverPref* driverPref,
          dest.setOffset(float(extConns[j].offset) / float(MAX_UINT16));
          // Create the subroute.
          SubRoute* subRoute = new SubRoute(orig, dest);
+         subRoute->setAlternative( alternative );
          subRoute->reserve(nbrNodes);
          int nbrNodesToAdd = nbrNodes;
          if ( subRoute->hasOneMap() ) {
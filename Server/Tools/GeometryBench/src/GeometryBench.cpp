@@ -0,0 +1,201 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "config.h"
+
+#include "GenericMap.h"
+#include "Item.h"
+#include "GfxData.h"
+#include "GfxUtility.h"
+#include "GeometryKernels.h"
+#include "MC2BoundingBox.h"
+#include "TimeUtility.h"
+
+#include <vector>
+
+/**
+ *   Measures the polygon clipping and point in polygon tests with
+ *   each of the GeometryKernels supported by the cpu.
+ *   The closed polygons of the maps are clipped to a grid of tiles
+ *   covering their bounding boxes and a grid of points inside the
+ *   bounding boxes are tested against them. The results of all the
+ *   kernels are checked to be the same.
+ */
+
+namespace {
+
+/// The number of tiles and test points along each side of a polygon.
+const int32 GRID_SIZE = 8;
+
+/// A polygon from the maps.
+struct polygon_t {
+   /// The gfx data, owned by the map.
+   const GfxData* gfx;
+   /// The bounding box of the polygon.
+   MC2BoundingBox bbox;
+   /// The coordinates as x = lon and y = lat.
+   vector<POINT> points;
+};
+
+/// Adds the first polygon of gfx if it is a closed polygon.
+void addPolygon( const GfxData* gfx, vector<polygon_t>& polygons )
+{
+   if ( gfx == NULL || ! gfx->closed() ||
+        gfx->getNbrPolygons() == 0 || gfx->getNbrCoordinates( 0 ) < 3 ) {
+      return;
+   }
+   polygon_t polygon;
+   polygon.gfx = gfx;
+   gfx->getMC2BoundingBox( polygon.bbox, 0 );
+   for ( GfxData::const_iterator it = gfx->polyBegin( 0 );
+         it != gfx->polyEnd( 0 ); ++it ) {
+      POINT point;
+      point.x = it->lon;
+      point.y = it->lat;
+      polygon.points.push_back( point );
+   }
+   polygons.push_back( polygon );
+}
+
+/// @return The part of the grid at index i, from min to max.
+int32 gridValue( int32 min, int32 max, int32 i )
+{
+   return min + int32( ( int64( max ) - min ) * i / GRID_SIZE );
+}
+
+/// Clips all polygons to the grid, @return The number of output points.
+uint64 clipPolygons( const vector<polygon_t>& polygons )
+{
+   uint64 nbrPoints = 0;
+   vector<POINT> points;
+   for ( uint32 p = 0; p < polygons.size(); ++p ) {
+      const MC2BoundingBox& bbox = polygons[ p ].bbox;
+      for ( int32 y = 0; y < GRID_SIZE; ++y ) {
+         for ( int32 x = 0; x < GRID_SIZE; ++x ) {
+            MC2BoundingBox tile(
+               gridValue( bbox.getMinLat(), bbox.getMaxLat(), y + 1 ),
+               gridValue( bbox.getMinLon(), bbox.getMaxLon(), x ),
+               gridValue( bbox.getMinLat(), bbox.getMaxLat(), y ),
+               gridValue( bbox.getMinLon(), bbox.getMaxLon(), x + 1 ) );
+            points = polygons[ p ].points;
+            if ( GfxUtility::clipPolyToBBoxFast( &tile, points ) ) {
+               nbrPoints += points.size();
+            }
+         }
+      }
+   }
+   return nbrPoints;
+}
+
+/// Tests the grid points against all polygons, @return The sum of results.
+uint64 insidePolygons( const vector<polygon_t>& polygons )
+{
+   uint64 sum = 0;
+   for ( uint32 p = 0; p < polygons.size(); ++p ) {
+      const MC2BoundingBox& bbox = polygons[ p ].bbox;
+      for ( int32 y = 0; y <= GRID_SIZE; ++y ) {
+         for ( int32 x = 0; x <= GRID_SIZE; ++x ) {
+            sum += polygons[ p ].gfx->insidePolygon(
+               gridValue( bbox.getMinLat(), bbox.getMaxLat(), y ),
+               gridValue( bbox.getMinLon(), bbox.getMaxLon(), x ), 0 );
+         }
+      }
+   }
+   return sum;
+}
+
+}
+
+int main( int argc, char* argv[] )
+{
+   if ( argc < 3 ) {
+      cerr << "Usage: " << argv[ 0 ] << " <iterations> <map files>"
+           << endl;
+      return 1;
+   }
+   const uint32 nbrIterations = atoi( argv[ 1 ] );
+
+   vector<GenericMap*> maps;
+   vector<polygon_t> polygons;
+   uint64 nbrCoordinates = 0;
+   for ( int i = 2; i < argc; ++i ) {
+      GenericMap* map = GenericMap::createMap( argv[ i ] );
+      if ( map == NULL ) {
+         cerr << "Could not open " << argv[ i ] << endl;
+         continue;
+      }
+      maps.push_back( map );
+      for ( uint32 zoom = 0; zoom < NUMBER_GFX_ZOOMLEVELS; ++zoom ) {
+         for ( uint32 j = 0; j < map->getNbrItemsWithZoom( zoom ); ++j ) {
+            Item* item = map->getItem( zoom, j );
+            if ( item != NULL ) {
+               addPolygon( item->getGfxData(), polygons );
+            }
+         }
+      }
+   }
+   if ( polygons.empty() ) {
+      cerr << "No polygons found" << endl;
+      return 1;
+   }
+   for ( uint32 p = 0; p < polygons.size(); ++p ) {
+      nbrCoordinates += polygons[ p ].points.size();
+   }
+   cout << polygons.size() << " polygons, " << nbrCoordinates
+        << " coordinates, " << nbrIterations << " iterations" << endl;
+
+   const GeometryKernels::kernel_t kernels[] = {
+      GeometryKernels::SCALAR, GeometryKernels::SSE2, GeometryKernels::AVX2
+   };
+   uint64 scalarClip = 0;
+   uint64 scalarInside = 0;
+   int res = 0;
+   for ( uint32 k = 0; k < NBR_ITEMS( kernels ); ++k ) {
+      const char* name = GeometryKernels::getKernelName( kernels[ k ] );
+      if ( ! GeometryKernels::setKernel( kernels[ k ] ) ) {
+         cout << name << ": not supported" << endl;
+         continue;
+      }
+
+      uint64 clipRes = 0;
+      uint32 startTime = TimeUtility::getCurrentTime();
+      for ( uint32 it = 0; it < nbrIterations; ++it ) {
+         clipRes = clipPolygons( polygons );
+      }
+      const uint32 clipTime = TimeUtility::getCurrentTime() - startTime;
+
+      uint64 insideRes = 0;
+      startTime = TimeUtility::getCurrentTime();
+      for ( uint32 it = 0; it < nbrIterations; ++it ) {
+         insideRes = insidePolygons( polygons );
+      }
+      const uint32 insideTime = TimeUtility::getCurrentTime() - startTime;
+
+      cout << name << ": clip " << clipTime << " ms, inside "
+           << insideTime << " ms" << endl;
+
+      if ( kernels[ k ] == GeometryKernels::SCALAR ) {
+         scalarClip = clipRes;
+         scalarInside = insideRes;
+      } else if ( clipRes != scalarClip || insideRes != scalarInside ) {
+         cerr << name << " gives other results than scalar" << endl;
+         res = 1;
+      }
+   }
+
+   for ( uint32 i = 0; i < maps.size(); ++i ) {
+      delete maps[ i ];
+   }
+   return res;
+}
@@ -0,0 +1,277 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "config.h"
+
+#include "OverlapDetector.h"
+#include "BoundingBoxGrid.h"
+#include "MC2BoundingBox.h"
+#include "TimeUtility.h"
+
+#include <vector>
+#include <algorithm>
+#include <math.h>
+#include <stdlib.h>
+
+/**
+ *   Measures the label collision tests of the text and poi placement
+ *   on a synthetic dense city tile.
+ *   The tile is filled with candidate boxes like the ones the placement
+ *   creates: poi symbols, horizontal texts and the boxes around the
+ *   rotated letters of street names. The candidates are placed greedily,
+ *   first with a scan of all placed boxes as the placement used to do
+ *   and then with the grid of the OverlapDetector. The placement times
+ *   are reported and the placed boxes are checked to be the same.
+ *   Then the obstacles of the street names are collected for a number
+ *   of street polygons, first from a copy of all boxes of the tile and
+ *   then from a grid of the boxes, and the intersections are checked
+ *   to be the same.
+ */
+
+namespace {
+
+/// The side of the tile in pixels.
+const int32 TILE_SIZE = 1024;
+
+/// @return A random value from min to max - 1.
+int32 randomValue( int32 min, int32 max )
+{
+   return min + rand() % ( max - min );
+}
+
+/// @return A box of the given size with its upper left corner at x, y.
+MC2BoundingBox makeBox( int32 x, int32 y, int32 width, int32 height )
+{
+   return MC2BoundingBox( y + height, x, y, x + width );
+}
+
+/// @return The box around a letter rotated angle radians around x, y.
+MC2BoundingBox rotatedLetter( int32 x, int32 y, float64 angle )
+{
+   const float64 corners[ 4 ][ 2 ] = {
+      { 0, 0 }, { 8, 0 }, { 8, 12 }, { 0, 12 }
+   };
+   MC2BoundingBox bbox;
+   for ( uint32 i = 0; i < 4; ++i ) {
+      const float64 cx = corners[ i ][ 0 ] * cos( angle ) -
+         corners[ i ][ 1 ] * sin( angle );
+      const float64 cy = corners[ i ][ 0 ] * sin( angle ) +
+         corners[ i ][ 1 ] * cos( angle );
+      bbox.update( y + int32( rint( cy ) ), x + int32( rint( cx ) ), false );
+   }
+   return bbox;
+}
+
+/// Creates the candidate boxes in the order they would be placed.
+void createCandidates( uint32 nbrCandidates,
+                       vector<MC2BoundingBox>& candidates )
+{
+   for ( uint32 i = 0; i < nbrCandidates; ++i ) {
+      const int32 x = randomValue( 0, TILE_SIZE );
+      const int32 y = randomValue( 0, TILE_SIZE );
+      switch ( i % 3 ) {
+         case 0:
+            // Poi symbol
+            candidates.push_back( makeBox( x, y, 16, 16 ) );
+            break;
+         case 1:
+            // Horizontal text
+            candidates.push_back( makeBox( x, y, randomValue( 30, 120 ),
+                                           12 ) );
+            break;
+         default:
+            // A letter of a street name
+            candidates.push_back( rotatedLetter( x, y, 
+                                                 randomValue( 0, 628 ) /
+                                                 100.0 ) );
+            break;
+      }
+   }
+}
+
+/// Places the candidates testing all placed boxes, @return The placed.
+uint32 placeScan( const vector<MC2BoundingBox>& candidates,
+                  vector<MC2BoundingBox>& placed )
+{
+   placed.clear();
+   for ( uint32 i = 0; i < candidates.size(); ++i ) {
+      bool free = true;
+      for ( uint32 j = 0; j < placed.size() && free; ++j ) {
+         free = ! candidates[ i ].overlaps( placed[ j ] );
+      }
+      if ( free ) {
+         placed.push_back( candidates[ i ] );
+      }
+   }
+   return placed.size();
+}
+
+/// Places the candidates using the OverlapDetector, @return The placed.
+uint32 placeGrid( const vector<MC2BoundingBox>& candidates,
+                  vector<MC2BoundingBox>& placed )
+{
+   OverlapDetector<MC2BoundingBox> detector;
+   for ( uint32 i = 0; i < candidates.size(); ++i ) {
+      detector.addIfNotOverlapping( candidates[ i ] );
+   }
+   detector.getBoxes( placed );
+   return placed.size();
+}
+
+/// Creates the bounding boxes of the street polygons of a tile.
+void createStreets( uint32 nbrStreets, vector<MC2BoundingBox>& streets )
+{
+   for ( uint32 i = 0; i < nbrStreets; ++i ) {
+      const int32 x = randomValue( 0, TILE_SIZE );
+      const int32 y = randomValue( 0, TILE_SIZE );
+      if ( i % 2 == 0 ) {
+         streets.push_back( makeBox( x, y, randomValue( 50, 300 ),
+                                     randomValue( 5, 40 ) ) );
+      } else {
+         streets.push_back( makeBox( x, y, randomValue( 5, 40 ),
+                                     randomValue( 50, 300 ) ) );
+      }
+   }
+}
+
+/// Collects the intersections with each street from a copy of all boxes.
+/// @return The number of intersections.
+uint32 streetsScan( const vector<MC2BoundingBox>& boxes,
+                    const vector<MC2BoundingBox>& streets,
+                    vector<MC2BoundingBox>& intersected )
+{
+   intersected.clear();
+   MC2BoundingBox interSection;
+   for ( uint32 i = 0; i < streets.size(); ++i ) {
+      vector<MC2BoundingBox> obstacles( boxes );
+      for ( uint32 j = 0; j < obstacles.size(); ++j ) {
+         if ( obstacles[ j ].getInterSection( streets[ i ], interSection ) ) {
+            intersected.push_back( interSection );
+         }
+      }
+   }
+   return intersected.size();
+}
+
+/// Collects the intersections with each street from the boxes found
+/// in a grid, building the grid included. @return The number of
+/// intersections.
+uint32 streetsGrid( const vector<MC2BoundingBox>& boxes,
+                    const vector<MC2BoundingBox>& streets,
+                    vector<MC2BoundingBox>& intersected )
+{
+   intersected.clear();
+   BoundingBoxGrid grid;
+   for ( uint32 i = 0; i < boxes.size(); ++i ) {
+      grid.add( boxes[ i ], i );
+   }
+   MC2BoundingBox interSection;
+   vector<uint32> indices;
+   for ( uint32 i = 0; i < streets.size(); ++i ) {
+      indices.clear();
+      grid.getOverlapping( streets[ i ], indices );
+      // Same order as the scan
+      std::sort( indices.begin(), indices.end() );
+      vector<MC2BoundingBox> obstacles;
+      obstacles.reserve( indices.size() );
+      for ( uint32 j = 0; j < indices.size(); ++j ) {
+         obstacles.push_back( boxes[ indices[ j ] ] );
+      }
+      for ( uint32 j = 0; j < obstacles.size(); ++j ) {
+         if ( obstacles[ j ].getInterSection( streets[ i ], interSection ) ) {
+            intersected.push_back( interSection );
+         }
+      }
+   }
+   return intersected.size();
+}
+
+}
+
+int main( int argc, char* argv[] )
+{
+   if ( argc < 3 ) {
+      cerr << "Usage: " << argv[ 0 ] << " <iterations> <candidates per tile>"
+           << endl;
+      return 1;
+   }
+   const uint32 nbrIterations = atoi( argv[ 1 ] );
+   const uint32 nbrCandidates = atoi( argv[ 2 ] );
+
+   srand( 4711 );
+   vector< vector<MC2BoundingBox> > tiles( MAX( nbrIterations, 1u ) );
+   for ( uint32 i = 0; i < tiles.size(); ++i ) {
+      createCandidates( nbrCandidates, tiles[ i ] );
+   }
+
+   vector<MC2BoundingBox> scanPlaced;
+   uint64 nbrScanPlaced = 0;
+   uint32 startTime = TimeUtility::getCurrentTime();
+   for ( uint32 i = 0; i < nbrIterations; ++i ) {
+      nbrScanPlaced += placeScan( tiles[ i ], scanPlaced );
+   }
+   const uint32 scanTime = TimeUtility::getCurrentTime() - startTime;
+
+   vector<MC2BoundingBox> gridPlaced;
+   uint64 nbrGridPlaced = 0;
+   startTime = TimeUtility::getCurrentTime();
+   for ( uint32 i = 0; i < nbrIterations; ++i ) {
+      nbrGridPlaced += placeGrid( tiles[ i ], gridPlaced );
+   }
+   const uint32 gridTime = TimeUtility::getCurrentTime() - startTime;
+
+   // One street per ten candidates, the obstacles are all candidates.
+   vector< vector<MC2BoundingBox> > streets( tiles.size() );
+   for ( uint32 i = 0; i < streets.size(); ++i ) {
+      createStreets( nbrCandidates / 10 + 1, streets[ i ] );
+   }
+
+   vector<MC2BoundingBox> scanIntersected;
+   uint64 nbrScanIntersected = 0;
+   startTime = TimeUtility::getCurrentTime();
+   for ( uint32 i = 0; i < nbrIterations; ++i ) {
+      nbrScanIntersected += streetsScan( tiles[ i ], streets[ i ],
+                                         scanIntersected );
+   }
+   const uint32 streetScanTime = TimeUtility::getCurrentTime() - startTime;
+
+   vector<MC2BoundingBox> gridIntersected;
+   uint64 nbrGridIntersected = 0;
+   startTime = TimeUtility::getCurrentTime();
+   for ( uint32 i = 0; i < nbrIterations; ++i ) {
+      nbrGridIntersected += streetsGrid( tiles[ i ], streets[ i ],
+                                         gridIntersected );
+   }
+   const uint32 streetGridTime = TimeUtility::getCurrentTime() - startTime;
+
+   cout << nbrIterations << " tiles, " << nbrCandidates 
+        << " candidates per tile, " << nbrScanPlaced << " placed" << endl;
+   cout << "scan: " << scanTime << " ms" << endl;
+   cout << "grid: " << gridTime << " ms" << endl;
+   cout << streets[ 0 ].size() << " streets per tile, "
+        << nbrScanIntersected << " intersections" << endl;
+   cout << "street scan: " << streetScanTime << " ms" << endl;
+   cout << "street grid: " << streetGridTime << " ms" << endl;
+
+   if ( nbrScanPlaced != nbrGridPlaced ||
+        ( nbrIterations > 0 && scanPlaced != gridPlaced ) ) {
+      cerr << "The grid places other boxes than the scan" << endl;
+      return 1;
+   }
+   if ( nbrScanIntersected != nbrGridIntersected ||
+        ( nbrIterations > 0 && scanIntersected != gridIntersected ) ) {
+      cerr << "The grid finds other street obstacles than the scan" << endl;
+      return 1;
+   }
+   return 0;
+}
@@ -0,0 +1,171 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "config.h"
+
+#include "TileMap.h"
+#include "TileMapParams.h"
+#include "ServerTileMapFormatDesc.h"
+#include "BitBuffer.h"
+#include "GunzipUtil.h"
+#include "TimeUtility.h"
+
+#include <fstream>
+#include <vector>
+#include <string>
+
+/**
+ *   Measures how fast tile maps are decoded and encoded.
+ *   The files should contain tile maps as sent by the TileModule,
+ *   gzipped or not, and be named after their parameter strings.
+ *   Each map is decoded with TileMap::load and encoded with
+ *   TileMap::save the given number of times and the speed is
+ *   reported in MB of unzipped tile map per second.
+ */
+
+namespace {
+
+/// A tile map from the corpus.
+struct tileMapFile_t {
+   /// The parameter string, from the file name.
+   MC2SimpleString param;
+   /// The unzipped tile map.
+   vector<byte> data;
+};
+
+bool readTileMap( const char* fileName, tileMapFile_t& tileMap )
+{
+   ifstream file( fileName, ios::in | ios::binary );
+   if ( ! file ) {
+      cerr << "Could not open " << fileName << endl;
+      return false;
+   }
+   vector<byte> data;
+   char buf[ 4096 ];
+   while ( file.read( buf, sizeof( buf ) ) || file.gcount() > 0 ) {
+      data.insert( data.end(), buf, buf + file.gcount() );
+   }
+   if ( data.size() < 2 ) {
+      cerr << fileName << " is too small" << endl;
+      return false;
+   }
+
+   // Unzip once here so that only the bit coding is measured.
+   if ( GunzipUtil::isGzip( &data.front() ) ) {
+      int origLength = GunzipUtil::origLength( &data.front(), data.size() );
+      if ( origLength <= 0 ) {
+         cerr << "Could not unzip " << fileName << endl;
+         return false;
+      }
+      tileMap.data.resize( origLength );
+      if ( GunzipUtil::gunzip( &tileMap.data.front(), origLength,
+                               &data.front(), data.size() ) < 0 ) {
+         cerr << "Could not unzip " << fileName << endl;
+         return false;
+      }
+   } else {
+      tileMap.data.swap( data );
+   }
+
+   string param( fileName );
+   string::size_type slash = param.rfind( '/' );
+   if ( slash != string::npos ) {
+      param.erase( 0, slash + 1 );
+   }
+   tileMap.param = param.c_str();
+   return true;
+}
+
+float64 mbPerSec( uint64 nbrBytes, uint32 timeMs )
+{
+   if ( timeMs == 0 ) {
+      timeMs = 1;
+   }
+   return float64( nbrBytes ) / ( 1024.0 * 1024.0 ) / ( timeMs / 1000.0 );
+}
+
+}
+
+int main( int argc, char* argv[] )
+{
+   if ( argc < 3 ) {
+      cerr << "Usage: " << argv[ 0 ] << " <iterations> <tilemap files>"
+           << endl;
+      return 1;
+   }
+   const uint32 nbrIterations = atoi( argv[ 1 ] );
+
+   STMFDParams stmfdParam;
+   ServerTileMapFormatDesc desc( stmfdParam );
+   desc.setData();
+
+   vector<tileMapFile_t> corpus;
+   uint64 corpusSize = 0;
+   for ( int i = 2; i < argc; ++i ) {
+      tileMapFile_t tileMap;
+      if ( readTileMap( argv[ i ], tileMap ) ) {
+         corpusSize += tileMap.data.size();
+         corpus.push_back( tileMap );
+      }
+   }
+   if ( corpus.empty() ) {
+      return 1;
+   }
+
+   // Decode once to get the maps to encode and the size of the output.
+   vector<TileMap*> maps;
+   for ( uint32 i = 0; i < corpus.size(); ++i ) {
+      BitBuffer buf( &corpus[ i ].data.front(), corpus[ i ].data.size() );
+      TileMap* tileMap = new TileMap;
+      if ( ! tileMap->load( buf, desc, corpus[ i ].param ) ) {
+         cerr << "Could not load " << corpus[ i ].param << endl;
+      }
+      maps.push_back( tileMap );
+   }
+
+   uint32 startTime = TimeUtility::getCurrentTime();
+   for ( uint32 it = 0; it < nbrIterations; ++it ) {
+      for ( uint32 i = 0; i < corpus.size(); ++i ) {
+         BitBuffer buf( &corpus[ i ].data.front(), corpus[ i ].data.size() );
+         TileMap tileMap;
+         tileMap.load( buf, desc, corpus[ i ].param );
+      }
+   }
+   const uint32 decodeTime = TimeUtility::getCurrentTime() - startTime;
+
+   uint64 encodedSize = 0;
+   startTime = TimeUtility::getCurrentTime();
+   for ( uint32 it = 0; it < nbrIterations; ++it ) {
+      for ( uint32 i = 0; i < maps.size(); ++i ) {
+         // Room for the map, saving may grow it a bit.
+         BitBuffer buf( corpus[ i ].data.size() * 2 + 1024 );
+         maps[ i ]->save( buf );
+         encodedSize += buf.getCurrentOffset();
+      }
+   }
+   const uint32 encodeTime = TimeUtility::getCurrentTime() - startTime;
+
+   cout << corpus.size() << " tile maps, " << corpusSize << " bytes, "
+        << nbrIterations << " iterations" << endl;
+   cout << "Decode: " << decodeTime << " ms, "
+        << mbPerSec( corpusSize * nbrIterations, decodeTime ) << " MB/s"
+        << endl;
+   cout << "Encode: " << encodeTime << " ms, "
+        << mbPerSec( encodedSize, encodeTime ) << " MB/s" << endl;
+
+   for ( uint32 i = 0; i < maps.size(); ++i ) {
+      delete maps[ i ];
+   }
+   return 0;
+}
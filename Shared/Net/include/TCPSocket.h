@@ -358,6 +358,22 @@ class TCPSocket : public Socket, public Writeable, public Readable,
        */
       virtual ssize_t writeAll(const byte *buffer, size_t length);
 
+
+      /**
+       *    Writes a part of a file to the socket. On Linux the data is
+       *    not copied through user space. The data is written directly
+       *    to the socket, so it must not be used on sockets that change
+       *    the data in write, like SSLSocket.
+       *
+       *    @param   fd       The file to send from.
+       *    @param   offset   The position in the file, moved forward by
+       *                      the number of bytes written.
+       *    @param   length   The maximum number of bytes to write.
+       *    @return  The number of successfully written bytes or -1
+       *             upon failure, 0 on closed socket and -3 on EAGAIN.
+       */
+      ssize_t sendFile( int fd, off_t& offset, size_t length );
+
       /**
        *    Accept a connection. 
        *    @return  A TCPSocket that is connected to a socket at the 
@@ -24,6 +24,10 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
    #include <stdlib.h>
 #endif
 
+#ifdef __linux
+   #include <sys/sendfile.h>
+#endif
+
 #ifdef __CYGWIN__
 #define getdtablesize() (howmany(FD_SETSIZE, NFDBITS))
 #endif
@@ -988,6 +992,50 @@ TCPSocket::write( const byte *buffer, size_t length,
 }
 
 
+ssize_t
+TCPSocket::sendFile( int fd, off_t& offset, size_t length ) {
+   if ( m_sock == 0 ) {
+      mc2log << error << "TCPSocket::sendFile - m_sock == 0" << endl;
+      return -1;
+   }
+
+   SysUtility::ignorePipe();
+
+#ifdef __linux
+   ssize_t writeLength;
+   do {
+      writeLength = ::sendfile( m_sock, fd, &offset, length );
+   } while ( writeLength < 0 && errno == EINTR );
+#else
+   // Through a buffer on the other platforms.
+   byte buffer[ 65536 ];
+   ssize_t writeLength = -1;
+   if ( lseek( fd, offset, SEEK_SET ) == offset ) {
+      ssize_t readLength = ::read( fd, buffer, MIN( length, 
+                                                    sizeof( buffer ) ) );
+      if ( readLength > 0 ) {
+         writeLength = protectedWrite( buffer, readLength );
+         if ( writeLength > 0 ) {
+            offset += writeLength;
+         }
+      }
+   }
+#endif
+
+   SysUtility::setPipeDefault();
+
+   if ( writeLength < 0 ) {
+      if ( errno == EPIPE ) { // Closed
+         writeLength = 0;
+      } else if ( errno == EAGAIN ) { // try again later, select first
+         writeLength = -3;
+      } // Else leave it as -1
+   }
+
+   return writeLength;
+}
+
+
 ssize_t
 TCPSocket::writeAll( const byte *buffer,
                      size_t length  )
@@ -111,10 +111,10 @@ int main( int argc, char** argv ) {
    ScopedArray<uint8> dataOrg( new uint8[ dataSize ] );
    ScopedArray<uint8> dataNew( new uint8[ dataSize ] );
 
-   // clear data
+   // Fill with the same random data to check that the bits
+   // around the written ones are kept.
    for ( uint32 i = 0; i < dataSize; ++i ) {
-      dataNew[ i ] = 0;
-      dataOrg[ i ] = 0;
+      dataNew[ i ] = dataOrg[ i ] = rand();
    }
 
    ReferenceImp::BitBuffer buf( dataOrg.get(), dataSize );
@@ -188,7 +188,7 @@ int main( int argc, char** argv ) {
    }
    // read the final bits
    while ( buf.getCurrentBitOffset() < MAX_BITS ) {
-      BitBuffer::SizeType bits = MAX_BITS - buf.getCurrentBitOffset();
+      uint32 bits = MAX_BITS - buf.getCurrentBitOffset();
       if ( bits > 32 ) {
          bits = 32;
       }
@@ -0,0 +1,142 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "MC2UnitTestMain.h"
+
+#include "BoundingBoxGrid.h"
+#include "OverlapDetector.h"
+#include "MC2BoundingBox.h"
+
+#include <algorithm>
+#include <stdlib.h>
+
+namespace {
+
+/// @return A random box of at most maxSize around the area.
+MC2BoundingBox randomBox( int32 area, int32 maxSize ) {
+   int32 lat = rand() % area - area / 2;
+   int32 lon = rand() % area - area / 2;
+   return MC2BoundingBox( lat + rand() % maxSize, lon,
+                          lat, lon + rand() % maxSize );
+}
+
+/// @return The indices of the boxes overlapping bbox, borders included.
+std::vector<uint32> bruteForce( const std::vector<MC2BoundingBox>& boxes,
+                                const MC2BoundingBox& bbox ) {
+   std::vector<uint32> expected;
+   for ( uint32 i = 0; i < boxes.size(); ++i ) {
+      if ( boxes[ i ].getMaxLat() >= bbox.getMinLat() &&
+           boxes[ i ].getMinLat() <= bbox.getMaxLat() &&
+           boxes[ i ].getMaxLon() >= bbox.getMinLon() &&
+           boxes[ i ].getMinLon() <= bbox.getMaxLon() ) {
+         expected.push_back( i );
+      }
+   }
+   return expected;
+}
+
+}
+
+MC2_UNIT_TEST_FUNCTION( emptyGridTest ) {
+   BoundingBoxGrid grid;
+   std::vector<uint32> values;
+   grid.getOverlapping( MC2BoundingBox( 10, 0, 0, 10 ), values );
+   MC2_TEST_CHECK( values.empty() );
+   MC2_TEST_CHECK( grid.size() == 0 );
+   MC2_TEST_CHECK( grid.getCellSize() == 0 );
+}
+
+MC2_UNIT_TEST_FUNCTION( bruteForceTest ) {
+   srand( 4711 );
+   // Mostly small boxes with a few larger than the cells.
+   std::vector<MC2BoundingBox> boxes;
+   BoundingBoxGrid grid( 1000 );
+   for ( uint32 i = 0; i < 2000; ++i ) {
+      boxes.push_back( randomBox( 100000, i % 50 == 0 ? 30000 : 1000 ) );
+      grid.add( boxes.back(), i );
+
+      if ( i % 10 == 0 ) {
+         MC2BoundingBox bbox = randomBox( 110000, i % 30 == 0 ? 50000 : 2000 );
+         std::vector<uint32> values;
+         grid.getOverlapping( bbox, values );
+         std::sort( values.begin(), values.end() );
+         MC2_TEST_CHECK( values == bruteForce( boxes, bbox ) );
+      }
+   }
+   MC2_TEST_CHECK( grid.size() == boxes.size() );
+
+   grid.clear();
+   MC2_TEST_CHECK( grid.size() == 0 );
+   MC2_TEST_CHECK( grid.getCellSize() == 1000 );
+   std::vector<uint32> values;
+   grid.getOverlapping( boxes.front(), values );
+   MC2_TEST_CHECK( values.empty() );
+}
+
+MC2_UNIT_TEST_FUNCTION( dateLineTest ) {
+   BoundingBoxGrid grid;
+   grid.add( MC2BoundingBox( 100, 0, 0, 100 ), 0 );
+   MC2_TEST_CHECK( grid.getCellSize() == 200 );
+   // Crossing the date line, always found.
+   grid.add( MC2BoundingBox( 100, MAX_INT32 - 100, 0, MIN_INT32 + 100 ), 1 );
+
+   std::vector<uint32> values;
+   grid.getOverlapping( MC2BoundingBox( 50, 50, 0, 60 ), values );
+   std::sort( values.begin(), values.end() );
+   MC2_TEST_REQUIRED( values.size() == 2 );
+   MC2_TEST_CHECK( values[ 0 ] == 0 && values[ 1 ] == 1 );
+
+   // A search crossing the date line finds everything.
+   values.clear();
+   grid.getOverlapping( MC2BoundingBox( 10, MAX_INT32 - 10, 0, 
+                                        MIN_INT32 + 10 ), values );
+   MC2_TEST_CHECK( values.size() == 2 );
+}
+
+MC2_UNIT_TEST_FUNCTION( overlapDetectorTest ) {
+   srand( 17 );
+   OverlapDetector<MC2BoundingBox> detector;
+   std::vector<MC2BoundingBox> added;
+   for ( uint32 i = 0; i < 3000; ++i ) {
+      MC2BoundingBox bbox = randomBox( 200000, 3000 );
+      bool expected = true;
+      for ( uint32 j = 0; j < added.size(); ++j ) {
+         if ( bbox.overlaps( added[ j ] ) ) {
+            expected = false;
+            break;
+         }
+      }
+      MC2_TEST_CHECK( detector.addIfNotOverlapping( bbox ) == expected );
+      if ( expected ) {
+         added.push_back( bbox );
+      }
+   }
+
+   // The boxes come back in the order they were added.
+   std::vector<MC2BoundingBox> boxes;
+   detector.getBoxes( boxes );
+   MC2_TEST_CHECK( boxes == added );
+
+   // All or none.
+   std::vector<MC2BoundingBox> group;
+   group.push_back( MC2BoundingBox( 1000010, 1000000, 1000000, 1000010 ) );
+   group.push_back( added.front() );
+   MC2_TEST_CHECK( ! detector.addIfNotOverlapping( group ) );
+   group.pop_back();
+   MC2_TEST_CHECK( detector.addIfNotOverlapping( group ) );
+   detector.getBoxes( boxes );
+   MC2_TEST_CHECK( boxes.size() == added.size() + 1 );
+
+   detector.clear();
+   MC2_TEST_CHECK( detector.addIfNotOverlapping( added.front() ) );
+}
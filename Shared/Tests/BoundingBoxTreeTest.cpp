@@ -0,0 +1,74 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "MC2UnitTestMain.h"
+
+#include "BoundingBoxTree.h"
+#include "MC2BoundingBox.h"
+
+#include <algorithm>
+#include <stdlib.h>
+
+MC2_UNIT_TEST_FUNCTION( emptyTreeTest ) {
+   BoundingBoxTree tree;
+   tree.build();
+   std::vector<uint32> values;
+   tree.getContaining( 0, 0, values );
+   MC2_TEST_CHECK( values.empty() );
+   MC2_TEST_CHECK( tree.size() == 0 );
+}
+
+MC2_UNIT_TEST_FUNCTION( bruteForceTest ) {
+   srand( 4711 );
+   std::vector<MC2BoundingBox> boxes;
+   BoundingBoxTree tree;
+   for ( uint32 i = 0; i < 1000; ++i ) {
+      int32 lat = rand() % 100000 - 50000;
+      int32 lon = rand() % 100000 - 50000;
+      MC2BoundingBox bbox( lat + rand() % 5000, lon,
+                           lat, lon + rand() % 5000 );
+      boxes.push_back( bbox );
+      tree.add( bbox, i );
+   }
+   tree.build();
+   MC2_TEST_CHECK( tree.size() == boxes.size() );
+
+   for ( uint32 q = 0; q < 200; ++q ) {
+      int32 lat = rand() % 110000 - 55000;
+      int32 lon = rand() % 110000 - 55000;
+      std::vector<uint32> values;
+      tree.getContaining( lat, lon, values );
+      std::sort( values.begin(), values.end() );
+
+      std::vector<uint32> expected;
+      for ( uint32 i = 0; i < boxes.size(); ++i ) {
+         if ( boxes[ i ].contains( lat, lon ) ) {
+            expected.push_back( i );
+         }
+      }
+      MC2_TEST_CHECK( values == expected );
+
+      MC2BoundingBox search( lat + 2000, lon, lat, lon + 2000 );
+      values.clear();
+      tree.getOverlapping( search, values );
+      std::sort( values.begin(), values.end() );
+      expected.clear();
+      for ( uint32 i = 0; i < boxes.size(); ++i ) {
+         if ( boxes[ i ].overlaps( search ) ) {
+            expected.push_back( i );
+         }
+      }
+      MC2_TEST_CHECK( values == expected );
+   }
+}
@@ -0,0 +1,190 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "MC2UnitTestMain.h"
+
+#include "GeometryKernels.h"
+#include "MC2BoundingBox.h"
+#include "ClipUtil.h"
+
+#include <stdlib.h>
+
+using namespace GeometryKernels;
+
+namespace {
+
+/// The bounding box used in the tests.
+MC2BoundingBox testBBox() {
+   return MC2BoundingBox( 1000, -1000, -1000, 1000 );
+}
+
+/// Random coordinates around the test bounding box, some of them exactly
+/// on the borders.
+vector<int32> randomCoords( uint32 nbr ) {
+   vector<int32> coords;
+   for ( uint32 i = 0; i < 2 * nbr; ++i ) {
+      switch ( rand() % 4 ) {
+         case 0:
+            coords.push_back( rand() % 2 ? 1000 : -1000 );
+            break;
+         case 1:
+            coords.push_back( rand() % 4001 - 2000 );
+            break;
+         default:
+            coords.push_back( rand() % 2001 - 1000 );
+            break;
+      }
+   }
+   return coords;
+}
+
+/// @return The kernels supported by this cpu.
+vector<kernel_t> supportedKernels() {
+   vector<kernel_t> kernels;
+   const kernel_t all[] = { SCALAR, SSE2, AVX2 };
+   kernel_t old = getKernel();
+   for ( uint32 i = 0; i < NBR_ITEMS( all ); ++i ) {
+      if ( setKernel( all[ i ] ) ) {
+         kernels.push_back( all[ i ] );
+      }
+   }
+   setKernel( old );
+   return kernels;
+}
+
+}
+
+MC2_UNIT_TEST_FUNCTION( kernelSelectionTest ) {
+   MC2_TEST_CHECK( setKernel( SCALAR ) );
+   MC2_TEST_CHECK( getKernel() == SCALAR );
+   MC2_TEST_CHECK( MC2String( getKernelName( SCALAR ) ) == "scalar" );
+   MC2_TEST_CHECK( supportedKernels().front() == SCALAR );
+}
+
+MC2_UNIT_TEST_FUNCTION( outcodesTest ) {
+   MC2BoundingBox bbox = testBBox();
+   vector<kernel_t> kernels = supportedKernels();
+   for ( uint32 nbr = 0; nbr < 70; ++nbr ) {
+      vector<int32> coords = randomCoords( nbr );
+      for ( uint32 o = 0; o < 2; ++o ) {
+         order_t order = order_t( o );
+         vector<byte> expected( nbr + 1 );
+         byte expOr = 0;
+         byte expAnd = 0xff;
+         for ( uint32 i = 0; i < nbr; ++i ) {
+            int32 lat = coords[ 2 * i + ( order == LAT_LON ? 0 : 1 ) ];
+            int32 lon = coords[ 2 * i + ( order == LAT_LON ? 1 : 0 ) ];
+            expected[ i ] = bbox.getCohenSutherlandOutcode( lat, lon );
+            expOr |= expected[ i ];
+            expAnd &= expected[ i ];
+         }
+         if ( nbr == 0 ) {
+            expAnd = 0;
+         }
+         for ( uint32 k = 0; k < kernels.size(); ++k ) {
+            setKernel( kernels[ k ] );
+            vector<byte> outcodes( nbr + 1 );
+            byte orCodes = 0xff;
+            byte andCodes = 0xff;
+            computeOutcodes( bbox, coords.empty() ? NULL : &coords[ 0 ],
+                             nbr, order, &outcodes[ 0 ], orCodes, andCodes );
+            MC2_TEST_CHECK( outcodes == expected );
+            MC2_TEST_CHECK( orCodes == expOr );
+            MC2_TEST_CHECK( andCodes == expAnd );
+            MC2_TEST_CHECK( orBytes( &outcodes[ 0 ], nbr ) == expOr );
+         }
+      }
+   }
+   setKernel( kernels.back() );
+}
+
+MC2_UNIT_TEST_FUNCTION( latCrossingTest ) {
+   vector<kernel_t> kernels = supportedKernels();
+   for ( uint32 nbr = 1; nbr < 70; ++nbr ) {
+      vector<int32> coords = randomCoords( nbr );
+      for ( uint32 begin = 1; begin <= nbr; ++begin ) {
+         int32 lat = rand() % 2001 - 1000;
+         uint32 expected = begin;
+         for ( ; expected < nbr; ++expected ) {
+            int32 d1 = coords[ 2 * ( expected - 1 ) ] - lat;
+            int32 d2 = coords[ 2 * expected ] - lat;
+            if ( ( d1 <= 0 && d2 >= 0 ) || ( d1 >= 0 && d2 <= 0 ) ) {
+               break;
+            }
+         }
+         for ( uint32 k = 0; k < kernels.size(); ++k ) {
+            setKernel( kernels[ k ] );
+            MC2_TEST_CHECK( findLatCrossing( &coords[ 0 ], begin, nbr,
+                                             LAT_LON, lat ) == expected );
+         }
+      }
+   }
+   setKernel( kernels.back() );
+}
+
+MC2_UNIT_TEST_FUNCTION( clipTest ) {
+   MC2BoundingBox bbox = testBBox();
+
+   // Completely inside, four boundaries rotate the polygon four steps.
+   vector<MC2Coordinate> inside;
+   for ( int32 i = 0; i < 6; ++i ) {
+      inside.push_back( MC2Coordinate( -i * 100, i * 100 ) );
+   }
+   vector<MC2Coordinate> clipped;
+   MC2_TEST_CHECK( ClipUtil::clipPolyToBBoxFast( bbox, clipped,
+                                                 inside.begin(),
+                                                 inside.end() ) );
+   MC2_TEST_REQUIRED( clipped.size() == inside.size() );
+   for ( uint32 i = 0; i < inside.size(); ++i ) {
+      MC2_TEST_CHECK( clipped[ i ] == inside[ ( i + 4 ) % inside.size() ] );
+   }
+
+   // Completely outside.
+   vector<MC2Coordinate> outside;
+   outside.push_back( MC2Coordinate( 2000, 0 ) );
+   outside.push_back( MC2Coordinate( 3000, 500 ) );
+   outside.push_back( MC2Coordinate( 3000, -500 ) );
+   MC2_TEST_CHECK( ! ClipUtil::clipPolyToBBoxFast( bbox, clipped,
+                                                   outside.begin(),
+                                                   outside.end() ) );
+
+   // Partly inside, all kernels must give the same result.
+   vector<kernel_t> kernels = supportedKernels();
+   for ( uint32 n = 0; n < 50; ++n ) {
+      vector<int32> coords = randomCoords( 3 + n );
+      vector<MC2Coordinate> poly;
+      for ( uint32 i = 0; i + 1 < coords.size(); i += 2 ) {
+         poly.push_back( MC2Coordinate( coords[ i ] * 2,
+                                        coords[ i + 1 ] * 2 ) );
+      }
+      setKernel( SCALAR );
+      vector<MC2Coordinate> expected;
+      int expectedRes = ClipUtil::clipPolyToBBoxFast( bbox, expected,
+                                                      poly.begin(),
+                                                      poly.end() );
+      for ( uint32 i = 0; expectedRes && i < expected.size(); ++i ) {
+         MC2_TEST_CHECK( bbox.contains( expected[ i ] ) );
+      }
+      for ( uint32 k = 1; k < kernels.size(); ++k ) {
+         setKernel( kernels[ k ] );
+         vector<MC2Coordinate> res;
+         MC2_TEST_CHECK( ClipUtil::clipPolyToBBoxFast( bbox, res,
+                                                       poly.begin(),
+                                                       poly.end() ) ==
+                         expectedRes );
+         MC2_TEST_CHECK( res == expected );
+      }
+   }
+   setKernel( kernels.back() );
+}
@@ -0,0 +1,119 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "MC2UnitTestMain.h"
+
+#include "LatencyStatistics.h"
+#include "Packet.h"
+
+#include <sstream>
+
+MC2_UNIT_TEST_FUNCTION( bucketTest ) {
+   typedef LatencyStatistics::Histogram Histogram;
+   MC2_TEST_CHECK( Histogram::getBucketIndex( 0 ) == 0 );
+   MC2_TEST_CHECK( Histogram::getBucketIndex( 1 ) == 1 );
+   MC2_TEST_CHECK( Histogram::getBucketIndex( 2 ) == 2 );
+   MC2_TEST_CHECK( Histogram::getBucketIndex( 3 ) == 2 );
+   MC2_TEST_CHECK( Histogram::getBucketIndex( 1000 ) == 10 );
+   MC2_TEST_CHECK( Histogram::getBucketIndex( MAX_UINT32 ) ==
+                   Histogram::NBR_BUCKETS - 1 );
+}
+
+MC2_UNIT_TEST_FUNCTION( percentileTest ) {
+   LatencyStatistics::Histogram hist;
+   MC2_TEST_CHECK( hist.getPercentile( 0.5 ) == 0 );
+   MC2_TEST_CHECK( hist.getMean() == 0 );
+
+   // 90 fast and 10 slow.
+   for ( uint32 i = 0; i < 90; ++i ) {
+      hist.add( 5 );
+   }
+   for ( uint32 i = 0; i < 10; ++i ) {
+      hist.add( 300 );
+   }
+   MC2_TEST_CHECK( hist.getCount() == 100 );
+   MC2_TEST_CHECK( hist.getMax() == 300 );
+   MC2_TEST_CHECK( hist.getMean() == 34 );
+   MC2_TEST_CHECK( hist.getPercentile( 0.5 ) == 7 );
+   MC2_TEST_CHECK( hist.getPercentile( 0.9 ) == 7 );
+   // The upper limit of the bucket is capped by the max.
+   MC2_TEST_CHECK( hist.getPercentile( 0.99 ) == 300 );
+   MC2_TEST_CHECK( hist.getBucket( 3 ) == 90 );
+   MC2_TEST_CHECK( hist.getBucket( 9 ) == 10 );
+}
+
+MC2_UNIT_TEST_FUNCTION( statisticsTest ) {
+   LatencyStatistics stats( 0 );
+   stats.add( Packet::PACKETTYPE_EXPANDROUTEREQUEST,
+              LatencyStatistics::PROCESSING, 100 );
+   stats.add( Packet::PACKETTYPE_EXPANDROUTEREQUEST,
+              LatencyStatistics::MODULE_QUEUE, 2 );
+   stats.add( Packet::PACKETTYPE_EXPANDROUTEREQUEST,
+              LatencyStatistics::MODULE_QUEUE, 4 );
+
+   LatencyStatistics::StatisticsMap copy = stats.getStatistics();
+   MC2_TEST_REQUIRED( copy.size() == 1 );
+   const LatencyStatistics::TypeStatistics& route =
+      copy[ Packet::PACKETTYPE_EXPANDROUTEREQUEST ];
+   MC2_TEST_CHECK( route.stages[ LatencyStatistics::PROCESSING ].
+                   getCount() == 1 );
+   MC2_TEST_CHECK( route.stages[ LatencyStatistics::MODULE_QUEUE ].
+                   getCount() == 2 );
+   MC2_TEST_CHECK( route.stages[ LatencyStatistics::NETWORK ].
+                   getCount() == 0 );
+
+   std::ostringstream str;
+   stats.print( str );
+   MC2_TEST_CHECK( str.str().find( "module queue n 2" ) !=
+                   MC2String::npos );
+   MC2_TEST_CHECK( str.str().find( "network" ) == MC2String::npos );
+
+   stats.clear();
+   MC2_TEST_CHECK( stats.getStatistics().empty() );
+}
+
+MC2_UNIT_TEST_FUNCTION( traceTimeTest ) {
+   // Exact for small times.
+   for ( uint32 i = 0; i < 32; ++i ) {
+      MC2_TEST_CHECK( Packet::decodeTraceTime(
+                         Packet::encodeTraceTime( i ) ) == i );
+   }
+   // Within 1/16 and never above for larger ones.
+   for ( uint32 t = 32; t < 500000; t = t * 9 / 8 + 1 ) {
+      uint32 decoded = Packet::decodeTraceTime(
+         Packet::encodeTraceTime( t ) );
+      MC2_TEST_CHECK( decoded <= t );
+      MC2_TEST_CHECK( t - decoded <= t / 16 );
+      // Encoding a decoded time gives the same time.
+      MC2_TEST_CHECK( Packet::decodeTraceTime(
+                         Packet::encodeTraceTime( decoded ) ) == decoded );
+   }
+   // Saturates.
+   MC2_TEST_CHECK( Packet::encodeTraceTime( MAX_UINT32 ) == MAX_UINT8 );
+
+   Packet packet( 100, 0, Packet::PACKETTYPE_EXPANDROUTEREQUEST, 0, 0 );
+   MC2_TEST_CHECK( ! packet.isTraced() );
+   MC2_TEST_CHECK( packet.getTraceFlags() == 0 );
+   packet.setCPUTime( 0x01020304 );
+   packet.setTimeout( 7 );
+   packet.setTraceFlags( Packet::TRACE_REQUESTED );
+   packet.setTraceSendQueueTime( 12 );
+   packet.setTraceModuleQueueTime( 1000 );
+   MC2_TEST_CHECK( packet.isTraced() );
+   MC2_TEST_CHECK( packet.getTraceSendQueueTime() == 12 );
+   MC2_TEST_CHECK( packet.getTraceModuleQueueTime() == 992 );
+   // The trace context is between the timeout and the cpu time.
+   MC2_TEST_CHECK( packet.getCPUTime() == 0x01020304 );
+   MC2_TEST_CHECK( packet.getTimeout() == 7 );
+}
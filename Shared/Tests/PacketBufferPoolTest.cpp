@@ -0,0 +1,86 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "MC2UnitTestMain.h"
+
+#include "PacketBufferPool.h"
+#include "Packet.h"
+
+MC2_UNIT_TEST_FUNCTION( capacityTest ) {
+   MC2_TEST_CHECK( PacketBufferPool::getCapacity( 0 ) == 256 );
+   MC2_TEST_CHECK( PacketBufferPool::getCapacity( 256 ) == 256 );
+   MC2_TEST_CHECK( PacketBufferPool::getCapacity( 257 ) == 512 );
+   MC2_TEST_CHECK( PacketBufferPool::getCapacity( MAX_PACKET_SIZE ) ==
+                   65536 );
+   // Larger than the largest class are not rounded
+   MC2_TEST_CHECK( PacketBufferPool::getCapacity( 70000 ) == 70000 );
+}
+
+MC2_UNIT_TEST_FUNCTION( reuseTest ) {
+   PacketBufferPool::trim();
+   PacketBufferPool::Statistics before = PacketBufferPool::getStatistics();
+
+   uint32 capacity = 0;
+   byte* first = PacketBufferPool::allocate( 1000, capacity );
+   MC2_TEST_REQUIRED( first != NULL );
+   MC2_TEST_CHECK( capacity == 1024 );
+   PacketBufferPool::deallocate( first, capacity );
+
+   // The same buffer should come back from the thread cache.
+   byte* second = PacketBufferPool::allocate( 800, capacity );
+   MC2_TEST_CHECK( second == first );
+   MC2_TEST_CHECK( capacity == 1024 );
+
+   PacketBufferPool::Statistics after = PacketBufferPool::getStatistics();
+   MC2_TEST_CHECK( after.allocations - before.allocations == 2 );
+   MC2_TEST_CHECK( after.threadCacheHits - before.threadCacheHits == 1 );
+   MC2_TEST_CHECK( after.bytesInFlight - before.bytesInFlight == 1024 );
+
+   PacketBufferPool::deallocate( second, capacity );
+   after = PacketBufferPool::getStatistics();
+   MC2_TEST_CHECK( after.bytesInFlight == before.bytesInFlight );
+
+   // Oversize buffers bypass the caches.
+   byte* large = PacketBufferPool::allocate( 100000, capacity );
+   MC2_TEST_CHECK( capacity == 100000 );
+   PacketBufferPool::deallocate( large, capacity );
+}
+
+MC2_UNIT_TEST_FUNCTION( packetTest ) {
+   const uint16 subType = Packet::PACKETTYPE_TESTREQUEST;
+   {
+      Packet packet( 100, 0, subType, 0, 0 );
+      MC2_TEST_CHECK( packet.getBufSize() == 256 );
+      MC2_TEST_CHECK( packet.getSubType() == subType );
+      int pos = HEADER_SIZE;
+      for ( uint32 i = 0; i < 1000; ++i ) {
+         packet.updateSize( 4, 4 );
+         packet.incWriteLong( pos, i );
+         packet.setLength( pos );
+      }
+      MC2_TEST_CHECK( packet.getBufSize() >= packet.getLength() );
+
+      Packet* clone = packet.getClone( false );
+      MC2_TEST_CHECK( clone->getLength() == packet.getLength() );
+      pos = HEADER_SIZE;
+      MC2_TEST_CHECK( clone->incReadLong( pos ) == 0 );
+      delete clone;
+   }
+   // The packet above has taught the pool how large the type gets.
+   MC2_TEST_CHECK( PacketBufferPool::getSizeHint( subType ) == 4096 );
+
+   // So a growing packet of the type goes to that size at once.
+   Packet packet( 100, 0, subType, 0, 0 );
+   packet.updateSize( 300, 300 );
+   MC2_TEST_CHECK( packet.getBufSize() == 4096 );
+}
@@ -0,0 +1,113 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "MC2UnitTestMain.h"
+
+#include "AsyncLogHandler.h"
+
+#include <stdio.h>
+
+namespace {
+
+/// @return The contents of file.
+MC2String readAll( FILE* file ) {
+   MC2String result;
+   rewind( file );
+   char buf[ 4096 ];
+   size_t len = 0;
+   while ( ( len = fread( buf, 1, sizeof( buf ), file ) ) > 0 ) {
+      result.append( buf, len );
+   }
+   return result;
+}
+
+/// @return The number of lines in str.
+uint32 countLines( const MC2String& str ) {
+   uint32 lines = 0;
+   for ( MC2String::size_type i = 0; i < str.size(); ++i ) {
+      if ( str[ i ] == '\n' ) {
+         ++lines;
+      }
+   }
+   return lines;
+}
+
+void logMessage( AsyncLogHandler& handler, uint32 i, 
+                 int level = MC2Logging::LOGLEVEL_INFO ) {
+   char msg[ 64 ];
+   int len = sprintf( msg, "message %u", i );
+   handler.handleMessage( level, msg, len, "INFO : ", 
+                          "2010-01-01 00:00:00.000" );
+}
+
+}
+
+MC2_UNIT_TEST_FUNCTION( writeTest ) {
+   FILE* file = tmpfile();
+   MC2_TEST_REQUIRED( file != NULL );
+   {
+      AsyncLogHandler handler( file );
+      const uint32 nbrMessages = 1000;
+      for ( uint32 i = 0; i < nbrMessages; ++i ) {
+         logMessage( handler, i );
+      }
+      handler.flush();
+
+      MC2String contents = readAll( file );
+      MC2_TEST_CHECK( countLines( contents ) == nbrMessages );
+      MC2_TEST_CHECK( contents.find( 
+                         "2010-01-01 00:00:00.000 INFO : message 0\n" ) == 0 );
+      // In order
+      MC2_TEST_CHECK( contents.find( "message 998\n" ) < 
+                      contents.find( "message 999\n" ) );
+
+      AsyncLogHandler::Statistics stats = handler.getStatistics();
+      MC2_TEST_CHECK( stats.records == nbrMessages );
+      MC2_TEST_CHECK( stats.dropped == 0 );
+      MC2_TEST_CHECK( stats.writes >= 1 );
+      MC2_TEST_CHECK( stats.writes <= nbrMessages );
+      MC2_TEST_CHECK( stats.queuedBytes == 0 );
+
+      // Fatal records are written before handleMessage returns
+      fseek( file, 0, SEEK_END );
+      logMessage( handler, nbrMessages, MC2Logging::LOGLEVEL_FATAL );
+      MC2_TEST_CHECK( countLines( readAll( file ) ) == nbrMessages + 1 );
+   }
+   fclose( file );
+}
+
+MC2_UNIT_TEST_FUNCTION( overflowTest ) {
+   FILE* file = tmpfile();
+   MC2_TEST_REQUIRED( file != NULL );
+   const uint32 nbrMessages = 10000;
+   AsyncLogHandler::Statistics stats;
+   {
+      // Room for a few records only
+      AsyncLogHandler handler( file, 256 );
+      for ( uint32 i = 0; i < nbrMessages; ++i ) {
+         logMessage( handler, i );
+      }
+      stats = handler.getStatistics();
+      // The destructor writes the rest
+   }
+
+   MC2String contents = readAll( file );
+   MC2_TEST_CHECK( stats.records + stats.dropped == nbrMessages );
+   if ( stats.dropped > 0 ) {
+      MC2_TEST_CHECK( contents.find( "log records were dropped" ) != 
+                      MC2String::npos );
+   }
+   MC2_TEST_CHECK( contents.find( "message 0\n" ) != MC2String::npos );
+   fclose( file );
+}
@@ -0,0 +1,74 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "MC2UnitTestMain.h"
+
+#include "GzipUtil.h"
+#include "GunzipUtil.h"
+
+#include <vector>
+
+namespace {
+std::vector< byte > makeData( uint32 size ) {
+   std::vector< byte > data( size );
+   for ( uint32 i = 0; i < size; ++i ) {
+      data[ i ] = "Wayfinder gzip test "[ i % 20 ] + ( i / 1000 );
+   }
+   return data;
+}
+}
+
+MC2_UNIT_TEST_FUNCTION( roundTripTest ) {
+   // Every level twice, to use the reset streams too.
+   for ( int level = -1; level <= 9; ++level ) {
+      for ( uint32 times = 0; times < 2; ++times ) {
+         std::vector< byte > data = makeData( 10000 + times * 1000 );
+         std::vector< byte > gzipped( data.size() );
+         int gzSize = GzipUtil::gzip( &gzipped.front(), gzipped.size(),
+                                      &data.front(), data.size(), level );
+         if ( level == 0 ) {
+            // Stored is larger than the data
+            MC2_TEST_CHECK( gzSize < 0 );
+            continue;
+         }
+         MC2_TEST_REQUIRED( gzSize > 0 );
+         MC2_TEST_REQUIRED( GunzipUtil::origLength( &gzipped.front(), 
+                                                    gzSize ) == 
+                            int( data.size() ) );
+         std::vector< byte > result( data.size() );
+         int res = GunzipUtil::gunzip( &result.front(), result.size(),
+                                       &gzipped.front(), gzSize );
+         // Returns the number of bytes consumed
+         MC2_TEST_CHECK( res == gzSize );
+         MC2_TEST_CHECK( result == data );
+      }
+   }
+}
+
+MC2_UNIT_TEST_FUNCTION( tooSmallBufferTest ) {
+   std::vector< byte > data = makeData( 1000 );
+   std::vector< byte > gzipped( 10 );
+   MC2_TEST_CHECK( GzipUtil::gzip( &gzipped.front(), gzipped.size(),
+                                   &data.front(), data.size() ) < 0 );
+   // The stream must still work after the failure.
+   gzipped.resize( data.size() );
+   int gzSize = GzipUtil::gzip( &gzipped.front(), gzipped.size(),
+                                &data.front(), data.size() );
+   MC2_TEST_REQUIRED( gzSize > 0 );
+   std::vector< byte > result( data.size() );
+   MC2_TEST_CHECK( GunzipUtil::gunzip( &result.front(), result.size(),
+                                       &gzipped.front(), gzSize ) ==
+                   gzSize );
+   MC2_TEST_CHECK( result == data );
+}
@@ -0,0 +1,72 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "MC2UnitTestMain.h"
+
+#include "ISABThread.h"
+
+#include <vector>
+
+namespace {
+
+struct Counter {
+   Counter() : value( 0 ) {}
+   uint32 value;
+};
+
+ISABThreadSpecific<Counter> counters;
+
+/// Counts in its own Counter and remembers where it ended.
+class CountThread: public ISABThread {
+public:
+   explicit CountThread( uint32 nbr ) : m_nbr( nbr ), m_result( 0 ) {}
+
+   void run() {
+      for ( uint32 i = 0; i < m_nbr; ++i ) {
+         ++counters.get().value;
+         ISABThread::yield();
+      }
+      m_result = counters.get().value;
+   }
+
+   uint32 getResult() const { return m_result; }
+
+private:
+   uint32 m_nbr;
+   uint32 m_result;
+};
+
+}
+
+MC2_UNIT_TEST_FUNCTION( threadSpecificTest ) {
+   ISABThreadInitialize initThreads;
+
+   counters.get().value = 1000;
+
+   std::vector<ISABThreadHandle> threads;
+   std::vector<CountThread*> counts;
+   for ( uint32 i = 0; i < 8; ++i ) {
+      counts.push_back( new CountThread( 100 + i ) );
+      threads.push_back( counts.back() );
+      threads.back()->start();
+   }
+   for ( uint32 i = 0; i < threads.size(); ++i ) {
+      threads[ i ]->join();
+      // Each thread started from zero and saw only its own counts.
+      MC2_TEST_CHECK( counts[ i ]->getResult() == 100 + i );
+   }
+
+   // The counter of this thread was not touched.
+   MC2_TEST_CHECK( counters.get().value == 1000 );
+}
@@ -0,0 +1,31 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "MC2UnitTestMain.h"
+
+#include "IntervalTimer.h"
+
+MC2_UNIT_TEST_FUNCTION( intervalTimerTest ) {
+   const uint32 start = TimeUtility::getRealTime();
+   IntervalTimer timer( 60 );
+   // Not due until a whole interval has passed since it was created.
+   MC2_TEST_CHECK( ! timer.isDue( start ) );
+   MC2_TEST_CHECK( ! timer.isDue( start + 30 ) );
+   MC2_TEST_CHECK( timer.isDue( start + 62 ) );
+   // The next interval starts when it was due.
+   MC2_TEST_CHECK( ! timer.isDue( start + 100 ) );
+   MC2_TEST_CHECK( timer.isDue( start + 122 ) );
+
+   IntervalTimer never( 0 );
+   MC2_TEST_CHECK( ! never.isDue( start + 1000 ) );
+}
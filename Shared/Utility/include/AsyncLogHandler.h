@@ -0,0 +1,172 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#ifndef ASYNCLOGHANDLER_H
+#define ASYNCLOGHANDLER_H
+
+#include "MC2Logging.h"
+#include "MC2String.h"
+#include "NotCopyable.h"
+#include "PMonitor.h"
+
+#include <pthread.h>
+#include <sys/types.h>
+
+/**
+ *   LogHandler that writes to a file from a background thread.
+ *
+ *   The logging threads only append the formatted record to a queue
+ *   and never wait for the file. The writer thread takes all queued
+ *   records at once and writes them with one write, so the number of
+ *   writes drops when there is much logging.
+ *
+ *   If the queue grows larger than the maximum size, records are dropped
+ *   and counted, and a note about the dropped records is written. Fatal
+ *   records are never dropped and are written before handleMessage
+ *   returns, as the program is probably about to exit.
+ *
+ *   A process forked from the one that created the handler has no
+ *   writer thread and writes directly to the file.
+ */
+class AsyncLogHandler : public LogHandler, private NotCopyable {
+public:
+   /// The default maximum number of bytes waiting to be written.
+   static const uint32 DEFAULT_MAX_QUEUED_BYTES = 4*1024*1024;
+
+   /**
+    *   The counters of the handler.
+    */
+   struct Statistics {
+      /// The number of records queued.
+      uint64 records;
+      /// The number of writes done by the writer thread.
+      uint64 writes;
+      /// The number of records dropped because the queue was full.
+      uint64 dropped;
+      /// Bytes waiting to be written.
+      uint32 queuedBytes;
+   };
+
+   /**
+    *   Creates a handler writing to an open file, which is not closed
+    *   by the handler.
+    *
+    *   @param out The file to write to.
+    *   @param maxQueuedBytes The maximum size of the queue.
+    */
+   explicit AsyncLogHandler( FILE* out, 
+                             uint32 maxQueuedBytes = 
+                             DEFAULT_MAX_QUEUED_BYTES );
+
+   /**
+    *   Creates a handler that opens a log file for appending.
+    *
+    *   @param path Path to the log file.
+    *   @param maxQueuedBytes The maximum size of the queue.
+    */
+   explicit AsyncLogHandler( const char* path,
+                             uint32 maxQueuedBytes = 
+                             DEFAULT_MAX_QUEUED_BYTES );
+
+   /**
+    *   Writes the queued records and stops the writer thread.
+    */
+   virtual ~AsyncLogHandler();
+
+   /**
+    *   Queues a record for the writer thread.
+    *   @param level The loglevel, see MC2Logging.
+    *   @param msg   Pointer to the log message.
+    *   @param msgLen Length of the log message.
+    *   @param levelStr String representation of the log level.
+    *   @param timeStamp String representation of the time stamp.
+    */
+   virtual void handleMessage( int level, const char* msg, int msgLen,
+                               const char* levelStr, 
+                               const char* timeStamp );
+
+   /**
+    *   Waits until all records queued before the call are written.
+    */
+   void flush();
+
+   /**
+    *   @return The counters of the handler.
+    */
+   Statistics getStatistics() const;
+
+private:
+   /// Starts the writer thread.
+   void start( FILE* out, uint32 maxQueuedBytes );
+
+   /// The writer thread, takes the handler as argument.
+   static void* writerMain( void* handler );
+
+   /// Writes the queue until the handler is stopped.
+   void run();
+
+   /**
+    *   Writes records to the file.
+    *   @param records The formatted records.
+    *   @param dropped The number of records dropped before them.
+    */
+   void write( const MC2String& records, uint32 dropped );
+
+   /// @return True if the writer thread belongs to this process.
+   bool hasWriter() const;
+
+   /// The file to write to.
+   FILE* m_out;
+
+   /// True if m_out was opened by the handler.
+   bool m_ownsFile;
+
+   /// The maximum size of m_queue.
+   uint32 m_maxQueuedBytes;
+
+   /// Protects the members below and signals changes of them.
+   mutable PThread::Monitor m_monitor;
+
+   /// The formatted records waiting for the writer.
+   MC2String m_queue;
+
+   /// The number of records queued, ever.
+   uint64 m_queuedRecords;
+
+   /// The number of records written, ever.
+   uint64 m_writtenRecords;
+
+   /// The number of writes done by the writer.
+   uint64 m_writes;
+
+   /// The number of dropped records, ever.
+   uint64 m_dropped;
+
+   /// The number of dropped records not yet noted in the file.
+   uint32 m_unreportedDrops;
+
+   /// False when the writer should stop.
+   bool m_running;
+
+   /// True if the writer thread was started.
+   bool m_started;
+
+   /// The process that started the writer.
+   pid_t m_writerPid;
+
+   /// The writer thread.
+   pthread_t m_writer;
+};
+
+#endif // ASYNCLOGHANDLER_H
@@ -437,6 +437,48 @@ public:
    static void set( TSSKey key, const void* value );
 };
 
+/**
+ * One default constructed T per thread, created the first time the
+ * thread calls get and deleted when the thread exits.
+ * Meant for the static buffers of code that is run by several threads.
+ */
+template<typename T>
+class ISABThreadSpecific {
+public:
+   ISABThreadSpecific() : m_key( ISABTSS::createKey( deleteValue ) ) {
+   }
+
+   ~ISABThreadSpecific() {
+      ISABTSS::deleteKey( m_key );
+   }
+
+   /**
+    * @return The T of the calling thread.
+    */
+   T& get() {
+      T* value = static_cast<T*>( ISABTSS::get( m_key ) );
+      if ( value == NULL ) {
+         value = new T();
+         ISABTSS::set( m_key, value );
+      }
+      return *value;
+   }
+
+private:
+   /// Not to be copied.
+   ISABThreadSpecific( const ISABThreadSpecific& );
+   /// Not to be assigned.
+   ISABThreadSpecific& operator = ( const ISABThreadSpecific& );
+
+   /// Deletes the value of an exiting thread.
+   static void deleteValue( void* value ) {
+      delete static_cast<T*>( value );
+   }
+
+   /// The key of the values.
+   ISABTSS::TSSKey m_key;
+};
+
 // inlines
 
 ////////////////////////////////////////////////////////////////////////
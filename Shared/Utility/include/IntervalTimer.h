@@ -0,0 +1,53 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef INTERVALTIMER_H
+#define INTERVALTIMER_H
+
+#include "config.h"
+#include "TimeUtility.h"
+
+/**
+ *   Tells when something that should be done at most once per
+ *   interval, like logging statistics, is due again. The first
+ *   interval starts when the timer is created. Not locked, a timer
+ *   used by several threads must be protected by the caller.
+ */
+class IntervalTimer {
+public:
+   /// @param interval The interval in seconds, 0 means never due.
+   explicit IntervalTimer( uint32 interval = 60 ):
+      m_interval( interval ),
+      m_last( TimeUtility::getRealTime() ) { }
+
+   /**
+    *   @param now The current real time in seconds.
+    *   @return True if the interval has passed since the last time
+    *           it was due, the next interval starts at now then.
+    */
+   bool isDue( uint32 now = TimeUtility::getRealTime() ) {
+      if ( m_interval == 0 || now - m_last < m_interval ) {
+         return false;
+      }
+      m_last = now;
+      return true;
+   }
+
+private:
+   /// The interval in seconds.
+   uint32 m_interval;
+   /// When the timer was last due, real time in seconds.
+   uint32 m_last;
+};
+
+#endif // INTERVALTIMER_H
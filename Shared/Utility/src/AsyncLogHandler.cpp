@@ -0,0 +1,189 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "AsyncLogHandler.h"
+
+#include <stdio.h>
+#include <unistd.h>
+
+AsyncLogHandler::AsyncLogHandler( FILE* out, uint32 maxQueuedBytes ) {
+   m_ownsFile = false;
+   start( out, maxQueuedBytes );
+}
+
+AsyncLogHandler::AsyncLogHandler( const char* path, uint32 maxQueuedBytes ) {
+   m_ownsFile = true;
+   start( fopen( path, "a" ), maxQueuedBytes );
+
+   if ( m_out == NULL ) {
+      mc2log << error << "[AsyncLogHandler] Couldn't open log file "
+             << path << " for writing!" << endl;
+   }
+}
+
+void
+AsyncLogHandler::start( FILE* out, uint32 maxQueuedBytes ) {
+   m_out = out;
+   m_maxQueuedBytes = maxQueuedBytes;
+   m_queuedRecords = 0;
+   m_writtenRecords = 0;
+   m_writes = 0;
+   m_dropped = 0;
+   m_unreportedDrops = 0;
+   m_running = true;
+   m_writerPid = getpid();
+   m_queue.reserve( 65536 );
+
+   // If there is no thread the records are written directly instead.
+   m_started = pthread_create( &m_writer, NULL, writerMain, this ) == 0;
+}
+
+AsyncLogHandler::~AsyncLogHandler() {
+   if ( hasWriter() ) {
+      {
+         PThread::Monitor::Sync sync( m_monitor );
+         m_running = false;
+         m_monitor.notifyAll();
+      }
+      // The writer writes what is left before it stops.
+      pthread_join( m_writer, NULL );
+   }
+
+   if ( m_ownsFile && m_out != NULL ) {
+      fclose( m_out );
+   }
+}
+
+bool
+AsyncLogHandler::hasWriter() const {
+   return m_started && getpid() == m_writerPid;
+}
+
+void
+AsyncLogHandler::handleMessage( int level, const char* msg, int msgLen,
+                                const char* levelStr, 
+                                const char* timeStamp ) {
+   if ( m_out == NULL ) {
+      return;
+   }
+
+   const bool fatal = level == MC2Logging::LOGLEVEL_FATAL;
+
+   if ( ! hasWriter() ) {
+      PThread::Monitor::Sync sync( m_monitor );
+      fprintf( m_out, "%s %s%s\n", timeStamp, levelStr, msg );
+      fflush( m_out );
+      return;
+   }
+
+   {
+      PThread::Monitor::Sync sync( m_monitor );
+      const uint32 timeLen = strlen( timeStamp );
+      const uint32 levelLen = strlen( levelStr );
+      const uint32 recordLen = timeLen + 1 + levelLen + msgLen + 1;
+      if ( ! fatal && m_queue.size() + recordLen > m_maxQueuedBytes ) {
+         ++m_dropped;
+         ++m_unreportedDrops;
+         return;
+      }
+      const bool wasEmpty = m_queue.empty();
+      m_queue.append( timeStamp, timeLen );
+      m_queue += ' ';
+      m_queue.append( levelStr, levelLen );
+      m_queue.append( msg, msgLen );
+      m_queue += '\n';
+      ++m_queuedRecords;
+      if ( wasEmpty ) {
+         m_monitor.notifyAll();
+      }
+   }
+
+   if ( fatal ) {
+      // The program is probably about to exit
+      flush();
+   }
+}
+
+void
+AsyncLogHandler::flush() {
+   if ( ! hasWriter() ) {
+      return;
+   }
+   PThread::Monitor::Sync sync( m_monitor );
+   const uint64 target = m_queuedRecords;
+   while ( m_writtenRecords < target ) {
+      m_monitor.wait();
+   }
+}
+
+AsyncLogHandler::Statistics
+AsyncLogHandler::getStatistics() const {
+   PThread::Monitor::Sync sync( m_monitor );
+   Statistics stats;
+   stats.records = m_queuedRecords;
+   stats.writes = m_writes;
+   stats.dropped = m_dropped;
+   stats.queuedBytes = m_queue.size();
+   return stats;
+}
+
+void*
+AsyncLogHandler::writerMain( void* handler ) {
+   static_cast<AsyncLogHandler*>( handler )->run();
+   return NULL;
+}
+
+void
+AsyncLogHandler::run() {
+   MC2String records;
+   records.reserve( 65536 );
+   for (;;) {
+      uint64 queued = 0;
+      uint32 dropped = 0;
+      {
+         PThread::Monitor::Sync sync( m_monitor );
+         while ( m_running && m_queue.empty() && m_unreportedDrops == 0 ) {
+            m_monitor.wait();
+         }
+         if ( ! m_running && m_queue.empty() && m_unreportedDrops == 0 ) {
+            return;
+         }
+         // Take everything queued, the loggers continue in the empty one.
+         records.swap( m_queue );
+         queued = m_queuedRecords;
+         dropped = m_unreportedDrops;
+         m_unreportedDrops = 0;
+      }
+
+      write( records, dropped );
+      records.clear();
+
+      {
+         PThread::Monitor::Sync sync( m_monitor );
+         m_writtenRecords = queued;
+         ++m_writes;
+         m_monitor.notifyAll();
+      }
+   }
+}
+
+void
+AsyncLogHandler::write( const MC2String& records, uint32 dropped ) {
+   if ( dropped != 0 ) {
+      fprintf( m_out, "WARN : [AsyncLogHandler] The log queue was full, "
+               "%u log records were dropped.\n", dropped );
+   }
+   fwrite( records.data(), 1, records.size(), m_out );
+   fflush( m_out );
+}
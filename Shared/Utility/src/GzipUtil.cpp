@@ -14,6 +14,95 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include "GzipUtil.h"
 
 #include "zlib.h"
+#include "ISABThread.h"
+
+#define OS_CODE  0x03  /* Default Unix */
+#define MEM_LEVEL 8
+
+namespace {
+
+/**
+ *   The deflate streams of a thread, one per compression level.
+ *   Setting up a stream allocates a few hundred kB so the streams are
+ *   reset and reused instead of being created for every call.
+ */
+struct DeflateStreams {
+   /// Levels Z_DEFAULT_COMPRESSION (-1) to Z_BEST_COMPRESSION (9).
+   enum { NBR_LEVELS = Z_BEST_COMPRESSION + 2 };
+
+   DeflateStreams() {
+      for ( int i = 0; i < NBR_LEVELS; ++i ) {
+         m_inited[ i ] = false;
+      }
+   }
+
+   ~DeflateStreams() {
+      for ( int i = 0; i < NBR_LEVELS; ++i ) {
+         if ( m_inited[ i ] ) {
+            deflateEnd( &m_streams[ i ] );
+         }
+      }
+   }
+
+   /**
+    *   @param level The compression level, -1 to 9.
+    *   @return A stream ready for deflate or NULL if it could not be
+    *           created. Call deflateReset on it when done.
+    */
+   z_stream* getStream( int level ) {
+      const int i = level + 1;
+      if ( ! m_inited[ i ] ) {
+         z_stream& s = m_streams[ i ];
+         s.next_in = s.next_out = Z_NULL;
+         s.avail_in = s.avail_out = 0;
+         s.msg = 0;
+         s.zalloc = (alloc_func)0;
+         s.zfree = (free_func)0;
+         s.opaque = (voidpf)0;
+         // windowBits is passed < 0 to suppress zlib header
+         // WARNING: Undocumented feature in zlib!!
+         if ( deflateInit2( &s, level, Z_DEFLATED, -MAX_WBITS, 
+                            MEM_LEVEL, Z_DEFAULT_STRATEGY ) != Z_OK ) {
+            return NULL;
+         }
+         m_inited[ i ] = true;
+      }
+      return &m_streams[ i ];
+   }
+
+   z_stream m_streams[ NBR_LEVELS ];
+   bool m_inited[ NBR_LEVELS ];
+};
+
+/// Deletes the streams of a thread when it terminates.
+void deleteStreams( void* ptr ) {
+   delete static_cast<DeflateStreams*>( ptr );
+}
+
+/// Makes sure we only call initTSS once
+ISABOnceFlag tssInited = ISAB_ONCE_INIT;
+
+/// The key to the thread specific streams
+ISABTSS::TSSKey streamsTSSKey;
+
+/// Initiates streamsTSSKey
+void initTSS() {
+   streamsTSSKey = ISABTSS::createKey( deleteStreams );
+}
+
+/// @return The streams of the calling thread.
+DeflateStreams& getThreadStreams() {
+   ISABCallOnce( &initTSS, tssInited );
+   DeflateStreams* streams = 
+      static_cast<DeflateStreams*>( ISABTSS::get( streamsTSSKey ) );
+   if ( streams == NULL ) {
+      streams = new DeflateStreams();
+      ISABTSS::set( streamsTSSKey, streams );
+   }
+   return *streams;
+}
+
+}
 
 int
 GzipUtil::gzip(unsigned char* p_outBuffer, int p_outlen,
@@ -26,7 +115,6 @@ GzipUtil::gzip(unsigned char* p_outBuffer, int p_outlen,
    
    // Zlib starts
    int err;
-   int pos = 0;
    bool ok = true;
    int level = Z_DEFAULT_COMPRESSION; //Z_BEST_SPEED
    // Set level according to in-value if it is within bounds.
@@ -34,31 +122,14 @@ GzipUtil::gzip(unsigned char* p_outBuffer, int p_outlen,
         compressionLevel <= Z_BEST_COMPRESSION ) {
       level = compressionLevel;
    }
-   int strategy = Z_DEFAULT_STRATEGY;
-   z_stream s;
    uLong crc = crc32( 0L, Z_NULL, 0);
    static const int gz_magic[2] = {0x1f, 0x8b}; /* gzip magic header */
-#define OS_CODE  0x03  /* Default Unix */
-#define MEM_LEVEL 8
-   
-   s.next_in = s.next_out = Z_NULL;
-   s.avail_in = s.avail_out = 0;
-   
-   s.msg = 0;
-   
-   s.zalloc = (alloc_func)0;
-   s.zfree = (free_func)0;
-   s.opaque = (voidpf)0;
-   
-   
-   // windowBits is passed < 0 to suppress zlib header
-   // WARNING: Undocumented feature in zlib!!
-   err = deflateInit2( &s, level, Z_DEFLATED, -MAX_WBITS, 
-                       MEM_LEVEL, strategy );
-   
-   if ( err != Z_OK ) {
-      ok = false;
+
+   z_stream* stream = getThreadStreams().getStream( level );
+   if ( stream == NULL ) {
+      return -1;
    }
+   z_stream& s = *stream;
    
    // Set indata
    s.next_in  = (Byte*)p_inBuffer;
@@ -88,7 +159,8 @@ GzipUtil::gzip(unsigned char* p_outBuffer, int p_outlen,
    
    // Compress
    err = deflate( &(s), Z_FINISH ); // Finnish as in flush to outbuff
-   if ( err != Z_OK && err != Z_STREAM_END ) {
+   if ( err != Z_STREAM_END ) {
+      // Z_OK means that the output buffer was too small
       ok = false;
    }
    
@@ -101,25 +173,20 @@ GzipUtil::gzip(unsigned char* p_outBuffer, int p_outlen,
       *s.next_out++ = crc>>8;
       *s.next_out++ = crc>>16;
       *s.next_out++ = crc>>24;
-      s.total_out += 4;
       int tot = s.total_in;
       *s.next_out++ = tot;
       *s.next_out++ = tot>>8;
       *s.next_out++ = tot>>16;
       *s.next_out++ = tot>>24;
-      s.total_out += 4;
    } else {
       ok = false;
       s.next_out = outData + outLen;
    }
    
-   pos = s.total_in;
    outPos = (s.next_out - outData);
    
-   // Clean zlib stream
-   err = deflateEnd ( &s );
-   if ( err != Z_OK ) {
-   }
+   // Make the stream ready for the next call
+   deflateReset( &s );
    
    if ( ok ) {
       return outPos;
@@ -127,6 +194,3 @@ GzipUtil::gzip(unsigned char* p_outBuffer, int p_outlen,
       return -1;
    }
 }
-
-
-
@@ -107,22 +107,21 @@ private:
     *   really, really const.
     */
    inline void bitsHaveBeenUsed() const;
-   
-   /**
-    *   Writes one bit.
-    */
-   inline void writeNextBit(int value);
 
    /**
-    *   Reads one bit.
+    *   Reads the bits from the current position into the top of a
+    *   64 bit word. Reads the whole word at once when it is inside
+    *   the buffer and only the needed bytes at the end of the buffer.
+    *
+    *   @param nbrBytes The number of bytes that are needed, 1-5.
     */
-   inline int readNextBit();
+   inline uint64 loadBits( uint32 nbrBytes ) const;
    
    /**
-    *   Counter for the bit position in a byte.
-    *   32 bits for thumb to be happy.
+    *   The number of bits already used in the byte at m_pos, 0-7.
+    *   The bits are used from the most significant bit.
     */
-   uint32 m_bitMask;
+   uint32 m_bitOffset;
    
 };
 
@@ -132,19 +131,22 @@ BitBuffer::bitsHaveBeenUsed() const
    DEBUG1(const_cast<BitBuffer*>(this)->m_bytesOK = false);
 }
 
-inline int
-BitBuffer::readNextBit()
+inline uint64
+BitBuffer::loadBits( uint32 nbrBytes ) const
 {
-   bool retVal = (*m_pos & m_bitMask) != 0;
-
-   m_bitMask >>= 1;
-
-   if ( m_bitMask == 0x00 ) {
-      m_bitMask = 0x80;
-      m_pos++;
+   const uint8* pos = m_pos;
+   if ( pos + 8 <= m_buf + m_bufSize ) {
+      return
+         ( uint64( pos[ 0 ] ) << 56 ) | ( uint64( pos[ 1 ] ) << 48 ) |
+         ( uint64( pos[ 2 ] ) << 40 ) | ( uint64( pos[ 3 ] ) << 32 ) |
+         ( uint64( pos[ 4 ] ) << 24 ) | ( uint64( pos[ 5 ] ) << 16 ) |
+         ( uint64( pos[ 6 ] ) << 8 )  |   uint64( pos[ 7 ] );
    }
-
-   return retVal;
+   uint64 word = 0;
+   for ( uint32 i = 0; i < nbrBytes; ++i ) {
+      word |= uint64( pos[ i ] ) << ( 56 - 8 * i );
+   }
+   return word;
 }
 
 inline uint32
@@ -152,89 +154,52 @@ BitBuffer::readNextBits(int nbrBits)
 {
    MC2_ASSERT(nbrBits > 0);
    bitsHaveBeenUsed();
-   // This could probably be optimized.
-   uint32 value = 0;
-   while ( nbrBits-- ) {
-      value <<= 1;
-      value |= readNextBit();
-   }
+   const uint32 endBit = m_bitOffset + nbrBits;
+   const uint64 word = loadBits( ( endBit + 7 ) >> 3 );
+   m_pos += endBit >> 3;
+   const uint32 value = uint32( ( word << m_bitOffset ) >> ( 64 - nbrBits ) );
+   m_bitOffset = endBit & 7;
    return value;
 }
 
 inline int32
 BitBuffer::readNextSignedBits(int nbrBits)
 {
-   bitsHaveBeenUsed();
-   // This could probably be optimized.
+   uint32 value = readNextBits( nbrBits );
    // Add the sign-extension if needed.
-   uint32 value = readNextBit();
-   if ( value ) {
-      value = 0xffffffff;
-   }
-   // Skip one bit and read the others as usual.
-   while ( --nbrBits ) {
-      value <<= 1;
-      value |= readNextBit();
+   if ( nbrBits < 32 && ( value & ( 1 << ( nbrBits - 1 ) ) ) ) {
+      value |= 0xffffffff << nbrBits;
    }
    return int32(value);
 }
 
-inline void
-BitBuffer::writeNextBit(int value)
-{
-   if ( value ) {
-      *m_pos |= m_bitMask;      
-   } else {
-      *m_pos &= (0xff ^ m_bitMask);
-   }
-   m_bitMask >>= 1;
-
-   if ( m_bitMask == 0x00 ) {
-      m_bitMask = 0x80;
-      m_pos++;
-   }
-
-   
-}
-
 inline void
 BitBuffer::writeNextBits(uint32 value, int nbrBits)
 {
    bitsHaveBeenUsed();
-   value <<= (32-nbrBits);
-   while ( nbrBits-- ) {
-      writeNextBit( (value & 0x80000000) != 0 );
-      value <<= 1;
+   const uint32 endBit = m_bitOffset + nbrBits;
+   const uint32 nbrBytes = ( endBit + 7 ) >> 3;
+   // The value and the bits it covers, placed in the
+   // bytes from m_pos.
+   const uint32 shift = nbrBytes * 8 - endBit;
+   const uint64 mask = ( ( uint64( 1 ) << nbrBits ) - 1 ) << shift;
+   uint64 bits = ( uint64( value ) << shift ) & mask;
+   if ( m_bitOffset != 0 || shift != 0 ) {
+      // Keep the bits around the value.
+      bits |= ( loadBits( nbrBytes ) >> ( 64 - nbrBytes * 8 ) ) & ~mask;
    }
+   for ( int i = nbrBytes - 1; i >= 0; --i ) {
+      m_pos[ i ] = uint8( bits );
+      bits >>= 8;
+   }
+   m_pos += endBit >> 3;
+   m_bitOffset = endBit & 7;
 }
 
 inline uint32 
 BitBuffer::getCurrentBitOffset() const
 {
-   uint32 nbrBits = (m_pos - m_buf) << 3; // *8
-
-   switch ( m_bitMask ) {
-      case ( 0x80 ) :
-         return nbrBits;
-      case ( 0x40 ) :
-         return nbrBits + 1;
-      case ( 0x20 ) :
-         return nbrBits + 2;
-      case ( 0x10 ) :
-         return nbrBits + 3;
-      case ( 0x08 ) :
-         return nbrBits + 4;
-      case ( 0x04 ) :
-         return nbrBits + 5;
-      case ( 0x02 ) :
-         return nbrBits + 6;
-      case ( 0x01 ) :
-         return nbrBits + 7;
-      default:
-         // This should not happen.
-         MC2_ASSERT( false );
-         return nbrBits;
-   }
+   return ( ( m_pos - m_buf ) << 3 ) + m_bitOffset;
 }
 
 #endif
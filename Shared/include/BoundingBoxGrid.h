@@ -0,0 +1,129 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef BOUNDINGBOXGRID_H
+#define BOUNDINGBOXGRID_H
+
+#include "config.h"
+
+#include <vector>
+
+class MC2BoundingBox;
+
+/**
+ *   A uniform grid of bounding boxes, each with a uint32 value.
+ *
+ *   Unlike the BoundingBoxTree the grid can be searched between the
+ *   additions, which is what greedy placement of labels and symbols
+ *   needs: each candidate is tested against the boxes placed so far
+ *   and added if it is free. The cells are hashed into a fixed number
+ *   of buckets so the grid has no bounds and clear is cheap.
+ *
+ *   The boxes are compared using plain min and max values, borders
+ *   included. Boxes crossing the date line and searches with such a
+ *   box always find them, so callers using the wrapping comparisons
+ *   of MC2BoundingBox get the same answers as a scan of all boxes.
+ */
+class BoundingBoxGrid {
+public:
+   /// The max number of cells a box is put in, larger go in a list.
+   static const uint32 MAX_CELLS_PER_BOX = 64;
+
+   /// The number of buckets the cells are hashed into.
+   static const uint32 NBR_BUCKETS = 1024;
+
+   /**
+    * @param cellSize The side of the cells in the unit of the boxes.
+    *                 If 0 it is set to twice the size of the first box
+    *                 added, which suits boxes of similar sizes.
+    */
+   explicit BoundingBoxGrid( uint32 cellSize = 0 );
+
+   /**
+    * Adds a box.
+    *
+    * @param bbox  The box.
+    * @param value The value returned when the box is found.
+    */
+   void add( const MC2BoundingBox& bbox, uint32 value );
+
+   /**
+    * Finds the boxes overlapping a box, borders included.
+    *
+    * @param bbox   The box to search with.
+    * @param values The values of the boxes are added here, each once
+    *               and in no particular order.
+    */
+   void getOverlapping( const MC2BoundingBox& bbox,
+                        std::vector<uint32>& values ) const;
+
+   /**
+    * Removes all boxes. The cell size is kept unless it was chosen
+    * from the first box.
+    */
+   void clear();
+
+   /// @return The number of boxes added.
+   uint32 size() const;
+
+   /// @return The side of the cells, 0 if not chosen yet.
+   uint32 getCellSize() const;
+
+private:
+   /// A box in the grid.
+   struct Box {
+      int32 minLat;
+      int32 maxLat;
+      int32 minLon;
+      int32 maxLon;
+      uint32 value;
+   };
+
+   /// @return The cell of a coordinate.
+   inline int32 getCell( int32 coord ) const;
+
+   /// @return The bucket of a cell.
+   static inline uint32 getBucket( int32 cellLat, int32 cellLon );
+
+   /// Adds the value of box index to values if not already found.
+   inline void found( uint32 index, std::vector<uint32>& values ) const;
+
+   /// Starts a new search, resetting the marks when needed.
+   void newSearch() const;
+
+   /// The boxes in the order they were added.
+   std::vector<Box> m_boxes;
+
+   /// Indices of the boxes in each bucket.
+   std::vector< std::vector<uint32> > m_buckets;
+
+   /// The buckets that are not empty, for clear.
+   std::vector<uint32> m_usedBuckets;
+
+   /// Indices of the boxes too large for the cells or crossing the date line.
+   std::vector<uint32> m_largeBoxes;
+
+   /// The search number each box was last found in.
+   mutable std::vector<uint32> m_marks;
+
+   /// The current search number.
+   mutable uint32 m_mark;
+
+   /// The side of the cells.
+   uint32 m_cellSize;
+
+   /// True if the cell size is chosen from the first box.
+   bool m_autoCellSize;
+};
+
+#endif // BOUNDINGBOXGRID_H
@@ -0,0 +1,121 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#ifndef BOUNDINGBOXTREE_H
+#define BOUNDINGBOXTREE_H
+
+#include "config.h"
+
+#include <vector>
+
+class MC2BoundingBox;
+
+/**
+ *   A static R-tree of bounding boxes, each with a uint32 value.
+ *   
+ *   All boxes are added first and then the tree is packed with build,
+ *   using sort tile recursive packing. After that the tree can be
+ *   searched for the boxes overlapping a box or containing a point.
+ *
+ *   The boxes are compared using plain min and max values, so boxes
+ *   crossing the date line must be split by the caller.
+ */
+class BoundingBoxTree {
+public:
+   /// The max number of children of a node.
+   static const uint32 NODE_SIZE = 16;
+
+   BoundingBoxTree();
+
+   /**
+    * Adds a box. Must not be called after build.
+    *
+    * @param bbox  The box.
+    * @param value The value returned when the box is found.
+    */
+   void add( const MC2BoundingBox& bbox, uint32 value );
+
+   /**
+    * Adds a box. Must not be called after build.
+    */
+   void add( int32 minLat, int32 maxLat, int32 minLon, int32 maxLon,
+             uint32 value );
+
+   /**
+    * Packs the tree. Must be called after the boxes are added and
+    * before searching.
+    */
+   void build();
+
+   /**
+    * Finds the boxes containing a point, borders included.
+    *
+    * @param lat    The latitude of the point.
+    * @param lon    The longitude of the point.
+    * @param values The values of the boxes are added here, in no
+    *               particular order.
+    */
+   void getContaining( int32 lat, int32 lon, 
+                       std::vector<uint32>& values ) const;
+
+   /**
+    * Finds the boxes overlapping a box, borders included.
+    *
+    * @param bbox   The box to search with.
+    * @param values The values of the boxes are added here, in no
+    *               particular order.
+    */
+   void getOverlapping( const MC2BoundingBox& bbox,
+                        std::vector<uint32>& values ) const;
+
+   /// @return The number of boxes added.
+   uint32 size() const;
+
+private:
+   /**
+    *   A box in the tree. In the lowest level first is the value, in
+    *   the other levels the children are the count boxes starting at
+    *   first in the level below.
+    */
+   struct Box {
+      int32 minLat;
+      int32 maxLat;
+      int32 minLon;
+      int32 maxLon;
+      uint32 first;
+      uint32 count;
+   };
+
+   typedef std::vector<Box> Level;
+
+   /// Sorts boxes in tile order and makes the level above them.
+   static void packLevel( Level& boxes, Level& parents );
+
+   /// Searches a box and its children.
+   void search( uint32 level, uint32 index, 
+                int32 minLat, int32 maxLat, int32 minLon, int32 maxLon,
+                std::vector<uint32>& values ) const;
+
+   /// Searches the whole tree.
+   void search( int32 minLat, int32 maxLat, int32 minLon, int32 maxLon,
+                std::vector<uint32>& values ) const;
+
+   /// The levels of the tree, the added boxes first and the root last.
+   std::vector<Level> m_levels;
+
+   /// True if build has been called.
+   bool m_built;
+};
+
+#endif // BOUNDINGBOXTREE_H
@@ -595,6 +595,11 @@ class CommandlineOptionHandler {
            */
          bool m_debugFlag;
 
+         /**
+           *   The value of the -A/--async-log option is stored here.
+           */
+         bool m_asyncLogFlag;
+
          /**
           *    The properties to add to Properties.
           */
@@ -0,0 +1,112 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#ifndef GEOMETRYKERNELS_H
+#define GEOMETRYKERNELS_H
+
+#include "config.h"
+
+class MC2BoundingBox;
+
+/**
+ *   Vectorized inner loops for the polygon code.
+ *
+ *   The kernels work directly on arrays of coordinates stored as pairs
+ *   of int32, i.e. MC2Coordinate, MC2Point and POINT, and give exactly
+ *   the same results as the scalar code they replace. Each kernel has a
+ *   scalar, an SSE2 and an AVX2 version. The best one supported by the
+ *   cpu is selected the first time a kernel is used.
+ */
+namespace GeometryKernels {
+
+/// The order of the two int32 in each coordinate.
+enum order_t {
+   /// lat first, like MC2Coordinate.
+   LAT_LON,
+   /// lon first, like MC2Point and POINT, where x is lon.
+   LON_LAT
+};
+
+/// The implementations.
+enum kernel_t {
+   SCALAR = 0,
+   SSE2   = 1,
+   AVX2   = 2
+};
+
+/**
+ *   @return The kernels in use.
+ */
+kernel_t getKernel();
+
+/**
+ *   Selects the kernels to use, for tests and benchmarks.
+ *
+ *   @param kernel The kernels to use.
+ *   @return False if the cpu or compiler does not support them, the
+ *           kernels are not changed then.
+ */
+bool setKernel( kernel_t kernel );
+
+/**
+ *   @return The name of the kernels.
+ */
+const char* getKernelName( kernel_t kernel );
+
+/**
+ *   Computes MC2BoundingBox::getCohenSutherlandOutcode for each
+ *   coordinate.
+ *
+ *   @param bbox     The box.
+ *   @param coords   The coordinates, 2 * nbr int32.
+ *   @param nbr      The number of coordinates.
+ *   @param order    The order of lat and lon in coords.
+ *   @param outcodes [OUT] nbr outcodes.
+ *   @param orCodes  [OUT] All the outcodes or:ed together, 0 if all
+ *                   coordinates are inside.
+ *   @param andCodes [OUT] All the outcodes and:ed together, not 0 if all
+ *                   coordinates are outside the same side.
+ */
+void computeOutcodes( const MC2BoundingBox& bbox,
+                      const int32* coords, uint32 nbr, order_t order,
+                      byte* outcodes, byte& orCodes, byte& andCodes );
+
+/**
+ *   @param data The bytes.
+ *   @param nbr  The number of bytes.
+ *   @return All the bytes or:ed together.
+ */
+byte orBytes( const byte* data, uint32 nbr );
+
+/**
+ *   Finds the next edge of a polygon that may cross a latitude, as
+ *   tested by GfxData::insidePolygon. The edge i goes from coordinate
+ *   i - 1 to coordinate i and may cross if one end is on or below
+ *   the latitude and the other on or above.
+ *
+ *   @param coords The coordinates.
+ *   @param begin  The first edge to test, at least 1.
+ *   @param end    The edge after the last one to test, at most the
+ *                 number of coordinates.
+ *   @param order  The order of lat and lon in coords.
+ *   @param lat    The latitude.
+ *   @return The first edge in [begin, end) that may cross lat,
+ *           end if none.
+ */
+uint32 findLatCrossing( const int32* coords, uint32 begin, uint32 end,
+                        order_t order, int32 lat );
+
+}
+
+#endif // GEOMETRYKERNELS_H
@@ -0,0 +1,152 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#ifndef LATENCYSTATISTICS_H
+#define LATENCYSTATISTICS_H
+
+#include "config.h"
+#include "ISABThread.h"
+#include "NotCopyable.h"
+#include "IntervalTimer.h"
+
+#include <map>
+#include <iosfwd>
+
+/**
+ *   Latency histograms per packet type and stage of a request.
+ *
+ *   The server adds the stages of the traced requests when the replies
+ *   arrive and the modules add their own queue and processing times.
+ *   A summary per packet type is logged once a minute by the thread
+ *   that adds a time when the minute has passed.
+ */
+class LatencyStatistics: private NotCopyable {
+public:
+   /// The stages of a request.
+   enum stage_t {
+      /// Waiting in the send queue of the server.
+      SERVER_SEND_QUEUE = 0,
+      /// On the network, both ways, including the receive queues.
+      NETWORK,
+      /// Waiting in the module before processing.
+      MODULE_QUEUE,
+      /// Processing in the module.
+      PROCESSING,
+      /// From the reply arriving at the server until it is handled.
+      REPLY_QUEUE,
+      /// From the first send until the reply is handled.
+      TOTAL,
+      NBR_STAGES
+   };
+
+   /**
+    *   Histogram of times with power of two buckets. Bucket 0 holds
+    *   0 ms, bucket i the times 2^(i-1) to 2^i - 1 and the last one
+    *   all larger times.
+    */
+   class Histogram {
+   public:
+      /// The number of buckets.
+      static const uint32 NBR_BUCKETS = 21;
+
+      Histogram();
+
+      /// Adds a time in milli seconds.
+      void add( uint32 timeMs );
+
+      /// @return The number of added times.
+      uint32 getCount() const { return m_count; }
+
+      /// @return The largest added time.
+      uint32 getMax() const { return m_max; }
+
+      /// @return The mean of the added times, 0 if none.
+      uint32 getMean() const;
+
+      /**
+       *   @param fraction The percentile as a fraction, e.g. 0.99.
+       *   @return The upper limit of the bucket holding the percentile,
+       *           at most the largest time.
+       */
+      uint32 getPercentile( float fraction ) const;
+
+      /// @return The number of times in a bucket.
+      uint32 getBucket( uint32 index ) const { return m_buckets[ index ]; }
+
+      /// @return The index of the bucket for a time.
+      static uint32 getBucketIndex( uint32 timeMs );
+
+   private:
+      uint32 m_buckets[ NBR_BUCKETS ];
+      uint32 m_count;
+      uint32 m_max;
+      uint64 m_sum;
+   };
+
+   /// The histograms of all stages for a packet type.
+   struct TypeStatistics {
+      Histogram stages[ NBR_STAGES ];
+   };
+
+   /// Histograms per packet subtype.
+   typedef std::map< uint16, TypeStatistics > StatisticsMap;
+
+   /**
+    *   @param logInterval Seconds between the logged summaries,
+    *                      0 to never log.
+    */
+   explicit LatencyStatistics( uint32 logInterval = 60 );
+
+   /// @return The statistics of this process.
+   static LatencyStatistics& getInstance();
+
+   /**
+    *   Adds the time of one stage.
+    *
+    *   @param subType The packet type of the request.
+    *   @param stage   The stage.
+    *   @param timeMs  The time in milli seconds.
+    */
+   void add( uint16 subType, stage_t stage, uint32 timeMs );
+
+   /// @return A copy of the histograms.
+   StatisticsMap getStatistics() const;
+
+   /// Removes all times.
+   void clear();
+
+   /**
+    *   Prints one line per packet type with count, median, 90th and
+    *   99th percentile and max of each stage.
+    */
+   void print( std::ostream& stream ) const;
+
+   /// @return The name of a stage.
+   static const char* getStageName( stage_t stage );
+
+private:
+   /// Logs the summary if the interval has passed.
+   void logIfDue();
+
+   /// Prints the map.
+   static void print( std::ostream& stream, const StatisticsMap& stats );
+
+   /// Protects m_stats and m_logTimer.
+   mutable ISABMutexBeforeInit m_mutex;
+   StatisticsMap m_stats;
+   /// When the summary is due to be logged.
+   IntervalTimer m_logTimer;
+};
+
+#endif // LATENCYSTATISTICS_H
@@ -15,20 +15,31 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #define OVERLAPDETECTOR
 
 #include "config.h"
+#include "BoundingBoxGrid.h"
 #include <vector>
 
 /**
  *   Contains pixelboxes to be checked for overlap
  *   
+ *   The boxes are kept in a BoundingBoxGrid so that only the boxes
+ *   near a new box are tested against it. BBOX must be an
+ *   MC2BoundingBox or a subclass of it.
  */
 template<class BBOX> class OverlapDetector {
    
    public:
+      /**
+       *   @param cellSize The cell size of the grid, see BoundingBoxGrid.
+       */
+      explicit OverlapDetector( uint32 cellSize = 0 ) : m_grid( cellSize ) {
+      }
+
       /**
        *   Clear everything.
        */
       void clear() {
          m_boxes.clear();
+         m_grid.clear();
       }
 
       /**
@@ -36,14 +47,10 @@ template<class BBOX> class OverlapDetector {
        *   the OverlapDetector.
        */
       bool addIfNotOverlapping( const BBOX& inbox ) {
-         for( typename storage_t::const_iterator it = m_boxes.begin();
-               it != m_boxes.end();
-               ++it ) {
-            if ( inbox.overlaps(*it) ) {
-               return false;
-            }
+         if ( overlapsAny( inbox ) ) {
+            return false;
          }
-         m_boxes.push_back(inbox);
+         add( inbox );
          return true;
       }
 
@@ -52,18 +59,18 @@ template<class BBOX> class OverlapDetector {
        *   in the list, then add all. If one overlaps, add none.
        */
       bool addIfNotOverlapping( const vector<BBOX>& inboxes ) {
-         for( typename storage_t::const_iterator it = m_boxes.begin();
-              it != m_boxes.end();
-              ++it ) {
-            for ( typename vector<BBOX>::const_iterator jt = inboxes.begin();
-                  jt != inboxes.end();
-                  ++jt ) {
-               if ( (*jt).overlaps(*it) ) {
-                  return false;
-               }
+         for ( typename vector<BBOX>::const_iterator jt = inboxes.begin();
+               jt != inboxes.end();
+               ++jt ) {
+            if ( overlapsAny( *jt ) ) {
+               return false;
             }
          }
-         m_boxes.insert(m_boxes.end(), inboxes.begin(), inboxes.end());
+         for ( typename vector<BBOX>::const_iterator jt = inboxes.begin();
+               jt != inboxes.end();
+               ++jt ) {
+            add( *jt );
+         }
          return true;
       }
 
@@ -73,11 +80,32 @@ template<class BBOX> class OverlapDetector {
       
    private:
 
-      /// Type of storage
-      typedef vector<BBOX> storage_t;
-   
+      /// @return True if inbox overlaps any of the boxes.
+      bool overlapsAny( const BBOX& inbox ) {
+         m_candidates.clear();
+         m_grid.getOverlapping( inbox, m_candidates );
+         for ( uint32 i = 0; i < m_candidates.size(); ++i ) {
+            if ( inbox.overlaps( m_boxes[ m_candidates[ i ] ] ) ) {
+               return true;
+            }
+         }
+         return false;
+      }
+
+      /// Adds a box that does not overlap.
+      void add( const BBOX& inbox ) {
+         m_grid.add( inbox, m_boxes.size() );
+         m_boxes.push_back( inbox );
+      }
+
       /// The non-overlapping boxes are stored here.
       vector<BBOX> m_boxes;
+
+      /// Index of m_boxes.
+      BoundingBoxGrid m_grid;
+
+      /// The boxes near the one being tested, kept to save allocations.
+      vector<uint32> m_candidates;
       
 };
 
@@ -21,6 +21,7 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include "BitUtility.h"
 #include "TimeUtility.h"
 #include "NotCopyable.h"
+#include "PacketBufferPool.h"
 
 #include "MC2BoundingBox.h"
 #include "MC2String.h"
@@ -55,7 +56,11 @@ class IPnPort;
 #define PACKET_OFFSET_MAPSETID    32
 #define PACKET_OFFSET_REQUEST_TAG 36
 #define PACKET_OFFSET_TIMEOUT     40
-#define PACKET_OFFSET_CPUTIME     41
+#define PACKET_OFFSET_TRACEFLAGS  41
+#define PACKET_OFFSET_TRACE_SENDQUEUE   42
+#define PACKET_OFFSET_TRACE_MODULEQUEUE 43
+// Was 41, which readLong and writeLong aligned to 44.
+#define PACKET_OFFSET_CPUTIME     44
 // Packet header size (bytes)
 #  define   HEADER_SIZE          48    
 // RequestPacket header size (bytes)
@@ -94,6 +99,11 @@ class IPnPort;
   *      @row 31  @sep 1 byte  @sep resend nbr.                @endrow
   *      @row 32  @sep 4 bytes @sep mapSet ID                  @endrow
   *      @row 36  @sep 4 bytes @sep Request Tag                @endrow
+  *      @row 40  @sep 1 byte  @sep timeout in seconds         @endrow
+  *      @row 41  @sep 1 byte  @sep trace flags                @endrow
+  *      @row 42  @sep 1 byte  @sep trace, server send queue time @endrow
+  *      @row 43  @sep 1 byte  @sep trace, module queue time   @endrow
+  *      @row 44  @sep 4 bytes @sep cpu time                   @endrow
   *   @endpacketdesc
   *
   */
@@ -580,6 +590,14 @@ class Packet: private NotCopyable
         */
       const char *getSubTypeAsString() const;
 
+      /**
+        *   Get a packet type as a nullterminated string.
+        *   @param   subType The type.
+        *   @return  Pointer to a nullterminated string containing 
+        *            the type.
+        */
+      static const char* getSubTypeAsString( uint16 subType );
+
       /** 
         *   The IP of the sender of this packet (the one who should be sent
         *   the reply).
@@ -695,6 +713,51 @@ class Packet: private NotCopyable
    inline void setCPUTime( uint32 time );
    /// @return cpu time
    inline uint32 getCPUTime() const;
+
+   /**
+    * The trace flags in the header.
+    */
+   enum traceFlag {
+      /// The sender wants the latency trace times back in the reply.
+      TRACE_REQUESTED     = 0x01,
+      /// The module has filled in the trace times of the reply.
+      TRACE_MODULE_TIMES  = 0x02
+   };
+
+   /// @return The trace flags, a combination of traceFlag.
+   inline byte getTraceFlags() const;
+   /// Sets the trace flags, a combination of traceFlag.
+   inline void setTraceFlags( byte flags );
+   /// @return True if TRACE_REQUESTED is set.
+   bool isTraced() const { return getTraceFlags() & TRACE_REQUESTED; }
+
+   /**
+    * Sets the time the request spent in the send queue of the sender.
+    * Stored with about 6% precision, saturates at about 8 minutes.
+    * @param timeMs The time in milli seconds.
+    */
+   inline void setTraceSendQueueTime( uint32 timeMs );
+   /// @return The send queue time in milli seconds.
+   inline uint32 getTraceSendQueueTime() const;
+
+   /**
+    * Sets the time the request waited in the module before processing.
+    * Stored like the send queue time.
+    * @param timeMs The time in milli seconds.
+    */
+   inline void setTraceModuleQueueTime( uint32 timeMs );
+   /// @return The module queue time in milli seconds.
+   inline uint32 getTraceModuleQueueTime() const;
+
+   /**
+    * Encodes a time into one byte, exact up to 31 ms and then with
+    * four bits of mantissa.
+    * @param timeMs The time in milli seconds.
+    * @return The encoded time.
+    */
+   static byte encodeTraceTime( uint32 timeMs );
+   /// @return The time encoded with encodeTraceTime, rounded down.
+   static uint32 decodeTraceTime( byte code );
       /**
        *    Get packetNbr.
        *    @return the part number of the packet.
@@ -1141,6 +1204,9 @@ class Packet: private NotCopyable
       /// True if the buffer should be deleted
       bool m_deleteBuffer;
 
+      /// True if the buffer belongs to the PacketBufferPool
+      bool m_pooledBuffer;
+
       /**
         *   Dumps the pakets data to stdout.
         *   @param startPos   Tells where the data starts used when
@@ -1309,6 +1375,20 @@ class Packet: private NotCopyable
       }
       
   private:
+      /**
+        *   Sets buffer to a new buffer from the PacketBufferPool
+        *   and bufSize to its capacity, which may be more than
+        *   bufLength.
+        *   @param bufLength The minimum size of the buffer.
+        */
+      void allocateBuffer( uint32 bufLength );
+
+      /**
+        *   Returns the buffer to the PacketBufferPool or deletes it,
+        *   if the packet owns it.
+        */
+      void freeBuffer();
+
       /**
         *   Pointer used by the PacketPool to maintain the packets
         *   allocated there.
@@ -1574,9 +1654,8 @@ inline Packet*
 Packet::getClone(bool fullBuffer) const
 {
    // Set the length. 
-   int newBufSize = fullBuffer ? getBufSize() : getLength();
-   byte* buff = reinterpret_cast< byte* > ( 
-      new uint32[ ( newBufSize + 3) >> 2 ] );
+   uint32 newBufSize = fullBuffer ? getBufSize() : getLength();
+   byte* buff = PacketBufferPool::allocate( newBufSize, newBufSize );
 
    // Only copy getLength() bytes to the new packet.
    memcpy( buff , getBuf(), getLength() );
@@ -1585,6 +1664,7 @@ Packet::getClone(bool fullBuffer) const
    result->length = getLength();
    result->m_arrivalTime = m_arrivalTime;
    result->m_deleteBuffer = true;
+   result->m_pooledBuffer = true;
    return result;
 }
 
@@ -2213,6 +2293,30 @@ void Packet::setCPUTime( uint32 timeMs ) {
    writeLong( PACKET_OFFSET_CPUTIME, timeMs );
 }
 
+byte Packet::getTraceFlags() const {
+   return readByte( PACKET_OFFSET_TRACEFLAGS );
+}
+
+void Packet::setTraceFlags( byte flags ) {
+   writeByte( PACKET_OFFSET_TRACEFLAGS, flags );
+}
+
+void Packet::setTraceSendQueueTime( uint32 timeMs ) {
+   writeByte( PACKET_OFFSET_TRACE_SENDQUEUE, encodeTraceTime( timeMs ) );
+}
+
+uint32 Packet::getTraceSendQueueTime() const {
+   return decodeTraceTime( readByte( PACKET_OFFSET_TRACE_SENDQUEUE ) );
+}
+
+void Packet::setTraceModuleQueueTime( uint32 timeMs ) {
+   writeByte( PACKET_OFFSET_TRACE_MODULEQUEUE, encodeTraceTime( timeMs ) );
+}
+
+uint32 Packet::getTraceModuleQueueTime() const {
+   return decodeTraceTime( readByte( PACKET_OFFSET_TRACE_MODULEQUEUE ) );
+}
+
 Packet::PacketID Packet::getPacketID() const { 
    return readShort(PACKET_OFFSET_PACKETID); 
 }
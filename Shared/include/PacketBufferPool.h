@@ -0,0 +1,142 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef PACKETBUFFERPOOL_H
+#define PACKETBUFFERPOOL_H
+
+#include "config.h"
+
+#include <iosfwd>
+
+/**
+ *   Size classed allocator for the buffers of the Packets.
+ *
+ *   The buffers are grouped in power of two size classes from
+ *   MIN_CLASS_SIZE up to MAX_CLASS_SIZE (which is large enough for
+ *   MAX_PACKET_SIZE). Each thread keeps a small cache of free buffers
+ *   per size class so that most allocations and deallocations do not
+ *   need any locking at all. When a thread cache runs empty or grows
+ *   too large, buffers are moved in batches to or from a global depot.
+ *   Buffers larger than MAX_CLASS_SIZE are allocated and deleted
+ *   directly.
+ *
+ *   The buffers are uint32 aligned, like the ones created with
+ *   MAKE_UINT32_ALIGNED_BYTE_BUFFER, but must be returned with
+ *   deallocate and never with delete.
+ *
+ *   The pool also remembers the largest size seen for each packet
+ *   subtype so that growing packets can be resized directly to the
+ *   size the packets of that type usually end up with.
+ *
+ *   At most 256 kB per size class is cached in each thread and
+ *   4 MB per size class in the depot.
+ */
+class PacketBufferPool {
+public:
+   /// The smallest size class.
+   static const uint32 MIN_CLASS_SIZE = 256;
+   /// The largest size class.
+   static const uint32 MAX_CLASS_SIZE = 65536;
+   /// The number of size classes, 256, 512, ..., 65536.
+   static const uint32 NBR_SIZE_CLASSES = 9;
+
+   /**
+    *   Statistics for the pool, summed over all threads.
+    *   The values are read without stopping the threads that
+    *   are using the pool so they are only approximate.
+    */
+   struct Statistics {
+      Statistics();
+
+      /// The number of allocations.
+      uint64 allocations;
+      /// Allocations served from the thread cache.
+      uint64 threadCacheHits;
+      /// Allocations served from the global depot.
+      uint64 depotHits;
+      /// Allocations that had to allocate new memory.
+      uint64 systemAllocations;
+      /// Allocations larger than MAX_CLASS_SIZE.
+      uint64 oversizeAllocations;
+      /// The number of deallocations.
+      uint64 deallocations;
+      /// Bytes currently handed out to packets.
+      int64 bytesInFlight;
+      /// Bytes in free buffers in the thread caches and the depot.
+      int64 bytesCached;
+
+      /// @return The part of the allocations not needing new memory, 0-1.
+      float getHitRate() const;
+   };
+
+   /**
+    *   Allocates a buffer of at least size bytes.
+    *
+    *   @param size     The minimum size of the buffer.
+    *   @param capacity Set to the real size of the returned buffer,
+    *                   which is the size rounded up to the size class.
+    *   @return A new uint32 aligned buffer, return it with deallocate.
+    */
+   static byte* allocate( uint32 size, uint32& capacity );
+
+   /**
+    *   Returns a buffer allocated with allocate.
+    *
+    *   @param buffer   The buffer to return, may be NULL.
+    *   @param capacity The capacity returned by allocate.
+    */
+   static void deallocate( byte* buffer, uint32 capacity );
+
+   /**
+    *   @param size The requested size.
+    *   @return The size of the buffer that allocate would return for
+    *           size.
+    */
+   static uint32 getCapacity( uint32 size );
+
+   /**
+    *   Remembers the final length of a packet of a subtype.
+    *
+    *   @param subType The subtype of the packet.
+    *   @param length  The length of the packet.
+    */
+   static void recordLength( uint16 subType, uint32 length );
+
+   /**
+    *   @param subType The subtype of the packet.
+    *   @return The size class of the largest packet of the subtype seen
+    *           so far or 0 if no packet of the type has been recorded.
+    */
+   static uint32 getSizeHint( uint16 subType );
+
+   /**
+    *   @return The statistics summed over all threads.
+    */
+   static Statistics getStatistics();
+
+   /**
+    *   Frees all buffers in the cache of the calling thread and in the
+    *   depot. Mainly for tests and for shrinking after load peaks.
+    */
+   static void trim();
+
+private:
+   /// Not to be created.
+   PacketBufferPool();
+};
+
+/// Prints the statistics on one line.
+std::ostream& operator << ( std::ostream& stream,
+                            const PacketBufferPool::Statistics& stats );
+
+#endif // PACKETBUFFERPOOL_H
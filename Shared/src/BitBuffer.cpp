@@ -28,20 +28,20 @@ BitBuffer::BitBuffer( uint8* bytes, uint32 size )
 BitBuffer::BitBuffer( const BitBuffer& other, bool shrinkToOffset )
       : SharedBuffer( other, shrinkToOffset )
 {
-   m_bitMask = other.m_bitMask;   
+   m_bitOffset = other.m_bitOffset;   
 }
 
 BitBuffer::BitBuffer( const SharedBuffer& other, bool shrinkToOffset )
       : SharedBuffer( other, shrinkToOffset )
 {
-   m_bitMask = 0x80;
+   m_bitOffset = 0;
 }
 
 void
 BitBuffer::reset()
 {
-   m_pos     = m_buf;
-   m_bitMask = 0x80;
+   m_pos       = m_buf;
+   m_bitOffset = 0;
    m_bytesOK = true;
 }
 
@@ -49,11 +49,11 @@ BitBuffer::reset()
 void
 BitBuffer::alignToByte()
 {
-   if ( m_bitMask != 0x80 ) {
+   if ( m_bitOffset != 0 ) {
       // Not done writing bits to this byte.
       // Skip to next one.
       ++m_pos;
    }
-   m_bitMask = 0x80;
+   m_bitOffset = 0;
    m_bytesOK = true;
 }
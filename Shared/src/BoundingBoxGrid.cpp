@@ -0,0 +1,201 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "BoundingBoxGrid.h"
+
+#include "MC2BoundingBox.h"
+
+#include <algorithm>
+
+namespace {
+
+/// @return True if the box crosses the date line or is invalid.
+inline bool isWrapping( const MC2BoundingBox& bbox ) {
+   return bbox.getMinLon() > bbox.getMaxLon() ||
+      bbox.getMinLat() > bbox.getMaxLat();
+}
+
+}
+
+BoundingBoxGrid::BoundingBoxGrid( uint32 cellSize )
+      : m_mark( 0 ),
+        m_cellSize( cellSize ),
+        m_autoCellSize( cellSize == 0 ) {
+}
+
+inline int32
+BoundingBoxGrid::getCell( int32 coord ) const {
+   // Round towards minus infinity so that cell 0 is not twice as large.
+   int64 cell = int64( coord ) / m_cellSize;
+   if ( coord < 0 && int64( coord ) % m_cellSize != 0 ) {
+      --cell;
+   }
+   return int32( cell );
+}
+
+inline uint32
+BoundingBoxGrid::getBucket( int32 cellLat, int32 cellLon ) {
+   return ( uint32( cellLat ) * 73856093u ^ uint32( cellLon ) * 19349663u ) &
+      ( NBR_BUCKETS - 1 );
+}
+
+inline void
+BoundingBoxGrid::found( uint32 index, std::vector<uint32>& values ) const {
+   if ( m_marks[ index ] != m_mark ) {
+      m_marks[ index ] = m_mark;
+      values.push_back( m_boxes[ index ].value );
+   }
+}
+
+void
+BoundingBoxGrid::newSearch() const {
+   if ( ++m_mark == 0 ) {
+      std::fill( m_marks.begin(), m_marks.end(), 0 );
+      m_mark = 1;
+   }
+}
+
+void
+BoundingBoxGrid::add( const MC2BoundingBox& bbox, uint32 value ) {
+   Box box;
+   box.minLat = bbox.getMinLat();
+   box.maxLat = bbox.getMaxLat();
+   box.minLon = bbox.getMinLon();
+   box.maxLon = bbox.getMaxLon();
+   box.value = value;
+   const uint32 index = m_boxes.size();
+   m_boxes.push_back( box );
+   m_marks.push_back( 0 );
+
+   if ( isWrapping( bbox ) ) {
+      m_largeBoxes.push_back( index );
+      return;
+   }
+
+   if ( m_cellSize == 0 ) {
+      int64 side = MAX( int64( box.maxLat ) - box.minLat,
+                        int64( box.maxLon ) - box.minLon );
+      m_cellSize = uint32( MIN( MAX( side * 2, int64( 1 ) ),
+                                int64( MAX_INT32 ) ) );
+   }
+
+   const int32 minCellLat = getCell( box.minLat );
+   const int32 maxCellLat = getCell( box.maxLat );
+   const int32 minCellLon = getCell( box.minLon );
+   const int32 maxCellLon = getCell( box.maxLon );
+   if ( ( int64( maxCellLat ) - minCellLat + 1 ) *
+        ( int64( maxCellLon ) - minCellLon + 1 ) > MAX_CELLS_PER_BOX ) {
+      m_largeBoxes.push_back( index );
+      return;
+   }
+
+   if ( m_buckets.empty() ) {
+      m_buckets.resize( NBR_BUCKETS );
+   }
+   for ( int32 cellLat = minCellLat; cellLat <= maxCellLat; ++cellLat ) {
+      for ( int32 cellLon = minCellLon; cellLon <= maxCellLon; ++cellLon ) {
+         std::vector<uint32>& bucket =
+            m_buckets[ getBucket( cellLat, cellLon ) ];
+         if ( bucket.empty() ) {
+            m_usedBuckets.push_back( getBucket( cellLat, cellLon ) );
+         }
+         bucket.push_back( index );
+      }
+   }
+}
+
+void
+BoundingBoxGrid::getOverlapping( const MC2BoundingBox& bbox,
+                                 std::vector<uint32>& values ) const {
+   if ( m_boxes.empty() ) {
+      return;
+   }
+   newSearch();
+
+   const int32 minLat = bbox.getMinLat();
+   const int32 maxLat = bbox.getMaxLat();
+   const int32 minLon = bbox.getMinLon();
+   const int32 maxLon = bbox.getMaxLon();
+   const bool wrapping = isWrapping( bbox );
+
+   // The boxes not in the cells.
+   for ( uint32 i = 0; i < m_largeBoxes.size(); ++i ) {
+      const Box& box = m_boxes[ m_largeBoxes[ i ] ];
+      if ( wrapping || box.minLon > box.maxLon || box.minLat > box.maxLat ||
+           ! ( box.maxLat < minLat || box.minLat > maxLat ||
+               box.maxLon < minLon || box.minLon > maxLon ) ) {
+         found( m_largeBoxes[ i ], values );
+      }
+   }
+
+   if ( m_buckets.empty() ) {
+      return;
+   }
+
+   const int32 minCellLat = wrapping ? 0 : getCell( minLat );
+   const int32 maxCellLat = wrapping ? 0 : getCell( maxLat );
+   const int32 minCellLon = wrapping ? 0 : getCell( minLon );
+   const int32 maxCellLon = wrapping ? 0 : getCell( maxLon );
+   if ( wrapping ||
+        ( int64( maxCellLat ) - minCellLat + 1 ) *
+        ( int64( maxCellLon ) - minCellLon + 1 ) > NBR_BUCKETS ) {
+      // Covers more cells than there are buckets, check all boxes.
+      for ( uint32 i = 0; i < m_boxes.size(); ++i ) {
+         const Box& box = m_boxes[ i ];
+         if ( wrapping ||
+              ! ( box.maxLat < minLat || box.minLat > maxLat ||
+                  box.maxLon < minLon || box.minLon > maxLon ) ) {
+            found( i, values );
+         }
+      }
+      return;
+   }
+
+   for ( int32 cellLat = minCellLat; cellLat <= maxCellLat; ++cellLat ) {
+      for ( int32 cellLon = minCellLon; cellLon <= maxCellLon; ++cellLon ) {
+         const std::vector<uint32>& bucket =
+            m_buckets[ getBucket( cellLat, cellLon ) ];
+         for ( uint32 i = 0; i < bucket.size(); ++i ) {
+            const Box& box = m_boxes[ bucket[ i ] ];
+            if ( ! ( box.maxLat < minLat || box.minLat > maxLat ||
+                     box.maxLon < minLon || box.minLon > maxLon ) ) {
+               found( bucket[ i ], values );
+            }
+         }
+      }
+   }
+}
+
+void
+BoundingBoxGrid::clear() {
+   for ( uint32 i = 0; i < m_usedBuckets.size(); ++i ) {
+      m_buckets[ m_usedBuckets[ i ] ].clear();
+   }
+   m_usedBuckets.clear();
+   m_largeBoxes.clear();
+   m_boxes.clear();
+   m_marks.clear();
+   if ( m_autoCellSize ) {
+      m_cellSize = 0;
+   }
+}
+
+uint32
+BoundingBoxGrid::size() const {
+   return m_boxes.size();
+}
+
+uint32
+BoundingBoxGrid::getCellSize() const {
+   return m_cellSize;
+}
@@ -0,0 +1,168 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "BoundingBoxTree.h"
+
+#include "MC2BoundingBox.h"
+
+#include <algorithm>
+#include <math.h>
+
+namespace {
+
+/// Twice the center longitude, avoids overflow.
+inline int64 centerLon2( int32 minLon, int32 maxLon ) {
+   return int64( minLon ) + maxLon;
+}
+
+/// Twice the center latitude, avoids overflow.
+inline int64 centerLat2( int32 minLat, int32 maxLat ) {
+   return int64( minLat ) + maxLat;
+}
+
+template <class BOX>
+struct LessCenterLon {
+   bool operator () ( const BOX& a, const BOX& b ) const {
+      return centerLon2( a.minLon, a.maxLon ) < 
+         centerLon2( b.minLon, b.maxLon );
+   }
+};
+
+template <class BOX>
+struct LessCenterLat {
+   bool operator () ( const BOX& a, const BOX& b ) const {
+      return centerLat2( a.minLat, a.maxLat ) < 
+         centerLat2( b.minLat, b.maxLat );
+   }
+};
+
+}
+
+BoundingBoxTree::BoundingBoxTree()
+      : m_levels( 1 ),
+        m_built( false ) {
+}
+
+void
+BoundingBoxTree::add( const MC2BoundingBox& bbox, uint32 value ) {
+   add( bbox.getMinLat(), bbox.getMaxLat(), 
+        bbox.getMinLon(), bbox.getMaxLon(), value );
+}
+
+void
+BoundingBoxTree::add( int32 minLat, int32 maxLat, 
+                      int32 minLon, int32 maxLon,
+                      uint32 value ) {
+   MC2_ASSERT( ! m_built );
+   Box box;
+   box.minLat = minLat;
+   box.maxLat = maxLat;
+   box.minLon = minLon;
+   box.maxLon = maxLon;
+   box.first = value;
+   box.count = 0;
+   m_levels.front().push_back( box );
+}
+
+uint32
+BoundingBoxTree::size() const {
+   return m_levels.front().size();
+}
+
+void
+BoundingBoxTree::packLevel( Level& boxes, Level& parents ) {
+   const uint32 nbrParents = ( boxes.size() + NODE_SIZE - 1 ) / NODE_SIZE;
+   const uint32 nbrSlices = 
+      uint32( ceil( sqrt( float64( nbrParents ) ) ) );
+   const uint32 sliceSize = nbrSlices * NODE_SIZE;
+
+   std::sort( boxes.begin(), boxes.end(), LessCenterLon<Box>() );
+   for ( uint32 start = 0; start < boxes.size(); start += sliceSize ) {
+      uint32 end = MIN( start + sliceSize, boxes.size() );
+      std::sort( boxes.begin() + start, boxes.begin() + end, 
+                 LessCenterLat<Box>() );
+   }
+
+   parents.clear();
+   parents.reserve( nbrParents );
+   for ( uint32 start = 0; start < boxes.size(); start += NODE_SIZE ) {
+      uint32 end = MIN( start + NODE_SIZE, boxes.size() );
+      Box parent = boxes[ start ];
+      for ( uint32 i = start + 1; i < end; ++i ) {
+         parent.minLat = MIN( parent.minLat, boxes[ i ].minLat );
+         parent.maxLat = MAX( parent.maxLat, boxes[ i ].maxLat );
+         parent.minLon = MIN( parent.minLon, boxes[ i ].minLon );
+         parent.maxLon = MAX( parent.maxLon, boxes[ i ].maxLon );
+      }
+      parent.first = start;
+      parent.count = end - start;
+      parents.push_back( parent );
+   }
+}
+
+void
+BoundingBoxTree::build() {
+   MC2_ASSERT( ! m_built );
+   m_built = true;
+   while ( m_levels.back().size() > 1 ) {
+      Level parents;
+      packLevel( m_levels.back(), parents );
+      m_levels.push_back( Level() );
+      m_levels.back().swap( parents );
+   }
+}
+
+void
+BoundingBoxTree::search( uint32 level, uint32 index,
+                         int32 minLat, int32 maxLat,
+                         int32 minLon, int32 maxLon,
+                         std::vector<uint32>& values ) const {
+   const Box& box = m_levels[ level ][ index ];
+   if ( box.maxLat < minLat || box.minLat > maxLat ||
+        box.maxLon < minLon || box.minLon > maxLon ) {
+      return;
+   }
+   if ( level == 0 ) {
+      values.push_back( box.first );
+      return;
+   }
+   for ( uint32 i = box.first; i < box.first + box.count; ++i ) {
+      search( level - 1, i, minLat, maxLat, minLon, maxLon, values );
+   }
+}
+
+void
+BoundingBoxTree::search( int32 minLat, int32 maxLat,
+                         int32 minLon, int32 maxLon,
+                         std::vector<uint32>& values ) const {
+   MC2_ASSERT( m_built );
+   const Level& top = m_levels.back();
+   for ( uint32 i = 0; i < top.size(); ++i ) {
+      search( m_levels.size() - 1, i, minLat, maxLat, minLon, maxLon, 
+              values );
+   }
+}
+
+void
+BoundingBoxTree::getContaining( int32 lat, int32 lon, 
+                                std::vector<uint32>& values ) const {
+   search( lat, lat, lon, lon, values );
+}
+
+void
+BoundingBoxTree::getOverlapping( const MC2BoundingBox& bbox,
+                                 std::vector<uint32>& values ) const {
+   search( bbox.getMinLat(), bbox.getMaxLat(), 
+           bbox.getMinLon(), bbox.getMaxLon(), values );
+}
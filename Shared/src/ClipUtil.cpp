@@ -14,6 +14,9 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include "config.h"
 
 #include "ClipUtil.h"
+#include "GeometryKernels.h"
+
+#include <algorithm>
 
 void
 ClipUtil::clipSegment( const MC2Point& prevVertex,
@@ -107,6 +110,22 @@ ClipUtil::clipToBoundary( const byte boundaryOutcode,
    
    resVertices.reserve(vertices.size());
    resOutcodes.reserve(outcodes.size());
+
+   if ( ( GeometryKernels::orBytes( &outcodes.front(), outcodes.size() ) &
+          boundaryOutcode ) == 0 ) {
+      // All vertices are inside the boundary. The result is the
+      // vertices starting from the second one, like the loop below
+      // would produce.
+      resVertices.insert( resVertices.end(),
+                          vertices.begin() + 1, vertices.end() );
+      resVertices.push_back( vertices.front() );
+      resOutcodes.insert( resOutcodes.end(),
+                          outcodes.begin() + 1, outcodes.end() );
+      resOutcodes.push_back( outcodes.front() );
+      vertices.clear();
+      outcodes.clear();
+      return (resVertices.size() > 2);
+   }
    
    // Previous outcode
    vector<byte>::const_iterator prevOcIt = outcodes.begin();
@@ -163,13 +182,26 @@ ClipUtil::clipPolyToBBoxFast( const MC2BoundingBox& bbox,
    }
    
    
-   vector<byte> outcodes1;
-   outcodes1.reserve(nbrVertices);
-   // Calculate the outcodes.
-   for ( vector<MC2Point>::const_iterator it = vertices.begin();
-         it != vertices.end(); ++it ) {
-      outcodes1.push_back( 
-         bbox.getCohenSutherlandOutcode( it->getY(), it->getX() ) );
+   vector<byte> outcodes1( nbrVertices );
+   // Calculate the outcodes. MC2Point is x (lon) followed by y (lat).
+   byte orCodes = 0;
+   byte andCodes = 0;
+   GeometryKernels::
+      computeOutcodes( bbox, &vertices.front().getX(), nbrVertices,
+                       GeometryKernels::LON_LAT,
+                       &outcodes1.front(), orCodes, andCodes );
+
+   if ( andCodes != 0 ) {
+      // All vertices are outside the same boundary.
+      vertices.clear();
+      return (false);
+   }
+   if ( orCodes == 0 ) {
+      // All vertices are inside. Each of the four boundaries
+      // would have moved the first vertex to the end.
+      std::rotate( vertices.begin(), vertices.begin() + 4 % nbrVertices,
+                   vertices.end() );
+      return (true);
    }
    
    vector<byte> outcodes2;
@@ -31,6 +31,7 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include "sockets.h"
 #include "Properties.h"
 #include "StringUtility.h"
+#include "AsyncLogHandler.h"
 
 void dumpHandler(int s)
 {
@@ -153,6 +154,8 @@ CommandlineOptionHandler::CommandlineOptionHandler( int argc, char** argv,
              propenv.c_str(), "Use given property file");
    addOption("-q", "--no-debug", presentVal, 0, &m_debugFlag,
              "F", "Turn of all debug output");
+   addOption("-A", "--async-log", presentVal, 0, &m_asyncLogFlag,
+             "F", "Write the log from a background thread");
    addOption( "-P", "--setproperty", stringVal, 1, &m_properties,
               "", "Add property to Properties. Use like this: "
               "\"BMC=2.4.,PPM=34,PPX=4\"" );
@@ -437,6 +440,18 @@ CommandlineOptionHandler::parse(bool handleErrors)
 
    MC2Logging::getInstance().setDebugOutput(!m_debugFlag);
 
+   if ( m_asyncLogFlag ) {
+      // Replace the default handler writing to stderr
+      MC2Logging& logging = MC2Logging::getInstance();
+      logging.deleteHandlers();
+      logging.addHandler( ( MC2Logging::LOGLEVEL_DEBUG | 
+                            MC2Logging::LOGLEVEL_INFO  | 
+                            MC2Logging::LOGLEVEL_WARN  |
+                            MC2Logging::LOGLEVEL_ERROR |
+                            MC2Logging::LOGLEVEL_FATAL ), 
+                          new AsyncLogHandler( stderr ) );
+   }
+
    return true;
 }
 
@@ -0,0 +1,470 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "config.h"
+
+#include "GeometryKernels.h"
+#include "MC2BoundingBox.h"
+
+#include <string.h>
+
+#if defined( __SSE2__ ) && ( defined( __x86_64__ ) || defined( __i386__ ) )
+#define HAVE_SSE2_KERNELS
+#include <emmintrin.h>
+#endif
+
+#if defined( HAVE_SSE2_KERNELS ) && defined( __GNUC__ ) && \
+   ( __GNUC__ > 4 || ( __GNUC__ == 4 && __GNUC_MINOR__ >= 9 ) )
+#define HAVE_AVX2_KERNELS
+#include <immintrin.h>
+#endif
+
+namespace GeometryKernels {
+
+namespace {
+
+/// One implementation of the kernels.
+struct Kernels {
+   kernel_t kernel;
+   void (*computeOutcodes)( const MC2BoundingBox& bbox,
+                            const int32* coords, uint32 nbr, order_t order,
+                            byte* outcodes, byte& orCodes, byte& andCodes );
+   byte (*orBytes)( const byte* data, uint32 nbr );
+   uint32 (*findLatCrossing)( const int32* coords, uint32 begin, uint32 end,
+                              order_t order, int32 lat );
+};
+
+/// @return The lat of coordinate i.
+inline int32 getLat( const int32* coords, uint32 i, order_t order ) {
+   return coords[ 2 * i + ( order == LAT_LON ? 0 : 1 ) ];
+}
+
+/// @return The lon of coordinate i.
+inline int32 getLon( const int32* coords, uint32 i, order_t order ) {
+   return coords[ 2 * i + ( order == LAT_LON ? 1 : 0 ) ];
+}
+
+/// @return True if edge i may cross lat, same test as insidePolygon.
+inline bool mayCross( const int32* coords, uint32 i, order_t order,
+                      int32 lat ) {
+   int32 d_lat1 = getLat( coords, i - 1, order ) - lat;
+   int32 d_lat2 = getLat( coords, i, order ) - lat;
+   return ( d_lat1 <= 0 && d_lat2 >= 0 ) || ( d_lat1 >= 0 && d_lat2 <= 0 );
+}
+
+////////////////////////////////////////////////////////////
+// Scalar
+////////////////////////////////////////////////////////////
+
+void computeOutcodesScalar( const MC2BoundingBox& bbox,
+                            const int32* coords, uint32 nbr, order_t order,
+                            byte* outcodes, byte& orCodes, byte& andCodes ) {
+   byte orAcc = 0;
+   byte andAcc = 0xff;
+   for ( uint32 i = 0; i < nbr; ++i ) {
+      byte code = bbox.getCohenSutherlandOutcode( getLat( coords, i, order ),
+                                                  getLon( coords, i, order ) );
+      outcodes[ i ] = code;
+      orAcc |= code;
+      andAcc &= code;
+   }
+   orCodes = orAcc;
+   andCodes = nbr > 0 ? andAcc : 0;
+}
+
+byte orBytesScalar( const byte* data, uint32 nbr ) {
+   byte res = 0;
+   for ( uint32 i = 0; i < nbr; ++i ) {
+      res |= data[ i ];
+   }
+   return res;
+}
+
+uint32 findLatCrossingScalar( const int32* coords, uint32 begin, uint32 end,
+                              order_t order, int32 lat ) {
+   for ( uint32 i = begin; i < end; ++i ) {
+      if ( mayCross( coords, i, order, lat ) ) {
+         return i;
+      }
+   }
+   return end;
+}
+
+const Kernels scalarKernels = {
+   SCALAR,
+   computeOutcodesScalar,
+   orBytesScalar,
+   findLatCrossingScalar
+};
+
+#ifdef HAVE_SSE2_KERNELS
+
+////////////////////////////////////////////////////////////
+// SSE2, 4 coordinates at a time
+////////////////////////////////////////////////////////////
+
+/// Splits 4 coordinates into the first and second int32 of each.
+inline void split4( const int32* coords, __m128i& first, __m128i& second ) {
+   __m128i a = _mm_loadu_si128( (const __m128i*)coords );
+   __m128i b = _mm_loadu_si128( (const __m128i*)( coords + 4 ) );
+   a = _mm_shuffle_epi32( a, _MM_SHUFFLE( 3, 1, 2, 0 ) );
+   b = _mm_shuffle_epi32( b, _MM_SHUFFLE( 3, 1, 2, 0 ) );
+   first = _mm_unpacklo_epi64( a, b );
+   second = _mm_unpackhi_epi64( a, b );
+}
+
+/// @return The lats of 4 coordinates.
+inline __m128i lat4( const int32* coords, order_t order ) {
+   __m128i first, second;
+   split4( coords, first, second );
+   return order == LAT_LON ? first : second;
+}
+
+/// Or:s the 4 int32 of v together.
+inline uint32 horizontalOr( __m128i v ) {
+   v = _mm_or_si128( v, _mm_shuffle_epi32( v, _MM_SHUFFLE( 1, 0, 3, 2 ) ) );
+   v = _mm_or_si128( v, _mm_shuffle_epi32( v, _MM_SHUFFLE( 2, 3, 0, 1 ) ) );
+   return _mm_cvtsi128_si32( v );
+}
+
+/// And:s the 4 int32 of v together.
+inline uint32 horizontalAnd( __m128i v ) {
+   v = _mm_and_si128( v, _mm_shuffle_epi32( v, _MM_SHUFFLE( 1, 0, 3, 2 ) ) );
+   v = _mm_and_si128( v, _mm_shuffle_epi32( v, _MM_SHUFFLE( 2, 3, 0, 1 ) ) );
+   return _mm_cvtsi128_si32( v );
+}
+
+/// The outcodes of 4 coordinates, like getCohenSutherlandOutcode.
+inline __m128i outcodes4( __m128i lat, __m128i lon,
+                          __m128i minLat, __m128i maxLat,
+                          __m128i minLon, __m128i maxLon ) {
+   const __m128i zero = _mm_setzero_si128();
+   // lon is compared with wrap around, lat is not.
+   __m128i left = _mm_cmplt_epi32( _mm_sub_epi32( lon, minLon ), zero );
+   __m128i right = _mm_andnot_si128( 
+      left, _mm_cmpgt_epi32( _mm_sub_epi32( lon, maxLon ), zero ) );
+   __m128i bottom = _mm_cmplt_epi32( lat, minLat );
+   __m128i top = _mm_andnot_si128( bottom, _mm_cmpgt_epi32( lat, maxLat ) );
+   return _mm_or_si128( 
+      _mm_or_si128( _mm_and_si128( left, _mm_set1_epi32( 1 ) ),
+                    _mm_and_si128( right, _mm_set1_epi32( 2 ) ) ),
+      _mm_or_si128( _mm_and_si128( bottom, _mm_set1_epi32( 4 ) ),
+                    _mm_and_si128( top, _mm_set1_epi32( 8 ) ) ) );
+}
+
+void computeOutcodesSSE2( const MC2BoundingBox& bbox,
+                          const int32* coords, uint32 nbr, order_t order,
+                          byte* outcodes, byte& orCodes, byte& andCodes ) {
+   const __m128i minLat = _mm_set1_epi32( bbox.getMinLat() );
+   const __m128i maxLat = _mm_set1_epi32( bbox.getMaxLat() );
+   const __m128i minLon = _mm_set1_epi32( bbox.getMinLon() );
+   const __m128i maxLon = _mm_set1_epi32( bbox.getMaxLon() );
+   __m128i orAcc = _mm_setzero_si128();
+   __m128i andAcc = _mm_set1_epi32( 0xff );
+   uint32 i = 0;
+   for ( ; i + 4 <= nbr; i += 4 ) {
+      __m128i first, second;
+      split4( coords + 2 * i, first, second );
+      __m128i codes = order == LAT_LON ?
+         outcodes4( first, second, minLat, maxLat, minLon, maxLon ) :
+         outcodes4( second, first, minLat, maxLat, minLon, maxLon );
+      orAcc = _mm_or_si128( orAcc, codes );
+      andAcc = _mm_and_si128( andAcc, codes );
+      // The codes fit in a byte, pack them.
+      __m128i packed = _mm_packs_epi32( codes, codes );
+      packed = _mm_packus_epi16( packed, packed );
+      uint32 four = _mm_cvtsi128_si32( packed );
+      memcpy( outcodes + i, &four, 4 );
+   }
+   byte tailOr, tailAnd;
+   computeOutcodesScalar( bbox, coords + 2 * i, nbr - i, order,
+                          outcodes + i, tailOr, tailAnd );
+   orCodes = horizontalOr( orAcc ) | tailOr;
+   andCodes = horizontalAnd( andAcc );
+   if ( i < nbr ) {
+      andCodes &= tailAnd;
+   }
+   if ( nbr == 0 ) {
+      andCodes = 0;
+   }
+}
+
+byte orBytesSSE2( const byte* data, uint32 nbr ) {
+   __m128i acc = _mm_setzero_si128();
+   uint32 i = 0;
+   for ( ; i + 16 <= nbr; i += 16 ) {
+      acc = _mm_or_si128( acc, _mm_loadu_si128( (const __m128i*)( data + i ) ) );
+   }
+   uint32 res = horizontalOr( acc );
+   res |= res >> 16;
+   res |= res >> 8;
+   return byte( res ) | orBytesScalar( data + i, nbr - i );
+}
+
+uint32 findLatCrossingSSE2( const int32* coords, uint32 begin, uint32 end,
+                            order_t order, int32 lat ) {
+   const __m128i latV = _mm_set1_epi32( lat );
+   const __m128i zero = _mm_setzero_si128();
+   uint32 i = begin;
+   for ( ; i + 4 <= end; i += 4 ) {
+      // The edges i to i + 3 go from coordinates i - 1 .. i + 2
+      // to i .. i + 3.
+      __m128i d1 = _mm_sub_epi32( lat4( coords + 2 * ( i - 1 ), order ),
+                                  latV );
+      __m128i d2 = _mm_sub_epi32( lat4( coords + 2 * i, order ), latV );
+      // The edges with both ends above or both below can not cross.
+      __m128i above = _mm_and_si128( _mm_cmpgt_epi32( d1, zero ),
+                                     _mm_cmpgt_epi32( d2, zero ) );
+      __m128i below = _mm_and_si128( _mm_cmplt_epi32( d1, zero ),
+                                     _mm_cmplt_epi32( d2, zero ) );
+      if ( _mm_movemask_epi8( _mm_or_si128( above, below ) ) != 0xffff ) {
+         break;
+      }
+   }
+   return findLatCrossingScalar( coords, i, end, order, lat );
+}
+
+const Kernels sse2Kernels = {
+   SSE2,
+   computeOutcodesSSE2,
+   orBytesSSE2,
+   findLatCrossingSSE2
+};
+
+#endif // HAVE_SSE2_KERNELS
+
+#ifdef HAVE_AVX2_KERNELS
+
+////////////////////////////////////////////////////////////
+// AVX2, 8 coordinates at a time
+////////////////////////////////////////////////////////////
+
+#define AVX2_FUNCTION __attribute__(( target( "avx2" ) ))
+
+/// Splits 8 coordinates into the first and second int32 of each.
+AVX2_FUNCTION
+inline void split8( const int32* coords, __m256i& first, __m256i& second ) {
+   __m256i a = _mm256_loadu_si256( (const __m256i*)coords );
+   __m256i b = _mm256_loadu_si256( (const __m256i*)( coords + 8 ) );
+   // f0 f1 s0 s1 | f2 f3 s2 s3 and f4 f5 s4 s5 | f6 f7 s6 s7
+   a = _mm256_shuffle_epi32( a, _MM_SHUFFLE( 3, 1, 2, 0 ) );
+   b = _mm256_shuffle_epi32( b, _MM_SHUFFLE( 3, 1, 2, 0 ) );
+   // f0 f1 f4 f5 | f2 f3 f6 f7, then in order.
+   first = _mm256_permute4x64_epi64( _mm256_unpacklo_epi64( a, b ),
+                                     _MM_SHUFFLE( 3, 1, 2, 0 ) );
+   second = _mm256_permute4x64_epi64( _mm256_unpackhi_epi64( a, b ),
+                                      _MM_SHUFFLE( 3, 1, 2, 0 ) );
+}
+
+/// @return The lats of 8 coordinates.
+AVX2_FUNCTION
+inline __m256i lat8( const int32* coords, order_t order ) {
+   __m256i first, second;
+   split8( coords, first, second );
+   return order == LAT_LON ? first : second;
+}
+
+/// The outcodes of 8 coordinates, like getCohenSutherlandOutcode.
+AVX2_FUNCTION
+inline __m256i outcodes8( __m256i lat, __m256i lon,
+                          __m256i minLat, __m256i maxLat,
+                          __m256i minLon, __m256i maxLon ) {
+   const __m256i zero = _mm256_setzero_si256();
+   __m256i left = _mm256_cmpgt_epi32( zero, _mm256_sub_epi32( lon, minLon ) );
+   __m256i right = _mm256_andnot_si256( 
+      left, _mm256_cmpgt_epi32( _mm256_sub_epi32( lon, maxLon ), zero ) );
+   __m256i bottom = _mm256_cmpgt_epi32( minLat, lat );
+   __m256i top = _mm256_andnot_si256( bottom, 
+                                      _mm256_cmpgt_epi32( lat, maxLat ) );
+   return _mm256_or_si256( 
+      _mm256_or_si256( _mm256_and_si256( left, _mm256_set1_epi32( 1 ) ),
+                       _mm256_and_si256( right, _mm256_set1_epi32( 2 ) ) ),
+      _mm256_or_si256( _mm256_and_si256( bottom, _mm256_set1_epi32( 4 ) ),
+                       _mm256_and_si256( top, _mm256_set1_epi32( 8 ) ) ) );
+}
+
+AVX2_FUNCTION
+void computeOutcodesAVX2( const MC2BoundingBox& bbox,
+                          const int32* coords, uint32 nbr, order_t order,
+                          byte* outcodes, byte& orCodes, byte& andCodes ) {
+   const __m256i minLat = _mm256_set1_epi32( bbox.getMinLat() );
+   const __m256i maxLat = _mm256_set1_epi32( bbox.getMaxLat() );
+   const __m256i minLon = _mm256_set1_epi32( bbox.getMinLon() );
+   const __m256i maxLon = _mm256_set1_epi32( bbox.getMaxLon() );
+   __m256i orAcc = _mm256_setzero_si256();
+   __m256i andAcc = _mm256_set1_epi32( 0xff );
+   uint32 i = 0;
+   for ( ; i + 8 <= nbr; i += 8 ) {
+      __m256i first, second;
+      split8( coords + 2 * i, first, second );
+      __m256i codes = order == LAT_LON ?
+         outcodes8( first, second, minLat, maxLat, minLon, maxLon ) :
+         outcodes8( second, first, minLat, maxLat, minLon, maxLon );
+      orAcc = _mm256_or_si256( orAcc, codes );
+      andAcc = _mm256_and_si256( andAcc, codes );
+      __m128i packed = _mm_packs_epi32( _mm256_castsi256_si128( codes ),
+                                        _mm256_extracti128_si256( codes, 1 ) );
+      packed = _mm_packus_epi16( packed, packed );
+      _mm_storel_epi64( (__m128i*)( outcodes + i ), packed );
+   }
+   __m128i orHalf = _mm_or_si128( _mm256_castsi256_si128( orAcc ),
+                                  _mm256_extracti128_si256( orAcc, 1 ) );
+   __m128i andHalf = _mm_and_si128( _mm256_castsi256_si128( andAcc ),
+                                    _mm256_extracti128_si256( andAcc, 1 ) );
+   byte tailOr, tailAnd;
+   computeOutcodesScalar( bbox, coords + 2 * i, nbr - i, order,
+                          outcodes + i, tailOr, tailAnd );
+   orCodes = horizontalOr( orHalf ) | tailOr;
+   andCodes = horizontalAnd( andHalf );
+   if ( i < nbr ) {
+      andCodes &= tailAnd;
+   }
+   if ( nbr == 0 ) {
+      andCodes = 0;
+   }
+}
+
+AVX2_FUNCTION
+byte orBytesAVX2( const byte* data, uint32 nbr ) {
+   __m256i acc = _mm256_setzero_si256();
+   uint32 i = 0;
+   for ( ; i + 32 <= nbr; i += 32 ) {
+      acc = _mm256_or_si256( 
+         acc, _mm256_loadu_si256( (const __m256i*)( data + i ) ) );
+   }
+   uint32 res = horizontalOr( _mm_or_si128( 
+                                 _mm256_castsi256_si128( acc ),
+                                 _mm256_extracti128_si256( acc, 1 ) ) );
+   res |= res >> 16;
+   res |= res >> 8;
+   return byte( res ) | orBytesScalar( data + i, nbr - i );
+}
+
+AVX2_FUNCTION
+uint32 findLatCrossingAVX2( const int32* coords, uint32 begin, uint32 end,
+                            order_t order, int32 lat ) {
+   const __m256i latV = _mm256_set1_epi32( lat );
+   const __m256i zero = _mm256_setzero_si256();
+   uint32 i = begin;
+   for ( ; i + 8 <= end; i += 8 ) {
+      __m256i d1 = _mm256_sub_epi32( lat8( coords + 2 * ( i - 1 ), order ),
+                                     latV );
+      __m256i d2 = _mm256_sub_epi32( lat8( coords + 2 * i, order ), latV );
+      __m256i above = _mm256_and_si256( _mm256_cmpgt_epi32( d1, zero ),
+                                        _mm256_cmpgt_epi32( d2, zero ) );
+      __m256i below = _mm256_and_si256( _mm256_cmpgt_epi32( zero, d1 ),
+                                        _mm256_cmpgt_epi32( zero, d2 ) );
+      if ( uint32( _mm256_movemask_epi8( _mm256_or_si256( above, below ) ) ) 
+           != 0xffffffff ) {
+         break;
+      }
+   }
+   return findLatCrossingScalar( coords, i, end, order, lat );
+}
+
+const Kernels avx2Kernels = {
+   AVX2,
+   computeOutcodesAVX2,
+   orBytesAVX2,
+   findLatCrossingAVX2
+};
+
+#endif // HAVE_AVX2_KERNELS
+
+/// @return The kernels for kernel or NULL if not supported.
+const Kernels* getKernels( kernel_t kernel ) {
+   switch ( kernel ) {
+      case SCALAR:
+         return &scalarKernels;
+      case SSE2:
+#ifdef HAVE_SSE2_KERNELS
+         return &sse2Kernels;
+#else
+         return NULL;
+#endif
+      case AVX2:
+#ifdef HAVE_AVX2_KERNELS
+         __builtin_cpu_init();
+         if ( __builtin_cpu_supports( "avx2" ) ) {
+            return &avx2Kernels;
+         }
+#endif
+         return NULL;
+   }
+   return NULL;
+}
+
+/// @return The best kernels for the cpu.
+const Kernels* getBestKernels() {
+   for ( int kernel = AVX2; kernel > SCALAR; --kernel ) {
+      const Kernels* kernels = getKernels( kernel_t( kernel ) );
+      if ( kernels != NULL ) {
+         return kernels;
+      }
+   }
+   return &scalarKernels;
+}
+
+/// The kernels in use. Set at static initialization.
+const Kernels* currentKernels = getBestKernels();
+
+/// @return The kernels in use.
+inline const Kernels& kernels() {
+   return *currentKernels;
+}
+
+}
+
+kernel_t getKernel() {
+   return kernels().kernel;
+}
+
+bool setKernel( kernel_t kernel ) {
+   const Kernels* newKernels = getKernels( kernel );
+   if ( newKernels == NULL ) {
+      return false;
+   }
+   currentKernels = newKernels;
+   return true;
+}
+
+const char* getKernelName( kernel_t kernel ) {
+   switch ( kernel ) {
+      case SCALAR:
+         return "scalar";
+      case SSE2:
+         return "SSE2";
+      case AVX2:
+         return "AVX2";
+   }
+   return "unknown";
+}
+
+void computeOutcodes( const MC2BoundingBox& bbox,
+                      const int32* coords, uint32 nbr, order_t order,
+                      byte* outcodes, byte& orCodes, byte& andCodes ) {
+   kernels().computeOutcodes( bbox, coords, nbr, order,
+                              outcodes, orCodes, andCodes );
+}
+
+byte orBytes( const byte* data, uint32 nbr ) {
+   return kernels().orBytes( data, nbr );
+}
+
+uint32 findLatCrossing( const int32* coords, uint32 begin, uint32 end,
+                        order_t order, int32 lat ) {
+   return kernels().findLatCrossing( coords, begin, end, order, lat );
+}
+
+}
@@ -15,6 +15,7 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include "GfxConstants.h"
 #include "MC2BoundingBox.h"
 #include "ClipUtil.h"
+#include "GeometryKernels.h"
 #include "InsideUtil.h"
 #include "GnuPlotDump.h"
 #include "Intersect.h"
@@ -1490,13 +1491,25 @@ GfxUtility::clipPolyToBBoxFast( const MC2BoundingBox* bbox,
    }
   
  
-   vector<byte> outcodes1;
-   outcodes1.reserve(nbrVertices);
-   // Calculate the outcodes.
-   for ( vector<POINT>::const_iterator it = vertices.begin();
-         it != vertices.end(); ++it ) {
-      outcodes1.push_back( 
-            bbox->getCohenSutherlandOutcode( it->y, it->x ) );
+   vector<byte> outcodes1( nbrVertices );
+   // Calculate the outcodes. POINT is x (lon) followed by y (lat).
+   byte orCodes = 0;
+   byte andCodes = 0;
+   GeometryKernels::computeOutcodes( *bbox, &vertices.front().x, nbrVertices,
+                                     GeometryKernels::LON_LAT,
+                                     &outcodes1.front(), orCodes, andCodes );
+
+   if ( andCodes != 0 ) {
+      // All vertices are outside the same boundary.
+      vertices.clear();
+      return (false);
+   }
+   if ( orCodes == 0 ) {
+      // All vertices are inside. Each of the four boundaries
+      // would have moved the first vertex to the end.
+      std::rotate( vertices.begin(), vertices.begin() + 4 % nbrVertices,
+                   vertices.end() );
+      return (true);
    }
 
    vector<byte> outcodes2;
@@ -2951,6 +2964,22 @@ GfxUtility::clipToBoundary( const byte boundaryOutcode,
    resVertices.reserve(vertices.size());
    resOutcodes.reserve(outcodes.size());
 
+   if ( ( GeometryKernels::orBytes( &outcodes.front(), outcodes.size() ) &
+          boundaryOutcode ) == 0 ) {
+      // All vertices are inside the boundary. The result is the
+      // vertices starting from the second one, like the loop below
+      // would produce.
+      resVertices.insert( resVertices.end(),
+                          vertices.begin() + 1, vertices.end() );
+      resVertices.push_back( vertices.front() );
+      resOutcodes.insert( resOutcodes.end(),
+                          outcodes.begin() + 1, outcodes.end() );
+      resOutcodes.push_back( outcodes.front() );
+      vertices.clear();
+      outcodes.clear();
+      return (resVertices.size() > 2);
+   }
+
    // Previous outcode
    vector<byte>::const_iterator prevOcIt = outcodes.begin();
    bool prevInside = (((*prevOcIt) & boundaryOutcode) == 0);
@@ -0,0 +1,182 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "LatencyStatistics.h"
+
+#include "Packet.h"
+
+#include <iostream>
+#include <sstream>
+
+LatencyStatistics::Histogram::Histogram():
+   m_count( 0 ),
+   m_max( 0 ),
+   m_sum( 0 )
+{
+   for ( uint32 i = 0; i < NBR_BUCKETS; ++i ) {
+      m_buckets[ i ] = 0;
+   }
+}
+
+uint32
+LatencyStatistics::Histogram::getBucketIndex( uint32 timeMs )
+{
+   uint32 index = 0;
+   while ( timeMs != 0 && index < NBR_BUCKETS - 1 ) {
+      timeMs >>= 1;
+      ++index;
+   }
+   return index;
+}
+
+void
+LatencyStatistics::Histogram::add( uint32 timeMs )
+{
+   ++m_buckets[ getBucketIndex( timeMs ) ];
+   ++m_count;
+   m_sum += timeMs;
+   m_max = MAX( m_max, timeMs );
+}
+
+uint32
+LatencyStatistics::Histogram::getMean() const
+{
+   if ( m_count == 0 ) {
+      return 0;
+   }
+   return m_sum / m_count;
+}
+
+uint32
+LatencyStatistics::Histogram::getPercentile( float fraction ) const
+{
+   // The number of times at or below the percentile, at least one.
+   uint32 rank = MAX( 1u, uint32( fraction * m_count + 0.5f ) );
+   uint32 seen = 0;
+   for ( uint32 i = 0; i < NBR_BUCKETS - 1; ++i ) {
+      seen += m_buckets[ i ];
+      if ( seen >= rank ) {
+         return MIN( ( 1u << i ) - 1, m_max );
+      }
+   }
+   return m_max;
+}
+
+LatencyStatistics::LatencyStatistics( uint32 logInterval ):
+   m_logTimer( logInterval )
+{
+}
+
+LatencyStatistics&
+LatencyStatistics::getInstance()
+{
+   static LatencyStatistics instance;
+   return instance;
+}
+
+void
+LatencyStatistics::add( uint16 subType, stage_t stage, uint32 timeMs )
+{
+   {
+      ISABSyncBeforeInit sync( m_mutex );
+      m_stats[ subType ].stages[ stage ].add( timeMs );
+   }
+   logIfDue();
+}
+
+LatencyStatistics::StatisticsMap
+LatencyStatistics::getStatistics() const
+{
+   ISABSyncBeforeInit sync( m_mutex );
+   return m_stats;
+}
+
+void
+LatencyStatistics::clear()
+{
+   ISABSyncBeforeInit sync( m_mutex );
+   m_stats.clear();
+}
+
+void
+LatencyStatistics::logIfDue()
+{
+   StatisticsMap stats;
+   {
+      ISABSyncBeforeInit sync( m_mutex );
+      if ( ! m_logTimer.isDue() ) {
+         return;
+      }
+      stats = m_stats;
+   }
+
+   std::ostringstream summary;
+   print( summary, stats );
+   // Log line by line to get the log prefix on each line.
+   std::istringstream lines( summary.str() );
+   MC2String line;
+   while ( std::getline( lines, line ) ) {
+      mc2log << info << "[LatencyStatistics] " << line << endl;
+   }
+}
+
+void
+LatencyStatistics::print( std::ostream& stream ) const
+{
+   print( stream, getStatistics() );
+}
+
+void
+LatencyStatistics::print( std::ostream& stream, const StatisticsMap& stats )
+{
+   for ( StatisticsMap::const_iterator it = stats.begin();
+         it != stats.end(); ++it ) {
+      stream << Packet::getSubTypeAsString( it->first ) << ":";
+      for ( uint32 s = 0; s < NBR_STAGES; ++s ) {
+         const Histogram& hist = it->second.stages[ s ];
+         if ( hist.getCount() == 0 ) {
+            continue;
+         }
+         stream << " " << getStageName( stage_t( s ) )
+                << " n " << hist.getCount()
+                << " p50 " << hist.getPercentile( 0.5 )
+                << " p90 " << hist.getPercentile( 0.9 )
+                << " p99 " << hist.getPercentile( 0.99 )
+                << " max " << hist.getMax() << " ms;";
+      }
+      stream << endl;
+   }
+}
+
+const char*
+LatencyStatistics::getStageName( stage_t stage )
+{
+   switch ( stage ) {
+      case SERVER_SEND_QUEUE:
+         return "send queue";
+      case NETWORK:
+         return "network";
+      case MODULE_QUEUE:
+         return "module queue";
+      case PROCESSING:
+         return "processing";
+      case REPLY_QUEUE:
+         return "reply queue";
+      case TOTAL:
+         return "total";
+      case NBR_STAGES:
+         break;
+   }
+   return "unknown";
+}
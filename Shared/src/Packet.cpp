@@ -21,6 +21,7 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include "Properties.h"
 #include "IPnPort.h"
 #include "PacketDump.h"
+#include "PacketBufferPool.h"
 
 #ifdef _WIN32
    #define TRACE printf
@@ -36,14 +37,12 @@ const Packet::MapID Packet::MAX_MAP_ID = MAX_UINT32;
 Packet::Packet(uint32 bufLength):
    m_arrivalTime( 0 )
 {
-   m_deleteBuffer = true;
    // Cannot allocate Packet smaller than the header, please
    MC2_ASSERT( bufLength >= HEADER_SIZE );
   
-   this->bufSize = bufLength;
    this->length = HEADER_SIZE;
    // Make an aligned buffer
-   buffer = MAKE_UINT32_ALIGNED_BYTE_BUFFER( bufLength );
+   allocateBuffer( bufLength );
    // Zero the header (valgrind will be happier)
    memset(buffer, 0, bufLength/*HEADER_SIZE*/);
    
@@ -63,6 +62,7 @@ Packet::Packet(byte* buf, uint32 bufLength, bool nodelete ):
    this->bufSize = bufLength;
    this->length = bufLength;
    m_deleteBuffer = !nodelete;
+   m_pooledBuffer = false;
    buffer = buf;
    if ( m_deleteBuffer ) {
       setPacketTag(DEFAULT_PACKET_TAG);
@@ -80,13 +80,11 @@ Packet::Packet( uint32 bufLength,
 {
    // Cannot allocate Packet smaller than the header, please
    MC2_ASSERT( bufLength >= HEADER_SIZE );
-   m_deleteBuffer = true;
-   buffer = MAKE_UINT32_ALIGNED_BYTE_BUFFER( bufLength );
+   allocateBuffer( bufLength );
    
    // Zero the header (valgrind will be happier)
    memset(buffer, 0, bufLength/*HEADER_SIZE*/);
    
-   this->bufSize = bufLength;
    this->length = HEADER_SIZE;
    setPacketTag(DEFAULT_PACKET_TAG);
    setSubType(subType);
@@ -112,12 +110,10 @@ Packet::Packet(   uint32 bufLength,
 {
    // Cannot allocate Packet smaller than the header, please
    MC2_ASSERT( bufLength >= HEADER_SIZE );
-   m_deleteBuffer = true;
    // Make a longword-aligned buffer
-   buffer = MAKE_UINT32_ALIGNED_BYTE_BUFFER( bufLength );
+   allocateBuffer( bufLength );
    // Zero the header (valgrind will be happier)
    memset(buffer, 0, HEADER_SIZE);
-   this->bufSize = bufLength;
    this->length = HEADER_SIZE;
    setPacketTag(DEFAULT_PACKET_TAG);
    setSubType(subType);
@@ -146,12 +142,10 @@ Packet::Packet(   uint32 bufLength,
 {
    // Cannot allocate Packet smaller than the header, please
    MC2_ASSERT( bufLength >= HEADER_SIZE );
-   m_deleteBuffer = true;
    // Make a longword-aligned buffer
-   buffer = MAKE_UINT32_ALIGNED_BYTE_BUFFER( bufLength );
+   allocateBuffer( bufLength );
    // Zero the header (valgrind will be happier)
    memset(buffer, 0, HEADER_SIZE);
-   this->bufSize = bufLength;
    this->length = HEADER_SIZE;
    setPacketTag(DEFAULT_PACKET_TAG);
    setSubType(subType);
@@ -199,7 +193,29 @@ Packet::getTCPLimitSize()
 
 Packet::~Packet() 
 {
-   if ( m_deleteBuffer ) {
+   if ( m_deleteBuffer && m_pooledBuffer ) {
+      PacketBufferPool::recordLength( getSubType(), getLength() );
+   }
+   freeBuffer();
+}
+
+void
+Packet::allocateBuffer( uint32 bufLength )
+{
+   buffer = PacketBufferPool::allocate( bufLength, bufSize );
+   m_deleteBuffer = true;
+   m_pooledBuffer = true;
+}
+
+void
+Packet::freeBuffer()
+{
+   if ( ! m_deleteBuffer ) {
+      return;
+   }
+   if ( m_pooledBuffer ) {
+      PacketBufferPool::deallocate( buffer, bufSize );
+   } else {
       delete [] (uint32 *)buffer;
    }
 }
@@ -207,7 +223,13 @@ Packet::~Packet()
 const char* 
 Packet::getSubTypeAsString() const
 {
-   packetType typ = getSubType();
+   return getSubTypeAsString( getSubType() );
+}
+
+const char*
+Packet::getSubTypeAsString( uint16 subType )
+{
+   packetType typ = packetType( subType );
    
    switch( typ ) {
 
@@ -649,27 +671,60 @@ Packet::getSubTypeAsString() const
    // Cannot happen. Yes with gcc 2.96, it can.
    static char tempString[32];
    sprintf( tempString, "unknown typenumber %d", 
-            getSubType() );
+            subType );
    return tempString;
 }
 
+byte
+Packet::encodeTraceTime( uint32 timeMs )
+{
+   if ( timeMs < 32 ) {
+      return timeMs;
+   }
+   // Shift until the mantissa is 16-31, the top bit is implicit.
+   uint32 shift = 1;
+   while ( ( timeMs >> shift ) >= 32 ) {
+      ++shift;
+   }
+   if ( shift > 14 ) {
+      return MAX_UINT8;
+   }
+   return ( shift + 1 ) * 16 + ( ( timeMs >> shift ) - 16 );
+}
+
+uint32
+Packet::decodeTraceTime( byte code )
+{
+   if ( code < 32 ) {
+      return code;
+   }
+   return ( ( code % 16 ) + 16 ) << ( code / 16 - 1 );
+}
+
 void 
 Packet::resize( uint32 newSize ) {
    if ( newSize < getLength() ) {
       newSize = getLength();
    }
-   bufSize = newSize;
-   byte* tmpBuff = MAKE_UINT32_ALIGNED_BYTE_BUFFER( bufSize );
+   if ( newSize > bufSize ) {
+      // Packets of this type have grown larger before, go there at once
+      // instead of growing a little at a time.
+      newSize = MAX( newSize, PacketBufferPool::getSizeHint( getSubType() ) );
+   }
+   uint32 newBufSize = 0;
+   byte* tmpBuff = PacketBufferPool::allocate( newSize, newBufSize );
    // Copy old data
    memcpy( tmpBuff, buffer, getLength() );
-   if ( m_deleteBuffer ) {      
-      delete[] buffer;
-   } else {
+   if ( ! m_deleteBuffer ) {
       mc2log << warn << "[Packet]: Resizing packet that doesn't own buffer"
              << endl;
       MC2_ASSERT( false );
    }
+   freeBuffer();
    buffer = tmpBuff;
+   bufSize = newBufSize;
+   m_deleteBuffer = true;
+   m_pooledBuffer = true;
 }
 
 IPnPort
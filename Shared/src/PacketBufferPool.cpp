@@ -0,0 +1,395 @@
+/*
+Copyright (c) 1999 - 2010, Vodafone Group Services Ltd
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of the Vodafone Group Services Ltd nor the names of its contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "PacketBufferPool.h"
+
+#include "ISABThread.h"
+#include "AlignUtility.h"
+
+#include <set>
+#include <iostream>
+#include <string.h>
+
+namespace {
+
+/// Singly linked list of free buffers, the next pointer is in the buffer.
+struct FreeList {
+   FreeList() : head( NULL ), count( 0 ) {}
+
+   static byte* getNext( byte* buffer ) {
+      byte* next = NULL;
+      memcpy( &next, buffer, sizeof( next ) );
+      return next;
+   }
+
+   void push( byte* buffer ) {
+      memcpy( buffer, &head, sizeof( head ) );
+      head = buffer;
+      ++count;
+   }
+
+   byte* pop() {
+      byte* buffer = head;
+      if ( buffer != NULL ) {
+         head = getNext( buffer );
+         --count;
+      }
+      return buffer;
+   }
+
+   /// Moves at most nbr buffers from this list to other.
+   void moveTo( FreeList& other, uint32 nbr ) {
+      for ( uint32 i = 0; i < nbr && head != NULL; ++i ) {
+         other.push( pop() );
+      }
+   }
+
+   /// Deletes all buffers in the list.
+   void clear() {
+      while ( head != NULL ) {
+         delete [] reinterpret_cast<uint32*>( pop() );
+      }
+   }
+
+   byte* head;
+   uint32 count;
+};
+
+/// Counters kept per thread so that they can be updated without locking.
+struct Counters {
+   Counters() :
+      allocations( 0 ), threadCacheHits( 0 ), depotHits( 0 ),
+      systemAllocations( 0 ), oversizeAllocations( 0 ),
+      deallocations( 0 ), bytesAllocated( 0 ), bytesDeallocated( 0 ) {}
+
+   void add( const Counters& other ) {
+      allocations += other.allocations;
+      threadCacheHits += other.threadCacheHits;
+      depotHits += other.depotHits;
+      systemAllocations += other.systemAllocations;
+      oversizeAllocations += other.oversizeAllocations;
+      deallocations += other.deallocations;
+      bytesAllocated += other.bytesAllocated;
+      bytesDeallocated += other.bytesDeallocated;
+   }
+
+   uint64 allocations;
+   uint64 threadCacheHits;
+   uint64 depotHits;
+   uint64 systemAllocations;
+   uint64 oversizeAllocations;
+   uint64 deallocations;
+   uint64 bytesAllocated;
+   uint64 bytesDeallocated;
+};
+
+/// The free buffers and counters of one thread.
+struct ThreadCache {
+   FreeList lists[ PacketBufferPool::NBR_SIZE_CLASSES ];
+   Counters counters;
+};
+
+/// Everything that is shared between the threads.
+struct Depot {
+   /**
+    * Max bytes cached per thread and size class. Not read from the
+    * Properties since packets are created by tools without mc2.prop too.
+    */
+   static const uint32 THREAD_CACHE_BYTES = 256 * 1024;
+   /// Max bytes cached in the depot per size class.
+   static const uint32 DEPOT_BYTES = 4 * 1024 * 1024;
+
+   Depot() {
+      memset( sizeHints, 0, sizeof( sizeHints ) );
+   }
+
+   /// @return The max number of buffers in a thread cache for a class.
+   uint32 getThreadLimit( uint32 classIdx ) const {
+      return MAX( 2, THREAD_CACHE_BYTES /
+                  ( PacketBufferPool::MIN_CLASS_SIZE << classIdx ) );
+   }
+
+   /// @return The max number of buffers in the depot for a class.
+   uint32 getDepotLimit( uint32 classIdx ) const {
+      return MAX( 4, DEPOT_BYTES /
+                  ( PacketBufferPool::MIN_CLASS_SIZE << classIdx ) );
+   }
+
+   /// Protects lists, threads and retired.
+   ISABMutexBeforeInit mutex;
+   FreeList lists[ PacketBufferPool::NBR_SIZE_CLASSES ];
+   /// All live thread caches, for the statistics.
+   std::set<ThreadCache*> threads;
+   /// The counters of the threads that have terminated.
+   Counters retired;
+   /**
+    * Size class index + 1 of the largest packet seen per subtype.
+    * Written without locking, a lost update only makes a hint smaller.
+    */
+   uint8 sizeHints[ MAX_UINT16 + 1 ];
+};
+
+/// Never deleted so that packets may be freed during static destruction.
+Depot* depot = NULL;
+
+/// The key to the thread caches.
+ISABTSS::TSSKey threadCacheKey;
+
+/// Makes sure init is only called once.
+ISABOnceFlag poolInited = ISAB_ONCE_INIT;
+
+/**
+ *  Destructor function which moves the buffers of a thread to the depot
+ *  when the thread terminates.
+ */
+void deleteThreadCache( void* ptr ) {
+   ThreadCache* cache = static_cast<ThreadCache*>( ptr );
+   {
+      ISABSyncBeforeInit sync( depot->mutex );
+      for ( uint32 i = 0; i < PacketBufferPool::NBR_SIZE_CLASSES; ++i ) {
+         uint32 room = depot->getDepotLimit( i ) -
+            MIN( depot->getDepotLimit( i ), depot->lists[ i ].count );
+         cache->lists[ i ].moveTo( depot->lists[ i ], room );
+      }
+      depot->retired.add( cache->counters );
+      depot->threads.erase( cache );
+   }
+   for ( uint32 i = 0; i < PacketBufferPool::NBR_SIZE_CLASSES; ++i ) {
+      cache->lists[ i ].clear();
+   }
+   delete cache;
+}
+
+/// Creates the depot and the key to the thread caches.
+void init() {
+   depot = new Depot();
+   threadCacheKey = ISABTSS::createKey( deleteThreadCache );
+}
+
+/// @return The thread cache of the calling thread.
+ThreadCache& getThreadCache() {
+   ISABCallOnce( &init, poolInited );
+
+   ThreadCache* cache =
+      static_cast<ThreadCache*>( ISABTSS::get( threadCacheKey ) );
+   if ( cache == NULL ) {
+      cache = new ThreadCache();
+      ISABTSS::set( threadCacheKey, cache );
+      ISABSyncBeforeInit sync( depot->mutex );
+      depot->threads.insert( cache );
+   }
+   return *cache;
+}
+
+/// @return The size class index for size, NBR_SIZE_CLASSES if too large.
+uint32 getClassIndex( uint32 size ) {
+   uint32 idx = 0;
+   uint32 classSize = PacketBufferPool::MIN_CLASS_SIZE;
+   while ( classSize < size && idx < PacketBufferPool::NBR_SIZE_CLASSES ) {
+      classSize <<= 1;
+      ++idx;
+   }
+   return idx;
+}
+
+}
+
+PacketBufferPool::Statistics::Statistics() :
+   allocations( 0 ), threadCacheHits( 0 ), depotHits( 0 ),
+   systemAllocations( 0 ), oversizeAllocations( 0 ), deallocations( 0 ),
+   bytesInFlight( 0 ), bytesCached( 0 )
+{
+}
+
+float
+PacketBufferPool::Statistics::getHitRate() const
+{
+   if ( allocations == 0 ) {
+      return 0;
+   }
+   return float( threadCacheHits + depotHits ) / allocations;
+}
+
+uint32
+PacketBufferPool::getCapacity( uint32 size )
+{
+   uint32 classIdx = getClassIndex( size );
+   if ( classIdx >= NBR_SIZE_CLASSES ) {
+      return size;
+   }
+   return MIN_CLASS_SIZE << classIdx;
+}
+
+byte*
+PacketBufferPool::allocate( uint32 size, uint32& capacity )
+{
+   ThreadCache& cache = getThreadCache();
+   ++cache.counters.allocations;
+
+   uint32 classIdx = getClassIndex( size );
+   if ( classIdx >= NBR_SIZE_CLASSES ) {
+      ++cache.counters.oversizeAllocations;
+      ++cache.counters.systemAllocations;
+      cache.counters.bytesAllocated += size;
+      capacity = size;
+      return MAKE_UINT32_ALIGNED_BYTE_BUFFER( size );
+   }
+
+   capacity = MIN_CLASS_SIZE << classIdx;
+   cache.counters.bytesAllocated += capacity;
+
+   FreeList& list = cache.lists[ classIdx ];
+   if ( list.head != NULL ) {
+      ++cache.counters.threadCacheHits;
+      return list.pop();
+   }
+
+   // Refill half of the thread cache from the depot in one go.
+   {
+      ISABSyncBeforeInit sync( depot->mutex );
+      depot->lists[ classIdx ].moveTo( list,
+                                       MAX( 1, depot->getThreadLimit( classIdx ) / 2 ) );
+   }
+   if ( list.head != NULL ) {
+      ++cache.counters.depotHits;
+      return list.pop();
+   }
+
+   ++cache.counters.systemAllocations;
+   return MAKE_UINT32_ALIGNED_BYTE_BUFFER( capacity );
+}
+
+void
+PacketBufferPool::deallocate( byte* buffer, uint32 capacity )
+{
+   if ( buffer == NULL ) {
+      return;
+   }
+   ThreadCache& cache = getThreadCache();
+   ++cache.counters.deallocations;
+   cache.counters.bytesDeallocated += capacity;
+
+   uint32 classIdx = getClassIndex( capacity );
+   if ( classIdx >= NBR_SIZE_CLASSES ||
+        ( MIN_CLASS_SIZE << classIdx ) != capacity ) {
+      // Oversize or not from the pool.
+      delete [] reinterpret_cast<uint32*>( buffer );
+      return;
+   }
+
+   FreeList& list = cache.lists[ classIdx ];
+   list.push( buffer );
+
+   const uint32 threadLimit = depot->getThreadLimit( classIdx );
+   if ( list.count <= threadLimit ) {
+      return;
+   }
+
+   // Give back half of the thread cache, if the depot is full too
+   // the rest is freed.
+   FreeList surplus;
+   list.moveTo( surplus, list.count - threadLimit / 2 );
+   {
+      ISABSyncBeforeInit sync( depot->mutex );
+      const uint32 depotLimit = depot->getDepotLimit( classIdx );
+      FreeList& depotList = depot->lists[ classIdx ];
+      if ( depotList.count < depotLimit ) {
+         surplus.moveTo( depotList, depotLimit - depotList.count );
+      }
+   }
+   surplus.clear();
+}
+
+void
+PacketBufferPool::recordLength( uint16 subType, uint32 length )
+{
+   ISABCallOnce( &init, poolInited );
+   uint32 classIdx = getClassIndex( length );
+   if ( classIdx >= NBR_SIZE_CLASSES ) {
+      classIdx = NBR_SIZE_CLASSES - 1;
+   }
+   if ( depot->sizeHints[ subType ] < classIdx + 1 ) {
+      depot->sizeHints[ subType ] = classIdx + 1;
+   }
+}
+
+uint32
+PacketBufferPool::getSizeHint( uint16 subType )
+{
+   ISABCallOnce( &init, poolInited );
+   uint8 hint = depot->sizeHints[ subType ];
+   if ( hint == 0 ) {
+      return 0;
+   }
+   return MIN_CLASS_SIZE << ( hint - 1 );
+}
+
+PacketBufferPool::Statistics
+PacketBufferPool::getStatistics()
+{
+   ISABCallOnce( &init, poolInited );
+
+   Counters counters;
+   Statistics stats;
+   ISABSyncBeforeInit sync( depot->mutex );
+   counters.add( depot->retired );
+   for ( std::set<ThreadCache*>::const_iterator it = depot->threads.begin();
+         it != depot->threads.end(); ++it ) {
+      counters.add( (*it)->counters );
+      for ( uint32 i = 0; i < NBR_SIZE_CLASSES; ++i ) {
+         stats.bytesCached +=
+            int64( (*it)->lists[ i ].count ) * ( MIN_CLASS_SIZE << i );
+      }
+   }
+   for ( uint32 i = 0; i < NBR_SIZE_CLASSES; ++i ) {
+      stats.bytesCached +=
+         int64( depot->lists[ i ].count ) * ( MIN_CLASS_SIZE << i );
+   }
+
+   stats.allocations = counters.allocations;
+   stats.threadCacheHits = counters.threadCacheHits;
+   stats.depotHits = counters.depotHits;
+   stats.systemAllocations = counters.systemAllocations;
+   stats.oversizeAllocations = counters.oversizeAllocations;
+   stats.deallocations = counters.deallocations;
+   stats.bytesInFlight =
+      int64( counters.bytesAllocated ) - int64( counters.bytesDeallocated );
+   return stats;
+}
+
+void
+PacketBufferPool::trim()
+{
+   ThreadCache& cache = getThreadCache();
+   for ( uint32 i = 0; i < NBR_SIZE_CLASSES; ++i ) {
+      cache.lists[ i ].clear();
+   }
+   ISABSyncBeforeInit sync( depot->mutex );
+   for ( uint32 i = 0; i < NBR_SIZE_CLASSES; ++i ) {
+      depot->lists[ i ].clear();
+   }
+}
+
+std::ostream& operator << ( std::ostream& stream,
+                            const PacketBufferPool::Statistics& stats )
+{
+   return stream << "allocations: " << stats.allocations
+                 << " hit rate: " << stats.getHitRate()
+                 << " (thread " << stats.threadCacheHits
+                 << ", depot " << stats.depotHits << ")"
+                 << " new: " << stats.systemAllocations
+                 << " oversize: " << stats.oversizeAllocations
+                 << " frees: " << stats.deallocations
+                 << " in flight: " << stats.bytesInFlight << " B"
+                 << " cached: " << stats.bytesCached << " B";
+}